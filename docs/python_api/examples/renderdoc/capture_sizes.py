@@ -0,0 +1,114 @@
+import sys
+
+# Import renderdoc if not already imported (e.g. in the UI)
+if 'renderdoc' not in sys.modules and '_renderdoc' not in sys.modules:
+	import renderdoc
+
+# Alias renderdoc for legibility
+rd = renderdoc
+
+# Substrings of chunk names, checked in order. The first category to match wins
+categories = [
+	("Map/coherent memory updates", ["Unmap", "FlushMappedMemoryRanges", "FlushMappedBufferRange",
+	                                 "CoherentMapWrite"]),
+	("Buffer/texture uploads", ["BufferData", "BufferSubData", "BufferStorage", "UpdateSubresource",
+	                            "UpdateBuffer", "WriteToSubresource", "TexImage", "TexSubImage",
+	                            "TextureSubImage", "CompressedTex"]),
+	("Shader blobs", ["CreateShaderModule", "ShaderSource", "ShaderBinary", "ProgramBinary",
+	                  "CreateVertexShader", "CreatePixelShader", "CreateHullShader",
+	                  "CreateDomainShader", "CreateGeometryShader", "CreateComputeShader",
+	                  "CreateShadersEXT"]),
+	("Pipeline state", ["CreateGraphicsPipelines", "CreateComputePipelines",
+	                    "CreateRayTracingPipelines", "CreateGraphicsPipelineState",
+	                    "CreateComputePipelineState", "CreatePipelineState", "CreateStateObject",
+	                    "CreatePipelineLibrary"]),
+]
+
+def formatBytes(b):
+	for unit,scale in [("GB", 1024**3), ("MB", 1024**2), ("KB", 1024)]:
+		if b >= scale:
+			return "%.2f %s" % (b / scale, unit)
+	return "%d B" % b
+
+def categorise(chunk):
+	if "Internal::Initial Contents" in chunk.name:
+		# The resource type is serialised in the chunk, though the name varies by API
+		for i in range(chunk.NumChildren()):
+			child = chunk.GetChild(i)
+			if child.name == "type" or child.name == "Type":
+				return "Initial contents: " + child.AsString()
+		return "Initial contents"
+
+	for name,needles in categories:
+		for n in needles:
+			if n in chunk.name:
+				return name
+
+	return "Other"
+
+def sampleCode(cap):
+	print("Sections (compressed / uncompressed):")
+
+	frameRatio = 1.0
+
+	for i in range(cap.GetSectionCount()):
+		props = cap.GetSectionProperties(i)
+		print("  %-40s %12s / %12s" % (props.name, formatBytes(props.compressedSize),
+		                               formatBytes(props.uncompressedSize)))
+
+		if props.type == rd.SectionType.FrameCapture and props.uncompressedSize > 0:
+			frameRatio = props.compressedSize / props.uncompressedSize
+
+	thumb = cap.GetThumbnail(rd.FileType.JPG, 0)
+	print("  %-40s %12s" % ("Header thumbnail", formatBytes(len(thumb.data))))
+
+	sizes = {}
+	total = 0
+
+	for chunk in cap.GetStructuredData().chunks:
+		cat = categorise(chunk)
+		sizes[cat] = sizes.get(cat, 0) + chunk.metadata.length
+		total += chunk.metadata.length
+
+	if total == 0:
+		print("No chunk data available.")
+		return
+
+	# Chunks are compressed together, so estimate each category's compressed size from the
+	# frame capture section's overall ratio
+	print("Frame capture chunks (uncompressed / estimated compressed):")
+
+	for cat,size in sorted(sizes.items(), key=lambda x: x[1], reverse=True):
+		print("  %-50s %12s / %12s  %5.1f%%" % (cat, formatBytes(size),
+		                                         formatBytes(int(size * frameRatio)),
+		                                         100.0 * size / total))
+
+def loadCapture(filename):
+	# Open a capture file handle
+	cap = rd.OpenCaptureFile()
+
+	# Open a particular file - see also OpenBuffer to load from memory
+	result = cap.OpenFile(filename, '', None)
+
+	# Make sure the file opened successfully
+	if result != rd.ResultCode.Succeeded:
+		raise RuntimeError("Couldn't open file: " + str(result))
+
+	return cap
+
+if 'pyrenderdoc' in globals():
+	print("This example runs standalone on a capture file")
+else:
+	rd.InitialiseReplay(rd.GlobalEnvironment(), [])
+
+	if len(sys.argv) <= 1:
+		print('Usage: python3 {} filename.rdc'.format(sys.argv[0]))
+		sys.exit(0)
+
+	cap = loadCapture(sys.argv[1])
+
+	sampleCode(cap)
+
+	cap.Shutdown()
+
+	rd.ShutdownReplay()
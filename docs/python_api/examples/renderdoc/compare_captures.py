@@ -0,0 +1,170 @@
+import sys
+import math
+
+# Import renderdoc if not already imported (e.g. in the UI)
+if 'renderdoc' not in sys.modules and '_renderdoc' not in sys.modules:
+	import renderdoc
+
+# Alias renderdoc for legibility
+rd = renderdoc
+
+# How many times to fetch the GPU durations, to estimate how much they vary between runs
+REPEATS = 5
+
+# How many standard errors apart the timings must be for a change to count as significant
+SIGNIFICANCE = 3.0
+
+# Number of draws to list, sorted by the largest change
+TOP_DRAWS = 20
+
+class Timing:
+	def __init__(self, samples):
+		self.n = len(samples)
+		self.mean = sum(samples) / self.n
+		if self.n > 1:
+			self.variance = sum([(s - self.mean) ** 2 for s in samples]) / (self.n - 1)
+		else:
+			self.variance = 0.0
+
+	def add(self, other):
+		# timings of different actions are independent, so the means and variances add
+		self.mean += other.mean
+		self.variance += other.variance
+
+# Key every action by the markers it's under, its name, and how many times that same combination
+# has been seen before. The same work in two captures will then have the same key even if other
+# actions have been added or removed elsewhere in the frame
+def keyActions(controller):
+	sdfile = controller.GetStructuredFile()
+	keys = {}
+	seen = {}
+
+	def walk(action, path):
+		if action.flags & rd.ActionFlags.PushMarker:
+			path = path + (action.GetName(sdfile),)
+		else:
+			name = action.GetName(sdfile)
+			count = seen.get((path, name), 0)
+			seen[(path, name)] = count + 1
+			keys[action.eventId] = (path, name, count)
+
+		for child in action.children:
+			walk(child, path)
+
+	for action in controller.GetRootActions():
+		walk(action, ())
+
+	return keys
+
+# Fetch the GPU durations several times, returning a Timing for each action key
+def fetchTimings(filename):
+	cap,controller = loadCapture(filename)
+
+	if not (rd.GPUCounter.EventGPUDuration in controller.EnumerateCounters()):
+		raise RuntimeError("%s: implementation doesn't support the GPU duration counter" % filename)
+
+	keys = keyActions(controller)
+
+	samples = {}
+	for i in range(REPEATS):
+		for r in controller.FetchCounters([rd.GPUCounter.EventGPUDuration]):
+			if r.eventId in keys:
+				samples.setdefault(keys[r.eventId], []).append(r.value.d)
+
+	controller.Shutdown()
+	cap.Shutdown()
+
+	return {k: Timing(v) for k,v in samples.items()}
+
+def significant(a, b):
+	stderr = math.sqrt(a.variance / a.n + b.variance / b.n)
+	return abs(b.mean - a.mean) > SIGNIFICANCE * stderr
+
+def describe(a, b):
+	delta = b.mean - a.mean
+	percent = delta * 100.0 / a.mean if a.mean > 0 else 0.0
+	return "%.3f ms -> %.3f ms (%+.3f ms, %+.1f%%)%s" % (a.mean * 1000.0, b.mean * 1000.0,
+	                                                   delta * 1000.0, percent,
+	                                                   "" if significant(a, b) else " (within noise)")
+
+def compare(fileA, fileB):
+	timingsA = fetchTimings(fileA)
+	timingsB = fetchTimings(fileB)
+
+	matched = [k for k in timingsA if k in timingsB]
+	onlyA = [k for k in timingsA if k not in timingsB]
+	onlyB = [k for k in timingsB if k not in timingsA]
+
+	# Sum up the matched actions under each marker region, as a pass. Actions only in one
+	# capture are counted separately so they don't distort the matched totals
+	passesA = {}
+	passesB = {}
+	for k in matched:
+		path = k[0]
+		for i in range(len(path) + 1):
+			for passes,timings in [(passesA, timingsA), (passesB, timingsB)]:
+				if path[:i] not in passes:
+					passes[path[:i]] = Timing([0.0] * REPEATS)
+				passes[path[:i]].add(timings[k])
+
+	print("Whole frame: %s" % describe(passesA[()], passesB[()]))
+	print("%d actions matched, %d only in A, %d only in B" % (len(matched), len(onlyA), len(onlyB)))
+	print("")
+
+	print("Marker regions:")
+	for path in passesA:
+		if len(path) == 0:
+			continue
+		print("%s%s: %s" % ("  " * len(path), path[-1], describe(passesA[path], passesB[path])))
+	print("")
+
+	matched.sort(key=lambda k: abs(timingsB[k].mean - timingsA[k].mean), reverse=True)
+
+	print("Largest changes in matched actions:")
+	for k in matched[:TOP_DRAWS]:
+		print("  %s%s: %s" % ("".join([p + " > " for p in k[0]]), k[1], describe(timingsA[k], timingsB[k])))
+
+	for label,keys,timings in [("A", onlyA, timingsA), ("B", onlyB, timingsB)]:
+		if len(keys) == 0:
+			continue
+
+		print("")
+		print("Actions only in %s, %.3f ms total:" % (label, sum([timings[k].mean for k in keys]) * 1000.0))
+		for k in sorted(keys, key=lambda k: timings[k].mean, reverse=True)[:TOP_DRAWS]:
+			print("  %s%s: %.3f ms" % ("".join([p + " > " for p in k[0]]), k[1], timings[k].mean * 1000.0))
+
+def loadCapture(filename):
+	# Open a capture file handle
+	cap = rd.OpenCaptureFile()
+
+	# Open a particular file - see also OpenBuffer to load from memory
+	result = cap.OpenFile(filename, '', None)
+
+	# Make sure the file opened successfully
+	if result != rd.ResultCode.Succeeded:
+		raise RuntimeError("Couldn't open file: " + str(result))
+
+	# Make sure we can replay
+	if not cap.LocalReplaySupport():
+		raise RuntimeError("Capture cannot be replayed")
+
+	# Initialise the replay
+	result,controller = cap.OpenCapture(rd.ReplayOptions(), None)
+
+	if result != rd.ResultCode.Succeeded:
+		raise RuntimeError("Couldn't initialise replay: " + str(result))
+
+	return cap,controller
+
+if 'pyrenderdoc' in globals():
+	print("This example opens its own captures, run it from the command line")
+else:
+	rd.InitialiseReplay(rd.GlobalEnvironment(), [])
+
+	if len(sys.argv) <= 2:
+		print('Usage: python3 {} before.rdc after.rdc'.format(sys.argv[0]))
+		sys.exit(0)
+
+	compare(sys.argv[1], sys.argv[2])
+
+	rd.ShutdownReplay()
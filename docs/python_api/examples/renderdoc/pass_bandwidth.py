@@ -0,0 +1,306 @@
+import sys
+
+# Import renderdoc if not already imported (e.g. in the UI)
+if 'renderdoc' not in sys.modules and '_renderdoc' not in sys.modules:
+	import renderdoc
+
+# Alias renderdoc for legibility
+rd = renderdoc
+
+VK_ATTACHMENT_LOAD_OP_LOAD = 0
+VK_ATTACHMENT_STORE_OP_STORE = 0
+VK_ATTACHMENT_UNUSED = 0xFFFFFFFF
+VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT = 0x80
+
+def formatBytes(b):
+	for unit,scale in [("GB", 1024**3), ("MB", 1024**2), ("KB", 1024)]:
+		if b >= scale:
+			return "%.2f %s" % (b / scale, unit)
+	return "%d B" % b
+
+def children(obj):
+	if obj is None:
+		return []
+	return [obj.GetChild(i) for i in range(obj.NumChildren())]
+
+# Information about resources gathered from their creation chunks and the replay's resource lists
+class Resources:
+	def __init__(self, controller):
+		self.textures = {}
+		for tex in controller.GetTextures():
+			self.textures[tex.resourceId] = tex
+
+		self.parents = {}
+		self.names = {}
+		for res in controller.GetResources():
+			self.parents[res.resourceId] = res.parentResources
+			self.names[res.resourceId] = res.name
+
+		self.renderPasses = {}
+		self.framebuffers = {}
+		self.transient = set()
+
+		for chunk in controller.GetStructuredFile().chunks:
+			info = chunk.FindChild("CreateInfo")
+			if info is None:
+				continue
+
+			if "vkCreateRenderPass" in chunk.name:
+				self.renderPasses[chunk.FindChild("RenderPass").AsResourceId()] = info
+			elif chunk.name == "vkCreateFramebuffer":
+				self.framebuffers[chunk.FindChild("Framebuffer").AsResourceId()] = info
+			elif chunk.name == "vkCreateImage":
+				if info.FindChild("usage").AsUInt64() & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT:
+					self.transient.add(chunk.FindChild("Image").AsResourceId())
+
+	# Find the image behind an image view
+	def image(self, view):
+		for parent in self.parents.get(view, []):
+			if parent in self.textures:
+				return parent
+		return None
+
+class Attachment:
+	def __init__(self, resources, view, load, store, resolveView, width, height):
+		self.image = resources.image(view)
+		self.name = resources.names.get(self.image, "Unknown attachment")
+		self.tex = resources.textures.get(self.image)
+		self.load = load
+		self.store = store
+		self.transient = self.image in resources.transient
+		self.resolved = resolveView is not None
+
+		self.bytes = 0
+		self.resolveBytes = 0
+		if self.tex is not None:
+			pixelBytes = self.tex.format.ElementSize()
+			self.bytes = width * height * pixelBytes * max(1, self.tex.msSamp)
+
+			# resolves write one sample per pixel to their target
+			if self.resolved:
+				self.resolveBytes = width * height * pixelBytes
+
+# Attachments used by a vkCmdBeginRenderPass with a render pass and framebuffer
+def renderPassAttachments(resources, chunk):
+	begin = chunk.FindChild("RenderPassBegin")
+	rp = resources.renderPasses.get(begin.FindChild("renderPass").AsResourceId())
+	fb = resources.framebuffers.get(begin.FindChild("framebuffer").AsResourceId())
+
+	if rp is None or fb is None:
+		return []
+
+	extent = begin.FindChild("renderArea").FindChild("extent")
+	width = extent.FindChild("width").AsUInt64()
+	height = extent.FindChild("height").AsUInt64()
+
+	views = [v.AsResourceId() for v in children(fb.FindChild("pAttachments"))]
+	descs = children(rp.FindChild("pAttachments"))
+
+	# find which attachments are resolved into which others, in any subpass
+	resolves = {}
+	for subpass in children(rp.FindChild("pSubpasses")):
+		colors = children(subpass.FindChild("pColorAttachments"))
+		for i,res in enumerate(children(subpass.FindChild("pResolveAttachments"))):
+			src = colors[i].FindChild("attachment").AsUInt64()
+			dst = res.FindChild("attachment").AsUInt64()
+			if src != VK_ATTACHMENT_UNUSED and dst != VK_ATTACHMENT_UNUSED and dst < len(views):
+				resolves[src] = views[dst]
+
+	ret = []
+	for i,desc in enumerate(descs):
+		if i >= len(views):
+			break
+
+		# for depth/stencil count the attachment if either aspect is loaded or stored
+		load = (desc.FindChild("loadOp").AsUInt64() == VK_ATTACHMENT_LOAD_OP_LOAD or
+		        desc.FindChild("stencilLoadOp").AsUInt64() == VK_ATTACHMENT_LOAD_OP_LOAD)
+		store = (desc.FindChild("storeOp").AsUInt64() == VK_ATTACHMENT_STORE_OP_STORE or
+		         desc.FindChild("stencilStoreOp").AsUInt64() == VK_ATTACHMENT_STORE_OP_STORE)
+
+		ret.append(Attachment(resources, views[i], load, store, resolves.get(i), width, height))
+
+	return ret
+
+# Attachments used by a vkCmdBeginRendering
+def dynamicRenderingAttachments(resources, chunk):
+	info = chunk.FindChild("pRenderingInfo")
+
+	extent = info.FindChild("renderArea").FindChild("extent")
+	width = extent.FindChild("width").AsUInt64()
+	height = extent.FindChild("height").AsUInt64()
+
+	atts = children(info.FindChild("pColorAttachments"))
+	for name in ["pDepthAttachment", "pStencilAttachment"]:
+		att = info.FindChild(name)
+		if att is not None and att.NumChildren() > 0:
+			atts.append(att)
+
+	ret = []
+	for att in atts:
+		view = att.FindChild("imageView").AsResourceId()
+		if view == rd.ResourceId.Null():
+			continue
+
+		resolveView = None
+		if att.FindChild("resolveMode").AsUInt64() != 0:
+			resolveView = att.FindChild("resolveImageView").AsResourceId()
+
+		load = att.FindChild("loadOp").AsUInt64() == VK_ATTACHMENT_LOAD_OP_LOAD
+		store = att.FindChild("storeOp").AsUInt64() == VK_ATTACHMENT_STORE_OP_STORE
+
+		ret.append(Attachment(resources, view, load, store, resolveView, width, height))
+
+	return ret
+
+class Pass:
+	def __init__(self, eventId, name, attachments):
+		self.eventId = eventId
+		self.name = name
+		self.attachments = attachments
+		self.actions = []
+
+def findPasses(controller, resources):
+	sdfile = controller.GetStructuredFile()
+	passes = []
+	current = [None]
+
+	def walk(action):
+		for event in action.events:
+			if event.chunkIndex >= len(sdfile.chunks):
+				continue
+
+			chunk = sdfile.chunks[event.chunkIndex]
+
+			if "vkCmdBeginRenderPass" in chunk.name:
+				current[0] = Pass(event.eventId, chunk.name, renderPassAttachments(resources, chunk))
+				passes.append(current[0])
+			elif "vkCmdBeginRendering" in chunk.name:
+				current[0] = Pass(event.eventId, chunk.name, dynamicRenderingAttachments(resources, chunk))
+				passes.append(current[0])
+			elif "vkCmdEndRenderPass" in chunk.name or "vkCmdEndRendering" in chunk.name:
+				current[0] = None
+
+		if current[0] is not None and (action.flags & rd.ActionFlags.Drawcall):
+			current[0].actions.append(action.eventId)
+
+		for child in action.children:
+			walk(child)
+
+	for action in controller.GetRootActions():
+		walk(action)
+
+	return passes
+
+# Sum any counters measured in bytes over each pass's actions, if the hardware provides them
+def fetchByteCounters(controller, passes):
+	counters = []
+	for c in controller.EnumerateCounters():
+		if controller.DescribeCounter(c).unit == rd.CounterUnit.Bytes:
+			counters.append(c)
+
+	if len(counters) == 0:
+		return [], {}
+
+	descs = [controller.DescribeCounter(c) for c in counters]
+	results = controller.FetchCounters(counters)
+
+	totals = {}
+	for p in passes:
+		actions = set(p.actions)
+		sums = [0] * len(counters)
+		for r in results:
+			if r.eventId in actions:
+				idx = counters.index(r.counter)
+				if descs[idx].resultByteWidth == 8:
+					sums[idx] += r.value.u64
+				else:
+					sums[idx] += r.value.u32
+		totals[p.eventId] = sums
+
+	return descs, totals
+
+def sampleCode(controller):
+	resources = Resources(controller)
+	passes = findPasses(controller, resources)
+
+	if len(passes) == 0:
+		print("No Vulkan render passes found")
+		return
+
+	counterDescs, counterTotals = fetchByteCounters(controller, passes)
+
+	frameLoaded = 0
+	frameStored = 0
+
+	for p in passes:
+		loaded = 0
+		stored = 0
+		print("EID %d: %s (%d draws)" % (p.eventId, p.name, len(p.actions)))
+
+		for att in p.attachments:
+			attLoaded = att.bytes if att.load else 0
+			attStored = (att.bytes if att.store else 0) + att.resolveBytes
+			loaded += attLoaded
+			stored += attStored
+
+			notes = []
+			if att.transient and att.load:
+				notes.append("transient attachment is loaded")
+			if att.transient and att.store:
+				notes.append("transient attachment is stored")
+			if att.resolved and att.store and att.tex is not None and att.tex.msSamp > 1:
+				notes.append("multisampled attachment is stored as well as resolved")
+
+			print("  %-40s load %10s  store %10s  %s" % (att.name, formatBytes(attLoaded),
+			                                            formatBytes(attStored), "; ".join(notes)))
+
+		print("  %-40s load %10s  store %10s" % ("Pass total", formatBytes(loaded), formatBytes(stored)))
+
+		for i,desc in enumerate(counterDescs):
+			print("  %-40s %s" % (desc.name, formatBytes(counterTotals[p.eventId][i])))
+
+		frameLoaded += loaded
+		frameStored += stored
+
+	print("Frame total: load %s, store %s" % (formatBytes(frameLoaded), formatBytes(frameStored)))
+
+def loadCapture(filename):
+	# Open a capture file handle
+	cap = rd.OpenCaptureFile()
+
+	# Open a particular file - see also OpenBuffer to load from memory
+	result = cap.OpenFile(filename, '', None)
+
+	# Make sure the file opened successfully
+	if result != rd.ResultCode.Succeeded:
+		raise RuntimeError("Couldn't open file: " + str(result))
+
+	# Make sure we can replay
+	if not cap.LocalReplaySupport():
+		raise RuntimeError("Capture cannot be replayed")
+
+	# Initialise the replay
+	result,controller = cap.OpenCapture(rd.ReplayOptions(), None)
+
+	if result != rd.ResultCode.Succeeded:
+		raise RuntimeError("Couldn't initialise replay: " + str(result))
+
+	return cap,controller
+
+if 'pyrenderdoc' in globals():
+	pyrenderdoc.Replay().BlockInvoke(sampleCode)
+else:
+	rd.InitialiseReplay(rd.GlobalEnvironment(), [])
+
+	if len(sys.argv) <= 1:
+		print('Usage: python3 {} filename.rdc'.format(sys.argv[0]))
+		sys.exit(0)
+
+	cap,controller = loadCapture(sys.argv[1])
+
+	sampleCode(controller)
+
+	controller.Shutdown()
+	cap.Shutdown()
+
+	rd.ShutdownReplay()
@@ -0,0 +1,176 @@
+import sys
+import struct
+
+# Import renderdoc if not already imported (e.g. in the UI)
+if 'renderdoc' not in sys.modules and '_renderdoc' not in sys.modules:
+	import renderdoc
+
+# Alias renderdoc for legibility
+rd = renderdoc
+
+# The overdraw histogram has one bucket per count up to this, and anything above goes in the last
+MAX_OVERDRAW = 8
+
+# Number of draws to list, sorted by the most helper lanes
+WORST_DRAWS = 10
+
+class QuadStats:
+	def __init__(self):
+		# total quads, covered pixels, helper lanes and partially covered quads shaded
+		self.quads = 0
+		self.covered = 0
+		self.helpers = 0
+		self.partial = 0
+		# number of quad locations on screen shaded N times
+		self.histogram = [0] * (MAX_OVERDRAW + 1)
+
+	def add(self, other):
+		self.quads += other.quads
+		self.covered += other.covered
+		self.helpers += other.helpers
+		self.partial += other.partial
+		for i in range(len(self.histogram)):
+			self.histogram[i] += other.histogram[i]
+
+	# The fraction of shaded lanes which were covered pixels rather than helpers
+	def efficiency(self):
+		if self.quads == 0:
+			return 1.0
+		return self.covered / (self.quads * 4)
+
+	def describe(self):
+		return "%d quads, %d covered pixels, %d helper lanes (%.1f%% quad efficiency), %d partial quads" % \
+		       (self.quads, self.covered, self.helpers, self.efficiency() * 100.0, self.partial)
+
+# Read back the quad overdraw overlay and total up its values
+def readOverlay(controller, out, target, overlay):
+	disp = rd.TextureDisplay()
+	disp.resourceId = target
+	disp.overlay = overlay
+	out.SetTextureDisplay(disp)
+
+	overlayId = out.GetDebugOverlayTexID()
+	if overlayId == rd.ResourceId.Null():
+		return None
+
+	tex = [t for t in controller.GetTextures() if t.resourceId == target][0]
+	data = controller.GetTextureData(overlayId, rd.Subresource())
+
+	# The overlay is RGBA16F with one value per pixel, but every pixel in a 2x2 quad holds the
+	# same counts. See DebugOverlay.QuadOverdrawPass for what each channel contains
+	stats = QuadStats()
+	rowPitch = tex.width * 8
+	for y in range(0, tex.height, 2):
+		for x in range(0, tex.width, 2):
+			quads,covered,helpers,partial = struct.unpack_from('<4e', data, y * rowPitch + x * 8)
+			if quads == 0:
+				continue
+
+			stats.quads += int(quads)
+			stats.covered += int(covered)
+			stats.helpers += int(helpers)
+			stats.partial += int(partial)
+			stats.histogram[min(int(quads), MAX_OVERDRAW)] += 1
+
+	return stats
+
+def iterDraws(actions):
+	for action in actions:
+		if action.flags & rd.ActionFlags.Drawcall:
+			yield action
+		for child in iterDraws(action.children):
+			yield child
+
+def printHistogram(stats):
+	locations = sum(stats.histogram)
+	if locations == 0:
+		return
+
+	for i in range(1, len(stats.histogram)):
+		label = "%d%s" % (i, "+" if i == MAX_OVERDRAW else "")
+		print("    %3s: %d quads (%.1f%%)" % (label, stats.histogram[i],
+		                                       stats.histogram[i] * 100.0 / locations))
+
+def sampleCode(controller):
+	out = controller.CreateOutput(rd.CreateHeadlessWindowingData(100, 100), rd.ReplayOutputType.Texture)
+
+	draws = [d for d in iterDraws(controller.GetRootActions()) if d.outputs[0] != rd.ResourceId.Null()]
+
+	frame = QuadStats()
+	perDraw = []
+	passStart = 0
+
+	for i,draw in enumerate(draws):
+		controller.SetFrameEvent(draw.eventId, True)
+
+		stats = readOverlay(controller, out, draw.outputs[0], rd.DebugOverlay.QuadOverdrawDraw)
+		if stats is None:
+			continue
+
+		perDraw.append((draw, stats))
+		frame.add(stats)
+
+		# Treat consecutive draws to the same targets as a pass, and once we reach the last draw in
+		# it read the overlay accumulated over the whole pass to see how much the draws overlap
+		last = i + 1 == len(draws) or list(draws[i + 1].outputs) != list(draw.outputs) or \
+		       draws[i + 1].depthOut != draw.depthOut
+		if last:
+			passStats = readOverlay(controller, out, draw.outputs[0], rd.DebugOverlay.QuadOverdrawPass)
+			if passStats is not None:
+				print("Pass EID %d - %d: %s" % (draws[passStart].eventId, draw.eventId, passStats.describe()))
+				printHistogram(passStats)
+			passStart = i + 1
+
+	print("")
+	print("Frame total: %s" % frame.describe())
+	print("")
+
+	perDraw.sort(key=lambda d: d[1].helpers, reverse=True)
+
+	print("Draws with the most helper lanes:")
+	for draw,stats in perDraw[:WORST_DRAWS]:
+		print("  EID %d '%s': %s" % (draw.eventId, draw.GetName(controller.GetStructuredFile()),
+		                            stats.describe()))
+
+	out.Shutdown()
+
+def loadCapture(filename):
+	# Open a capture file handle
+	cap = rd.OpenCaptureFile()
+
+	# Open a particular file - see also OpenBuffer to load from memory
+	result = cap.OpenFile(filename, '', None)
+
+	# Make sure the file opened successfully
+	if result != rd.ResultCode.Succeeded:
+		raise RuntimeError("Couldn't open file: " + str(result))
+
+	# Make sure we can replay
+	if not cap.LocalReplaySupport():
+		raise RuntimeError("Capture cannot be replayed")
+
+	# Initialise the replay
+	result,controller = cap.OpenCapture(rd.ReplayOptions(), None)
+
+	if result != rd.ResultCode.Succeeded:
+		raise RuntimeError("Couldn't initialise replay: " + str(result))
+
+	return cap,controller
+
+if 'pyrenderdoc' in globals():
+	pyrenderdoc.Replay().BlockInvoke(sampleCode)
+else:
+	rd.InitialiseReplay(rd.GlobalEnvironment(), [])
+
+	if len(sys.argv) <= 1:
+		print('Usage: python3 {} filename.rdc'.format(sys.argv[0]))
+		sys.exit(0)
+
+	cap,controller = loadCapture(sys.argv[1])
+
+	sampleCode(controller)
+
+	controller.Shutdown()
+	cap.Shutdown()
+
+	rd.ShutdownReplay()
@@ -0,0 +1,252 @@
+import sys
+import os
+import json
+import tempfile
+
+# Import renderdoc if not already imported (e.g. in the UI)
+if 'renderdoc' not in sys.modules and '_renderdoc' not in sys.modules:
+	import renderdoc
+
+# Alias renderdoc for legibility
+rd = renderdoc
+
+# Bubbles shorter than this (in seconds) aren't reported
+MIN_BUBBLE = 10.0e-6
+
+def children(obj):
+	if obj is None:
+		return []
+	return [obj.GetChild(i) for i in range(obj.NumChildren())]
+
+# Look for a member in a struct or anywhere in its pNext chain
+def findMember(obj, name):
+	while obj is not None:
+		member = obj.FindChild(name)
+		if member is not None:
+			return member
+		obj = obj.FindChild("pNext")
+	return None
+
+class Submit:
+	def __init__(self, queue, index, waits, signals):
+		self.queue = queue
+		self.index = index
+		# lists of (semaphore, value) pairs. Binary semaphores have a value of 0
+		self.waits = waits
+		self.signals = signals
+		# (eventId, name, duration) for each action with a GPU duration
+		self.actions = []
+		self.start = 0.0
+		self.end = 0.0
+
+	def duration(self):
+		return sum([a[2] for a in self.actions])
+
+# Read the semaphores waited on and signalled by one VkSubmitInfo or VkSubmitInfo2
+def submitSemaphores(info):
+	# vkQueueSubmit2
+	if info.FindChild("pWaitSemaphoreInfos") is not None:
+		def semInfos(name):
+			return [(s.FindChild("semaphore").AsResourceId(), s.FindChild("value").AsUInt64())
+			        for s in children(info.FindChild(name))]
+		return semInfos("pWaitSemaphoreInfos"),semInfos("pSignalSemaphoreInfos")
+
+	# vkQueueSubmit, with timeline values in VkTimelineSemaphoreSubmitInfo if present
+	def sems(name, valuesName):
+		values = [v.AsUInt64() for v in children(findMember(info, valuesName))]
+		ret = []
+		for i,s in enumerate(children(info.FindChild(name))):
+			ret.append((s.AsResourceId(), values[i] if i < len(values) else 0))
+		return ret
+	return sems("pWaitSemaphores", "pWaitSemaphoreValues"),sems("pSignalSemaphores", "pSignalSemaphoreValues")
+
+# Split the frame's actions into the submits they were executed in
+def findSubmits(controller, durations):
+	sdfile = controller.GetStructuredFile()
+	submits = []
+	current = [None]
+	# each VkSubmitInfo adds an event for the same vkQueueSubmit chunk, so count them to know which
+	# submit info in the array we're looking at
+	seen = {}
+
+	def walk(action):
+		for event in action.events:
+			if event.chunkIndex >= len(sdfile.chunks):
+				continue
+
+			chunk = sdfile.chunks[event.chunkIndex]
+
+			if chunk.name.startswith("vkQueueSubmit"):
+				index = seen.get(event.chunkIndex, 0)
+				seen[event.chunkIndex] = index + 1
+
+				infos = children(chunk.FindChild("pSubmits"))
+				if index >= len(infos):
+					continue
+
+				waits,signals = submitSemaphores(infos[index])
+				current[0] = Submit(chunk.FindChild("queue").AsResourceId(), len(submits), waits, signals)
+				submits.append(current[0])
+
+		if current[0] is not None and action.eventId in durations:
+			current[0].actions.append((action.eventId, action.GetName(sdfile), durations[action.eventId]))
+
+		for child in action.children:
+			walk(child)
+
+	for action in controller.GetRootActions():
+		walk(action)
+
+	return submits
+
+# Schedule the submits on their queues as soon as their semaphore waits allow, using the durations
+# measured during replay. Returns the idle bubbles where a queue was waiting on another queue.
+def schedule(submits):
+	queueFree = {}
+	# semaphore -> list of (value, time) signals so far
+	signalled = {}
+	bubbles = []
+
+	for s in submits:
+		start = queueFree.get(s.queue, 0.0)
+		waitedOn = None
+
+		for sem,value in s.waits:
+			signals = signalled.get(sem, [])
+			if len(signals) == 0:
+				continue
+
+			# a binary semaphore waits for the most recent signal, a timeline semaphore for the first
+			# signal that reaches the value
+			if value == 0:
+				t = signals[-1][1]
+			else:
+				matching = [sig[1] for sig in signals if sig[0] >= value]
+				if len(matching) == 0:
+					continue
+				t = matching[0]
+
+			if t > start:
+				start = t
+				waitedOn = sem
+
+		idle = start - queueFree.get(s.queue, start)
+		if waitedOn is not None and idle >= MIN_BUBBLE:
+			bubbles.append((s.queue, queueFree.get(s.queue, 0.0), start, waitedOn))
+
+		s.start = start
+		s.end = start + s.duration()
+		queueFree[s.queue] = s.end
+
+		for sem,value in s.signals:
+			signalled.setdefault(sem, []).append((value, s.end))
+
+	return bubbles
+
+def writeTrace(filename, submits, names):
+	queues = []
+	events = []
+
+	for s in submits:
+		if s.queue not in queues:
+			queues.append(s.queue)
+			events.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": queues.index(s.queue),
+			               "args": {"name": names.get(s.queue, str(s.queue))}})
+
+		tid = queues.index(s.queue)
+		t = s.start
+		events.append({"name": "Submit %d" % s.index, "ph": "X", "pid": 0, "tid": tid,
+		               "ts": s.start * 1.0e6, "dur": (s.end - s.start) * 1.0e6})
+		for eventId,name,duration in s.actions:
+			events.append({"name": "EID %d: %s" % (eventId, name), "ph": "X", "pid": 0, "tid": tid,
+			               "ts": t * 1.0e6, "dur": duration * 1.0e6})
+			t += duration
+
+	with open(filename, "w") as f:
+		json.dump({"traceEvents": events}, f)
+
+def sampleCode(controller):
+	if not (rd.GPUCounter.EventGPUDuration in controller.EnumerateCounters()):
+		raise RuntimeError("Implementation doesn't support the GPU duration counter")
+
+	durations = {}
+	for r in controller.FetchCounters([rd.GPUCounter.EventGPUDuration]):
+		durations[r.eventId] = r.value.d
+
+	names = {}
+	for res in controller.GetResources():
+		names[res.resourceId] = res.name
+
+	submits = findSubmits(controller, durations)
+	if len(submits) == 0:
+		print("No queue submits found, this example only supports Vulkan captures")
+		return
+
+	bubbles = schedule(submits)
+
+	frameEnd = max([s.end for s in submits])
+	serial = sum([s.duration() for s in submits])
+
+	print("Serialised GPU time: %.3f ms" % (serial * 1000.0))
+	print("Frame time with queues overlapping: %.3f ms" % (frameEnd * 1000.0))
+	print("")
+
+	for queue in sorted(set([s.queue for s in submits]), key=lambda q: str(q)):
+		busy = sum([s.duration() for s in submits if s.queue == queue])
+		print("%s: busy %.3f ms (%.1f%% of the frame)" % (names.get(queue, str(queue)), busy * 1000.0,
+		                                                  busy * 100.0 / frameEnd if frameEnd > 0 else 0))
+
+		for q,start,end,sem in bubbles:
+			if q == queue:
+				print("    idle %.3f ms from %.3f ms waiting on %s" % ((end - start) * 1000.0, start * 1000.0,
+				                                                     names.get(sem, str(sem))))
+
+	filename = os.path.join(tempfile.gettempdir(), "queue_timeline.json")
+	if len(sys.argv) > 2:
+		filename = sys.argv[2]
+
+	writeTrace(filename, submits, names)
+
+	print("")
+	print("Timeline written to %s" % filename)
+
+def loadCapture(filename):
+	# Open a capture file handle
+	cap = rd.OpenCaptureFile()
+
+	# Open a particular file - see also OpenBuffer to load from memory
+	result = cap.OpenFile(filename, '', None)
+
+	# Make sure the file opened successfully
+	if result != rd.ResultCode.Succeeded:
+		raise RuntimeError("Couldn't open file: " + str(result))
+
+	# Make sure we can replay
+	if not cap.LocalReplaySupport():
+		raise RuntimeError("Capture cannot be replayed")
+
+	# Initialise the replay
+	result,controller = cap.OpenCapture(rd.ReplayOptions(), None)
+
+	if result != rd.ResultCode.Succeeded:
+		raise RuntimeError("Couldn't initialise replay: " + str(result))
+
+	return cap,controller
+
+if 'pyrenderdoc' in globals():
+	pyrenderdoc.Replay().BlockInvoke(sampleCode)
+else:
+	rd.InitialiseReplay(rd.GlobalEnvironment(), [])
+
+	if len(sys.argv) <= 1:
+		print('Usage: python3 {} filename.rdc [timeline.json]'.format(sys.argv[0]))
+		sys.exit(0)
+
+	cap,controller = loadCapture(sys.argv[1])
+
+	sampleCode(controller)
+
+	controller.Shutdown()
+	cap.Shutdown()
+
+	rd.ShutdownReplay()
@@ -0,0 +1,184 @@
+import sys
+import re
+
+# Import renderdoc if not already imported (e.g. in the UI)
+if 'renderdoc' not in sys.modules and '_renderdoc' not in sys.modules:
+	import renderdoc
+
+# Alias renderdoc for legibility
+rd = renderdoc
+
+# Disassembly targets from the driver which include compiler statistics, in order of preference
+STATS_TARGETS = [
+	"AMD_shader_info",                         # VK_AMD_shader_info
+	"KHR_pipeline_executable_properties",      # VK_KHR_pipeline_executable_properties
+]
+
+# If the driver doesn't provide statistics, the AMD shader compiler plugin can compile for a given
+# GPU, e.g. "RDNA2 (gfx1032)". If this is None the newest GPU listed is used
+AMD_ASIC = None
+
+# Lines of the form "; VGPRs: 24 out of 256 used" or "VGPRs: 24      // description"
+STAT_LINE = re.compile(r'^[;\s]*([A-Za-z][A-Za-z0-9 _\-\(\)]*?)\s*[:=]\s*(-?[0-9]+(?:\.[0-9]+)?)\b')
+
+# Statistics we want to show in the table if they're present, matched case-insensitively
+COLUMNS = ["vgpr", "sgpr", "lds", "scratch", "wave", "occupancy", "instruction", "code size"]
+
+def parseStats(disasm):
+	stats = {}
+	for line in disasm.splitlines():
+		m = STAT_LINE.match(line)
+		if m is None:
+			continue
+		name = m.group(1).strip()
+		# only keep the first value for each name
+		if name not in stats:
+			stats[name] = float(m.group(2))
+	return stats
+
+def pickTarget(controller):
+	targets = controller.GetDisassemblyTargets(True)
+	for t in STATS_TARGETS:
+		if t in targets:
+			return t
+
+	# the plugin's GPU targets are listed after AMDIL
+	if "AMDIL" in targets:
+		asics = targets[targets.index("AMDIL") + 1:]
+		if AMD_ASIC in asics:
+			return AMD_ASIC
+		if len(asics) > 0:
+			return asics[-1]
+
+	return None
+
+class PipelineInfo:
+	def __init__(self, pipeline):
+		self.pipeline = pipeline
+		self.draws = 0
+		self.duration = 0.0
+		# stage -> dict of statistics
+		self.stages = {}
+
+def iterActions(actions):
+	for action in actions:
+		if action.flags & (rd.ActionFlags.Drawcall | rd.ActionFlags.Dispatch):
+			yield action
+		for child in iterActions(action.children):
+			yield child
+
+def sampleCode(controller):
+	target = pickTarget(controller)
+	if target is None:
+		print("No disassembly target with statistics is available, targets are: %s" %
+		      ", ".join(controller.GetDisassemblyTargets(True)))
+		return
+
+	durations = {}
+	if rd.GPUCounter.EventGPUDuration in controller.EnumerateCounters():
+		for r in controller.FetchCounters([rd.GPUCounter.EventGPUDuration]):
+			durations[r.eventId] = r.value.d
+
+	names = {}
+	for res in controller.GetResources():
+		names[res.resourceId] = res.name
+
+	pipelines = {}
+	# statistics are cached by pipeline and shader, since several pipelines can share shaders but
+	# the compiled code can differ between them
+	cache = {}
+
+	for action in iterActions(controller.GetRootActions()):
+		controller.SetFrameEvent(action.eventId, False)
+		state = controller.GetPipelineState()
+
+		if action.flags & rd.ActionFlags.Dispatch:
+			pipe = state.GetComputePipelineObject()
+			stages = [rd.ShaderStage.Compute]
+		else:
+			pipe = state.GetGraphicsPipelineObject()
+			stages = [rd.ShaderStage.Vertex, rd.ShaderStage.Hull, rd.ShaderStage.Domain,
+			          rd.ShaderStage.Geometry, rd.ShaderStage.Pixel]
+
+		if pipe == rd.ResourceId.Null():
+			continue
+
+		if pipe not in pipelines:
+			info = PipelineInfo(pipe)
+			pipelines[pipe] = info
+
+			for stage in stages:
+				refl = state.GetShaderReflection(stage)
+				if refl is None:
+					continue
+
+				key = (pipe, refl.resourceId)
+				if key not in cache:
+					cache[key] = parseStats(controller.DisassembleShader(pipe, refl, target))
+				info.stages[stage] = cache[key]
+
+		pipelines[pipe].draws += 1
+		pipelines[pipe].duration += durations.get(action.eventId, 0.0)
+
+	# find which of the interesting statistics this target provides
+	allNames = set()
+	for info in pipelines.values():
+		for stats in info.stages.values():
+			allNames.update(stats.keys())
+
+	columns = []
+	for c in COLUMNS:
+		columns += sorted([n for n in allNames if c in n.lower() and n not in columns])
+
+	print("Statistics from '%s'" % target)
+	print("")
+	print("\t".join(["Pipeline", "Stage", "Actions", "GPU ms"] + columns))
+
+	# most expensive pipelines first, since those are where occupancy matters most
+	for info in sorted(pipelines.values(), key=lambda p: p.duration, reverse=True):
+		for stage,stats in info.stages.items():
+			row = [names.get(info.pipeline, str(info.pipeline)), str(stage), str(info.draws),
+			       "%.3f" % (info.duration * 1000.0)]
+			row += ["%g" % stats[c] if c in stats else "-" for c in columns]
+			print("\t".join(row))
+
+def loadCapture(filename):
+	# Open a capture file handle
+	cap = rd.OpenCaptureFile()
+
+	# Open a particular file - see also OpenBuffer to load from memory
+	result = cap.OpenFile(filename, '', None)
+
+	# Make sure the file opened successfully
+	if result != rd.ResultCode.Succeeded:
+		raise RuntimeError("Couldn't open file: " + str(result))
+
+	# Make sure we can replay
+	if not cap.LocalReplaySupport():
+		raise RuntimeError("Capture cannot be replayed")
+
+	# Initialise the replay
+	result,controller = cap.OpenCapture(rd.ReplayOptions(), None)
+
+	if result != rd.ResultCode.Succeeded:
+		raise RuntimeError("Couldn't initialise replay: " + str(result))
+
+	return cap,controller
+
+if 'pyrenderdoc' in globals():
+	pyrenderdoc.Replay().BlockInvoke(sampleCode)
+else:
+	rd.InitialiseReplay(rd.GlobalEnvironment(), [])
+
+	if len(sys.argv) <= 1:
+		print('Usage: python3 {} filename.rdc'.format(sys.argv[0]))
+		sys.exit(0)
+
+	cap,controller = loadCapture(sys.argv[1])
+
+	sampleCode(controller)
+
+	controller.Shutdown()
+	cap.Shutdown()
+
+	rd.ShutdownReplay()
@@ -0,0 +1,232 @@
+import sys
+
+# Import renderdoc if not already imported (e.g. in the UI)
+if 'renderdoc' not in sys.modules and '_renderdoc' not in sys.modules:
+	import renderdoc
+
+# Alias renderdoc for legibility
+rd = renderdoc
+
+# Substrings of chunk names that set state which stays bound until it's set again
+stateSetters = ["CmdBind", "CmdSet", "CmdPushConstants", "SetPipelineState", "SetGraphicsRoot",
+                "SetComputeRoot", "SetDescriptorHeaps", "IASet", "RSSet", "OMSet"]
+
+# Binding pipelines or root signatures can disturb other bound state, so anything bound after one
+# is never considered redundant
+stateResetters = ["CmdBindPipeline", "CmdBindShaders", "SetPipelineState", "RootSignature"]
+
+# Recording a command buffer or list from the start forgets everything bound in it
+recordStarts = ["BeginCommandBuffer", "ID3D12GraphicsCommandList::Reset"]
+
+barriers = ["CmdPipelineBarrier", "ResourceBarrier"]
+
+# Parameters that select which slot is being set, rather than what is set into it
+slotNames = ["pipelineBindPoint", "firstSet", "firstBinding", "firstViewport", "firstScissor",
+             "firstAttachment", "RootParameterIndex", "StartSlot", "layout", "stageFlags", "offset"]
+
+# Actions that do work a barrier could be protecting
+workFlags = (rd.ActionFlags.Clear | rd.ActionFlags.Drawcall | rd.ActionFlags.Dispatch |
+             rd.ActionFlags.Copy | rd.ActionFlags.Resolve | rd.ActionFlags.GenMips)
+
+VK_PIPELINE_STAGE_ALL_COMMANDS_BIT = 0x10000
+
+categories = ["Redundant state sets", "Duplicate descriptor binds",
+              "Barriers with no work since the last barrier", "Full pipeline barriers"]
+
+def matches(name, needles):
+	for n in needles:
+		if n in name:
+			return True
+	return False
+
+# Turn a structured object into something that can be compared for equality
+def value(obj):
+	t = obj.type.basetype
+
+	if t == rd.SDBasic.Struct or t == rd.SDBasic.Array:
+		return tuple((obj.GetChild(i).name, value(obj.GetChild(i))) for i in range(obj.NumChildren()))
+	if t == rd.SDBasic.String:
+		return obj.AsString()
+	if t == rd.SDBasic.Resource:
+		return str(obj.AsResourceId())
+	if t == rd.SDBasic.SignedInteger:
+		return obj.AsInt64()
+	if t == rd.SDBasic.UnsignedInteger or t == rd.SDBasic.Enum:
+		return obj.AsUInt64()
+	if t == rd.SDBasic.Float:
+		return obj.AsDouble()
+	if t == rd.SDBasic.Boolean:
+		return obj.AsBool()
+	if t == rd.SDBasic.Null:
+		return None
+
+	# The contents of buffers aren't available here, so never consider them equal
+	return object()
+
+# The command buffer or list a chunk is recorded into, which is serialised first
+def recordingTarget(chunk):
+	if chunk.NumChildren() > 0 and chunk.GetChild(0).type.basetype == rd.SDBasic.Resource:
+		return str(chunk.GetChild(0).AsResourceId())
+	return None
+
+def hasAllCommandsStage(obj):
+	if obj.name in ["srcStageMask", "dstStageMask"]:
+		return (obj.AsUInt64() & VK_PIPELINE_STAGE_ALL_COMMANDS_BIT) != 0
+
+	for i in range(obj.NumChildren()):
+		if hasAllCommandsStage(obj.GetChild(i)):
+			return True
+
+	return False
+
+class Analysis:
+	def __init__(self, sdfile):
+		self.sdfile = sdfile
+		# per command buffer, the last value set for each state slot
+		self.bound = {}
+		# per command buffer, whether the last barrier has had no work after it
+		self.barrierPending = {}
+		# per pass, the count of each category
+		self.passes = {}
+		self.passOrder = []
+		# the first few events found for each category
+		self.examples = {}
+
+	def report(self, passName, category, eventId):
+		if passName not in self.passes:
+			self.passes[passName] = {}
+			self.passOrder.append(passName)
+
+		counts = self.passes[passName]
+		counts[category] = counts.get(category, 0) + 1
+
+		examples = self.examples.setdefault(category, [])
+		if len(examples) < 10:
+			examples.append(eventId)
+
+	def processEvent(self, passName, action, event):
+		if event.chunkIndex >= len(self.sdfile.chunks):
+			return
+
+		chunk = self.sdfile.chunks[event.chunkIndex]
+		name = chunk.name
+		cmd = recordingTarget(chunk)
+
+		if matches(name, recordStarts):
+			self.bound[cmd] = {}
+			self.barrierPending[cmd] = False
+			return
+
+		if event.eventId == action.eventId and (action.flags & workFlags):
+			self.barrierPending[cmd] = False
+			return
+
+		if matches(name, barriers):
+			if self.barrierPending.get(cmd, False):
+				self.report(passName, categories[2], event.eventId)
+			if hasAllCommandsStage(chunk):
+				self.report(passName, categories[3], event.eventId)
+			self.barrierPending[cmd] = True
+			return
+
+		if matches(name, stateSetters):
+			bound = self.bound.setdefault(cmd, {})
+
+			if matches(name, stateResetters):
+				for key in [k for k in bound.keys() if not matches(k[0], stateResetters)]:
+					del bound[key]
+
+			slot = [name]
+			contents = []
+			for i in range(chunk.NumChildren()):
+				child = chunk.GetChild(i)
+				if child.name in slotNames:
+					slot.append(value(child))
+				contents.append(value(child))
+
+			slot = tuple(slot)
+			contents = tuple(contents)
+
+			if bound.get(slot) == contents:
+				if "DescriptorSets" in name or "DescriptorTable" in name:
+					self.report(passName, categories[1], event.eventId)
+				else:
+					self.report(passName, categories[0], event.eventId)
+
+			bound[slot] = contents
+
+	def processAction(self, action, passName):
+		for event in action.events:
+			self.processEvent(passName, action, event)
+
+		# Each marker region is counted as its own pass
+		childPass = passName
+		if len(action.children) > 0:
+			childPass = action.GetName(self.sdfile)
+
+		for child in action.children:
+			self.processAction(child, childPass)
+
+def sampleCode(controller):
+	analysis = Analysis(controller.GetStructuredFile())
+
+	for action in controller.GetRootActions():
+		analysis.processAction(action, "Frame")
+
+	if len(analysis.passOrder) == 0:
+		print("Nothing found")
+		return
+
+	for passName in analysis.passOrder:
+		print(passName)
+		for category in categories:
+			count = analysis.passes[passName].get(category, 0)
+			if count > 0:
+				print("  %-50s %d" % (category, count))
+
+	print("")
+	print("Example events:")
+	for category in categories:
+		if category in analysis.examples:
+			print("  %-50s %s" % (category, ", ".join(str(e) for e in analysis.examples[category])))
+
+def loadCapture(filename):
+	# Open a capture file handle
+	cap = rd.OpenCaptureFile()
+
+	# Open a particular file - see also OpenBuffer to load from memory
+	result = cap.OpenFile(filename, '', None)
+
+	# Make sure the file opened successfully
+	if result != rd.ResultCode.Succeeded:
+		raise RuntimeError("Couldn't open file: " + str(result))
+
+	# Make sure we can replay
+	if not cap.LocalReplaySupport():
+		raise RuntimeError("Capture cannot be replayed")
+
+	# Initialise the replay
+	result,controller = cap.OpenCapture(rd.ReplayOptions(), None)
+
+	if result != rd.ResultCode.Succeeded:
+		raise RuntimeError("Couldn't initialise replay: " + str(result))
+
+	return cap,controller
+
+if 'pyrenderdoc' in globals():
+	pyrenderdoc.Replay().BlockInvoke(sampleCode)
+else:
+	rd.InitialiseReplay(rd.GlobalEnvironment(), [])
+
+	if len(sys.argv) <= 1:
+		print('Usage: python3 {} filename.rdc'.format(sys.argv[0]))
+		sys.exit(0)
+
+	cap,controller = loadCapture(sys.argv[1])
+
+	sampleCode(controller)
+
+	controller.Shutdown()
+	cap.Shutdown()
+
+	rd.ShutdownReplay()
@@ -0,0 +1,200 @@
+import sys
+
+# Import renderdoc if not already imported (e.g. in the UI)
+if 'renderdoc' not in sys.modules and '_renderdoc' not in sys.modules:
+	import renderdoc
+
+# Alias renderdoc for legibility
+rd = renderdoc
+
+# Usages which read from a texture's contents
+READ_USAGES = [
+	rd.ResourceUsage.VS_Resource, rd.ResourceUsage.HS_Resource, rd.ResourceUsage.DS_Resource,
+	rd.ResourceUsage.GS_Resource, rd.ResourceUsage.PS_Resource, rd.ResourceUsage.CS_Resource,
+	rd.ResourceUsage.All_Resource,
+	rd.ResourceUsage.VS_RWResource, rd.ResourceUsage.HS_RWResource, rd.ResourceUsage.DS_RWResource,
+	rd.ResourceUsage.GS_RWResource, rd.ResourceUsage.PS_RWResource, rd.ResourceUsage.CS_RWResource,
+	rd.ResourceUsage.All_RWResource,
+	rd.ResourceUsage.InputTarget, rd.ResourceUsage.DepthStencilTarget, rd.ResourceUsage.Indirect,
+	rd.ResourceUsage.ResolveSrc, rd.ResourceUsage.CopySrc, rd.ResourceUsage.GenMips,
+]
+
+# Usages where a shader samples from or loads the texture
+SHADER_USAGES = READ_USAGES[0:14]
+
+# Usages which write to a render target
+TARGET_WRITE_USAGES = [
+	rd.ResourceUsage.ColorTarget, rd.ResourceUsage.Clear, rd.ResourceUsage.CopyDst,
+	rd.ResourceUsage.ResolveDst,
+]
+
+HALF_MAX = 65504.0
+
+# Estimate how many of a texture's bytes are in one mip
+def mipBytes(tex, mip):
+	def texels(m):
+		return max(1, tex.width >> m) * max(1, tex.height >> m) * max(1, tex.depth >> m)
+
+	total = sum([texels(m) for m in range(tex.mips)])
+	return tex.byteSize * texels(mip) // total
+
+def formatBytes(b):
+	for unit,scale in [("GB", 1024**3), ("MB", 1024**2), ("KB", 1024)]:
+		if b >= scale:
+			return "%.2f %s" % (b / scale, unit)
+	return "%d B" % b
+
+# Look at the final contents of a float render target to see if a smaller format would hold it.
+# Returns a list of suggestions and the number of bytes that could be saved
+def checkFormat(controller, tex, lastWrite):
+	fmt = tex.format
+	if fmt.Special() or fmt.compType != rd.CompType.Float or fmt.compByteWidth < 2:
+		return [],0
+
+	controller.SetFrameEvent(lastWrite, True)
+	minval,maxval = controller.GetMinMax(tex.resourceId, rd.Subresource(), rd.CompType.Typeless)
+
+	notes = []
+	used = 0
+	fitsHalf = True
+	fitsUnorm = True
+
+	for c in range(fmt.compCount):
+		lo = minval.floatValue[c]
+		hi = maxval.floatValue[c]
+
+		if lo == hi:
+			notes.append("channel %s is always %g" % ("RGBA"[c], lo))
+			continue
+
+		used += 1
+		if lo < -HALF_MAX or hi > HALF_MAX:
+			fitsHalf = False
+		if lo < 0.0 or hi > 1.0:
+			fitsUnorm = False
+
+	# formats with three channels usually aren't renderable, so those need four
+	channels = 4 if used == 3 else max(used, 1)
+	width = fmt.compByteWidth
+
+	if used > 0 and fitsUnorm and width > 1:
+		notes.append("values are all in [0, 1] so an 8-bit UNORM format may be enough")
+		width = 1
+	elif fitsHalf and width > 2:
+		notes.append("values are all in 16-bit float range")
+		width = 2
+
+	newSize = channels * width
+	if newSize >= fmt.ElementSize():
+		return notes,0
+
+	return notes,tex.byteSize - tex.byteSize * newSize // fmt.ElementSize()
+
+def sampleCode(controller):
+	names = {}
+	for res in controller.GetResources():
+		names[res.resourceId] = res.name
+
+	unused = []
+	neverRead = []
+	unsampledMips = []
+	formats = []
+
+	for tex in controller.GetTextures():
+		# swapchain images are read by presentation
+		if tex.creationFlags & rd.TextureCategory.SwapBuffer:
+			continue
+
+		usage = controller.GetUsage(tex.resourceId)
+		name = names.get(tex.resourceId, str(tex.resourceId))
+
+		if len(usage) == 0:
+			unused.append((tex, name))
+			continue
+
+		reads = [u for u in usage if u.usage in READ_USAGES]
+		if len(reads) == 0:
+			neverRead.append((tex, name))
+			continue
+
+		# without instrumenting the shaders we can't tell which mips are sampled, but a mip chain on
+		# a texture no shader samples from at all is never needed
+		if tex.mips > 1 and len([u for u in usage if u.usage in SHADER_USAGES]) == 0:
+			unsampledMips.append((tex, name, tex.byteSize - mipBytes(tex, 0)))
+
+		writes = [u.eventId for u in usage if u.usage in TARGET_WRITE_USAGES]
+		if tex.creationFlags & rd.TextureCategory.ColorTarget and len(writes) > 0:
+			notes,saved = checkFormat(controller, tex, writes[-1])
+			if len(notes) > 0:
+				formats.append((tex, name, notes, saved))
+
+	wasted = 0
+
+	print("Textures not used in the frame:")
+	for tex,name in unused:
+		print("  %s (%dx%d %s): %s" % (name, tex.width, tex.height, tex.format.Name(), formatBytes(tex.byteSize)))
+		wasted += tex.byteSize
+	print("")
+
+	print("Textures written but never read in the frame:")
+	for tex,name in neverRead:
+		print("  %s (%dx%d %s): %s" % (name, tex.width, tex.height, tex.format.Name(), formatBytes(tex.byteSize)))
+		wasted += tex.byteSize
+	print("")
+
+	print("Textures with mips that are never sampled by a shader:")
+	for tex,name,mipBytes in unsampledMips:
+		print("  %s (%d mips): %s in mips below the first" % (name, tex.mips, formatBytes(mipBytes)))
+		wasted += mipBytes
+	print("")
+
+	print("Render targets which may have wider formats than needed:")
+	for tex,name,notes,saved in formats:
+		print("  %s (%s): could save %s" % (name, tex.format.Name(), formatBytes(saved)))
+		for n in notes:
+			print("    %s" % n)
+		wasted += saved
+	print("")
+
+	print("Total potentially wasted: %s" % formatBytes(wasted))
+
+def loadCapture(filename):
+	# Open a capture file handle
+	cap = rd.OpenCaptureFile()
+
+	# Open a particular file - see also OpenBuffer to load from memory
+	result = cap.OpenFile(filename, '', None)
+
+	# Make sure the file opened successfully
+	if result != rd.ResultCode.Succeeded:
+		raise RuntimeError("Couldn't open file: " + str(result))
+
+	# Make sure we can replay
+	if not cap.LocalReplaySupport():
+		raise RuntimeError("Capture cannot be replayed")
+
+	# Initialise the replay
+	result,controller = cap.OpenCapture(rd.ReplayOptions(), None)
+
+	if result != rd.ResultCode.Succeeded:
+		raise RuntimeError("Couldn't initialise replay: " + str(result))
+
+	return cap,controller
+
+if 'pyrenderdoc' in globals():
+	pyrenderdoc.Replay().BlockInvoke(sampleCode)
+else:
+	rd.InitialiseReplay(rd.GlobalEnvironment(), [])
+
+	if len(sys.argv) <= 1:
+		print('Usage: python3 {} filename.rdc'.format(sys.argv[0]))
+		sys.exit(0)
+
+	cap,controller = loadCapture(sys.argv[1])
+
+	sampleCode(controller)
+
+	controller.Shutdown()
+	cap.Shutdown()
+
+	rd.ShutdownReplay()
@@ -196,6 +196,7 @@ DEFINE_SAFE_EQUALITY(SourceVariableMapping)
 DEFINE_SAFE_EQUALITY(SigParameter)
 DEFINE_SAFE_EQUALITY(TextureDescription)
 DEFINE_SAFE_EQUALITY(ShaderEntryPoint)
+DEFINE_SAFE_EQUALITY(ShaderSearchResult)
 DEFINE_SAFE_EQUALITY(Viewport)
 DEFINE_SAFE_EQUALITY(Scissor)
 DEFINE_SAFE_EQUALITY(ColorBlend)
@@ -527,13 +527,31 @@ struct TypeConversion<bytebuf, false>
   // nicer failure error messages out with the index that failed
   static int ConvertFromPy(PyObject *in, bytebuf &out, int *failIdx)
   {
-    if(!PyBytes_Check(in))
+    if(PyBytes_Check(in))
+    {
+      Py_ssize_t len = PyBytes_Size(in);
+
+      out.resize((size_t)len);
+      memcpy(out.data(), PyBytes_AsString(in), out.size());
+
+      return SWIG_OK;
+    }
+
+    // also accept anything exposing a contiguous buffer - bytearray, memoryview, numpy arrays -
+    // so that scripts don't have to make an intermediate bytes copy just to pass data in
+    if(!PyObject_CheckBuffer(in))
       return SWIG_TypeError;
 
-    Py_ssize_t len = PyBytes_Size(in);
+    Py_buffer view = {};
+    if(PyObject_GetBuffer(in, &view, PyBUF_C_CONTIGUOUS) != 0)
+    {
+      PyErr_Clear();
+      return SWIG_TypeError;
+    }
+
+    out.assign((const byte *)view.buf, (size_t)view.len);
 
-    out.resize((size_t)len);
-    memcpy(out.data(), PyBytes_AsString(in), out.size());
+    PyBuffer_Release(&view);
 
     return SWIG_OK;
   }
@@ -318,6 +318,97 @@ Invalid if the object is not actually a string.
   PyObject *AsString() { return ConvertToPy($self->data.str); }
 }
 
+%extend StructuredChunkList {
+  %feature("docstring") R"(Gathers the values of named fields from every chunk with a given name,
+iterating natively rather than creating a python object for each chunk and parameter.
+
+Field names can refer to nested members by separating names with ``.``, e.g. ``CreateInfo.size``.
+
+:param str chunkName: The name of the chunks to gather from.
+:param List[str] fieldNames: The names of the fields to gather.
+:return: One list per requested field, preceded by a list of the indices of the matching chunks.
+  Each list contains one entry per matching chunk. Basic values are returned as their python
+  equivalent, and fields which are missing or aren't a basic type are returned as ``None``.
+:rtype: List[List]
+)";
+  PyObject *GatherFields(const rdcstr &chunkName, const rdcarray<rdcstr> &fieldNames)
+  {
+    rdcarray<rdcarray<rdcstr>> paths;
+    paths.resize(fieldNames.size());
+    for(size_t f = 0; f < fieldNames.size(); f++)
+    {
+      int32_t start = 0;
+      int32_t dot = fieldNames[f].find('.');
+      while(dot >= 0)
+      {
+        paths[f].push_back(fieldNames[f].substr(start, dot - start));
+        start = dot + 1;
+        dot = fieldNames[f].find('.', start);
+      }
+      paths[f].push_back(fieldNames[f].substr(start));
+    }
+
+    PyObject *indices = PyList_New(0);
+    rdcarray<PyObject *> columns;
+    for(size_t f = 0; f < fieldNames.size(); f++)
+      columns.push_back(PyList_New(0));
+
+    for(size_t c = 0; c < $self->size(); c++)
+    {
+      const SDChunk *chunk = $self->at(c);
+
+      if(chunk->name != chunkName)
+        continue;
+
+      PyObject *idx = ConvertToPy((uint64_t)c);
+      PyList_Append(indices, idx);
+      Py_DecRef(idx);
+
+      for(size_t f = 0; f < paths.size(); f++)
+      {
+        const SDObject *o = chunk;
+        for(size_t p = 0; o && p < paths[f].size(); p++)
+          o = o->FindChild(paths[f][p]);
+
+        PyObject *val = NULL;
+
+        if(o)
+        {
+          switch(o->type.basetype)
+          {
+            case SDBasic::String: val = ConvertToPy(o->data.str); break;
+            case SDBasic::Enum:
+            case SDBasic::UnsignedInteger: val = ConvertToPy(o->data.basic.u); break;
+            case SDBasic::SignedInteger: val = ConvertToPy(o->data.basic.i); break;
+            case SDBasic::Float: val = ConvertToPy(o->data.basic.d); break;
+            case SDBasic::Boolean: val = ConvertToPy(o->data.basic.b); break;
+            case SDBasic::Character: val = ConvertToPy(rdcstr(&o->data.basic.c, 1)); break;
+            case SDBasic::Resource: val = ConvertToPy(o->data.basic.id); break;
+            default: break;
+          }
+        }
+
+        if(!val)
+          val = SWIG_Py_Void();
+
+        PyList_Append(columns[f], val);
+        Py_DecRef(val);
+      }
+    }
+
+    PyObject *ret = PyList_New(0);
+    PyList_Append(ret, indices);
+    Py_DecRef(indices);
+    for(PyObject *col : columns)
+    {
+      PyList_Append(ret, col);
+      Py_DecRef(col);
+    }
+
+    return ret;
+  }
+}
+
 // add python array members that aren't in slots
 EXTEND_ARRAY_CLASS_METHODS(rdcarray)
 EXTEND_ARRAY_CLASS_METHODS(StructuredChunkList)
@@ -372,6 +463,7 @@ TEMPLATE_ARRAY_INSTANTIATE(rdcarray, PathEntry)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, PixelModification)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ResourceDescription)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ResourceId)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, Subresource)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, LineColumnInfo)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, InstructionSourceInfo)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderCompileFlag)
@@ -389,7 +481,9 @@ TEMPLATE_ARRAY_INSTANTIATE(rdcarray, DebugVariableReference)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, SourceVariableMapping)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, SigParameter)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, TextureDescription)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, TextureSave)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderEntryPoint)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderSearchResult)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, Viewport)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, Scissor)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ColorBlend)
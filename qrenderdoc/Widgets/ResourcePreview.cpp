@@ -173,3 +173,9 @@ void ResourcePreview::resizeEvent(QResizeEvent *e)
   emit resized(this);
   QFrame::resizeEvent(e);
 }
+
+void ResourcePreview::showEvent(QShowEvent *e)
+{
+  emit shown(this);
+  QFrame::showEvent(e);
+}
@@ -53,6 +53,7 @@ signals:
   void clicked(QMouseEvent *e);
   void doubleClicked(QMouseEvent *e);
   void resized(ResourcePreview *prev);
+  void shown(ResourcePreview *prev);
 
 public:
   void setSlotName(const QString &n);
@@ -78,6 +79,7 @@ public:
 
 private:
   virtual void resizeEvent(QResizeEvent *event);
+  virtual void showEvent(QShowEvent *event);
 
   Ui::ResourcePreview *ui;
 
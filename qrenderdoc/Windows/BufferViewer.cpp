@@ -858,6 +858,9 @@ public:
   void endReset(const BufferConfiguration &conf)
   {
     config = conf;
+    decodedData = NULL;
+    decodedElement = NULL;
+    decodedList.clear();
     cacheColumns();
     totalColumnCount = columnLookup.count() + reservedColumnCount();
     emit endResetModel();
@@ -1038,9 +1041,7 @@ public:
             data += config.buffers[prop.buffer]->stride * row;
             data += el.byteOffset;
 
-            // only slightly wasteful, we need to fetch all variants together
-            // since some formats are packed and can't be read individually
-            QVariantList list = GetVariants(prop.format, el, data, end);
+            const QVariantList &list = decodeElement(el, prop, data, end);
 
             if(!list.isEmpty())
             {
@@ -1195,9 +1196,7 @@ public:
 
             data += el.byteOffset;
 
-            // only slightly wasteful, we need to fetch all variants together
-            // since some formats are packed and can't be read individually
-            QVariantList list = GetVariants(prop.format, el, data, end);
+            const QVariantList &list = decodeElement(el, prop, data, end);
 
             int comp = componentForIndex(col);
 
@@ -1356,6 +1355,12 @@ private:
   // the total number of columns including any reserved ones like VTX / IDX
   int totalColumnCount = 0;
 
+  // the last element decoded by decodeElement(), cleared on reset since the data and columns it
+  // points into are replaced
+  mutable const byte *decodedData = NULL;
+  mutable const ShaderConstant *decodedElement = NULL;
+  mutable QVariantList decodedList;
+
   // which format element is selected as position data
   int positionEl = -1;
   // which format element is selected as secondary data
@@ -1413,6 +1418,23 @@ private:
     }
   }
 
+  // we need to fetch all variants of an element together since some formats are packed and can't
+  // be read individually. The view requests cells a row at a time, so consecutive requests are
+  // usually for other components of the same element - keep the last decode rather than
+  // repeating it for each component.
+  const QVariantList &decodeElement(const ShaderConstant &el, const BufferElementProperties &prop,
+                                    const byte *data, const byte *end) const
+  {
+    if(data != decodedData || &el != decodedElement)
+    {
+      decodedData = data;
+      decodedElement = &el;
+      decodedList = GetVariants(prop.format, el, data, end);
+    }
+
+    return decodedList;
+  }
+
   QString outOfBounds() const { return lit("---"); }
   QString interpretGeneric(int col, const ShaderConstant &el, const BufferElementProperties &prop) const
   {
@@ -2996,7 +3018,15 @@ void BufferViewer::OnEventChanged(uint32_t eventId)
 
   QPointer<BufferViewer> me(this);
 
-  m_Ctx.Replay().AsyncInvoke([this, me, bufdata](IReplayController *r) {
+  // the replay job is tagged per-viewer so that if the event changes again before it runs, the
+  // queued fetch is replaced instead of fetching data that would only be thrown away. The shared
+  // pointer keeps the population data alive for as long as either job still references it, and
+  // frees it if a job is dropped or goes stale.
+  QSharedPointer<PopulateBufferData> bufdataOwner(bufdata);
+
+  QString tag = lit("bufferdata%1").arg((qulonglong)(void *)this);
+
+  m_Ctx.Replay().AsyncInvoke(tag, [this, me, bufdata, bufdataOwner](IReplayController *r) {
     if(!me)
       return;
 
@@ -3113,7 +3143,7 @@ void BufferViewer::OnEventChanged(uint32_t eventId)
             m_CBufferSlot.slot, m_BufferID, m_ByteOffset, m_ByteSize);
     }
 
-    GUIInvoke::call(this, [this, bufdata]() {
+    GUIInvoke::call(this, [this, bufdata, bufdataOwner]() {
       if(bufdata->sequence != m_Sequence)
         return;
 
@@ -3296,9 +3326,6 @@ void BufferViewer::OnEventChanged(uint32_t eventId)
         }
       }
 
-      // we're done with it, the buffer configurations are individually copied/refcounted
-      delete bufdata;
-
       INVOKE_MEMFN(RT_UpdateAndDisplay);
     });
   });
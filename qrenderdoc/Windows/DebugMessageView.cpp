@@ -42,9 +42,45 @@ public:
   void refresh()
   {
     emit beginResetModel();
+
+    // group identical messages together, so that a message repeated many times in the capture can
+    // be shown once with a count and the range of events it came from
+    const rdcarray<DebugMessage> &msgs = m_Ctx.DebugMessages();
+
+    QHash<QString, int> firstRows;
+    m_GroupFirst.resize(msgs.count());
+    m_GroupCount.fill(0, msgs.count());
+    m_GroupLastEID.fill(0, msgs.count());
+
+    for(int i = 0; i < msgs.count(); i++)
+    {
+      const DebugMessage &msg = msgs[i];
+      QString key = QFormatStr("%1|%2|%3|%4")
+                        .arg((uint32_t)msg.source)
+                        .arg((uint32_t)msg.category)
+                        .arg(msg.messageID)
+                        .arg(QString(msg.description));
+
+      int first = firstRows.value(key, -1);
+      if(first < 0)
+      {
+        first = i;
+        firstRows[key] = i;
+      }
+
+      m_GroupFirst[i] = first;
+      m_GroupCount[first]++;
+      m_GroupLastEID[first] = qMax(m_GroupLastEID[first], msg.eventId);
+    }
+
     emit endResetModel();
   }
 
+  bool isDuplicateRow(int row) const
+  {
+    return row >= 0 && row < m_GroupFirst.count() && m_GroupFirst[row] != row;
+  }
+
   QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override
   {
     if(row < 0 || row >= rowCount())
@@ -58,7 +94,7 @@ public:
   {
     return m_Ctx.DebugMessages().count();
   }
-  int columnCount(const QModelIndex &parent = QModelIndex()) const override { return 6; }
+  int columnCount(const QModelIndex &parent = QModelIndex()) const override { return 7; }
   Qt::ItemFlags flags(const QModelIndex &index) const override
   {
     if(!index.isValid())
@@ -78,7 +114,8 @@ public:
         case 2: return lit("Severity");
         case 3: return lit("Category");
         case 4: return lit("ID");
-        case 5: return lit("Description");
+        case 5: return lit("Count");
+        case 6: return lit("Description");
         default: break;
       }
     }
@@ -107,6 +144,14 @@ public:
           case 3: return ToQStr(msg.category);
           case 4: return msg.messageID;
           case 5:
+          {
+            const int first = row < m_GroupFirst.count() ? m_GroupFirst[row] : row;
+            const int count = first < m_GroupCount.count() ? m_GroupCount[first] : 1;
+            if(sort || count <= 1)
+              return count;
+            return QFormatStr("%1 (last EID %2)").arg(count).arg(m_GroupLastEID[first]);
+          }
+          case 6:
           {
             QVariant desc = msg.description;
             RichResourceTextInitialise(desc, &m_Ctx, true);
@@ -126,6 +171,12 @@ public:
 
 private:
   ICaptureContext &m_Ctx;
+
+  // for each message, the row of the first identical message
+  QVector<int> m_GroupFirst;
+  // on the first row of each group, the number of messages in it and the last event they came from
+  QVector<int> m_GroupCount;
+  QVector<uint32_t> m_GroupLastEID;
 };
 
 class DebugMessageFilterModel : public QSortFilterProxyModel
@@ -148,6 +199,7 @@ public:
   QList<MessageType> m_HiddenTypes;
 
   bool showHidden = false;
+  bool collapseDuplicates = true;
 
   void refresh() { invalidateFilter(); }
   QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override
@@ -175,6 +227,10 @@ protected:
   {
     const DebugMessage &msg = m_Ctx.DebugMessages()[sourceRow];
 
+    if(collapseDuplicates &&
+       ((const DebugMessageItemModel *)sourceModel())->isDuplicateRow(sourceRow))
+      return false;
+
     if(m_HiddenSources.contains(msg.source))
       return false;
 
@@ -228,14 +284,18 @@ DebugMessageView::DebugMessageView(ICaptureContext &ctx, QWidget *parent)
   m_ContextMenu = new QMenu(this);
 
   m_ShowHidden = new QAction(tr("Show hidden rows"), this);
+  m_CollapseDuplicates = new QAction(tr("Collapse duplicate messages"), this);
   m_ToggleSource = new QAction(QString(), this);
   m_ToggleSeverity = new QAction(QString(), this);
   m_ToggleCategory = new QAction(QString(), this);
   m_ToggleMessageType = new QAction(QString(), this);
 
   m_ShowHidden->setCheckable(true);
+  m_CollapseDuplicates->setCheckable(true);
+  m_CollapseDuplicates->setChecked(m_FilterModel->collapseDuplicates);
 
   m_ContextMenu->addAction(m_ShowHidden);
+  m_ContextMenu->addAction(m_CollapseDuplicates);
   m_ContextMenu->addSeparator();
   m_ContextMenu->addAction(m_ToggleSource);
   m_ContextMenu->addAction(m_ToggleSeverity);
@@ -243,6 +303,8 @@ DebugMessageView::DebugMessageView(ICaptureContext &ctx, QWidget *parent)
   m_ContextMenu->addAction(m_ToggleMessageType);
 
   QObject::connect(m_ShowHidden, &QAction::triggered, this, &DebugMessageView::messages_toggled);
+  QObject::connect(m_CollapseDuplicates, &QAction::triggered, this,
+                   &DebugMessageView::messages_toggled);
   QObject::connect(m_ToggleSource, &QAction::triggered, this, &DebugMessageView::messages_toggled);
   QObject::connect(m_ToggleSeverity, &QAction::triggered, this, &DebugMessageView::messages_toggled);
   QObject::connect(m_ToggleCategory, &QAction::triggered, this, &DebugMessageView::messages_toggled);
@@ -306,6 +368,11 @@ void DebugMessageView::messages_toggled()
     m_FilterModel->showHidden = !m_FilterModel->showHidden;
     m_ShowHidden->setChecked(m_FilterModel->showHidden);
   }
+  else if(action == m_CollapseDuplicates)
+  {
+    m_FilterModel->collapseDuplicates = !m_FilterModel->collapseDuplicates;
+    m_CollapseDuplicates->setChecked(m_FilterModel->collapseDuplicates);
+  }
   else if(action == m_ToggleSource)
   {
     if(m_FilterModel->m_HiddenSources.contains(m_ContextMessage.source))
@@ -73,6 +73,7 @@ private:
   DebugMessage m_ContextMessage;
   QMenu *m_ContextMenu;
   QAction *m_ShowHidden;
+  QAction *m_CollapseDuplicates;
   QAction *m_ToggleSource;
   QAction *m_ToggleSeverity;
   QAction *m_ToggleCategory;
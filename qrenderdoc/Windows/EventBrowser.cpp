@@ -232,6 +232,7 @@ struct EventItemModel : public QAbstractItemModel
     m_RowInParentCache.clear();
     m_MessageCounts.clear();
     m_EIDNameCache.clear();
+    m_FindRefinable = false;
     m_Actions.clear();
     m_Chunks.clear();
     m_Times.clear();
@@ -260,6 +261,7 @@ struct EventItemModel : public QAbstractItemModel
 
     m_MessageCounts[eid] = m_Ctx.CurPipelineState().GetShaderMessages().count();
     m_EIDNameCache.remove(eid);
+    m_FindRefinable = false;
 
     if(eid != data(m_CurrentEID, ROLE_SELECTED_EID) || eid == 0)
     {
@@ -292,6 +294,7 @@ struct EventItemModel : public QAbstractItemModel
 
     if(m_Ctx.ResourceNameCacheID() != m_RenameCacheID)
     {
+      m_FindRefinable = false;
       m_View->viewport()->update();
     }
 
@@ -348,6 +351,7 @@ struct EventItemModel : public QAbstractItemModel
       m_ShowParameterNames = show;
 
       m_EIDNameCache.clear();
+      m_FindRefinable = false;
       m_View->viewport()->update();
     }
   }
@@ -360,6 +364,7 @@ struct EventItemModel : public QAbstractItemModel
       m_ShowAllParameters = show;
 
       m_EIDNameCache.clear();
+      m_FindRefinable = false;
       m_View->viewport()->update();
     }
   }
@@ -372,6 +377,7 @@ struct EventItemModel : public QAbstractItemModel
       m_UseCustomActionNames = use;
 
       m_EIDNameCache.clear();
+      m_FindRefinable = false;
       m_View->viewport()->update();
     }
   }
@@ -395,6 +401,11 @@ struct EventItemModel : public QAbstractItemModel
     rdcarray<QModelIndex> oldResults;
     oldResults.swap(m_FindResults);
 
+    // when typing, each new string usually contains the previous one. Any name that matches it
+    // must also have matched before, so we only need to re-check the previous results.
+    const bool refine = m_FindRefinable && !m_FindEIDSearch && !m_FindString.isEmpty() &&
+                        text.contains(m_FindString, Qt::CaseInsensitive);
+
     m_FindString = text;
     m_FindResults.clear();
 
@@ -424,10 +435,22 @@ struct EventItemModel : public QAbstractItemModel
 
     if(!m_FindString.isEmpty() && !eidSearch)
     {
-      // do a depth-first search to find results
-      AccumulateFindResults(createIndex(0, 0, TagRoot));
+      if(refine)
+      {
+        // the previous results are already in depth-first order
+        for(QModelIndex i : oldResults)
+          if(data(i).toString().contains(m_FindString, Qt::CaseInsensitive))
+            m_FindResults.push_back(i);
+      }
+      else
+      {
+        // do a depth-first search to find results
+        AccumulateFindResults(createIndex(0, 0, TagRoot));
+      }
     }
 
+    m_FindRefinable = !eidSearch;
+
     for(QModelIndex i : oldResults)
       RefreshIcon(i);
     for(QModelIndex i : m_FindResults)
@@ -966,6 +989,9 @@ private:
 
   // needs to be mutable because we update this inside data()
   mutable QMap<uint32_t, QVariant> m_EIDNameCache;
+  // whether m_FindResults is a complete name search against the current names, so a search for a
+  // longer string can be answered from it. Any change to the names invalidates it.
+  bool m_FindRefinable = false;
 
   void AccumulateFindResults(QModelIndex root)
   {
@@ -1458,12 +1484,17 @@ public:
           };
     }
   }
-  void ResetCache() { m_VisibleCache.clear(); }
+  void ResetCache()
+  {
+    m_VisibleCache.clear();
+    m_SubtreeCache.clear();
+  }
   ParseTrace ParseExpressionToFilters(QString expr, rdcarray<EventFilter> &filters) const;
 
   void SetFilters(const rdcarray<EventFilter> &filters)
   {
     m_VisibleCache.clear();
+    m_SubtreeCache.clear();
     m_Filters = filters;
     invalidateFilter();
   }
@@ -1506,7 +1537,13 @@ public:
     return ret;
   }
 
-  void SetEmptyRegionsVisible(bool visible) { m_EmptyRegionsVisible = visible; }
+  void SetEmptyRegionsVisible(bool visible)
+  {
+    // whether a region has a visible descendant depends on this, so forget any cached results
+    if(m_EmptyRegionsVisible != visible)
+      m_SubtreeCache.clear();
+    m_EmptyRegionsVisible = visible;
+  }
   static bool RegisterEventFilterFunction(const rdcstr &name, const rdcstr &description,
                                           IEventBrowser::EventFilterCallback filter,
                                           IEventBrowser::FilterParseCallback parser,
@@ -1544,11 +1581,24 @@ protected:
       return true;
 
     QModelIndex idx = sourceModel()->index(source_row, 0, source_parent);
-    for(int i = 0, row_count = sourceModel()->rowCount(idx); i < row_count; i++)
-      if(filterAcceptsRow(i, idx))
-        return true;
+    int row_count = sourceModel()->rowCount(idx);
+    if(row_count == 0)
+      return false;
 
-    return false;
+    // the proxy model calls this for every row at every level, so without caching each region's
+    // subtree would be walked again for every ancestor.
+    uint32_t eid = sourceModel()->data(idx, ROLE_SELECTED_EID).toUInt();
+
+    m_SubtreeCache.resize_for_index(eid);
+    if(m_SubtreeCache[eid] != 0)
+      return m_SubtreeCache[eid] > 0;
+
+    bool ret = false;
+    for(int i = 0; i < row_count && !ret; i++)
+      ret = filterAcceptsRow(i, idx);
+
+    m_SubtreeCache[eid] = ret ? 1 : -1;
+    return ret;
   }
 
   virtual bool filterAcceptsSingleRow(int source_row, const QModelIndex &source_parent) const
@@ -1602,6 +1652,8 @@ private:
   // false. This means we can resize it and know that we don't pollute with bad data.
   // it must be mutable since we update it in a const function filterAcceptsRow.
   mutable rdcarray<int8_t> m_VisibleCache;
+  // the same for whether any descendant of a row passes, for rows with children
+  mutable rdcarray<int8_t> m_SubtreeCache;
 
   EventItemModel *m_Model = NULL;
 
@@ -1450,6 +1450,10 @@ ScintillaEdit *ShaderViewer::MakeEditor(const QString &name, const QString &text
   ret->setScrollWidth(1);
   ret->setScrollWidthTracking(true);
 
+  // disassembly can run to hundreds of thousands of lines. Only style what's visible up front and
+  // do the rest when idle, so that setting the text or jumping to the end doesn't lex everything
+  ret->setIdleStyling(SC_IDLESTYLING_ALL);
+
   ret->colourise(0, -1);
 
   SetTextAndUpdateMargin0(ret, text);
@@ -1461,7 +1465,14 @@ ScintillaEdit *ShaderViewer::MakeEditor(const QString &name, const QString &text
 
 void ShaderViewer::SetTextAndUpdateMargin0(ScintillaEdit *sc, const QString &text)
 {
-  sc->setText(text.toUtf8().data());
+  SetTextAndUpdateMargin0(sc, rdcstr(text));
+}
+
+void ShaderViewer::SetTextAndUpdateMargin0(ScintillaEdit *sc, const rdcstr &text)
+{
+  // text from the replay is already UTF-8, so pass it straight through rather than converting to
+  // a QString and back, which is significant for large disassembly
+  sc->setText(text.c_str());
 
   int numLines = sc->lineCount();
 
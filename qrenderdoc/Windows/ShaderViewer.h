@@ -343,6 +343,7 @@ private:
 
   ScintillaEdit *MakeEditor(const QString &name, const QString &text, int lang);
   void SetTextAndUpdateMargin0(ScintillaEdit *ret, const QString &text);
+  void SetTextAndUpdateMargin0(ScintillaEdit *ret, const rdcstr &text);
 
   ScintillaEdit *AddFileScintilla(const QString &name, const QString &text, ShaderEncoding encoding);
 
@@ -24,6 +24,9 @@
 
 #include "StatisticsViewer.h"
 #include <QFontDatabase>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include "Code/QRDUtils.h"
 #include "ui_StatisticsViewer.h"
 
@@ -683,6 +686,64 @@ void StatisticsViewer::AppendAPICallSummary()
   m_Report += tr("\tOutput set calls: %1\n").arg(numOutputSets);
 }
 
+void StatisticsViewer::AppendChunkStatistics()
+{
+  ICaptureAccess *access = m_Ctx.Replay().GetCaptureAccess();
+
+  if(!access)
+    return;
+
+  int idx = access->FindSectionByType(SectionType::ChunkStatistics);
+
+  if(idx < 0)
+    return;
+
+  bytebuf buf = access->GetSectionContents(idx);
+
+  QJsonDocument doc = QJsonDocument::fromJson(QByteArray((const char *)buf.data(), buf.count()));
+  QJsonArray chunks = doc.object()[lit("chunks")].toArray();
+
+  if(chunks.isEmpty())
+    return;
+
+  // show the most expensive calls first
+  QList<QJsonObject> sorted;
+  for(const QJsonValue &c : chunks)
+    sorted.push_back(c.toObject());
+
+  std::sort(sorted.begin(), sorted.end(), [](const QJsonObject &a, const QJsonObject &b) {
+    return a[lit("count")].toDouble() * a[lit("meanDurationMicro")].toDouble() >
+           b[lit("count")].toDouble() * b[lit("meanDurationMicro")].toDouble();
+  });
+
+  m_Report.append(tr("\n*** API Call Timings (recorded at capture time) ***\n\n"));
+  m_Report.append(QFormatStr("%1 %2 %3 %4 %5 %6 %7 %8\n")
+                      .arg(tr("Call"), -40)
+                      .arg(tr("Count"), 8)
+                      .arg(tr("Bytes"), 12)
+                      .arg(tr("Total ms"), 10)
+                      .arg(tr("Min us"), 10)
+                      .arg(tr("Mean us"), 10)
+                      .arg(tr("p99 us"), 10)
+                      .arg(tr("Max us"), 10));
+
+  for(const QJsonObject &c : sorted)
+  {
+    double count = c[lit("count")].toDouble();
+    double mean = c[lit("meanDurationMicro")].toDouble();
+
+    m_Report.append(QFormatStr("%1 %2 %3 %4 %5 %6 %7 %8\n")
+                        .arg(c[lit("name")].toString(), -40)
+                        .arg((qulonglong)count, 8)
+                        .arg((qulonglong)c[lit("bytes")].toDouble(), 12)
+                        .arg(count * mean / 1000.0, 10, 'f', 3)
+                        .arg(c[lit("minDurationMicro")].toDouble(), 10, 'f', 2)
+                        .arg(mean, 10, 'f', 2)
+                        .arg(c[lit("p99DurationMicro")].toDouble(), 10, 'f', 2)
+                        .arg(c[lit("maxDurationMicro")].toDouble(), 10, 'f', 2));
+  }
+}
+
 void StatisticsViewer::GenerateReport()
 {
   const rdcarray<ActionDescription> &curActions = m_Ctx.CurRootActions();
@@ -813,6 +874,8 @@ void StatisticsViewer::GenerateReport()
   m_Report.append(load);
 
   AppendDetailedInformation();
+
+  AppendChunkStatistics();
 }
 
 StatisticsViewer::StatisticsViewer(ICaptureContext &ctx, QWidget *parent)
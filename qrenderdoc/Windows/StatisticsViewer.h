@@ -69,5 +69,6 @@ private:
   void CountContributingEvents(const ActionDescription &action, uint32_t &drawCount,
                                uint32_t &dispatchCount, uint32_t &diagnosticCount);
   void AppendAPICallSummary();
+  void AppendChunkStatistics();
   void GenerateReport();
 };
@@ -2056,6 +2056,11 @@ ResourcePreview *TextureViewer::UI_CreateThumbnail(ThumbnailStrip *strip)
   QObject::connect(prev, &ResourcePreview::clicked, this, &TextureViewer::thumb_clicked);
   QObject::connect(prev, &ResourcePreview::doubleClicked, this, &TextureViewer::thumb_doubleClicked);
   QObject::connect(prev, &ResourcePreview::resized, this, &TextureViewer::UI_PreviewResized);
+  QObject::connect(prev, &ResourcePreview::shown, this, [this](ResourcePreview *p) {
+    // render any thumbnail that was skipped while hidden
+    if(p->property("stale").toBool())
+      GUIInvoke::call(p, [this, p] { UI_PreviewResized(p); });
+  });
 
   prev->setActive(false);
   strip->addThumb(prev);
@@ -2498,6 +2503,16 @@ void TextureViewer::InitResourcePreview(ResourcePreview *prev, BoundResource res
 
 void TextureViewer::UI_PreviewResized(ResourcePreview *prev)
 {
+  // don't render thumbnails that can't be seen, e.g. while the texture viewer is in a hidden tab.
+  // They're rendered when shown instead.
+  if(!prev->isVisible())
+  {
+    prev->setProperty("stale", true);
+    return;
+  }
+
+  prev->setProperty("stale", false);
+
   QSize s = prev->GetThumbSize();
 
   ResourceId id = prev->property("id").value<ResourceId>();
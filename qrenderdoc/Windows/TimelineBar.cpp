@@ -789,14 +789,27 @@ void TimelineBar::paintEvent(QPaintEvent *e)
     qreal leftClip = -triRadius * 2.0;
     qreal rightClip = pipsRect.width() + triRadius * 10.0;
 
+    // history and usage are both sorted by event, and event positions increase monotonically, so
+    // skip straight to the first visible event and stop after the last rather than visiting them
+    // all.
+    auto pipPos = [this, triRadius](uint32_t eid) {
+      return offsetOf(eid) + m_eidWidth / 2 - triRadius;
+    };
+
     if(!m_HistoryEvents.isEmpty())
     {
-      for(const PixelModification &mod : m_HistoryEvents)
+      auto first = std::lower_bound(m_HistoryEvents.begin(), m_HistoryEvents.end(), leftClip,
+                                    [&pipPos](const PixelModification &mod, qreal clip) {
+                                      return pipPos(mod.eventId) < clip;
+                                    });
+
+      for(auto it = first; it != m_HistoryEvents.end(); ++it)
       {
-        qreal pos = offsetOf(mod.eventId) + m_eidWidth / 2 - triRadius;
+        const PixelModification &mod = *it;
+        qreal pos = pipPos(mod.eventId);
 
-        if(pos < leftClip || pos > rightClip)
-          continue;
+        if(pos > rightClip)
+          break;
 
         if(mod.Passed())
           pipranges[HistoryPassed].push(pos, triRadius);
@@ -806,12 +819,17 @@ void TimelineBar::paintEvent(QPaintEvent *e)
     }
     else
     {
-      for(const EventUsage &use : m_UsageEvents)
+      auto first = std::lower_bound(
+          m_UsageEvents.begin(), m_UsageEvents.end(), leftClip,
+          [&pipPos](const EventUsage &use, qreal clip) { return pipPos(use.eventId) < clip; });
+
+      for(auto it = first; it != m_UsageEvents.end(); ++it)
       {
-        qreal pos = offsetOf(use.eventId) + m_eidWidth / 2 - triRadius;
+        const EventUsage &use = *it;
+        qreal pos = pipPos(use.eventId);
 
-        if(pos < leftClip || pos > rightClip)
-          continue;
+        if(pos > rightClip)
+          break;
 
         if(((int)use.usage >= (int)ResourceUsage::VS_RWResource &&
             (int)use.usage <= (int)ResourceUsage::All_RWResource) ||
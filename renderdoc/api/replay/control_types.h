@@ -112,6 +112,34 @@ An empty string indicates no errors/problems.
 
 DECLARE_REFLECTION_STRUCT(MeshFormat);
 
+DOCUMENT(R"(Statistics about the cache of post-transform vertex data used by
+:meth:`ReplayController.GetPostVSData` and mesh rendering.
+
+The cached data is held in GPU memory. Once the cache is over its budget the least recently used
+events are released, and will be fetched again if they are needed later.
+)");
+struct PostVSCacheStatistics
+{
+  PostVSCacheStatistics() = default;
+  PostVSCacheStatistics(const PostVSCacheStatistics &) = default;
+  PostVSCacheStatistics &operator=(const PostVSCacheStatistics &) = default;
+
+  DOCUMENT("The number of requests for an event's data that were served from the cache.");
+  uint64_t hits = 0;
+  DOCUMENT("The number of requests for an event's data that had to replay to fetch it.");
+  uint64_t misses = 0;
+  DOCUMENT("The number of events that have been released to keep the cache within its budget.");
+  uint64_t evictions = 0;
+  DOCUMENT("The number of bytes of GPU memory currently used by the cache.");
+  uint64_t bytesUsed = 0;
+  DOCUMENT("The budget in bytes for the cache, or 0 if it is unlimited.");
+  uint64_t budget = 0;
+  DOCUMENT("The number of events currently in the cache.");
+  uint32_t entries = 0;
+};
+
+DECLARE_REFLECTION_STRUCT(PostVSCacheStatistics);
+
 struct ICamera;
 
 DOCUMENT(R"(
@@ -604,6 +632,30 @@ struct NewChildData
 
 DECLARE_REFLECTION_STRUCT(NewChildData);
 
+DOCUMENT("Frame timing and memory statistics from the target, sampled roughly once a second.");
+struct FrameStatsData
+{
+  DOCUMENT("");
+  FrameStatsData() = default;
+  FrameStatsData(const FrameStatsData &) = default;
+  FrameStatsData &operator=(const FrameStatsData &) = default;
+
+  DOCUMENT("The average frame time, in milliseconds.");
+  double averageMS = 0.0;
+  DOCUMENT("The shortest frame time, in milliseconds.");
+  double minimumMS = 0.0;
+  DOCUMENT("The longest frame time, in milliseconds.");
+  double maximumMS = 0.0;
+  DOCUMENT("The total memory used by the target process, in bytes.");
+  uint64_t processMemory = 0;
+  DOCUMENT(R"(The memory tracked by RenderDoc's own accounting in the target process, in bytes. This
+covers large allocations such as serialised chunk data and GPU-side readback and initial contents.
+)");
+  uint64_t accountedMemory = 0;
+};
+
+DECLARE_REFLECTION_STRUCT(FrameStatsData);
+
 DOCUMENT("A message from a target control connection.");
 struct TargetControlMessage
 {
@@ -639,6 +691,12 @@ struct TargetControlMessage
 )");
   NewChildData newChild;
 
+  DOCUMENT(R"(The frame timing data.
+
+:type: FrameStatsData
+)");
+  FrameStatsData frameStats;
+
   DOCUMENT(R"(The progress of an on-going capture.
 
 When valid, will be in the range of 0.0 to 1.0 (0 - 100%). If not valid when a capture isn't going
@@ -1057,4 +1115,6 @@ DECLARE_REFLECTION_STRUCT(ExecuteResult);
 // name.
 typedef std::function<bool()> RENDERDOC_KillCallback;
 typedef std::function<void(float)> RENDERDOC_ProgressCallback;
+typedef std::function<void(uint32_t)> RENDERDOC_EventCallback;
+typedef std::function<void(uint32_t, const bytebuf &)> RENDERDOC_TextureDataCallback;
 typedef std::function<WindowingData(bool, const rdcarray<WindowingSystem> &)> RENDERDOC_PreviewWindowCallback;
@@ -1589,6 +1589,10 @@ struct ActionDescription
   ActionDescription() = default;
   ActionDescription(const ActionDescription &) = default;
   ActionDescription &operator=(const ActionDescription &) = default;
+#if !defined(SWIG)
+  ActionDescription(ActionDescription &&) = default;
+  ActionDescription &operator=(ActionDescription &&) = default;
+#endif
 
   DOCUMENT(R"(Returns whether or not this action corresponds to a fake marker added by
 :meth:`ReplayController.AddFakeMarkers`.
@@ -2217,6 +2221,54 @@ pixel.
 
 DECLARE_REFLECTION_STRUCT(PixelModification);
 
+DOCUMENT(R"(The events that modified each pixel in a rectangular region of a texture.
+
+The per-pixel lists are packed into flat arrays. :data:`pixelOffsets` has one entry for each pixel
+in row-major order, plus a final entry. The events for pixel ``(x + i, y + j)`` are the entries in
+:data:`eventIds` and :data:`fragments` from ``pixelOffsets[j * width + i]`` up to but not including
+``pixelOffsets[j * width + i + 1]``, in the order the events happened.
+
+For the full details of every modification to one pixel, such as the values before and after each
+fragment, use :meth:`ReplayController.PixelHistory` on that pixel.
+)");
+struct PixelRegionHistory
+{
+  DOCUMENT("");
+  PixelRegionHistory() = default;
+  PixelRegionHistory(const PixelRegionHistory &) = default;
+  PixelRegionHistory &operator=(const PixelRegionHistory &) = default;
+
+  DOCUMENT("The x co-ordinate of the top-left of the region.");
+  uint32_t x = 0;
+  DOCUMENT("The y co-ordinate of the top-left of the region.");
+  uint32_t y = 0;
+  DOCUMENT("The width of the region in pixels.");
+  uint32_t width = 0;
+  DOCUMENT("The height of the region in pixels.");
+  uint32_t height = 0;
+
+  DOCUMENT(R"(The index of the first entry for each pixel, plus the total number of entries.
+
+:type: List[int]
+)");
+  rdcarray<uint32_t> pixelOffsets;
+  DOCUMENT(R"(The :data:`eventId <APIEvent.eventId>` of each entry.
+
+:type: List[int]
+)");
+  rdcarray<uint32_t> eventIds;
+  DOCUMENT(R"(The number of fragments each entry's event rasterised at the pixel.
+
+This is 0 if the event was not a draw, such as a clear, copy or shader write, or if its fragments
+could not be counted.
+
+:type: List[int]
+)");
+  rdcarray<uint32_t> fragments;
+};
+
+DECLARE_REFLECTION_STRUCT(PixelRegionHistory);
+
 DOCUMENT("Contains the bytes and metadata describing a thumbnail.");
 struct Thumbnail
 {
@@ -41,6 +41,10 @@ struct rdcflatmap
     return unsorted_erase(id);
   }
   void erase(rdcpair<Key, Value> *it) { storage.erase(it - begin()); }
+  void erase(rdcpair<Key, Value> *first, rdcpair<Key, Value> *last)
+  {
+    storage.erase(first - begin(), last - first);
+  }
   Value &operator[](const Key &id)
   {
     if(sorted)
@@ -412,6 +412,23 @@ well as control the replay and analysis functionality available.
 
   :param float progress: The latest progress amount.
 
+.. function:: EventCallback()
+
+  Not an actual member function - the signature for any ``EventCallback`` callbacks.
+
+  Called by :meth:`ReplayController.VisitEvents` once the replay has been moved to each event.
+
+  :param int eventId: The :data:`eventId <APIEvent.eventId>` the replay is now at.
+
+.. function:: TextureDataCallback()
+
+  Not an actual member function - the signature for any ``TextureDataCallback`` callbacks.
+
+  Called by :meth:`ReplayController.GetTextureDataBatch` with the contents of each subresource.
+
+  :param int index: The index in the requested list of the subresource this data is for.
+  :param bytes data: The subresource contents, or empty if it couldn't be read back.
+
 .. function:: PreviewWindowCallback()
 
   Not an actual member function - the signature for any ``PreviewWindowCallback`` callbacks.
@@ -491,6 +508,29 @@ function must be called from another thread.
 )");
   virtual void SetFrameEvent(uint32_t eventId, bool force) = 0;
 
+  DOCUMENT(R"(Move the replay through a list of events in frame order, calling a callback at each
+one with the replay in the same state as if :meth:`SetFrameEvent` had been called with that event.
+
+Inside the callback any query of the current state such as :meth:`GetPipelineState`,
+:meth:`GetBufferData` or :meth:`GetPostVSData` can be made. This is much faster than calling
+:meth:`SetFrameEvent` for each event in turn, because the replay continues on from the previous
+event where possible instead of replaying the frame from the start each time, and outputs aren't
+updated for every event along the way.
+
+The events are visited in increasing order regardless of the order in the list, and duplicates are
+only visited once. Once this function returns the replay is left at the last event visited, and any
+outputs are updated to match.
+
+.. note::
+  Calling :meth:`SetFrameEvent` or any function which itself replays the capture, such as
+  :meth:`DebugPixel` or :meth:`PixelHistory`, from the callback is allowed, but will prevent the
+  replay from continuing on from that point for the next event.
+
+:param List[int] eventIds: The :data:`eventIds <APIEvent.eventId>` to visit.
+:param EventCallback callback: The callback to call at each event.
+)");
+  virtual void VisitEvents(const rdcarray<uint32_t> &eventIds, RENDERDOC_EventCallback callback) = 0;
+
   DOCUMENT(R"(Retrieve the current :class:`D3D11State` pipeline state.
 
 The return value will be ``None`` if the capture is not using the D3D11 API.
@@ -549,6 +589,52 @@ capture's API.
 )");
   virtual const PipeState &GetPipelineState() = 0;
 
+  DOCUMENT(R"(Retrieve the contents of a range of descriptors in a descriptor set bound at the
+current event.
+
+This returns the same data as :data:`VKDescriptorBinding.binds` in the :class:`VKState` pipeline
+state, but only for the requested elements. For very large descriptor arrays this avoids iterating
+or copying every element when only a few are needed.
+
+The result will be empty if the capture is not using the Vulkan API, or if the set or binding
+doesn't exist. If the range extends past the end of the binding, only the elements up to the end
+are returned.
+
+See also :meth:`GetVulkanUsedDescriptors`.
+
+:param bool compute: ``True`` to look up the set bound to the compute pipeline, ``False`` for the
+  graphics pipeline.
+:param int set: The index of the bound descriptor set.
+:param int binding: The binding within the descriptor set.
+:param int firstElement: The first array element to return.
+:param int count: The number of array elements to return.
+:return: The descriptor contents, one for each array element in the range.
+:rtype: List[VKBindingElement]
+)");
+  virtual rdcarray<VKPipe::BindingElement> GetVulkanDescriptors(bool compute, uint32_t set,
+                                                                uint32_t binding,
+                                                                uint32_t firstElement,
+                                                                uint32_t count) = 0;
+
+  DOCUMENT(R"(Retrieve the array elements of a binding in a descriptor set bound at the current
+event that were dynamically used, according to the shader feedback for the event.
+
+If no feedback is available for the event, or the binding isn't arrayed, every element is
+considered used and all indices are returned. See :data:`VKBindingElement.dynamicallyUsed`.
+
+Combined with :meth:`GetVulkanDescriptors` this allows visiting only the descriptors that were used
+in a large bindless array.
+
+:param bool compute: ``True`` to look up the set bound to the compute pipeline, ``False`` for the
+  graphics pipeline.
+:param int set: The index of the bound descriptor set.
+:param int binding: The binding within the descriptor set.
+:return: The sorted array indices of the dynamically used elements.
+:rtype: List[int]
+)");
+  virtual rdcarray<uint32_t> GetVulkanUsedDescriptors(bool compute, uint32_t set,
+                                                      uint32_t binding) = 0;
+
   DOCUMENT(R"(Retrieve the list of possible disassembly targets for :meth:`DisassembleShader`. The
 values are implementation dependent but will always include a default target first which is the
 native disassembly of the shader. Further options may be available for additional diassembly views
@@ -843,6 +929,22 @@ only ever have one result (only one entry point per shader).
   virtual const ShaderReflection *GetShader(ResourceId pipeline, ResourceId shader,
                                             ShaderEntryPoint entry) = 0;
 
+  DOCUMENT(R"(Search every shader in the capture for some text.
+
+The shaders' embedded source from debug info, their default disassembly, and the names in their
+reflection data (resources, constants and signature elements) are all searched. Each line is only
+returned once even if it contains multiple matches.
+
+The first search disassembles every shader, which can take some time for large captures. That text
+is kept so that later searches only need to scan it, which is done in parallel.
+
+:param str text: The text to search for.
+:param bool caseSensitive: ``True`` if the search should be case sensitive.
+:return: The matches, ordered by shader.
+:rtype: List[ShaderSearchResult]
+)");
+  virtual rdcarray<ShaderSearchResult> SearchShaders(const rdcstr &text, bool caseSensitive) = 0;
+
   DOCUMENT(R"(Retrieve the contents of a particular pixel in a texture.
 
 .. note::
@@ -926,6 +1028,33 @@ bucket when the pixel values are divided between ``minval`` and ``maxval``.
   virtual rdcarray<PixelModification> PixelHistory(ResourceId texture, uint32_t x, uint32_t y,
                                                    const Subresource &sub, CompType typeCast) = 0;
 
+  DOCUMENT(R"(Retrieve which events modified each pixel in a rectangular region of the selected
+texture.
+
+Where the API supports it the whole region is processed in a single replay, so this is much faster
+than calling :meth:`PixelHistory` on every pixel. The result only lists the events and how many
+fragments each one produced, not the values written.
+
+.. note::
+  X and Y co-ordinates are top-left, the same as for :meth:`PixelHistory`.
+
+:param ResourceId texture: The texture to search for modifications.
+:param int x: The x co-ordinate of the top-left of the region.
+:param int y: The y co-ordinate of the top-left of the region.
+:param int width: The width of the region. It is clamped to the texture's dimensions.
+:param int height: The height of the region. It is clamped to the texture's dimensions.
+:param Subresource sub: The subresource within this texture to use.
+:param CompType typeCast: If possible interpret the texture with this type instead of its normal
+  type. If set to :data:`CompType.Typeless` then no cast is applied, otherwise where allowed the
+  texture data will be reinterpreted - e.g. from unsigned integers to floats, or to unsigned
+  normalised values.
+:return: The per-pixel table of events.
+:rtype: PixelRegionHistory
+)");
+  virtual PixelRegionHistory PixelHistoryRegion(ResourceId texture, uint32_t x, uint32_t y,
+                                                uint32_t width, uint32_t height,
+                                                const Subresource &sub, CompType typeCast) = 0;
+
   DOCUMENT(R"(Retrieve a debugging trace from running a vertex shader.
 
 :param int vertid: The vertex ID as a 0-based index up to the number of vertices in the draw.
@@ -960,6 +1089,21 @@ bucket when the pixel values are divided between ``minval`` and ``maxval``.
   virtual ShaderDebugTrace *DebugPixel(uint32_t x, uint32_t y, uint32_t sample,
                                        uint32_t primitive) = 0;
 
+#if !defined(SWIG)
+  DOCUMENT(R"(INTERNAL: Retrieve debugging traces for several pixels at once, in the same way as
+:meth:`DebugPixel`. Where supported the inputs for all of the pixels are gathered in one replay of
+the action, which is much faster than debugging each of them in turn when they are close together.
+
+:param List[Tuple[int,int]] pixels: The x and y co-ordinates of each pixel.
+:param int sample: The multi-sampled sample. Ignored if non-multisampled texture.
+:param int primitive: Debug the pixels from this primitive if there's ambiguity.
+:return: One trace for each pixel, in the same order. Destroy each with :meth:`FreeTrace`.
+:rtype: List[ShaderDebugTrace]
+)");
+  virtual rdcarray<ShaderDebugTrace *> DebugPixels(
+      const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels, uint32_t sample, uint32_t primitive) = 0;
+#endif
+
   DOCUMENT(R"(Retrieve a debugging trace from running a compute thread.
 
 :param Tuple[int,int,int] groupid: A list containing the 3D workgroup index.
@@ -1031,6 +1175,24 @@ texture to something compatible with the target file format.
 )");
   virtual ResultDetails SaveTexture(const TextureSave &saveData, const rdcstr &path) = 0;
 
+  DOCUMENT(R"(Save a list of textures to files on disk, the same as calling :meth:`SaveTexture` for
+each one in turn.
+
+This is much faster for saving many textures or subresources at once. The texture contents are
+fetched in one batch, and converting and encoding each file happens on worker threads while the
+following textures are still being fetched.
+
+Every texture is attempted even if an earlier one fails.
+
+:param List[TextureSave] saveData: The configuration settings of which textures to save, and how.
+:param List[str] paths: The path to save each texture to on disk. Must be the same length as
+  ``saveData``.
+:return: The result of the operation. If any texture failed to save, this is the first failure.
+:rtype: ResultDetails
+)");
+  virtual ResultDetails SaveTextures(const rdcarray<TextureSave> &saveData,
+                                     const rdcarray<rdcstr> &paths) = 0;
+
   DOCUMENT(R"(Retrieve the generated data from one of the geometry processing shader stages.
 
 :param int instance: The index of the instance to retrieve data for, or 0 for non-instanced draws.
@@ -1041,6 +1203,16 @@ texture to something compatible with the target file format.
 )");
   virtual MeshFormat GetPostVSData(uint32_t instance, uint32_t view, MeshDataStage stage) = 0;
 
+  DOCUMENT(R"(Retrieve statistics about the cache of post-transform data used by
+:meth:`GetPostVSData` and mesh rendering.
+
+The GPU memory the cache can use is set by the ``Replay_PostVSCacheBudgetMB`` config setting.
+
+:return: The current statistics for the cache.
+:rtype: PostVSCacheStatistics
+)");
+  virtual PostVSCacheStatistics GetPostVSCacheStatistics() = 0;
+
   DOCUMENT(R"(Retrieve the contents of a range of a buffer as a ``bytes``.
 
 :param ResourceId buff: The id of the buffer to retrieve data from.
@@ -1060,6 +1232,25 @@ texture to something compatible with the target file format.
 )");
   virtual bytebuf GetTextureData(ResourceId tex, const Subresource &sub) = 0;
 
+  DOCUMENT(R"(Retrieve the contents of a list of texture subresources, calling a callback with the
+contents of each one.
+
+This returns the same data as calling :meth:`GetTextureData` for each subresource in turn, but where
+possible the copies are kept in flight on the GPU while earlier results are handed to the callback,
+so any processing done in the callback such as converting or writing the data to disk overlaps with
+fetching the next subresources.
+
+The callback is called exactly once for each entry, in the order they were requested.
+
+:param List[ResourceId] textures: The ids of the textures to retrieve data from.
+:param List[Subresource] subs: The subresource to use within the texture at the same index in
+  ``textures``. Must be the same length as ``textures``.
+:param TextureDataCallback callback: The callback to call with each subresource's contents.
+)");
+  virtual void GetTextureDataBatch(const rdcarray<ResourceId> &textures,
+                                   const rdcarray<Subresource> &subs,
+                                   RENDERDOC_TextureDataCallback callback) = 0;
+
   static const uint32_t NoPreference = ~0U;
 
 protected:
@@ -2137,6 +2328,18 @@ DOCUMENT(R"(Returns the current process's memory usage in bytes
 )");
 extern "C" RENDERDOC_API uint64_t RENDERDOC_CC RENDERDOC_GetCurrentProcessMemoryUsage();
 
+DOCUMENT(R"(Saves the profile regions recorded so far as a Chrome trace, which can be loaded in
+``chrome://tracing`` or any compatible trace viewer.
+
+Regions are only recorded while the ``Replay_ProfileTrace`` config setting is enabled. Each thread
+keeps a bounded number of the most recent events.
+
+:param str filename: The filename to save the trace to.
+:return: ``True`` if the trace was saved successfully, ``False`` otherwise.
+:rtype: bool
+)");
+extern "C" RENDERDOC_API bool RENDERDOC_CC RENDERDOC_SaveProfileTrace(const rdcstr &filename);
+
 DOCUMENT(R"(Return a read-only handle to the :class:`SDObject` corresponding to a given setting's
 value object.
 
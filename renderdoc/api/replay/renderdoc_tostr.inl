@@ -916,6 +916,7 @@ rdcstr DoStringise(const GPUCounter &el)
     STRINGISE_ENUM_CLASS(GSInvocations);
     STRINGISE_ENUM_CLASS(PSInvocations);
     STRINGISE_ENUM_CLASS(CSInvocations);
+    STRINGISE_ENUM_CLASS(EventGPUDurationStdDev);
   }
   END_ENUM_STRINGISE();
 }
@@ -1076,6 +1077,10 @@ rdcstr DoStringise(const SectionType &el)
     STRINGISE_ENUM_CLASS_NAMED(EditedShaders, "renderdoc/ui/edits");
     STRINGISE_ENUM_CLASS_NAMED(D3D12Core, "renderdoc/internal/d3d12core");
     STRINGISE_ENUM_CLASS_NAMED(D3D12SDKLayers, "renderdoc/internal/d3d12sdklayers");
+    STRINGISE_ENUM_CLASS_NAMED(BlockIndex, "renderdoc/internal/blockindex");
+    STRINGISE_ENUM_CLASS_NAMED(ChunkIndex, "renderdoc/internal/chunkindex");
+    STRINGISE_ENUM_CLASS_NAMED(ChunkStatistics, "renderdoc/internal/chunkstatistics");
+    STRINGISE_ENUM_CLASS_NAMED(CallstackTable, "renderdoc/internal/callstacktable");
   }
   END_ENUM_STRINGISE();
 }
@@ -110,6 +110,39 @@ version of RenderDoc that addes a new section type. They should be considered eq
   This section contains an internal copy of D3D12SDKLayers for replaying.
 
   The name for this section will be "renderdoc/internal/d3d12sdklayers".
+
+.. data:: BlockIndex
+
+  This section contains an index of the compressed blocks in the frame capture section, allowing it
+  to be read from an arbitrary offset without decompressing everything before it. It is only present
+  when the frame capture was compressed in independent blocks.
+
+  The name for this section will be "renderdoc/internal/blockindex".
+
+.. data:: ChunkIndex
+
+  This section contains an index of the chunks in the uncompressed frame capture section, with the
+  offset, length and chunk ID of each chunk and the event ID for chunks inside the captured frame.
+  It is generated on replay when enabled and is only valid for the frame capture it was built from.
+
+  The name for this section will be "renderdoc/internal/chunkindex".
+
+.. data:: ChunkStatistics
+
+  This section contains statistics for each type of chunk in the captured frame, gathered when the
+  capture was made: the number of calls, the total bytes serialised and the minimum, mean, 99th
+  percentile and maximum time spent in the driver. It is stored as UTF-8 JSON text so it can be read
+  without replaying the capture.
+
+  The name for this section will be "renderdoc/internal/chunkstatistics".
+
+.. data:: CallstackTable
+
+  This section contains each unique callstack collected while capturing, as a list of return
+  addresses. Chunks in the frame capture refer to a callstack by its index in this table rather than
+  storing the addresses themselves.
+
+  The name for this section will be "renderdoc/internal/callstacktable".
 )");
 enum class SectionType : uint32_t
 {
@@ -126,6 +159,10 @@ enum class SectionType : uint32_t
   EditedShaders,
   D3D12Core,
   D3D12SDKLayers,
+  BlockIndex,
+  ChunkIndex,
+  ChunkStatistics,
+  CallstackTable,
   Count,
 };
 
@@ -1305,6 +1342,14 @@ See :ref:`the documentation for this feature <render-overlay>`.
 
   The overlay accounts for all draws in the current pass.
 
+  Only the red channel is displayed, but when reading back the overlay texture each pixel contains
+  the values for the 2x2 quad it's in:
+
+  * ``x`` - the number of quads shaded, which is what the overlay displays.
+  * ``y`` - the number of covered pixels shaded.
+  * ``z`` - the number of helper lanes shaded, for uncovered pixels in a partially covered quad.
+  * ``w`` - the number of quads shaded that were only partially covered.
+
 .. data:: QuadOverdrawDraw
 
   This is the same as the :data:`QuadOverdrawPass` overlay, except it only shows the overdraw for
@@ -3439,7 +3484,8 @@ enumerated with IDs in the appropriate ranges.
 
 .. data:: EventGPUDuration
 
-  Time taken for this event on the GPU, as measured by delta between two GPU timestamps.
+  Time taken for this event on the GPU, as measured by delta between two GPU timestamps. When the
+  event is timed over several replays this is the median duration.
 
 .. data:: InputVerticesRead
 
@@ -3501,6 +3547,11 @@ enumerated with IDs in the appropriate ranges.
 
   Number of times a :data:`compute shader <ShaderStage.Compute>` was invoked.
 
+.. data:: EventGPUDurationStdDev
+
+  Standard deviation of :data:`EventGPUDuration` when the event is timed over several replays. This
+  is 0 when only one replay is made.
+
 .. data:: FirstAMD
 
   The AMD-specific counter IDs start from this value.
@@ -3560,6 +3611,7 @@ enum class GPUCounter : uint32_t
   PSInvocations,
   FSInvocations = PSInvocations,
   CSInvocations,
+  EventGPUDurationStdDev,
   Count,
 
   // IHV specific counters can be set above this point
@@ -3960,6 +4012,10 @@ DOCUMENT(R"(The type of message received from or sent to an application target c
 .. data:: RequestShow
 
   The client has requested that the controller show itself (raise its window to the top).
+
+.. data:: FrameStats
+
+  Periodic update of the target's recent frame timings.
 )");
 enum class TargetControlMessageType : uint32_t
 {
@@ -3974,6 +4030,7 @@ enum class TargetControlMessageType : uint32_t
   CaptureProgress,
   CapturableWindowCount,
   RequestShow,
+  FrameStats,
 };
 
 DECLARE_REFLECTION_ENUM(TargetControlMessageType);
@@ -1309,6 +1309,59 @@ struct ShaderEntryPoint
 
 DECLARE_REFLECTION_STRUCT(ShaderEntryPoint);
 
+DOCUMENT("A single match found by :meth:`ReplayController.SearchShaders`.");
+struct ShaderSearchResult
+{
+  DOCUMENT("");
+  ShaderSearchResult() = default;
+  ShaderSearchResult(const ShaderSearchResult &) = default;
+  ShaderSearchResult &operator=(const ShaderSearchResult &) = default;
+
+  bool operator==(const ShaderSearchResult &o) const
+  {
+    return shader == o.shader && entryPoint == o.entryPoint && location == o.location &&
+           lineNumber == o.lineNumber && lineText == o.lineText;
+  }
+  bool operator<(const ShaderSearchResult &o) const
+  {
+    if(!(shader == o.shader))
+      return shader < o.shader;
+    if(!(entryPoint == o.entryPoint))
+      return entryPoint < o.entryPoint;
+    if(!(location == o.location))
+      return location < o.location;
+    if(!(lineNumber == o.lineNumber))
+      return lineNumber < o.lineNumber;
+    if(!(lineText == o.lineText))
+      return lineText < o.lineText;
+    return false;
+  }
+  DOCUMENT("The :class:`ResourceId` of the shader containing the match.");
+  ResourceId shader;
+
+  DOCUMENT(R"(The entry point in the shader that the match was found in.
+
+:type: ShaderEntryPoint
+)");
+  ShaderEntryPoint entryPoint;
+
+  DOCUMENT(R"(Where the match was found. This is the filename for a match in the shader's embedded
+source, ``Disassembly`` for a match in the default disassembly, or ``Reflection`` for a match in the
+name of a resource, constant or signature element.
+)");
+  rdcstr location;
+
+  DOCUMENT(R"(The 1-based line number of the match in the source or disassembly, or the index of the
+name within the reflection data.
+)");
+  uint32_t lineNumber = 0;
+
+  DOCUMENT("The whole line of text containing the match.");
+  rdcstr lineText;
+};
+
+DECLARE_REFLECTION_STRUCT(ShaderSearchResult);
+
 DOCUMENT("Contains a single flag used at compile-time on a shader.");
 struct ShaderCompileFlag
 {
@@ -415,13 +415,43 @@ DECLARE_REFLECTION_STRUCT(SDObjectData);
 
 #if !defined(SWIG)
 using LazyGenerator = std::function<SDObject *(const void *)>;
+using LazyObjectGenerator = std::function<void(SDObject *)>;
 
+// either a lazy array, where each child is generated on demand from its element in data, or a
+// lazy object where all children are added at once by objectGenerator on first access. For lazy
+// objects elemSize is 0 and data is NULL.
 struct LazyArrayData
 {
   byte *data;
   size_t elemSize;
   LazyGenerator generator;
+  LazyObjectGenerator objectGenerator;
 };
+
+// A bump allocator for SDObjects, owned by an SDFile, so that building and destroying a large
+// structured file is a handful of large allocations instead of one per object. The memory is only
+// freed once the owning file and every object allocated from it have been destroyed, so objects
+// can still be moved between files. Objects from the same arena must not be destroyed concurrently.
+struct SDObjectArena
+{
+  static SDObjectArena *Create();
+  void *Allocate(size_t sz);
+  void Release();
+
+private:
+  struct Block
+  {
+    Block *next;
+    size_t size;
+    size_t used;
+    size_t padding;
+  };
+
+  Block *m_Blocks = NULL;
+  size_t m_Refs = 1;
+};
+#else
+struct SDObjectArena;
 #endif
 
 DOCUMENT(R"(Defines a single structured object. Structured objects are defined recursively and one
@@ -494,9 +524,11 @@ struct SDObject
 #endif
 
   /////////////////////////////////////////////////////////////////
-  // memory management, in a dll safe way
-  void *operator new(size_t sz) { return SDObject::alloc(sz); }
-  void operator delete(void *p) { SDObject::dealloc(p); }
+  // memory management, in a dll safe way. Objects can also be allocated from an SDObjectArena.
+  void *operator new(size_t sz) { return SDObject::allocObject(sz, NULL); }
+  void *operator new(size_t sz, SDObjectArena *arena) { return SDObject::allocObject(sz, arena); }
+  void operator delete(void *p) { SDObject::deallocObject(p); }
+  void operator delete(void *p, SDObjectArena *) { SDObject::deallocObject(p); }
   void *operator new[](size_t count) = delete;
   void operator delete[](void *p) = delete;
 
@@ -578,7 +610,7 @@ recursively through children.
     {
       ret = false;
     }
-    else if(data.children.size() != obj->data.children.size())
+    else if(NumChildren() != obj->NumChildren())
     {
       ret = false;
     }
@@ -618,7 +650,7 @@ returned.
 )");
   inline SDObject *FindChild(const rdcstr &childName)
   {
-    for(size_t i = 0; i < data.children.size(); i++)
+    for(size_t i = 0; i < NumChildren(); i++)
       if(GetChild(i)->name == childName)
         return GetChild(i);
     return NULL;
@@ -658,7 +690,7 @@ returned.
 )");
   inline SDObject *GetChild(size_t index)
   {
-    if(index < data.children.size())
+    if(index < NumChildren())
     {
       PopulateChild(index);
       return data.children[index];
@@ -678,7 +710,7 @@ returned.
   // const versions of FindChild/GetChild
   inline const SDObject *FindChild(const rdcstr &childName) const
   {
-    for(size_t i = 0; i < data.children.size(); i++)
+    for(size_t i = 0; i < NumChildren(); i++)
       if(GetChild(i)->name == childName)
         return GetChild(i);
     return NULL;
@@ -700,7 +732,7 @@ returned.
   }
   inline const SDObject *GetChild(size_t index) const
   {
-    if(index < data.children.size())
+    if(index < NumChildren())
     {
       PopulateChild(index);
       return data.children[index];
@@ -716,7 +748,7 @@ returned.
 )");
   inline void RemoveChild(size_t index)
   {
-    if(index < data.children.size())
+    if(index < NumChildren())
     {
       // we really shouldn't be deleting individually from a lazy array but just in case we are,
       // fully evaluate it first.
@@ -741,16 +773,20 @@ returned.
 :return: The number of children this object contains.
 :rtype: int
 )");
-  inline size_t NumChildren() const { return data.children.size(); }
+  inline size_t NumChildren() const
+  {
+    PopulateLazyObject();
+    return data.children.size();
+  }
 #if !defined(SWIG)
   // these are for C++ iteration so not defined when SWIG is generating interfaces
   inline SDObjectIt<const SDObject> begin() const { return SDObjectIt<const SDObject>(this, 0); }
   inline SDObjectIt<const SDObject> end() const
   {
-    return SDObjectIt<const SDObject>(this, data.children.size());
+    return SDObjectIt<const SDObject>(this, NumChildren());
   }
   inline SDObjectIt<SDObject> begin() { return SDObjectIt<SDObject>(this, 0); }
-  inline SDObjectIt<SDObject> end() { return SDObjectIt<SDObject>(this, data.children.size()); }
+  inline SDObjectIt<SDObject> end() { return SDObjectIt<SDObject>(this, NumChildren()); }
 #endif
 
 #if !defined(SWIG)
@@ -800,6 +836,24 @@ returned.
     memcpy(m_Lazy->data, arrayData, sz);
     data.children.resize((size_t)arrayCount);
   }
+
+  // defer generating all of this object's children until they're first accessed. The generator
+  // is called once with this object and should add the children, e.g. by decoding them on demand
+  // from a serialised chunk.
+  void SetLazyObject(LazyObjectGenerator generator)
+  {
+    DeleteChildren();
+
+    void *lazyAlloc = alloc(sizeof(LazyArrayData));
+
+    m_Lazy = new(lazyAlloc) LazyArrayData;
+    m_Lazy->objectGenerator = generator;
+    m_Lazy->elemSize = 0;
+    m_Lazy->data = NULL;
+  }
+
+  // returns true if the children of this object haven't been generated yet
+  bool IsLazyObject() const { return m_Lazy && m_Lazy->elemSize == 0; }
 #endif
 
 // C++ gets more extensive typecasts. We'll add a couple for python in the interface file
@@ -949,7 +1003,9 @@ protected:
   {
     if(m_Lazy)
     {
-      if(data.children[idx] == NULL)
+      if(m_Lazy->elemSize == 0)
+        PopulateLazyObject();
+      else if(data.children[idx] == NULL)
       {
         data.children[idx] = m_Lazy->generator(m_Lazy->data + idx * m_Lazy->elemSize);
         data.children[idx]->m_Parent = (SDObject *)this;
@@ -957,9 +1013,24 @@ protected:
     }
   }
 
+  inline void PopulateLazyObject() const
+  {
+    if(m_Lazy && m_Lazy->elemSize == 0)
+    {
+      // the generator adds children normally, so clear the lazy state first
+      LazyObjectGenerator generator = std::move(m_Lazy->objectGenerator);
+      DeleteLazyGenerator();
+      generator((SDObject *)this);
+    }
+  }
+
   void PopulateAllChildren() const
   {
-    if(m_Lazy)
+    if(m_Lazy && m_Lazy->elemSize == 0)
+    {
+      PopulateLazyObject();
+    }
+    else if(m_Lazy)
     {
       for(size_t i = 0; i < data.children.size(); i++)
         PopulateChild(i);
@@ -989,7 +1060,16 @@ protected:
 #endif
   }
 
+  // each object allocation is prefixed with the arena it came from, or NULL if it came from the
+  // heap, so that delete works the same on either. The prefix keeps the allocation's alignment.
+  static const size_t ArenaPrefixSize = 16;
+
+  static void *allocObject(size_t sz, SDObjectArena *arena);
+  static void deallocObject(void *p);
+
 private:
+  friend struct SDObjectArena;
+
   SDObject *m_Parent = NULL;
   mutable LazyArrayData *m_Lazy = NULL;
 
@@ -1006,6 +1086,7 @@ private:
     if(m_Lazy)
     {
       dealloc(m_Lazy->data);
+      m_Lazy->~LazyArrayData();
       dealloc(m_Lazy);
       m_Lazy = NULL;
     }
@@ -1014,6 +1095,79 @@ private:
 
 DECLARE_REFLECTION_STRUCT(SDObject);
 
+#if !defined(SWIG)
+inline void *SDObject::allocObject(size_t sz, SDObjectArena *arena)
+{
+  byte *ret = (byte *)(arena ? arena->Allocate(sz + ArenaPrefixSize) : alloc(sz + ArenaPrefixSize));
+  *(SDObjectArena **)ret = arena;
+  return ret + ArenaPrefixSize;
+}
+
+inline void SDObject::deallocObject(void *p)
+{
+  if(p == NULL)
+    return;
+
+  byte *base = (byte *)p - ArenaPrefixSize;
+  SDObjectArena *arena = *(SDObjectArena **)base;
+
+  if(arena)
+    arena->Release();
+  else
+    dealloc(base);
+}
+
+inline SDObjectArena *SDObjectArena::Create()
+{
+  return new(SDObject::alloc(sizeof(SDObjectArena))) SDObjectArena;
+}
+
+inline void *SDObjectArena::Allocate(size_t sz)
+{
+  sz = (sz + 15) & ~size_t(15);
+
+  if(m_Blocks == NULL || m_Blocks->used + sz > m_Blocks->size)
+  {
+    // start small since many serialisers only export a few objects, and grow up to 1MB blocks
+    size_t blockSize = m_Blocks ? m_Blocks->size * 2 : 4096;
+    if(blockSize > 1024 * 1024)
+      blockSize = 1024 * 1024;
+    if(blockSize < sz)
+      blockSize = sz;
+
+    Block *block = (Block *)SDObject::alloc(sizeof(Block) + blockSize);
+    block->next = m_Blocks;
+    block->size = blockSize;
+    block->used = 0;
+    m_Blocks = block;
+  }
+
+  void *ret = (byte *)(m_Blocks + 1) + m_Blocks->used;
+  m_Blocks->used += sz;
+
+  // each live object holds a reference
+  m_Refs++;
+
+  return ret;
+}
+
+inline void SDObjectArena::Release()
+{
+  if(--m_Refs > 0)
+    return;
+
+  while(m_Blocks)
+  {
+    Block *next = m_Blocks->next;
+    SDObject::dealloc(m_Blocks);
+    m_Blocks = next;
+  }
+
+  this->~SDObjectArena();
+  SDObject::dealloc(this);
+}
+#endif
+
 #if defined(RENDERDOC_QT_COMPAT)
 inline SDObject *makeSDObject(const rdcinflexiblestr &name, QVariant val)
 {
@@ -1401,10 +1555,10 @@ struct SDChunk : public SDObject
     ret->data.basic = data.basic;
     ret->data.str = data.str;
 
-    ret->data.children.resize(data.children.size());
-
     PopulateAllChildren();
 
+    ret->data.children.resize(data.children.size());
+
     for(size_t i = 0; i < data.children.size(); i++)
       ret->data.children[i] = data.children[i]->Duplicate();
 
@@ -1533,6 +1687,11 @@ public:
 
     for(bytebuf *buf : buffers)
       delete buf;
+
+#if !defined(SWIG)
+    if(m_Arena)
+      m_Arena->Release();
+#endif
   }
 
   DOCUMENT(R"(The chunks in the file in order.
@@ -1559,9 +1718,22 @@ public:
     chunks.swap(other.chunks);
     buffers.swap(other.buffers);
     std::swap(version, other.version);
+    std::swap(m_Arena, other.m_Arena);
+  }
+
+#if !defined(SWIG)
+  // the arena for allocating this file's objects when building it, created on first use
+  SDObjectArena *GetObjectArena()
+  {
+    if(m_Arena == NULL)
+      m_Arena = SDObjectArena::Create();
+    return m_Arena;
   }
+#endif
 
 protected:
   SDFile(const SDFile &) = delete;
   SDFile &operator=(const SDFile &) = delete;
+
+  SDObjectArena *m_Arena = NULL;
 };
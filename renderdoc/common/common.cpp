@@ -26,6 +26,7 @@
 #include "common.h"
 #include <stdarg.h>
 #include <string.h>
+#include "api/replay/rdcpair.h"
 #include "common/threading.h"
 #include "os/os_specific.h"
 #include "strings/string_utils.h"
@@ -39,43 +40,59 @@ void rdcassert(const char *msg, const char *file, unsigned int line, const char
                 "Assertion failed: %s", msg);
 }
 
-#if 0
-static __m128 zero = {0};
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DIFF_SSE2 OPTION_ON
+#else
+#define DIFF_SSE2 OPTION_OFF
+#endif
+
+#if DISABLED(DIFF_SSE2) && (defined(__aarch64__) || defined(_M_ARM64))
+#include <arm_neon.h>
+#define DIFF_NEON OPTION_ON
+#else
+#define DIFF_NEON OPTION_OFF
 #endif
 
-// assumes a and b both point to 16-byte aligned 16-byte chunks of memory.
-// Returns if they're equal or different
-bool Vec16NotEqual(void *a, void *b)
+// returns a mask with bit i set if byte i differs between the 16 bytes at a and b. Neither pointer
+// needs to be aligned
+static inline uint32_t DiffMask16(const byte *a, const byte *b)
 {
-// disabled SSE version as it's acting dodgy
-#if 0
-	__m128 avec = _mm_load_ps(aflt);
-	__m128 bvec = _mm_load_ps(bflt);
-
-	__m128 diff = _mm_xor_ps(avec, bvec);
-
-	__m128 eq = _mm_cmpeq_ps(diff, zero);
-	int mask = _mm_movemask_ps(eq);
-	int signMask = _mm_movemask_ps(diff);
-
-	// first check ensures that diff is floatequal to zero (ie. avec bitwise equal to bvec).
-	// HOWEVER -0 is floatequal to 0, so we ensure no sign bits are set on diff
-	if((mask^0xf) || signMask != 0)
-	{
-		return true;
-	}
-	
-	return false;
-#elif ENABLED(RDOC_X64)
-  uint64_t *a64 = (uint64_t *)a;
-  uint64_t *b64 = (uint64_t *)b;
-
-  return a64[0] != b64[0] || a64[1] != b64[1];
+#if ENABLED(DIFF_SSE2)
+  __m128i av = _mm_loadu_si128((const __m128i *)a);
+  __m128i bv = _mm_loadu_si128((const __m128i *)b);
+  return (~(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(av, bv))) & 0xffff;
+#elif ENABLED(DIFF_NEON)
+  static const uint8_t bitValues[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+
+  uint8x16_t ne = vmvnq_u8(vceqq_u8(vld1q_u8(a), vld1q_u8(b)));
+  uint8x16_t bits = vandq_u8(ne, vld1q_u8(bitValues));
+
+  return uint32_t(vaddv_u8(vget_low_u8(bits))) | (uint32_t(vaddv_u8(vget_high_u8(bits))) << 8);
 #else
-  uint32_t *a32 = (uint32_t *)a;
-  uint32_t *b32 = (uint32_t *)b;
+  uint32_t mask = 0;
+  for(uint32_t i = 0; i < 16; i++)
+    mask |= (a[i] != b[i] ? 1U : 0U) << i;
+  return mask;
+#endif
+}
 
-  return a32[0] != b32[0] || a32[1] != b32[1] || a32[2] != b32[2] || a32[3] != b32[3];
+// quick check if the 64 bytes at a and b are identical, to skip over unchanged memory
+static inline bool Equal64(const byte *a, const byte *b)
+{
+#if ENABLED(DIFF_SSE2)
+  __m128i diff = _mm_setzero_si128();
+  for(int i = 0; i < 64; i += 16)
+    diff = _mm_or_si128(diff, _mm_xor_si128(_mm_loadu_si128((const __m128i *)(a + i)),
+                                            _mm_loadu_si128((const __m128i *)(b + i))));
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) == 0xffff;
+#elif ENABLED(DIFF_NEON)
+  uint8x16_t diff = vdupq_n_u8(0);
+  for(int i = 0; i < 64; i += 16)
+    diff = vorrq_u8(diff, veorq_u8(vld1q_u8(a + i), vld1q_u8(b + i)));
+  return vmaxvq_u8(diff) == 0;
+#else
+  return memcmp(a, b, 64) == 0;
 #endif
 }
 
@@ -90,29 +107,21 @@ bool FindDiffRange(void *a, void *b, size_t bufSize, size_t &diffStart, size_t &
   size_t alignedSize = bufSize & (~0xf);
   size_t numVecs = alignedSize / 16;
 
-  size_t offs = 0;
-
-  float *aflt = (float *)a;
-  float *bflt = (float *)b;
+  const byte *abyte = (const byte *)a;
+  const byte *bbyte = (const byte *)b;
 
   // sweep to find the start of differences
   for(size_t v = 0; v < numVecs; v++)
   {
-    if(Vec16NotEqual(aflt, bflt))
+    uint32_t mask = DiffMask16(abyte + v * 16, bbyte + v * 16);
+    if(mask)
     {
-      diffStart = offs;
+      // the mask makes us byte-accurate, to comply with WRITE_NO_OVERWRITE
+      diffStart = v * 16 + Bits::CountTrailingZeroes(mask);
       break;
     }
-
-    aflt += 4;
-    bflt += 4;
-    offs += 4 * sizeof(float);
   }
 
-  // make sure we're byte-accurate, to comply with WRITE_NO_OVERWRITE
-  while(diffStart < bufSize && *((byte *)a + diffStart) == *((byte *)b + diffStart))
-    diffStart++;
-
   // do we have some unaligned bytes at the end of the buffer?
   if(bufSize > alignedSize)
   {
@@ -121,61 +130,131 @@ bool FindDiffRange(void *a, void *b, size_t bufSize, size_t &diffStart, size_t &
     // if we haven't even found a start, check in these bytes
     if(diffStart > bufSize)
     {
-      offs = alignedSize;
-
       for(size_t by = 0; by < numBytes; by++)
       {
-        if(*((byte *)a + alignedSize + by) != *((byte *)b + alignedSize + by))
+        if(abyte[alignedSize + by] != bbyte[alignedSize + by])
         {
-          diffStart = offs;
+          diffStart = alignedSize + by;
           break;
         }
-
-        offs++;
       }
     }
 
     // sweep from the last byte to find the end
     for(size_t by = 0; by < numBytes; by++)
     {
-      if(*((byte *)a + bufSize - 1 - by) != *((byte *)b + bufSize - 1 - by))
+      if(abyte[bufSize - 1 - by] != bbyte[bufSize - 1 - by])
       {
         diffEnd = bufSize - by;
         break;
       }
     }
+
+    // if we found the end just exit
+    if(diffEnd > 0)
+      return true;
+  }
+
+  // if we didn't find a start, or we found the start and end in the unaligned bytes, exit
+  if(diffStart > bufSize)
+    return false;
+
+  // sweep from the last vector to find the end
+  for(size_t v = numVecs; v > 0; v--)
+  {
+    uint32_t mask = DiffMask16(abyte + (v - 1) * 16, bbyte + (v - 1) * 16);
+    if(mask)
+    {
+      // the highest differing byte in this vector is the last one
+      diffEnd = (v - 1) * 16 + 16 - Bits::CountLeadingZeroes(mask << 16);
+      break;
+    }
   }
 
-  // if we haven't found a start, or we've found a start AND and end,
-  // then we're done.
-  if(diffStart > bufSize || diffEnd > 0)
-    return diffStart < bufSize;
+  // if we found a start then we necessarily found an end
+  return diffStart < bufSize;
+}
 
-  offs = alignedSize;
+namespace
+{
+struct DiffRangeBuilder
+{
+  rdcarray<rdcpair<size_t, size_t>> &ranges;
+  size_t mergeGap;
+  size_t maxRanges;
 
-  // sweep from the last __m128
-  aflt = (float *)a + offs / sizeof(float) - 4;
-  bflt = (float *)b + offs / sizeof(float) - 4;
+  bool inRange;
+  size_t start;
+  size_t end;
 
-  for(size_t v = 0; v < numVecs; v++)
+  // add the differing bytes set in a 16-bit mask of bytes starting at base
+  void Add(size_t base, uint32_t mask)
   {
-    if(Vec16NotEqual(aflt, bflt))
+    while(mask)
     {
-      diffEnd = offs;
-      break;
+      uint32_t first = Bits::CountTrailingZeroes(mask);
+      // the number of contiguous differing bytes from first. The mask only has 16 bits so the
+      // inverse is never 0
+      uint32_t len = Bits::CountTrailingZeroes(~(mask >> first));
+
+      size_t pos = base + first;
+
+      // close the current range if the gap is too large to merge, unless we're at the limit in
+      // which case the last range grows to cover everything else
+      if(inRange && pos - end > mergeGap && ranges.size() + 1 < maxRanges)
+      {
+        ranges.push_back({start, end});
+        inRange = false;
+      }
+
+      if(!inRange)
+      {
+        start = pos;
+        inRange = true;
+      }
+
+      end = pos + len;
+
+      // first + len is at most 16, so this is a valid shift
+      mask &= ~0U << (first + len);
     }
+  }
+};
+};
+
+bool FindDiffRanges(const void *a, const void *b, size_t bufSize, size_t mergeGap,
+                    rdcarray<rdcpair<size_t, size_t>> &ranges, size_t maxRanges)
+{
+  ranges.clear();
+
+  const byte *abyte = (const byte *)a;
+  const byte *bbyte = (const byte *)b;
 
-    aflt -= 4;
-    bflt -= 4;
-    offs -= 16;
+  DiffRangeBuilder builder = {ranges, mergeGap, RDCMAX(maxRanges, (size_t)1), false, 0, 0};
+
+  size_t offs = 0;
+
+  for(; offs + 64 <= bufSize; offs += 64)
+  {
+    if(Equal64(abyte + offs, bbyte + offs))
+      continue;
+
+    for(size_t v = 0; v < 64; v += 16)
+      builder.Add(offs + v, DiffMask16(abyte + offs + v, bbyte + offs + v));
   }
 
-  // make sure we're byte-accurate, to comply with WRITE_NO_OVERWRITE
-  while(diffEnd > 0 && *((byte *)a + diffEnd - 1) == *((byte *)b + diffEnd - 1))
-    diffEnd--;
+  for(; offs + 16 <= bufSize; offs += 16)
+    builder.Add(offs, DiffMask16(abyte + offs, bbyte + offs));
 
-  // if we found a start then we necessarily found an end
-  return diffStart < bufSize;
+  uint32_t tailMask = 0;
+  for(size_t by = 0; offs + by < bufSize; by++)
+    tailMask |= (abyte[offs + by] != bbyte[offs + by] ? 1U : 0U) << by;
+  builder.Add(offs, tailMask);
+
+  if(builder.inRange)
+    ranges.push_back({builder.start, builder.end});
+
+  return !ranges.empty();
 }
 
 uint32_t CalcNumMips(int w, int h, int d)
@@ -527,3 +606,122 @@ void rdclog_direct(time_t utcTime, uint32_t pid, LogType type, const char *proje
 
   SAFE_DELETE_ARRAY(oversizedBuffer);
 }
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "catch/catch.hpp"
+
+TEST_CASE("Find differing ranges in memory", "[diffrange]")
+{
+  bytebuf a, b;
+  a.resize(4096 + 13);
+  for(size_t i = 0; i < a.size(); i++)
+    a[i] = byte(i * 7);
+  b = a;
+
+  rdcarray<rdcpair<size_t, size_t>> ranges;
+
+  SECTION("Identical buffers")
+  {
+    CHECK_FALSE(FindDiffRanges(a.data(), b.data(), a.size(), 0, ranges));
+    CHECK(ranges.empty());
+
+    size_t s = 0, e = 0;
+    CHECK_FALSE(FindDiffRange(a.data(), b.data(), a.size(), s, e));
+  };
+
+  SECTION("Ranges at opposite ends")
+  {
+    b[3]++;
+    b[4]++;
+    b[a.size() - 1]++;
+
+    REQUIRE(FindDiffRanges(a.data(), b.data(), a.size(), 64, ranges));
+    REQUIRE(ranges.size() == 2);
+    CHECK(ranges[0].first == 3);
+    CHECK(ranges[0].second == 5);
+    CHECK(ranges[1].first == a.size() - 1);
+    CHECK(ranges[1].second == a.size());
+
+    // the single range covers everything in between
+    size_t s = 0, e = 0;
+    REQUIRE(FindDiffRange(a.data(), b.data(), a.size(), s, e));
+    CHECK(s == 3);
+    CHECK(e == a.size());
+  };
+
+  SECTION("Nearby ranges are merged")
+  {
+    b[100]++;
+    b[110]++;
+    b[200]++;
+
+    REQUIRE(FindDiffRanges(a.data(), b.data(), a.size(), 9, ranges));
+    REQUIRE(ranges.size() == 2);
+    CHECK(ranges[0].first == 100);
+    CHECK(ranges[0].second == 111);
+    CHECK(ranges[1].first == 200);
+    CHECK(ranges[1].second == 201);
+
+    REQUIRE(FindDiffRanges(a.data(), b.data(), a.size(), 8, ranges));
+    CHECK(ranges.size() == 3);
+
+    REQUIRE(FindDiffRanges(a.data(), b.data(), a.size(), 1000, ranges));
+    REQUIRE(ranges.size() == 1);
+    CHECK(ranges[0].first == 100);
+    CHECK(ranges[0].second == 201);
+  };
+
+  SECTION("Range limit extends the last range")
+  {
+    for(size_t i = 0; i < 10; i++)
+      b[i * 256 + 1]++;
+
+    REQUIRE(FindDiffRanges(a.data(), b.data(), a.size(), 0, ranges, 4));
+    REQUIRE(ranges.size() == 4);
+    CHECK(ranges[2].first == 2 * 256 + 1);
+    CHECK(ranges[2].second == 2 * 256 + 2);
+    CHECK(ranges[3].first == 3 * 256 + 1);
+    CHECK(ranges[3].second == 9 * 256 + 2);
+  };
+
+  SECTION("Matches a byte-by-byte comparison")
+  {
+    uint32_t seed = 1234;
+    for(int i = 0; i < 200; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      b[(seed >> 8) % b.size()] ^= 0x5a;
+    }
+
+    for(size_t size : {a.size(), size_t(4096), size_t(1000), size_t(63), size_t(5)})
+    {
+      rdcarray<rdcpair<size_t, size_t>> expected;
+      for(size_t i = 0; i < size; i++)
+      {
+        if(a[i] == b[i])
+          continue;
+
+        if(!expected.empty() && expected.back().second == i)
+          expected.back().second++;
+        else
+          expected.push_back({i, i + 1});
+      }
+
+      FindDiffRanges(a.data(), b.data(), size, 0, ranges, ~0U);
+      bool matches = (ranges == expected);
+      CHECK(matches);
+
+      size_t s = 0, e = 0;
+      bool found = FindDiffRange(a.data(), b.data(), size, s, e);
+      CHECK(found == !expected.empty());
+      if(found)
+      {
+        CHECK(s == expected.front().first);
+        CHECK(e == expected.back().second);
+      }
+    }
+  };
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -297,7 +297,18 @@ inline T AlignUpPtr(T x, A a)
 #define MAKE_FOURCC(a, b, c, d) \
   (((uint32_t)(d) << 24) | ((uint32_t)(c) << 16) | ((uint32_t)(b) << 8) | (uint32_t)(a))
 
+template <typename T>
+struct rdcarray;
+template <typename A, typename B>
+struct rdcpair;
+
 bool FindDiffRange(void *a, void *b, size_t bufSize, size_t &diffStart, size_t &diffEnd);
+
+// finds each [start, end) byte range where a and b differ. Ranges separated by mergeGap or fewer
+// identical bytes are merged together, and once maxRanges ranges are found the last one is extended
+// to cover any remaining differences. Returns true if any differences were found.
+bool FindDiffRanges(const void *a, const void *b, size_t bufSize, size_t mergeGap,
+                    rdcarray<rdcpair<size_t, size_t>> &ranges, size_t maxRanges = 256);
 uint32_t CalcNumMips(int Width, int Height, int Depth);
 
 typedef uint8_t byte;
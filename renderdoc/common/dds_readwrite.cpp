@@ -936,12 +936,8 @@ RDResult write_dds_to_file(FILE *f, const write_dds_data &data)
             pitch = RDCMAX(blockSize, (((rowlen + 3) / 4)) * blockSize);
           }
 
-          for(uint32_t row = 0; row < numRows; row++)
-          {
-            FileIO::fwrite(bytedata, 1, pitch, f);
-
-            bytedata += pitch;
-          }
+          // rows are tightly packed in the source data, so the whole slice goes out in one write
+          FileIO::fwrite(bytedata, 1, size_t(numRows) * pitch, f);
 
           i++;
         }
@@ -961,7 +957,7 @@ bool is_dds_file(byte *headerBuffer, size_t size)
   return memcmp(headerBuffer, &dds_fourcc, 4) == 0;
 }
 
-RDResult load_dds_from_file(StreamReader *reader, read_dds_data &ret)
+RDResult load_dds_from_file(StreamReader *reader, read_dds_data &ret, bool loadData)
 {
   uint64_t fileSize = reader->GetSize();
 
@@ -1223,7 +1219,12 @@ RDResult load_dds_from_file(StreamReader *reader, read_dds_data &ret)
                         ret.slices, ret.mips, fileSize);
   }
 
+  // swizzled data has to be loaded to be fixed up
+  if(bgrSwap)
+    loadData = true;
+
   // we reserve space for a full mip-chain (twice the size of the top mip) just to be conservative
+  if(loadData)
   {
     uint32_t rowlen = AlignUp(ret.width, subsamplePacking);
     uint32_t numRows = ret.height;
@@ -1246,6 +1247,8 @@ RDResult load_dds_from_file(StreamReader *reader, read_dds_data &ret)
   }
   ret.subresources.reserve(ret.slices * ret.mips);
 
+  uint64_t fileOffset = reader->GetOffset();
+
   int i = 0;
   for(uint32_t slice = 0; slice < ret.slices; slice++)
   {
@@ -1270,15 +1273,39 @@ RDResult load_dds_from_file(StreamReader *reader, read_dds_data &ret)
         pitch = RDCMAX(blockSize, (((rowlen + 3) / 4)) * blockSize);
       }
 
-      size_t subOffs = ret.buffer.size();
       size_t subSize = numdepths * numRows * pitch;
 
+      if(!loadData)
+      {
+        if(fileOffset + subSize > fileSize)
+        {
+          RETURN_ERROR_RESULT(ResultCode::ImageUnsupported,
+                              "DDS file of size %llu is truncated, expected %llu bytes or more",
+                              fileSize, fileOffset + subSize);
+        }
+
+        ret.subresources.push_back({fileOffset, subSize});
+        fileOffset += subSize;
+        i++;
+        continue;
+      }
+
+      size_t subOffs = ret.buffer.size();
+
       ret.subresources.push_back({subOffs, subSize});
 
       ret.buffer.resize(ret.buffer.size() + subSize);
 
       byte *bytedata = ret.buffer.data() + subOffs;
 
+      // without any fixup the rows are contiguous in the file, so read the subresource in one go
+      if(!bgrSwap)
+      {
+        reader->Read(bytedata, subSize);
+        i++;
+        continue;
+      }
+
       for(uint32_t d = 0; d < numdepths; d++)
       {
         for(uint32_t row = 0; row < numRows; row++)
@@ -46,8 +46,9 @@ struct read_dds_data : public dds_data
 {
   bytebuf buffer;
 
-  // pairs of {offset, size} into above data buffer
-  rdcarray<rdcpair<size_t, size_t>> subresources;
+  // pairs of {offset, size} into above data buffer. If the data wasn't loaded, buffer is empty and
+  // these are offsets into the file instead.
+  rdcarray<rdcpair<uint64_t, size_t>> subresources;
 };
 
 struct write_dds_data : public dds_data
@@ -56,5 +57,7 @@ struct write_dds_data : public dds_data
 };
 
 extern bool is_dds_file(byte *headerBuffer, size_t size);
-extern RDResult load_dds_from_file(StreamReader *reader, read_dds_data &data);
+// if loadData is false, only the header is read and the subresource offsets refer to the file, so
+// the data can be read on demand. Files where the data needs fixing up on load are always loaded.
+extern RDResult load_dds_from_file(StreamReader *reader, read_dds_data &data, bool loadData = true);
 extern RDResult write_dds_to_file(FILE *f, const write_dds_data &data);
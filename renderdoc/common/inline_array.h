@@ -0,0 +1,157 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2023 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdlib.h>
+#include <string.h>
+#include <type_traits>
+#include "api/replay/rdcarray.h"
+
+// an array with storage for N elements inline, which only goes to the heap once it grows past
+// that. For temporary arrays built on every call in hot paths - e.g. the barriers in a single
+// vkCmdPipelineBarrier - where the common case is a handful of elements and an allocation (and any
+// contention on the allocator between recording threads) would cost more than the work itself.
+//
+// Only the subset of rdcarray's interface needed for building and consuming such arrays is
+// provided, and elements must be trivially copyable so they can be moved around with memcpy.
+template <typename T, size_t N>
+class rdcinlinearray
+{
+  static_assert(std::is_trivially_copyable<T>::value,
+                "rdcinlinearray should only be used with POD types like Vulkan structs.");
+
+public:
+  rdcinlinearray() = default;
+  ~rdcinlinearray()
+  {
+    if(elems != inlineElems)
+      free(elems);
+  }
+  rdcinlinearray(const rdcinlinearray &o) { assign(o.data(), o.size()); }
+  rdcinlinearray &operator=(const rdcinlinearray &o)
+  {
+    if(this != &o)
+    {
+      clear();
+      assign(o.data(), o.size());
+    }
+    return *this;
+  }
+
+  /////////////////////////////////////////////////////////////////
+  // simple accessors
+  T &operator[](size_t i) { return elems[i]; }
+  const T &operator[](size_t i) const { return elems[i]; }
+  T *data() { return elems; }
+  const T *data() const { return elems; }
+  T *begin() { return elems; }
+  T *end() { return elems + usedCount; }
+  const T *begin() const { return elems; }
+  const T *end() const { return elems + usedCount; }
+  T &front() { return elems[0]; }
+  T &back() { return elems[usedCount - 1]; }
+  const T &front() const { return elems[0]; }
+  const T &back() const { return elems[usedCount - 1]; }
+  size_t size() const { return usedCount; }
+  size_t capacity() const { return allocatedCount; }
+  bool empty() const { return usedCount == 0; }
+  // true if the elements are still in the inline storage
+  bool isInline() const { return elems == inlineElems; }
+  /////////////////////////////////////////////////////////////////
+  // modifiers
+
+  void reserve(size_t s)
+  {
+    if(s <= allocatedCount)
+      return;
+
+    // grow exponentially, the same as rdcarray
+    size_t newCapacity = allocatedCount * 2;
+    if(newCapacity < s)
+      newCapacity = s;
+
+    T *newElems = (T *)malloc(newCapacity * sizeof(T));
+    if(!newElems)
+      RENDERDOC_OutOfMemory(newCapacity * sizeof(T));
+
+    memcpy(newElems, elems, usedCount * sizeof(T));
+
+    if(elems != inlineElems)
+      free(elems);
+
+    elems = newElems;
+    allocatedCount = newCapacity;
+  }
+
+  void resize(size_t s)
+  {
+    reserve(s);
+    for(size_t i = usedCount; i < s; i++)
+      elems[i] = T();
+    usedCount = s;
+  }
+
+  void push_back(const T &el)
+  {
+    // el could point into our own storage, so copy it before growing
+    if(usedCount == allocatedCount)
+    {
+      T copy = el;
+      reserve(usedCount + 1);
+      elems[usedCount++] = copy;
+      return;
+    }
+
+    elems[usedCount++] = el;
+  }
+
+  void append(const T *in, size_t count)
+  {
+    reserve(usedCount + count);
+    memcpy(elems + usedCount, in, count * sizeof(T));
+    usedCount += count;
+  }
+
+  void append(const rdcarray<T> &in) { append(in.data(), in.size()); }
+  void assign(const T *in, size_t count)
+  {
+    usedCount = 0;
+    append(in, count);
+  }
+
+  void pop_back()
+  {
+    if(usedCount > 0)
+      usedCount--;
+  }
+
+  // keeps any heap storage, so the array can be re-used without re-allocating
+  void clear() { usedCount = 0; }
+private:
+  T inlineElems[N];
+  T *elems = inlineElems;
+  size_t usedCount = 0;
+  size_t allocatedCount = N;
+};
@@ -31,9 +31,28 @@
 
 static const uint32_t ShaderCacheMagic = MAKE_FOURCC('R', 'D', '$', '$');
 
-template <typename ResultType, typename ShaderCallbacks>
+// a wider key for caches where a 32-bit hash collision would matter, e.g. for content that's keyed
+// on arbitrary application shaders rather than our own built-in ones
+struct ShaderCacheHash128
+{
+  uint64_t hash[2] = {};
+
+  bool operator<(const ShaderCacheHash128 &o) const
+  {
+    if(hash[0] != o.hash[0])
+      return hash[0] < o.hash[0];
+    return hash[1] < o.hash[1];
+  }
+  bool operator==(const ShaderCacheHash128 &o) const
+  {
+    return hash[0] == o.hash[0] && hash[1] == o.hash[1];
+  }
+};
+
+// the hash type can be any plain-old-data key with a strict ordering, usually uint32_t
+template <typename HashType, typename ResultType, typename ShaderCallbacks>
 bool LoadShaderCache(const rdcstr &filename, const uint32_t magicNumber, const uint32_t versionNumber,
-                     std::map<uint32_t, ResultType> &resultCache, const ShaderCallbacks &callbacks)
+                     std::map<HashType, ResultType> &resultCache, const ShaderCallbacks &callbacks)
 {
   rdcstr shadercache = FileIO::GetAppFolderFilename(filename);
 
@@ -62,7 +81,8 @@ bool LoadShaderCache(const rdcstr &filename, const uint32_t magicNumber, const u
 
   for(uint32_t i = 0; i < numentries; i++)
   {
-    uint32_t hash = 0, length = 0;
+    HashType hash = {};
+    uint32_t length = 0;
     compressedReader.Read(hash);
     compressedReader.Read(length);
 
@@ -85,25 +105,32 @@ bool LoadShaderCache(const rdcstr &filename, const uint32_t magicNumber, const u
   return ret && !compressedReader.IsErrored() && !fileReader.IsErrored();
 }
 
-template <typename ResultType, typename ShaderCallbacks>
+template <typename HashType, typename ResultType, typename ShaderCallbacks>
 void SaveShaderCache(const rdcstr &filename, uint32_t magicNumber, uint32_t versionNumber,
-                     const std::map<uint32_t, ResultType> &cache, const ShaderCallbacks &callbacks)
+                     const std::map<HashType, ResultType> &cache, const ShaderCallbacks &callbacks)
 {
   rdcstr shadercache = FileIO::GetAppFolderFilename(filename);
 
-  FILE *f = FileIO::fopen(shadercache, FileIO::WriteBinary);
+  // several replay processes can share a cache, so write to a file of our own and move it into
+  // place when complete. That way a reader never sees a partially written cache, and the last
+  // writer wins.
+  rdcstr tempcache = StringFormat::Fmt("%s.%u.tmp", shadercache.c_str(), Process::GetCurrentPID());
+
+  FILE *f = FileIO::fopen(tempcache, FileIO::WriteBinary);
 
   if(!f)
   {
     RDCERR("Error opening shader cache for write");
+    for(auto it = cache.begin(); it != cache.end(); ++it)
+      callbacks.Destroy(it->second);
     return;
   }
 
-  StreamWriter fileWriter(f, Ownership::Stream);
+  StreamWriter *fileWriter = new StreamWriter(f, Ownership::Stream);
 
-  fileWriter.Write(ShaderCacheMagic);
-  fileWriter.Write(magicNumber);
-  fileWriter.Write(versionNumber);
+  fileWriter->Write(ShaderCacheMagic);
+  fileWriter->Write(magicNumber);
+  fileWriter->Write(versionNumber);
 
   uint32_t numentries = (uint32_t)cache.size();
 
@@ -111,30 +138,49 @@ void SaveShaderCache(const rdcstr &filename, uint32_t magicNumber, uint32_t vers
 
   // hash + length + data for each entry
   for(auto it = cache.begin(); it != cache.end(); ++it)
-    uncompressedSize += sizeof(uint32_t) * 2 + callbacks.GetSize(it->second);
-
-  fileWriter.Write(uncompressedSize);
+    uncompressedSize += sizeof(HashType) + sizeof(uint32_t) + callbacks.GetSize(it->second);
 
-  StreamWriter compressedWriter(new ZSTDCompressor(&fileWriter, Ownership::Nothing),
-                                Ownership::Stream);
+  fileWriter->Write(uncompressedSize);
 
-  compressedWriter.Write(numentries);
+  bool success = true;
 
-  for(auto it = cache.begin(); it != cache.end(); ++it)
   {
-    uint32_t hash = it->first;
-    uint32_t len = callbacks.GetSize(it->second);
-    const byte *data = callbacks.GetData(it->second);
+    StreamWriter compressedWriter(new ZSTDCompressor(fileWriter, Ownership::Nothing),
+                                  Ownership::Stream);
 
-    compressedWriter.Write(hash);
-    compressedWriter.Write(len);
-    compressedWriter.Write(data, len);
+    compressedWriter.Write(numentries);
 
-    callbacks.Destroy(it->second);
+    for(auto it = cache.begin(); it != cache.end(); ++it)
+    {
+      HashType hash = it->first;
+      uint32_t len = callbacks.GetSize(it->second);
+      const byte *data = callbacks.GetData(it->second);
+
+      compressedWriter.Write(hash);
+      compressedWriter.Write(len);
+      compressedWriter.Write(data, len);
+
+      callbacks.Destroy(it->second);
+    }
+
+    compressedWriter.Finish();
+
+    success = !compressedWriter.IsErrored();
   }
 
-  compressedWriter.Finish();
+  uint64_t compressedSize = fileWriter->GetOffset();
+  success = success && !fileWriter->IsErrored();
+
+  // close the file before moving it
+  delete fileWriter;
+
+  if(!success || !FileIO::Move(tempcache, shadercache, true))
+  {
+    RDCERR("Error writing shader cache %s", shadercache.c_str());
+    FileIO::Delete(tempcache);
+    return;
+  }
 
   RDCDEBUG("Successfully wrote %u entries to cache, compressed from %llu to %llu", numentries,
-           uncompressedSize, fileWriter.GetOffset());
+           uncompressedSize, compressedSize);
 }
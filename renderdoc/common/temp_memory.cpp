@@ -0,0 +1,262 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2023 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "temp_memory.h"
+#include "os/os_specific.h"
+
+// the first stack block on each thread. Most unwrapping needs far less than this
+static const size_t StackBlockSize = 64 * 1024;
+// ring memory is allocated in multiples of this
+static const size_t RingBlockSize = 4 * 1024 * 1024;
+
+struct TempMemoryThreadData
+{
+  struct Block
+  {
+    byte *memory;
+    size_t size;
+  };
+
+  // the stack is a list of blocks so that growing it never moves memory that's in use. Blocks past
+  // the current one hold nothing and are kept for re-use.
+  rdcarray<Block> blocks;
+  size_t curBlock = 0;
+  size_t curOffset = 0;
+
+  byte *ring = NULL;
+  byte *ringCur = NULL;
+  size_t ringSize = 0;
+  // rings that were outgrown. Allocations from them may still be in use so they're kept until
+  // shutdown
+  rdcarray<byte *> oldRings;
+
+  ~TempMemoryThreadData()
+  {
+    for(Block &b : blocks)
+      delete[] b.memory;
+    for(byte *r : oldRings)
+      delete[] r;
+    delete[] ring;
+  }
+
+  // returns memory at the top of the stack, moving on to a new block if it doesn't fit in the
+  // current one. Only commits the memory if advance is true.
+  byte *Top(size_t s, bool advance)
+  {
+    s = AlignUp(s, size_t(16));
+
+    while(true)
+    {
+      if(curBlock == blocks.size())
+      {
+        size_t size = StackBlockSize;
+        if(!blocks.empty())
+          size = blocks.back().size * 2;
+        while(size < s)
+          size *= 2;
+        blocks.push_back({new byte[size], size});
+      }
+
+      Block &b = blocks[curBlock];
+
+      if(curOffset + s <= b.size)
+      {
+        byte *ret = b.memory + curOffset;
+        if(advance)
+          curOffset += s;
+        return ret;
+      }
+
+      // nothing is allocated in this block, so it can be replaced with a larger one
+      if(curOffset == 0)
+      {
+        delete[] b.memory;
+        while(b.size < s)
+          b.size *= 2;
+        b.memory = new byte[b.size];
+        continue;
+      }
+
+      curBlock++;
+      curOffset = 0;
+    }
+  }
+};
+
+ThreadTempMemory::ThreadTempMemory()
+{
+  m_TLSSlot = Threading::AllocateTLSSlot();
+}
+
+ThreadTempMemory::~ThreadTempMemory()
+{
+  for(TempMemoryThreadData *t : m_Threads)
+    delete t;
+}
+
+TempMemoryThreadData *ThreadTempMemory::GetThreadData()
+{
+  TempMemoryThreadData *ret = (TempMemoryThreadData *)Threading::GetTLSValue(m_TLSSlot);
+  if(ret)
+    return ret;
+
+  // slow path, once per thread
+  ret = new TempMemoryThreadData;
+  Threading::SetTLSValue(m_TLSSlot, (void *)ret);
+
+  SCOPED_LOCK(m_Lock);
+  m_Threads.push_back(ret);
+
+  return ret;
+}
+
+byte *ThreadTempMemory::GetTempMemory(size_t s)
+{
+  return GetThreadData()->Top(s, false);
+}
+
+byte *ThreadTempMemory::GetRingTempMemory(size_t s)
+{
+  TempMemoryThreadData *t = GetThreadData();
+
+  if(t->ringSize < s)
+  {
+    if(t->ring)
+    {
+      RDCWARN("More than %zu bytes needed to unwrap!", t->ringSize);
+      t->oldRings.push_back(t->ring);
+    }
+
+    t->ringSize = AlignUp(s, RingBlockSize);
+    t->ring = t->ringCur = new byte[t->ringSize];
+  }
+
+  // if we'd wrap, go back to the start
+  if(t->ringCur + s >= t->ring + t->ringSize)
+    t->ringCur = t->ring;
+
+  // save the return value and update the cur pointer
+  byte *ret = t->ringCur;
+  t->ringCur = AlignUpPtr(t->ringCur + s, 16);
+  return ret;
+}
+
+ThreadTempMemory::Scope::Scope(ThreadTempMemory &mem)
+{
+  m_Thread = mem.GetThreadData();
+  m_Block = m_Thread->curBlock;
+  m_Offset = m_Thread->curOffset;
+}
+
+ThreadTempMemory::Scope::~Scope()
+{
+  RDCASSERTMSG("Temp memory scopes released out of order",
+               m_Thread->curBlock > m_Block ||
+                   (m_Thread->curBlock == m_Block && m_Thread->curOffset >= m_Offset));
+  m_Thread->curBlock = m_Block;
+  m_Thread->curOffset = m_Offset;
+}
+
+byte *ThreadTempMemory::Scope::Alloc(size_t s)
+{
+  return m_Thread->Top(s, true);
+}
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "catch/catch.hpp"
+
+TEST_CASE("Test thread temp memory", "[tempmemory]")
+{
+  ThreadTempMemory mem;
+
+  SECTION("scoped allocations don't overlap and are released")
+  {
+    byte *top = mem.GetTempMemory(16);
+
+    {
+      ThreadTempMemory::Scope scope(mem);
+
+      uint32_t *a = scope.AllocArray<uint32_t>(100);
+      uint32_t *b = scope.AllocArray<uint32_t>(100);
+
+      CHECK(a == (uint32_t *)top);
+      CHECK((byte *)b >= (byte *)(a + 100));
+
+      for(uint32_t i = 0; i < 100; i++)
+      {
+        a[i] = i;
+        b[i] = i * 2;
+      }
+
+      {
+        ThreadTempMemory::Scope inner(mem);
+
+        // larger than a whole block, so goes into a new one without disturbing a or b
+        byte *big = inner.Alloc(1024 * 1024);
+        memset(big, 0xcc, 1024 * 1024);
+
+        // unreserved memory comes after all the reserved allocations
+        byte *scratch = mem.GetTempMemory(64);
+        CHECK((scratch >= big + 1024 * 1024 || scratch + 64 <= big));
+      }
+
+      bool intact = true;
+      for(uint32_t i = 0; i < 100; i++)
+        intact &= (a[i] == i && b[i] == i * 2);
+      CHECK(intact);
+    }
+
+    CHECK(mem.GetTempMemory(16) == top);
+  };
+
+  SECTION("ring memory")
+  {
+    byte *a = mem.GetRingTempMemory(100);
+    byte *b = mem.GetRingTempMemory(100);
+
+    CHECK(b >= a + 100);
+
+    // a request larger than the ring grows it
+    byte *c = mem.GetRingTempMemory(RingBlockSize + 1);
+    CHECK(c != NULL);
+    memset(c, 0, RingBlockSize + 1);
+  };
+
+  SECTION("threads get separate memory")
+  {
+    byte *mine = mem.GetTempMemory(16);
+    byte *theirs = NULL;
+
+    Threading::ThreadHandle th =
+        Threading::CreateThread([&mem, &theirs]() { theirs = mem.GetTempMemory(16); });
+    Threading::JoinThread(th);
+    Threading::CloseThread(th);
+
+    CHECK(theirs != NULL);
+    CHECK(theirs != mine);
+  };
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
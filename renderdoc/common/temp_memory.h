@@ -0,0 +1,89 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2023 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include "api/replay/rdcarray.h"
+#include "common/common.h"
+#include "common/threading.h"
+
+struct TempMemoryThreadData;
+
+// Per-thread scratch memory for the API wrappers, used for unwrapping structs and arrays of handles
+// before passing them on so that no allocation happens on the API call path. Each driver owns one,
+// and the memory for all threads is freed when it is destroyed.
+//
+// There are three ways to use it:
+//
+// * GetTempMemory() returns memory at the top of the thread's stack without reserving it. It is
+//   only valid until the next temp allocation on this thread, so everything needed at once should
+//   come from a single call.
+// * A Scope reserves memory with Alloc() that stays valid until the scope is destroyed, so nested
+//   functions can each take their own temporary storage. Scopes must be destroyed in reverse order.
+// * GetRingTempMemory() hands out memory from a ring buffer. Several allocations can be alive at
+//   once with no scope to manage, as long as they don't exceed the ring size in total. This is
+//   used on replay where temporary memory is held across several calls.
+class ThreadTempMemory
+{
+public:
+  ThreadTempMemory();
+  ~ThreadTempMemory();
+
+  ThreadTempMemory(const ThreadTempMemory &) = delete;
+  ThreadTempMemory &operator=(const ThreadTempMemory &) = delete;
+
+  byte *GetTempMemory(size_t s);
+  byte *GetRingTempMemory(size_t s);
+
+  class Scope
+  {
+  public:
+    Scope(ThreadTempMemory &mem);
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+    byte *Alloc(size_t s);
+
+    template <class T>
+    T *AllocArray(size_t count)
+    {
+      return (T *)Alloc(sizeof(T) * count);
+    }
+
+  private:
+    TempMemoryThreadData *m_Thread;
+    size_t m_Block, m_Offset;
+  };
+
+private:
+  friend class Scope;
+
+  TempMemoryThreadData *GetThreadData();
+
+  uint64_t m_TLSSlot;
+  Threading::CriticalSection m_Lock;
+  rdcarray<TempMemoryThreadData *> m_Threads;
+};
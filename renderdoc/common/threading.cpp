@@ -0,0 +1,134 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2023 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#include "threading.h"
+
+namespace Threading
+{
+WorkerPool::WorkerPool(uint32_t numThreads)
+{
+  m_Threads.resize(numThreads);
+  for(uint32_t i = 0; i < numThreads; i++)
+    m_Threads[i] = CreateThread([this]() { WorkerMain(); });
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    SCOPED_LOCK(m_Lock);
+    m_Shutdown = true;
+  }
+
+  m_JobsAvailable.Wake((uint32_t)m_Threads.size());
+
+  for(ThreadHandle t : m_Threads)
+  {
+    JoinThread(t);
+    CloseThread(t);
+  }
+}
+
+uint32_t WorkerPool::DefaultThreadCount()
+{
+  // leave one core for the thread that is producing work. We cap the count since the work we
+  // distribute is rarely fine-grained enough to scale beyond this, and each thread typically has
+  // its own scratch memory.
+  return RDCCLAMP(GetNumCores(), 2U, 17U) - 1;
+}
+
+void WorkerPool::AddJob(std::function<void()> job)
+{
+  if(m_Threads.empty())
+  {
+    job();
+    return;
+  }
+
+  {
+    SCOPED_LOCK(m_Lock);
+    m_Jobs.push_back(job);
+    m_Outstanding++;
+  }
+
+  m_JobsAvailable.Wake(1);
+}
+
+void WorkerPool::WaitForIdle()
+{
+  {
+    SCOPED_LOCK(m_Lock);
+    if(m_Outstanding == 0)
+      return;
+    m_Waiting = true;
+  }
+
+  m_Idle.WaitForWake();
+}
+
+void WorkerPool::WorkerMain()
+{
+  SetCurrentThreadName("RenderDoc Worker");
+
+  for(;;)
+  {
+    m_JobsAvailable.WaitForWake();
+
+    std::function<void()> job;
+
+    {
+      SCOPED_LOCK(m_Lock);
+
+      // jobs are only ever consumed by wakes, so if there's nothing left we must be shutting down
+      if(m_NextJob >= m_Jobs.size())
+      {
+        RDCASSERT(m_Shutdown);
+        return;
+      }
+
+      job.swap(m_Jobs[m_NextJob]);
+      m_NextJob++;
+
+      // once the queue has been drained, reset it so it doesn't grow unbounded
+      if(m_NextJob == m_Jobs.size())
+      {
+        m_Jobs.clear();
+        m_NextJob = 0;
+      }
+    }
+
+    job();
+
+    {
+      SCOPED_LOCK(m_Lock);
+      m_Outstanding--;
+      if(m_Outstanding == 0 && m_Waiting)
+      {
+        m_Waiting = false;
+        m_Idle.Wake(1);
+      }
+    }
+  }
+}
+};
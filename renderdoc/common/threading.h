@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <functional>
 #include "common/common.h"
 #include "os/os_specific.h"
 
@@ -110,6 +111,50 @@ public:
 private:
   SpinLock *m_Spin = NULL;
 };
+
+// A fixed set of worker threads that run queued jobs. Jobs are started in the order they are added
+// but can complete in any order. The pool is joined on destruction, so it should be scoped to the
+// operation that needs it rather than kept alive globally (which could mean joining threads during
+// module unload).
+class WorkerPool
+{
+public:
+  // create a pool with the given number of worker threads. If numThreads is 0, jobs are run
+  // immediately on the calling thread when they're added.
+  WorkerPool(uint32_t numThreads);
+  ~WorkerPool();
+
+  // the number of threads to use for a pool when there's no explicit preference
+  static uint32_t DefaultThreadCount();
+
+  uint32_t GetNumThreads() const { return (uint32_t)m_Threads.size(); }
+  void AddJob(std::function<void()> job);
+
+  // wait until all jobs that have been added so far have completed. Only one thread may wait at
+  // once.
+  void WaitForIdle();
+
+  // no copying
+  WorkerPool &operator=(const WorkerPool &other) = delete;
+  WorkerPool(const WorkerPool &other) = delete;
+
+private:
+  void WorkerMain();
+
+  rdcarray<ThreadHandle> m_Threads;
+
+  CriticalSection m_Lock;
+  rdcarray<std::function<void()>> m_Jobs;
+  size_t m_NextJob = 0;
+  uint32_t m_Outstanding = 0;
+  bool m_Waiting = false;
+  bool m_Shutdown = false;
+
+  // woken once per job added (and once per thread on shutdown)
+  Semaphore m_JobsAvailable;
+  // woken when the last outstanding job completes while someone is waiting
+  Semaphore m_Idle;
+};
 };
 
 #define SCOPED_LOCK(cs) Threading::ScopedLock CONCAT(scopedlock, __LINE__)(&cs);
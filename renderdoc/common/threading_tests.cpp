@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include "common/threading.h"
+#include "common/wrapped_pool.h"
 #include "os/os_specific.h"
 
 #if ENABLED(ENABLE_UNIT_TESTS)
@@ -71,4 +72,127 @@ TEST_CASE("Test spin lock", "[threading]")
   CHECK(finalValue == value);
 }
 
+TEST_CASE("Test worker pool", "[threading]")
+{
+  rdcarray<int32_t> results;
+  results.resize(256);
+
+  SECTION("Jobs run on worker threads")
+  {
+    Threading::WorkerPool pool(4);
+
+    CHECK(pool.GetNumThreads() == 4);
+
+    // run a couple of rounds to make sure the pool can be waited on repeatedly
+    for(int round = 0; round < 2; round++)
+    {
+      int32_t total = 0;
+
+      for(int i = 0; i < results.count(); i++)
+        pool.AddJob([&results, &total, i, round]() {
+          results[i] = i * (round + 1);
+          Atomic::Inc32(&total);
+        });
+
+      pool.WaitForIdle();
+
+      CHECK(total == results.count());
+      for(int i = 0; i < results.count(); i++)
+        CHECK(results[i] == i * (round + 1));
+    }
+  };
+
+  SECTION("Empty pool runs jobs inline")
+  {
+    Threading::WorkerPool pool(0);
+
+    uint64_t threadID = 0;
+    pool.AddJob([&threadID]() { threadID = Threading::GetCurrentID(); });
+
+    CHECK(threadID == Threading::GetCurrentID());
+
+    // waiting with nothing outstanding returns immediately
+    pool.WaitForIdle();
+  };
+
+  SECTION("Destroying the pool completes pending jobs")
+  {
+    int32_t total = 0;
+
+    {
+      Threading::WorkerPool pool(2);
+      for(int i = 0; i < 64; i++)
+        pool.AddJob([&total]() { Atomic::Inc32(&total); });
+    }
+
+    CHECK(total == 64);
+  };
+}
+
+struct PoolTestObject
+{
+  uint32_t owner;
+  uint32_t index;
+  byte padding[56];
+
+  ALLOCATE_WITH_WRAPPED_POOL(PoolTestObject);
+};
+
+WRAPPED_POOL_INST(PoolTestObject);
+
+TEST_CASE("Test wrapping pool", "[threading]")
+{
+  static const uint32_t numThreads = 8;
+  static const uint32_t numObjects = 2000;
+
+  rdcarray<Threading::ThreadHandle> threads;
+  rdcarray<uint32_t> errors;
+
+  threads.resize(numThreads);
+  errors.resize(numThreads);
+
+  for(uint32_t t = 0; t < numThreads; t++)
+  {
+    threads[t] = Threading::CreateThread([&errors, t]() {
+      rdcarray<PoolTestObject *> objs;
+      objs.resize(numObjects);
+
+      for(int loop = 0; loop < 4; loop++)
+      {
+        for(uint32_t i = 0; i < numObjects; i++)
+        {
+          objs[i] = new PoolTestObject;
+          objs[i]->owner = t;
+          objs[i]->index = i;
+        }
+
+        // if any object was handed out twice, another thread will have overwritten it
+        for(uint32_t i = 0; i < numObjects; i++)
+        {
+          if(objs[i]->owner != t || objs[i]->index != i || !PoolTestObject::IsAlloc(objs[i]))
+            errors[t]++;
+        }
+
+        // free every other object first to interleave frees with other threads' allocations
+        for(uint32_t i = 0; i < numObjects; i += 2)
+          delete objs[i];
+        for(uint32_t i = 1; i < numObjects; i += 2)
+          delete objs[i];
+      }
+    });
+  }
+
+  for(Threading::ThreadHandle t : threads)
+  {
+    Threading::JoinThread(t);
+    Threading::CloseThread(t);
+  }
+
+  for(uint32_t t = 0; t < numThreads; t++)
+    CHECK(errors[t] == 0);
+
+  PoolTestObject stackObj;
+  CHECK_FALSE(PoolTestObject::IsAlloc(&stackObj));
+}
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
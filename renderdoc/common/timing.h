@@ -55,12 +55,13 @@ public:
   void InitTimers()
   {
     m_HighPrecisionTimer.Restart();
-    m_TotalTime = m_AvgFrametime = m_MinFrametime = m_MaxFrametime = 0.0;
+    m_TotalTime = m_AvgFrametime = m_MinFrametime = m_MaxFrametime = m_LastFrametime = 0.0;
   }
 
   void UpdateTimers()
   {
-    m_FrameTimes.push_back(m_HighPrecisionTimer.GetMilliseconds());
+    m_LastFrametime = m_HighPrecisionTimer.GetMilliseconds();
+    m_FrameTimes.push_back(m_LastFrametime);
     m_TotalTime += m_FrameTimes.back();
     m_HighPrecisionTimer.Restart();
 
@@ -91,6 +92,7 @@ public:
   double GetAvgFrameTime() const { return m_AvgFrametime; }
   double GetMinFrameTime() const { return m_MinFrametime; }
   double GetMaxFrameTime() const { return m_MaxFrametime; }
+  double GetLastFrameTime() const { return m_LastFrametime; }
 private:
   PerformanceTimer m_HighPrecisionTimer;
   rdcarray<double> m_FrameTimes;
@@ -98,6 +100,7 @@ private:
   double m_AvgFrametime;
   double m_MinFrametime;
   double m_MaxFrametime;
+  double m_LastFrametime;
 };
 
 class ScopedTimer
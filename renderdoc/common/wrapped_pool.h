@@ -38,52 +38,55 @@ public:
   typedef C Type;
 };
 
-// allocate each class in its own pool so we can identify the type by the pointer
+// allocate each class in its own pool so we can identify the type by the pointer.
+//
+// Allocation, deallocation and IsAlloc are all lock-free. Each pool keeps its free items on an
+// index-linked stack with a tagged head, and additional pools are published into a fixed array
+// of slots with a single compare-exchange so they never move or disappear while in use.
 template <typename WrapType, bool DebugClear = true>
 class WrappingPool
 {
 public:
   void *Allocate()
   {
-    SCOPED_LOCK(m_Lock);
-
     // try and allocate from immediate pool
     void *ret = m_ImmediatePool.Allocate();
     if(ret != NULL)
       return ret;
 
     // fall back to additional pools, if there are any
-    for(size_t i = 0; i < m_AdditionalPools.size(); i++)
+    size_t i = 0;
+    for(; i < MaxAdditionalPools; i++)
     {
-      ret = m_AdditionalPools[i]->Allocate();
+      ItemPool *pool = GetAdditionalPool(i);
+
+      if(pool == NULL)
+      {
+        // allocate a new additional pool and try to publish it in this slot. If another thread
+        // beat us to it use theirs instead
+        ItemPool *newPool = new ItemPool(i + 1);
+        pool = (ItemPool *)Atomic::CmpExchPtr((void **)&m_AdditionalPools[i], NULL, newPool);
+        if(pool == NULL)
+          pool = newPool;
+        else
+          delete newPool;
+      }
+
+      ret = pool->Allocate();
       if(ret != NULL)
         return ret;
     }
 
-    // allocate a new additional pool and use that to allocate from
-    m_AdditionalPools.push_back(new ItemPool(m_AdditionalPools.size() + 1));
-
-    return m_AdditionalPools.back()->Allocate();
+    RDCERR("Out of pools for wrapped objects - %zu pools allocated", i);
+    return NULL;
   }
 
   bool IsAlloc(const void *p)
   {
-    // we can check the immediate pool without locking
     if(m_ImmediatePool.IsAlloc(p))
       return true;
 
-    // if we have additional pools, lock and check them.
-    // TODO: Check for additional pools in a lock-free manner,
-    // to prevent the cost of locking if there are no more pools.
-    {
-      SCOPED_LOCK(m_Lock);
-
-      for(size_t i = 0; i < m_AdditionalPools.size(); i++)
-        if(m_AdditionalPools[i]->IsAlloc(p))
-          return true;
-    }
-
-    return false;
+    return FindAdditionalPool(p) != NULL;
   }
 
   void Deallocate(void *p)
@@ -91,25 +94,19 @@ public:
     if(p == NULL)
       return;
 
-    SCOPED_LOCK(m_Lock);
-
     // try immediate pool
     if(m_ImmediatePool.IsAlloc(p))
     {
       m_ImmediatePool.Deallocate(p);
       return;
     }
-    else if(!m_AdditionalPools.empty())
+
+    // fall back and try additional pools
+    ItemPool *pool = FindAdditionalPool(p);
+    if(pool)
     {
-      // fall back and try additional pools
-      for(size_t i = 0; i < m_AdditionalPools.size(); i++)
-      {
-        if(m_AdditionalPools[i]->IsAlloc(p))
-        {
-          m_AdditionalPools[i]->Deallocate(p);
-          return;
-        }
-      }
+      pool->Deallocate(p);
+      return;
     }
 
     // this is an error - deleting an object that we don't recognise
@@ -122,14 +119,13 @@ private:
   WrappingPool() : m_ImmediatePool(0) {}
   ~WrappingPool()
   {
-    for(size_t i = 0; i < m_AdditionalPools.size(); i++)
+    for(size_t i = 0; i < MaxAdditionalPools && m_AdditionalPools[i]; i++)
+    {
       delete m_AdditionalPools[i];
-
-    m_AdditionalPools.clear();
+      m_AdditionalPools[i] = NULL;
+    }
   }
 
-  Threading::CriticalSection m_Lock;
-
   struct ItemPool
   {
     ItemPool(size_t poolIndex)
@@ -158,26 +154,49 @@ private:
       count = size / itemSize;
 
       items = (WrapType *)(new uint8_t[count * itemSize]);
-      freeStack = new int[count];
-      for(int i = 0; i < (int)count; ++i)
-      {
-        freeStack[i] = i;
-      }
-      freeStackHead = count;
+      nextFree = new int32_t[count];
+      for(int32_t i = 0; i < (int32_t)count; ++i)
+        nextFree[i] = i + 1 < (int32_t)count ? i + 1 : -1;
+      freeHead = MakeHead(0, 0);
     }
     ~ItemPool()
     {
       delete[](uint8_t *) items;
-      delete[] freeStack;
+      delete[] nextFree;
     }
+
+    // the head of the free stack is the index of the first free item in the low 32 bits, or -1
+    // when empty, and a tag in the upper 32 bits which is bumped on every change. The tag means a
+    // compare-exchange fails if the head was popped and pushed back by other threads in between
+    // reading it and its next link.
+    static int64_t MakeHead(int64_t tag, int32_t idx)
+    {
+      return int64_t(uint64_t(tag) << 32) | int64_t(uint32_t(idx));
+    }
+    static int32_t HeadIndex(int64_t head) { return int32_t(uint32_t(uint64_t(head))); }
+    static int64_t HeadTag(int64_t head) { return int64_t(uint64_t(head) >> 32); }
+
     void *Allocate()
     {
-      if(freeStackHead == 0)
+      int64_t head = freeHead;
+      for(;;)
       {
-        return NULL;
+        int32_t idx = HeadIndex(head);
+        if(idx < 0)
+          return NULL;
+
+        // this can read a stale link if another thread pops idx first, but then the tag will have
+        // changed and the compare-exchange fails
+        int64_t newHead = MakeHead(HeadTag(head) + 1, ((volatile int32_t *)nextFree)[idx]);
+
+        int64_t prev = Atomic::CmpExch64(&freeHead, head, newHead);
+        if(prev == head)
+          break;
+
+        head = prev;
       }
-      --freeStackHead;
-      void *ret = items + freeStack[freeStackHead];
+
+      void *ret = items + HeadIndex(head);
 
 #if ENABLED(RDOC_DEVEL)
       const size_t itemSize = sizeof(WrapType);
@@ -189,27 +208,59 @@ private:
 
     void Deallocate(void *p)
     {
-      int idx = (int)((WrapType *)p - &items[0]);
-
-      freeStack[freeStackHead] = idx;
-      ++freeStackHead;
+      int32_t idx = (int32_t)((WrapType *)p - &items[0]);
 
 #if ENABLED(RDOC_DEVEL)
       const size_t itemSize = sizeof(WrapType);
       if(DebugClear)
         memset(p, 0xfe, itemSize);
 #endif
+
+      int64_t head = freeHead;
+      for(;;)
+      {
+        ((volatile int32_t *)nextFree)[idx] = HeadIndex(head);
+
+        int64_t prev = Atomic::CmpExch64(&freeHead, head, MakeHead(HeadTag(head) + 1, idx));
+        if(prev == head)
+          break;
+
+        head = prev;
+      }
     }
 
     bool IsAlloc(const void *p) const { return p >= &items[0] && p < &items[count]; }
     WrapType *items;
     size_t count;
-    int *freeStack;
-    size_t freeStackHead;
+    int32_t *nextFree;
+    int64_t freeHead;
   };
 
+  ItemPool *GetAdditionalPool(size_t i) const
+  {
+    return ((ItemPool *volatile *)m_AdditionalPools)[i];
+  }
+
+  ItemPool *FindAdditionalPool(const void *p) const
+  {
+    // pools are only ever appended, so the first empty slot ends the list
+    for(size_t i = 0; i < MaxAdditionalPools; i++)
+    {
+      ItemPool *pool = GetAdditionalPool(i);
+      if(pool == NULL)
+        break;
+      if(pool->IsAlloc(p))
+        return pool;
+    }
+
+    return NULL;
+  }
+
+  // with 512kB per pool this allows for up to 2GB of any one type
+  static const size_t MaxAdditionalPools = 4096;
+
   ItemPool m_ImmediatePool;
-  rdcarray<ItemPool *> m_AdditionalPools;
+  ItemPool *m_AdditionalPools[MaxAdditionalPools] = {};
 
   friend typename FriendMaker<WrapType>::Type;
 };
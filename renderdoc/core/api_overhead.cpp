@@ -0,0 +1,177 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2023 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "api_overhead.h"
+#include "common/formatting.h"
+#include "common/threading.h"
+#include "core/settings.h"
+#include "os/os_specific.h"
+
+RDOC_CONFIG(bool, Capture_APIOverheadCounters, false,
+            "Time every hooked API call, to measure the overhead RenderDoc adds outside of a "
+            "capture. Displayed on the overlay and available through the in-application API.");
+
+namespace APIOverhead
+{
+bool enabled = false;
+
+// counters are registered from hooked functions which can be called during shutdown, so these are
+// deliberately never destroyed
+static Threading::CriticalSection &counterLock = *(new Threading::CriticalSection);
+static rdcarray<APIOverheadCounter *> &counters = *(new rdcarray<APIOverheadCounter *>);
+static uint64_t currentScopeSlot = 0;
+
+void Init()
+{
+  if(Capture_APIOverheadCounters())
+    Enable();
+}
+
+void Enable()
+{
+  SCOPED_LOCK(counterLock);
+
+  if(enabled)
+    return;
+
+  currentScopeSlot = Threading::AllocateTLSSlot();
+  enabled = true;
+}
+
+void AddDriverTicks(uint64_t ticks)
+{
+  ScopedAPIOverhead *scope = (ScopedAPIOverhead *)Threading::GetTLSValue(currentScopeSlot);
+  if(scope)
+    scope->m_DriverTicks += ticks;
+}
+
+void AddSerialisedBytes(uint64_t bytes)
+{
+  ScopedAPIOverhead *scope = (ScopedAPIOverhead *)Threading::GetTLSValue(currentScopeSlot);
+  if(scope)
+    scope->m_SerialisedBytes += bytes;
+}
+
+static uint64_t TicksToNanoseconds(int64_t ticks)
+{
+  // tick frequency is in ticks per millisecond
+  return uint64_t(double(ticks) * 1.0e6 / Timing::GetTickFrequency());
+}
+
+rdcarray<APIOverheadStat> GetStats()
+{
+  rdcarray<APIOverheadStat> ret;
+
+  SCOPED_LOCK(counterLock);
+
+  for(APIOverheadCounter *c : counters)
+  {
+    int64_t calls = Atomic::ExchAdd64(&c->calls, 0);
+    if(calls == 0)
+      continue;
+
+    int64_t total = Atomic::ExchAdd64(&c->totalTicks, 0);
+    int64_t driver = Atomic::ExchAdd64(&c->driverTicks, 0);
+    int64_t bytes = Atomic::ExchAdd64(&c->serialisedBytes, 0);
+
+    ret.push_back({c->function, (uint64_t)calls, TicksToNanoseconds(RDCMAX((int64_t)0, total - driver)),
+                   TicksToNanoseconds(driver), (uint64_t)bytes});
+  }
+
+  return ret;
+}
+
+rdcstr GetOverlayText()
+{
+  int64_t calls = 0, total = 0, driver = 0;
+  const char *worstFunc = NULL;
+  int64_t worstTicks = 0;
+
+  {
+    SCOPED_LOCK(counterLock);
+
+    for(APIOverheadCounter *c : counters)
+    {
+      int64_t curCalls = Atomic::ExchAdd64(&c->calls, 0);
+      int64_t curTotal = Atomic::ExchAdd64(&c->totalTicks, 0);
+      int64_t curDriver = Atomic::ExchAdd64(&c->driverTicks, 0);
+
+      int64_t wrapperTicks =
+          (curTotal - c->overlayTotalTicks) - (curDriver - c->overlayDriverTicks);
+
+      calls += curCalls - c->overlayCalls;
+      total += curTotal - c->overlayTotalTicks;
+      driver += curDriver - c->overlayDriverTicks;
+
+      if(wrapperTicks > worstTicks)
+      {
+        worstTicks = wrapperTicks;
+        worstFunc = c->function;
+      }
+
+      c->overlayCalls = curCalls;
+      c->overlayTotalTicks = curTotal;
+      c->overlayDriverTicks = curDriver;
+    }
+  }
+
+  const double msPerTick = 1.0 / Timing::GetTickFrequency();
+
+  rdcstr ret = StringFormat::Fmt("%lld API calls, %.2f ms in RenderDoc, %.2f ms in driver.", calls,
+                                 double(RDCMAX((int64_t)0, total - driver)) * msPerTick,
+                                 double(driver) * msPerTick);
+
+  if(worstFunc)
+    ret += StringFormat::Fmt(" Most: %s %.2f ms.", worstFunc, double(worstTicks) * msPerTick);
+
+  return ret;
+}
+};
+
+APIOverheadCounter::APIOverheadCounter(const char *func) : function(func)
+{
+  SCOPED_LOCK(APIOverhead::counterLock);
+  APIOverhead::counters.push_back(this);
+}
+
+void ScopedAPIOverhead::Begin(APIOverheadCounter &counter)
+{
+  m_Counter = &counter;
+  m_Prev = (ScopedAPIOverhead *)Threading::GetTLSValue(APIOverhead::currentScopeSlot);
+  Threading::SetTLSValue(APIOverhead::currentScopeSlot, this);
+  m_Start = Timing::GetTick();
+}
+
+void ScopedAPIOverhead::End()
+{
+  uint64_t total = Timing::GetTick() - m_Start;
+
+  Atomic::Inc64(&m_Counter->calls);
+  Atomic::ExchAdd64(&m_Counter->totalTicks, (int64_t)total);
+  Atomic::ExchAdd64(&m_Counter->driverTicks, (int64_t)m_DriverTicks);
+  if(m_SerialisedBytes)
+    Atomic::ExchAdd64(&m_Counter->serialisedBytes, (int64_t)m_SerialisedBytes);
+
+  Threading::SetTLSValue(APIOverhead::currentScopeSlot, m_Prev);
+}
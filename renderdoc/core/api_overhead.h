@@ -0,0 +1,112 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2023 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include "api/replay/rdcarray.h"
+#include "api/replay/rdcstr.h"
+#include "common/common.h"
+
+// Optional counters of the time spent in each hooked API entry point, split into the time spent in
+// the real driver call and the time RenderDoc's wrapping added on top. These cost a couple of
+// timer queries per call so they are off unless enabled by config or through the in-app API.
+
+struct APIOverheadCounter
+{
+  APIOverheadCounter(const char *func);
+
+  const char *function;
+  int64_t calls = 0;
+  int64_t totalTicks = 0;
+  int64_t driverTicks = 0;
+  int64_t serialisedBytes = 0;
+
+  // snapshot at the last overlay update, to display per-frame numbers
+  int64_t overlayCalls = 0;
+  int64_t overlayTotalTicks = 0;
+  int64_t overlayDriverTicks = 0;
+};
+
+struct APIOverheadStat
+{
+  const char *function;
+  uint64_t calls;
+  uint64_t wrapperNanoseconds;
+  uint64_t driverNanoseconds;
+  uint64_t serialisedBytes;
+};
+
+namespace APIOverhead
+{
+extern bool enabled;
+
+inline bool IsEnabled()
+{
+  return enabled;
+}
+
+void Init();
+void Enable();
+
+// add time spent in the real driver to the entry point currently executing on this thread
+void AddDriverTicks(uint64_t ticks);
+// add bytes serialised into a chunk to the entry point currently executing on this thread
+void AddSerialisedBytes(uint64_t bytes);
+
+rdcarray<APIOverheadStat> GetStats();
+rdcstr GetOverlayText();
+};
+
+class ScopedAPIOverhead
+{
+public:
+  ScopedAPIOverhead(APIOverheadCounter &counter)
+  {
+    if(APIOverhead::IsEnabled())
+      Begin(counter);
+  }
+  ~ScopedAPIOverhead()
+  {
+    if(m_Counter)
+      End();
+  }
+
+private:
+  friend void APIOverhead::AddDriverTicks(uint64_t ticks);
+  friend void APIOverhead::AddSerialisedBytes(uint64_t bytes);
+
+  void Begin(APIOverheadCounter &counter);
+  void End();
+
+  APIOverheadCounter *m_Counter = NULL;
+  ScopedAPIOverhead *m_Prev = NULL;
+  uint64_t m_Start = 0;
+  uint64_t m_DriverTicks = 0;
+  uint64_t m_SerialisedBytes = 0;
+};
+
+// placed at the start of a hooked entry point to count its calls and time
+#define SCOPED_API_OVERHEAD(func)                                      \
+  static APIOverheadCounter CONCAT(apiOverheadCounter, __LINE__)(func); \
+  ScopedAPIOverhead CONCAT(apiOverheadScope, __LINE__)(CONCAT(apiOverheadCounter, __LINE__));
@@ -29,6 +29,8 @@
 #include "api/replay/version.h"
 #include "common/common.h"
 #include "common/threading.h"
+#include "core/api_overhead.h"
+#include "core/memory_accounting.h"
 #include "core/settings.h"
 #include "hooks/hooks.h"
 #include "maths/formatpacking.h"
@@ -54,6 +56,127 @@ RDOC_DEBUG_CONFIG(bool, Capture_Debug_SnapshotDiagnosticLog, false,
 RDOC_CONFIG(rdcarray<rdcstr>, DXBC_Debug_SearchDirPaths, {},
             "Paths to search for separated shader debug PDBs.");
 
+RDOC_CONFIG(uint32_t, Capture_MapDiffMergeGap, 4096,
+            "When looking for changes in persistently mapped memory, changed ranges separated by "
+            "at most this many unchanged bytes are merged and serialised together.");
+
+RDOC_CONFIG(bool, Capture_TrackMapWrites, false,
+            "Where the OS supports it, track which pages of persistently mapped memory are written "
+            "by the application instead of comparing against a copy of the last serialised data.");
+
+RDOC_CONFIG(bool, Capture_BackgroundFileWriting, false,
+            "Build capture files in memory and compress and write them to disk on a background "
+            "thread, so the application is stalled for less time when a capture ends. Captures "
+            "only appear in the list of captures once they have been fully written.");
+
+RDOC_CONFIG(bool, Capture_StreamToTargetControl, false,
+            "While a target control client is connected, keep finished captures in memory and send "
+            "them straight to it when requested instead of writing them to local storage first. "
+            "For devices where storage is slow or limited. Captures that are never retrieved are "
+            "written to disk on shutdown.");
+
+RDOC_CONFIG(uint32_t, Capture_InitialStateSerialiseThreads, 4,
+            "How many threads to use to serialise initial contents when writing a capture, for "
+            "APIs that support it. Chunks are still written in the same order. 1 serialises "
+            "everything on the capturing thread.");
+
+RDOC_CONFIG(bool, Capture_ZstdFrameCapture, false,
+            "Compress the frame capture section with zstd instead of LZ4, for APIs that support "
+            "it. This takes longer to write but produces noticeably smaller captures, which is "
+            "worthwhile when they must be copied off a device over a slow link.");
+
+RDOC_CONFIG(uint32_t, Capture_PreSnapshotFrames, 0,
+            "When a capture is queued for a future frame, prepare the initial contents of dirty "
+            "resources spread over this many frames beforehand, so the capture only needs to "
+            "re-prepare those written since. 0 prepares everything when the capture starts.");
+
+RDOC_CONFIG(uint32_t, Capture_FrameTimeSpikeMS, 0,
+            "If non-zero, capture the frame following any frame that takes longer than this many "
+            "milliseconds, to catch intermittent hitches. Once triggered, it re-arms after a "
+            "second's worth of frames under the threshold.");
+
+RDOC_CONFIG(bool, Capture_OverlayIndicatorOnly, false,
+            "Replace the in-application overlay text with a small blank box that only shows "
+            "RenderDoc is attached, to keep the cost of drawing the overlay to a minimum each "
+            "frame.");
+
+RDOC_CONFIG(bool, Replay_CacheAvailableGPUs, true,
+            "Keep the list of available GPUs on disk until the next reboot, so that replay "
+            "processes don't need to initialise every API to enumerate them.");
+
+static const uint32_t GPUListCacheVersion = 1;
+
+// the GPU list only changes with new hardware or drivers, which almost always means a reboot. The
+// boot time is estimated from the monotonic clock so it isn't exact, and sleeping moves it
+static uint64_t GetApproxBootTime()
+{
+  uint64_t uptime = uint64_t(double(Timing::GetTick()) / Timing::GetTickFrequency() / 1000.0);
+  return Timing::GetUnixTimestamp() - uptime;
+}
+
+static bool LoadCachedGPUList(rdcarray<GPUDevice> &gpus)
+{
+  FILE *f = FileIO::fopen(FileIO::GetAppFolderFilename("gpus.cache"), FileIO::ReadBinary);
+  if(!f)
+    return false;
+
+  ReadSerialiser ser(new StreamReader(f), Ownership::Stream);
+
+  uint32_t version = 0;
+  rdcstr build;
+  uint64_t bootTime = 0;
+  rdcarray<GPUDevice> cached;
+
+  ser.Serialise("version"_lit, version);
+  if(version != GPUListCacheVersion || ser.IsErrored())
+    return false;
+
+  ser.Serialise("build"_lit, build);
+  ser.Serialise("bootTime"_lit, bootTime);
+  ser.Serialise("gpus"_lit, cached);
+
+  if(ser.IsErrored() || build != GitVersionHash || cached.empty())
+    return false;
+
+  uint64_t curBootTime = GetApproxBootTime();
+  uint64_t drift = curBootTime > bootTime ? curBootTime - bootTime : bootTime - curBootTime;
+  if(drift > 60)
+    return false;
+
+  gpus.swap(cached);
+  return true;
+}
+
+static void SaveCachedGPUList(rdcarray<GPUDevice> &gpus)
+{
+  rdcstr filename = FileIO::GetAppFolderFilename("gpus.cache");
+  rdcstr tempfile = StringFormat::Fmt("%s.%u.tmp", filename.c_str(), Process::GetCurrentPID());
+
+  FILE *f = FileIO::fopen(tempfile, FileIO::WriteBinary);
+  if(!f)
+    return;
+
+  bool success = false;
+
+  {
+    WriteSerialiser ser(new StreamWriter(f, Ownership::Stream), Ownership::Stream);
+
+    uint32_t version = GPUListCacheVersion;
+    rdcstr build = GitVersionHash;
+    uint64_t bootTime = GetApproxBootTime();
+
+    ser.Serialise("version"_lit, version);
+    ser.Serialise("build"_lit, build);
+    ser.Serialise("bootTime"_lit, bootTime);
+    ser.Serialise("gpus"_lit, gpus);
+
+    success = !ser.IsErrored();
+  }
+
+  if(!success || !FileIO::Move(tempfile, filename, true))
+    FileIO::Delete(tempfile);
+}
+
 void LogReplayOptions(const ReplayOptions &opts)
 {
   RDCLOG("%s API validation during replay", (opts.apiValidation ? "Enabling" : "Not enabling"));
@@ -200,6 +323,18 @@ rdcstr DoStringise(const RDCDriver &el)
   END_ENUM_STRINGISE();
 }
 
+template <>
+rdcstr DoStringise(const LoadProgress &el)
+{
+  BEGIN_ENUM_STRINGISE(LoadProgress);
+  {
+    STRINGISE_ENUM_CLASS(DebugManagerInit);
+    STRINGISE_ENUM_CLASS(FileInitialRead);
+    STRINGISE_ENUM_CLASS(FrameEventsRead);
+  }
+  END_ENUM_STRINGISE();
+}
+
 template <>
 rdcstr DoStringise(const ReplayLogType &el)
 {
@@ -530,6 +665,9 @@ void RenderDoc::Initialise()
     RDCLOGOUTPUT();
 
   ProcessConfig();
+
+  if(!IsReplayApp())
+    APIOverhead::Init();
 }
 
 RenderDoc::~RenderDoc()
@@ -545,16 +683,40 @@ RenderDoc::~RenderDoc()
 
   for(size_t i = 0; i < m_Captures.size(); i++)
   {
+    auto streamed = m_StreamedCaptures.find(m_Captures[i].path);
+
     if(m_Captures[i].retrieved)
     {
       RDCLOG("Removing remotely retrieved capture %s", m_Captures[i].path.c_str());
       FileIO::Delete(m_Captures[i].path);
     }
+    else if(streamed != m_StreamedCaptures.end())
+    {
+      // never retrieved, so write it out rather than losing it
+      RDCLOG("Writing unretrieved in-memory capture to %s", m_Captures[i].path.c_str());
+      FileIO::WriteAll(m_Captures[i].path, streamed->second);
+    }
     else
     {
       RDCLOG("'Leaking' unretrieved capture %s", m_Captures[i].path.c_str());
     }
   }
+  m_StreamedCaptures.clear();
+
+  for(auto it = m_PendingThumbnails.begin(); it != m_PendingThumbnails.end(); ++it)
+    delete it->second;
+  m_PendingThumbnails.clear();
+
+  // give any capture being written in the background a chance to finish. We can't join the thread
+  // for the same reason as the target control thread below, so poll until it's done.
+  if(m_CaptureWriteThread)
+  {
+    for(int i = 0; i < 30000 / 50 && Atomic::CmpExch32(&m_CaptureWriteActive, 0, 0) != 0; i++)
+      Threading::Sleep(50);
+
+    Threading::CloseThread(m_CaptureWriteThread);
+    m_CaptureWriteThread = 0;
+  }
 
   RDCSTOPLOGGING();
 
@@ -588,6 +750,8 @@ void RenderDoc::RemoveHooks()
     UnloadCrashHandler();
   }
 
+  WaitForCaptureWriting();
+
   if(m_RemoteThread)
   {
     // explicitly wait for thread to shutdown, this call is not from module unloading and
@@ -622,7 +786,9 @@ void RenderDoc::InitialiseReplay(GlobalEnvironment env, const rdcarray<rdcstr> &
   else
     RecreateCrashHandler();
 
-  if(env.enumerateGPUs)
+  // the list from a previous process is used if it's still valid, otherwise enumerate on a thread.
+  // Anything that needs the list or creates a replay driver waits for it in SyncAvailableGPUThread
+  if(env.enumerateGPUs && !(Replay_CacheAvailableGPUs() && LoadCachedGPUList(m_AvailableGPUs)))
   {
     m_AvailableGPUThread = Threading::CreateThread([this]() {
       for(GraphicsAPI api : {GraphicsAPI::D3D11, GraphicsAPI::D3D12, GraphicsAPI::Vulkan})
@@ -728,6 +894,9 @@ void RenderDoc::InitialiseReplay(GlobalEnvironment env, const rdcarray<rdcstr> &
       {
         std::sort(dev.apis.begin(), dev.apis.end());
       }
+
+      if(Replay_CacheAvailableGPUs() && !m_AvailableGPUs.empty())
+        SaveCachedGPUList(m_AvailableGPUs);
     });
   }
 }
@@ -930,6 +1099,31 @@ void RenderDoc::Tick()
     TriggerCapture(1);
   }
 
+  const uint32_t spikeMS = Capture_FrameTimeSpikeMS();
+  if(spikeMS > 0)
+  {
+    // hitches tend to come in clusters, so the frame after a spike is the best chance of capturing
+    // whatever caused it. Wait for the first second of averages so that loading isn't counted.
+    if(m_FrameTimer.GetLastFrameTime() > double(spikeMS) && m_FrameTimer.GetAvgFrameTime() > 0.0)
+    {
+      // frames around a capture are always slow, so only re-arm after a run of normal frames. The
+      // run length is approximately a second at the current average frame rate.
+      const double avg = m_FrameTimer.GetAvgFrameTime();
+      if(m_Cap == 0 && !IsFrameCapturing() && m_FramesSinceSpike >= uint32_t(1000.0 / avg))
+      {
+        RDCLOG("Frame took %.2lf ms, over the %u ms threshold. Capturing next frame",
+               m_FrameTimer.GetLastFrameTime(), spikeMS);
+        TriggerCapture(1);
+      }
+
+      m_FramesSinceSpike = 0;
+    }
+    else
+    {
+      m_FramesSinceSpike++;
+    }
+  }
+
   m_PrevFocus = cur_focus;
   m_PrevCap = cur_cap;
 
@@ -991,6 +1185,10 @@ uint32_t RenderDoc::GetCapturableWindowCount()
 rdcstr RenderDoc::GetOverlayText(RDCDriver driver, DeviceOwnedWindow devWnd, uint32_t frameNumber,
                                  int flags)
 {
+  // a single blank glyph draws just the background box
+  if(Capture_OverlayIndicatorOnly())
+    return " ";
+
   bool activeWindow;
   const bool capturesEnabled = (flags & eOverlay_CaptureDisabled) == 0;
 
@@ -1110,6 +1308,12 @@ rdcstr RenderDoc::GetOverlayText(RDCDriver driver, DeviceOwnedWindow devWnd, uin
   }
 #endif
 
+  if(APIOverhead::IsEnabled())
+    overlayText += APIOverhead::GetOverlayText() + "\n";
+
+  if(MemoryAccounting::ShowOnOverlay())
+    overlayText += MemoryAccounting::GetOverlayText() + "\n";
+
   if(capturesEnabled)
   {
     if(activeWindow)
@@ -1228,6 +1432,20 @@ bool RenderDoc::ShouldTriggerCapture(uint32_t frameNumber)
   return ret;
 }
 
+uint32_t RenderDoc::GetFramesUntilQueuedCapture(uint32_t frameNumber)
+{
+  // a triggered capture starts on the next check
+  if(m_Cap > 0)
+    return 0;
+
+  // the list is sorted, so the first frame not in the past is the next capture
+  for(uint32_t frame : m_QueuedFrameCaptures)
+    if(frame >= frameNumber)
+      return frame - frameNumber;
+
+  return ~0U;
+}
+
 void RenderDoc::ResamplePixels(const FramePixels &in, RDCThumb &out)
 {
   if(in.width == 0 || in.height == 0)
@@ -1361,7 +1579,7 @@ void RenderDoc::EncodePixelsPNG(const RDCThumb &in, RDCThumb &out)
   out.format = FileType::PNG;
 }
 
-RDCFile *RenderDoc::CreateRDC(RDCDriver driver, uint32_t frameNum, const FramePixels &fp)
+RDCFile *RenderDoc::CreateRDC(RDCDriver driver, uint32_t frameNum, FramePixels &fp)
 {
   RDCFile *ret = new RDCFile;
 
@@ -1386,12 +1604,29 @@ RDCFile *RenderDoc::CreateRDC(RDCDriver driver, uint32_t frameNum, const FramePi
     }
   }
 
+  // when writing in the background or streaming to target control, sections are kept in memory
+  // until FinishCaptureWriting
+  bool inMemory = Capture_BackgroundFileWriting() ||
+                  (Capture_StreamToTargetControl() && IsTargetControlConnected());
+
   RDCThumb outRaw, outPng;
+  FramePixels *pendingPixels = NULL;
   if(fp.data)
   {
-    // point sample info into raw buffer
-    ResamplePixels(fp, outRaw);
-    EncodePixelsPNG(outRaw, outPng);
+    if(inMemory)
+    {
+      // resampling and encoding a large backbuffer takes a while, so leave it for the background
+      // thread. Take the pixel data rather than copying it
+      pendingPixels = new FramePixels;
+      *pendingPixels = fp;
+      fp.data = NULL;
+    }
+    else
+    {
+      // point sample info into raw buffer
+      ResamplePixels(fp, outRaw);
+      EncodePixelsPNG(outRaw, outPng);
+    }
   }
 
   ret->SetData(driver, ToStr(driver).c_str(), OSUtility::GetMachineIdent(), &outPng, m_TimeBase,
@@ -1399,6 +1634,17 @@ RDCFile *RenderDoc::CreateRDC(RDCDriver driver, uint32_t frameNum, const FramePi
 
   FileIO::CreateParentDirectory(m_CurrentLogFile);
 
+  if(inMemory)
+  {
+    if(pendingPixels)
+    {
+      SCOPED_LOCK(m_CaptureLock);
+      m_PendingThumbnails[ret] = pendingPixels;
+    }
+
+    return ret;
+  }
+
   ret->Create(m_CurrentLogFile.c_str());
 
   if(ret->Error() != ResultCode::Succeeded)
@@ -1824,6 +2070,49 @@ void RenderDoc::SetCaptureOptions(const CaptureOptions &opts)
   LibraryHooks::OptionsUpdated();
 }
 
+void RenderDoc::SetProgress(LoadProgress section, float delta)
+{
+  if(section >= LoadProgress::First && section < LoadProgress::Count)
+  {
+    uint64_t now = Timing::GetTick();
+
+    // a load always begins by reporting the first phase, so use that to forget the previous one
+    if(section == LoadProgress::First && delta <= 0.0f)
+    {
+      for(LoadProgress s : values<LoadProgress>())
+        m_LoadPhaseStart[(size_t)s] = m_LoadPhaseEnd[(size_t)s] = 0;
+    }
+
+    if(m_LoadPhaseStart[(size_t)section] == 0)
+      m_LoadPhaseStart[(size_t)section] = now;
+
+    if(delta >= 1.0f && m_LoadPhaseEnd[(size_t)section] == 0)
+    {
+      m_LoadPhaseEnd[(size_t)section] = now;
+
+      if(section == LoadProgress(uint32_t(LoadProgress::Count) - 1))
+      {
+        const double freq = Timing::GetTickFrequency();
+
+        rdcstr breakdown;
+        for(LoadProgress s : values<LoadProgress>())
+        {
+          if(m_LoadPhaseStart[(size_t)s] == 0 || m_LoadPhaseEnd[(size_t)s] == 0)
+            continue;
+
+          breakdown += StringFormat::Fmt(
+              " %s %.2f ms", ToStr(s).c_str(),
+              double(m_LoadPhaseEnd[(size_t)s] - m_LoadPhaseStart[(size_t)s]) / freq);
+        }
+
+        RDCLOG("Capture load phases:%s", breakdown.c_str());
+      }
+    }
+  }
+
+  SetProgress<LoadProgress>(section, delta);
+}
+
 void RenderDoc::SetCaptureFileTemplate(const rdcstr &pathtemplate)
 {
   if(pathtemplate.empty())
@@ -1863,32 +2152,14 @@ void RenderDoc::FinishCaptureWriting(RDCFile *rdc, uint32_t frameNumber)
       w->Finish();
 
       delete w;
-    }
 
-    const RDCThumb &thumb = rdc->GetThumbnail();
-    if(thumb.format != FileType::JPG && thumb.width > 0 && thumb.height > 0)
-    {
-      SectionProperties props = {};
-      props.type = SectionType::ExtendedThumbnail;
-      props.version = 1;
-      StreamWriter *w = rdc->WriteSection(props);
-
-      // if this file format ever changes, be sure to update the XML export which has a special
-      // handling for this case.
-
-      ExtThumbnailHeader header;
-      header.width = thumb.width;
-      header.height = thumb.height;
-      header.format = thumb.format;
-      header.len = (uint32_t)thumb.pixels.size();
-      w->Write(header);
-      w->Write(thumb.pixels.data(), thumb.pixels.size());
-
-      w->Finish();
-
-      delete w;
+      rdc->WriteCallstackTable(GetInternedCallstacks());
     }
 
+    // captures built in memory get their thumbnail on the background thread below
+    if(rdc->IsFileBacked())
+      WriteThumbnailSection(rdc);
+
     if(Capture_Debug_SnapshotDiagnosticLog())
     {
       rdcstr logcontents = FileIO::logfile_readall(0, RDCGETLOGFILE());
@@ -1906,8 +2177,6 @@ void RenderDoc::FinishCaptureWriting(RDCFile *rdc, uint32_t frameNumber)
       delete w;
     }
 
-    RDCLOG("Written to disk: %s", m_CurrentLogFile.c_str());
-
     CaptureData cap;
     cap.path = m_CurrentLogFile;
     cap.title = m_CaptureTitle;
@@ -1915,6 +2184,84 @@ void RenderDoc::FinishCaptureWriting(RDCFile *rdc, uint32_t frameNumber)
     cap.driver = rdc->GetDriver();
     cap.frameNumber = frameNumber;
     m_CaptureTitle.clear();
+
+    if(!rdc->IsFileBacked())
+    {
+      // only write one capture at a time, to bound how much memory is held by pending captures
+      WaitForCaptureWriting();
+
+      Atomic::Inc32(&m_CaptureWriteActive);
+
+      // if the client went away since the capture started, fall back to writing to disk
+      bool stream = Capture_StreamToTargetControl() && IsTargetControlConnected();
+
+      FramePixels *pixels = NULL;
+      {
+        SCOPED_LOCK(m_CaptureLock);
+        auto it = m_PendingThumbnails.find(rdc);
+        if(it != m_PendingThumbnails.end())
+        {
+          pixels = it->second;
+          m_PendingThumbnails.erase(it);
+        }
+      }
+
+      m_CaptureWriteThread = Threading::CreateThread([this, rdc, cap, stream, pixels]() {
+        if(pixels)
+        {
+          RDCThumb raw, png;
+          ResamplePixels(*pixels, raw);
+          EncodePixelsPNG(raw, png);
+          rdc->SetThumbnail(png);
+          delete pixels;
+        }
+
+        WriteThumbnailSection(rdc);
+
+        if(stream)
+        {
+          StreamWriter writer(StreamWriter::DefaultScratchSize);
+          rdc->WriteToStream(writer);
+
+          if(rdc->Error() == ResultCode::Succeeded)
+          {
+            RDCLOG("Holding capture in memory for target control: %s", cap.path.c_str());
+
+            SCOPED_LOCK(m_CaptureLock);
+            m_StreamedCaptures[cap.path].assign(writer.GetData(), (size_t)writer.GetOffset());
+            m_Captures.push_back(cap);
+          }
+        }
+        else
+        {
+          rdc->CreateFromMemory(cap.path);
+
+          if(rdc->Error() == ResultCode::Succeeded)
+          {
+            RDCLOG("Written to disk in background: %s", cap.path.c_str());
+
+            SCOPED_LOCK(m_CaptureLock);
+            m_Captures.push_back(cap);
+          }
+        }
+
+        if(rdc->Error() != ResultCode::Succeeded)
+        {
+          RDCERR("Failed to write capture: %s", rdc->Error().message.c_str());
+        }
+
+        delete rdc;
+
+        RenderDoc::Inst().SetProgress(CaptureProgress::FileWriting, 1.0f);
+
+        Atomic::Dec32(&m_CaptureWriteActive);
+      });
+
+      return;
+    }
+
+    RDCLOG("Written to disk: %s", m_CurrentLogFile.c_str());
+
     {
       SCOPED_LOCK(m_CaptureLock);
       m_Captures.push_back(cap);
@@ -1930,6 +2277,43 @@ void RenderDoc::FinishCaptureWriting(RDCFile *rdc, uint32_t frameNumber)
   RenderDoc::Inst().SetProgress(CaptureProgress::FileWriting, 1.0f);
 }
 
+void RenderDoc::WriteThumbnailSection(RDCFile *rdc)
+{
+  const RDCThumb &thumb = rdc->GetThumbnail();
+  if(thumb.format != FileType::JPG && thumb.width > 0 && thumb.height > 0)
+  {
+    SectionProperties props = {};
+    props.type = SectionType::ExtendedThumbnail;
+    props.version = 1;
+    StreamWriter *w = rdc->WriteSection(props);
+
+    // if this file format ever changes, be sure to update the XML export which has a special
+    // handling for this case.
+
+    ExtThumbnailHeader header;
+    header.width = thumb.width;
+    header.height = thumb.height;
+    header.format = thumb.format;
+    header.len = (uint32_t)thumb.pixels.size();
+    w->Write(header);
+    w->Write(thumb.pixels.data(), thumb.pixels.size());
+
+    w->Finish();
+
+    delete w;
+  }
+}
+
+void RenderDoc::WaitForCaptureWriting()
+{
+  if(m_CaptureWriteThread)
+  {
+    Threading::JoinThread(m_CaptureWriteThread);
+    Threading::CloseThread(m_CaptureWriteThread);
+    m_CaptureWriteThread = 0;
+  }
+}
+
 void RenderDoc::AddChildProcess(uint32_t pid, uint32_t ident)
 {
   if(ident == 0 || ident == m_RemoteIdent)
@@ -1969,7 +2353,10 @@ void RenderDoc::AddChildThread(uint32_t pid, Threading::ThreadHandle thread)
 void RenderDoc::ValidateCaptures()
 {
   SCOPED_LOCK(m_CaptureLock);
-  m_Captures.removeIf([](const CaptureData &cap) { return !FileIO::exists(cap.path); });
+  m_Captures.removeIf([this](const CaptureData &cap) {
+    return m_StreamedCaptures.find(cap.path) == m_StreamedCaptures.end() &&
+           !FileIO::exists(cap.path);
+  });
 }
 
 rdcarray<CaptureData> RenderDoc::GetCaptures()
@@ -1984,9 +2371,19 @@ void RenderDoc::MarkCaptureRetrieved(uint32_t idx)
   if(idx < m_Captures.size())
   {
     m_Captures[idx].retrieved = true;
+    m_StreamedCaptures.erase(m_Captures[idx].path);
   }
 }
 
+const bytebuf *RenderDoc::GetStreamedCapture(const rdcstr &path)
+{
+  SCOPED_LOCK(m_CaptureLock);
+  auto it = m_StreamedCaptures.find(path);
+  if(it == m_StreamedCaptures.end())
+    return NULL;
+  return &it->second;
+}
+
 void RenderDoc::AddDeviceFrameCapturer(void *dev, IFrameCapturer *cap)
 {
   if(IsReplayApp())
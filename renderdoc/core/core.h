@@ -445,6 +445,9 @@ public:
     cb(progress);
   }
 
+  // capture loading additionally records how long each phase took, to log a breakdown at the end
+  void SetProgress(LoadProgress section, float delta);
+
   // set from outside of the device creation interface
   void SetCaptureFileTemplate(const rdcstr &logFile);
   const char *GetCaptureFileTemplate() const { return m_CaptureFileTemplate.c_str(); }
@@ -484,8 +487,11 @@ public:
   void UnregisterMemoryRegion(void *mem);
   void ResamplePixels(const FramePixels &in, RDCThumb &out);
   void EncodePixelsPNG(const RDCThumb &in, RDCThumb &out);
-  RDCFile *CreateRDC(RDCDriver driver, uint32_t frameNum, const FramePixels &fp);
+  // may take ownership of the pixel data in fp, to generate the thumbnail later
+  RDCFile *CreateRDC(RDCDriver driver, uint32_t frameNum, FramePixels &fp);
   void FinishCaptureWriting(RDCFile *rdc, uint32_t frameNumber);
+  void WriteThumbnailSection(RDCFile *rdc);
+  void WaitForCaptureWriting();
 
   void AddChildProcess(uint32_t pid, uint32_t ident);
   rdcarray<rdcpair<uint32_t, uint32_t>> GetChildProcesses();
@@ -498,6 +504,10 @@ public:
 
   void MarkCaptureRetrieved(uint32_t idx);
 
+  // returns the contents of a capture that was kept in memory for target control instead of
+  // being written to disk, or NULL. Valid until the capture is marked as retrieved.
+  const bytebuf *GetStreamedCapture(const rdcstr &path);
+
   void RegisterReplayProvider(RDCDriver driver, ReplayDriverProvider provider);
   void RegisterRemoteProvider(RDCDriver driver, RemoteDriverProvider provider);
 
@@ -608,6 +618,9 @@ public:
   const rdcarray<RENDERDOC_InputButton> &GetFocusKeys() { return m_FocusKeys; }
   const rdcarray<RENDERDOC_InputButton> &GetCaptureKeys() { return m_CaptureKeys; }
   bool ShouldTriggerCapture(uint32_t frameNumber);
+  // the number of frames from frameNumber until the next queued or triggered capture, or ~0U if
+  // none is pending
+  uint32_t GetFramesUntilQueuedCapture(uint32_t frameNumber);
 
   enum
   {
@@ -619,6 +632,14 @@ public:
   void CycleActiveWindow();
   uint32_t GetCapturableWindowCount();
 
+  // frame times in milliseconds, recalculated roughly once a second
+  void GetFrameTimes(double &avgMS, double &minMS, double &maxMS) const
+  {
+    avgMS = m_FrameTimer.GetAvgFrameTime();
+    minMS = m_FrameTimer.GetMinFrameTime();
+    maxMS = m_FrameTimer.GetMaxFrameTime();
+  }
+
 private:
   RenderDoc();
   ~RenderDoc();
@@ -632,6 +653,10 @@ private:
   bool m_PrevFocus = false;
   bool m_PrevCap = false;
 
+  // how many frames in a row have been under the frame time spike threshold. A spike only triggers
+  // a capture once this is high enough, so the capture itself doesn't count as a spike.
+  uint32_t m_FramesSinceSpike = 0;
+
   rdcarray<RENDERDOC_InputButton> m_FocusKeys;
   rdcarray<RENDERDOC_InputButton> m_CaptureKeys;
 
@@ -665,8 +690,22 @@ private:
 
   std::map<rdcstr, RENDERDOC_ProgressCallback> m_ProgressCallbacks;
 
+  // ticks at which each load phase was first reported and when it completed
+  uint64_t m_LoadPhaseStart[arraydim<LoadProgress>()] = {};
+  uint64_t m_LoadPhaseEnd[arraydim<LoadProgress>()] = {};
+
   Threading::CriticalSection m_CaptureLock;
   rdcarray<CaptureData> m_Captures;
+  // complete capture files held in memory for target control to retrieve instead of being written
+  // to disk, keyed by the path they would have had. Protected by m_CaptureLock
+  std::map<rdcstr, bytebuf> m_StreamedCaptures;
+  // backbuffer pixels for captures built in memory. The thumbnail is generated from them on the
+  // background writing thread instead of on the capturing thread. Protected by m_CaptureLock
+  std::map<RDCFile *, FramePixels *> m_PendingThumbnails;
+
+  // captures being compressed and written to disk in the background
+  Threading::ThreadHandle m_CaptureWriteThread = 0;
+  int32_t m_CaptureWriteActive = 0;
 
   Threading::CriticalSection m_ChildLock;
   rdcarray<rdcpair<uint32_t, uint32_t>> m_Children;
@@ -152,17 +152,32 @@ public:
       y = (mipHeight - 1) - y;
     }
 
+    EnsureSubresourceUploaded(sub);
+
     m_Proxy->PickPixel(texture, x, y, sub, typeCast, pixel);
   }
+  bool PickPixelTile(ResourceId texture, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                     const Subresource &sub, CompType typeCast, rdcarray<float> &pixels)
+  {
+    // the OpenGL flip would reverse the rows in the tile, so leave that case to PickPixel
+    if(m_Props.localRenderer == GraphicsAPI::OpenGL)
+      return false;
+
+    EnsureSubresourceUploaded(sub);
+
+    return m_Proxy->PickPixelTile(texture, x, y, width, height, sub, typeCast, pixels);
+  }
   bool GetMinMax(ResourceId texid, const Subresource &sub, CompType typeCast, float *minval,
                  float *maxval)
   {
+    EnsureSubresourceUploaded(sub);
     return m_Proxy->GetMinMax(m_TextureID, sub, typeCast, minval, maxval);
   }
   bool GetHistogram(ResourceId texid, const Subresource &sub, CompType typeCast, float minval,
                     float maxval, const rdcfixedarray<bool, 4> &channels,
                     rdcarray<uint32_t> &histogram)
   {
+    EnsureSubresourceUploaded(sub);
     return m_Proxy->GetHistogram(m_TextureID, sub, typeCast, minval, maxval, channels, histogram);
   }
   bool RenderTexture(TextureDisplay cfg)
@@ -173,6 +188,9 @@ public:
     if(m_Props.localRenderer == GraphicsAPI::OpenGL)
       cfg.flipY = !cfg.flipY;
 
+    if(cfg.resourceId == m_TextureID)
+      EnsureSubresourceUploaded(cfg.subresource);
+
     return m_Proxy->RenderTexture(cfg);
   }
   uint32_t PickVertex(uint32_t eventId, int32_t width, int32_t height, const MeshDisplay &cfg,
@@ -205,6 +223,10 @@ public:
   void FreeCustomShader(ResourceId id) { m_Proxy->FreeTargetResource(id); }
   ResourceId ApplyCustomShader(TextureDisplay &display)
   {
+    // custom shaders can sample any mip, so make sure the whole slice is available
+    for(uint32_t mip = 0; mip < m_TexDetails.mips; mip++)
+      EnsureSubresourceUploaded({mip, display.subresource.slice});
+
     m_CustomTexID = m_Proxy->ApplyCustomShader(display);
     return m_CustomTexID;
   }
@@ -217,6 +239,9 @@ public:
     if(tex != m_TextureID && tex != m_CustomTexID)
       tex = m_TextureID;
 
+    if(tex == m_TextureID)
+      EnsureSubresourceUploaded(sub);
+
     if(tex == m_TextureID && !m_RealTexData.empty() && params.remap == RemapTexture::NoRemap)
     {
       RDCASSERT(sub.sample == 0);
@@ -229,6 +254,16 @@ public:
 
     m_Proxy->GetTextureData(tex, sub, params, data);
   }
+  void GetTextureDataBatch(const rdcarray<TextureReadback> &readbacks,
+                           TextureReadbackCallback callback)
+  {
+    for(size_t i = 0; i < readbacks.size(); i++)
+    {
+      bytebuf data;
+      GetTextureData(readbacks[i].tex, readbacks[i].sub, readbacks[i].params, data);
+      callback(i, data);
+    }
+  }
 
   // handle a couple of operations ourselves to return a simple fake log
   APIProperties GetAPIProperties() { return m_Props; }
@@ -259,6 +294,16 @@ public:
     return ret;
   }
   void SavePipelineState(uint32_t eventId) {}
+  rdcarray<VKPipe::BindingElement> GetVulkanDescriptors(bool compute, uint32_t set,
+                                                        uint32_t binding, uint32_t firstElement,
+                                                        uint32_t count)
+  {
+    return {};
+  }
+  rdcarray<uint32_t> GetVulkanUsedDescriptors(bool compute, uint32_t set, uint32_t binding)
+  {
+    return {};
+  }
   DriverInformation GetDriverInfo()
   {
     DriverInformation ret = {};
@@ -286,6 +331,7 @@ public:
   void GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, bytebuf &retData) {}
   void InitPostVSBuffers(uint32_t eventId) {}
   void InitPostVSBuffers(const rdcarray<uint32_t> &eventId) {}
+  PostVSCacheStatistics GetPostVSCacheStatistics() { return PostVSCacheStatistics(); }
   MeshFormat GetPostVSBuffers(uint32_t eventId, uint32_t instID, uint32_t viewID, MeshDataStage stage)
   {
     MeshFormat ret;
@@ -313,6 +359,12 @@ public:
   {
     return rdcarray<PixelModification>();
   }
+  PixelRegionHistory PixelHistoryRegion(rdcarray<EventUsage> events, ResourceId target, uint32_t x,
+                                        uint32_t y, uint32_t width, uint32_t height,
+                                        const Subresource &sub, CompType typeCast)
+  {
+    return PixelRegionHistory();
+  }
   ShaderDebugTrace *DebugVertex(uint32_t eventId, uint32_t vertid, uint32_t instid, uint32_t idx,
                                 uint32_t view)
   {
@@ -323,6 +375,15 @@ public:
   {
     return new ShaderDebugTrace();
   }
+  rdcarray<ShaderDebugTrace *> DebugPixels(uint32_t eventId,
+                                           const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels,
+                                           uint32_t sample, uint32_t primitive)
+  {
+    rdcarray<ShaderDebugTrace *> ret;
+    for(size_t i = 0; i < pixels.size(); i++)
+      ret.push_back(new ShaderDebugTrace());
+    return ret;
+  }
   ShaderDebugTrace *DebugThread(uint32_t eventId, const rdcfixedarray<uint32_t, 3> &groupid,
                                 const rdcfixedarray<uint32_t, 3> &threadid)
   {
@@ -367,6 +428,8 @@ public:
 private:
   void RefreshFile();
   void CreateProxyTexture(TextureDescription &texDetails, read_dds_data &read_data);
+  void UploadSubresource(uint32_t idx, const byte *data, size_t size);
+  void EnsureSubresourceUploaded(const Subresource &sub);
 
   APIProperties m_Props;
   FrameRecord m_FrameRecord;
@@ -380,9 +443,22 @@ private:
 
   RDResult m_Error;
 
+  // the proxy texture as created, which may differ from m_TexDetails if it was remapped
+  TextureDescription m_ProxyDetails;
+
+  // if the proxy can't display the file's format it is converted to float on upload
+  bool m_ConvertToFloat = false;
+
   // if we remapped the texture for display, this contains the real data to return from
   // GetTextureData()
   rdcarray<bytebuf> m_RealTexData;
+
+  // DDS files are streamed: only the header is read up front and each subresource is read from the
+  // file and uploaded the first time it's needed. These are the file offsets and sizes, indexed by
+  // proxy subresource, and whether each has been uploaded since the file was last refreshed.
+  bool m_Streaming = false;
+  rdcarray<rdcpair<uint64_t, size_t>> m_StreamSubresources;
+  rdcarray<bool> m_StreamUploaded;
 };
 
 RDResult IMG_CreateReplayDevice(RDCFile *rdc, IReplayDriver **driver)
@@ -494,7 +570,8 @@ RDResult IMG_CreateReplayDevice(RDCFile *rdc, IReplayDriver **driver)
     FileIO::fseek64(f, 0, SEEK_SET);
     StreamReader reader(f);
     read_dds_data read_data;
-    RDResult res = load_dds_from_file(&reader, read_data);
+    // only validate the header and layout here, the data is read when the viewer is created
+    RDResult res = load_dds_from_file(&reader, read_data, false);
     f = NULL;
 
     if(res != ResultCode::Succeeded)
@@ -562,6 +639,27 @@ RDResult IMG_CreateReplayDevice(RDCFile *rdc, IReplayDriver **driver)
   return ResultCode::Succeeded;
 }
 
+static void RemapSubresourcesToArray(read_dds_data &read_data, uint32_t arraysize, uint32_t mips)
+{
+  rdcarray<rdcpair<uint64_t, size_t>> oldSubs;
+  oldSubs.swap(read_data.subresources);
+
+  // reformat the subresources. The data doesn't change we just add new offsets/sizes
+  for(uint32_t i = 0; i < arraysize * mips; i++)
+  {
+    const uint32_t mip = i % mips;
+    const uint32_t slice = i / mips;
+
+    // size of each subresource is 1/Nth for an N-sized array
+    size_t size = oldSubs[mip].second / arraysize;
+
+    // and the offset is slice steps further on
+    uint64_t offset = oldSubs[mip].first + size * slice;
+
+    read_data.subresources.push_back({offset, size});
+  }
+}
+
 void ImageViewer::RefreshFile()
 {
   FILE *f = NULL;
@@ -842,7 +940,7 @@ void ImageViewer::RefreshFile()
   {
     FileIO::fseek64(f, 0, SEEK_SET);
     StreamReader reader(f);
-    RDResult res = load_dds_from_file(&reader, read_data);
+    RDResult res = load_dds_from_file(&reader, read_data, false);
     f = NULL;
 
     if(res != ResultCode::Succeeded)
@@ -906,7 +1004,15 @@ void ImageViewer::RefreshFile()
   m_TexDetails = texDetails;
 
   if(m_TextureID == ResourceId())
+  {
     CreateProxyTexture(texDetails, read_data);
+    m_ProxyDetails = texDetails;
+  }
+  else if(m_ProxyDetails.arraysize != texDetails.arraysize)
+  {
+    // the layout is unchanged so the proxy was remapped the same way as when it was created
+    RemapSubresourcesToArray(read_data, m_ProxyDetails.arraysize, m_ProxyDetails.mips);
+  }
 
   if(m_TextureID == ResourceId())
   {
@@ -917,19 +1023,28 @@ void ImageViewer::RefreshFile()
   m_TexDetails.resourceId = m_TextureID;
   m_TexDetails.byteSize = fileSize;
 
+  m_Streaming = false;
+  m_StreamSubresources.clear();
+  m_StreamUploaded.clear();
+
   if(!dds)
   {
     m_Proxy->SetProxyTextureData(m_TextureID, Subresource(), data, datasize);
     free(data);
   }
+  else if(read_data.buffer.empty())
+  {
+    // nothing is uploaded now. Subresources are uploaded as they're used, so after a refresh only
+    // the ones that are viewed again get re-read and re-uploaded
+    m_Streaming = true;
+    m_StreamSubresources.swap(read_data.subresources);
+    m_StreamUploaded.resize(m_StreamSubresources.size());
+  }
   else
   {
-    for(uint32_t i = 0; i < texDetails.arraysize * texDetails.mips; i++)
-    {
-      m_Proxy->SetProxyTextureData(m_TextureID, {i % texDetails.mips, i / texDetails.mips},
-                                   read_data.buffer.data() + read_data.subresources[i].first,
-                                   read_data.subresources[i].second);
-    }
+    for(uint32_t i = 0; i < m_ProxyDetails.arraysize * m_ProxyDetails.mips; i++)
+      UploadSubresource(i, read_data.buffer.data() + read_data.subresources[i].first,
+                        read_data.subresources[i].second);
   }
 
   if(f != NULL)
@@ -938,6 +1053,9 @@ void ImageViewer::RefreshFile()
 
 void ImageViewer::CreateProxyTexture(TextureDescription &texDetails, read_dds_data &read_data)
 {
+  m_ConvertToFloat = false;
+  m_RealTexData.clear();
+
   if(m_Proxy->IsTextureSupported(texDetails))
   {
     m_TextureID = m_Proxy->CreateProxyTexture(texDetails);
@@ -959,23 +1077,7 @@ void ImageViewer::CreateProxyTexture(TextureDescription &texDetails, read_dds_da
         texDetails = arrayDetails;
         m_TextureID = m_Proxy->CreateProxyTexture(arrayDetails);
 
-        rdcarray<rdcpair<size_t, size_t>> oldSubs;
-        oldSubs.swap(read_data.subresources);
-
-        // reformat the subresources. The data doesn't change we just add new offsets/sizes
-        for(uint32_t i = 0; i < texDetails.arraysize * texDetails.mips; i++)
-        {
-          const uint32_t mip = i % texDetails.mips;
-          const uint32_t slice = i / texDetails.mips;
-
-          // size of each subresource is 1/Nth for an N-sized array
-          size_t size = oldSubs[mip].second / texDetails.arraysize;
-
-          // and the offset is slice steps further on
-          size_t offset = oldSubs[mip].first + size * slice;
-
-          read_data.subresources.push_back({offset, size});
-        }
+        RemapSubresourcesToArray(read_data, texDetails.arraysize, texDetails.mips);
 
         return;
       }
@@ -989,52 +1091,10 @@ void ImageViewer::CreateProxyTexture(TextureDescription &texDetails, read_dds_da
 
       if(convertSupported)
       {
-        uint32_t srcStride = texDetails.format.ElementSize();
-
-        if(texDetails.format.type == ResourceFormatType::D16S8)
-          srcStride = 4;
-        else if(texDetails.format.type == ResourceFormatType::D32S8)
-          srcStride = 8;
-
+        // the data is converted as each subresource is uploaded
+        m_ConvertToFloat = true;
         m_RealTexData.resize(texDetails.arraysize * texDetails.mips);
 
-        bytebuf convertedData;
-
-        for(uint32_t i = 0; i < texDetails.arraysize * texDetails.mips; i++)
-        {
-          const uint32_t mip = i % texDetails.mips;
-
-          const uint32_t mipwidth = RDCMAX(1U, texDetails.width >> mip);
-          const uint32_t mipheight = RDCMAX(1U, texDetails.height >> mip);
-          const uint32_t mipdepth = RDCMAX(1U, texDetails.depth >> mip);
-
-          byte *old = read_data.buffer.data() + read_data.subresources[i].first;
-          m_RealTexData[i].assign(old, read_data.subresources[i].second);
-
-          read_data.subresources[i].first = convertedData.size();
-          read_data.subresources[i].second = sizeof(FloatVector) * mipwidth * mipheight * mipdepth;
-          convertedData.resize(convertedData.size() + read_data.subresources[i].second);
-          byte *converted = convertedData.data() + read_data.subresources[i].first;
-
-          byte *src = old;
-          FloatVector *dst = (FloatVector *)converted;
-
-          for(uint32_t z = 0; z < mipdepth; z++)
-          {
-            for(uint32_t y = 0; y < mipheight; y++)
-            {
-              for(uint32_t x = 0; x < mipwidth; x++)
-              {
-                *dst = DecodeFormattedComponents(texDetails.format, src);
-                dst++;
-                src += srcStride;
-              }
-            }
-          }
-        }
-
-        read_data.buffer.swap(convertedData);
-
         ResourceFormat rgba32_float;
         rgba32_float.type = ResourceFormatType::Regular;
         rgba32_float.compByteWidth = 4;
@@ -1057,3 +1117,81 @@ void ImageViewer::CreateProxyTexture(TextureDescription &texDetails, read_dds_da
     }
   }
 }
+
+void ImageViewer::UploadSubresource(uint32_t idx, const byte *data, size_t size)
+{
+  const Subresource sub = {idx % m_ProxyDetails.mips, idx / m_ProxyDetails.mips};
+
+  if(!m_ConvertToFloat)
+  {
+    m_Proxy->SetProxyTextureData(m_TextureID, sub, (byte *)data, size);
+    return;
+  }
+
+  const ResourceFormat &fmt = m_TexDetails.format;
+
+  uint32_t srcStride = fmt.ElementSize();
+
+  if(fmt.type == ResourceFormatType::D16S8)
+    srcStride = 4;
+  else if(fmt.type == ResourceFormatType::D32S8)
+    srcStride = 8;
+
+  const uint32_t mipwidth = RDCMAX(1U, m_ProxyDetails.width >> sub.mip);
+  const uint32_t mipheight = RDCMAX(1U, m_ProxyDetails.height >> sub.mip);
+  const uint32_t mipdepth = RDCMAX(1U, m_ProxyDetails.depth >> sub.mip);
+
+  m_RealTexData[idx].assign(data, size);
+
+  bytebuf converted;
+  converted.resize(sizeof(FloatVector) * mipwidth * mipheight * mipdepth);
+
+  DecodeFormattedComponents(fmt, data, srcStride, mipwidth * mipheight * mipdepth,
+                            (FloatVector *)converted.data());
+
+  m_Proxy->SetProxyTextureData(m_TextureID, sub, converted.data(), converted.size());
+}
+
+void ImageViewer::EnsureSubresourceUploaded(const Subresource &sub)
+{
+  if(!m_Streaming || m_TextureID == ResourceId())
+    return;
+
+  // 3D textures have one subresource per mip, where the slice selects a depth slice
+  const uint32_t slice = m_ProxyDetails.arraysize > 1 ? sub.slice : 0;
+
+  if(sub.mip >= m_ProxyDetails.mips || slice >= m_ProxyDetails.arraysize)
+    return;
+
+  const uint32_t idx = slice * m_ProxyDetails.mips + sub.mip;
+
+  if(m_StreamUploaded[idx])
+    return;
+
+  // we don't keep the file open between uploads so that it can still be modified externally
+  FILE *f = FileIO::fopen(m_Filename, FileIO::ReadBinary);
+
+  if(!f)
+  {
+    RDCERR("Couldn't re-open %s to read subresource data", m_Filename.c_str());
+    return;
+  }
+
+  bytebuf data;
+  data.resize(m_StreamSubresources[idx].second);
+
+  FileIO::fseek64(f, m_StreamSubresources[idx].first, SEEK_SET);
+  size_t read = FileIO::fread(data.data(), 1, data.size(), f);
+  FileIO::fclose(f);
+
+  if(read != data.size())
+  {
+    RDCERR("Couldn't read subresource data from %s, file may have been truncated",
+           m_Filename.c_str());
+    return;
+  }
+
+  UploadSubresource(idx, data.data(), data.size());
+
+  m_StreamUploaded[idx] = true;
+}
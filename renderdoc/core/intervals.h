@@ -209,38 +209,60 @@ public:
   // (where `oldValue` is the value of the interval prior to calling `update`).
   // If start/finish do not lie on the boundaries between intervals, the intervals
   // will be split as necessary.
+  // The start points are stored in a flat array, so rather than merging each interval as it's
+  // updated (shifting the whole tail of the array each time) the range is updated in place and
+  // then compacted in one pass. An update touching many intervals costs a single shift.
   template <typename Compose>
   void update(uint64_t start, uint64_t finish, T val, Compose comp)
   {
     if(finish <= start)
       return;
 
-    auto i = find(start);
+    // Split the interval containing `start` so that an interval begins at `start`
+    auto first = StartPoints.upper_bound(start);
+    first--;
+    if(first->first < start)
+      StartPoints.insert(rdcpair<uint64_t, T>(start, first->second));
 
-    // Split the interval so that `i.start == start`
-    i->split(start);
+    // Likewise split the interval containing `finish`. UINT64_MAX is the implicit end of the last
+    // interval, so never needs a start point.
+    if(finish != UINT64_MAX)
+    {
+      auto last = StartPoints.upper_bound(finish);
+      last--;
+      if(last->first < finish)
+        StartPoints.insert(rdcpair<uint64_t, T>(finish, last->second));
+    }
+
+    rdcpair<uint64_t, T> *points = StartPoints.begin();
+    const size_t count = StartPoints.size();
+
+    // [lo, hi) are now exactly the intervals covering [start, finish)
+    const size_t lo = StartPoints.lower_bound(start) - points;
+    const size_t hi =
+        finish == UINT64_MAX ? count : size_t(StartPoints.lower_bound(finish) - points);
+
+    for(size_t i = lo; i < hi; i++)
+      points[i].second = comp(points[i].second, val);
+
+    // Merge any neighbouring intervals with the same value, including the intervals either side of
+    // the updated range. Nothing outside this window can have changed.
+    const size_t windowStart = lo > 0 ? lo - 1 : 0;
+    const size_t windowEnd = hi < count ? hi + 1 : count;
 
-    // Loop over all the intervals in `a` that intersect the interval [start, finish)
-    for(; i != end() && i->start() < finish; i++)
+    size_t write = windowStart + 1;
+    for(size_t read = windowStart + 1; read < windowEnd; read++)
     {
-      if(i->finish() > finish)
-      {
-        // In this case, interval `i` extends beyond `finish`;
-        // split `i` so that we only update the portion of `i` in [start, finish).
-        i->split(finish);
+      if(points[read].second == points[write - 1].second)
+        continue;
 
-        // `split` leaves `i` pointing at the interval starting at `finish`;
-        // move back to the interval finishing at `finish`.
-        i--;
-      }
-      i->setValue(comp(i->value(), val));
-      i->mergeLeft();
+      if(write != read)
+        points[write] = points[read];
+      write++;
     }
 
-    // `i` now points to the interval following the last interval whose value was
-    // modified; merge `i` with that last modified interval, if the values match.
-    if(i != end())
-      i->mergeLeft();
+    if(write < windowEnd)
+      StartPoints.erase(points + write, points + windowEnd);
   }
 
   // Update `this` by composing the value of each interval with the value of the
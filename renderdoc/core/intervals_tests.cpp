@@ -27,6 +27,8 @@
 #if ENABLED(ENABLE_UNIT_TESTS)
 
 #include "api/replay/rdcarray.h"
+#include "common/formatting.h"
+#include "common/timing.h"
 #include "intervals.h"
 
 #include "catch/catch.hpp"
@@ -293,6 +295,17 @@ TEST_CASE("Test Intervals type", "[intervals]")
       test.update(UINT64_MAX, UINT64_MAX, 1, [](uint64_t x, uint64_t y) -> uint64_t { return 99; });
       check_intervals(test, {{0, 0, 5}, {5, 1, 10}, {10, 0, UINT64_MAX}});
     };
+
+    SECTION("update spanning many intervals")
+    {
+      Intervals<uint64_t> test = make_intervals(
+          {{0, 0, 10}, {10, 1, 20}, {20, 2, 30}, {30, 1, 40}, {40, 2, 50}, {50, 0, UINT64_MAX}});
+      test.update(15, 45, 2, [](uint64_t x, uint64_t y) -> uint64_t { return x > y ? x : y; });
+      check_intervals(test, {{0, 0, 10}, {10, 1, 15}, {15, 2, 50}, {50, 0, UINT64_MAX}});
+
+      test.update(5, 55, 1, [](uint64_t x, uint64_t y) -> uint64_t { return y; });
+      check_intervals(test, {{0, 0, 5}, {5, 1, 55}, {55, 0, UINT64_MAX}});
+    };
   };
 
   SECTION("mergeIntervals tests")
@@ -439,4 +452,54 @@ TEST_CASE("Test Intervals type", "[intervals]")
   };
 };
 
+// hidden by default, run explicitly with the [benchmark] tag to get timings reported
+TEST_CASE("Intervals update performance", "[.][benchmark][intervals]")
+{
+  // similar to a large suballocated memory object, with many small alternating ranges
+  const uint64_t numIntervals = 200000;
+  const uint64_t granularity = 256;
+
+  auto assign = [](uint64_t, uint64_t y) -> uint64_t { return y; };
+
+  Intervals<uint64_t> test;
+
+  PerformanceTimer timer;
+
+  for(uint64_t i = 0; i < numIntervals; i++)
+    test.update(i * granularity, (i + 1) * granularity, i & 1, assign);
+
+  double buildMS = timer.GetMilliseconds();
+
+  CHECK(test.size() == numIntervals + 1);
+
+  // wide updates each covering a large number of intervals, alternating between changing the
+  // values and leaving them the same
+  const uint64_t numUpdates = 100;
+  const uint64_t span = (numIntervals / 10) * granularity;
+
+  timer.Restart();
+
+  for(uint64_t i = 0; i < numUpdates; i++)
+  {
+    const uint64_t start = (i * 997 * granularity) % (numIntervals * granularity - span);
+    test.update(start, start + span, 0, [](uint64_t x, uint64_t y) -> uint64_t { return x + y; });
+  }
+
+  double wideMS = timer.GetMilliseconds();
+
+  timer.Restart();
+
+  test.update(0, numIntervals * granularity, 7, assign);
+
+  double collapseMS = timer.GetMilliseconds();
+
+  check_intervals(test, {{0, 7, numIntervals * granularity},
+                         {numIntervals * granularity, 0, UINT64_MAX}});
+
+  WARN(StringFormat::Fmt("Built %llu intervals in %.2f ms, %llu wide updates in %.2f ms, "
+                         "collapsed in %.2f ms",
+                         numIntervals, buildMS, numUpdates, wideMS, collapseMS)
+           .c_str());
+}
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -0,0 +1,71 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2023 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#include "memory_accounting.h"
+#include "common/formatting.h"
+#include "core/settings.h"
+#include "os/os_specific.h"
+
+RDOC_CONFIG(bool, Capture_MemoryAccountingOverlay, false,
+            "Show the memory used by RenderDoc's larger allocations, broken down by category, on "
+            "the in-application overlay.");
+
+namespace MemoryAccounting
+{
+static int64_t bytes[(uint32_t)MemoryCategory::Count] = {};
+
+void Allocated(MemoryCategory category, uint64_t size)
+{
+  Atomic::ExchAdd64(&bytes[(uint32_t)category], (int64_t)size);
+}
+
+void Freed(MemoryCategory category, uint64_t size)
+{
+  Atomic::ExchAdd64(&bytes[(uint32_t)category], -(int64_t)size);
+}
+
+uint64_t GetBytes(MemoryCategory category)
+{
+  return (uint64_t)RDCMAX((int64_t)0, Atomic::ExchAdd64(&bytes[(uint32_t)category], 0));
+}
+
+bool ShowOnOverlay()
+{
+  return Capture_MemoryAccountingOverlay();
+}
+
+rdcstr GetOverlayText()
+{
+  const double MB = 1024.0 * 1024.0;
+
+  return StringFormat::Fmt(
+      "Process memory %.2f MB. Chunk pages %.2f MB, GPU initial contents %.2f MB, GPU readback "
+      "%.2f MB.",
+      double(Process::GetMemoryUsage()) / MB,
+      double(GetBytes(MemoryCategory::ChunkPages)) / MB,
+      double(GetBytes(MemoryCategory::GPUInitialContents)) / MB,
+      double(GetBytes(MemoryCategory::GPUIndirectReadback)) / MB);
+}
+};
@@ -0,0 +1,52 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2023 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#pragma once
+
+#include "api/replay/rdcstr.h"
+#include "common/common.h"
+
+// Running totals of the large memory consumers in capture and replay, so that it's possible to see
+// where memory is going when a process runs out. These are cheap atomic counters, updated when
+// memory is allocated from or returned to the system - not on every suballocation.
+
+enum class MemoryCategory : uint32_t
+{
+  ChunkPages,
+  GPUInitialContents,
+  GPUIndirectReadback,
+  Count,
+};
+
+namespace MemoryAccounting
+{
+void Allocated(MemoryCategory category, uint64_t bytes);
+void Freed(MemoryCategory category, uint64_t bytes);
+
+uint64_t GetBytes(MemoryCategory category);
+
+bool ShowOnOverlay();
+rdcstr GetOverlayText();
+};
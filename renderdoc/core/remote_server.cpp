@@ -671,12 +671,11 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
 
       if(resolver)
       {
-        StackFrames.reserve(StackAddresses.size());
-        for(uint64_t frame : StackAddresses)
-        {
-          Callstack::AddressDetails info = resolver->GetAddr(frame);
+        rdcarray<Callstack::AddressDetails> details = resolver->GetAddrs(StackAddresses);
+
+        StackFrames.reserve(details.size());
+        for(Callstack::AddressDetails &info : details)
           StackFrames.push_back(info.formattedString());
-        }
       }
       else
       {
@@ -1542,12 +1541,19 @@ void RemoteServer::CopyCaptureFromRemote(const rdcstr &remotepath, const rdcstr
 
     if(type == eRemoteServer_CopyCaptureFromRemote)
     {
-      StreamWriter streamWriter(FileIO::fopen(localpath, FileIO::WriteBinary), Ownership::Stream);
+      {
+        StreamWriter streamWriter(FileIO::fopen(localpath, FileIO::WriteBinary),
+                                  Ownership::Stream);
 
-      ser.SerialiseStream(localpath, streamWriter, progress);
+        ser.SerialiseStream(localpath, streamWriter, progress);
+      }
 
       if(ser.IsErrored())
       {
+        // don't leave a truncated capture behind that could be mistaken for a complete one. The
+        // writer above has been closed so the file can be deleted.
+        FileIO::Delete(localpath);
+
         RDCERR("Network error receiving file");
         return;
       }
@@ -25,9 +25,102 @@
 
 #include "replay_proxy.h"
 #include <list>
+#include "compressonator/CMP_Core.h"
+#include "core/settings.h"
 #include "lz4/lz4.h"
 #include "replay/dummy_driver.h"
 #include "serialise/lz4io.h"
+#include "serialise/zstdio.h"
+
+RDOC_CONFIG(bool, RemoteServer_ZstdTransfer, false,
+            "Compress bulk buffer and texture data sent from a remote server with zstd instead of "
+            "LZ4. This is slower to compress but considerably smaller, which helps on slow links. "
+            "Only the remote server's setting matters, the client follows whatever it was sent.");
+
+RDOC_CONFIG(bool, Replay_RemotePreviewTextures, false,
+            "When displaying 8-bit colour textures from a remote server, send a lossy BC7 "
+            "compressed preview instead of the exact data, for 4x less data when browsing over a "
+            "slow link. Picking, statistics and saving still fetch the exact data.");
+
+// compresses tightly packed 8-bit RGBA or BGRA data into BC7 blocks in RGBA order. Blocks that
+// overhang the edge of the image repeat its last row and column.
+static bool CompressPreviewBC7(const bytebuf &pixels, uint32_t width, uint32_t height, bool bgra,
+                               bytebuf &blocks)
+{
+#if ENABLED(RDOC_ANDROID)
+  return false;
+#else
+  if(pixels.size() < size_t(width) * height * 4)
+    return false;
+
+  void *opts = NULL;
+  CreateOptionsBC7(&opts);
+  // this is only for display, so favour speed over quality
+  SetQualityBC7(opts, 0.05f);
+
+  const uint32_t blocksWide = (width + 3) / 4;
+  const uint32_t blocksHigh = (height + 3) / 4;
+
+  blocks.resize(size_t(blocksWide) * blocksHigh * 16);
+
+  byte *out = blocks.data();
+  byte inblock[4 * 4 * 4];
+
+  for(uint32_t by = 0; by < blocksHigh; by++)
+  {
+    for(uint32_t bx = 0; bx < blocksWide; bx++)
+    {
+      for(uint32_t y = 0; y < 4; y++)
+      {
+        for(uint32_t x = 0; x < 4; x++)
+        {
+          uint32_t px = RDCMIN(bx * 4 + x, width - 1);
+          uint32_t py = RDCMIN(by * 4 + y, height - 1);
+
+          const byte *src = pixels.data() + (size_t(py) * width + px) * 4;
+          byte *dst = inblock + (y * 4 + x) * 4;
+
+          dst[0] = src[bgra ? 2 : 0];
+          dst[1] = src[1];
+          dst[2] = src[bgra ? 0 : 2];
+          dst[3] = src[3];
+        }
+      }
+
+      CompressBlockBC7(inblock, 4 * sizeof(uint32_t), out, opts);
+      out += 16;
+    }
+  }
+
+  DestroyOptionsBC7(opts);
+
+  return true;
+#endif
+}
+
+// whether a texture can be displayed from a BC7 preview without losing anything but precision
+static bool PreviewCompressible(const TextureDescription &tex)
+{
+  return tex.format.type == ResourceFormatType::Regular && tex.format.compByteWidth == 1 &&
+         tex.format.compCount == 4 &&
+         (tex.format.compType == CompType::UNorm || tex.format.compType == CompType::UNormSRGB) &&
+         tex.dimension == 2 && tex.msSamp <= 1 && (tex.width % 4) == 0 && (tex.height % 4) == 0 &&
+         !(tex.creationFlags & TextureCategory::DepthTarget);
+}
+
+static Compressor *MakeTransferCompressor(StreamWriter *writer, bool zstd)
+{
+  if(zstd)
+    return new ZSTDCompressor(writer, Ownership::Nothing);
+  return new LZ4Compressor(writer, Ownership::Nothing);
+}
+
+static Decompressor *MakeTransferDecompressor(StreamReader *reader, bool zstd)
+{
+  if(zstd)
+    return new ZSTDDecompressor(reader, Ownership::Nothing);
+  return new LZ4Decompressor(reader, Ownership::Nothing);
+}
 
 template <>
 rdcstr DoStringise(const ReplayProxyPacket &el)
@@ -41,6 +134,7 @@ rdcstr DoStringise(const ReplayProxyPacket &el)
 
     STRINGISE_ENUM_NAMED(eReplayProxy_CacheBufferData, "CacheBufferData");
     STRINGISE_ENUM_NAMED(eReplayProxy_CacheTextureData, "CacheTextureData");
+    STRINGISE_ENUM_NAMED(eReplayProxy_GetPreviewTextureData, "GetPreviewTextureData");
 
     STRINGISE_ENUM_NAMED(eReplayProxy_GetAPIProperties, "GetAPIProperties");
     STRINGISE_ENUM_NAMED(eReplayProxy_FetchStructuredFile, "FetchStructuredFile");
@@ -60,6 +154,8 @@ rdcstr DoStringise(const ReplayProxyPacket &el)
     STRINGISE_ENUM_NAMED(eReplayProxy_GetTextureData, "GetTextureData");
 
     STRINGISE_ENUM_NAMED(eReplayProxy_SavePipelineState, "SavePipelineState");
+    STRINGISE_ENUM_NAMED(eReplayProxy_GetVulkanDescriptors, "GetVulkanDescriptors");
+    STRINGISE_ENUM_NAMED(eReplayProxy_GetVulkanUsedDescriptors, "GetVulkanUsedDescriptors");
     STRINGISE_ENUM_NAMED(eReplayProxy_GetUsage, "GetUsage");
     STRINGISE_ENUM_NAMED(eReplayProxy_GetLiveID, "GetLiveID");
     STRINGISE_ENUM_NAMED(eReplayProxy_GetFrameRecord, "GetFrameRecord");
@@ -76,6 +172,7 @@ rdcstr DoStringise(const ReplayProxyPacket &el)
     STRINGISE_ENUM_NAMED(eReplayProxy_InitPostVS, "InitPostVS");
     STRINGISE_ENUM_NAMED(eReplayProxy_InitPostVSVec, "InitPostVSVec");
     STRINGISE_ENUM_NAMED(eReplayProxy_GetPostVS, "GetPostVS");
+    STRINGISE_ENUM_NAMED(eReplayProxy_GetPostVSCacheStatistics, "GetPostVSCacheStatistics");
 
     STRINGISE_ENUM_NAMED(eReplayProxy_BuildTargetShader, "BuildTargetShader");
     STRINGISE_ENUM_NAMED(eReplayProxy_ReplaceResource, "ReplaceResource");
@@ -88,6 +185,7 @@ rdcstr DoStringise(const ReplayProxyPacket &el)
     STRINGISE_ENUM_NAMED(eReplayProxy_RenderOverlay, "RenderOverlay");
 
     STRINGISE_ENUM_NAMED(eReplayProxy_PixelHistory, "PixelHistory");
+    STRINGISE_ENUM_NAMED(eReplayProxy_PixelHistoryRegion, "PixelHistoryRegion");
 
     STRINGISE_ENUM_NAMED(eReplayProxy_DisassembleShader, "DisassembleShader");
     STRINGISE_ENUM_NAMED(eReplayProxy_GetDisassemblyTargets, "GetDisassemblyTargets");
@@ -907,19 +1005,22 @@ void ReplayProxy::Proxied_GetBufferData(ParamSerialiser &paramser, ReturnSeriali
   // to this amount.
   uint64_t dataSize = retData.size() + 2 * retser.GetChunkAlignment();
 
+  // the sender picks the compression, the receiver reads whichever it chose
+  bool zstd = RemoteServer_ZstdTransfer();
+
   {
     ReturnSerialiser &ser = retser;
     PACKET_HEADER(packet);
     SERIALISE_ELEMENT(packet);
     SERIALISE_ELEMENT(dataSize);
+    SERIALISE_ELEMENT(zstd);
   }
 
   char empty[128] = {};
 
-  // lz4 compress
   if(retser.IsReading())
   {
-    ReadSerialiser ser(new StreamReader(new LZ4Decompressor(retser.GetReader(), Ownership::Nothing),
+    ReadSerialiser ser(new StreamReader(MakeTransferDecompressor(retser.GetReader(), zstd),
                                         dataSize, Ownership::Stream),
                        Ownership::Stream);
 
@@ -934,7 +1035,7 @@ void ReplayProxy::Proxied_GetBufferData(ParamSerialiser &paramser, ReturnSeriali
   }
   else
   {
-    WriteSerialiser ser(new StreamWriter(new LZ4Compressor(retser.GetWriter(), Ownership::Nothing),
+    WriteSerialiser ser(new StreamWriter(MakeTransferCompressor(retser.GetWriter(), zstd),
                                          Ownership::Stream),
                         Ownership::Stream);
 
@@ -985,19 +1086,22 @@ void ReplayProxy::Proxied_GetTextureData(ParamSerialiser &paramser, ReturnSerial
   // to this amount.
   uint64_t dataSize = data.size() + 2 * retser.GetChunkAlignment();
 
+  // the sender picks the compression, the receiver reads whichever it chose
+  bool zstd = RemoteServer_ZstdTransfer();
+
   {
     ReturnSerialiser &ser = retser;
     PACKET_HEADER(packet);
     SERIALISE_ELEMENT(packet);
     SERIALISE_ELEMENT(dataSize);
+    SERIALISE_ELEMENT(zstd);
   }
 
   char empty[128] = {};
 
-  // lz4 compress
   if(retser.IsReading())
   {
-    ReadSerialiser ser(new StreamReader(new LZ4Decompressor(retser.GetReader(), Ownership::Nothing),
+    ReadSerialiser ser(new StreamReader(MakeTransferDecompressor(retser.GetReader(), zstd),
                                         dataSize, Ownership::Stream),
                        Ownership::Stream);
 
@@ -1012,7 +1116,7 @@ void ReplayProxy::Proxied_GetTextureData(ParamSerialiser &paramser, ReturnSerial
   }
   else
   {
-    WriteSerialiser ser(new StreamWriter(new LZ4Compressor(retser.GetWriter(), Ownership::Nothing),
+    WriteSerialiser ser(new StreamWriter(MakeTransferCompressor(retser.GetWriter(), zstd),
                                          Ownership::Stream),
                         Ownership::Stream);
 
@@ -1091,6 +1195,35 @@ void ReplayProxy::InitPostVSBuffers(const rdcarray<uint32_t> &events)
   PROXY_FUNCTION(InitPostVSBuffers, events);
 }
 
+template <typename ParamSerialiser, typename ReturnSerialiser>
+PostVSCacheStatistics ReplayProxy::Proxied_GetPostVSCacheStatistics(ParamSerialiser &paramser,
+                                                                    ReturnSerialiser &retser)
+{
+  const ReplayProxyPacket expectedPacket = eReplayProxy_GetPostVSCacheStatistics;
+  ReplayProxyPacket packet = eReplayProxy_GetPostVSCacheStatistics;
+  PostVSCacheStatistics ret;
+
+  {
+    BEGIN_PARAMS();
+    END_PARAMS();
+  }
+
+  {
+    REMOTE_EXECUTION();
+    if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
+      ret = m_Remote->GetPostVSCacheStatistics();
+  }
+
+  SERIALISE_RETURN(ret);
+
+  return ret;
+}
+
+PostVSCacheStatistics ReplayProxy::GetPostVSCacheStatistics()
+{
+  PROXY_FUNCTION(GetPostVSCacheStatistics);
+}
+
 template <typename ParamSerialiser, typename ReturnSerialiser>
 MeshFormat ReplayProxy::Proxied_GetPostVSBuffers(ParamSerialiser &paramser, ReturnSerialiser &retser,
                                                  uint32_t eventId, uint32_t instID, uint32_t viewID,
@@ -1172,6 +1305,16 @@ rdcarray<ShaderEntryPoint> ReplayProxy::Proxied_GetShaderEntryPoints(ParamSerial
   ReplayProxyPacket packet = eReplayProxy_GetShaderEntryPoints;
   rdcarray<ShaderEntryPoint> ret;
 
+  // entry points can only change if shaders themselves are mutable
+  const bool cacheable = !m_APIProps.shadersMutable;
+
+  if(retser.IsReading() && cacheable)
+  {
+    auto it = m_ShaderEntryPointCache.find(id);
+    if(it != m_ShaderEntryPointCache.end())
+      return it->second;
+  }
+
   {
     BEGIN_PARAMS();
     SERIALISE_ELEMENT(id);
@@ -1186,6 +1329,9 @@ rdcarray<ShaderEntryPoint> ReplayProxy::Proxied_GetShaderEntryPoints(ParamSerial
 
   SERIALISE_RETURN(ret);
 
+  if(retser.IsReading() && cacheable && !m_IsErrored)
+    m_ShaderEntryPointCache[id] = ret;
+
   return ret;
 }
 
@@ -1268,6 +1414,20 @@ rdcstr ReplayProxy::Proxied_DisassembleShader(ParamSerialiser &paramser, ReturnS
     EntryPoint.stage = refl->stage;
   }
 
+  // only consider eventID part of the key on APIs where shaders are mutable, as with reflection
+  ShaderReflKey key(m_APIProps.shadersMutable ? m_EventID : 0, pipeline, Shader, EntryPoint);
+
+  if(retser.IsReading())
+  {
+    auto it = m_DisassemblyCache.find(key);
+    if(it != m_DisassemblyCache.end())
+    {
+      auto targetIt = it->second.find(target);
+      if(targetIt != it->second.end())
+        return targetIt->second;
+    }
+  }
+
   {
     BEGIN_PARAMS();
     SERIALISE_ELEMENT(pipeline);
@@ -1286,6 +1446,9 @@ rdcstr ReplayProxy::Proxied_DisassembleShader(ParamSerialiser &paramser, ReturnS
 
   SERIALISE_RETURN(ret);
 
+  if(retser.IsReading() && !m_IsErrored)
+    m_DisassemblyCache[key][target] = ret;
+
   return ret;
 }
 
@@ -1532,6 +1695,48 @@ rdcarray<PixelModification> ReplayProxy::PixelHistory(rdcarray<EventUsage> event
   PROXY_FUNCTION(PixelHistory, events, target, x, y, sub, typeCast);
 }
 
+template <typename ParamSerialiser, typename ReturnSerialiser>
+PixelRegionHistory ReplayProxy::Proxied_PixelHistoryRegion(
+    ParamSerialiser &paramser, ReturnSerialiser &retser, rdcarray<EventUsage> events,
+    ResourceId target, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+    const Subresource &sub, CompType typeCast)
+{
+  const ReplayProxyPacket expectedPacket = eReplayProxy_PixelHistoryRegion;
+  ReplayProxyPacket packet = eReplayProxy_PixelHistoryRegion;
+  PixelRegionHistory ret;
+
+  {
+    BEGIN_PARAMS();
+    SERIALISE_ELEMENT(events);
+    SERIALISE_ELEMENT(target);
+    SERIALISE_ELEMENT(x);
+    SERIALISE_ELEMENT(y);
+    SERIALISE_ELEMENT(width);
+    SERIALISE_ELEMENT(height);
+    SERIALISE_ELEMENT(sub);
+    SERIALISE_ELEMENT(typeCast);
+    END_PARAMS();
+  }
+
+  {
+    REMOTE_EXECUTION();
+    if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
+      ret = m_Remote->PixelHistoryRegion(events, target, x, y, width, height, sub, typeCast);
+  }
+
+  SERIALISE_RETURN(ret);
+
+  return ret;
+}
+
+PixelRegionHistory ReplayProxy::PixelHistoryRegion(rdcarray<EventUsage> events, ResourceId target,
+                                                   uint32_t x, uint32_t y, uint32_t width,
+                                                   uint32_t height, const Subresource &sub,
+                                                   CompType typeCast)
+{
+  PROXY_FUNCTION(PixelHistoryRegion, events, target, x, y, width, height, sub, typeCast);
+}
+
 template <typename ParamSerialiser, typename ReturnSerialiser>
 ShaderDebugTrace *ReplayProxy::Proxied_DebugVertex(ParamSerialiser &paramser,
                                                    ReturnSerialiser &retser, uint32_t eventId,
@@ -1609,6 +1814,17 @@ ShaderDebugTrace *ReplayProxy::DebugPixel(uint32_t eventId, uint32_t x, uint32_t
   PROXY_FUNCTION(DebugPixel, eventId, x, y, sample, primitive);
 }
 
+rdcarray<ShaderDebugTrace *> ReplayProxy::DebugPixels(
+    uint32_t eventId, const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels, uint32_t sample,
+    uint32_t primitive)
+{
+  // not batched over the network, each pixel is debugged with its own round-trip
+  rdcarray<ShaderDebugTrace *> ret;
+  for(const rdcpair<uint32_t, uint32_t> &p : pixels)
+    ret.push_back(DebugPixel(eventId, p.first, p.second, sample, primitive));
+  return ret;
+}
+
 template <typename ParamSerialiser, typename ReturnSerialiser>
 ShaderDebugTrace *ReplayProxy::Proxied_DebugThread(ParamSerialiser &paramser,
                                                    ReturnSerialiser &retser, uint32_t eventId,
@@ -1747,8 +1963,132 @@ void ReplayProxy::Proxied_SavePipelineState(ParamSerialiser &paramser, ReturnSer
     }
     else if(m_APIProps.pipelineType == GraphicsAPI::Vulkan)
     {
+      // descriptor sets can be enormous with bindless, and usually don't change from one event to
+      // the next. Send them separately so that unchanged sets are skipped - both sides keep the
+      // sets from the previous state, so only the ones that differ need to go across.
+      VKPipe::Pipeline *pipes[2] = {&m_VulkanPipelineState->graphics,
+                                    &m_VulkanPipelineState->compute};
+      rdcarray<VKPipe::DescriptorSet> descSets[2];
+
+      for(int p = 0; p < 2; p++)
+        pipes[p]->descriptorSets.swap(descSets[p]);
+
       SERIALISE_ELEMENT(*m_VulkanPipelineState);
+
+      for(int p = 0; p < 2; p++)
+        pipes[p]->descriptorSets.swap(descSets[p]);
+
+      for(int p = 0; p < 2; p++)
+      {
+        rdcarray<VKPipe::DescriptorSet> &sets = pipes[p]->descriptorSets;
+        rdcarray<VKPipe::DescriptorSet> &sent = m_SentDescriptorSets[p];
+
+        uint64_t numSets = sets.size();
+        SERIALISE_ELEMENT(numSets);
+
+        if(ser.IsReading())
+          sets.resize((size_t)numSets);
+        else
+          sent.resize((size_t)numSets);
+
+        for(size_t i = 0; i < sets.size(); i++)
+        {
+          VKPipe::DescriptorSet &set = sets[i];
+
+          bool changed = true;
+          if(ser.IsWriting())
+            changed = !(set == sent[i]);
+
+          SERIALISE_ELEMENT(changed);
+
+          if(changed)
+          {
+            SERIALISE_ELEMENT(set);
+
+            if(ser.IsWriting())
+              sent[i] = set;
+          }
+        }
+      }
     }
+
+    // the client immediately looks up the live IDs and reflection for every bound shader, so push
+    // those along with the state instead of waiting for a round trip for each one. Anything that
+    // was sent before is skipped since the client caches it for the lifetime of the connection.
+    rdcarray<ResourceId> prefetchIDs, prefetchLiveIDs;
+    rdcarray<ShaderReflKey> prefetchShaders;
+
+    if(ser.IsWriting())
+    {
+      for(const ShaderReflKey &key : GetBoundShaders())
+      {
+        ResourceId livePipe, liveShader;
+
+        if(key.pipeline != ResourceId())
+          livePipe = m_Remote->GetLiveID(key.pipeline);
+        liveShader = m_Remote->GetLiveID(key.shader);
+
+        if(key.pipeline != ResourceId() && m_PrefetchedLiveIDs.insert(key.pipeline).second)
+        {
+          prefetchIDs.push_back(key.pipeline);
+          prefetchLiveIDs.push_back(livePipe);
+        }
+
+        if(m_PrefetchedLiveIDs.insert(key.shader).second)
+        {
+          prefetchIDs.push_back(key.shader);
+          prefetchLiveIDs.push_back(liveShader);
+        }
+
+        // reflection is keyed by event when shaders are mutable, don't try to predict that
+        ShaderReflKey liveKey(0, livePipe, liveShader, key.entry);
+        if(!m_APIProps.shadersMutable && m_PrefetchedShaders.insert(liveKey).second)
+          prefetchShaders.push_back(liveKey);
+      }
+    }
+
+    SERIALISE_ELEMENT(prefetchIDs);
+    SERIALISE_ELEMENT(prefetchLiveIDs);
+
+    uint32_t numPrefetchShaders = prefetchShaders.count();
+    SERIALISE_ELEMENT(numPrefetchShaders);
+
+    for(uint32_t i = 0; i < numPrefetchShaders; i++)
+    {
+      ResourceId pipeline, shader;
+      ShaderEntryPoint entry;
+      ShaderReflection *refl = NULL;
+
+      if(ser.IsWriting())
+      {
+        pipeline = prefetchShaders[i].pipeline;
+        shader = prefetchShaders[i].shader;
+        entry = prefetchShaders[i].entry;
+        refl = m_Remote->GetShader(pipeline, shader, entry);
+      }
+
+      SERIALISE_ELEMENT(pipeline);
+      SERIALISE_ELEMENT(shader);
+      SERIALISE_ELEMENT(entry);
+      SERIALISE_ELEMENT_OPT(refl);
+
+      if(ser.IsReading())
+      {
+        ShaderReflKey key(0, pipeline, shader, entry);
+
+        if(m_ShaderReflectionCache.find(key) == m_ShaderReflectionCache.end())
+          m_ShaderReflectionCache[key] = refl;
+        else
+          delete refl;
+      }
+    }
+
+    if(ser.IsReading())
+    {
+      for(size_t i = 0; i < prefetchIDs.size() && i < prefetchLiveIDs.size(); i++)
+        m_LiveIDs[prefetchIDs[i]] = prefetchLiveIDs[i];
+    }
+
     SERIALISE_ELEMENT(packet);
     ser.EndChunk();
 
@@ -1832,6 +2172,150 @@ void ReplayProxy::SavePipelineState(uint32_t eventId)
   PROXY_FUNCTION(SavePipelineState, eventId);
 }
 
+template <typename ParamSerialiser, typename ReturnSerialiser>
+rdcarray<VKPipe::BindingElement> ReplayProxy::Proxied_GetVulkanDescriptors(
+    ParamSerialiser &paramser, ReturnSerialiser &retser, bool compute, uint32_t set,
+    uint32_t binding, uint32_t firstElement, uint32_t count)
+{
+  const ReplayProxyPacket expectedPacket = eReplayProxy_GetVulkanDescriptors;
+  ReplayProxyPacket packet = eReplayProxy_GetVulkanDescriptors;
+  rdcarray<VKPipe::BindingElement> ret;
+
+  {
+    BEGIN_PARAMS();
+    SERIALISE_ELEMENT(compute);
+    SERIALISE_ELEMENT(set);
+    SERIALISE_ELEMENT(binding);
+    SERIALISE_ELEMENT(firstElement);
+    SERIALISE_ELEMENT(count);
+    END_PARAMS();
+  }
+
+  {
+    REMOTE_EXECUTION();
+    if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
+      ret = m_Remote->GetVulkanDescriptors(compute, set, binding, firstElement, count);
+  }
+
+  SERIALISE_RETURN(ret);
+
+  return ret;
+}
+
+rdcarray<VKPipe::BindingElement> ReplayProxy::GetVulkanDescriptors(bool compute, uint32_t set,
+                                                                   uint32_t binding,
+                                                                   uint32_t firstElement,
+                                                                   uint32_t count)
+{
+  PROXY_FUNCTION(GetVulkanDescriptors, compute, set, binding, firstElement, count);
+}
+
+template <typename ParamSerialiser, typename ReturnSerialiser>
+rdcarray<uint32_t> ReplayProxy::Proxied_GetVulkanUsedDescriptors(ParamSerialiser &paramser,
+                                                                 ReturnSerialiser &retser,
+                                                                 bool compute, uint32_t set,
+                                                                 uint32_t binding)
+{
+  const ReplayProxyPacket expectedPacket = eReplayProxy_GetVulkanUsedDescriptors;
+  ReplayProxyPacket packet = eReplayProxy_GetVulkanUsedDescriptors;
+  rdcarray<uint32_t> ret;
+
+  {
+    BEGIN_PARAMS();
+    SERIALISE_ELEMENT(compute);
+    SERIALISE_ELEMENT(set);
+    SERIALISE_ELEMENT(binding);
+    END_PARAMS();
+  }
+
+  {
+    REMOTE_EXECUTION();
+    if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
+      ret = m_Remote->GetVulkanUsedDescriptors(compute, set, binding);
+  }
+
+  SERIALISE_RETURN(ret);
+
+  return ret;
+}
+
+rdcarray<uint32_t> ReplayProxy::GetVulkanUsedDescriptors(bool compute, uint32_t set,
+                                                         uint32_t binding)
+{
+  PROXY_FUNCTION(GetVulkanUsedDescriptors, compute, set, binding);
+}
+
+rdcarray<ReplayProxy::ShaderReflKey> ReplayProxy::GetBoundShaders()
+{
+  rdcarray<ShaderReflKey> ret;
+
+  if(m_APIProps.pipelineType == GraphicsAPI::D3D11 && m_D3D11PipelineState)
+  {
+    const D3D11Pipe::Shader *stages[] = {
+        &m_D3D11PipelineState->vertexShader, &m_D3D11PipelineState->hullShader,
+        &m_D3D11PipelineState->domainShader, &m_D3D11PipelineState->geometryShader,
+        &m_D3D11PipelineState->pixelShader,  &m_D3D11PipelineState->computeShader,
+    };
+
+    for(int i = 0; i < 6; i++)
+      if(stages[i]->resourceId != ResourceId())
+        ret.push_back(ShaderReflKey(0, ResourceId(), stages[i]->resourceId, ShaderEntryPoint()));
+
+    if(m_D3D11PipelineState->inputAssembly.resourceId != ResourceId())
+      ret.push_back(ShaderReflKey(0, ResourceId(), m_D3D11PipelineState->inputAssembly.resourceId,
+                                  ShaderEntryPoint()));
+  }
+  else if(m_APIProps.pipelineType == GraphicsAPI::D3D12 && m_D3D12PipelineState)
+  {
+    const D3D12Pipe::Shader *stages[] = {
+        &m_D3D12PipelineState->vertexShader, &m_D3D12PipelineState->hullShader,
+        &m_D3D12PipelineState->domainShader, &m_D3D12PipelineState->geometryShader,
+        &m_D3D12PipelineState->pixelShader,  &m_D3D12PipelineState->computeShader,
+    };
+
+    ResourceId pipe = m_D3D12PipelineState->pipelineResourceId;
+
+    for(int i = 0; i < 6; i++)
+      if(stages[i]->resourceId != ResourceId())
+        ret.push_back(ShaderReflKey(0, pipe, stages[i]->resourceId, ShaderEntryPoint()));
+  }
+  else if(m_APIProps.pipelineType == GraphicsAPI::OpenGL && m_GLPipelineState)
+  {
+    const GLPipe::Shader *stages[] = {
+        &m_GLPipelineState->vertexShader,   &m_GLPipelineState->tessControlShader,
+        &m_GLPipelineState->tessEvalShader, &m_GLPipelineState->geometryShader,
+        &m_GLPipelineState->fragmentShader, &m_GLPipelineState->computeShader,
+    };
+
+    for(int i = 0; i < 6; i++)
+      if(stages[i]->shaderResourceId != ResourceId())
+        ret.push_back(
+            ShaderReflKey(0, ResourceId(), stages[i]->shaderResourceId, ShaderEntryPoint()));
+  }
+  else if(m_APIProps.pipelineType == GraphicsAPI::Vulkan && m_VulkanPipelineState)
+  {
+    const VKPipe::Shader *stages[] = {
+        &m_VulkanPipelineState->vertexShader,   &m_VulkanPipelineState->tessControlShader,
+        &m_VulkanPipelineState->tessEvalShader, &m_VulkanPipelineState->geometryShader,
+        &m_VulkanPipelineState->fragmentShader, &m_VulkanPipelineState->computeShader,
+    };
+
+    ResourceId pipe = m_VulkanPipelineState->graphics.pipelineResourceId;
+
+    for(int i = 0; i < 6; i++)
+    {
+      if(i == 5)
+        pipe = m_VulkanPipelineState->compute.pipelineResourceId;
+
+      if(stages[i]->resourceId != ResourceId())
+        ret.push_back(ShaderReflKey(0, pipe, stages[i]->resourceId,
+                                    ShaderEntryPoint(stages[i]->entryPoint, stages[i]->stage)));
+    }
+  }
+
+  return ret;
+}
+
 template <typename ParamSerialiser, typename ReturnSerialiser>
 void ReplayProxy::Proxied_ReplayLog(ParamSerialiser &paramser, ReturnSerialiser &retser,
                                     uint32_t endEventID, ReplayLogType replayType)
@@ -1855,6 +2339,7 @@ void ReplayProxy::Proxied_ReplayLog(ParamSerialiser &paramser, ReturnSerialiser
   if(retser.IsReading())
   {
     m_TextureProxyCache.clear();
+    m_PreviewProxyCache.clear();
     m_BufferProxyCache.clear();
   }
 
@@ -1958,7 +2443,7 @@ void DoSerialise(SerialiserType &ser, DeltaSection &el)
 template <typename SerialiserType>
 void ReplayProxy::DeltaTransferBytes(SerialiserType &xferser, bytebuf &referenceData, bytebuf &newData)
 {
-  // lz4 compress
+  // compressed with LZ4 or zstd, as chosen by the sender
   if(xferser.IsReading())
   {
     uint64_t uncompSize = 0;
@@ -1972,12 +2457,15 @@ void ReplayProxy::DeltaTransferBytes(SerialiserType &xferser, bytebuf &reference
     }
     else
     {
+      bool zstd = false;
+      xferser.Serialise("zstd"_lit, zstd);
+
       rdcarray<DeltaSection> deltas;
 
       {
         ReadSerialiser ser(
-            new StreamReader(new LZ4Decompressor(xferser.GetReader(), Ownership::Nothing),
-                             uncompSize, Ownership::Stream),
+            new StreamReader(MakeTransferDecompressor(xferser.GetReader(), zstd), uncompSize,
+                             Ownership::Stream),
             Ownership::Stream);
 
         SERIALISE_ELEMENT(deltas);
@@ -2144,12 +2632,15 @@ void ReplayProxy::DeltaTransferBytes(SerialiserType &xferser, bytebuf &reference
         }
 
         // if there are still some bytes remaining at the end of the image, smaller than the chunk
-        // size, just diff directly and send if needed. We could combine this with the last delta if
-        // we ended in the active state.
+        // size, just diff directly and send if needed. If we ended in the active state the tail is
+        // contiguous with the last delta so extend it rather than starting a new one.
         if(bytesRemain > 0 && memcmp(src, dst, bytesRemain) != 0)
         {
-          deltasList.push_back(DeltaSection());
-          deltasList.back().offs = src - srcBegin;
+          if(state == DeltaState::None)
+          {
+            deltasList.push_back(DeltaSection());
+            deltasList.back().offs = src - srcBegin;
+          }
           deltasList.back().contents.append(src, bytesRemain);
         }
       }
@@ -2188,7 +2679,10 @@ void ReplayProxy::DeltaTransferBytes(SerialiserType &xferser, bytebuf &reference
 
     if(uncompSize > 0)
     {
-      WriteSerialiser ser(new StreamWriter(new LZ4Compressor(xferser.GetWriter(), Ownership::Nothing),
+      bool zstd = RemoteServer_ZstdTransfer();
+      xferser.Serialise("zstd"_lit, zstd);
+
+      WriteSerialiser ser(new StreamWriter(MakeTransferCompressor(xferser.GetWriter(), zstd),
                                            Ownership::Stream),
                           Ownership::Stream);
 
@@ -2294,6 +2788,61 @@ void ReplayProxy::CacheTextureData(ResourceId tex, const Subresource &sub,
   PROXY_FUNCTION(CacheTextureData, tex, sub, params);
 }
 
+template <typename ParamSerialiser, typename ReturnSerialiser>
+bool ReplayProxy::Proxied_GetPreviewTextureData(ParamSerialiser &paramser, ReturnSerialiser &retser,
+                                                ResourceId tex, const Subresource &sub,
+                                                const GetTextureDataParams &params, bytebuf &data)
+{
+  const ReplayProxyPacket expectedPacket = eReplayProxy_GetPreviewTextureData;
+  ReplayProxyPacket packet = eReplayProxy_GetPreviewTextureData;
+  bool ret = false;
+
+  {
+    BEGIN_PARAMS();
+    SERIALISE_ELEMENT(tex);
+    SERIALISE_ELEMENT(sub);
+    SERIALISE_ELEMENT(params);
+    END_PARAMS();
+  }
+
+  {
+    REMOTE_EXECUTION();
+    if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
+    {
+      TextureDescription desc = m_Remote->GetTexture(tex);
+
+      if(PreviewCompressible(desc))
+      {
+        bytebuf pixels;
+        m_Remote->GetTextureData(tex, sub, params, pixels);
+
+        ret = CompressPreviewBC7(pixels, RDCMAX(1U, desc.width >> sub.mip),
+                                 RDCMAX(1U, desc.height >> sub.mip), desc.format.BGRAOrder(), data);
+      }
+    }
+  }
+
+  {
+    ReturnSerialiser &ser = retser;
+    PACKET_HEADER(packet);
+    SERIALISE_ELEMENT(packet);
+    SERIALISE_ELEMENT(ret);
+    SERIALISE_ELEMENT(data);
+  }
+
+  retser.EndChunk();
+
+  CheckError(packet, expectedPacket);
+
+  return ret;
+}
+
+bool ReplayProxy::GetPreviewTextureData(ResourceId tex, const Subresource &sub,
+                                        const GetTextureDataParams &params, bytebuf &data)
+{
+  PROXY_FUNCTION(GetPreviewTextureData, tex, sub, params, data);
+}
+
 #pragma endregion Proxied Functions
 
 // If a remap is required, modify the params that are used when getting the proxy texture data
@@ -2410,35 +2959,110 @@ void ReplayProxy::RemapProxyTextureIfNeeded(TextureDescription &tex, GetTextureD
   }
 }
 
-void ReplayProxy::EnsureTexCached(ResourceId &texid, CompType &typeCast, const Subresource &sub)
+ReplayProxy::TextureCacheEntry ReplayProxy::GetTextureCacheEntry(ResourceId texid,
+                                                                 const Subresource &sub)
+{
+  TextureCacheEntry entry = {texid, sub};
+
+  // ignore parameters in the key which don't matter for this texture
+  auto it = m_TextureInfo.find(texid);
+  if(it != m_TextureInfo.end())
+  {
+    if(it->second.mips <= 1)
+      entry.sub.mip = 0;
+
+    if(it->second.dimension == 3 || it->second.arraysize <= 1)
+      entry.sub.slice = 0;
+
+    if(it->second.msSamp <= 1)
+      entry.sub.sample = 0;
+  }
+
+  return entry;
+}
+
+bool ReplayProxy::EnsurePreviewTexCached(ResourceId &texid, CompType &typeCast,
+                                         const Subresource &sub)
 {
+  if(!Replay_RemotePreviewTextures())
+    return false;
+
   if(m_Reader.IsErrored() || m_Writer.IsErrored())
-    return;
+    return false;
 
-  if(m_LocalTextures.find(texid) != m_LocalTextures.end())
-    return;
+  if(texid == ResourceId() || m_LocalTextures.find(texid) != m_LocalTextures.end())
+    return false;
 
-  if(texid == ResourceId())
-    return;
+  // the preview has the texture's own format, so it can't be reinterpreted
+  if(typeCast != CompType::Typeless && typeCast != CompType::UNorm &&
+     typeCast != CompType::UNormSRGB)
+    return false;
 
-  TextureCacheEntry entry = {texid, sub};
+  TextureCacheEntry entry = GetTextureCacheEntry(texid, sub);
 
-  // ignore parameters in the key which don't matter for this texture
+  // if the exact data is already here, e.g. after picking, display that instead
+  if(m_TextureProxyCache.find(entry) != m_TextureProxyCache.end())
+    return false;
+
+  auto proxyit = m_PreviewProxyTextures.find(texid);
+
+  if(proxyit == m_PreviewProxyTextures.end())
   {
-    auto it = m_TextureInfo.find(texid);
-    if(it != m_TextureInfo.end())
+    TextureDescription tex = GetTexture(texid);
+
+    ResourceId proxyid;
+
+    if(PreviewCompressible(tex))
     {
-      if(it->second.mips <= 1)
-        entry.sub.mip = 0;
+      tex.format.type = ResourceFormatType::BC7;
+      tex.format.SetBGRAOrder(false);
+
+      if(m_Proxy->IsTextureSupported(tex))
+        proxyid = m_Proxy->CreateProxyTexture(tex);
+    }
+
+    proxyit = m_PreviewProxyTextures.insert(std::make_pair(texid, proxyid)).first;
+  }
+
+  if(proxyit->second == ResourceId())
+    return false;
 
-      if(it->second.dimension == 3 || it->second.arraysize <= 1)
-        entry.sub.slice = 0;
+  if(m_PreviewProxyCache.find(entry) == m_PreviewProxyCache.end())
+  {
+    GetTextureDataParams params;
+    params.standardLayout = true;
 
-      if(it->second.msSamp <= 1)
-        entry.sub.sample = 0;
+    bytebuf data;
+    if(!GetPreviewTextureData(texid, entry.sub, params, data))
+    {
+      // the remote can't compress this, so don't ask again
+      proxyit->second = ResourceId();
+      return false;
     }
+
+    m_Proxy->SetProxyTextureData(proxyit->second, entry.sub, data.data(), data.size());
+
+    m_PreviewProxyCache.insert(entry);
   }
 
+  texid = proxyit->second;
+
+  return true;
+}
+
+void ReplayProxy::EnsureTexCached(ResourceId &texid, CompType &typeCast, const Subresource &sub)
+{
+  if(m_Reader.IsErrored() || m_Writer.IsErrored())
+    return;
+
+  if(m_LocalTextures.find(texid) != m_LocalTextures.end())
+    return;
+
+  if(texid == ResourceId())
+    return;
+
+  TextureCacheEntry entry = GetTextureCacheEntry(texid, sub);
+
   auto proxyit = m_ProxyTextures.find(texid);
 
   if(m_TextureProxyCache.find(entry) == m_TextureProxyCache.end())
@@ -2877,6 +3501,12 @@ bool ReplayProxy::Tick(int type)
     case eReplayProxy_CacheTextureData:
       CacheTextureData(ResourceId(), Subresource(), GetTextureDataParams());
       break;
+    case eReplayProxy_GetPreviewTextureData:
+    {
+      bytebuf dummy;
+      GetPreviewTextureData(ResourceId(), Subresource(), GetTextureDataParams(), dummy);
+      break;
+    }
     case eReplayProxy_ReplayLog: ReplayLog(0, (ReplayLogType)0); break;
     case eReplayProxy_FetchStructuredFile: FetchStructuredFile(); break;
     case eReplayProxy_GetAPIProperties: GetAPIProperties(); break;
@@ -2902,6 +3532,8 @@ bool ReplayProxy::Tick(int type)
       break;
     }
     case eReplayProxy_SavePipelineState: SavePipelineState(0); break;
+    case eReplayProxy_GetVulkanDescriptors: GetVulkanDescriptors(false, 0, 0, 0, 0); break;
+    case eReplayProxy_GetVulkanUsedDescriptors: GetVulkanUsedDescriptors(false, 0, 0); break;
     case eReplayProxy_GetUsage: GetUsage(ResourceId()); break;
     case eReplayProxy_GetLiveID: GetLiveID(ResourceId()); break;
     case eReplayProxy_GetFrameRecord: GetFrameRecord(); break;
@@ -2931,6 +3563,7 @@ bool ReplayProxy::Tick(int type)
       break;
     }
     case eReplayProxy_GetPostVS: GetPostVSBuffers(0, 0, 0, MeshDataStage::Unknown); break;
+    case eReplayProxy_GetPostVSCacheStatistics: GetPostVSCacheStatistics(); break;
     case eReplayProxy_BuildTargetShader:
     {
       rdcstr entry;
@@ -2957,6 +3590,10 @@ bool ReplayProxy::Tick(int type)
     case eReplayProxy_PixelHistory:
       PixelHistory(rdcarray<EventUsage>(), ResourceId(), 0, 0, Subresource(), CompType::Typeless);
       break;
+    case eReplayProxy_PixelHistoryRegion:
+      PixelHistoryRegion(rdcarray<EventUsage>(), ResourceId(), 0, 0, 0, 0, Subresource(),
+                         CompType::Typeless);
+      break;
     case eReplayProxy_DisassembleShader: DisassembleShader(ResourceId(), NULL, ""); break;
     case eReplayProxy_GetDisassemblyTargets: GetDisassemblyTargets(false); break;
     case eReplayProxy_GetTargetShaderEncodings: GetTargetShaderEncodings(); break;
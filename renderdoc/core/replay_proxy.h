@@ -46,6 +46,7 @@ enum ReplayProxyPacket
 
   eReplayProxy_CacheBufferData,
   eReplayProxy_CacheTextureData,
+  eReplayProxy_GetPreviewTextureData,
 
   eReplayProxy_GetAPIProperties,
   eReplayProxy_FetchStructuredFile,
@@ -65,6 +66,8 @@ enum ReplayProxyPacket
   eReplayProxy_GetTextureData,
 
   eReplayProxy_SavePipelineState,
+  eReplayProxy_GetVulkanDescriptors,
+  eReplayProxy_GetVulkanUsedDescriptors,
   eReplayProxy_GetUsage,
   eReplayProxy_GetLiveID,
   eReplayProxy_GetFrameRecord,
@@ -81,6 +84,7 @@ enum ReplayProxyPacket
   eReplayProxy_InitPostVS,
   eReplayProxy_InitPostVSVec,
   eReplayProxy_GetPostVS,
+  eReplayProxy_GetPostVSCacheStatistics,
 
   eReplayProxy_BuildTargetShader,
   eReplayProxy_ReplaceResource,
@@ -93,6 +97,7 @@ enum ReplayProxyPacket
   eReplayProxy_RenderOverlay,
 
   eReplayProxy_PixelHistory,
+  eReplayProxy_PixelHistoryRegion,
 
   eReplayProxy_DisassembleShader,
   eReplayProxy_GetDisassemblyTargets,
@@ -231,7 +236,8 @@ public:
   {
     if(m_Proxy)
     {
-      EnsureTexCached(cfg.resourceId, cfg.typeCast, cfg.subresource);
+      if(!EnsurePreviewTexCached(cfg.resourceId, cfg.typeCast, cfg.subresource))
+        EnsureTexCached(cfg.resourceId, cfg.typeCast, cfg.subresource);
 
       if(cfg.resourceId == ResourceId())
         return false;
@@ -276,6 +282,27 @@ public:
     }
   }
 
+  bool PickPixelTile(ResourceId texture, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                     const Subresource &sub, CompType typeCast, rdcarray<float> &pixels)
+  {
+    if(m_Proxy)
+    {
+      EnsureTexCached(texture, typeCast, sub);
+
+      if(texture == ResourceId())
+        return false;
+
+      // the OpenGL flip would reverse the rows in the tile, so leave that case to PickPixel
+      if((m_APIProps.pipelineType == GraphicsAPI::OpenGL) !=
+         (m_APIProps.localRenderer == GraphicsAPI::OpenGL))
+        return false;
+
+      return m_Proxy->PickPixelTile(texture, x, y, width, height, sub, typeCast, pixels);
+    }
+
+    return false;
+  }
+
   bool GetMinMax(ResourceId texid, const Subresource &sub, CompType typeCast, float *minval,
                  float *maxval)
   {
@@ -477,6 +504,10 @@ public:
   IMPLEMENT_FUNCTION_PROXIED(rdcarray<DebugMessage>, GetDebugMessages);
 
   IMPLEMENT_FUNCTION_PROXIED(void, SavePipelineState, uint32_t eventId);
+  IMPLEMENT_FUNCTION_PROXIED(rdcarray<VKPipe::BindingElement>, GetVulkanDescriptors, bool compute,
+                             uint32_t set, uint32_t binding, uint32_t firstElement, uint32_t count);
+  IMPLEMENT_FUNCTION_PROXIED(rdcarray<uint32_t>, GetVulkanUsedDescriptors, bool compute,
+                             uint32_t set, uint32_t binding);
   IMPLEMENT_FUNCTION_PROXIED(void, ReplayLog, uint32_t endEventID, ReplayLogType replayType);
 
   IMPLEMENT_FUNCTION_PROXIED(rdcarray<uint32_t>, GetPassEvents, uint32_t eventId);
@@ -502,8 +533,21 @@ public:
   IMPLEMENT_FUNCTION_PROXIED(void, GetTextureData, ResourceId tex, const Subresource &sub,
                              const GetTextureDataParams &params, bytebuf &data);
 
+  // batches aren't sent across as a whole, each readback is proxied in turn
+  void GetTextureDataBatch(const rdcarray<TextureReadback> &readbacks,
+                           TextureReadbackCallback callback)
+  {
+    for(size_t i = 0; i < readbacks.size(); i++)
+    {
+      bytebuf data;
+      GetTextureData(readbacks[i].tex, readbacks[i].sub, readbacks[i].params, data);
+      callback(i, data);
+    }
+  }
+
   IMPLEMENT_FUNCTION_PROXIED(void, InitPostVSBuffers, uint32_t eventId);
   IMPLEMENT_FUNCTION_PROXIED(void, InitPostVSBuffers, const rdcarray<uint32_t> &passEvents);
+  IMPLEMENT_FUNCTION_PROXIED(PostVSCacheStatistics, GetPostVSCacheStatistics);
   IMPLEMENT_FUNCTION_PROXIED(MeshFormat, GetPostVSBuffers, uint32_t eventId, uint32_t instID,
                              uint32_t viewID, MeshDataStage stage);
 
@@ -524,10 +568,16 @@ public:
   IMPLEMENT_FUNCTION_PROXIED(rdcarray<PixelModification>, PixelHistory, rdcarray<EventUsage> events,
                              ResourceId target, uint32_t x, uint32_t y, const Subresource &sub,
                              CompType typeCast);
+  IMPLEMENT_FUNCTION_PROXIED(PixelRegionHistory, PixelHistoryRegion, rdcarray<EventUsage> events,
+                             ResourceId target, uint32_t x, uint32_t y, uint32_t width,
+                             uint32_t height, const Subresource &sub, CompType typeCast);
   IMPLEMENT_FUNCTION_PROXIED(ShaderDebugTrace *, DebugVertex, uint32_t eventId, uint32_t vertid,
                              uint32_t instid, uint32_t idx, uint32_t view);
   IMPLEMENT_FUNCTION_PROXIED(ShaderDebugTrace *, DebugPixel, uint32_t eventId, uint32_t x,
                              uint32_t y, uint32_t sample, uint32_t primitive);
+  rdcarray<ShaderDebugTrace *> DebugPixels(uint32_t eventId,
+                                           const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels,
+                                           uint32_t sample, uint32_t primitive);
   IMPLEMENT_FUNCTION_PROXIED(ShaderDebugTrace *, DebugThread, uint32_t eventId,
                              const rdcfixedarray<uint32_t, 3> &groupid,
                              const rdcfixedarray<uint32_t, 3> &threadid);
@@ -549,6 +599,11 @@ public:
   IMPLEMENT_FUNCTION_PROXIED(void, CacheTextureData, ResourceId tex, const Subresource &sub,
                              const GetTextureDataParams &params);
 
+  // fetches a subresource BC7-compressed on the remote side, for a lossy preview. Returns false if
+  // the remote can't compress it.
+  IMPLEMENT_FUNCTION_PROXIED(bool, GetPreviewTextureData, ResourceId tex, const Subresource &sub,
+                             const GetTextureDataParams &params, bytebuf &data);
+
   // utility function to serialise the contents of a byte array given the previous contents that's
   // available on both sides of the communication.
   template <typename SerialiserType>
@@ -581,6 +636,7 @@ public:
 
 private:
   void EnsureTexCached(ResourceId &texid, CompType &typeCast, const Subresource &sub);
+  bool EnsurePreviewTexCached(ResourceId &texid, CompType &typeCast, const Subresource &sub);
   void RemapProxyTextureIfNeeded(TextureDescription &tex, GetTextureDataParams &params);
   void EnsureBufCached(ResourceId bufid);
   IMPLEMENT_FUNCTION_PROXIED(bool, NeedRemapForFetch, const ResourceFormat &format);
@@ -608,6 +664,15 @@ private:
   std::set<TextureCacheEntry> m_TextureProxyCache;
   std::set<ResourceId> m_BufferProxyCache;
 
+  TextureCacheEntry GetTextureCacheEntry(ResourceId texid, const Subresource &sub);
+
+  // the same as above, for the lossy BC7 previews used to display textures when
+  // Replay_RemotePreviewTextures is enabled. Previews are only used to display textures, anything
+  // that reads values like picking or saving always fetches the exact data. Textures that can't
+  // be previewed map to a NULL ID.
+  std::set<TextureCacheEntry> m_PreviewProxyCache;
+  std::map<ResourceId, ResourceId> m_PreviewProxyTextures;
+
   struct ProxyTextureProperties
   {
     ResourceId id;
@@ -663,6 +728,22 @@ private:
 
   std::map<ShaderReflKey, ShaderReflection *> m_ShaderReflectionCache;
 
+  // on the remote side, the live IDs and shader reflection we've already pushed to the client along
+  // with a pipeline state. The client keeps these cached for the lifetime of the connection.
+  std::set<ResourceId> m_PrefetchedLiveIDs;
+  std::set<ShaderReflKey> m_PrefetchedShaders;
+
+  // returns {pipeline, shader, entry} with original IDs for each shader in the current pipeline
+  // state, i.e. the reflection the client will look up after receiving it
+  rdcarray<ShaderReflKey> GetBoundShaders();
+
+  // disassembly of a given shader to a given target never changes, and the UI re-requests it each
+  // time a shader viewer is opened or the pipeline state is refreshed, so avoid the round trip.
+  std::map<ShaderReflKey, std::map<rdcstr, rdcstr>> m_DisassemblyCache;
+
+  // likewise entry points are immutable when shaders are, keyed by shader ID
+  std::map<ResourceId, rdcarray<ShaderEntryPoint>> m_ShaderEntryPointCache;
+
   // reader from the other side of the host <-> remote connection
   ReadSerialiser &m_Reader;
   // writer to the other side of the host <-> remote connection
@@ -724,4 +805,8 @@ private:
   D3D12Pipe::State *m_D3D12PipelineState = NULL;
   GLPipe::State *m_GLPipelineState = NULL;
   VKPipe::State *m_VulkanPipelineState = NULL;
+
+  // the Vulkan descriptor sets as last sent to the other side, graphics then compute, so that only
+  // sets which changed are sent with each new pipeline state
+  rdcarray<VKPipe::DescriptorSet> m_SentDescriptorSets[2];
 };
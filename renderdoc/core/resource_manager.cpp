@@ -201,10 +201,7 @@ bool IsCompleteWriteFrameRef(FrameRefType refType)
 
 void ResourceRecord::AddResourceReferences(ResourceRecordHandler *mgr)
 {
-  for(auto it = m_FrameRefs.begin(); it != m_FrameRefs.end(); ++it)
-  {
-    mgr->MarkResourceFrameReferenced(it->first, it->second);
-  }
+  mgr->MarkResourcesFrameReferenced(m_FrameRefs);
 }
 
 void ResourceRecord::Delete(ResourceRecordHandler *mgr)
@@ -34,9 +34,13 @@
 #include "api/replay/resourceid.h"
 #include "common/threading.h"
 #include "core/core.h"
+#include "core/resourceid_map.h"
+#include "core/settings.h"
 #include "os/os_specific.h"
 #include "serialise/serialiser.h"
 
+RDOC_EXTERN_CONFIG(uint32_t, Capture_InitialStateSerialiseThreads);
+
 // In what way (read, write, etc) was a resource referenced in a frame -
 // used to determine if initial contents are needed and to what degree.
 // These values are used both as states (representing the cumulative previous
@@ -289,6 +293,40 @@ inline bool MarkReferenced(std::unordered_map<ResourceId, FrameRefType> &refs, R
   return MarkReferenced(refs, id, refType, ComposeFrameRefs);
 }
 
+// a map keyed by ResourceId that's split into shards by ID, each with its own lock, so that threads
+// looking up different resources don't contend on a single lock.
+template <typename T>
+struct ShardedResourceMap
+{
+  static const size_t NumShards = 16;
+
+  struct Shard
+  {
+    std::unordered_map<ResourceId, T> map;
+    Threading::RWLock lock;
+  };
+
+  Shard &GetShard(ResourceId id) { return shards[std::hash<ResourceId>()(id) % NumShards]; }
+  // the functions below don't lock, the caller must ensure no shard is being modified
+  size_t size() const
+  {
+    size_t ret = 0;
+    for(size_t i = 0; i < NumShards; i++)
+      ret += shards[i].map.size();
+    return ret;
+  }
+
+  bool empty() const { return size() == 0; }
+  bool contains(ResourceId id) { return GetShard(id).map.count(id) > 0; }
+  void clear()
+  {
+    for(size_t i = 0; i < NumShards; i++)
+      shards[i].map.clear();
+  }
+
+  Shard shards[NumShards];
+};
+
 // verbose prints with IDs of each dirty resource and whether it was prepared,
 // and whether it was serialised.
 #define VERBOSE_DIRTY_RESOURCES OPTION_OFF
@@ -301,12 +339,30 @@ void SetReplayResourceIDs();
 
 struct ResourceRecord;
 
+// records add their chunks either to a map, for small per-command-buffer lists that need to be
+// ordered as they're built, or to a flat list of (ID, chunk) pairs that is sorted once at the end.
+// The flat list is used when gathering every referenced chunk for a capture, where there can be
+// millions of chunks and allocating a map node for each one is far slower than a single sort.
+typedef rdcarray<rdcpair<int64_t, Chunk *>> ChunkIDList;
+
+inline void AddRecordChunk(std::map<int64_t, Chunk *> &recordlist, int64_t id, Chunk *chunk)
+{
+  recordlist[id] = chunk;
+}
+
+inline void AddRecordChunk(ChunkIDList &recordlist, int64_t id, Chunk *chunk)
+{
+  recordlist.push_back({id, chunk});
+}
+
 class ResourceRecordHandler
 {
 public:
   virtual void MarkDirtyResource(ResourceId id) = 0;
   virtual void RemoveResourceRecord(ResourceId id) = 0;
   virtual void MarkResourceFrameReferenced(ResourceId id, FrameRefType refType) = 0;
+  virtual void MarkResourcesFrameReferenced(
+      const std::unordered_map<ResourceId, FrameRefType> &refs) = 0;
   virtual void DestroyResourceRecord(ResourceRecord *record) = 0;
 };
 
@@ -371,7 +427,8 @@ struct ResourceRecord
   }
 
   void MarkDataUnwritten() { DataWritten = false; }
-  void Insert(std::map<int64_t, Chunk *> &recordlist)
+  template <typename ChunkList>
+  void Insert(ChunkList &recordlist)
   {
     bool dataWritten = DataWritten;
 
@@ -388,7 +445,7 @@ struct ResourceRecord
     if(!dataWritten)
     {
       for(auto it = m_Chunks.begin(); it != m_Chunks.end(); ++it)
-        recordlist[it->id] = it->chunk;
+        AddRecordChunk(recordlist, it->id, it->chunk);
     }
   }
 
@@ -397,6 +454,12 @@ struct ResourceRecord
   void Delete(ResourceRecordHandler *mgr);
 
   ResourceId GetResourceID() const { return ResID; }
+
+  // chunk IDs come from one global counter, so that chunks in different records can be ordered
+  static int64_t GetID() { return Atomic::Inc64(&IDCounter()); }
+  // returns true if no chunk ID has been allocated since this one
+  static bool IsLatestID(int64_t ID) { return Atomic::CmpExch64(&IDCounter(), ID, ID) == ID; }
+
   void AddChunk(Chunk *chunk, int64_t ID = 0)
   {
     if(ID == 0)
@@ -509,11 +572,11 @@ protected:
 
   rdcarray<ResourceRecord *> Parents;
 
-  int64_t GetID()
+  static int64_t &IDCounter()
   {
     static int64_t globalIDCounter = 10;
 
-    return Atomic::Inc64(&globalIDCounter);
+    return globalIDCounter;
   }
 
   struct StoredChunk
@@ -607,6 +670,25 @@ public:
   // call callbacks to prepare initial contents for dirty resources
   void PrepareInitialContents();
 
+  // ahead of a queued capture, prepare the initial contents of a share of the dirty resources that
+  // don't have them yet, so the work is spread over the remaining frames. At capture start
+  // PrepareInitialContents keeps any of these that haven't been written since, and only
+  // re-prepares the rest. The caller must ensure it's safe to prepare contents, as at capture
+  // start.
+  void PreSnapshotInitialContents(uint32_t framesRemaining);
+
+  // free any initial contents prepared ahead of a capture, e.g. if the capture didn't happen
+  void DiscardPreSnapshots();
+  bool HasPreSnapshots();
+
+  // when another capture follows immediately, the initial contents prepared at the start of this
+  // one are still valid for any resource that wasn't written in between. Calling this before
+  // InsertInitialContentsChunks keeps them after serialising, and then at the end of the capture
+  // RetainInitialContentsForNextCapture() frees everything else and keeps them as pre-snapshots
+  // for the next PrepareInitialContents.
+  void SetRetainInitialContents(bool retain) { m_RetainInitialContents = retain; }
+  void RetainInitialContentsForNextCapture();
+
   InitialContentData GetInitialContents(ResourceId id);
   void SetInitialContents(ResourceId id, InitialContentData contents);
   void SetInitialChunk(ResourceId id, Chunk *chunk);
@@ -614,6 +696,11 @@ public:
   // generate chunks for initial contents and insert.
   void InsertInitialContentsChunks(WriteSerialiser &ser);
 
+  // while inserting initial contents chunks, the position of a resource's chunk in the stream.
+  // Initial states may be serialised out of order on several threads, so a chunk can only depend
+  // on chunks with a lower position.
+  uint32_t GetInitialContentsChunkOrder(ResourceId id);
+
   // for initial contents that don't need a chunk - apply them here. This allows any patching to
   // creation-time chunks to happen before they're written to disk.
   void ApplyInitialContentsNonChunks(WriteSerialiser &ser);
@@ -629,6 +716,10 @@ public:
   void MarkResourceFrameReferenced(ResourceId id, FrameRefType refType, Compose comp);
 
   inline void MarkResourceFrameReferenced(ResourceId id, FrameRefType refType);
+
+  // mark a set of references at once, such as those accumulated while recording a command buffer.
+  // Only the references that change anything take the global lock, and it's taken once for them.
+  void MarkResourcesFrameReferenced(const std::unordered_map<ResourceId, FrameRefType> &refs);
   void MarkBackgroundFrameReferenced(const rdcflatmap<ResourceId, FrameRefType> &refs);
   void CleanBackgroundFrameReferences();
 
@@ -660,6 +751,7 @@ public:
 
   // Free any initial contents that are prepared (for after capture is complete)
   void FreeInitialContents();
+  void FreeInitialContents(ResourceId id);
 
   // Apply the initial contents for the resources that need them, used at the start of a frame
   void ApplyInitialContents();
@@ -681,6 +773,12 @@ public:
   bool ShouldSkip(ResourceId id);
 
   virtual bool IsResourceTrackedForPersistency(const WrappedResourceType &res) { return false; }
+  // whether all writes to the resource are seen through write references, so contents taken
+  // before the capture can be trusted if it hasn't been written since.
+  virtual bool IsResourceTrackedForPreSnapshot(const WrappedResourceType &res)
+  {
+    return IsResourceTrackedForPersistency(res);
+  }
 protected:
   friend InitialContentData;
   // 'interface' to implement by derived classes
@@ -696,13 +794,26 @@ protected:
   virtual uint64_t GetSize_InitialState(ResourceId id, const InitialContentData &initial) = 0;
   virtual bool Serialise_InitialState(WriteSerialiser &ser, ResourceId id, RecordType *record,
                                       const InitialContentData *initialData) = 0;
+  // whether Serialise_InitialState can be called concurrently for different resources while
+  // writing, once their initial contents have been prepared.
+  virtual bool IsSerialiseInitialStateThreadSafe() { return false; }
   virtual void Create_InitialState(ResourceId id, WrappedResourceType live, bool hasData) = 0;
   virtual void Apply_InitialState(WrappedResourceType live, const InitialContentData &initial) = 0;
   virtual rdcarray<ResourceId> InitialContentResources();
 
   void UpdateLastWriteTime(ResourceId id, FrameRefType refType);
+  bool HasWriteSince(ResourceId id, double time);
+  bool IsRetainedInitialContents(ResourceId id)
+  {
+    return m_RetainInitialContents &&
+           m_CaptureSnapshotTimes.find(id) != m_CaptureSnapshotTimes.end();
+  }
 
   void Prepare_InitialStateIfPostponed(ResourceId id, bool midframe);
+
+  // whether marking a frame reference would have no effect, without taking the global lock
+  template <typename Compose>
+  bool IsFrameReferenceUnchanged(ResourceId id, FrameRefType refType, Compose comp);
   void SkipOrPostponeOrPrepare_InitialState(ResourceId id, FrameRefType refType);
 
   // very coarse lock, protects EVERYTHING. This could certainly be improved and it may be a
@@ -721,8 +832,10 @@ protected:
   // Unwrap)
   std::map<RealResourceType, WrappedResourceType> m_WrapperMap;
 
-  // used during capture - holds resources referenced in current frame (and how they're referenced)
-  std::unordered_map<ResourceId, FrameRefType> m_FrameReferencedResources;
+  // used during capture - holds resources referenced in current frame (and how they're referenced).
+  // Only modified while holding m_Lock and the shard's write lock, so it can be read under either
+  // m_Lock or the shard's read lock.
+  ShardedResourceMap<FrameRefType> m_FrameReferencedResources;
 
   // used during capture - holds resources marked as dirty, needing initial contents
   std::set<ResourceId> m_DirtyResources;
@@ -747,25 +860,28 @@ protected:
   // used during capture or replay - holds initial contents
   std::unordered_map<ResourceId, InitialContentDataOrChunk> m_InitialContents;
 
+  // used during capture - only while inserting initial contents chunks, see
+  // GetInitialContentsChunkOrder
+  std::unordered_map<ResourceId, uint32_t> m_InitialContentsChunkOrder;
+
   // used during capture or replay - map of resources currently alive with their real IDs, used in
   // capture and replay.
-  std::unordered_map<ResourceId, WrappedResourceType> m_CurrentResourceMap;
+  ResourceIdMap<WrappedResourceType> m_CurrentResourceMap;
 
   // used during replay - maps back and forth from original id to live id and vice-versa
-  std::unordered_map<ResourceId, ResourceId> m_OriginalIDs, m_LiveIDs;
+  ResourceIdMap<ResourceId> m_OriginalIDs, m_LiveIDs;
 
   // used during replay - holds resources allocated and the original id that they represent
-  std::unordered_map<ResourceId, WrappedResourceType> m_LiveResourceMap;
+  ResourceIdMap<WrappedResourceType> m_LiveResourceMap;
 
-  // used during capture - holds resource records by id.
-  std::unordered_map<ResourceId, RecordType *> m_ResourceRecords;
-  Threading::RWLock m_ResourceRecordLock;
+  // used during capture - holds resource records by id, each shard protected by its own lock.
+  ShardedResourceMap<RecordType *> m_ResourceRecords;
 
   // used during replay - holds current resource replacements
   // replaced -> replacement
-  std::unordered_map<ResourceId, ResourceId> m_Replacements;
+  ResourceIdMap<ResourceId> m_Replacements;
   // replacement -> replaced (for looking up original IDs)
-  std::unordered_map<ResourceId, ResourceId> m_Replaced;
+  ResourceIdMap<ResourceId> m_Replaced;
 
   // During initial resources preparation, persistent resources are
   // postponed until serializing to RDC file.
@@ -773,6 +889,12 @@ protected:
   // During initial resources preparation, resources that are completely written
   // over are skipped
   std::unordered_set<ResourceId> m_SkippedResourceIDs;
+  // Resources whose initial contents were prepared ahead of the capture, and when
+  std::unordered_map<ResourceId, double> m_PreSnapshotTimes;
+  // Resources whose initial contents were prepared at the start of the current capture, and when.
+  // These can become pre-snapshots for a capture that follows immediately
+  std::unordered_map<ResourceId, double> m_CaptureSnapshotTimes;
+  bool m_RetainInitialContents = false;
 
   struct ResourceRefTimes
   {
@@ -894,7 +1016,10 @@ void ResourceManager<Configuration>::CleanBackgroundFrameReferences()
       // if this isn't skippable, and the write time was a long time ago then we can delete it.
       // Resources not in the list are treated as if they were written an infinite time ago and so
       // are postponable.
-      if(now - check.writeTime > PERSISTENT_RESOURCE_AGE && check.firstSkipTime == 0.0)
+      // Resources with a snapshot taken ahead of a capture are kept so that any write to them is
+      // still noticed.
+      if(now - check.writeTime > PERSISTENT_RESOURCE_AGE && check.firstSkipTime == 0.0 &&
+         m_PreSnapshotTimes.find(check.id) == m_PreSnapshotTimes.end())
       {
         // skip src, check the next one
         src++;
@@ -920,11 +1045,14 @@ template <typename Compose>
 void ResourceManager<Configuration>::MarkResourceFrameReferenced(ResourceId id,
                                                                  FrameRefType refType, Compose comp)
 {
-  SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
-
   if(id == ResourceId())
     return;
 
+  if(IsFrameReferenceUnchanged(id, refType, comp))
+    return;
+
+  SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
+
   if(IsActiveCapturing(m_State))
   {
     SkipOrPostponeOrPrepare_InitialState(id, refType);
@@ -940,7 +1068,13 @@ void ResourceManager<Configuration>::MarkResourceFrameReferenced(ResourceId id,
   if(IsBackgroundCapturing(m_State))
     return;
 
-  bool newRef = MarkReferenced(m_FrameReferencedResources, id, refType, comp);
+  typename ShardedResourceMap<FrameRefType>::Shard &shard = m_FrameReferencedResources.GetShard(id);
+
+  bool newRef;
+  {
+    SCOPED_WRITELOCK(shard.lock);
+    newRef = MarkReferenced(shard.map, id, refType, comp);
+  }
 
   if(newRef)
   {
@@ -957,6 +1091,58 @@ void ResourceManager<Configuration>::MarkResourceFrameReferenced(ResourceId id,
   return MarkResourceFrameReferenced(id, refType, ComposeFrameRefs);
 }
 
+template <typename Configuration>
+template <typename Compose>
+bool ResourceManager<Configuration>::IsFrameReferenceUnchanged(ResourceId id, FrameRefType refType,
+                                                               Compose comp)
+{
+  // reads don't change anything while background capturing
+  if(IsBackgroundCapturing(m_State) && !IsDirtyFrameRef(refType))
+    return true;
+
+  // most references in a frame are repeats that don't change how the resource is referenced, and
+  // everything else in MarkResourceFrameReferenced was already done the first time. Those only
+  // need the shard's lock.
+  if(IsActiveCapturing(m_State))
+  {
+    typename ShardedResourceMap<FrameRefType>::Shard &shard =
+        m_FrameReferencedResources.GetShard(id);
+
+    SCOPED_READLOCK(shard.lock);
+
+    auto it = shard.map.find(id);
+    if(it != shard.map.end() && comp(it->second, refType) == it->second &&
+       (!IsDirtyFrameRef(refType) || it->second == refType))
+      return true;
+  }
+
+  return false;
+}
+
+template <typename Configuration>
+void ResourceManager<Configuration>::MarkResourcesFrameReferenced(
+    const std::unordered_map<ResourceId, FrameRefType> &refs)
+{
+  rdcarray<rdcpair<ResourceId, FrameRefType>> changed;
+
+  for(auto it = refs.begin(); it != refs.end(); ++it)
+  {
+    if(it->first == ResourceId())
+      continue;
+
+    if(!IsFrameReferenceUnchanged(it->first, it->second, ComposeFrameRefs))
+      changed.push_back({it->first, it->second});
+  }
+
+  if(changed.empty())
+    return;
+
+  SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
+
+  for(const rdcpair<ResourceId, FrameRefType> &ref : changed)
+    MarkResourceFrameReferenced(ref.first, ref.second);
+}
+
 template <typename Configuration>
 void ResourceManager<Configuration>::MarkDirtyResource(ResourceId res)
 {
@@ -966,6 +1152,10 @@ void ResourceManager<Configuration>::MarkDirtyResource(ResourceId res)
     return;
 
   m_DirtyResources.insert(res);
+
+  // being dirtied again means it may have changed in a way we don't see through write times, so any
+  // snapshot taken before now can't be used
+  m_PreSnapshotTimes.erase(res);
 }
 
 template <typename Configuration>
@@ -1061,14 +1251,17 @@ void ResourceManager<Configuration>::Serialise_InitialContentsNeeded(WriteSerial
 
   // all resources that were recorded as being modified should be included in the list of those
   // needing initial contents
-  for(auto it = m_FrameReferencedResources.begin(); it != m_FrameReferencedResources.end(); ++it)
+  for(auto &shard : m_FrameReferencedResources.shards)
   {
-    RecordType *record = GetResourceRecord(it->first);
-    if(IsDirtyFrameRef(it->second))
+    for(auto it = shard.map.begin(); it != shard.map.end(); ++it)
     {
-      WrittenRecord wr = {it->first, record ? record->DataInSerialiser : true};
+      RecordType *record = GetResourceRecord(it->first);
+      if(IsDirtyFrameRef(it->second))
+      {
+        WrittenRecord wr = {it->first, record ? record->DataInSerialiser : true};
 
-      NeededInitials.push_back(wr);
+        NeededInitials.push_back(wr);
+      }
     }
   }
 
@@ -1081,7 +1274,7 @@ void ResourceManager<Configuration>::Serialise_InitialContentsNeeded(WriteSerial
     bool include = RenderDoc::Inst().GetCaptureOptions().refAllResources;
 
     ResourceId id = it->first;
-    if(m_FrameReferencedResources.find(id) != m_FrameReferencedResources.end())
+    if(m_FrameReferencedResources.contains(id))
       include = true;
 
     if(include)
@@ -1110,6 +1303,22 @@ void ResourceManager<Configuration>::FreeInitialContents()
   }
   m_PostponedResourceIDs.clear();
   m_SkippedResourceIDs.clear();
+  m_PreSnapshotTimes.clear();
+  m_CaptureSnapshotTimes.clear();
+  m_RetainInitialContents = false;
+}
+
+template <typename Configuration>
+void ResourceManager<Configuration>::FreeInitialContents(ResourceId id)
+{
+  SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
+
+  auto it = m_InitialContents.find(id);
+  if(it != m_InitialContents.end())
+  {
+    it->second.Free(this);
+    m_InitialContents.erase(it);
+  }
 }
 
 template <typename Configuration>
@@ -1230,6 +1439,20 @@ inline void ResourceManager<Configuration>::UpdateLastWriteTime(ResourceId id, F
   }
 }
 
+template <typename Configuration>
+inline bool ResourceManager<Configuration>::HasWriteSince(ResourceId id, double time)
+{
+  // parent must hold m_Lock for us
+
+  ResourceRefTimes *it = std::lower_bound(m_ResourceRefTimes.begin(), m_ResourceRefTimes.end(), id);
+
+  if(it == m_ResourceRefTimes.end() || it->id != id)
+    return false;
+
+  // writes in the same millisecond as the snapshot are conservatively counted as after it
+  return it->writeTime >= time;
+}
+
 template <typename Configuration>
 inline bool ResourceManager<Configuration>::HasPersistentAge(ResourceId id)
 {
@@ -1375,16 +1598,19 @@ rdcarray<ResourceId> ResourceManager<Configuration>::InitialContentResources()
 template <typename Configuration>
 void ResourceManager<Configuration>::MarkUnwrittenResources()
 {
-  SCOPED_READLOCK(m_ResourceRecordLock);
+  for(auto &shard : m_ResourceRecords.shards)
+  {
+    SCOPED_READLOCK(shard.lock);
 
-  for(auto it = m_ResourceRecords.begin(); it != m_ResourceRecords.end(); ++it)
-    it->second->MarkDataUnwritten();
+    for(auto it = shard.map.begin(); it != shard.map.end(); ++it)
+      it->second->MarkDataUnwritten();
+  }
 }
 
 template <typename Configuration>
 void ResourceManager<Configuration>::InsertReferencedChunks(WriteSerialiser &ser)
 {
-  std::map<int64_t, Chunk *> sortedChunks;
+  ChunkIDList sortedChunks;
 
   SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
 
@@ -1392,21 +1618,23 @@ void ResourceManager<Configuration>::InsertReferencedChunks(WriteSerialiser &ser
 
   if(RenderDoc::Inst().GetCaptureOptions().refAllResources)
   {
-    SCOPED_READLOCK(m_ResourceRecordLock);
-
     float num = float(m_ResourceRecords.size());
     float idx = 0.0f;
 
-    for(auto it = m_ResourceRecords.begin(); it != m_ResourceRecords.end(); ++it)
+    for(auto &shard : m_ResourceRecords.shards)
     {
-      RenderDoc::Inst().SetProgress(CaptureProgress::AddReferencedResources, idx / num);
-      idx += 1.0f;
+      SCOPED_READLOCK(shard.lock);
 
-      if(m_FrameReferencedResources.find(it->first) == m_FrameReferencedResources.end() &&
-         it->second->InternalResource)
-        continue;
+      for(auto it = shard.map.begin(); it != shard.map.end(); ++it)
+      {
+        RenderDoc::Inst().SetProgress(CaptureProgress::AddReferencedResources, idx / num);
+        idx += 1.0f;
 
-      it->second->Insert(sortedChunks);
+        if(!m_FrameReferencedResources.contains(it->first) && it->second->InternalResource)
+          continue;
+
+        it->second->Insert(sortedChunks);
+      }
     }
   }
   else
@@ -1414,21 +1642,37 @@ void ResourceManager<Configuration>::InsertReferencedChunks(WriteSerialiser &ser
     float num = float(m_FrameReferencedResources.size());
     float idx = 0.0f;
 
-    for(auto it = m_FrameReferencedResources.begin(); it != m_FrameReferencedResources.end(); ++it)
+    for(auto &shard : m_FrameReferencedResources.shards)
     {
-      RenderDoc::Inst().SetProgress(CaptureProgress::AddReferencedResources, idx / num);
-      idx += 1.0f;
+      for(auto it = shard.map.begin(); it != shard.map.end(); ++it)
+      {
+        RenderDoc::Inst().SetProgress(CaptureProgress::AddReferencedResources, idx / num);
+        idx += 1.0f;
 
-      RecordType *record = GetResourceRecord(it->first);
-      if(record)
-        record->Insert(sortedChunks);
+        RecordType *record = GetResourceRecord(it->first);
+        if(record)
+          record->Insert(sortedChunks);
+      }
     }
   }
 
+  // each record's chunks are already in ID order, but records are visited in hash order so the
+  // list as a whole needs sorting
+  std::sort(sortedChunks.begin(), sortedChunks.end(),
+            [](const rdcpair<int64_t, Chunk *> &a, const rdcpair<int64_t, Chunk *> &b) {
+              return a.first < b.first;
+            });
+
   RDCDEBUG("%u frame resource chunks", (uint32_t)sortedChunks.size());
 
-  for(auto it = sortedChunks.begin(); it != sortedChunks.end(); it++)
-    it->second->Write(ser);
+  for(size_t i = 0; i < sortedChunks.size(); i++)
+  {
+    // each record is only inserted once, but never write the same chunk twice
+    if(i > 0 && sortedChunks[i].first == sortedChunks[i - 1].first)
+      continue;
+
+    sortedChunks[i].second->Write(ser);
+  }
 
   RDCDEBUG("inserted to serialiser");
 }
@@ -1442,6 +1686,9 @@ void ResourceManager<Configuration>::PrepareInitialContents()
   uint32_t prepared = 0;
   uint32_t postponed = 0;
   uint32_t skipped = 0;
+  uint32_t presnapshotted = 0;
+
+  m_CaptureSnapshotTimes.clear();
 
   float num = float(m_DirtyResources.size());
   float idx = 0.0f;
@@ -1466,9 +1713,22 @@ void ResourceManager<Configuration>::PrepareInitialContents()
     if(record == NULL || record->InternalResource)
       continue;
 
+    // if we already have contents from before the capture and the resource hasn't been written
+    // since, use them as-is
+    auto snap = m_PreSnapshotTimes.find(id);
+    if(snap != m_PreSnapshotTimes.end() && !HasWriteSince(id, snap->second))
+    {
+      m_CaptureSnapshotTimes[id] = snap->second;
+      presnapshotted++;
+      continue;
+    }
+
     if(ShouldSkip(id))
     {
       m_SkippedResourceIDs.insert(id);
+      // drop any stale snapshot, skipped resources have no initial contents
+      if(snap != m_PreSnapshotTimes.end())
+        FreeInitialContents(id);
       skipped++;
       continue;
     }
@@ -1488,12 +1748,126 @@ void ResourceManager<Configuration>::PrepareInitialContents()
     RDCDEBUG("Prepare Resource %s", ToStr(id).c_str());
 #endif
 
+    if(IsResourceTrackedForPreSnapshot(res))
+      m_CaptureSnapshotTimes[id] = m_ResourcesUpdateTimer.GetMilliseconds();
+
     Prepare_InitialState(res);
   }
 
+  if(presnapshotted > 0 || !m_PreSnapshotTimes.empty())
+    RDCLOG("Using %u dirty resources prepared before the capture (of %zu)", presnapshotted,
+           m_PreSnapshotTimes.size());
+
+  m_PreSnapshotTimes.clear();
+
   RDCLOG("Prepared %u dirty resources, postponed %u, skipped %u", prepared, postponed, skipped);
 }
 
+template <typename Configuration>
+void ResourceManager<Configuration>::PreSnapshotInitialContents(uint32_t framesRemaining)
+{
+  SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
+
+  rdcarray<ResourceId> pending;
+
+  for(auto it = m_DirtyResources.begin(); it != m_DirtyResources.end(); ++it)
+  {
+    ResourceId id = *it;
+
+    if(!HasCurrentResource(id))
+      continue;
+
+    RecordType *record = GetResourceRecord(id);
+
+    if(record == NULL || record->InternalResource)
+      continue;
+
+    // resources that will be skipped or postponed at capture time don't need any preparation
+    if(!IsResourceTrackedForPreSnapshot(GetCurrentResource(id)) || ShouldSkip(id) ||
+       ShouldPostpone(id))
+      continue;
+
+    auto snap = m_PreSnapshotTimes.find(id);
+    if(snap != m_PreSnapshotTimes.end() && !HasWriteSince(id, snap->second))
+      continue;
+
+    pending.push_back(id);
+  }
+
+  if(pending.empty())
+    return;
+
+  // spread what's left evenly over the remaining frames
+  size_t count = pending.size();
+  if(framesRemaining > 1)
+    count = (count + framesRemaining - 1) / framesRemaining;
+
+  RDCDEBUG("Preparing %zu of %zu resources ahead of capture in %u frames", count, pending.size(),
+           framesRemaining);
+
+  for(size_t i = 0; i < count; i++)
+  {
+    ResourceId id = pending[i];
+
+    // take the time before preparing, so any write that races with it counts as newer
+    m_PreSnapshotTimes[id] = m_ResourcesUpdateTimer.GetMilliseconds();
+
+    Prepare_InitialState(GetCurrentResource(id));
+  }
+}
+
+template <typename Configuration>
+void ResourceManager<Configuration>::DiscardPreSnapshots()
+{
+  SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
+
+  for(auto it = m_PreSnapshotTimes.begin(); it != m_PreSnapshotTimes.end(); ++it)
+  {
+    FreeInitialContents(it->first);
+  }
+
+  m_PreSnapshotTimes.clear();
+}
+
+template <typename Configuration>
+bool ResourceManager<Configuration>::HasPreSnapshots()
+{
+  SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
+
+  return !m_PreSnapshotTimes.empty();
+}
+
+template <typename Configuration>
+void ResourceManager<Configuration>::RetainInitialContentsForNextCapture()
+{
+  SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
+
+  rdcarray<ResourceId> unretained;
+  for(auto it = m_InitialContents.begin(); it != m_InitialContents.end(); ++it)
+  {
+    if(m_CaptureSnapshotTimes.find(it->first) == m_CaptureSnapshotTimes.end())
+      unretained.push_back(it->first);
+  }
+
+  for(ResourceId id : unretained)
+  {
+    auto it = m_InitialContents.find(id);
+    if(it != m_InitialContents.end())
+    {
+      it->second.Free(this);
+      m_InitialContents.erase(id);
+    }
+  }
+
+  m_PostponedResourceIDs.clear();
+  m_SkippedResourceIDs.clear();
+  m_PreSnapshotTimes.swap(m_CaptureSnapshotTimes);
+  m_CaptureSnapshotTimes.clear();
+  m_RetainInitialContents = false;
+
+  RDCLOG("Keeping %zu initial contents for the next capture", m_PreSnapshotTimes.size());
+}
+
 template <typename Configuration>
 void ResourceManager<Configuration>::InsertInitialContentsChunks(WriteSerialiser &ser)
 {
@@ -1505,17 +1879,27 @@ void ResourceManager<Configuration>::InsertInitialContentsChunks(WriteSerialiser
   RDCLOG("Checking %u resources with initial contents against %u referenced resources",
          (uint32_t)m_InitialContents.size(), (uint32_t)m_FrameReferencedResources.size());
 
-  float num = float(m_InitialContents.size());
-  float idx = 0.0f;
+  struct PendingInitialState
+  {
+    ResourceId id;
+    RecordType *record;
+    InitialContentDataOrChunk *contents;
+    uint64_t size;
+    StreamWriter *writer;
+  };
+
+  // gather the initial contents to write, in the order they'll be written. Element pointers into
+  // m_InitialContents stay valid even if preparing a postponed resource below adds entries.
+  rdcarray<PendingInitialState> pending;
+  pending.reserve(m_InitialContents.size());
+
+  m_InitialContentsChunkOrder.clear();
 
   for(auto it = m_InitialContents.begin(); it != m_InitialContents.end(); ++it)
   {
     ResourceId id = it->first;
 
-    RenderDoc::Inst().SetProgress(CaptureProgress::SerialiseInitialStates, idx / num);
-    idx += 1.0f;
-
-    if(m_FrameReferencedResources.find(id) == m_FrameReferencedResources.end() &&
+    if(!m_FrameReferencedResources.contains(id) &&
        !RenderDoc::Inst().GetCaptureOptions().refAllResources)
     {
 #if ENABLED(VERBOSE_DIRTY_RESOURCES)
@@ -1543,42 +1927,168 @@ void ResourceManager<Configuration>::InsertInitialContentsChunks(WriteSerialiser
       continue;
     }
 
+    m_InitialContentsChunkOrder[id] = (uint32_t)pending.size();
+    pending.push_back({id, record, &it->second, 0, NULL});
+  }
+
+  const uint32_t numThreads = RDCMAX(1U, Capture_InitialStateSerialiseThreads());
+  const bool parallel = numThreads > 1 && IsSerialiseInitialStateThreadSafe();
+
+  // serialising on worker threads needs a copy of each chunk until it's written in order, so limit
+  // how much is in flight at once. Larger initial states are serialised directly.
+  const uint64_t batchBudget = 256 * 1024 * 1024;
+  const uint64_t parallelMaxSize = batchBudget / numThreads;
+  const size_t batchMaxCount = numThreads * 64;
+
+  float num = float(pending.size());
+
+  rdcarray<Threading::ThreadHandle> threads;
+
+  size_t idx = 0;
+  while(idx < pending.size())
+  {
+    RenderDoc::Inst().SetProgress(CaptureProgress::SerialiseInitialStates, float(idx) / num);
+
+    // prepare as many initial states as fit in a batch. Postponed resources are prepared here
+    // rather than up front so that only a batch's worth of their contents is alive at once.
+    size_t batchBegin = idx;
+    size_t batchEnd = idx;
+    uint64_t batchSize = 0;
+    bool direct = false;
+
+    while(batchEnd < pending.size() && batchEnd - batchBegin < batchMaxCount)
+    {
+      PendingInitialState &p = pending[batchEnd];
+
 #if ENABLED(VERBOSE_DIRTY_RESOURCES)
-    RDCDEBUG("Serialising dirty Resource %s", ToStr(id).c_str());
+      RDCDEBUG("Serialising dirty Resource %s", ToStr(p.id).c_str());
 #endif
 
-    // Load postponed resource if needed.
-    Prepare_InitialStateIfPostponed(id, false);
+      // Load postponed resource if needed.
+      Prepare_InitialStateIfPostponed(p.id, false);
 
-    dirty++;
+      // this was handled in ApplyInitialContentsNonChunks(), there's no point copying the data
+      // again (it's already been serialised).
+      if(!Need_InitialStateChunk(p.id, p.contents->data))
+        p.contents = NULL;
+      else if(!p.contents->chunk)
+        p.size = GetSize_InitialState(p.id, p.contents->data);
 
-    if(!Need_InitialStateChunk(id, it->second.data))
-    {
-      // this was handled in ApplyInitialContentsNonChunks(), do nothing as there's no point copying
-      // the data again (it's already been serialised).
-      continue;
+      // anything that isn't serialised on a worker thread ends the batch, so that it's written
+      // directly after the batch and in order
+      if(!parallel || !p.contents || p.contents->chunk || p.size > parallelMaxSize ||
+         batchSize + p.size > batchBudget)
+      {
+        direct = true;
+        break;
+      }
+
+      batchSize += p.size;
+      batchEnd++;
     }
 
-    if(it->second.chunk)
+    if(batchEnd > batchBegin)
     {
-      it->second.chunk->Write(ser);
+      // the calling thread serialises too, alongside the workers
+      int32_t nextIdx = int32_t(batchBegin) - 1;
+      auto worker = [this, &pending, &nextIdx, &ser, batchEnd]() {
+        for(;;)
+        {
+          size_t i = (size_t)Atomic::Inc32(&nextIdx);
+          if(i >= batchEnd)
+            break;
+
+          PendingInitialState &p = pending[i];
+
+          p.writer = new StreamWriter(p.size);
+
+          WriteSerialiser workerSer(p.writer, Ownership::Nothing);
+          workerSer.SetChunkMetadataRecording(ser.GetChunkMetadataRecording());
+          workerSer.SetUserData(ser.GetUserData());
+
+          {
+            ScopedChunk scope(workerSer, SystemChunk::InitialContents, p.size);
+
+            Serialise_InitialState(workerSer, p.id, p.record, &p.contents->data);
+          }
+        }
+      };
+
+      uint32_t numWorkers = RDCMIN(numThreads, uint32_t(batchEnd - batchBegin));
+      for(uint32_t t = 1; t < numWorkers; t++)
+        threads.push_back(Threading::CreateThread(worker));
+
+      worker();
+
+      for(Threading::ThreadHandle t : threads)
+      {
+        Threading::JoinThread(t);
+        Threading::CloseThread(t);
+      }
+      threads.clear();
+
+      for(size_t i = batchBegin; i < batchEnd; i++)
+      {
+        PendingInitialState &p = pending[i];
+
+        // each chunk was serialised at the start of its own stream, so buffers inside it are
+        // only aligned if it starts at the serialiser's 64-byte chunk alignment here too.
+        ser.GetWriter()->AlignTo<64>();
+        ser.GetWriter()->Write(p.writer->GetData(), p.writer->GetOffset());
+        SAFE_DELETE(p.writer);
+
+        dirty++;
+
+        // Reset back to empty contents, unloading the actual resource.
+        if(!IsRetainedInitialContents(p.id))
+          SetInitialContents(p.id, InitialContentData());
+      }
     }
-    else
+
+    idx = batchEnd;
+
+    if(direct)
     {
-      uint64_t size = GetSize_InitialState(id, it->second.data);
+      PendingInitialState &p = pending[idx];
 
-      SCOPED_SERIALISE_CHUNK(SystemChunk::InitialContents, size);
+      idx++;
+      dirty++;
 
-      Serialise_InitialState(ser, id, record, &it->second.data);
-    }
+      if(!p.contents)
+        continue;
 
-    // Reset back to empty contents, unloading the actual resource.
-    SetInitialContents(id, InitialContentData());
+      if(p.contents->chunk)
+      {
+        p.contents->chunk->Write(ser);
+      }
+      else
+      {
+        SCOPED_SERIALISE_CHUNK(SystemChunk::InitialContents, p.size);
+
+        Serialise_InitialState(ser, p.id, p.record, &p.contents->data);
+      }
+
+      // Reset back to empty contents, unloading the actual resource.
+      if(!IsRetainedInitialContents(p.id))
+        SetInitialContents(p.id, InitialContentData());
+    }
   }
 
+  m_InitialContentsChunkOrder.clear();
+
   RDCLOG("Serialised %u resources, skipped %u unreferenced", dirty, skipped);
 }
 
+template <typename Configuration>
+uint32_t ResourceManager<Configuration>::GetInitialContentsChunkOrder(ResourceId id)
+{
+  auto it = m_InitialContentsChunkOrder.find(id);
+  if(it != m_InitialContentsChunkOrder.end())
+    return it->second;
+
+  return ~0U;
+}
+
 template <typename Configuration>
 void ResourceManager<Configuration>::ApplyInitialContentsNonChunks(WriteSerialiser &ser)
 {
@@ -1588,7 +2098,7 @@ void ResourceManager<Configuration>::ApplyInitialContentsNonChunks(WriteSerialis
   {
     ResourceId id = it->first;
 
-    if(m_FrameReferencedResources.find(id) == m_FrameReferencedResources.end() &&
+    if(!m_FrameReferencedResources.contains(id) &&
        !RenderDoc::Inst().GetCaptureOptions().refAllResources)
     {
       continue;
@@ -1609,19 +2119,24 @@ void ResourceManager<Configuration>::ClearReferencedResources()
 {
   SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
 
-  for(auto it = m_FrameReferencedResources.begin(); it != m_FrameReferencedResources.end(); ++it)
+  for(auto &shard : m_FrameReferencedResources.shards)
   {
-    RecordType *record = GetResourceRecord(it->first);
+    SCOPED_WRITELOCK(shard.lock);
 
-    if(record)
+    for(auto it = shard.map.begin(); it != shard.map.end(); ++it)
     {
-      if(IncludesWrite(it->second))
-        MarkDirtyResource(it->first);
-      record->Delete(this);
+      RecordType *record = GetResourceRecord(it->first);
+
+      if(record)
+      {
+        if(IncludesWrite(it->second))
+          MarkDirtyResource(it->first);
+        record->Delete(this);
+      }
     }
-  }
 
-  m_FrameReferencedResources.clear();
+    shard.map.clear();
+  }
 }
 
 template <typename Configuration>
@@ -1661,11 +2176,13 @@ void ResourceManager<Configuration>::RemoveReplacement(ResourceId id)
 template <typename Configuration>
 typename Configuration::RecordType *ResourceManager<Configuration>::GetResourceRecord(ResourceId id)
 {
-  SCOPED_READLOCK(m_ResourceRecordLock);
+  typename ShardedResourceMap<RecordType *>::Shard &shard = m_ResourceRecords.GetShard(id);
+
+  SCOPED_READLOCK(shard.lock);
 
-  auto it = m_ResourceRecords.find(id);
+  auto it = shard.map.find(id);
 
-  if(it == m_ResourceRecords.end())
+  if(it == shard.map.end())
     return NULL;
 
   return it->second;
@@ -1674,11 +2191,13 @@ typename Configuration::RecordType *ResourceManager<Configuration>::GetResourceR
 template <typename Configuration>
 bool ResourceManager<Configuration>::HasResourceRecord(ResourceId id)
 {
-  SCOPED_READLOCK(m_ResourceRecordLock);
+  typename ShardedResourceMap<RecordType *>::Shard &shard = m_ResourceRecords.GetShard(id);
 
-  auto it = m_ResourceRecords.find(id);
+  SCOPED_READLOCK(shard.lock);
 
-  if(it == m_ResourceRecords.end())
+  auto it = shard.map.find(id);
+
+  if(it == shard.map.end())
     return false;
 
   return true;
@@ -1687,21 +2206,25 @@ bool ResourceManager<Configuration>::HasResourceRecord(ResourceId id)
 template <typename Configuration>
 typename Configuration::RecordType *ResourceManager<Configuration>::AddResourceRecord(ResourceId id)
 {
-  SCOPED_WRITELOCK(m_ResourceRecordLock);
+  typename ShardedResourceMap<RecordType *>::Shard &shard = m_ResourceRecords.GetShard(id);
+
+  SCOPED_WRITELOCK(shard.lock);
 
-  RDCASSERT(m_ResourceRecords.find(id) == m_ResourceRecords.end(), id);
+  RDCASSERT(shard.map.find(id) == shard.map.end(), id);
 
-  return (m_ResourceRecords[id] = new RecordType(id));
+  return (shard.map[id] = new RecordType(id));
 }
 
 template <typename Configuration>
 void ResourceManager<Configuration>::RemoveResourceRecord(ResourceId id)
 {
-  SCOPED_WRITELOCK(m_ResourceRecordLock);
+  typename ShardedResourceMap<RecordType *>::Shard &shard = m_ResourceRecords.GetShard(id);
 
-  RDCASSERT(m_ResourceRecords.find(id) != m_ResourceRecords.end(), id);
+  SCOPED_WRITELOCK(shard.lock);
 
-  m_ResourceRecords.erase(id);
+  RDCASSERT(shard.map.find(id) != shard.map.end(), id);
+
+  shard.map.erase(id);
 }
 
 template <typename Configuration>
@@ -1902,6 +2425,9 @@ void ResourceManager<Configuration>::ReleaseCurrentResource(ResourceId id)
   m_CurrentResourceMap.erase(id);
   m_DirtyResources.erase(id);
 
+  if(m_PreSnapshotTimes.erase(id))
+    FreeInitialContents(id);
+
   auto it = std::lower_bound(m_ResourceRefTimes.begin(), m_ResourceRefTimes.end(), id);
   if(it != m_ResourceRefTimes.end())
     m_ResourceRefTimes.erase(it - m_ResourceRefTimes.begin());
@@ -0,0 +1,312 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2023 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <string.h>
+#include <functional>
+#include <utility>
+#include "api/replay/rdcpair.h"
+#include "api/replay/resourceid.h"
+#include "common/common.h"
+
+// A flat open-addressing hash map keyed on ResourceId, for the large and hot ID lookup maps where a
+// node-based std::unordered_map spends most of its time chasing pointers.
+//
+// Alongside the slots is an array of one control byte per slot, which is either empty, deleted, or
+// holds 7 bits of the key's hash. Lookups probe linearly through the control bytes and only touch a
+// slot when those bits match, so misses and collisions rarely load the keys themselves.
+//
+// Erasing leaves a tombstone rather than moving other entries, so iterators (other than to the
+// erased element) stay valid across erase(). Inserting may rehash and invalidates all iterators.
+template <typename T>
+class ResourceIdMap
+{
+public:
+  typedef rdcpair<ResourceId, T> value_type;
+  typedef size_t size_type;
+
+  template <typename MapType, typename ValueType>
+  class iter
+  {
+    friend class ResourceIdMap;
+
+    MapType *map;
+    size_t idx;
+
+    iter(MapType *m, size_t i) : map(m), idx(i) {}
+  public:
+    ValueType &operator*() const { return map->m_Slots[idx]; }
+    ValueType *operator->() const { return &map->m_Slots[idx]; }
+    iter &operator++()
+    {
+      idx = map->NextOccupied(idx + 1);
+      return *this;
+    }
+    iter operator++(int)
+    {
+      iter tmp(*this);
+      operator++();
+      return tmp;
+    }
+    bool operator==(const iter &o) const { return idx == o.idx && map == o.map; }
+    bool operator!=(const iter &o) const { return !(*this == o); }
+  };
+
+  typedef iter<ResourceIdMap, value_type> iterator;
+  typedef iter<const ResourceIdMap, const value_type> const_iterator;
+
+  ResourceIdMap() = default;
+  ~ResourceIdMap() { Free(); }
+  ResourceIdMap(const ResourceIdMap &o) { *this = o; }
+  ResourceIdMap &operator=(const ResourceIdMap &o)
+  {
+    if(this == &o)
+      return *this;
+
+    clear();
+    reserve(o.size());
+    for(const value_type &v : o)
+      (*this)[v.first] = v.second;
+    return *this;
+  }
+
+  iterator begin() { return iterator(this, FirstOccupied()); }
+  iterator end() { return iterator(this, m_Capacity); }
+  const_iterator begin() const { return const_iterator(this, FirstOccupied()); }
+  const_iterator end() const { return const_iterator(this, m_Capacity); }
+  size_t size() const { return m_Size; }
+  bool empty() const { return m_Size == 0; }
+  void clear()
+  {
+    for(size_t i = 0; i < m_Capacity; i++)
+    {
+      if(IsFull(m_Ctrl[i]))
+        m_Slots[i] = value_type();
+      m_Ctrl[i] = Empty;
+    }
+    m_Size = m_Deleted = m_FirstHint = 0;
+  }
+
+  // ensure at least count elements can be present without rehashing
+  void reserve(size_t count)
+  {
+    size_t cap = MinCapacity;
+    while(count > MaxLoad(cap))
+      cap *= 2;
+    if(cap > m_Capacity)
+      Rehash(cap);
+  }
+
+  iterator find(ResourceId id) { return iterator(this, FindIndex(id)); }
+  const_iterator find(ResourceId id) const { return const_iterator(this, FindIndex(id)); }
+  size_t count(ResourceId id) const { return FindIndex(id) != m_Capacity ? 1 : 0; }
+  T &operator[](ResourceId id)
+  {
+    // insertion may reallocate m_Slots, so it must happen before indexing
+    size_t idx = FindOrInsert(id);
+    return m_Slots[idx].second;
+  }
+  rdcpair<iterator, bool> insert(const value_type &val)
+  {
+    size_t prevSize = m_Size;
+    size_t idx = FindOrInsert(val.first);
+    bool inserted = m_Size != prevSize;
+    if(inserted)
+      m_Slots[idx].second = val.second;
+    return {iterator(this, idx), inserted};
+  }
+
+  void erase(iterator it) { EraseIndex(it.idx); }
+  size_t erase(ResourceId id)
+  {
+    size_t idx = FindIndex(id);
+    if(idx == m_Capacity)
+      return 0;
+    EraseIndex(idx);
+    return 1;
+  }
+
+  void swap(ResourceIdMap &o)
+  {
+    std::swap(m_Ctrl, o.m_Ctrl);
+    std::swap(m_Slots, o.m_Slots);
+    std::swap(m_Capacity, o.m_Capacity);
+    std::swap(m_Size, o.m_Size);
+    std::swap(m_Deleted, o.m_Deleted);
+    std::swap(m_FirstHint, o.m_FirstHint);
+  }
+
+private:
+  static const uint8_t Empty = 0x80;
+  static const uint8_t Deleted = 0xFE;
+  static const size_t MinCapacity = 16;
+
+  uint8_t *m_Ctrl = NULL;
+  value_type *m_Slots = NULL;
+  size_t m_Capacity = 0;
+  size_t m_Size = 0;
+  size_t m_Deleted = 0;
+  // no occupied slot is before this index. Kept so that repeatedly erasing begin() stays linear
+  // overall instead of rescanning the tombstones at the start of the table each time.
+  mutable size_t m_FirstHint = 0;
+
+  static bool IsFull(uint8_t c) { return (c & 0x80) == 0; }
+  // keep the table at most 7/8ths full, counting tombstones, so probe sequences stay short
+  static size_t MaxLoad(size_t cap) { return cap - cap / 8; }
+  static uint64_t Hash(ResourceId id)
+  {
+    // IDs are sequential, so mix the bits to spread them over the whole table
+    uint64_t h = std::hash<ResourceId>()(id);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  size_t FirstOccupied() const
+  {
+    m_FirstHint = NextOccupied(m_FirstHint);
+    return m_FirstHint;
+  }
+
+  size_t NextOccupied(size_t idx) const
+  {
+    while(idx < m_Capacity && !IsFull(m_Ctrl[idx]))
+      idx++;
+    return idx;
+  }
+
+  size_t FindIndex(ResourceId id) const
+  {
+    if(m_Size == 0)
+      return m_Capacity;
+
+    const uint64_t h = Hash(id);
+    const uint8_t h2 = uint8_t(h & 0x7f);
+    const size_t mask = m_Capacity - 1;
+
+    for(size_t idx = size_t(h >> 7) & mask;; idx = (idx + 1) & mask)
+    {
+      const uint8_t c = m_Ctrl[idx];
+      if(c == h2 && m_Slots[idx].first == id)
+        return idx;
+      if(c == Empty)
+        return m_Capacity;
+    }
+  }
+
+  size_t FindOrInsert(ResourceId id)
+  {
+    size_t idx = FindIndex(id);
+    if(idx != m_Capacity)
+      return idx;
+
+    if(m_Size + m_Deleted + 1 > MaxLoad(m_Capacity))
+    {
+      // if it's mostly tombstones just clean them out, otherwise grow
+      size_t cap = m_Capacity < MinCapacity ? MinCapacity : m_Capacity;
+      if(m_Size + 1 > MaxLoad(cap) / 2)
+        cap *= 2;
+      Rehash(cap);
+    }
+
+    const uint64_t h = Hash(id);
+    const size_t mask = m_Capacity - 1;
+
+    idx = size_t(h >> 7) & mask;
+    while(IsFull(m_Ctrl[idx]))
+      idx = (idx + 1) & mask;
+
+    if(m_Ctrl[idx] == Deleted)
+      m_Deleted--;
+
+    m_Ctrl[idx] = uint8_t(h & 0x7f);
+    m_Slots[idx].first = id;
+    m_Slots[idx].second = T();
+    m_Size++;
+    m_FirstHint = RDCMIN(m_FirstHint, idx);
+
+    return idx;
+  }
+
+  void EraseIndex(size_t idx)
+  {
+    m_Slots[idx] = value_type();
+    // if the next slot is empty, no probe sequence can continue past here so the slot can be freed
+    // entirely instead of leaving a tombstone
+    if(m_Ctrl[(idx + 1) & (m_Capacity - 1)] == Empty)
+    {
+      m_Ctrl[idx] = Empty;
+    }
+    else
+    {
+      m_Ctrl[idx] = Deleted;
+      m_Deleted++;
+    }
+    m_Size--;
+  }
+
+  void Rehash(size_t newCapacity)
+  {
+    uint8_t *oldCtrl = m_Ctrl;
+    value_type *oldSlots = m_Slots;
+    size_t oldCapacity = m_Capacity;
+
+    m_Ctrl = new uint8_t[newCapacity];
+    m_Slots = new value_type[newCapacity]();
+    m_Capacity = newCapacity;
+    m_Size = m_Deleted = m_FirstHint = 0;
+    memset(m_Ctrl, Empty, newCapacity);
+
+    const size_t mask = m_Capacity - 1;
+
+    for(size_t i = 0; i < oldCapacity; i++)
+    {
+      if(!IsFull(oldCtrl[i]))
+        continue;
+
+      const uint64_t h = Hash(oldSlots[i].first);
+      size_t idx = size_t(h >> 7) & mask;
+      while(m_Ctrl[idx] != Empty)
+        idx = (idx + 1) & mask;
+
+      m_Ctrl[idx] = uint8_t(h & 0x7f);
+      m_Slots[idx] = std::move(oldSlots[i]);
+      m_Size++;
+    }
+
+    delete[] oldCtrl;
+    delete[] oldSlots;
+  }
+
+  void Free()
+  {
+    delete[] m_Ctrl;
+    delete[] m_Slots;
+    m_Ctrl = NULL;
+    m_Slots = NULL;
+    m_Capacity = m_Size = m_Deleted = m_FirstHint = 0;
+  }
+};
@@ -0,0 +1,258 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2023 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "common/globalconfig.h"
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include <unordered_map>
+#include "common/formatting.h"
+#include "common/timing.h"
+#include "resourceid_map.h"
+
+#include "catch/catch.hpp"
+
+TEST_CASE("Test ResourceIdMap type", "[resourceidmap]")
+{
+  rdcarray<ResourceId> ids;
+  for(int i = 0; i < 1000; i++)
+    ids.push_back(ResourceIDGen::GetNewUniqueID());
+
+  SECTION("empty map")
+  {
+    ResourceIdMap<uint32_t> map;
+
+    CHECK(map.empty());
+    CHECK(map.size() == 0);
+    CHECK((map.begin() == map.end()));
+    CHECK((map.find(ids[0]) == map.end()));
+    CHECK(map.count(ids[0]) == 0);
+    CHECK(map.erase(ids[0]) == 0);
+  };
+
+  SECTION("insert, find and erase")
+  {
+    ResourceIdMap<uint32_t> map;
+
+    for(size_t i = 0; i < ids.size(); i++)
+      map[ids[i]] = uint32_t(i);
+
+    CHECK(map.size() == ids.size());
+
+    for(size_t i = 0; i < ids.size(); i++)
+    {
+      auto it = map.find(ids[i]);
+      REQUIRE((it != map.end()));
+      CHECK(it->first == ids[i]);
+      CHECK(it->second == i);
+    }
+
+    // insert doesn't overwrite an existing value
+    auto res = map.insert({ids[5], 1234U});
+    CHECK_FALSE(res.second);
+    CHECK(res.first->second == 5);
+
+    // erase every other element, both by key and by iterator
+    for(size_t i = 0; i < ids.size(); i += 2)
+    {
+      if(i % 4 == 0)
+        CHECK(map.erase(ids[i]) == 1);
+      else
+        map.erase(map.find(ids[i]));
+    }
+
+    CHECK(map.size() == ids.size() / 2);
+
+    for(size_t i = 0; i < ids.size(); i++)
+      CHECK(map.count(ids[i]) == (i % 2));
+
+    // re-inserting an erased key gives a default value
+    CHECK(map[ids[0]] == 0);
+    CHECK(map.size() == ids.size() / 2 + 1);
+
+    map.clear();
+    CHECK(map.empty());
+    CHECK((map.begin() == map.end()));
+    CHECK(map.count(ids[1]) == 0);
+  };
+
+  SECTION("iteration")
+  {
+    ResourceIdMap<uint32_t> map;
+
+    for(size_t i = 0; i < ids.size(); i++)
+      map[ids[i]] = uint32_t(i);
+
+    rdcarray<bool> seen;
+    seen.resize(ids.size());
+
+    size_t count = 0;
+    for(auto it = map.begin(); it != map.end(); ++it)
+    {
+      CHECK(it->first == ids[it->second]);
+      CHECK_FALSE(seen[it->second]);
+      seen[it->second] = true;
+      count++;
+    }
+
+    CHECK(count == ids.size());
+
+    // erasing the current element doesn't invalidate the iteration
+    count = 0;
+    for(auto it = map.begin(); it != map.end(); ++it)
+    {
+      if(it->second % 3 == 0)
+        map.erase(it);
+      count++;
+    }
+
+    CHECK(count == ids.size());
+    CHECK(map.size() == ids.size() - (ids.size() + 2) / 3);
+
+    // the Shutdown() pattern of always erasing the first element
+    while(!map.empty())
+      map.erase(map.begin());
+
+    CHECK((map.begin() == map.end()));
+  };
+
+  SECTION("matches std::unordered_map under churn")
+  {
+    ResourceIdMap<uint32_t> map;
+    std::unordered_map<ResourceId, uint32_t> reference;
+
+    uint32_t seed = 1;
+    for(uint32_t i = 0; i < 100000; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      ResourceId id = ids[(seed >> 8) % ids.size()];
+
+      if((seed >> 4) % 3 == 0)
+      {
+        CHECK(map.erase(id) == reference.erase(id));
+      }
+      else
+      {
+        map[id] = i;
+        reference[id] = i;
+      }
+    }
+
+    CHECK(map.size() == reference.size());
+
+    for(auto it = reference.begin(); it != reference.end(); ++it)
+    {
+      auto found = map.find(it->first);
+      REQUIRE((found != map.end()));
+      CHECK(found->second == it->second);
+    }
+
+    ResourceIdMap<uint32_t> copy = map;
+    CHECK(copy.size() == reference.size());
+    for(auto it = copy.begin(); it != copy.end(); ++it)
+      CHECK(reference[it->first] == it->second);
+  };
+};
+
+// hidden by default, run explicitly with the [benchmark] tag to get timings reported
+TEST_CASE("ResourceIdMap lookup performance", "[.][benchmark][resourceidmap]")
+{
+  // similar to the resource manager on replay of a large capture: two maps from original to live
+  // IDs and back, with many more lookups than insertions
+  const size_t numResources = 200000;
+  const size_t numLookups = 5000000;
+
+  rdcarray<ResourceId> origIds, liveIds;
+  for(size_t i = 0; i < numResources; i++)
+  {
+    origIds.push_back(ResourceIDGen::GetNewUniqueID());
+    liveIds.push_back(ResourceIDGen::GetNewUniqueID());
+  }
+
+  // a fixed pseudo-random lookup order shared between both map types
+  rdcarray<uint32_t> order;
+  order.resize(numLookups);
+  uint32_t seed = 1;
+  for(size_t i = 0; i < numLookups; i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    order[i] = (seed >> 4) % numResources;
+  }
+
+  PerformanceTimer timer;
+
+  ResourceIdMap<ResourceId> liveMap, origMap;
+  for(size_t i = 0; i < numResources; i++)
+  {
+    liveMap[origIds[i]] = liveIds[i];
+    origMap[liveIds[i]] = origIds[i];
+  }
+
+  double flatInsertMS = timer.GetMilliseconds();
+
+  timer.Restart();
+
+  size_t flatMatches = 0;
+  for(uint32_t idx : order)
+  {
+    ResourceId live = liveMap.find(origIds[idx])->second;
+    if(origMap.find(live)->second == origIds[idx])
+      flatMatches++;
+  }
+
+  double flatLookupMS = timer.GetMilliseconds();
+
+  timer.Restart();
+
+  std::unordered_map<ResourceId, ResourceId> stdLiveMap, stdOrigMap;
+  for(size_t i = 0; i < numResources; i++)
+  {
+    stdLiveMap[origIds[i]] = liveIds[i];
+    stdOrigMap[liveIds[i]] = origIds[i];
+  }
+
+  double stdInsertMS = timer.GetMilliseconds();
+
+  timer.Restart();
+
+  size_t stdMatches = 0;
+  for(uint32_t idx : order)
+  {
+    ResourceId live = stdLiveMap.find(origIds[idx])->second;
+    if(stdOrigMap.find(live)->second == origIds[idx])
+      stdMatches++;
+  }
+
+  double stdLookupMS = timer.GetMilliseconds();
+
+  CHECK(flatMatches == numLookups);
+  CHECK(stdMatches == numLookups);
+
+  WARN(StringFormat::Fmt("ResourceIdMap: %.2f ms insert, %.2f ms lookup. "
+                         "std::unordered_map: %.2f ms insert, %.2f ms lookup",
+                         flatInsertMS, flatLookupMS, stdInsertMS, stdLookupMS)
+           .c_str());
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -854,6 +854,86 @@ void PageTable::copyImageWrappedRange(uint32_t dstSubresource, const Coord &coor
     dstMapping->simplifyUnmapped();
 }
 
+rdcarray<Box> PageTable::getMappedBoxes(uint32_t subresource) const
+{
+  rdcarray<Box> ret;
+
+  const uint32_t mipLevel = subresource % m_MipCount;
+
+  const Coord mipDim = {
+      RDCMAX(1U, m_TextureDim.x >> mipLevel), RDCMAX(1U, m_TextureDim.y >> mipLevel),
+      RDCMAX(1U, m_TextureDim.z >> mipLevel),
+  };
+
+  const PageRangeMapping &mapping = getPageRangeMapping(subresource);
+
+  // whole subresource is either mapped or not
+  if(isSubresourceInMipTail(subresource) || mapping.hasSingleMapping())
+  {
+    if(mapping.isMapped())
+      ret.push_back({{0, 0, 0}, mipDim});
+    return ret;
+  }
+
+  const Coord pageDim = calcSubresourcePageDim(subresource);
+
+  // boxes which end on the previous row, which can be extended by an identical run on this row
+  rdcarray<size_t> prevRow, curRow;
+
+  for(uint32_t z = 0; z < pageDim.z; z++)
+  {
+    prevRow.clear();
+
+    for(uint32_t y = 0; y < pageDim.y; y++)
+    {
+      curRow.clear();
+
+      for(uint32_t x = 0; x < pageDim.x; x++)
+      {
+        if(mapping.pages[calcPageForTileCoord({x, y, z}, pageDim)].memory == ResourceId())
+          continue;
+
+        uint32_t runEnd = x + 1;
+        while(runEnd < pageDim.x &&
+              mapping.pages[calcPageForTileCoord({runEnd, y, z}, pageDim)].memory != ResourceId())
+          runEnd++;
+
+        Box box;
+        box.offset = {x * m_PageTexelSize.x, y * m_PageTexelSize.y, z * m_PageTexelSize.z};
+        box.extent = {
+            RDCMIN(runEnd * m_PageTexelSize.x, mipDim.x) - box.offset.x,
+            RDCMIN((y + 1) * m_PageTexelSize.y, mipDim.y) - box.offset.y,
+            RDCMIN((z + 1) * m_PageTexelSize.z, mipDim.z) - box.offset.z,
+        };
+
+        bool merged = false;
+        for(size_t b : prevRow)
+        {
+          if(ret[b].offset.x == box.offset.x && ret[b].extent.x == box.extent.x)
+          {
+            ret[b].extent.y += box.extent.y;
+            curRow.push_back(b);
+            merged = true;
+            break;
+          }
+        }
+
+        if(!merged)
+        {
+          curRow.push_back(ret.size());
+          ret.push_back(box);
+        }
+
+        x = runEnd;
+      }
+
+      prevRow.swap(curRow);
+    }
+  }
+
+  return ret;
+}
+
 Coord PageTable::calcSubresourcePageDim(uint32_t subresource) const
 {
   const uint32_t mipLevel = subresource % m_MipCount;
@@ -1599,6 +1679,51 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
     CHECK(pageTable.getSubresource(0).pages[_idx(13, 3)] == Sparse::Page({mem1, 0}));
   };
 
+  SECTION("mapped boxes")
+  {
+    pageTable.Initialise({500, 116, 1}, 6, 1, 64, {32, 32, 1}, 4, 0x10000, 0, 64);
+
+    ResourceId mem = ResourceIDGen::GetNewUniqueID();
+
+    // nothing mapped
+    CHECK(pageTable.getMappedBoxes(0).empty());
+    CHECK(pageTable.getMappedBoxes(4).empty());
+
+    // whole subresource is one box, clamped to the mip size
+    pageTable.setImageBoxRange(1, {0, 0, 0}, {250, 58, 1}, mem, 0, false);
+
+    rdcarray<Sparse::Box> boxes = pageTable.getMappedBoxes(1);
+    REQUIRE(boxes.size() == 1);
+    CHECK(boxes[0].offset == Sparse::Coord({0, 0, 0}));
+    CHECK(boxes[0].extent == Sparse::Coord({250, 58, 1}));
+
+    // two pages wide for two rows merge vertically, and the run at the right edge is clamped
+    pageTable.setImageBoxRange(0, {64, 0, 0}, {64, 64, 1}, mem, 0, false);
+    pageTable.setImageBoxRange(0, {448, 96, 0}, {500 - 448, 116 - 96, 1}, mem, 0, false);
+
+    boxes = pageTable.getMappedBoxes(0);
+    REQUIRE(boxes.size() == 2);
+    CHECK(boxes[0].offset == Sparse::Coord({64, 0, 0}));
+    CHECK(boxes[0].extent == Sparse::Coord({64, 64, 1}));
+    CHECK(boxes[1].offset == Sparse::Coord({448, 96, 0}));
+    CHECK(boxes[1].extent == Sparse::Coord({500 - 448, 116 - 96, 1}));
+
+    // a different run on the next row starts a new box
+    pageTable.setImageBoxRange(0, {32, 64, 0}, {96, 32, 1}, mem, 0, false);
+
+    boxes = pageTable.getMappedBoxes(0);
+    REQUIRE(boxes.size() == 3);
+    CHECK(boxes[1].offset == Sparse::Coord({32, 64, 0}));
+    CHECK(boxes[1].extent == Sparse::Coord({96, 32, 1}));
+
+    // mip tail is returned whole once mapped
+    pageTable.setMipTailRange(0x10000, mem, 0, 64, false);
+
+    boxes = pageTable.getMappedBoxes(4);
+    REQUIRE(boxes.size() == 1);
+    CHECK(boxes[0].extent == Sparse::Coord({31, 7, 1}));
+  };
+
   SECTION("2D texture that's all mip tail")
   {
     // create a 256x256 texture with 32x32 pages, 6 mips (the last two are in the mip tail)
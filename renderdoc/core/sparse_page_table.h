@@ -57,6 +57,13 @@ struct Page
   bool operator==(const Page &o) const { return memory == o.memory && offset == o.offset; }
 };
 
+// a box of texels within a subresource
+struct Box
+{
+  Coord offset;
+  Coord extent;
+};
+
 struct PageRangeMapping
 {
   bool hasSingleMapping() const { return pages.empty(); }
@@ -213,6 +220,12 @@ public:
     return subresourcePageDim.x * subresourcePageDim.y * subresourcePageDim.z * m_PageByteSize;
   }
 
+  // returns the texel boxes in a subresource that have memory mapped, clamped to the subresource's
+  // dimensions. Runs of mapped pages along a row are returned as one box, and identical runs in
+  // consecutive rows are merged, so a fully mapped subresource is a single box. Mip tail
+  // subresources are returned whole if any of the mip tail is mapped.
+  rdcarray<Box> getMappedBoxes(uint32_t subresource) const;
+
   // set a contiguous range of pages, with offsets and sizes applied in bytes.
   // This is when you are setting XYZ resource pages to point to ABC memory pages.
   // useSinglePage means only one page of memory will be used for all pages in the resource. Think
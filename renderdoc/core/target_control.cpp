@@ -27,12 +27,13 @@
 #include "api/replay/renderdoc_replay.h"
 #include "common/threading.h"
 #include "core/core.h"
+#include "core/memory_accounting.h"
 #include "jpeg-compressor/jpgd.h"
 #include "os/os_specific.h"
 #include "replay/replay_driver.h"
 #include "serialise/serialiser.h"
 
-static const uint32_t TargetControlProtocolVersion = 9;
+static const uint32_t TargetControlProtocolVersion = 11;
 
 static bool IsProtocolVersionSupported(const uint32_t protocolVersion)
 {
@@ -64,6 +65,14 @@ static bool IsProtocolVersionSupported(const uint32_t protocolVersion)
   if(protocolVersion == 8)
     return true;
 
+  // 9 -> 10 send frame stats in place of the keepalive ping
+  if(protocolVersion == 9)
+    return true;
+
+  // 10 -> 11 add memory usage to frame stats
+  if(protocolVersion == 10)
+    return true;
+
   if(protocolVersion == TargetControlProtocolVersion)
     return true;
 
@@ -85,7 +94,8 @@ enum PacketType : uint32_t
   ePacket_CaptureProgress,
   ePacket_CycleActiveWindow,
   ePacket_CapturableWindowCount,
-  ePacket_RequestShow
+  ePacket_RequestShow,
+  ePacket_FrameStats,
 };
 
 DECLARE_REFLECTION_ENUM(PacketType);
@@ -108,6 +118,7 @@ rdcstr DoStringise(const PacketType &el)
     STRINGISE_ENUM_NAMED(ePacket_CaptureProgress, "Capture Progress");
     STRINGISE_ENUM_NAMED(ePacket_CycleActiveWindow, "Cycle Active Window");
     STRINGISE_ENUM_NAMED(ePacket_CapturableWindowCount, "Capturable Window Count");
+    STRINGISE_ENUM_NAMED(ePacket_FrameStats, "Frame Stats");
   }
   END_ENUM_STRINGISE();
 }
@@ -228,10 +239,15 @@ void RenderDoc::TargetControlClientThread(uint32_t version, Network::Socket *cli
 
       rdcstr path = FileIO::GetFullPathname(captures.back().path);
 
+      // captures streamed to us are only in memory, not on disk
+      const bytebuf *streamed = RenderDoc::Inst().GetStreamedCapture(captures.back().path);
+
       bytebuf buf;
 
       ICaptureFile *file = RENDERDOC_OpenCaptureFile();
-      if(file->OpenFile(captures.back().path, "rdc", NULL).OK())
+      ResultDetails opened = streamed ? file->OpenBuffer(*streamed, "rdc", NULL)
+                                      : file->OpenFile(captures.back().path, "rdc", NULL);
+      if(opened.OK())
       {
         buf = file->GetThumbnail(FileType::JPG, 0).data;
       }
@@ -254,7 +270,8 @@ void RenderDoc::TargetControlClientThread(uint32_t version, Network::Socket *cli
         }
         if(version >= 6)
         {
-          uint64_t byteSize = FileIO::GetFileSize(captures.back().path);
+          uint64_t byteSize =
+              streamed ? streamed->size() : FileIO::GetFileSize(captures.back().path);
           SERIALISE_ELEMENT(byteSize);
         }
         if(version >= 9)
@@ -331,6 +348,30 @@ void RenderDoc::TargetControlClientThread(uint32_t version, Network::Socket *cli
     if(curtime > pingtime)
     {
       WRITE_DATA_SCOPE();
+      if(version >= 10)
+      {
+        // the frame timer only updates once a second, so piggy-back on the ping rather than
+        // sending a separate packet
+        double averageMS = 0.0, minimumMS = 0.0, maximumMS = 0.0;
+        RenderDoc::Inst().GetFrameTimes(averageMS, minimumMS, maximumMS);
+
+        SCOPED_SERIALISE_CHUNK(ePacket_FrameStats);
+        SERIALISE_ELEMENT(averageMS);
+        SERIALISE_ELEMENT(minimumMS);
+        SERIALISE_ELEMENT(maximumMS);
+
+        if(version >= 11)
+        {
+          uint64_t processMemory = Process::GetMemoryUsage();
+          uint64_t accountedMemory = 0;
+          for(uint32_t c = 0; c < (uint32_t)MemoryCategory::Count; c++)
+            accountedMemory += MemoryAccounting::GetBytes((MemoryCategory)c);
+
+          SERIALISE_ELEMENT(processMemory);
+          SERIALISE_ELEMENT(accountedMemory);
+        }
+      }
+      else
       {
         SCOPED_SERIALISE_CHUNK(ePacket_Noop);
       }
@@ -397,13 +438,19 @@ void RenderDoc::TargetControlClientThread(uint32_t version, Network::Socket *cli
 
           rdcstr filename = caps[id].path;
 
-          StreamReader fileStream(FileIO::fopen(filename, FileIO::ReadBinary));
-          ser.SerialiseStream(filename, fileStream);
+          const bytebuf *streamed = RenderDoc::Inst().GetStreamedCapture(filename);
+
+          StreamReader *fileStream =
+              streamed ? new StreamReader(*streamed)
+                       : new StreamReader(FileIO::fopen(filename, FileIO::ReadBinary));
+          ser.SerialiseStream(filename, *fileStream);
 
-          if(fileStream.IsErrored() || ser.IsErrored())
+          if(fileStream->IsErrored() || ser.IsErrored())
             SAFE_DELETE(client);
           else
             RenderDoc::Inst().MarkCaptureRetrieved(id);
+
+          delete fileStream;
         }
       }
       else if(type == ePacket_CycleActiveWindow)
@@ -769,6 +816,24 @@ public:
       reader.EndChunk();
       return msg;
     }
+    else if(type == ePacket_FrameStats)
+    {
+      msg.type = TargetControlMessageType::FrameStats;
+
+      READ_DATA_SCOPE();
+      SERIALISE_ELEMENT(msg.frameStats.averageMS).Named("Average"_lit);
+      SERIALISE_ELEMENT(msg.frameStats.minimumMS).Named("Minimum"_lit);
+      SERIALISE_ELEMENT(msg.frameStats.maximumMS).Named("Maximum"_lit);
+
+      if(m_Version >= 11)
+      {
+        SERIALISE_ELEMENT(msg.frameStats.processMemory).Named("Process Memory"_lit);
+        SERIALISE_ELEMENT(msg.frameStats.accountedMemory).Named("Accounted Memory"_lit);
+      }
+
+      reader.EndChunk();
+      return msg;
+    }
     else if(type == ePacket_CaptureProgress)
     {
       msg.type = TargetControlMessageType::CaptureProgress;
@@ -899,13 +964,19 @@ public:
 
       msg.newCapture.path = m_CaptureCopies[msg.newCapture.captureId];
 
-      StreamWriter streamWriter(FileIO::fopen(msg.newCapture.path, FileIO::WriteBinary),
-                                Ownership::Stream);
+      {
+        StreamWriter streamWriter(FileIO::fopen(msg.newCapture.path, FileIO::WriteBinary),
+                                  Ownership::Stream);
 
-      ser.SerialiseStream(msg.newCapture.path, streamWriter, progress);
+        ser.SerialiseStream(msg.newCapture.path, streamWriter, progress);
+      }
 
       if(reader.IsErrored())
       {
+        // the capture isn't marked as retrieved on the target so it can be copied again, don't
+        // leave a truncated file behind in the meantime.
+        FileIO::Delete(msg.newCapture.path);
+
         SAFE_DELETE(m_Socket);
 
         msg.type = TargetControlMessageType::Disconnected;
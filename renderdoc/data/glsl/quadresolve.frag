@@ -47,11 +47,22 @@ void main()
 {
   ivec2 quad = ivec2(gl_FragCoord.xy * 0.5f);
 
+  // slice i counts the covered pixels shaded in quads with i+1 covered pixels, so dividing gives
+  // the number of quads. Only .x is displayed, the rest is there for anyone reading back the
+  // overlay to calculate quad efficiency
   uint overdraw = 0u;
+  uint covered = 0u;
+  uint partial = 0u;
   for(uint i = 0u; i < 4u; i++)
-    overdraw += imageLoad(overdrawImage, ivec3(quad, i)).x / (i + 1u);
+  {
+    uint count = imageLoad(overdrawImage, ivec3(quad, i)).x;
+    overdraw += count / (i + 1u);
+    covered += count;
+    if(i < 3u)
+      partial += count / (i + 1u);
+  }
 
-  color_out = vec4(overdraw);
+  color_out = vec4(overdraw, covered, overdraw * 4u - covered, partial);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
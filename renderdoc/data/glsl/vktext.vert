@@ -40,10 +40,13 @@ void main(void)
   vec3 pos = verts[vert];
   uint strindex = uint(gl_VertexIndex) / 6u;
 
-  vec2 charPos =
-      vec2(float(strindex) + pos.x + general.TextPosition.x, pos.y + general.TextPosition.y);
+  // each character carries its own line and column, so many lines can be drawn at once
+  uvec4 ch = str.chars[strindex];
 
-  FontGlyphData G = glyphs.data[str.chars[strindex].x];
+  vec2 charPos = vec2(float(ch.z) + pos.x + general.TextPosition.x,
+                      float(ch.y) + pos.y + general.TextPosition.y);
+
+  FontGlyphData G = glyphs.data[ch.x];
 
   gl_Position =
       vec4(charPos.xy * 2.0f * general.TextSize * general.FontScreenAspect.xy + vec2(-1, -1), 1, 1);
@@ -67,11 +67,20 @@ float4 RENDERDOC_QOResolvePS(float4 vpos
 {
   uint2 quad = vpos.xy * 0.5;
 
+  // see quadresolve.frag for the meaning of each channel
   uint overdraw = 0;
+  uint covered = 0;
+  uint partial = 0;
   for(int i = 0; i < 4; i++)
-    overdraw += overdrawSRV[uint3(quad, i)] / (i + 1);
+  {
+    uint count = overdrawSRV[uint3(quad, i)];
+    overdraw += count / (i + 1);
+    covered += count;
+    if(i < 3)
+      partial += count / (i + 1);
+  }
 
-  return float(overdraw).xxxx;
+  return float4(overdraw, covered, overdraw * 4 - covered, partial);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
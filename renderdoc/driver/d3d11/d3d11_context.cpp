@@ -209,6 +209,8 @@ WrappedID3D11DeviceContext::WrappedID3D11DeviceContext(WrappedID3D11Device *real
     {
       m_SuccessfulCapture = false;
     }
+
+    UpdateStateTracking();
   }
 
   ReplayFakeContext(ResourceId());
@@ -507,6 +509,8 @@ void WrappedID3D11DeviceContext::AttemptCapture()
 
   m_FailureReason = CaptureSucceeded;
 
+  m_DiscardMapBaselines.clear();
+
   // deferred contexts are initially NOT successful unless empty. That's because we don't have the
   // serialised
   // contents of whatever is in them up until now (could be anything).
@@ -525,6 +529,12 @@ void WrappedID3D11DeviceContext::AttemptCapture()
     else
       m_FailureReason = CaptureFailed_UncappedCmdlist;
 
+    // start tracking state now we're capturing. An empty command list has had nothing set since
+    // the last clear, so its state is known and it can be captured from here.
+    UpdateStateTracking();
+    if(m_EmptyCommandList)
+      m_CurrentPipelineState->Clear();
+
     RDCDEBUG("Deferred Context %s Attempting capture - now %s", ToStr(GetResourceID()).c_str(),
              m_SuccessfulCapture ? "successful" : "unsuccessful");
   }
@@ -549,6 +559,14 @@ void WrappedID3D11DeviceContext::AttemptCapture()
   }
 }
 
+void WrappedID3D11DeviceContext::UpdateStateTracking()
+{
+  // the immediate context always tracks its state. Deferred contexts only need to while recording a
+  // command list that could be captured, or if their state carries over into the next command list.
+  if(IsCaptureMode(m_State) && GetType() == D3D11_DEVICE_CONTEXT_DEFERRED)
+    m_CurrentPipelineState->SetTracking(IsActiveCapturing(m_State) || m_DeferredStateCarriesOver);
+}
+
 void WrappedID3D11DeviceContext::FinishCapture()
 {
   if(GetType() != D3D11_DEVICE_CONTEXT_DEFERRED ||
@@ -1241,6 +1259,7 @@ RDResult WrappedID3D11DeviceContext::ReplayLog(CaptureState readType, uint32_t s
   ReadSerialiser ser(m_FrameReader, Ownership::Nothing);
 
   ser.SetStringDatabase(&m_StringDB);
+  ser.SetCallstackTable(m_pDevice->GetCallstackTable());
   ser.SetUserData(GetResourceManager());
   ser.SetVersion(m_pDevice->GetLogVersion());
 
@@ -31,6 +31,10 @@
 #include "d3d11_manager.h"
 #include "d3d11_video.h"
 
+// checks the tracked pipeline state against what the real context returned, for use in the Get
+// functions. Skipped when the state isn't tracked, e.g. on non-capturing deferred contexts.
+#define RDCASSERT_STATE(cond) RDCASSERT(!m_CurrentPipelineState->IsKnown() || (cond))
+
 struct MapIntercept
 {
   MapIntercept()
@@ -124,6 +128,9 @@ private:
 
   std::set<ResourceId> m_HighTrafficResources;
   std::map<MappedResource, MapIntercept> m_OpenMaps;
+  // buffers which have been WRITE_DISCARD mapped in full during this capture. After that their
+  // shadow copy matches what replay will have, so later discards only need to store what changed.
+  std::set<MappedResource> m_DiscardMapBaselines;
 
   std::map<ResourceId, rdcarray<EventUsage>> m_ResourceUses;
 
@@ -157,6 +164,11 @@ private:
   CaptureFailReason m_FailureReason;
   bool m_SuccessfulCapture;
   bool m_EmptyCommandList;
+  // set once a command list is finished with RestoreDeferredContextState, since from then on the
+  // state carries over between command lists and must always be tracked
+  bool m_DeferredStateCarriesOver = false;
+
+  void UpdateStateTracking();
 
   bool m_MarkedActive = false;
 
@@ -1481,14 +1481,15 @@ void WrappedID3D11DeviceContext::VSGetConstantBuffers1(UINT StartSlot, UINT NumB
       ppConstantBuffers[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppConstantBuffers[i]);
 
-      RDCASSERT(ppConstantBuffers[i] == m_CurrentPipelineState->VS.ConstantBuffers[i + StartSlot]);
+      RDCASSERT_STATE(ppConstantBuffers[i] ==
+                      m_CurrentPipelineState->VS.ConstantBuffers[i + StartSlot]);
     }
 
     if(pFirstConstant)
-      RDCASSERT(pFirstConstant[i] == m_CurrentPipelineState->VS.CBOffsets[i + StartSlot]);
+      RDCASSERT_STATE(pFirstConstant[i] == m_CurrentPipelineState->VS.CBOffsets[i + StartSlot]);
 
     if(pNumConstants)
-      RDCASSERT(pNumConstants[i] == m_CurrentPipelineState->VS.CBCounts[i + StartSlot]);
+      RDCASSERT_STATE(pNumConstants[i] == m_CurrentPipelineState->VS.CBCounts[i + StartSlot]);
   }
 }
 
@@ -1524,14 +1525,15 @@ void WrappedID3D11DeviceContext::HSGetConstantBuffers1(UINT StartSlot, UINT NumB
       ppConstantBuffers[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppConstantBuffers[i]);
 
-      RDCASSERT(ppConstantBuffers[i] == m_CurrentPipelineState->HS.ConstantBuffers[i + StartSlot]);
+      RDCASSERT_STATE(ppConstantBuffers[i] ==
+                      m_CurrentPipelineState->HS.ConstantBuffers[i + StartSlot]);
     }
 
     if(pFirstConstant)
-      RDCASSERT(pFirstConstant[i] == m_CurrentPipelineState->HS.CBOffsets[i + StartSlot]);
+      RDCASSERT_STATE(pFirstConstant[i] == m_CurrentPipelineState->HS.CBOffsets[i + StartSlot]);
 
     if(pNumConstants)
-      RDCASSERT(pNumConstants[i] == m_CurrentPipelineState->HS.CBCounts[i + StartSlot]);
+      RDCASSERT_STATE(pNumConstants[i] == m_CurrentPipelineState->HS.CBCounts[i + StartSlot]);
   }
 }
 
@@ -1567,14 +1569,15 @@ void WrappedID3D11DeviceContext::DSGetConstantBuffers1(UINT StartSlot, UINT NumB
       ppConstantBuffers[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppConstantBuffers[i]);
 
-      RDCASSERT(ppConstantBuffers[i] == m_CurrentPipelineState->DS.ConstantBuffers[i + StartSlot]);
+      RDCASSERT_STATE(ppConstantBuffers[i] ==
+                      m_CurrentPipelineState->DS.ConstantBuffers[i + StartSlot]);
     }
 
     if(pFirstConstant)
-      RDCASSERT(pFirstConstant[i] == m_CurrentPipelineState->DS.CBOffsets[i + StartSlot]);
+      RDCASSERT_STATE(pFirstConstant[i] == m_CurrentPipelineState->DS.CBOffsets[i + StartSlot]);
 
     if(pNumConstants)
-      RDCASSERT(pNumConstants[i] == m_CurrentPipelineState->DS.CBCounts[i + StartSlot]);
+      RDCASSERT_STATE(pNumConstants[i] == m_CurrentPipelineState->DS.CBCounts[i + StartSlot]);
   }
 }
 
@@ -1610,14 +1613,15 @@ void WrappedID3D11DeviceContext::GSGetConstantBuffers1(UINT StartSlot, UINT NumB
       ppConstantBuffers[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppConstantBuffers[i]);
 
-      RDCASSERT(ppConstantBuffers[i] == m_CurrentPipelineState->GS.ConstantBuffers[i + StartSlot]);
+      RDCASSERT_STATE(ppConstantBuffers[i] ==
+                      m_CurrentPipelineState->GS.ConstantBuffers[i + StartSlot]);
     }
 
     if(pFirstConstant)
-      RDCASSERT(pFirstConstant[i] == m_CurrentPipelineState->GS.CBOffsets[i + StartSlot]);
+      RDCASSERT_STATE(pFirstConstant[i] == m_CurrentPipelineState->GS.CBOffsets[i + StartSlot]);
 
     if(pNumConstants)
-      RDCASSERT(pNumConstants[i] == m_CurrentPipelineState->GS.CBCounts[i + StartSlot]);
+      RDCASSERT_STATE(pNumConstants[i] == m_CurrentPipelineState->GS.CBCounts[i + StartSlot]);
   }
 }
 
@@ -1653,14 +1657,15 @@ void WrappedID3D11DeviceContext::PSGetConstantBuffers1(UINT StartSlot, UINT NumB
       ppConstantBuffers[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppConstantBuffers[i]);
 
-      RDCASSERT(ppConstantBuffers[i] == m_CurrentPipelineState->PS.ConstantBuffers[i + StartSlot]);
+      RDCASSERT_STATE(ppConstantBuffers[i] ==
+                      m_CurrentPipelineState->PS.ConstantBuffers[i + StartSlot]);
     }
 
     if(pFirstConstant)
-      RDCASSERT(pFirstConstant[i] == m_CurrentPipelineState->PS.CBOffsets[i + StartSlot]);
+      RDCASSERT_STATE(pFirstConstant[i] == m_CurrentPipelineState->PS.CBOffsets[i + StartSlot]);
 
     if(pNumConstants)
-      RDCASSERT(pNumConstants[i] == m_CurrentPipelineState->PS.CBCounts[i + StartSlot]);
+      RDCASSERT_STATE(pNumConstants[i] == m_CurrentPipelineState->PS.CBCounts[i + StartSlot]);
   }
 }
 
@@ -1696,14 +1701,15 @@ void WrappedID3D11DeviceContext::CSGetConstantBuffers1(UINT StartSlot, UINT NumB
       ppConstantBuffers[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppConstantBuffers[i]);
 
-      RDCASSERT(ppConstantBuffers[i] == m_CurrentPipelineState->CS.ConstantBuffers[i + StartSlot]);
+      RDCASSERT_STATE(ppConstantBuffers[i] ==
+                      m_CurrentPipelineState->CS.ConstantBuffers[i + StartSlot]);
     }
 
     if(pFirstConstant)
-      RDCASSERT(pFirstConstant[i] == m_CurrentPipelineState->CS.CBOffsets[i + StartSlot]);
+      RDCASSERT_STATE(pFirstConstant[i] == m_CurrentPipelineState->CS.CBOffsets[i + StartSlot]);
 
     if(pNumConstants)
-      RDCASSERT(pNumConstants[i] == m_CurrentPipelineState->CS.CBCounts[i + StartSlot]);
+      RDCASSERT_STATE(pNumConstants[i] == m_CurrentPipelineState->CS.CBCounts[i + StartSlot]);
   }
 }
 
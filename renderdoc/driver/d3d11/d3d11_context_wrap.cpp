@@ -286,7 +286,7 @@ void WrappedID3D11DeviceContext::IAGetInputLayout(ID3D11InputLayout **ppInputLay
     *ppInputLayout = (ID3D11InputLayout *)m_pDevice->GetResourceManager()->GetWrapper(real);
     SAFE_ADDREF(*ppInputLayout);
 
-    RDCASSERT(*ppInputLayout == m_CurrentPipelineState->IA.Layout);
+    RDCASSERT_STATE(*ppInputLayout == m_CurrentPipelineState->IA.Layout);
   }
 }
 
@@ -307,7 +307,7 @@ void WrappedID3D11DeviceContext::IAGetVertexBuffers(UINT StartSlot, UINT NumBuff
       ppVertexBuffers[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppVertexBuffers[i]);
 
-      RDCASSERT(ppVertexBuffers[i] == m_CurrentPipelineState->IA.VBs[i + StartSlot]);
+      RDCASSERT_STATE(ppVertexBuffers[i] == m_CurrentPipelineState->IA.VBs[i + StartSlot]);
     }
 
     // D3D11 really inconsistently tracks these.
@@ -330,12 +330,12 @@ void WrappedID3D11DeviceContext::IAGetIndexBuffer(ID3D11Buffer **pIndexBuffer, D
     *pIndexBuffer = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real);
     SAFE_ADDREF(*pIndexBuffer);
 
-    RDCASSERT(*pIndexBuffer == m_CurrentPipelineState->IA.IndexBuffer);
+    RDCASSERT_STATE(*pIndexBuffer == m_CurrentPipelineState->IA.IndexBuffer);
 
     if(Format)
-      RDCASSERT(*Format == m_CurrentPipelineState->IA.IndexFormat);
+      RDCASSERT_STATE(*Format == m_CurrentPipelineState->IA.IndexFormat);
     if(Offset)
-      RDCASSERT(*Offset == m_CurrentPipelineState->IA.IndexOffset);
+      RDCASSERT_STATE(*Offset == m_CurrentPipelineState->IA.IndexOffset);
   }
 }
 
@@ -345,7 +345,7 @@ void WrappedID3D11DeviceContext::IAGetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY
 
   m_pRealContext->IAGetPrimitiveTopology(pTopology);
   if(pTopology)
-    RDCASSERT(*pTopology == m_CurrentPipelineState->IA.Topo);
+    RDCASSERT_STATE(*pTopology == m_CurrentPipelineState->IA.Topo);
 }
 
 template <typename SerialiserType>
@@ -593,7 +593,8 @@ void WrappedID3D11DeviceContext::VSGetConstantBuffers(UINT StartSlot, UINT NumBu
       ppConstantBuffers[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppConstantBuffers[i]);
 
-      RDCASSERT(ppConstantBuffers[i] == m_CurrentPipelineState->VS.ConstantBuffers[i + StartSlot]);
+      RDCASSERT_STATE(ppConstantBuffers[i] ==
+                      m_CurrentPipelineState->VS.ConstantBuffers[i + StartSlot]);
     }
   }
 }
@@ -615,7 +616,7 @@ void WrappedID3D11DeviceContext::VSGetShaderResources(UINT StartSlot, UINT NumVi
           (ID3D11ShaderResourceView *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppShaderResourceViews[i]);
 
-      RDCASSERT(ppShaderResourceViews[i] == m_CurrentPipelineState->VS.SRVs[i + StartSlot]);
+      RDCASSERT_STATE(ppShaderResourceViews[i] == m_CurrentPipelineState->VS.SRVs[i + StartSlot]);
     }
   }
 }
@@ -636,7 +637,7 @@ void WrappedID3D11DeviceContext::VSGetSamplers(UINT StartSlot, UINT NumSamplers,
       ppSamplers[i] = (ID3D11SamplerState *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppSamplers[i]);
 
-      RDCASSERT(ppSamplers[i] == m_CurrentPipelineState->VS.Samplers[i + StartSlot]);
+      RDCASSERT_STATE(ppSamplers[i] == m_CurrentPipelineState->VS.Samplers[i + StartSlot]);
     }
   }
 }
@@ -664,7 +665,7 @@ void WrappedID3D11DeviceContext::VSGetShader(ID3D11VertexShader **ppVertexShader
     *ppVertexShader = (ID3D11VertexShader *)m_pDevice->GetResourceManager()->GetWrapper(realShader);
     SAFE_ADDREF(*ppVertexShader);
 
-    RDCASSERT(*ppVertexShader == m_CurrentPipelineState->VS.Object);
+    RDCASSERT_STATE(*ppVertexShader == m_CurrentPipelineState->VS.Object);
   }
 
   if(ppClassInstances)
@@ -675,7 +676,7 @@ void WrappedID3D11DeviceContext::VSGetShader(ID3D11VertexShader **ppVertexShader
           (ID3D11ClassInstance *)m_pDevice->GetResourceManager()->GetWrapper(realInsts[i]);
       SAFE_ADDREF(ppClassInstances[i]);
 
-      RDCASSERT(ppClassInstances[i] == m_CurrentPipelineState->VS.Instances[i]);
+      RDCASSERT_STATE(ppClassInstances[i] == m_CurrentPipelineState->VS.Instances[i]);
     }
   }
 
@@ -988,7 +989,8 @@ void WrappedID3D11DeviceContext::HSGetConstantBuffers(UINT StartSlot, UINT NumBu
       ppConstantBuffers[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppConstantBuffers[i]);
 
-      RDCASSERT(ppConstantBuffers[i] == m_CurrentPipelineState->HS.ConstantBuffers[i + StartSlot]);
+      RDCASSERT_STATE(ppConstantBuffers[i] ==
+                      m_CurrentPipelineState->HS.ConstantBuffers[i + StartSlot]);
     }
   }
 }
@@ -1010,7 +1012,7 @@ void WrappedID3D11DeviceContext::HSGetShaderResources(UINT StartSlot, UINT NumVi
           (ID3D11ShaderResourceView *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppShaderResourceViews[i]);
 
-      RDCASSERT(ppShaderResourceViews[i] == m_CurrentPipelineState->HS.SRVs[i + StartSlot]);
+      RDCASSERT_STATE(ppShaderResourceViews[i] == m_CurrentPipelineState->HS.SRVs[i + StartSlot]);
     }
   }
 }
@@ -1031,7 +1033,7 @@ void WrappedID3D11DeviceContext::HSGetSamplers(UINT StartSlot, UINT NumSamplers,
       ppSamplers[i] = (ID3D11SamplerState *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppSamplers[i]);
 
-      RDCASSERT(ppSamplers[i] == m_CurrentPipelineState->HS.Samplers[i + StartSlot]);
+      RDCASSERT_STATE(ppSamplers[i] == m_CurrentPipelineState->HS.Samplers[i + StartSlot]);
     }
   }
 }
@@ -1059,7 +1061,7 @@ void WrappedID3D11DeviceContext::HSGetShader(ID3D11HullShader **ppHullShader,
     *ppHullShader = (ID3D11HullShader *)m_pDevice->GetResourceManager()->GetWrapper(realShader);
     SAFE_ADDREF(*ppHullShader);
 
-    RDCASSERT(*ppHullShader == m_CurrentPipelineState->HS.Object);
+    RDCASSERT_STATE(*ppHullShader == m_CurrentPipelineState->HS.Object);
   }
 
   if(ppClassInstances)
@@ -1070,7 +1072,7 @@ void WrappedID3D11DeviceContext::HSGetShader(ID3D11HullShader **ppHullShader,
           (ID3D11ClassInstance *)m_pDevice->GetResourceManager()->GetWrapper(realInsts[i]);
       SAFE_ADDREF(ppClassInstances[i]);
 
-      RDCASSERT(ppClassInstances[i] == m_CurrentPipelineState->HS.Instances[i]);
+      RDCASSERT_STATE(ppClassInstances[i] == m_CurrentPipelineState->HS.Instances[i]);
     }
   }
 
@@ -1382,7 +1384,8 @@ void WrappedID3D11DeviceContext::DSGetConstantBuffers(UINT StartSlot, UINT NumBu
       ppConstantBuffers[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppConstantBuffers[i]);
 
-      RDCASSERT(ppConstantBuffers[i] == m_CurrentPipelineState->DS.ConstantBuffers[i + StartSlot]);
+      RDCASSERT_STATE(ppConstantBuffers[i] ==
+                      m_CurrentPipelineState->DS.ConstantBuffers[i + StartSlot]);
     }
   }
 }
@@ -1404,7 +1407,7 @@ void WrappedID3D11DeviceContext::DSGetShaderResources(UINT StartSlot, UINT NumVi
           (ID3D11ShaderResourceView *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppShaderResourceViews[i]);
 
-      RDCASSERT(ppShaderResourceViews[i] == m_CurrentPipelineState->DS.SRVs[i + StartSlot]);
+      RDCASSERT_STATE(ppShaderResourceViews[i] == m_CurrentPipelineState->DS.SRVs[i + StartSlot]);
     }
   }
 }
@@ -1425,7 +1428,7 @@ void WrappedID3D11DeviceContext::DSGetSamplers(UINT StartSlot, UINT NumSamplers,
       ppSamplers[i] = (ID3D11SamplerState *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppSamplers[i]);
 
-      RDCASSERT(ppSamplers[i] == m_CurrentPipelineState->DS.Samplers[i + StartSlot]);
+      RDCASSERT_STATE(ppSamplers[i] == m_CurrentPipelineState->DS.Samplers[i + StartSlot]);
     }
   }
 }
@@ -1453,7 +1456,7 @@ void WrappedID3D11DeviceContext::DSGetShader(ID3D11DomainShader **ppDomainShader
     *ppDomainShader = (ID3D11DomainShader *)m_pDevice->GetResourceManager()->GetWrapper(realShader);
     SAFE_ADDREF(*ppDomainShader);
 
-    RDCASSERT(*ppDomainShader == m_CurrentPipelineState->DS.Object);
+    RDCASSERT_STATE(*ppDomainShader == m_CurrentPipelineState->DS.Object);
   }
 
   if(ppClassInstances)
@@ -1464,7 +1467,7 @@ void WrappedID3D11DeviceContext::DSGetShader(ID3D11DomainShader **ppDomainShader
           (ID3D11ClassInstance *)m_pDevice->GetResourceManager()->GetWrapper(realInsts[i]);
       SAFE_ADDREF(ppClassInstances[i]);
 
-      RDCASSERT(ppClassInstances[i] == m_CurrentPipelineState->DS.Instances[i]);
+      RDCASSERT_STATE(ppClassInstances[i] == m_CurrentPipelineState->DS.Instances[i]);
     }
   }
 
@@ -1777,7 +1780,8 @@ void WrappedID3D11DeviceContext::GSGetConstantBuffers(UINT StartSlot, UINT NumBu
       ppConstantBuffers[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppConstantBuffers[i]);
 
-      RDCASSERT(ppConstantBuffers[i] == m_CurrentPipelineState->GS.ConstantBuffers[i + StartSlot]);
+      RDCASSERT_STATE(ppConstantBuffers[i] ==
+                      m_CurrentPipelineState->GS.ConstantBuffers[i + StartSlot]);
     }
   }
 }
@@ -1799,7 +1803,7 @@ void WrappedID3D11DeviceContext::GSGetShaderResources(UINT StartSlot, UINT NumVi
           (ID3D11ShaderResourceView *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppShaderResourceViews[i]);
 
-      RDCASSERT(ppShaderResourceViews[i] == m_CurrentPipelineState->GS.SRVs[i + StartSlot]);
+      RDCASSERT_STATE(ppShaderResourceViews[i] == m_CurrentPipelineState->GS.SRVs[i + StartSlot]);
     }
   }
 }
@@ -1820,7 +1824,7 @@ void WrappedID3D11DeviceContext::GSGetSamplers(UINT StartSlot, UINT NumSamplers,
       ppSamplers[i] = (ID3D11SamplerState *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppSamplers[i]);
 
-      RDCASSERT(ppSamplers[i] == m_CurrentPipelineState->GS.Samplers[i + StartSlot]);
+      RDCASSERT_STATE(ppSamplers[i] == m_CurrentPipelineState->GS.Samplers[i + StartSlot]);
     }
   }
 }
@@ -1849,7 +1853,7 @@ void WrappedID3D11DeviceContext::GSGetShader(ID3D11GeometryShader **ppGeometrySh
         (ID3D11GeometryShader *)m_pDevice->GetResourceManager()->GetWrapper(realShader);
     SAFE_ADDREF(*ppGeometryShader);
 
-    RDCASSERT(*ppGeometryShader == m_CurrentPipelineState->GS.Object);
+    RDCASSERT_STATE(*ppGeometryShader == m_CurrentPipelineState->GS.Object);
   }
 
   if(ppClassInstances)
@@ -1860,7 +1864,7 @@ void WrappedID3D11DeviceContext::GSGetShader(ID3D11GeometryShader **ppGeometrySh
           (ID3D11ClassInstance *)m_pDevice->GetResourceManager()->GetWrapper(realInsts[i]);
       SAFE_ADDREF(ppClassInstances[i]);
 
-      RDCASSERT(ppClassInstances[i] == m_CurrentPipelineState->GS.Instances[i]);
+      RDCASSERT_STATE(ppClassInstances[i] == m_CurrentPipelineState->GS.Instances[i]);
     }
   }
 
@@ -2172,7 +2176,7 @@ void WrappedID3D11DeviceContext::SOGetTargets(UINT NumBuffers, ID3D11Buffer **pp
       ppSOTargets[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppSOTargets[i]);
 
-      RDCASSERT(ppSOTargets[i] == m_CurrentPipelineState->SO.Buffers[i]);
+      RDCASSERT_STATE(ppSOTargets[i] == m_CurrentPipelineState->SO.Buffers[i]);
     }
   }
 }
@@ -2371,11 +2375,18 @@ void WrappedID3D11DeviceContext::SOSetTargets(UINT NumBuffers, ID3D11Buffer *con
     }
   }
 
+  // the stream-out targets drive the hidden counter queries above, so they're always tracked even
+  // when the rest of the state isn't
+  bool tracking = m_CurrentPipelineState->IsTracking();
+  m_CurrentPipelineState->SetTracking(true);
+
   m_CurrentPipelineState->ChangeRefWrite(m_CurrentPipelineState->SO.Buffers, setbufs, 0,
                                          D3D11_SO_STREAM_COUNT);
   m_CurrentPipelineState->Change(m_CurrentPipelineState->SO.Offsets, setoffs, 0,
                                  D3D11_SO_STREAM_COUNT);
 
+  m_CurrentPipelineState->SetTracking(tracking);
+
   VerifyState();
 }
 
@@ -2390,8 +2401,8 @@ void WrappedID3D11DeviceContext::RSGetViewports(UINT *pNumViewports, D3D11_VIEWP
   m_pRealContext->RSGetViewports(pNumViewports, pViewports);
 
   if(pViewports)
-    RDCASSERT(memcmp(pViewports, m_CurrentPipelineState->RS.Viewports,
-                     sizeof(D3D11_VIEWPORT) * (*pNumViewports)) == 0);
+    RDCASSERT_STATE(memcmp(pViewports, m_CurrentPipelineState->RS.Viewports,
+                           sizeof(D3D11_VIEWPORT) * (*pNumViewports)) == 0);
 }
 
 void WrappedID3D11DeviceContext::RSGetScissorRects(UINT *pNumRects, D3D11_RECT *pRects)
@@ -2401,8 +2412,8 @@ void WrappedID3D11DeviceContext::RSGetScissorRects(UINT *pNumRects, D3D11_RECT *
   m_pRealContext->RSGetScissorRects(pNumRects, pRects);
 
   if(pRects)
-    RDCASSERT(memcmp(pRects, m_CurrentPipelineState->RS.Scissors,
-                     sizeof(D3D11_RECT) * (*pNumRects)) == 0);
+    RDCASSERT_STATE(memcmp(pRects, m_CurrentPipelineState->RS.Scissors,
+                           sizeof(D3D11_RECT) * (*pNumRects)) == 0);
 }
 
 void WrappedID3D11DeviceContext::RSGetState(ID3D11RasterizerState **ppRasterizerState)
@@ -2426,7 +2437,7 @@ void WrappedID3D11DeviceContext::RSGetState(ID3D11RasterizerState **ppRasterizer
       *ppRasterizerState = NULL;
     }
 
-    RDCASSERT(*ppRasterizerState == m_CurrentPipelineState->RS.State);
+    RDCASSERT_STATE(*ppRasterizerState == m_CurrentPipelineState->RS.State);
   }
 }
 
@@ -2595,7 +2606,8 @@ void WrappedID3D11DeviceContext::PSGetConstantBuffers(UINT StartSlot, UINT NumBu
       ppConstantBuffers[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppConstantBuffers[i]);
 
-      RDCASSERT(ppConstantBuffers[i] == m_CurrentPipelineState->PS.ConstantBuffers[i + StartSlot]);
+      RDCASSERT_STATE(ppConstantBuffers[i] ==
+                      m_CurrentPipelineState->PS.ConstantBuffers[i + StartSlot]);
     }
   }
 }
@@ -2617,7 +2629,7 @@ void WrappedID3D11DeviceContext::PSGetShaderResources(UINT StartSlot, UINT NumVi
           (ID3D11ShaderResourceView *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppShaderResourceViews[i]);
 
-      RDCASSERT(ppShaderResourceViews[i] == m_CurrentPipelineState->PS.SRVs[i + StartSlot]);
+      RDCASSERT_STATE(ppShaderResourceViews[i] == m_CurrentPipelineState->PS.SRVs[i + StartSlot]);
     }
   }
 }
@@ -2638,7 +2650,7 @@ void WrappedID3D11DeviceContext::PSGetSamplers(UINT StartSlot, UINT NumSamplers,
       ppSamplers[i] = (ID3D11SamplerState *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppSamplers[i]);
 
-      RDCASSERT(ppSamplers[i] == m_CurrentPipelineState->PS.Samplers[i + StartSlot]);
+      RDCASSERT_STATE(ppSamplers[i] == m_CurrentPipelineState->PS.Samplers[i + StartSlot]);
     }
   }
 }
@@ -2666,7 +2678,7 @@ void WrappedID3D11DeviceContext::PSGetShader(ID3D11PixelShader **ppPixelShader,
     *ppPixelShader = (ID3D11PixelShader *)m_pDevice->GetResourceManager()->GetWrapper(realShader);
     SAFE_ADDREF(*ppPixelShader);
 
-    RDCASSERT(*ppPixelShader == m_CurrentPipelineState->PS.Object);
+    RDCASSERT_STATE(*ppPixelShader == m_CurrentPipelineState->PS.Object);
   }
 
   if(ppClassInstances)
@@ -2677,7 +2689,7 @@ void WrappedID3D11DeviceContext::PSGetShader(ID3D11PixelShader **ppPixelShader,
           (ID3D11ClassInstance *)m_pDevice->GetResourceManager()->GetWrapper(realInsts[i]);
       SAFE_ADDREF(ppClassInstances[i]);
 
-      RDCASSERT(ppClassInstances[i] == m_CurrentPipelineState->PS.Instances[i]);
+      RDCASSERT_STATE(ppClassInstances[i] == m_CurrentPipelineState->PS.Instances[i]);
     }
   }
 
@@ -3000,7 +3012,7 @@ void WrappedID3D11DeviceContext::OMGetRenderTargets(UINT NumViews,
           (ID3D11RenderTargetView *)m_pDevice->GetResourceManager()->GetWrapper(rtv[i]);
       SAFE_ADDREF(ppRenderTargetViews[i]);
 
-      RDCASSERT(ppRenderTargetViews[i] == m_CurrentPipelineState->OM.RenderTargets[i]);
+      RDCASSERT_STATE(ppRenderTargetViews[i] == m_CurrentPipelineState->OM.RenderTargets[i]);
     }
   }
 
@@ -3009,7 +3021,7 @@ void WrappedID3D11DeviceContext::OMGetRenderTargets(UINT NumViews,
     *ppDepthStencilView = (ID3D11DepthStencilView *)m_pDevice->GetResourceManager()->GetWrapper(dsv);
     SAFE_ADDREF(*ppDepthStencilView);
 
-    RDCASSERT(*ppDepthStencilView == m_CurrentPipelineState->OM.DepthView);
+    RDCASSERT_STATE(*ppDepthStencilView == m_CurrentPipelineState->OM.DepthView);
   }
 }
 
@@ -3045,7 +3057,7 @@ void WrappedID3D11DeviceContext::OMGetRenderTargetsAndUnorderedAccessViews(
           (ID3D11RenderTargetView *)m_pDevice->GetResourceManager()->GetWrapper(rtv[i]);
       SAFE_ADDREF(ppRenderTargetViews[i]);
 
-      RDCASSERT(ppRenderTargetViews[i] == m_CurrentPipelineState->OM.RenderTargets[i]);
+      RDCASSERT_STATE(ppRenderTargetViews[i] == m_CurrentPipelineState->OM.RenderTargets[i]);
     }
   }
 
@@ -3054,7 +3066,7 @@ void WrappedID3D11DeviceContext::OMGetRenderTargetsAndUnorderedAccessViews(
     *ppDepthStencilView = (ID3D11DepthStencilView *)m_pDevice->GetResourceManager()->GetWrapper(dsv);
     SAFE_ADDREF(*ppDepthStencilView);
 
-    RDCASSERT(*ppDepthStencilView == m_CurrentPipelineState->OM.DepthView);
+    RDCASSERT_STATE(*ppDepthStencilView == m_CurrentPipelineState->OM.DepthView);
   }
 
   if(ppUnorderedAccessViews)
@@ -3065,7 +3077,7 @@ void WrappedID3D11DeviceContext::OMGetRenderTargetsAndUnorderedAccessViews(
           (ID3D11UnorderedAccessView *)m_pDevice->GetResourceManager()->GetWrapper(uav[i]);
       SAFE_ADDREF(ppUnorderedAccessViews[i]);
 
-      RDCASSERT(ppUnorderedAccessViews[i] == m_CurrentPipelineState->OM.UAVs[i]);
+      RDCASSERT_STATE(ppUnorderedAccessViews[i] == m_CurrentPipelineState->OM.UAVs[i]);
     }
   }
 }
@@ -3093,12 +3105,13 @@ void WrappedID3D11DeviceContext::OMGetBlendState(ID3D11BlendState **ppBlendState
       *ppBlendState = NULL;
     }
 
-    RDCASSERT(*ppBlendState == m_CurrentPipelineState->OM.BlendState);
+    RDCASSERT_STATE(*ppBlendState == m_CurrentPipelineState->OM.BlendState);
   }
   if(BlendFactor)
-    RDCASSERT(memcmp(BlendFactor, m_CurrentPipelineState->OM.BlendFactor, sizeof(float) * 4) == 0);
+    RDCASSERT_STATE(
+        memcmp(BlendFactor, m_CurrentPipelineState->OM.BlendFactor, sizeof(float) * 4) == 0);
   if(pSampleMask)
-    RDCASSERT(*pSampleMask == m_CurrentPipelineState->OM.SampleMask);
+    RDCASSERT_STATE(*pSampleMask == m_CurrentPipelineState->OM.SampleMask);
 }
 
 void WrappedID3D11DeviceContext::OMGetDepthStencilState(ID3D11DepthStencilState **ppDepthStencilState,
@@ -3124,10 +3137,10 @@ void WrappedID3D11DeviceContext::OMGetDepthStencilState(ID3D11DepthStencilState
       *ppDepthStencilState = NULL;
     }
 
-    RDCASSERT(*ppDepthStencilState == m_CurrentPipelineState->OM.DepthStencilState);
+    RDCASSERT_STATE(*ppDepthStencilState == m_CurrentPipelineState->OM.DepthStencilState);
   }
   if(pStencilRef)
-    RDCASSERT(*pStencilRef == m_CurrentPipelineState->OM.StencRef);
+    RDCASSERT_STATE(*pStencilRef == m_CurrentPipelineState->OM.StencRef);
 }
 
 template <typename SerialiserType>
@@ -4545,7 +4558,8 @@ void WrappedID3D11DeviceContext::CSGetConstantBuffers(UINT StartSlot, UINT NumBu
       ppConstantBuffers[i] = (ID3D11Buffer *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppConstantBuffers[i]);
 
-      RDCASSERT(ppConstantBuffers[i] == m_CurrentPipelineState->CS.ConstantBuffers[i + StartSlot]);
+      RDCASSERT_STATE(ppConstantBuffers[i] ==
+                      m_CurrentPipelineState->CS.ConstantBuffers[i + StartSlot]);
     }
   }
 }
@@ -4567,7 +4581,7 @@ void WrappedID3D11DeviceContext::CSGetShaderResources(UINT StartSlot, UINT NumVi
           (ID3D11ShaderResourceView *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppShaderResourceViews[i]);
 
-      RDCASSERT(ppShaderResourceViews[i] == m_CurrentPipelineState->CS.SRVs[i + StartSlot]);
+      RDCASSERT_STATE(ppShaderResourceViews[i] == m_CurrentPipelineState->CS.SRVs[i + StartSlot]);
     }
   }
 }
@@ -4589,7 +4603,7 @@ void WrappedID3D11DeviceContext::CSGetUnorderedAccessViews(
           (ID3D11UnorderedAccessView *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppUnorderedAccessViews[i]);
 
-      RDCASSERT(ppUnorderedAccessViews[i] == m_CurrentPipelineState->CSUAVs[i + StartSlot]);
+      RDCASSERT_STATE(ppUnorderedAccessViews[i] == m_CurrentPipelineState->CSUAVs[i + StartSlot]);
     }
   }
 }
@@ -4610,7 +4624,7 @@ void WrappedID3D11DeviceContext::CSGetSamplers(UINT StartSlot, UINT NumSamplers,
       ppSamplers[i] = (ID3D11SamplerState *)m_pDevice->GetResourceManager()->GetWrapper(real[i]);
       SAFE_ADDREF(ppSamplers[i]);
 
-      RDCASSERT(ppSamplers[i] == m_CurrentPipelineState->CS.Samplers[i + StartSlot]);
+      RDCASSERT_STATE(ppSamplers[i] == m_CurrentPipelineState->CS.Samplers[i + StartSlot]);
     }
   }
 }
@@ -4638,7 +4652,7 @@ void WrappedID3D11DeviceContext::CSGetShader(ID3D11ComputeShader **ppComputeShad
     *ppComputeShader = (ID3D11ComputeShader *)m_pDevice->GetResourceManager()->GetWrapper(realShader);
     SAFE_ADDREF(*ppComputeShader);
 
-    RDCASSERT(*ppComputeShader == m_CurrentPipelineState->CS.Object);
+    RDCASSERT_STATE(*ppComputeShader == m_CurrentPipelineState->CS.Object);
   }
 
   if(ppClassInstances)
@@ -4649,7 +4663,7 @@ void WrappedID3D11DeviceContext::CSGetShader(ID3D11ComputeShader **ppComputeShad
           (ID3D11ClassInstance *)m_pDevice->GetResourceManager()->GetWrapper(realInsts[i]);
       SAFE_ADDREF(ppClassInstances[i]);
 
-      RDCASSERT(ppClassInstances[i] == m_CurrentPipelineState->CS.Instances[i]);
+      RDCASSERT_STATE(ppClassInstances[i] == m_CurrentPipelineState->CS.Instances[i]);
     }
   }
 
@@ -5328,6 +5342,9 @@ void WrappedID3D11DeviceContext::ExecuteCommandList(ID3D11CommandList *pCommandL
 
   if(IsActiveCapturing(m_State))
   {
+    // maps in the command list update buffers behind our shadow copies
+    m_DiscardMapBaselines.clear();
+
     {
       USE_SCRATCH_SERIALISER();
       GET_SERIALISER.SetActionChunk();
@@ -5555,7 +5572,13 @@ HRESULT WrappedID3D11DeviceContext::FinishCommandList(BOOL RestoreDeferredContex
       // if we're supposed to restore, save the state to restore to now. This is because the next
       // recording to this deferred context is expected to have the same state, but we don't have
       // that state serialised right now. So we blat out the whole serialisation
-      if(RestoreDeferredContextState)
+      // If the state wasn't tracked for this command list we don't know it, so the next command
+      // list can't be successful either.
+      if(RestoreDeferredContextState && !m_CurrentPipelineState->IsKnown())
+      {
+        m_SuccessfulCapture = false;
+      }
+      else if(RestoreDeferredContextState)
       {
         USE_SCRATCH_SERIALISER();
         SCOPED_SERIALISE_CHUNK(D3D11Chunk::PostFinishCommandListSet);
@@ -5598,6 +5621,11 @@ HRESULT WrappedID3D11DeviceContext::FinishCommandList(BOOL RestoreDeferredContex
     }
   }
 
+  if(RestoreDeferredContextState)
+    m_DeferredStateCarriesOver = true;
+
+  UpdateStateTracking();
+
   if(!RestoreDeferredContextState)
     m_CurrentPipelineState->Clear();
 
@@ -7854,10 +7882,29 @@ bool WrappedID3D11DeviceContext::Serialise_Unmap(SerialiserType &ser, ID3D11Reso
     // copy from the intercept buffer that the user wrote into, into D3D's real pointer
     intercept.CopyToD3D();
 
+    D3D11_RESOURCE_DIMENSION dim;
+    pResource->GetType(&dim);
+
+    // a discarded buffer is normally serialised in full, since replay has nothing else to go on.
+    // Dynamic buffers can only be written by Map(), so once a buffer has been discarded in full
+    // within the capture the shadow holds exactly what replay will have in the buffer. Later
+    // discards can then be diff'd like any other map, and replay copies just the changed range in
+    // without discarding. This only holds on the immediate context, where the order of maps is the
+    // order they are replayed in, and not when verifying since the shadow is filled with a pattern.
+    bool discardBaseline = false;
+    if(IsActiveCapturing(m_State) && intercept.MapType == D3D11_MAP_WRITE_DISCARD &&
+       GetType() == D3D11_DEVICE_CONTEXT_IMMEDIATE && dim == D3D11_RESOURCE_DIMENSION_BUFFER &&
+       !intercept.verifyWrite)
+    {
+      discardBaseline = m_DiscardMapBaselines.find(mapIdx) != m_DiscardMapBaselines.end();
+      m_DiscardMapBaselines.insert(mapIdx);
+    }
+
     // while actively capturing, on large buffers being updated, try to locate the range of data
     // being
     // updated and update the diffStart/diffEnd/len variables
-    if(IsActiveCapturing(m_State) && len > 512 && intercept.MapType != D3D11_MAP_WRITE_DISCARD)
+    if(IsActiveCapturing(m_State) && len > 512 &&
+       (intercept.MapType != D3D11_MAP_WRITE_DISCARD || discardBaseline))
     {
       size_t s = diffStart;
       size_t e = diffEnd;
@@ -7865,9 +7912,6 @@ bool WrappedID3D11DeviceContext::Serialise_Unmap(SerialiserType &ser, ID3D11Reso
       diffStart = (uint32_t)s;
       diffEnd = (uint32_t)e;
 
-      D3D11_RESOURCE_DIMENSION dim;
-      pResource->GetType(&dim);
-
       // structured buffers must have copies aligned to their structure width, so we align down and
       // up the detected diff start/end region to match.
       if(dim == D3D11_RESOURCE_DIMENSION_BUFFER)
@@ -7963,11 +8007,27 @@ bool WrappedID3D11DeviceContext::Serialise_Unmap(SerialiserType &ser, ID3D11Reso
       m_ResourceUses[mapIdx.resource].push_back(EventUsage(m_CurEventID, ResourceUsage::CPUWrite));
     }
 
+    // a discard that only stored the changed range must not throw away the rest of the buffer
+    bool partialDiscard = false;
+    if(intercept.MapType == D3D11_MAP_WRITE_DISCARD && diffStart < diffEnd)
+    {
+      D3D11_RESOURCE_DIMENSION dim;
+      pResource->GetType(&dim);
+
+      if(dim == D3D11_RESOURCE_DIMENSION_BUFFER)
+      {
+        D3D11_BUFFER_DESC bufdesc = {};
+        ((WrappedID3D11Buffer *)pResource)->GetDesc(&bufdesc);
+
+        partialDiscard = diffStart > 0 || diffEnd < bufdesc.ByteWidth;
+      }
+    }
+
     if(diffStart >= diffEnd)
     {
       // do nothing
     }
-    else if(intercept.MapType == D3D11_MAP_WRITE_NO_OVERWRITE)
+    else if(intercept.MapType == D3D11_MAP_WRITE_NO_OVERWRITE || partialDiscard)
     {
       ID3D11Buffer *mapContents = NULL;
 
@@ -1320,9 +1320,12 @@ RDResult WrappedID3D11Device::ReadLogInitialisation(RDCFile *rdc, bool storeStru
     return result;
   }
 
+  rdc->ReadCallstackTable(m_CallstackTable);
+
   ReadSerialiser ser(reader, Ownership::Stream);
 
   ser.SetStringDatabase(&m_StringDB);
+  ser.SetCallstackTable(&m_CallstackTable);
   ser.SetUserData(GetResourceManager());
 
   ser.ConfigureStructuredExport(&GetChunkName, storeStructuredBuffers, m_TimeBase, m_TimeFrequency);
@@ -2177,6 +2180,8 @@ bool WrappedID3D11Device::EndFrameCapture(DeviceOwnedWindow devWnd)
 
     uint64_t captureSectionSize = 0;
 
+    ChunkStatistics chunkStats;
+
     {
       WriteSerialiser ser(captureWriter, Ownership::Stream);
 
@@ -2240,6 +2245,7 @@ bool WrappedID3D11Device::EndFrameCapture(DeviceOwnedWindow devWnd)
           RenderDoc::Inst().SetProgress(CaptureProgress::SerialiseFrameContents, idx / num);
           idx += 1.0f;
           it->second->Write(ser);
+          chunkStats.Add(it->second);
         }
 
         RDCDEBUG("Done");
@@ -2253,6 +2259,9 @@ bool WrappedID3D11Device::EndFrameCapture(DeviceOwnedWindow devWnd)
     RDCLOG("Captured D3D11 frame with %f MB capture section in %f seconds",
            double(captureSectionSize) / (1024.0 * 1024.0), m_CaptureTimer.GetMilliseconds() / 1000.0);
 
+    if(rdc)
+      chunkStats.Write(rdc, &GetChunkName);
+
     RenderDoc::Inst().FinishCaptureWriting(rdc, m_CapturedFrames.back().frameNumber);
 
     m_State = CaptureState::BackgroundCapturing;
@@ -566,6 +566,7 @@ private:
 
   WriteSerialiser m_ScratchSerialiser;
   std::set<rdcstr> m_StringDB;
+  CallstackTable m_CallstackTable;
 
   ResourceId m_ResourceID;
   D3D11ResourceRecord *m_DeviceRecord;
@@ -642,6 +643,7 @@ public:
   }
   const ReplayOptions &GetReplayOptions() { return m_ReplayOptions; }
   uint64_t GetLogVersion() { return m_SectionVersion; }
+  const CallstackTable *GetCallstackTable() { return &m_CallstackTable; }
   virtual ~WrappedID3D11Device();
 
   ////////////////////////////////////////////////////////////////
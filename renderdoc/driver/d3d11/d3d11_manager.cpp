@@ -43,14 +43,17 @@ void D3D11ResourceManager::SetInternalResource(ID3D11DeviceChild *res)
 
 void D3D11ResourceManager::FreeCaptureData()
 {
-  for(auto it = m_ResourceRecords.begin(); it != m_ResourceRecords.end(); ++it)
+  for(auto &shard : m_ResourceRecords.shards)
   {
-    D3D11ResourceRecord *record = it->second;
+    for(auto it = shard.map.begin(); it != shard.map.end(); ++it)
+    {
+      D3D11ResourceRecord *record = it->second;
 
-    if(record == NULL || m_Device->GetImmediateContext()->ShadowStorageInUse(record))
-      continue;
+      if(record == NULL || m_Device->GetImmediateContext()->ShadowStorageInUse(record))
+        continue;
 
-    record->FreeShadowStorage();
+      record->FreeShadowStorage();
+    }
   }
 }
 
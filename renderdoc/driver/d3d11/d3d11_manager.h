@@ -170,7 +170,8 @@ struct D3D11ResourceRecord : public ResourceRecord
       SubResources[i]->SetDataPtr(ptr);
   }
 
-  void Insert(std::map<int64_t, Chunk *> &recordlist)
+  template <typename ChunkList>
+  void Insert(ChunkList &recordlist)
   {
     bool dataWritten = DataWritten;
 
@@ -187,7 +188,7 @@ struct D3D11ResourceRecord : public ResourceRecord
     if(!dataWritten)
     {
       for(auto it = m_Chunks.begin(); it != m_Chunks.end(); ++it)
-        recordlist[it->id] = it->chunk;
+        AddRecordChunk(recordlist, it->id, it->chunk);
 
       for(int i = 0; i < NumSubResources; i++)
         SubResources[i]->Insert(recordlist);
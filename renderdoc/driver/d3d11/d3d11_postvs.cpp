@@ -110,17 +110,53 @@ void D3D11Replay::CreateSOBuffers()
   }
 }
 
+void D3D11Replay::ReleasePostVSData(D3D11PostVSData &data)
+{
+  SAFE_RELEASE(data.vsout.buf);
+  SAFE_RELEASE(data.vsout.idxBuf);
+  SAFE_RELEASE(data.gsout.buf);
+  SAFE_RELEASE(data.gsout.idxBuf);
+}
+
 void D3D11Replay::ClearPostVSCache()
 {
   for(auto it = m_PostVSData.begin(); it != m_PostVSData.end(); ++it)
+    ReleasePostVSData(it->second);
+
+  m_PostVSData.clear();
+  m_PostVSCache.Clear();
+}
+
+void D3D11Replay::TrimPostVSCache(const rdcarray<uint32_t> &keep)
+{
+  for(uint32_t eventId : m_PostVSCache.GetUnsizedEvents())
   {
-    SAFE_RELEASE(it->second.vsout.buf);
-    SAFE_RELEASE(it->second.vsout.idxBuf);
-    SAFE_RELEASE(it->second.gsout.buf);
-    SAFE_RELEASE(it->second.gsout.idxBuf);
+    const D3D11PostVSData &data = m_PostVSData[eventId];
+
+    uint64_t size = 0;
+    for(ID3D11Buffer *buf : {data.vsout.buf, data.vsout.idxBuf, data.gsout.buf, data.gsout.idxBuf})
+    {
+      if(!buf)
+        continue;
+
+      D3D11_BUFFER_DESC desc;
+      buf->GetDesc(&desc);
+      size += desc.ByteWidth;
+    }
+
+    m_PostVSCache.SetSize(eventId, size);
   }
 
-  m_PostVSData.clear();
+  for(uint32_t eventId : m_PostVSCache.Trim(keep))
+  {
+    ReleasePostVSData(m_PostVSData[eventId]);
+    m_PostVSData.erase(eventId);
+  }
+}
+
+PostVSCacheStatistics D3D11Replay::GetPostVSCacheStatistics()
+{
+  return m_PostVSCache.GetStatistics();
 }
 
 MeshFormat D3D11Replay::GetPostVSBuffers(uint32_t eventId, uint32_t instID, uint32_t viewID,
@@ -195,11 +231,22 @@ MeshFormat D3D11Replay::GetPostVSBuffers(uint32_t eventId, uint32_t instID, uint
 }
 
 void D3D11Replay::InitPostVSBuffers(uint32_t eventId)
+{
+  TrimPostVSCache({eventId});
+
+  FetchPostVSData(eventId);
+}
+
+void D3D11Replay::FetchPostVSData(uint32_t eventId)
 {
   if(m_PostVSData.find(eventId) != m_PostVSData.end())
+  {
+    m_PostVSCache.Touch(eventId);
     return;
+  }
 
   D3D11PostVSData &ret = m_PostVSData[eventId];
+  m_PostVSCache.Add(eventId);
 
   // we handle out-of-memory errors while processing postvs, don't treat it as a fatal error
   ScopedOOMHandle11 oom(m_pDevice);
@@ -1127,10 +1174,12 @@ void D3D11Replay::InitPostVSBuffers(uint32_t eventId)
 
 void D3D11Replay::InitPostVSBuffers(const rdcarray<uint32_t> &passEvents)
 {
+  TrimPostVSCache(passEvents);
+
   uint32_t prev = 0;
 
   // since we can always replay between drawcalls, just loop through all the events
-  // doing partial replays and calling InitPostVSBuffers for each
+  // doing partial replays and fetching the data for each
   for(size_t i = 0; i < passEvents.size(); i++)
   {
     if(prev != passEvents[i])
@@ -1143,6 +1192,6 @@ void D3D11Replay::InitPostVSBuffers(const rdcarray<uint32_t> &passEvents)
     const ActionDescription *d = m_pDevice->GetAction(passEvents[i]);
 
     if(d)
-      InitPostVSBuffers(passEvents[i]);
+      FetchPostVSData(passEvents[i]);
   }
 }
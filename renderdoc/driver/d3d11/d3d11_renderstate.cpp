@@ -43,6 +43,7 @@ D3D11RenderState::D3D11RenderState(D3D11RenderState::EmptyInit)
   RDCEraseEl(CSUAVs);
   Predicate = NULL;
   PredicateValue = FALSE;
+  m_Tracking = m_Known = true;
   Clear();
 
   m_ImmediatePipeline = false;
@@ -66,6 +67,7 @@ D3D11RenderState::D3D11RenderState(const D3D11RenderState &other)
   PredicateValue = FALSE;
 
   m_ImmediatePipeline = false;
+  m_Tracking = m_Known = true;
   m_pDevice = NULL;
 
   CopyState(other);
@@ -331,6 +333,7 @@ void D3D11RenderState::AddRefs()
 D3D11RenderState::D3D11RenderState(WrappedID3D11DeviceContext *context)
 {
   RDCEraseMem(this, sizeof(D3D11RenderState));
+  m_Tracking = m_Known = true;
 
   CopyState(*context->GetCurrentPipelineState());
 }
@@ -347,6 +350,8 @@ void D3D11RenderState::Clear()
   for(size_t i = 0; i < ARRAY_COUNT(VS.CBCounts); i++)
     VS.CBCounts[i] = HS.CBCounts[i] = DS.CBCounts[i] = GS.CBCounts[i] = PS.CBCounts[i] =
         CS.CBCounts[i] = 4096;
+
+  m_Known = m_Tracking;
 }
 
 bool D3D11RenderState::PredicationWouldPass()
@@ -656,6 +661,10 @@ bool D3D11RenderState::ValidOutputMerger(ID3D11RenderTargetView *const RTs[], UI
                                          ID3D11DepthStencilView *depth,
                                          ID3D11UnorderedAccessView *const uavs[], UINT NumUAVs)
 {
+  // nothing will be bound in the tracked state anyway, so skip the validation
+  if(!m_Tracking)
+    return true;
+
   D3D11_RENDER_TARGET_VIEW_DESC RTDescs[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT];
   D3D11_DEPTH_STENCIL_VIEW_DESC DepthDesc;
 
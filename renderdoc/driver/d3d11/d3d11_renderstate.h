@@ -54,6 +54,19 @@ struct D3D11RenderState
   void ApplyState(WrappedID3D11DeviceContext *context) const;
   void Clear();
 
+  // when tracking is disabled the Change*() functions below do nothing, which saves the hazard
+  // checks and refcounting on every state set. This is used for deferred contexts that aren't
+  // recording a capturable command list, since nothing will read their state. Once disabled the
+  // state is no longer known to match the real context until the next Clear() with tracking on.
+  void SetTracking(bool tracking)
+  {
+    if(!tracking)
+      m_Known = false;
+    m_Tracking = tracking;
+  }
+  bool IsTracking() const { return m_Tracking; }
+  bool IsKnown() const { return m_Known; }
+
   ///////////////////////////////////////////////////////////////////////////////
   // pipeline-auto NULL. When binding a resource for write, it will be
   // unbound anywhere that it is bound for read.
@@ -99,7 +112,7 @@ struct D3D11RenderState
   {
     // don't do anything for redundant changes. This prevents the object from bouncing off refcount
     // 0 during the changeover if it's only bound once, has no external refcount.
-    if(stateItem == newItem)
+    if(!m_Tracking || stateItem == newItem)
       return;
 
     // release the old item, which may destroy it but we won't use it again as we know is not the
@@ -141,7 +154,7 @@ struct D3D11RenderState
   void ChangeRefWrite(T *&stateItem, T *newItem)
   {
     // don't do anything for redundant changes
-    if(stateItem == newItem)
+    if(!m_Tracking || stateItem == newItem)
       return;
 
     // release the old item, which may destroy it but we won't use it again as we know is not the
@@ -172,6 +185,9 @@ struct D3D11RenderState
   template <typename T>
   void Change(T *stateArray, const T *newArray, size_t offset, size_t num)
   {
+    if(!m_Tracking)
+      return;
+
     for(size_t i = 0; i < num; i++)
       stateArray[i + offset] = newArray[i];
   }
@@ -179,7 +195,8 @@ struct D3D11RenderState
   template <typename T>
   void Change(T &stateItem, const T &newItem)
   {
-    stateItem = newItem;
+    if(m_Tracking)
+      stateItem = newItem;
   }
 
   /////////////////////////////////////////////////////////////////////////
@@ -275,6 +292,8 @@ private:
   void ReleaseRefs();
 
   bool m_ImmediatePipeline;
+  bool m_Tracking;
+  bool m_Known;
   WrappedID3D11Device *m_pDevice;
 };
 
@@ -1805,6 +1805,14 @@ void D3D11Replay::PickPixel(ResourceId texture, uint32_t x, uint32_t y, const Su
   m_pImmediateContext->Unmap(m_PixelPick.StageTexture, 0);
 }
 
+bool D3D11Replay::PickPixelTile(ResourceId texture, uint32_t x, uint32_t y, uint32_t width,
+                                uint32_t height, const Subresource &sub, CompType typeCast,
+                                rdcarray<float> &pixels)
+{
+  // not implemented, pixels are picked individually
+  return false;
+}
+
 bool D3D11Replay::GetMinMax(ResourceId texid, const Subresource &sub, CompType typeCast,
                             float *minval, float *maxval)
 {
@@ -2617,6 +2625,18 @@ void D3D11Replay::GetTextureData(ResourceId tex, const Subresource &sub,
   SAFE_RELEASE(dummyTex);
 }
 
+void D3D11Replay::GetTextureDataBatch(const rdcarray<TextureReadback> &readbacks,
+                                      TextureReadbackCallback callback)
+{
+  // readbacks aren't pipelined here, fetch each one in turn
+  for(size_t i = 0; i < readbacks.size(); i++)
+  {
+    bytebuf data;
+    GetTextureData(readbacks[i].tex, readbacks[i].sub, readbacks[i].params, data);
+    callback(i, data);
+  }
+}
+
 rdcarray<ShaderSourcePrefix> D3D11Replay::GetCustomShaderSourcePrefixes()
 {
   return {
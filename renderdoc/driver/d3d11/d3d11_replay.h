@@ -174,6 +174,16 @@ public:
   }
   ShaderDebugging &GetShaderDebuggingData() { return m_ShaderDebug; }
   void SavePipelineState(uint32_t eventId);
+  rdcarray<VKPipe::BindingElement> GetVulkanDescriptors(bool compute, uint32_t set,
+                                                        uint32_t binding, uint32_t firstElement,
+                                                        uint32_t count)
+  {
+    return {};
+  }
+  rdcarray<uint32_t> GetVulkanUsedDescriptors(bool compute, uint32_t set, uint32_t binding)
+  {
+    return {};
+  }
   void FreeTargetResource(ResourceId id);
   void FreeCustomShader(ResourceId id);
 
@@ -205,11 +215,14 @@ public:
 
   void InitPostVSBuffers(uint32_t eventId);
   void InitPostVSBuffers(const rdcarray<uint32_t> &passEvents);
+  PostVSCacheStatistics GetPostVSCacheStatistics();
 
   ResourceId GetLiveID(ResourceId id);
 
   void PickPixel(ResourceId texture, uint32_t x, uint32_t y, const Subresource &sub,
                  CompType typeCast, float pixel[4]);
+  bool PickPixelTile(ResourceId texture, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                     const Subresource &sub, CompType typeCast, rdcarray<float> &pixels);
   bool GetMinMax(ResourceId texid, const Subresource &sub, CompType typeCast, float *minval,
                  float *maxval);
   bool GetHistogram(ResourceId texid, const Subresource &sub, CompType typeCast, float minval,
@@ -222,6 +235,8 @@ public:
   void GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, bytebuf &retData);
   void GetTextureData(ResourceId tex, const Subresource &sub, const GetTextureDataParams &params,
                       bytebuf &data);
+  void GetTextureDataBatch(const rdcarray<TextureReadback> &readbacks,
+                           TextureReadbackCallback callback);
 
   rdcarray<ShaderEncoding> GetCustomShaderEncodings()
   {
@@ -265,10 +280,16 @@ public:
 
   rdcarray<PixelModification> PixelHistory(rdcarray<EventUsage> events, ResourceId target, uint32_t x,
                                            uint32_t y, const Subresource &sub, CompType typeCast);
+  PixelRegionHistory PixelHistoryRegion(rdcarray<EventUsage> events, ResourceId target, uint32_t x,
+                                        uint32_t y, uint32_t width, uint32_t height,
+                                        const Subresource &sub, CompType typeCast);
   ShaderDebugTrace *DebugVertex(uint32_t eventId, uint32_t vertid, uint32_t instid, uint32_t idx,
                                 uint32_t view);
   ShaderDebugTrace *DebugPixel(uint32_t eventId, uint32_t x, uint32_t y, uint32_t sample,
                                uint32_t primitive);
+  rdcarray<ShaderDebugTrace *> DebugPixels(uint32_t eventId,
+                                           const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels,
+                                           uint32_t sample, uint32_t primitive);
   ShaderDebugTrace *DebugThread(uint32_t eventId, const rdcfixedarray<uint32_t, 3> &groupid,
                                 const rdcfixedarray<uint32_t, 3> &threadid);
   rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger);
@@ -300,6 +321,9 @@ private:
                    ShaderStage type, ResourceId &id, rdcstr &errors);
 
   void ClearPostVSCache();
+  void TrimPostVSCache(const rdcarray<uint32_t> &keep);
+  void ReleasePostVSData(D3D11PostVSData &data);
+  void FetchPostVSData(uint32_t eventId);
 
   void InitStreamOut();
   void CreateSOBuffers();
@@ -378,6 +402,7 @@ private:
 
   // event -> data
   std::map<uint32_t, D3D11PostVSData> m_PostVSData;
+  PostVSCacheTracker m_PostVSCache;
 
   HighlightCache m_HighlightCache;
 
@@ -2556,6 +2556,17 @@ void ExtractInputsPS(PSInput IN, float4 debug_pixelPos : SV_Position,
   return ret;
 }
 
+rdcarray<ShaderDebugTrace *> D3D11Replay::DebugPixels(
+    uint32_t eventId, const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels, uint32_t sample,
+    uint32_t primitive)
+{
+  // each pixel's inputs are gathered separately
+  rdcarray<ShaderDebugTrace *> ret;
+  for(const rdcpair<uint32_t, uint32_t> &p : pixels)
+    ret.push_back(DebugPixel(eventId, p.first, p.second, sample, primitive));
+  return ret;
+}
+
 ShaderDebugTrace *D3D11Replay::DebugThread(uint32_t eventId,
                                            const rdcfixedarray<uint32_t, 3> &groupid,
                                            const rdcfixedarray<uint32_t, 3> &threadid)
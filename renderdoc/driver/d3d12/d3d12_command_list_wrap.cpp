@@ -3605,6 +3605,8 @@ void WrappedID3D12GraphicsCommandList::PatchExecuteIndirect(BakedCmdListInfo &in
     baseChunk = m_Cmd->m_StructuredFile->chunks[actions[idx].action.events[0].chunkIndex];
   }
 
+  const byte *patchedArgs = mapPtr + exec.argOffs;
+
   for(uint32_t i = 0; i < count; i++)
   {
     byte *data = mapPtr + exec.argOffs;
@@ -3885,6 +3887,11 @@ void WrappedID3D12GraphicsCommandList::PatchExecuteIndirect(BakedCmdListInfo &in
     }
   }
 
+  // the arguments are fixed from here on, so keep a copy for partial replays to use. This is done
+  // once on load and avoids a GPU readback and sync every time we replay part-way into this
+  // execute
+  exec.argData.assign(patchedArgs, count * comSig->sig.ByteStride);
+
   exec.argBuf->Unmap(0, &range);
 
   // remove excesss actions if count < maxCount
@@ -3964,11 +3971,14 @@ void WrappedID3D12GraphicsCommandList::ReplayExecuteIndirect(ID3D12GraphicsComma
     return;
   }
 
-  bytebuf data;
-  m_pDevice->GetDebugManager()->GetBufferData(exec.argBuf, exec.argOffs,
-                                              count * comSig->sig.ByteStride, data);
+  bytebuf &data = exec.argData;
+
+  // should have been cached when patching, but fall back to reading back if not
+  if(data.size() < count * comSig->sig.ByteStride)
+    m_pDevice->GetDebugManager()->GetBufferData(exec.argBuf, exec.argOffs,
+                                                count * comSig->sig.ByteStride, data);
 
-  byte *dataPtr = &data[0];
+  byte *dataPtr = data.data();
 
   D3D12RenderState &state = m_Cmd->m_BakedCmdListInfo[m_Cmd->m_LastCmdListID].state;
 
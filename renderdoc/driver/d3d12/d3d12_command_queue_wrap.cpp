@@ -28,6 +28,7 @@
 #include "d3d12_resources.h"
 
 RDOC_EXTERN_CONFIG(bool, D3D12_Debug_SingleSubmitFlushing);
+RDOC_EXTERN_CONFIG(uint32_t, Capture_MapDiffMergeGap);
 
 template <typename SerialiserType>
 bool WrappedID3D12CommandQueue::Serialise_UpdateTileMappings(
@@ -914,9 +915,6 @@ void WrappedID3D12CommandQueue::ExecuteCommandListsInternal(UINT NumCommandLists
         // here AND serialise them there, but we'll play it safe.
         res->LockMaps();
 
-        size_t diffStart = 0, diffEnd = 0;
-        bool found = true;
-
         byte *ref = res->GetShadow(subres);
         byte *data = res->GetMap(subres);
 
@@ -968,17 +966,21 @@ void WrappedID3D12CommandQueue::ExecuteCommandListsInternal(UINT NumCommandLists
             }
           }
 
+          // compare against the previous data and only serialise the ranges that changed,
+          // otherwise serialise it all
+          rdcarray<rdcpair<size_t, size_t>> diffRanges;
           if(ref)
-            found = FindDiffRange(data, ref, size, diffStart, diffEnd);
-          else
-            diffEnd = size;
+            FindDiffRanges(data, ref, size, Capture_MapDiffMergeGap(), diffRanges);
+          else if(size > 0)
+            diffRanges.push_back({0, size});
 
-          if(found)
+          for(const rdcpair<size_t, size_t> &diff : diffRanges)
           {
             RDCLOG("Persistent map flush forced for %s (%llu -> %llu)",
-                   ToStr(res->GetResourceID()).c_str(), (uint64_t)diffStart, (uint64_t)diffEnd);
+                   ToStr(res->GetResourceID()).c_str(), (uint64_t)diff.first,
+                   (uint64_t)diff.second);
 
-            D3D12_RANGE range = {diffStart, diffEnd};
+            D3D12_RANGE range = {diff.first, diff.second};
 
             if(ref == NULL)
             {
@@ -990,7 +992,10 @@ void WrappedID3D12CommandQueue::ExecuteCommandListsInternal(UINT NumCommandLists
             // passing true here asks the serialisation function to update the shadow pointer for
             // this resource
             m_pDevice->MapDataWrite(res, subres, data, range, true);
+          }
 
+          if(!diffRanges.empty())
+          {
             GetResourceManager()->MarkDirtyResource(res->GetResourceID());
           }
           else
@@ -921,6 +921,7 @@ RDResult WrappedID3D12CommandQueue::ReplayLog(CaptureState readType, uint32_t st
   ReadSerialiser ser(m_FrameReader, Ownership::Nothing);
 
   ser.SetStringDatabase(&m_StringDB);
+  ser.SetCallstackTable(m_pDevice->GetCallstackTable());
   ser.SetUserData(GetResourceManager());
   ser.SetVersion(m_pDevice->GetCaptureVersion());
 
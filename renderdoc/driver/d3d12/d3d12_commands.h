@@ -190,6 +190,8 @@ struct BakedCmdListInfo
     WrappedID3D12CommandSignature *sig = NULL;
     UINT maxCount = 0;
     UINT realCount = 0;
+    // CPU copy of the patched arguments, so partial replays don't need to read them back
+    bytebuf argData;
   };
 
   rdcarray<ID3D12GraphicsCommandListX *> crackedLists;
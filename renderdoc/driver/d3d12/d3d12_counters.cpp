@@ -40,6 +40,7 @@ rdcarray<GPUCounter> D3D12Replay::EnumerateCounters()
   rdcarray<GPUCounter> ret;
 
   ret.push_back(GPUCounter::EventGPUDuration);
+  ret.push_back(GPUCounter::EventGPUDurationStdDev);
   ret.push_back(GPUCounter::InputVerticesRead);
   ret.push_back(GPUCounter::IAPrimitives);
   ret.push_back(GPUCounter::GSPrimitives);
@@ -106,6 +107,15 @@ CounterDescription D3D12Replay::DescribeCounter(GPUCounter counterID)
       desc.resultType = CompType::Float;
       desc.unit = CounterUnit::Seconds;
       break;
+    case GPUCounter::EventGPUDurationStdDev:
+      desc.name = "GPU Duration Std. Dev.";
+      desc.description =
+          "Standard deviation of the GPU duration of this event when it is timed over several "
+          "replays. 0 when only one replay is made.";
+      desc.resultByteWidth = 8;
+      desc.resultType = CompType::Float;
+      desc.unit = CounterUnit::Seconds;
+      break;
     case GPUCounter::InputVerticesRead:
       desc.name = "Input Vertices Read";
       desc.description = "Number of vertices read by input assembler.";
@@ -417,12 +427,13 @@ struct D3D12GPUTimerCallback : public D3D12ActionCallback
     if(cmd->GetType() == D3D12_COMMAND_LIST_TYPE_COPY)
       return;
 
-    if(cmd->GetType() == D3D12_COMMAND_LIST_TYPE_DIRECT)
+    if(cmd->GetType() == D3D12_COMMAND_LIST_TYPE_DIRECT && m_PipeStatsQueryHeap)
     {
       cmd->BeginQuery(m_OcclusionQueryHeap, D3D12_QUERY_TYPE_OCCLUSION, m_NumStatsQueries);
       cmd->BeginQuery(m_PipeStatsQueryHeap, D3D12_QUERY_TYPE_PIPELINE_STATISTICS, m_NumStatsQueries);
     }
-    cmd->EndQuery(m_TimerQueryHeap, D3D12_QUERY_TYPE_TIMESTAMP, m_NumTimestampQueries * 2 + 0);
+    cmd->EndQuery(m_TimerQueryHeap, D3D12_QUERY_TYPE_TIMESTAMP,
+                  (m_TimestampBase + m_NumTimestampQueries) * 2 + 0);
   }
 
   bool PostDraw(uint32_t eid, ID3D12GraphicsCommandListX *cmd) override
@@ -430,11 +441,12 @@ struct D3D12GPUTimerCallback : public D3D12ActionCallback
     if(cmd->GetType() == D3D12_COMMAND_LIST_TYPE_COPY)
       return false;
 
-    cmd->EndQuery(m_TimerQueryHeap, D3D12_QUERY_TYPE_TIMESTAMP, m_NumTimestampQueries * 2 + 1);
+    cmd->EndQuery(m_TimerQueryHeap, D3D12_QUERY_TYPE_TIMESTAMP,
+                  (m_TimestampBase + m_NumTimestampQueries) * 2 + 1);
     m_NumTimestampQueries++;
 
     bool direct = (cmd->GetType() == D3D12_COMMAND_LIST_TYPE_DIRECT);
-    if(direct)
+    if(direct && m_PipeStatsQueryHeap)
     {
       cmd->EndQuery(m_PipeStatsQueryHeap, D3D12_QUERY_TYPE_PIPELINE_STATISTICS, m_NumStatsQueries);
       cmd->EndQuery(m_OcclusionQueryHeap, D3D12_QUERY_TYPE_OCCLUSION, m_NumStatsQueries);
@@ -490,6 +502,8 @@ struct D3D12GPUTimerCallback : public D3D12ActionCallback
 
   uint32_t m_NumStatsQueries;
   uint32_t m_NumTimestampQueries;
+  // offset for the timestamps of repeated timing replays, in events
+  uint32_t m_TimestampBase = 0;
 
   // events which are the 'same' from being the same command buffer resubmitted
   // multiple times in the frame. We will only get the full callback when we're
@@ -546,6 +560,11 @@ rdcarray<CounterResult> D3D12Replay::FetchCounters(const rdcarray<GPUCounter> &c
     return ret;
   }
 
+  uint32_t timingRepeats = 1;
+  if(d3dCounters.contains(GPUCounter::EventGPUDuration) ||
+     d3dCounters.contains(GPUCounter::EventGPUDurationStdDev))
+    timingRepeats = GetGPUDurationRepeats();
+
   D3D12_HEAP_PROPERTIES heapProps;
   heapProps.Type = D3D12_HEAP_TYPE_READBACK;
   heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
@@ -556,7 +575,8 @@ rdcarray<CounterResult> D3D12Replay::FetchCounters(const rdcarray<GPUCounter> &c
   D3D12_RESOURCE_DESC bufDesc;
   bufDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
   bufDesc.Alignment = 0;
-  bufDesc.Width = (sizeof(uint64_t) * 3 + sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS)) * maxEID;
+  bufDesc.Width = (sizeof(uint64_t) * 3 + sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS)) * maxEID +
+                  sizeof(uint64_t) * 2 * maxEID * (timingRepeats - 1);
   bufDesc.Height = 1;
   bufDesc.DepthOrArraySize = 1;
   bufDesc.MipLevels = 1;
@@ -578,7 +598,7 @@ rdcarray<CounterResult> D3D12Replay::FetchCounters(const rdcarray<GPUCounter> &c
   }
 
   D3D12_QUERY_HEAP_DESC timerQueryDesc;
-  timerQueryDesc.Count = maxEID * 2;
+  timerQueryDesc.Count = maxEID * 2 * timingRepeats;
   timerQueryDesc.NodeMask = 1;
   timerQueryDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
   ID3D12QueryHeap *timerQueryHeap = NULL;
@@ -643,6 +663,32 @@ rdcarray<CounterResult> D3D12Replay::FetchCounters(const rdcarray<GPUCounter> &c
     m_pDevice->FlushLists(true);
   }
 
+  // time the events again with nothing but timestamps, while the clocks are still locked. Each
+  // replay writes its timestamps after the previous one's.
+  uint32_t timingRuns = 1;
+  for(uint32_t r = 1; r < timingRepeats && cb.m_NumTimestampQueries > 0; r++)
+  {
+    D3D12GPUTimerCallback timingCB(m_pDevice, this, timerQueryHeap, NULL, NULL);
+    timingCB.m_TimestampBase = cb.m_NumTimestampQueries * r;
+
+    m_pDevice->ReplayLog(0, maxEID, eReplay_Full);
+
+    if(D3D12_Debug_SingleSubmitFlushing())
+    {
+      m_pDevice->ExecuteLists();
+      m_pDevice->FlushLists(true);
+    }
+
+    if(timingCB.m_NumTimestampQueries != cb.m_NumTimestampQueries)
+    {
+      RDCERR("Timing replay saw %u events, expected %u", timingCB.m_NumTimestampQueries,
+             cb.m_NumTimestampQueries);
+      break;
+    }
+
+    timingRuns++;
+  }
+
   // Only supported with developer mode drivers!!!
   m_pDevice->SetStablePowerState(FALSE);
 
@@ -654,9 +700,9 @@ rdcarray<CounterResult> D3D12Replay::FetchCounters(const rdcarray<GPUCounter> &c
   UINT64 bufferOffset = 0;
 
   list->ResolveQueryData(timerQueryHeap, D3D12_QUERY_TYPE_TIMESTAMP, 0,
-                         cb.m_NumTimestampQueries * 2, readbackBuf, bufferOffset);
+                         cb.m_NumTimestampQueries * 2 * timingRuns, readbackBuf, bufferOffset);
 
-  bufferOffset += sizeof(uint64_t) * 2 * cb.m_NumTimestampQueries;
+  bufferOffset += sizeof(uint64_t) * 2 * cb.m_NumTimestampQueries * timingRuns;
 
   list->ResolveQueryData(pipestatsQueryHeap, D3D12_QUERY_TYPE_PIPELINE_STATISTICS, 0,
                          cb.m_NumStatsQueries, readbackBuf, bufferOffset);
@@ -690,7 +736,7 @@ rdcarray<CounterResult> D3D12Replay::FetchCounters(const rdcarray<GPUCounter> &c
   }
 
   uint64_t *timestamps = (uint64_t *)data;
-  data += cb.m_NumTimestampQueries * 2 * sizeof(uint64_t);
+  data += cb.m_NumTimestampQueries * 2 * timingRuns * sizeof(uint64_t);
   D3D12_QUERY_DATA_PIPELINE_STATISTICS *pipelinestats = (D3D12_QUERY_DATA_PIPELINE_STATISTICS *)data;
   data += cb.m_NumStatsQueries * sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS);
   uint64_t *occlusion = (uint64_t *)data;
@@ -705,6 +751,14 @@ rdcarray<CounterResult> D3D12Replay::FetchCounters(const rdcarray<GPUCounter> &c
     D3D12_QUERY_DATA_PIPELINE_STATISTICS pipeStats = {};
     uint64_t occl = 0;
 
+    rdcarray<double> durations;
+    for(uint32_t r = 0; r < timingRuns; r++)
+    {
+      const uint64_t *runTimestamps = timestamps + r * cb.m_NumTimestampQueries * 2;
+      uint64_t delta = runTimestamps[i * 2 + 1] - runTimestamps[i * 2 + 0];
+      durations.push_back(double(delta) / double(freq));
+    }
+
     // only events on direct lists recorded pipeline stats or occlusion queries
     if(direct)
     {
@@ -724,12 +778,10 @@ rdcarray<CounterResult> D3D12Replay::FetchCounters(const rdcarray<GPUCounter> &c
 
       switch(d3dCounters[c])
       {
-        case GPUCounter::EventGPUDuration:
-        {
-          uint64_t delta = timestamps[i * 2 + 1] - timestamps[i * 2 + 0];
-          result.value.d = double(delta) / double(freq);
-        }
-        break;
+        case GPUCounter::EventGPUDuration: result.value.d = CalcDurationMedian(durations); break;
+        case GPUCounter::EventGPUDurationStdDev:
+          result.value.d = CalcDurationStdDev(durations);
+          break;
         case GPUCounter::InputVerticesRead: result.value.u64 = pipeStats.IAVertices; break;
         case GPUCounter::IAPrimitives: result.value.u64 = pipeStats.IAPrimitives; break;
         case GPUCounter::GSPrimitives: result.value.u64 = pipeStats.GSPrimitives; break;
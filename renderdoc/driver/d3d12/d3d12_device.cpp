@@ -45,6 +45,18 @@ RDOC_DEBUG_CONFIG(bool, D3D12_Debug_SingleSubmitFlushing, false,
                   "Every command buffer is submitted and fully flushed to the GPU, to narrow down "
                   "the source of problems.");
 
+RDOC_DEBUG_CONFIG(bool, D3D12_Debug_DisableForwardReplay, false,
+                  "Always replay from the start of the frame when selecting a later event, instead "
+                  "of continuing on from the previously selected event where possible.");
+
+RDOC_DEBUG_CONFIG(bool, D3D12_Debug_AlwaysResetWrittenResources, false,
+                  "Reset every resource written in the frame when replaying from the start, even if "
+                  "the previous replays didn't reach any of its writes.");
+
+RDOC_CONFIG(bool, D3D12_PersistentPipelineCache, true,
+            "Store compiled pipelines in a per-capture pipeline library on disk, so that opening "
+            "the same capture again can skip recompiling them.");
+
 WRAPPED_POOL_INST(WrappedID3D12Device);
 
 Threading::CriticalSection WrappedID3D12Device::m_DeviceWrappersLock;
@@ -593,7 +605,6 @@ WrappedID3D12Device::WrappedID3D12Device(ID3D12Device *realDevice, D3D12InitPara
   m_WrappedDebug.m_pDevice = this;
 
   threadSerialiserTLSSlot = Threading::AllocateTLSSlot();
-  tempMemoryTLSSlot = Threading::AllocateTLSSlot();
 
   m_HeaderChunk = NULL;
 
@@ -830,6 +841,8 @@ WrappedID3D12Device::~WrappedID3D12Device()
 
   SAFE_DELETE(m_ResourceManager);
 
+  SaveReplayPipeLibrary();
+
   SAFE_RELEASE(m_DRED.m_pReal);
   SAFE_RELEASE(m_DRED.m_pReal1);
   SAFE_RELEASE(m_DREDSettings.m_pReal);
@@ -856,12 +869,6 @@ WrappedID3D12Device::~WrappedID3D12Device()
   for(size_t i = 0; i < m_ThreadSerialisers.size(); i++)
     delete m_ThreadSerialisers[i];
 
-  for(size_t i = 0; i < m_ThreadTempMem.size(); i++)
-  {
-    delete[] m_ThreadTempMem[i]->memory;
-    delete m_ThreadTempMem[i];
-  }
-
   SAFE_DELETE(m_ResourceList);
   SAFE_DELETE(m_PipelineList);
 
@@ -2645,6 +2652,8 @@ bool WrappedID3D12Device::EndFrameCapture(DeviceOwnedWindow devWnd)
 
   uint64_t captureSectionSize = 0;
 
+  ChunkStatistics chunkStats;
+
   {
     WriteSerialiser ser(captureWriter, Ownership::Stream);
 
@@ -2682,6 +2691,7 @@ bool WrappedID3D12Device::EndFrameCapture(DeviceOwnedWindow devWnd)
     }
 
     m_HeaderChunk->Write(ser);
+    chunkStats.Add(m_HeaderChunk);
 
     // don't need to lock access to m_CmdListRecords as we are no longer
     // in capframe (the transition is thread-protected) so nothing will be
@@ -2727,6 +2737,7 @@ bool WrappedID3D12Device::EndFrameCapture(DeviceOwnedWindow devWnd)
       RenderDoc::Inst().SetProgress(CaptureProgress::SerialiseFrameContents, idx / num);
       idx += 1.0f;
       it->second->Write(ser);
+      chunkStats.Add(it->second);
     }
 
     RDCDEBUG("Done");
@@ -2737,6 +2748,9 @@ bool WrappedID3D12Device::EndFrameCapture(DeviceOwnedWindow devWnd)
   RDCLOG("Captured D3D12 frame with %f MB capture section in %f seconds",
          double(captureSectionSize) / (1024.0 * 1024.0), m_CaptureTimer.GetMilliseconds() / 1000.0);
 
+  if(rdc)
+    chunkStats.Write(rdc, &GetChunkName);
+
   if(D3D12Core)
   {
     if(rdc)
@@ -3397,38 +3411,6 @@ FrameRefType WrappedID3D12Device::BindlessRefTypeForRes(ID3D12Resource *wrapped)
              : eFrameRef_Read;
 }
 
-byte *WrappedID3D12Device::GetTempMemory(size_t s)
-{
-  TempMem *mem = (TempMem *)Threading::GetTLSValue(tempMemoryTLSSlot);
-  if(mem && mem->size >= s)
-    return mem->memory;
-
-  // alloc or grow alloc
-  TempMem *newmem = mem;
-
-  if(!newmem)
-    newmem = new TempMem();
-
-  // free old memory, don't need to keep contents
-  if(newmem->memory)
-    delete[] newmem->memory;
-
-  // alloc new memory
-  newmem->size = s;
-  newmem->memory = new byte[s];
-
-  Threading::SetTLSValue(tempMemoryTLSSlot, (void *)newmem);
-
-  // if this is entirely new, save it for deletion on shutdown
-  if(!mem)
-  {
-    SCOPED_LOCK(m_ThreadTempMemLock);
-    m_ThreadTempMem.push_back(newmem);
-  }
-
-  return newmem->memory;
-}
-
 WriteSerialiser &WrappedID3D12Device::GetThreadSerialiser()
 {
   WriteSerialiser *ser = (WriteSerialiser *)Threading::GetTLSValue(threadSerialiserTLSSlot);
@@ -3801,6 +3783,8 @@ void WrappedID3D12Device::ExecuteList(ID3D12GraphicsCommandListX *list,
   ID3D12CommandList *l = list;
   queue->ExecuteCommandListsInternal(1, &l, InFrameCaptureBoundary, false);
 
+  m_InternalSubmitCount++;
+
   MarkListExecuted(list);
 }
 
@@ -3833,6 +3817,8 @@ void WrappedID3D12Device::ExecuteLists(WrappedID3D12CommandQueue *queue, bool In
     queue->ExecuteCommandListsInternal(cmdCount, &cmds[i], InFrameCaptureBoundary, false);
   }
 
+  m_InternalSubmitCount++;
+
   m_InternalCmds.submittedcmds.append(m_InternalCmds.pendingcmds);
   m_InternalCmds.pendingcmds.clear();
 }
@@ -4147,11 +4133,26 @@ RDResult WrappedID3D12Device::ReadLogInitialisation(RDCFile *rdc, bool storeStru
     return result;
   }
 
+  if(IsLoading(m_State))
+  {
+    const SectionProperties &props = rdc->GetSectionProperties(sectionIdx);
+    m_CaptureHash =
+        strhash(StringFormat::Fmt("%s_%llu_%llu_%llu", rdc->GetDriverName().c_str(),
+                                  rdc->GetTimestampBase(), props.uncompressedSize,
+                                  props.compressedSize)
+                    .c_str());
+
+    CreateReplayPipeLibrary();
+  }
+
+  rdc->ReadCallstackTable(m_CallstackTable);
+
   ReadSerialiser ser(reader, Ownership::Stream);
 
   APIProps.DXILShaders = m_UsedDXIL = m_InitParams.usedDXIL;
 
   ser.SetStringDatabase(&m_StringDB);
+  ser.SetCallstackTable(&m_CallstackTable);
   ser.SetUserData(GetResourceManager());
 
   ser.ConfigureStructuredExport(&GetChunkName, storeStructuredBuffers, m_TimeBase, m_TimeFrequency);
@@ -4329,11 +4330,16 @@ RDResult WrappedID3D12Device::ReadLogInitialisation(RDCFile *rdc, bool storeStru
   {
     D3D12CommandData &cmd = *m_Queue->GetCommandData();
 
+    m_FirstWriteEvent.clear();
+
     for(auto it = cmd.m_ResourceUses.begin(); it != cmd.m_ResourceUses.end(); ++it)
     {
+      // resources that can be written through UAVs aren't tracked precisely enough
       if(m_ModResources.find(it->first) != m_ModResources.end())
         continue;
 
+      uint32_t firstWrite = ~0U;
+
       for(const EventUsage &use : it->second)
       {
         if(use.usage == ResourceUsage::CopyDst || use.usage == ResourceUsage::Copy ||
@@ -4343,11 +4349,19 @@ RDResult WrappedID3D12Device::ReadLogInitialisation(RDCFile *rdc, bool storeStru
            use.usage == ResourceUsage::ColorTarget ||
            use.usage == ResourceUsage::DepthStencilTarget || use.usage == ResourceUsage::StreamOut)
         {
-          m_ModResources.insert(it->first);
-          break;
+          firstWrite = RDCMIN(firstWrite, use.eventId);
         }
       }
+
+      if(firstWrite != ~0U)
+      {
+        m_ModResources.insert(it->first);
+        m_FirstWriteEvent[it->first] = firstWrite;
+      }
     }
+
+    // the whole frame has been replayed while loading
+    m_ReplayedSinceReset = ~0U;
   }
 
 #if ENABLED(RDOC_DEVEL)
@@ -4385,9 +4399,233 @@ RDResult WrappedID3D12Device::ReadLogInitialisation(RDCFile *rdc, bool storeStru
   return ResultCode::Succeeded;
 }
 
+void WrappedID3D12Device::CreateReplayPipeLibrary()
+{
+  if(!D3D12_PersistentPipelineCache() || m_pDevice1 == NULL || m_ReplayPipeLibrary)
+    return;
+
+  m_ReplayPipeLibraryFilename =
+      FileIO::GetAppFolderFilename(StringFormat::Fmt("d3d12pipelines_%08x.cache", m_CaptureHash));
+
+  HRESULT hr = E_FAIL;
+
+  // the runtime validates the blob against the current adapter and driver, so a library saved
+  // on a different setup is simply discarded and rebuilt.
+  if(FileIO::ReadAll(m_ReplayPipeLibraryFilename, m_ReplayPipeLibraryBlob) &&
+     !m_ReplayPipeLibraryBlob.empty())
+  {
+    hr = m_pDevice1->CreatePipelineLibrary(m_ReplayPipeLibraryBlob.data(),
+                                           m_ReplayPipeLibraryBlob.size(),
+                                           __uuidof(ID3D12PipelineLibrary),
+                                           (void **)&m_ReplayPipeLibrary);
+
+    if(FAILED(hr))
+      RDCLOG("Discarding stale pipeline library %s: %s", m_ReplayPipeLibraryFilename.c_str(),
+             ToStr(hr).c_str());
+  }
+
+  if(FAILED(hr))
+  {
+    m_ReplayPipeLibraryBlob.clear();
+    m_ReplayPipeLibrary = NULL;
+
+    hr = m_pDevice1->CreatePipelineLibrary(NULL, 0, __uuidof(ID3D12PipelineLibrary),
+                                           (void **)&m_ReplayPipeLibrary);
+
+    if(FAILED(hr))
+    {
+      RDCWARN("Couldn't create pipeline library: %s", ToStr(hr).c_str());
+      m_ReplayPipeLibrary = NULL;
+      return;
+    }
+  }
+
+  m_ReplayPipeLibrary->QueryInterface(__uuidof(ID3D12PipelineLibrary1),
+                                      (void **)&m_ReplayPipeLibrary1);
+}
+
+void WrappedID3D12Device::SaveReplayPipeLibrary()
+{
+  if(m_ReplayPipeLibrary && m_ReplayPipeLibraryDirty)
+  {
+    bytebuf data;
+    data.resize(m_ReplayPipeLibrary->GetSerializedSize());
+
+    HRESULT hr = m_ReplayPipeLibrary->Serialize(data.data(), data.size());
+
+    if(SUCCEEDED(hr))
+      FileIO::WriteAll(m_ReplayPipeLibraryFilename, data);
+    else
+      RDCWARN("Couldn't serialise pipeline library: %s", ToStr(hr).c_str());
+  }
+
+  SAFE_RELEASE(m_ReplayPipeLibrary1);
+  SAFE_RELEASE(m_ReplayPipeLibrary);
+  m_ReplayPipeLibraryBlob.clear();
+  m_ReplayPipeLibraryDirty = false;
+}
+
+ID3D12PipelineState *WrappedID3D12Device::LoadReplayPipeline(
+    ResourceId id, const D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc)
+{
+  if(m_ReplayPipeLibrary == NULL)
+    return NULL;
+
+  ID3D12PipelineState *ret = NULL;
+  HRESULT hr = m_ReplayPipeLibrary->LoadGraphicsPipeline(StringFormat::UTF82Wide(ToStr(id)).c_str(),
+                                                         &desc, __uuidof(ID3D12PipelineState),
+                                                         (void **)&ret);
+
+  return SUCCEEDED(hr) ? ret : NULL;
+}
+
+ID3D12PipelineState *WrappedID3D12Device::LoadReplayPipeline(
+    ResourceId id, const D3D12_COMPUTE_PIPELINE_STATE_DESC &desc)
+{
+  if(m_ReplayPipeLibrary == NULL)
+    return NULL;
+
+  ID3D12PipelineState *ret = NULL;
+  HRESULT hr = m_ReplayPipeLibrary->LoadComputePipeline(StringFormat::UTF82Wide(ToStr(id)).c_str(),
+                                                        &desc, __uuidof(ID3D12PipelineState),
+                                                        (void **)&ret);
+
+  return SUCCEEDED(hr) ? ret : NULL;
+}
+
+ID3D12PipelineState *WrappedID3D12Device::LoadReplayPipeline(
+    ResourceId id, const D3D12_PIPELINE_STATE_STREAM_DESC &desc)
+{
+  if(m_ReplayPipeLibrary1 == NULL)
+    return NULL;
+
+  ID3D12PipelineState *ret = NULL;
+  HRESULT hr = m_ReplayPipeLibrary1->LoadPipeline(StringFormat::UTF82Wide(ToStr(id)).c_str(),
+                                                  &desc, __uuidof(ID3D12PipelineState),
+                                                  (void **)&ret);
+
+  return SUCCEEDED(hr) ? ret : NULL;
+}
+
+void WrappedID3D12Device::StoreReplayPipeline(ResourceId id, ID3D12PipelineState *pipe)
+{
+  if(m_ReplayPipeLibrary == NULL)
+    return;
+
+  // this fails harmlessly if a pipeline with this name is already stored but didn't match above
+  HRESULT hr = m_ReplayPipeLibrary->StorePipeline(StringFormat::UTF82Wide(ToStr(id)).c_str(), pipe);
+
+  if(SUCCEEDED(hr))
+    m_ReplayPipeLibraryDirty = true;
+}
+
+bool WrappedID3D12Device::WrittenSinceReset(ResourceId id)
+{
+  if(m_ReplayedSinceReset == ~0U || D3D12_Debug_AlwaysResetWrittenResources())
+    return true;
+
+  auto it = m_FirstWriteEvent.find(id);
+
+  // resources without a tracked first write are always reset
+  if(it == m_FirstWriteEvent.end())
+    return true;
+
+  return it->second <= m_ReplayedSinceReset;
+}
+
+bool WrappedID3D12Device::CanReplayForward(uint32_t endEventID)
+{
+  if(D3D12_Debug_DisableForwardReplay())
+    return false;
+
+  // we need to have fully replayed up to and including an earlier event, with nothing else done
+  if(m_ForwardReplay.eventId == 0 || m_ForwardReplay.pendingDraw ||
+     endEventID <= m_ForwardReplay.eventId)
+    return false;
+
+  D3D12CommandData &cmd = *m_Queue->GetCommandData();
+
+  const D3D12CommandData::PartialReplayData &primary = cmd.m_Partial[D3D12CommandData::Primary];
+
+  // we only continue within a primary command list outside of render passes, not inside bundles
+  if(primary.partialParent == ResourceId() || primary.renderPassActive ||
+     cmd.m_Partial[D3D12CommandData::Secondary].partialParent != ResourceId())
+    return false;
+
+  // the new event must be in the same execution of the command list that's partially replayed.
+  // This is the same check Reset uses to detect the partial command list.
+  if(endEventID > primary.baseEvent + cmd.m_BakedCmdListInfo[primary.partialParent].eventCount)
+    return false;
+
+  // anything that changes render pass state, steps into other command lists, or changes resource
+  // states can't be continued safely in a standalone command list, so fall back to a full replay
+  for(uint32_t eid = m_ForwardReplay.eventId + 1; eid <= endEventID; eid++)
+  {
+    const ActionDescription *action = GetAction(eid);
+
+    if(action && (action->flags & (ActionFlags::PassBoundary | ActionFlags::BeginPass |
+                                   ActionFlags::EndPass | ActionFlags::CmdList |
+                                   ActionFlags::CommandBufferBoundary | ActionFlags::MultiAction |
+                                   ActionFlags::Indirect | ActionFlags::Present)))
+      return false;
+
+    const APIEvent &ev = m_Queue->GetEvent(eid);
+
+    if(ev.eventId != eid)
+      return false;
+
+    switch((D3D12Chunk)cmd.m_StructuredFile->chunks[ev.chunkIndex]->metadata.chunkID)
+    {
+      case D3D12Chunk::List_ResourceBarrier:
+      case D3D12Chunk::List_ExecuteBundle:
+      case D3D12Chunk::List_ExecuteIndirect:
+      case D3D12Chunk::List_IndirectSubCommand:
+      case D3D12Chunk::List_BeginRenderPass:
+      case D3D12Chunk::List_EndRenderPass: return false;
+      default: break;
+    }
+  }
+
+  return true;
+}
+
 void WrappedID3D12Device::ReplayLog(uint32_t startEventID, uint32_t endEventID,
                                     ReplayLogType replayType)
 {
+  // the usual pattern when selecting an event is a replay up to the event without its action,
+  // then the action alone. If nothing else was executed in between, the GPU state afterwards is
+  // exactly the frame up to and including that event, and a later selection in the same command
+  // list can continue from there. Any other replay leaves things in an unknown state.
+  bool forward = false;
+
+  if(startEventID == 0 && replayType == eReplay_WithoutDraw)
+  {
+    forward = CanReplayForward(endEventID);
+
+    if(forward)
+      startEventID = m_ForwardReplay.eventId + 1;
+
+    m_ForwardReplay.eventId = endEventID;
+    m_ForwardReplay.pendingDraw = true;
+  }
+  else if(startEventID == 0 && replayType == eReplay_OnlyDraw && m_ForwardReplay.pendingDraw &&
+          m_ForwardReplay.eventId == endEventID &&
+          m_ForwardReplay.submitCount == m_InternalSubmitCount)
+  {
+    m_ForwardReplay.pendingDraw = false;
+  }
+  else
+  {
+    m_ForwardReplay.Reset();
+  }
+
+  // if the new event immediately follows the last one there's nothing to replay before its action
+  if(forward && startEventID == endEventID)
+  {
+    m_ForwardReplay.submitCount = m_InternalSubmitCount;
+    return;
+  }
+
   bool partial = true;
 
   if(startEventID == 0 && (replayType == eReplay_WithoutDraw || replayType == eReplay_Full))
@@ -4429,8 +4667,14 @@ void WrappedID3D12Device::ReplayLog(uint32_t startEventID, uint32_t endEventID,
 
     if(HasFatalError())
       return;
+
+    m_ReplayedSinceReset = 0;
   }
 
+  // this is conservative for partial replays that start later, but only the furthest write matters
+  if(m_ReplayedSinceReset != ~0U)
+    m_ReplayedSinceReset = RDCMAX(m_ReplayedSinceReset, endEventID);
+
   m_State = CaptureState::ActiveReplaying;
 
   D3D12MarkerRegion::Set(
@@ -4548,4 +4792,6 @@ void WrappedID3D12Device::ReplayLog(uint32_t startEventID, uint32_t endEventID,
 
     ExecuteLists();
   }
+
+  m_ForwardReplay.submitCount = m_InternalSubmitCount;
 }
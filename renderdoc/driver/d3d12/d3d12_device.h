@@ -26,6 +26,7 @@
 
 #include <stdint.h>
 #include <map>
+#include "common/temp_memory.h"
 #include "common/threading.h"
 #include "common/timing.h"
 #include "common/wrapped_pool.h"
@@ -610,6 +611,41 @@ private:
   HANDLE m_GPUSyncHandle;
   UINT64 m_GPUSyncCounter;
 
+  // tracks the event that the GPU state currently corresponds to after a WithoutDraw + OnlyDraw
+  // replay pair, so that selecting a later event in the same command list can replay only the
+  // events in between as a partial replay instead of starting again from the initial contents.
+  struct ForwardReplayData
+  {
+    void Reset()
+    {
+      eventId = 0;
+      pendingDraw = false;
+    }
+
+    // the last event replayed, or 0 if the state is unknown
+    uint32_t eventId = 0;
+    // true between the WithoutDraw and OnlyDraw halves, when eventId itself isn't replayed yet
+    bool pendingDraw = false;
+    // the number of internal submissions at the end of the last replay. If anything else was
+    // executed before the OnlyDraw half we can't be sure the state hasn't been modified.
+    uint64_t submitCount = 0;
+  } m_ForwardReplay;
+
+  // incremented for every execution of internal command lists
+  uint64_t m_InternalSubmitCount = 0;
+
+  // pipeline library persisted to disk across replays of the same capture, so that re-opening it
+  // can skip recompiling every PSO. The blob backs the library and must outlive it.
+  uint32_t m_CaptureHash = 0;
+  ID3D12PipelineLibrary *m_ReplayPipeLibrary = NULL;
+  ID3D12PipelineLibrary1 *m_ReplayPipeLibrary1 = NULL;
+  rdcstr m_ReplayPipeLibraryFilename;
+  bytebuf m_ReplayPipeLibraryBlob;
+  bool m_ReplayPipeLibraryDirty = false;
+
+  void CreateReplayPipeLibrary();
+  void SaveReplayPipeLibrary();
+
   WrappedDownlevelDevice m_WrappedDownlevel;
   WrappedDRED m_DRED;
   WrappedDREDSettings m_DREDSettings;
@@ -650,6 +686,10 @@ private:
 
   std::set<ResourceId> m_UploadResourceIds;
   std::set<ResourceId> m_ModResources;
+  // the first event writing each resource in m_ModResources that is only modified by tracked
+  // usage, and the last event replayed since initial contents were applied.
+  std::unordered_map<ResourceId, uint32_t> m_FirstWriteEvent;
+  uint32_t m_ReplayedSinceReset = ~0U;
   rdcflatmap<uint64_t, ID3D12Resource *> m_UploadBuffers;
   rdcflatmap<uint64_t, D3D12_RANGE> m_UploadRanges;
 
@@ -674,15 +714,7 @@ private:
   Threading::CriticalSection m_ThreadSerialisersLock;
   rdcarray<WriteSerialiser *> m_ThreadSerialisers;
 
-  uint64_t tempMemoryTLSSlot;
-  struct TempMem
-  {
-    TempMem() : memory(NULL), size(0) {}
-    byte *memory;
-    size_t size;
-  };
-  Threading::CriticalSection m_ThreadTempMemLock;
-  rdcarray<TempMem *> m_ThreadTempMem;
+  ThreadTempMemory m_TempMemory;
 
   rdcarray<DebugMessage> m_DebugMessages;
   int m_OOMHandler = 0;
@@ -723,6 +755,7 @@ private:
   Chunk *m_HeaderChunk;
 
   std::set<rdcstr> m_StringDB;
+  CallstackTable m_CallstackTable;
 
   ResourceId m_ResourceID;
   D3D12ResourceRecord *m_DeviceRecord;
@@ -873,6 +906,7 @@ public:
   }
   const ReplayOptions &GetReplayOptions() { return m_ReplayOptions; }
   uint64_t GetCaptureVersion() { return m_SectionVersion; }
+  const CallstackTable *GetCallstackTable() { return &m_CallstackTable; }
   CaptureState GetState() { return m_State; }
   D3D12Replay *GetReplay() { return m_Replay; }
   WrappedID3D12CommandQueue *GetQueue() { return m_Queue; }
@@ -894,7 +928,7 @@ public:
 
   bool IsCubemap(ResourceId id) { return m_Cubemaps.find(id) != m_Cubemaps.end(); }
   // returns thread-local temporary memory
-  byte *GetTempMemory(size_t s);
+  byte *GetTempMemory(size_t s) { return m_TempMemory.GetTempMemory(s); }
   template <class T>
   T *GetTempArray(uint32_t arraycount)
   {
@@ -932,6 +966,7 @@ public:
   ID3D12GraphicsCommandListX *GetInitialStateList();
 
   bool IsReadOnlyResource(ResourceId id) { return m_ModResources.find(id) == m_ModResources.end(); }
+  bool WrittenSinceReset(ResourceId id);
   void CloseInitialStateList();
   ID3D12Resource *GetUploadBuffer(uint64_t chunkOffset, uint64_t byteSize);
   void ApplyInitialContents();
@@ -967,6 +1002,15 @@ public:
 
   RDResult ReadLogInitialisation(RDCFile *rdc, bool storeStructuredBuffers);
   void ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType);
+  bool CanReplayForward(uint32_t endEventID);
+
+  ID3D12PipelineState *LoadReplayPipeline(ResourceId id,
+                                          const D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc);
+  ID3D12PipelineState *LoadReplayPipeline(ResourceId id,
+                                          const D3D12_COMPUTE_PIPELINE_STATE_DESC &desc);
+  ID3D12PipelineState *LoadReplayPipeline(ResourceId id,
+                                          const D3D12_PIPELINE_STATE_STREAM_DESC &desc);
+  void StoreReplayPipeline(ResourceId id, ID3D12PipelineState *pipe);
 
   void SetStructuredExport(uint64_t sectionVersion)
   {
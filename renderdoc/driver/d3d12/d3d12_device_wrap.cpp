@@ -454,8 +454,16 @@ bool WrappedID3D12Device::Serialise_CreateGraphicsPipelineState(
       }
     }
 
-    ID3D12PipelineState *ret = NULL;
-    HRESULT hr = m_pDevice->CreateGraphicsPipelineState(&unwrappedDesc, guid, (void **)&ret);
+    HRESULT hr = S_OK;
+    ID3D12PipelineState *ret = LoadReplayPipeline(pPipelineState, unwrappedDesc);
+
+    if(ret == NULL)
+    {
+      hr = m_pDevice->CreateGraphicsPipelineState(&unwrappedDesc, guid, (void **)&ret);
+
+      if(SUCCEEDED(hr))
+        StoreReplayPipeline(pPipelineState, ret);
+    }
 
     if(FAILED(hr))
     {
@@ -742,8 +750,16 @@ bool WrappedID3D12Device::Serialise_CreateComputePipelineState(
       DXBC::DXBCContainer::HashContainer((void *)Descriptor.CS.pShaderBytecode,
                                          Descriptor.CS.BytecodeLength);
 
-    ID3D12PipelineState *ret = NULL;
-    HRESULT hr = m_pDevice->CreateComputePipelineState(&unwrappedDesc, guid, (void **)&ret);
+    HRESULT hr = S_OK;
+    ID3D12PipelineState *ret = LoadReplayPipeline(pPipelineState, unwrappedDesc);
+
+    if(ret == NULL)
+    {
+      hr = m_pDevice->CreateComputePipelineState(&unwrappedDesc, guid, (void **)&ret);
+
+      if(SUCCEEDED(hr))
+        StoreReplayPipeline(pPipelineState, ret);
+    }
 
     if(FAILED(hr))
     {
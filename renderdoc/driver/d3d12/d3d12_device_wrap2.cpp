@@ -68,7 +68,19 @@ bool WrappedID3D12Device::Serialise_CreatePipelineState(SerialiserType &ser,
 
     if(m_pDevice2)
     {
-      hr = m_pDevice2->CreatePipelineState(unwrappedDesc.AsDescStream(), guid, (void **)&ret);
+      ret = LoadReplayPipeline(pPipelineState, *unwrappedDesc.AsDescStream());
+
+      if(ret)
+      {
+        hr = S_OK;
+      }
+      else
+      {
+        hr = m_pDevice2->CreatePipelineState(unwrappedDesc.AsDescStream(), guid, (void **)&ret);
+
+        if(SUCCEEDED(hr))
+          StoreReplayPipeline(pPipelineState, ret);
+      }
     }
     else
     {
@@ -1095,17 +1095,55 @@ void D3D12ResourceManager::Apply_InitialState(ID3D12DeviceChild *live,
 
     if(srcheap)
     {
-      // copy the whole heap
-      m_Device->CopyDescriptorsSimple(
-          srcheap->GetNumDescriptors(), dstheap->GetCPUDescriptorHandleForHeapStart(),
-          srcheap->GetCPUDescriptorHandleForHeapStart(), srcheap->GetDesc().Type);
+      D3D12_CPU_DESCRIPTOR_HANDLE dst = dstheap->GetCPUDescriptorHandleForHeapStart();
+      D3D12_CPU_DESCRIPTOR_HANDLE src = srcheap->GetCPUDescriptorHandleForHeapStart();
+      D3D12_DESCRIPTOR_HEAP_TYPE heapType = srcheap->GetDesc().Type;
+      UINT numDescriptors = srcheap->GetNumDescriptors();
+
+      if(IsActiveReplaying(m_State))
+      {
+        // only restore the pages that have been written since the last time we applied. Runs of
+        // consecutive dirty pages are copied together
+        const uint32_t pageSize = WrappedID3D12DescriptorHeap::DescriptorPageSize;
+        const uint32_t numPages = dstheap->GetNumDescriptorPages();
+
+        for(uint32_t page = 0; page < numPages;)
+        {
+          if(!dstheap->IsDirtyPage(page))
+          {
+            page++;
+            continue;
+          }
+
+          uint32_t firstPage = page;
+          while(page < numPages && dstheap->IsDirtyPage(page))
+            page++;
+
+          UINT first = firstPage * pageSize;
+          UINT count = RDCMIN(page * pageSize, numDescriptors) - first;
+
+          D3D12_CPU_DESCRIPTOR_HANDLE pageDst = dst, pageSrc = src;
+          pageDst.ptr += sizeof(D3D12Descriptor) * first;
+          pageSrc.ptr += sizeof(D3D12Descriptor) * first;
+
+          m_Device->CopyDescriptorsSimple(count, pageDst, pageSrc, heapType);
+        }
+      }
+      else
+      {
+        // copy the whole heap
+        m_Device->CopyDescriptorsSimple(numDescriptors, dst, src, heapType);
+      }
+
+      dstheap->ClearDirtyPages();
     }
   }
   else if(type == Resource_Resource)
   {
     ResourceId id = GetResID(live);
 
-    if(IsActiveReplaying(m_State) && m_Device->IsReadOnlyResource(id))
+    if(IsActiveReplaying(m_State) &&
+       (m_Device->IsReadOnlyResource(id) || !m_Device->WrittenSinceReset(id)))
     {
     }
     else if(data.tag == D3D12InitialContents::Copy || data.tag == D3D12InitialContents::ForceCopy)
@@ -791,18 +791,73 @@ bool D3D12ResourceManager::ResourceTypeRelease(ID3D12DeviceChild *res)
   return true;
 }
 
+GPUAddressRangeTracker::~GPUAddressRangeTracker()
+{
+  for(PageTableLeaf *leaf : pageTable)
+    delete leaf;
+}
+
+rdcarray<GPUAddressRange> *GPUAddressRangeTracker::GetPage(uint64_t page, bool create)
+{
+  size_t top = size_t(page >> LeafBits);
+
+  if(top >= pageTable.size())
+  {
+    if(!create)
+      return NULL;
+
+    pageTable.resize(top + 1);
+  }
+
+  if(pageTable[top] == NULL)
+  {
+    if(!create)
+      return NULL;
+
+    pageTable[top] = new PageTableLeaf;
+  }
+
+  return &pageTable[top]->pages[page & ((1U << LeafBits) - 1)];
+}
+
 void GPUAddressRangeTracker::AddTo(const GPUAddressRange &range)
 {
   SCOPED_WRITELOCK(addressLock);
   auto it = std::lower_bound(addresses.begin(), addresses.end(), range.start);
 
   addresses.insert(it - addresses.begin(), range);
+
+  if(range.end <= range.start || ((range.end - 1) >> MaxAddressBits) != 0)
+    return;
+
+  for(uint64_t page = range.start >> PageShift; page <= ((range.end - 1) >> PageShift); page++)
+  {
+    rdcarray<GPUAddressRange> &ranges = *GetPage(page, true);
+
+    it = std::lower_bound(ranges.begin(), ranges.end(), range.start);
+    ranges.insert(it - ranges.begin(), range);
+  }
 }
 
 void GPUAddressRangeTracker::RemoveFrom(const GPUAddressRange &range)
 {
   {
     SCOPED_WRITELOCK(addressLock);
+
+    if(range.end > range.start && ((range.end - 1) >> MaxAddressBits) == 0)
+    {
+      for(uint64_t page = range.start >> PageShift; page <= ((range.end - 1) >> PageShift); page++)
+      {
+        rdcarray<GPUAddressRange> *ranges = GetPage(page, false);
+        if(!ranges)
+          continue;
+
+        ranges->removeOneIf([&range](const GPUAddressRange &r) {
+          return r.start == range.start && r.id == range.id;
+        });
+      }
+    }
+
     size_t i = std::lower_bound(addresses.begin(), addresses.end(), range.start) - addresses.begin();
 
     // there might be multiple buffers with the same range start, find the exact range for this
@@ -833,7 +888,30 @@ void GPUAddressRangeTracker::GetResIDFromAddr(D3D12_GPU_VIRTUAL_ADDRESS addr, Re
 
   GPUAddressRange range;
 
-  // this should really be a read-write lock
+  if((addr >> MaxAddressBits) == 0)
+  {
+    SCOPED_READLOCK(addressLock);
+
+    const rdcarray<GPUAddressRange> *ranges = GetPage(addr >> PageShift, false);
+    if(!ranges)
+      return;
+
+    // ranges are sorted by descending start, so the first containing range is the one starting
+    // closest to addr - the same one the sorted list search would give, except that a range
+    // which doesn't contain addr can't shadow an earlier overlapping one that does.
+    for(const GPUAddressRange &r : *ranges)
+    {
+      if(r.start <= addr && addr < r.end)
+      {
+        id = r.id;
+        offs = addr - r.start;
+        return;
+      }
+    }
+
+    return;
+  }
+
   {
     SCOPED_READLOCK(addressLock);
 
@@ -465,6 +465,7 @@ struct GPUAddressRange
 struct GPUAddressRangeTracker
 {
   GPUAddressRangeTracker() {}
+  ~GPUAddressRangeTracker();
   // no copying
   GPUAddressRangeTracker(const GPUAddressRangeTracker &);
   GPUAddressRangeTracker &operator=(const GPUAddressRangeTracker &);
@@ -475,6 +476,25 @@ struct GPUAddressRangeTracker
   void AddTo(const GPUAddressRange &range);
   void RemoveFrom(const GPUAddressRange &range);
   void GetResIDFromAddr(D3D12_GPU_VIRTUAL_ADDRESS addr, ResourceId &id, UINT64 &offs);
+
+private:
+  // lookups happen for every VB/IB/root argument and every patched indirect argument, so on top of
+  // the sorted list we keep a two-level page table. Each 64kB page lists the ranges overlapping
+  // it, sorted by descending start like addresses, so a lookup is an index into the table and a
+  // scan of (usually) one range. The top level covers 4GB per entry up to 48-bit addresses,
+  // anything above that falls back to searching the sorted list.
+  static const uint32_t PageShift = 16;
+  static const uint32_t LeafBits = 16;
+  static const uint32_t MaxAddressBits = 48;
+
+  struct PageTableLeaf
+  {
+    rdcarray<GPUAddressRange> pages[1U << LeafBits];
+  };
+
+  rdcarray<PageTableLeaf *> pageTable;
+
+  rdcarray<GPUAddressRange> *GetPage(uint64_t page, bool create);
 };
 
 struct MapState
@@ -160,29 +160,88 @@ bool D3D12Replay::CreateSOBuffers()
   return true;
 }
 
+void D3D12Replay::ReleasePostVSData(D3D12PostVSData &data)
+{
+  SAFE_RELEASE(data.vsout.buf);
+  SAFE_RELEASE(data.vsout.idxBuf);
+  SAFE_RELEASE(data.gsout.buf);
+  SAFE_RELEASE(data.gsout.idxBuf);
+}
+
 void D3D12Replay::ClearPostVSCache()
 {
   for(auto it = m_PostVSData.begin(); it != m_PostVSData.end(); ++it)
+    ReleasePostVSData(it->second);
+
+  m_PostVSData.clear();
+  m_PostVSCache.Clear();
+}
+
+void D3D12Replay::TrimPostVSCache(const rdcarray<uint32_t> &keep)
+{
+  for(uint32_t eventId : m_PostVSCache.GetUnsizedEvents())
   {
-    SAFE_RELEASE(it->second.vsout.buf);
-    SAFE_RELEASE(it->second.vsout.idxBuf);
-    SAFE_RELEASE(it->second.gsout.buf);
-    SAFE_RELEASE(it->second.gsout.idxBuf);
+    const D3D12PostVSData &data = m_PostVSData[eventId];
+
+    uint64_t size = 0;
+    for(ID3D12Resource *buf :
+        {data.vsout.buf, data.vsout.idxBuf, data.gsout.buf, data.gsout.idxBuf})
+    {
+      if(buf)
+        size += buf->GetDesc().Width;
+    }
+
+    m_PostVSCache.SetSize(eventId, size);
   }
 
-  m_PostVSData.clear();
+  rdcarray<uint32_t> keepData;
+  for(uint32_t eventId : keep)
+  {
+    auto it = m_PostVSAlias.find(eventId);
+    keepData.push_back(it != m_PostVSAlias.end() ? it->second : eventId);
+  }
+
+  rdcarray<uint32_t> evict = m_PostVSCache.Trim(keepData);
+
+  if(evict.empty())
+    return;
+
+  // the data may still be in use by previously submitted mesh rendering
+  m_pDevice->GPUSync();
+
+  for(uint32_t eventId : evict)
+  {
+    ReleasePostVSData(m_PostVSData[eventId]);
+    m_PostVSData.erase(eventId);
+  }
+}
+
+PostVSCacheStatistics D3D12Replay::GetPostVSCacheStatistics()
+{
+  return m_PostVSCache.GetStatistics();
 }
 
 void D3D12Replay::InitPostVSBuffers(uint32_t eventId)
+{
+  TrimPostVSCache({eventId});
+
+  FetchPostVSData(eventId);
+}
+
+void D3D12Replay::FetchPostVSData(uint32_t eventId)
 {
   // go through any aliasing
   if(m_PostVSAlias.find(eventId) != m_PostVSAlias.end())
     eventId = m_PostVSAlias[eventId];
 
   if(m_PostVSData.find(eventId) != m_PostVSData.end())
+  {
+    m_PostVSCache.Touch(eventId);
     return;
+  }
 
   D3D12PostVSData &ret = m_PostVSData[eventId];
+  m_PostVSCache.Add(eventId);
 
   // we handle out-of-memory errors while processing postvs, don't treat it as a fatal error
   ScopedOOMHandle12 oom(m_pDevice);
@@ -1429,7 +1488,7 @@ struct D3D12InitPostVSCallback : public D3D12ActionCallback
   void PreDraw(uint32_t eid, ID3D12GraphicsCommandListX *cmd) override
   {
     if(m_Events.contains(eid))
-      m_Replay->InitPostVSBuffers(eid);
+      m_Replay->FetchPostVSData(eid);
   }
 
   bool PostDraw(uint32_t eid, ID3D12GraphicsCommandListX *cmd) override { return false; }
@@ -1456,6 +1515,8 @@ struct D3D12InitPostVSCallback : public D3D12ActionCallback
 
 void D3D12Replay::InitPostVSBuffers(const rdcarray<uint32_t> &events)
 {
+  TrimPostVSCache(events);
+
   // first we must replay up to the first event without replaying it. This ensures any
   // non-command buffer calls like memory unmaps etc all happen correctly before this
   // command buffer
@@ -2303,227 +2303,243 @@ uint32_t D3D12Replay::PickVertex(uint32_t eventId, int32_t width, int32_t height
   // we also tightly pack and unpack the data. IB is upcast to R32 so it we can apply baseVertex
   // without risking overflow.
 
-  uint32_t minIndex = 0;
-  uint32_t maxIndex = cfg.position.numIndices;
+  // the index and vertex data we prepare depends only on the mesh, not on the pick position. When
+  // picking repeatedly in the same mesh (e.g. while hovering) the previous data can be used as-is
+  const uint64_t pickKey = MeshPickingKey(eventId, cfg.position);
 
-  uint32_t idxclamp = 0;
-  if(cfg.position.baseVertex < 0)
-    idxclamp = uint32_t(-cfg.position.baseVertex);
-
-  D3D12_SHADER_RESOURCE_VIEW_DESC sdesc = {};
-  sdesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
-  sdesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-  sdesc.Format = DXGI_FORMAT_R32_UINT;
-
-  if(cfg.position.indexByteStride && ib)
+  if(pickKey != m_VertexPick.DataKey)
   {
-    // resize up on demand
-    if(m_VertexPick.IB == NULL || m_VertexPick.IBSize < cfg.position.numIndices * sizeof(uint32_t))
-    {
-      SAFE_RELEASE(m_VertexPick.IB);
-
-      m_VertexPick.IBSize = cfg.position.numIndices * sizeof(uint32_t);
-
-      D3D12_HEAP_PROPERTIES heapProps;
-      heapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
-      heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-      heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-      heapProps.CreationNodeMask = 1;
-      heapProps.VisibleNodeMask = 1;
-
-      D3D12_RESOURCE_DESC ibDesc;
-      ibDesc.Alignment = 0;
-      ibDesc.DepthOrArraySize = 1;
-      ibDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-      ibDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
-      ibDesc.Format = DXGI_FORMAT_UNKNOWN;
-      ibDesc.Height = 1;
-      ibDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-      ibDesc.MipLevels = 1;
-      ibDesc.SampleDesc.Count = 1;
-      ibDesc.SampleDesc.Quality = 0;
-      ibDesc.Width = m_VertexPick.IBSize;
-
-      hr = m_pDevice->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &ibDesc,
-                                              D3D12_RESOURCE_STATE_GENERIC_READ, NULL,
-                                              __uuidof(ID3D12Resource), (void **)&m_VertexPick.IB);
-
-      if(FAILED(hr))
-      {
-        RDCERR("Couldn't create pick index buffer: HRESULT: %s", ToStr(hr).c_str());
-        return ~0U;
-      }
+    m_VertexPick.DataKey = 0;
 
-      m_VertexPick.IB->SetName(L"m_PickIB");
+    uint32_t minIndex = 0;
+    uint32_t maxIndex = cfg.position.numIndices;
 
-      sdesc.Buffer.FirstElement = 0;
-      sdesc.Buffer.NumElements = cfg.position.numIndices;
-      m_pDevice->CreateShaderResourceView(m_VertexPick.IB, &sdesc,
-                                          GetDebugManager()->GetCPUHandle(PICK_IB_SRV));
-    }
+    uint32_t idxclamp = 0;
+    if(cfg.position.baseVertex < 0)
+      idxclamp = uint32_t(-cfg.position.baseVertex);
 
-    RDCASSERT(cfg.position.indexByteOffset < 0xffffffff);
+    D3D12_SHADER_RESOURCE_VIEW_DESC sdesc = {};
+    sdesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+    sdesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    sdesc.Format = DXGI_FORMAT_R32_UINT;
 
-    if(m_VertexPick.IB)
+    if(cfg.position.indexByteStride && ib)
     {
-      bytebuf idxs;
-      GetBufferData(cfg.position.indexResourceId, cfg.position.indexByteOffset, 0, idxs);
+      // resize up on demand
+      if(m_VertexPick.IB == NULL ||
+         m_VertexPick.IBSize < cfg.position.numIndices * sizeof(uint32_t))
+      {
+        SAFE_RELEASE(m_VertexPick.IB);
 
-      rdcarray<uint32_t> outidxs;
-      outidxs.resize(cfg.position.numIndices);
+        m_VertexPick.IBSize = cfg.position.numIndices * sizeof(uint32_t);
 
-      uint16_t *idxs16 = (uint16_t *)&idxs[0];
-      uint32_t *idxs32 = (uint32_t *)&idxs[0];
+        D3D12_HEAP_PROPERTIES heapProps;
+        heapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
+        heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+        heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+        heapProps.CreationNodeMask = 1;
+        heapProps.VisibleNodeMask = 1;
 
-      if(cfg.position.indexByteStride == 2)
-      {
-        size_t bufsize = idxs.size() / 2;
+        D3D12_RESOURCE_DESC ibDesc;
+        ibDesc.Alignment = 0;
+        ibDesc.DepthOrArraySize = 1;
+        ibDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+        ibDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+        ibDesc.Format = DXGI_FORMAT_UNKNOWN;
+        ibDesc.Height = 1;
+        ibDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+        ibDesc.MipLevels = 1;
+        ibDesc.SampleDesc.Count = 1;
+        ibDesc.SampleDesc.Quality = 0;
+        ibDesc.Width = m_VertexPick.IBSize;
+
+        hr = m_pDevice->CreateCommittedResource(
+            &heapProps, D3D12_HEAP_FLAG_NONE, &ibDesc, D3D12_RESOURCE_STATE_GENERIC_READ, NULL,
+            __uuidof(ID3D12Resource), (void **)&m_VertexPick.IB);
 
-        for(uint32_t i = 0; i < bufsize && i < cfg.position.numIndices; i++)
+        if(FAILED(hr))
         {
-          uint32_t idx = idxs16[i];
+          RDCERR("Couldn't create pick index buffer: HRESULT: %s", ToStr(hr).c_str());
+          return ~0U;
+        }
 
-          if(idx < idxclamp)
-            idx = 0;
-          else if(cfg.position.baseVertex < 0)
-            idx -= idxclamp;
-          else if(cfg.position.baseVertex > 0)
-            idx += cfg.position.baseVertex;
+        m_VertexPick.IB->SetName(L"m_PickIB");
 
-          if(i == 0)
-          {
-            minIndex = maxIndex = idx;
-          }
-          else
-          {
-            minIndex = RDCMIN(idx, minIndex);
-            maxIndex = RDCMAX(idx, maxIndex);
-          }
-
-          outidxs[i] = idx;
-        }
+        sdesc.Buffer.FirstElement = 0;
+        sdesc.Buffer.NumElements = cfg.position.numIndices;
+        m_pDevice->CreateShaderResourceView(m_VertexPick.IB, &sdesc,
+                                            GetDebugManager()->GetCPUHandle(PICK_IB_SRV));
       }
-      else
+
+      RDCASSERT(cfg.position.indexByteOffset < 0xffffffff);
+
+      if(m_VertexPick.IB)
       {
-        uint32_t bufsize = uint32_t(idxs.size() / 4);
+        bytebuf idxs;
+        GetBufferData(cfg.position.indexResourceId, cfg.position.indexByteOffset, 0, idxs);
+
+        rdcarray<uint32_t> outidxs;
+        outidxs.resize(cfg.position.numIndices);
 
-        minIndex = maxIndex = idxs32[0];
+        uint16_t *idxs16 = (uint16_t *)&idxs[0];
+        uint32_t *idxs32 = (uint32_t *)&idxs[0];
 
-        for(uint32_t i = 0; i < RDCMIN(bufsize, cfg.position.numIndices); i++)
+        if(cfg.position.indexByteStride == 2)
         {
-          uint32_t idx = idxs32[i];
+          size_t bufsize = idxs.size() / 2;
 
-          if(idx < idxclamp)
-            idx = 0;
-          else if(cfg.position.baseVertex < 0)
-            idx -= idxclamp;
-          else if(cfg.position.baseVertex > 0)
-            idx += cfg.position.baseVertex;
+          for(uint32_t i = 0; i < bufsize && i < cfg.position.numIndices; i++)
+          {
+            uint32_t idx = idxs16[i];
+
+            if(idx < idxclamp)
+              idx = 0;
+            else if(cfg.position.baseVertex < 0)
+              idx -= idxclamp;
+            else if(cfg.position.baseVertex > 0)
+              idx += cfg.position.baseVertex;
 
-          minIndex = RDCMIN(idx, minIndex);
-          maxIndex = RDCMAX(idx, maxIndex);
+            if(i == 0)
+            {
+              minIndex = maxIndex = idx;
+            }
+            else
+            {
+              minIndex = RDCMIN(idx, minIndex);
+              maxIndex = RDCMAX(idx, maxIndex);
+            }
 
-          outidxs[i] = idx;
+            outidxs[i] = idx;
+          }
         }
-      }
+        else
+        {
+          uint32_t bufsize = uint32_t(idxs.size() / 4);
 
-      D3D11_BOX box;
-      box.top = 0;
-      box.bottom = 1;
-      box.front = 0;
-      box.back = 1;
-      box.left = 0;
-      box.right = UINT(outidxs.size() * sizeof(uint32_t));
+          minIndex = maxIndex = idxs32[0];
 
-      GetDebugManager()->FillBuffer(m_VertexPick.IB, 0, outidxs.data(),
-                                    sizeof(uint32_t) * outidxs.size());
-    }
-  }
-  else
-  {
-    sdesc.Buffer.NumElements = 4;
-    m_pDevice->CreateShaderResourceView(NULL, &sdesc, GetDebugManager()->GetCPUHandle(PICK_IB_SRV));
-  }
+          for(uint32_t i = 0; i < RDCMIN(bufsize, cfg.position.numIndices); i++)
+          {
+            uint32_t idx = idxs32[i];
 
-  sdesc.Buffer.FirstElement = 0;
-  sdesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+            if(idx < idxclamp)
+              idx = 0;
+            else if(cfg.position.baseVertex < 0)
+              idx -= idxclamp;
+            else if(cfg.position.baseVertex > 0)
+              idx += cfg.position.baseVertex;
 
-  // unpack and linearise the data
-  {
-    bytebuf oldData;
-    GetDebugManager()->GetBufferData(vb, cfg.position.vertexByteOffset, 0, oldData);
+            minIndex = RDCMIN(idx, minIndex);
+            maxIndex = RDCMAX(idx, maxIndex);
 
-    // clamp maxIndex to upper bound in case we got invalid indices or primitive restart indices
-    maxIndex = RDCMIN(maxIndex, uint32_t(oldData.size() / RDCMAX(1U, cfg.position.vertexByteStride)));
+            outidxs[i] = idx;
+          }
+        }
 
-    if(vb)
+        D3D11_BOX box;
+        box.top = 0;
+        box.bottom = 1;
+        box.front = 0;
+        box.back = 1;
+        box.left = 0;
+        box.right = UINT(outidxs.size() * sizeof(uint32_t));
+
+        GetDebugManager()->FillBuffer(m_VertexPick.IB, 0, outidxs.data(),
+                                      sizeof(uint32_t) * outidxs.size());
+      }
+    }
+    else
     {
-      if(m_VertexPick.VB == NULL || m_VertexPick.VBSize < (maxIndex + 1) * sizeof(Vec4f))
-      {
-        SAFE_RELEASE(m_VertexPick.VB);
+      sdesc.Buffer.NumElements = 4;
+      m_pDevice->CreateShaderResourceView(NULL, &sdesc,
+                                          GetDebugManager()->GetCPUHandle(PICK_IB_SRV));
+    }
 
-        m_VertexPick.VBSize = (maxIndex + 1) * sizeof(Vec4f);
+    sdesc.Buffer.FirstElement = 0;
+    sdesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
 
-        D3D12_HEAP_PROPERTIES heapProps;
-        heapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
-        heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-        heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-        heapProps.CreationNodeMask = 1;
-        heapProps.VisibleNodeMask = 1;
+    // unpack and linearise the data
+    {
+      bytebuf oldData;
+      GetDebugManager()->GetBufferData(vb, cfg.position.vertexByteOffset, 0, oldData);
 
-        D3D12_RESOURCE_DESC vbDesc;
-        vbDesc.Alignment = 0;
-        vbDesc.DepthOrArraySize = 1;
-        vbDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-        vbDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
-        vbDesc.Format = DXGI_FORMAT_UNKNOWN;
-        vbDesc.Height = 1;
-        vbDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-        vbDesc.MipLevels = 1;
-        vbDesc.SampleDesc.Count = 1;
-        vbDesc.SampleDesc.Quality = 0;
-        vbDesc.Width = m_VertexPick.VBSize;
-
-        hr = m_pDevice->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &vbDesc,
-                                                D3D12_RESOURCE_STATE_GENERIC_READ, NULL,
-                                                __uuidof(ID3D12Resource), (void **)&m_VertexPick.VB);
+      // clamp maxIndex to upper bound in case we got invalid indices or primitive restart indices
+      maxIndex =
+          RDCMIN(maxIndex, uint32_t(oldData.size() / RDCMAX(1U, cfg.position.vertexByteStride)));
 
-        if(FAILED(hr))
+      if(vb)
+      {
+        if(m_VertexPick.VB == NULL || m_VertexPick.VBSize < (maxIndex + 1) * sizeof(Vec4f))
         {
-          RDCERR("Couldn't create pick vertex buffer: HRESULT: %s", ToStr(hr).c_str());
-          return ~0U;
-        }
+          SAFE_RELEASE(m_VertexPick.VB);
+
+          m_VertexPick.VBSize = (maxIndex + 1) * sizeof(Vec4f);
+
+          D3D12_HEAP_PROPERTIES heapProps;
+          heapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
+          heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+          heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+          heapProps.CreationNodeMask = 1;
+          heapProps.VisibleNodeMask = 1;
+
+          D3D12_RESOURCE_DESC vbDesc;
+          vbDesc.Alignment = 0;
+          vbDesc.DepthOrArraySize = 1;
+          vbDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+          vbDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+          vbDesc.Format = DXGI_FORMAT_UNKNOWN;
+          vbDesc.Height = 1;
+          vbDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+          vbDesc.MipLevels = 1;
+          vbDesc.SampleDesc.Count = 1;
+          vbDesc.SampleDesc.Quality = 0;
+          vbDesc.Width = m_VertexPick.VBSize;
+
+          hr = m_pDevice->CreateCommittedResource(
+              &heapProps, D3D12_HEAP_FLAG_NONE, &vbDesc, D3D12_RESOURCE_STATE_GENERIC_READ, NULL,
+              __uuidof(ID3D12Resource), (void **)&m_VertexPick.VB);
+
+          if(FAILED(hr))
+          {
+            RDCERR("Couldn't create pick vertex buffer: HRESULT: %s", ToStr(hr).c_str());
+            return ~0U;
+          }
 
-        m_VertexPick.VB->SetName(L"m_PickVB");
+          m_VertexPick.VB->SetName(L"m_PickVB");
 
-        sdesc.Buffer.NumElements = (maxIndex + 1);
-        m_pDevice->CreateShaderResourceView(m_VertexPick.VB, &sdesc,
+          sdesc.Buffer.NumElements = (maxIndex + 1);
+          m_pDevice->CreateShaderResourceView(m_VertexPick.VB, &sdesc,
+                                              GetDebugManager()->GetCPUHandle(PICK_VB_SRV));
+        }
+      }
+      else
+      {
+        sdesc.Buffer.NumElements = 4;
+        m_pDevice->CreateShaderResourceView(NULL, &sdesc,
                                             GetDebugManager()->GetCPUHandle(PICK_VB_SRV));
       }
-    }
-    else
-    {
-      sdesc.Buffer.NumElements = 4;
-      m_pDevice->CreateShaderResourceView(NULL, &sdesc, GetDebugManager()->GetCPUHandle(PICK_VB_SRV));
-    }
 
-    rdcarray<FloatVector> vbData;
-    vbData.resize(maxIndex + 1);
+      rdcarray<FloatVector> vbData;
+      vbData.resize(maxIndex + 1);
 
-    byte *data = &oldData[0];
-    byte *dataEnd = data + oldData.size();
+      byte *data = &oldData[0];
+      byte *dataEnd = data + oldData.size();
 
-    bool valid = true;
+      bool valid = true;
 
-    // the index buffer may refer to vertices past the start of the vertex buffer, so we can't just
-    // conver the first N vertices we'll need.
-    // Instead we grab min and max above, and convert every vertex in that range. This might
-    // slightly over-estimate but not as bad as 0-max or the whole buffer.
-    for(uint32_t idx = minIndex; idx <= maxIndex; idx++)
-      vbData[idx] = HighlightCache::InterpretVertex(data, idx, cfg.position.vertexByteStride,
-                                                    cfg.position.format, dataEnd, valid);
+      // the index buffer may refer to vertices past the start of the vertex buffer, so we can't
+      // just conver the first N vertices we'll need.
+      // Instead we grab min and max above, and convert every vertex in that range. This might
+      // slightly over-estimate but not as bad as 0-max or the whole buffer.
+      for(uint32_t idx = minIndex; idx <= maxIndex; idx++)
+        vbData[idx] = HighlightCache::InterpretVertex(data, idx, cfg.position.vertexByteStride,
+                                                      cfg.position.format, dataEnd, valid);
 
-    GetDebugManager()->FillBuffer(m_VertexPick.VB, 0, vbData.data(), sizeof(Vec4f) * (maxIndex + 1));
+      GetDebugManager()->FillBuffer(m_VertexPick.VB, 0, vbData.data(),
+                                    sizeof(Vec4f) * (maxIndex + 1));
+    }
+
+    m_VertexPick.DataKey = pickKey;
   }
 
   ID3D12GraphicsCommandList *list = m_pDevice->GetNewList();
@@ -2744,6 +2760,14 @@ void D3D12Replay::PickPixel(ResourceId texture, uint32_t x, uint32_t y, const Su
     m_General.ResultReadbackBuffer->Unmap(0, &range);
 }
 
+bool D3D12Replay::PickPixelTile(ResourceId texture, uint32_t x, uint32_t y, uint32_t width,
+                                uint32_t height, const Subresource &sub, CompType typeCast,
+                                rdcarray<float> &pixels)
+{
+  // not implemented, pixels are picked individually
+  return false;
+}
+
 bool D3D12Replay::GetMinMax(ResourceId texid, const Subresource &sub, CompType typeCast,
                             float *minval, float *maxval)
 {
@@ -4158,6 +4182,18 @@ void D3D12Replay::GetTextureData(ResourceId tex, const Subresource &sub,
   SAFE_RELEASE(tmpTexture);
 }
 
+void D3D12Replay::GetTextureDataBatch(const rdcarray<TextureReadback> &readbacks,
+                                      TextureReadbackCallback callback)
+{
+  // readbacks aren't pipelined here, fetch each one in turn
+  for(size_t i = 0; i < readbacks.size(); i++)
+  {
+    bytebuf data;
+    GetTextureData(readbacks[i].tex, readbacks[i].sub, readbacks[i].params, data);
+    callback(i, data);
+  }
+}
+
 rdcarray<ShaderSourcePrefix> D3D12Replay::GetCustomShaderSourcePrefixes()
 {
   return {
@@ -4300,6 +4336,14 @@ rdcarray<PixelModification> D3D12Replay::PixelHistory(rdcarray<EventUsage> event
   return {};
 }
 
+PixelRegionHistory D3D12Replay::PixelHistoryRegion(rdcarray<EventUsage> events, ResourceId target,
+                                                   uint32_t x, uint32_t y, uint32_t width,
+                                                   uint32_t height, const Subresource &sub,
+                                                   CompType typeCast)
+{
+  return {};
+}
+
 ResourceId D3D12Replay::CreateProxyTexture(const TextureDescription &templateTex)
 {
   return ResourceId();
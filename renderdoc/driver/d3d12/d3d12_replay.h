@@ -138,6 +138,16 @@ public:
     m_D3D12PipelineState = d3d12;
   }
   void SavePipelineState(uint32_t eventId);
+  rdcarray<VKPipe::BindingElement> GetVulkanDescriptors(bool compute, uint32_t set,
+                                                        uint32_t binding, uint32_t firstElement,
+                                                        uint32_t count)
+  {
+    return {};
+  }
+  rdcarray<uint32_t> GetVulkanUsedDescriptors(bool compute, uint32_t set, uint32_t binding)
+  {
+    return {};
+  }
   void FreeTargetResource(ResourceId id);
   void FreeCustomShader(ResourceId id);
 
@@ -169,6 +179,8 @@ public:
 
   void InitPostVSBuffers(uint32_t eventId);
   void InitPostVSBuffers(const rdcarray<uint32_t> &passEvents);
+  void FetchPostVSData(uint32_t eventId);
+  PostVSCacheStatistics GetPostVSCacheStatistics();
 
   // indicates that EID alias is the same as eventId
   void AliasPostVSBuffers(uint32_t eventId, uint32_t alias) { m_PostVSAlias[alias] = eventId; }
@@ -176,6 +188,8 @@ public:
 
   void PickPixel(ResourceId texture, uint32_t x, uint32_t y, const Subresource &sub,
                  CompType typeCast, float pixel[4]);
+  bool PickPixelTile(ResourceId texture, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                     const Subresource &sub, CompType typeCast, rdcarray<float> &pixels);
   bool GetMinMax(ResourceId texid, const Subresource &sub, CompType typeCast, float *minval,
                  float *maxval);
   bool GetHistogram(ResourceId texid, const Subresource &sub, CompType typeCast, float minval,
@@ -188,6 +202,8 @@ public:
   void GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, bytebuf &retData);
   void GetTextureData(ResourceId tex, const Subresource &sub, const GetTextureDataParams &params,
                       bytebuf &data);
+  void GetTextureDataBatch(const rdcarray<TextureReadback> &readbacks,
+                           TextureReadbackCallback callback);
 
   rdcarray<ShaderEncoding> GetCustomShaderEncodings()
   {
@@ -231,10 +247,16 @@ public:
 
   rdcarray<PixelModification> PixelHistory(rdcarray<EventUsage> events, ResourceId target, uint32_t x,
                                            uint32_t y, const Subresource &sub, CompType typeCast);
+  PixelRegionHistory PixelHistoryRegion(rdcarray<EventUsage> events, ResourceId target, uint32_t x,
+                                        uint32_t y, uint32_t width, uint32_t height,
+                                        const Subresource &sub, CompType typeCast);
   ShaderDebugTrace *DebugVertex(uint32_t eventId, uint32_t vertid, uint32_t instid, uint32_t idx,
                                 uint32_t view);
   ShaderDebugTrace *DebugPixel(uint32_t eventId, uint32_t x, uint32_t y, uint32_t sample,
                                uint32_t primitive);
+  rdcarray<ShaderDebugTrace *> DebugPixels(uint32_t eventId,
+                                           const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels,
+                                           uint32_t sample, uint32_t primitive);
   ShaderDebugTrace *DebugThread(uint32_t eventId, const rdcfixedarray<uint32_t, 3> &groupid,
                                 const rdcfixedarray<uint32_t, 3> &threadid);
   rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger);
@@ -268,6 +290,7 @@ private:
 
   bool CreateSOBuffers();
   void ClearPostVSCache();
+  void TrimPostVSCache(const rdcarray<uint32_t> &keep);
 
   bool FetchShaderFeedback(uint32_t eventId);
   void ClearFeedbackCache();
@@ -350,6 +373,9 @@ private:
 
   std::map<uint32_t, D3D12PostVSData> m_PostVSData;
   std::map<uint32_t, uint32_t> m_PostVSAlias;
+  PostVSCacheTracker m_PostVSCache;
+
+  void ReleasePostVSData(D3D12PostVSData &data);
 
   uint64_t m_SOBufferSize = 128;
   ID3D12Resource *m_SOBuffer = NULL;
@@ -452,6 +478,8 @@ private:
     ID3D12Resource *IB = NULL;
     uint32_t VBSize = 0;
     uint32_t IBSize = 0;
+    // identifies the mesh data currently in IB and VB, see MeshPickingKey
+    uint64_t DataKey = 0;
     ID3D12Resource *ResultBuf = NULL;
     ID3D12RootSignature *RootSig = NULL;
     ID3D12PipelineState *Pipe = NULL;
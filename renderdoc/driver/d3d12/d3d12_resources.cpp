@@ -380,12 +380,37 @@ bool WrappedID3D12DescriptorHeap::HasValidViewCache(uint32_t index)
 
 void WrappedID3D12DescriptorHeap::MarkMutableView(uint32_t index)
 {
+  // every write to a descriptor while replaying the frame comes through here, so this is also
+  // where we track which pages need to be restored on the next reset
+  if(dirtyPageBitmask)
+  {
+    uint32_t page = index / DescriptorPageSize;
+    dirtyPageBitmask[page / 64] |= (1ULL << (page % 64));
+  }
+
   if(!mutableViewBitmask)
     return;
 
   mutableViewBitmask[index / 64] |= (1ULL << (index % 64));
 }
 
+bool WrappedID3D12DescriptorHeap::IsDirtyPage(uint32_t page)
+{
+  // if we're not tracking, conservatively treat everything as dirty
+  if(!dirtyPageBitmask)
+    return true;
+
+  return (dirtyPageBitmask[page / 64] & (1ULL << (page % 64))) != 0;
+}
+
+void WrappedID3D12DescriptorHeap::ClearDirtyPages()
+{
+  if(!dirtyPageBitmask)
+    return;
+
+  RDCEraseMem(dirtyPageBitmask, sizeof(uint64_t) * (AlignUp(GetNumDescriptorPages(), 64U) / 64));
+}
+
 void WrappedID3D12DescriptorHeap::GetFromViewCache(uint32_t index, D3D12Pipe::View &view)
 {
   if(!mutableViewBitmask)
@@ -446,6 +471,18 @@ WrappedID3D12DescriptorHeap::WrappedID3D12DescriptorHeap(ID3D12DescriptorHeap *r
     cachedViews = NULL;
     mutableViewBitmask = NULL;
   }
+
+  if(IsReplayMode(device->GetState()))
+  {
+    size_t bitmaskSize = AlignUp(GetNumDescriptorPages(), 64U) / 64;
+
+    dirtyPageBitmask = new uint64_t[bitmaskSize];
+    RDCEraseMem(dirtyPageBitmask, sizeof(uint64_t) * bitmaskSize);
+  }
+  else
+  {
+    dirtyPageBitmask = NULL;
+  }
 }
 
 WrappedID3D12DescriptorHeap::~WrappedID3D12DescriptorHeap()
@@ -454,6 +491,7 @@ WrappedID3D12DescriptorHeap::~WrappedID3D12DescriptorHeap()
   SAFE_DELETE_ARRAY(descriptors);
   SAFE_DELETE_ARRAY(cachedViews);
   SAFE_DELETE_ARRAY(mutableViewBitmask);
+  SAFE_DELETE_ARRAY(dirtyPageBitmask);
 }
 
 void WrappedID3D12PipelineState::ShaderEntry::BuildReflection()
@@ -399,7 +399,14 @@ class WrappedID3D12DescriptorHeap : public WrappedDeviceChild12<ID3D12Descriptor
   D3D12Pipe::View *cachedViews;
   uint64_t *mutableViewBitmask;
 
+  // on replay, one bit per page of descriptors that has been written since the initial contents
+  // were last applied
+  uint64_t *dirtyPageBitmask;
+
 public:
+  // granularity of dirty tracking for restoring initial contents on replay
+  static const uint32_t DescriptorPageSize = 1024;
+
   ALLOCATE_WITH_WRAPPED_POOL(WrappedID3D12DescriptorHeap);
 
   enum
@@ -415,6 +422,12 @@ public:
   UINT GetNumDescriptors() { return numDescriptors; }
   bool HasValidViewCache(uint32_t index);
   void MarkMutableView(uint32_t index);
+  uint32_t GetNumDescriptorPages()
+  {
+    return AlignUp(numDescriptors, DescriptorPageSize) / DescriptorPageSize;
+  }
+  bool IsDirtyPage(uint32_t page);
+  void ClearDirtyPages();
   void GetFromViewCache(uint32_t index, D3D12Pipe::View &view);
   void SetToViewCache(uint32_t index, const D3D12Pipe::View &view);
 
@@ -26,6 +26,7 @@
 #pragma once
 
 #include "common/common.h"
+#include "core/api_overhead.h"
 #include "core/core.h"
 #include "maths/vec.h"
 
@@ -450,11 +451,13 @@ T CheckConstParam(T t);
 
 #define USE_SCRATCH_SERIALISER() WriteSerialiser &ser = m_ScratchSerialiser;
 
-#define SERIALISE_TIME_CALL(...)                                          \
-  m_ScratchSerialiser.ChunkMetadata().timestampMicro = Timing::GetTick(); \
-  __VA_ARGS__;                                                            \
-  m_ScratchSerialiser.ChunkMetadata().durationMicro =                     \
-      Timing::GetTick() - m_ScratchSerialiser.ChunkMetadata().timestampMicro;
+#define SERIALISE_TIME_CALL(...)                                                    \
+  m_ScratchSerialiser.ChunkMetadata().timestampMicro = Timing::GetTick();           \
+  __VA_ARGS__;                                                                      \
+  m_ScratchSerialiser.ChunkMetadata().durationMicro =                               \
+      Timing::GetTick() - m_ScratchSerialiser.ChunkMetadata().timestampMicro;       \
+  if(APIOverhead::IsEnabled())                                                      \
+    APIOverhead::AddDriverTicks(m_ScratchSerialiser.ChunkMetadata().durationMicro);
 
 // A handy macros to say "is the serialiser reading and we're doing replay-mode stuff?"
 // The reason we check both is that checking the first allows the compiler to eliminate the other
@@ -905,9 +908,32 @@ struct PerStageReflections
   const ShaderBindpointMapping *mappings[6] = {};
 };
 
+// a precomputed mapping of loose uniforms and block bindings from one program to another, built
+// the first time the programs are copied. Repeated copies between the same pair of programs can
+// then skip all the interface and location queries, and apply arrays in single calls.
+struct ProgramUniformLayout
+{
+  struct UniformRun
+  {
+    GLenum type;
+    GLint srcLocation;
+    GLint dstLocation;
+    GLsizei count;
+  };
+
+  bool valid = false;
+  bool dstSPIRV = false;
+  rdcarray<UniformRun> uniforms;
+  // source block index to destination block index
+  rdcarray<rdcpair<GLuint, GLuint>> uboBlocks;
+  rdcarray<rdcpair<GLuint, GLuint>> ssboBlocks;
+};
+
 void CopyProgramUniforms(const PerStageReflections &srcStages, GLuint progSrc,
                          const PerStageReflections &dstStages, GLuint progDst,
-                         std::map<GLint, GLint> *locTranslate = NULL);
+                         std::map<GLint, GLint> *locTranslate = NULL,
+                         ProgramUniformLayout *layout = NULL);
+void CopyProgramUniforms(const ProgramUniformLayout &layout, GLuint progSrc, GLuint progDst);
 template <typename SerialiserType>
 void SerialiseProgramUniforms(SerialiserType &ser, CaptureState state,
                               const PerStageReflections &stages, GLuint prog,
@@ -1698,6 +1698,14 @@ void GLReplay::PickPixel(ResourceId texture, uint32_t x, uint32_t y, const Subre
   }
 }
 
+bool GLReplay::PickPixelTile(ResourceId texture, uint32_t x, uint32_t y, uint32_t width,
+                             uint32_t height, const Subresource &sub, CompType typeCast,
+                             rdcarray<float> &pixels)
+{
+  // not implemented, pixels are picked individually
+  return false;
+}
+
 bool GLReplay::GetMinMax(ResourceId texid, const Subresource &sub, CompType typeCast, float *minval,
                          float *maxval)
 {
@@ -26,12 +26,15 @@
 #include "gl_driver.h"
 #include <algorithm>
 #include "common/common.h"
+#include "core/settings.h"
 #include "driver/shaders/spirv/spirv_compile.h"
 #include "jpeg-compressor/jpge.h"
 #include "serialise/rdcfile.h"
 #include "strings/string_utils.h"
 #include "gl_replay.h"
 
+RDOC_EXTERN_CONFIG(bool, Capture_ZstdFrameCapture);
+
 std::map<uint64_t, GLWindowingData> WrappedOpenGL::m_ActiveContexts;
 
 void WrappedOpenGL::BuildGLExtensions()
@@ -1078,9 +1081,21 @@ void WrappedOpenGL::CheckImplicitThread()
 
 WrappedOpenGL::ContextData &WrappedOpenGL::GetCtxData()
 {
+  GLContextTLSData *ret = (GLContextTLSData *)Threading::GetTLSValue(m_CurCtxDataTLS);
+  if(ret && ret->ctxData)
+    return *(ContextData *)ret->ctxData;
   return m_ContextData[GetCtx().ctx];
 }
 
+void WrappedOpenGL::ForgetCtxData(void *contextHandle)
+{
+  // the context data is about to be erased, so no thread can keep a pointer to it. Its handle is
+  // left so that GetCtx() behaves the same as before.
+  for(GLContextTLSData *tlsData : m_CtxDataVector)
+    if(tlsData->ctxPair.ctx == contextHandle)
+      tlsData->ctxData = NULL;
+}
+
 ////////////////////////////////////////////////////////////////
 // Windowing/setup/etc
 ////////////////////////////////////////////////////////////////
@@ -1152,6 +1167,7 @@ void WrappedOpenGL::DeleteContext(void *contextHandle)
     ctxdata.UnassociateWindow(this, wndHandle);
   }
 
+  ForgetCtxData(contextHandle);
   m_ContextData.erase(contextHandle);
 }
 
@@ -1306,6 +1322,7 @@ void WrappedOpenGL::UnregisterReplayContext(GLWindowingData windata)
     delete ctxdata.shareGroup;
   }
 
+  ForgetCtxData(contextHandle);
   m_ContextData.erase(contextHandle);
 }
 
@@ -1381,11 +1398,12 @@ void WrappedOpenGL::ActivateContext(GLWindowingData winData)
     {
       tlsData->ctxPair = {winData.ctx, GetShareGroup(winData.ctx)};
       tlsData->ctxRecord = ctxdata.m_ContextDataRecord;
+      tlsData->ctxData = &ctxdata;
     }
     else
     {
       tlsData = new GLContextTLSData(ContextPair({winData.ctx, GetShareGroup(winData.ctx)}),
-                                     ctxdata.m_ContextDataRecord);
+                                     ctxdata.m_ContextDataRecord, &ctxdata);
       m_CtxDataVector.push_back(tlsData);
 
       Threading::SetTLSValue(m_CurCtxDataTLS, tlsData);
@@ -2336,8 +2354,9 @@ bool WrappedOpenGL::EndFrameCapture(DeviceOwnedWindow devWnd)
     {
       SectionProperties props;
 
-      // Compress with LZ4 so that it's fast
-      props.flags = SectionFlags::LZ4Compressed;
+      // Compress with LZ4 so that it's fast, unless smaller captures have been asked for
+      props.flags =
+          Capture_ZstdFrameCapture() ? SectionFlags::ZstdCompressed : SectionFlags::LZ4Compressed;
       props.version = m_SectionVersion;
       props.type = SectionType::FrameCapture;
 
@@ -2350,6 +2369,8 @@ bool WrappedOpenGL::EndFrameCapture(DeviceOwnedWindow devWnd)
 
     uint64_t captureSectionSize = 0;
 
+    ChunkStatistics chunkStats;
+
     {
       WriteSerialiser ser(captureWriter, Ownership::Stream);
 
@@ -2431,6 +2452,7 @@ bool WrappedOpenGL::EndFrameCapture(DeviceOwnedWindow devWnd)
           RenderDoc::Inst().SetProgress(CaptureProgress::SerialiseFrameContents, idx / num);
           idx += 1.0f;
           it->second->Write(ser);
+          chunkStats.Add(it->second);
         }
 
         RDCDEBUG("Done");
@@ -2442,6 +2464,9 @@ bool WrappedOpenGL::EndFrameCapture(DeviceOwnedWindow devWnd)
     RDCLOG("Captured GL frame with %f MB capture section in %f seconds",
            double(captureSectionSize) / (1024.0 * 1024.0), m_CaptureTimer.GetMilliseconds() / 1000.0);
 
+    if(rdc)
+      chunkStats.Write(rdc, &GetChunkName);
+
     RenderDoc::Inst().FinishCaptureWriting(rdc, m_CapturedFrames.back().frameNumber);
 
     m_State = CaptureState::BackgroundCapturing;
@@ -3396,9 +3421,12 @@ RDResult WrappedOpenGL::ReadLogInitialisation(RDCFile *rdc, bool storeStructured
     return result;
   }
 
+  rdc->ReadCallstackTable(m_CallstackTable);
+
   ReadSerialiser ser(reader, Ownership::Stream);
 
   ser.SetStringDatabase(&m_StringDB);
+  ser.SetCallstackTable(&m_CallstackTable);
   ser.SetUserData(GetResourceManager());
 
   ser.ConfigureStructuredExport(&GetChunkName, storeStructuredBuffers, m_TimeBase, m_TimeFrequency);
@@ -5161,6 +5189,7 @@ RDResult WrappedOpenGL::ContextReplayLog(CaptureState readType, uint32_t startEv
   ReadSerialiser ser(m_FrameReader, Ownership::Nothing);
 
   ser.SetStringDatabase(&m_StringDB);
+  ser.SetCallstackTable(&m_CallstackTable);
   ser.SetUserData(GetResourceManager());
   ser.SetVersion(m_SectionVersion);
 
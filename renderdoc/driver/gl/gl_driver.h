@@ -26,6 +26,7 @@
 #pragma once
 
 #include "common/common.h"
+#include "common/temp_memory.h"
 #include "common/timing.h"
 #include "core/core.h"
 #include "driver/shaders/spirv/spirv_reflect.h"
@@ -178,6 +179,10 @@ private:
 
   WriteSerialiser m_ScratchSerialiser;
   std::set<rdcstr> m_StringDB;
+  CallstackTable m_CallstackTable;
+
+  // scratch memory for arrays of names built up on replay
+  ThreadTempMemory m_TempMemory;
 
   StreamReader *m_FrameReader = NULL;
 
@@ -371,6 +376,8 @@ private:
   bool Serialise_ContextConfiguration(SerialiserType &ser, void *ctx);
 
   void CleanupResourceRecord(GLResourceRecord *record, bool freeParents);
+  void RecordBufferSubData(GLResourceRecord *record, GLuint buffer, GLintptr offset,
+                           GLsizeiptr size, const void *data);
   void CleanupCapture();
   void FreeCaptureData();
 
@@ -474,6 +481,17 @@ private:
     GLint m_MaxAtomicBind = 0;
     GLint m_MaxSSBOBind = 0;
 
+    // the last buffer upload recorded on this context while capturing a frame. Uploads to the same
+    // buffer straight after it are merged into its chunk, see RecordBufferSubData
+    struct BufferUpload
+    {
+      Chunk *chunk = NULL;
+      int64_t chunkID = 0;
+      ResourceId buffer;
+      uint64_t offset = 0;
+      bytebuf data;
+    } m_LastBufferUpload;
+
     GLResourceRecord *GetActiveTexRecord(GLenum target)
     {
       if(IsProxyTarget(target))
@@ -550,6 +568,7 @@ private:
   std::map<void *, ContextData> m_ContextData;
 
   ContextData &GetCtxData();
+  void ForgetCtxData(void *contextHandle);
   GLuint GetUniformProgram();
 
   GLWindowingData *MakeValidContextCurrent(GLWindowingData existing, GLWindowingData &newContext);
@@ -749,6 +768,10 @@ public:
 
     std::map<GLint, GLint> locationTranslate;
 
+    // cached layout for restoring uniforms from the initial contents program. Invalidated whenever
+    // the program is re-linked since locations may change
+    ProgramUniformLayout initialUniformLayout;
+
     // this flag indicates the program was created with glCreateShaderProgram and cannot be relinked
     // again (because that function implicitly detaches and destroys the shader). However we only
     // need to relink when restoring things like frag data or attrib bindings which must be relinked
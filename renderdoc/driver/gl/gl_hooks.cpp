@@ -88,14 +88,15 @@ int ScopedPrinter::depth = 0;
 // This checks that we're not infinite looping by calling our own hooks from ourselves. Mostly
 // useful on android where you can only debug by printf and the stack dumps are often corrupted when
 // the callstack overflows.
-#define SCOPED_GLCALL(funcname)           \
-  SCOPED_LOCK(glLock);                    \
-  gl_CurChunk = GLChunk::funcname;        \
-  if(glhook.enabled)                      \
-  {                                       \
-    glhook.driver->CheckImplicitThread(); \
-  }                                       \
-  ScopedPrinter CONCAT(scopedprint, __LINE__)(STRINGIZE(funcname));
+#define SCOPED_GLCALL(funcname)                                     \
+  SCOPED_LOCK(glLock);                                              \
+  gl_CurChunk = GLChunk::funcname;                                  \
+  if(glhook.enabled)                                                \
+  {                                                                 \
+    glhook.driver->CheckImplicitThread();                           \
+  }                                                                 \
+  ScopedPrinter CONCAT(scopedprint, __LINE__)(STRINGIZE(funcname)); \
+  SCOPED_API_OVERHEAD(STRINGIZE(funcname));
 
 #else
 
@@ -105,7 +106,8 @@ int ScopedPrinter::depth = 0;
   if(glhook.enabled)                      \
   {                                       \
     glhook.driver->CheckImplicitThread(); \
-  }
+  }                                       \
+  SCOPED_API_OVERHEAD(STRINGIZE(funcname));
 
 #endif
 
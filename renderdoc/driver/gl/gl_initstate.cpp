@@ -1640,6 +1640,74 @@ bool GLResourceManager::Serialise_InitialState(SerialiserType &ser, ResourceId i
           // to avoid repeated new/free.
           byte *scratchBuf = AllocAlignedBuffer(size);
 
+          // on desktop GL when writing, read back every subresource into one pixel pack buffer up
+          // front and map it once. That way the copies are queued back-to-back and we only wait
+          // once per texture, instead of a full sync on every glGetTexImage. GLES emulates
+          // glGetTexImage and keeps compressed data on the CPU, so it uses the direct path.
+          GLuint readbackBuf = 0;
+          byte *readbackData = NULL;
+          uint64_t readbackOffs = 0;
+
+          if(ser.IsWriting() && !IsGLES)
+          {
+            rdcarray<uint64_t> readbackSizes;
+
+            for(int i = 0; i < TextureState.mips; i++)
+            {
+              uint32_t w = RDCMAX(TextureState.width >> i, 1U);
+              uint32_t h = RDCMAX(TextureState.height >> i, 1U);
+              uint32_t d = RDCMAX(TextureState.depth >> i, 1U);
+
+              if(targets[0] == eGL_TEXTURE_CUBE_MAP_ARRAY || targets[0] == eGL_TEXTURE_2D_ARRAY)
+                d = copySlices;
+
+              if(targets[0] == eGL_TEXTURE_1D_ARRAY)
+                h = TextureState.height;
+
+              if(isCompressed)
+                readbackSizes.push_back(
+                    (uint64_t)GetCompressedByteSize(w, h, d, TextureState.internalformat));
+              else
+                readbackSizes.push_back((uint64_t)GetByteSize(w, h, d, fmt, type));
+            }
+
+            uint64_t totalSize = 0;
+            for(uint64_t s : readbackSizes)
+              totalSize += s * targetcount;
+
+            GL.glGenBuffers(1, &readbackBuf);
+            GL.glBindBuffer(eGL_PIXEL_PACK_BUFFER, readbackBuf);
+            GL.glBufferData(eGL_PIXEL_PACK_BUFFER, (GLsizeiptr)totalSize, NULL, eGL_STREAM_READ);
+
+            uint64_t offs = 0;
+            for(int i = 0; i < TextureState.mips; i++)
+            {
+              for(int trg = 0; trg < targetcount; trg++)
+              {
+                void *dst = (void *)(uintptr_t)offs;
+
+                if(isCompressed)
+                  GL.glGetCompressedTextureImageEXT(tex, targets[trg], i, dst);
+                else
+                  GL.glGetTexImage(targets[trg], i, fmt, type, dst);
+
+                offs += readbackSizes[i];
+              }
+            }
+
+            readbackData = (byte *)GL.glMapBufferRange(eGL_PIXEL_PACK_BUFFER, 0,
+                                                       (GLsizeiptr)totalSize, eGL_MAP_READ_BIT);
+
+            GL.glBindBuffer(eGL_PIXEL_PACK_BUFFER, 0);
+
+            if(!readbackData)
+            {
+              RDCERR("Couldn't map texture readback buffer, falling back to direct readback");
+              GL.glDeleteBuffers(1, &readbackBuf);
+              readbackBuf = 0;
+            }
+          }
+
           // loop over all the available mips
           for(int i = 0; i < TextureState.mips; i++)
           {
@@ -1663,7 +1731,12 @@ bool GLResourceManager::Serialise_InitialState(SerialiserType &ser, ResourceId i
             for(int trg = 0; trg < targetcount; trg++)
             {
               // when writing, fetch the source data out of the texture
-              if(ser.IsWriting())
+              if(ser.IsWriting() && readbackData)
+              {
+                memcpy(scratchBuf, readbackData + readbackOffs, (size_t)size);
+                readbackOffs += size;
+              }
+              else if(ser.IsWriting())
               {
                 if(isCompressed)
                 {
@@ -1725,6 +1798,14 @@ bool GLResourceManager::Serialise_InitialState(SerialiserType &ser, ResourceId i
             }
           }
 
+          if(readbackBuf)
+          {
+            GL.glBindBuffer(eGL_PIXEL_PACK_BUFFER, readbackBuf);
+            GL.glUnmapBuffer(eGL_PIXEL_PACK_BUFFER);
+            GL.glBindBuffer(eGL_PIXEL_PACK_BUFFER, 0);
+            GL.glDeleteBuffers(1, &readbackBuf);
+          }
+
           // free our scratch buffer
           FreeAlignedBuffer(scratchBuf);
         }
@@ -2224,7 +2305,7 @@ void GLResourceManager::Apply_InitialState(GLResource live, const GLInitialConte
   {
     ResourceId Id = GetID(live);
 
-    const WrappedOpenGL::ProgramData &prog = m_Driver->m_Programs[Id];
+    WrappedOpenGL::ProgramData &prog = m_Driver->m_Programs[Id];
 
     bool changedBindings = false;
 
@@ -2239,14 +2320,25 @@ void GLResourceManager::Apply_InitialState(GLResource live, const GLInitialConte
     // we need to re-link the program to apply the bindings, as long as it's linkable.
     // See the comment on shaderProgramUnlinkable for more information.
     if(!prog.shaderProgramUnlinkable && changedBindings)
+    {
       GL.glLinkProgram(live.name);
+      prog.initialUniformLayout.valid = false;
+    }
 
-    PerStageReflections stages;
-    m_Driver->FillReflectionArray(Id, stages);
+    if(prog.initialUniformLayout.valid)
+    {
+      CopyProgramUniforms(prog.initialUniformLayout, initial.resource.name, live.name);
+    }
+    else
+    {
+      PerStageReflections stages;
+      m_Driver->FillReflectionArray(Id, stages);
 
-    // we can pass in the same stages array, it's the same program essentially (reflection is
-    // identical)
-    CopyProgramUniforms(stages, initial.resource.name, stages, live.name);
+      // we can pass in the same stages array, it's the same program essentially (reflection is
+      // identical). The layout is cached so that subsequent applies are much cheaper
+      CopyProgramUniforms(stages, initial.resource.name, stages, live.name, NULL,
+                          &prog.initialUniformLayout);
+    }
   }
   else if(live.Namespace == eResFramebuffer)
   {
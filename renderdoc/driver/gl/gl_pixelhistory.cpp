@@ -2173,3 +2173,11 @@ rdcarray<PixelModification> GLReplay::PixelHistory(rdcarray<EventUsage> events,
   m_pDriver->ReplayMarkers(true);
   return history;
 }
+
+PixelRegionHistory GLReplay::PixelHistoryRegion(rdcarray<EventUsage> events, ResourceId target,
+                                                uint32_t x, uint32_t y, uint32_t width,
+                                                uint32_t height, const Subresource &sub,
+                                                CompType typeCast)
+{
+  return StandardPixelHistoryRegion(this, events, target, x, y, width, height, sub, typeCast);
+}
@@ -195,27 +195,78 @@ static GLuint RecompileShader(WrappedOpenGL &drv, const WrappedOpenGL::ShaderDat
   return ret;
 }
 
-void GLReplay::ClearPostVSCache()
+void GLReplay::ReleasePostVSData(GLPostVSData &data)
 {
   WrappedOpenGL &drv = *m_pDriver;
 
+  drv.glDeleteBuffers(1, &data.vsout.buf);
+  drv.glDeleteBuffers(1, &data.vsout.idxBuf);
+  drv.glDeleteBuffers(1, &data.gsout.buf);
+  drv.glDeleteBuffers(1, &data.gsout.idxBuf);
+}
+
+void GLReplay::ClearPostVSCache()
+{
   for(auto it = m_PostVSData.begin(); it != m_PostVSData.end(); ++it)
+    ReleasePostVSData(it->second);
+
+  m_PostVSData.clear();
+  m_PostVSCache.Clear();
+}
+
+void GLReplay::TrimPostVSCache(const rdcarray<uint32_t> &keep)
+{
+  WrappedOpenGL &drv = *m_pDriver;
+
+  MakeCurrentReplayContext(&m_ReplayCtx);
+
+  for(uint32_t eventId : m_PostVSCache.GetUnsizedEvents())
   {
-    drv.glDeleteBuffers(1, &it->second.vsout.buf);
-    drv.glDeleteBuffers(1, &it->second.vsout.idxBuf);
-    drv.glDeleteBuffers(1, &it->second.gsout.buf);
-    drv.glDeleteBuffers(1, &it->second.gsout.idxBuf);
+    const GLPostVSData &data = m_PostVSData[eventId];
+
+    uint64_t size = 0;
+    for(GLuint buf : {data.vsout.buf, data.vsout.idxBuf, data.gsout.buf, data.gsout.idxBuf})
+    {
+      if(buf == 0)
+        continue;
+
+      GLint bufSize = 0;
+      drv.glGetNamedBufferParameterivEXT(buf, eGL_BUFFER_SIZE, &bufSize);
+      size += (uint64_t)bufSize;
+    }
+
+    m_PostVSCache.SetSize(eventId, size);
   }
 
-  m_PostVSData.clear();
+  for(uint32_t eventId : m_PostVSCache.Trim(keep))
+  {
+    ReleasePostVSData(m_PostVSData[eventId]);
+    m_PostVSData.erase(eventId);
+  }
+}
+
+PostVSCacheStatistics GLReplay::GetPostVSCacheStatistics()
+{
+  return m_PostVSCache.GetStatistics();
 }
 
 void GLReplay::InitPostVSBuffers(uint32_t eventId)
+{
+  TrimPostVSCache({eventId});
+
+  FetchPostVSData(eventId);
+}
+
+void GLReplay::FetchPostVSData(uint32_t eventId)
 {
   if(m_PostVSData.find(eventId) != m_PostVSData.end())
+  {
+    m_PostVSCache.Touch(eventId);
     return;
+  }
 
   GLPostVSData &ret = m_PostVSData[eventId];
+  m_PostVSCache.Add(eventId);
 
   if(m_pDriver->IsUnsafeDraw(eventId))
   {
@@ -1952,10 +2003,12 @@ void GLReplay::InitPostVSBuffers(uint32_t eventId)
 
 void GLReplay::InitPostVSBuffers(const rdcarray<uint32_t> &passEvents)
 {
+  TrimPostVSCache(passEvents);
+
   uint32_t prev = 0;
 
   // since we can always replay between drawcalls, just loop through all the events
-  // doing partial replays and calling InitPostVSBuffers for each
+  // doing partial replays and fetching the data for each
   for(size_t i = 0; i < passEvents.size(); i++)
   {
     if(prev != passEvents[i])
@@ -1969,7 +2022,7 @@ void GLReplay::InitPostVSBuffers(const rdcarray<uint32_t> &passEvents)
     const ActionDescription *d = m_pDriver->GetAction(passEvents[i]);
 
     if(d)
-      InitPostVSBuffers(passEvents[i]);
+      FetchPostVSData(passEvents[i]);
   }
 }
 
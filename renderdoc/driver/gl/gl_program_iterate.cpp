@@ -326,6 +326,313 @@ static void UnrollConstants(const PerStageReflections &stages,
   }
 }
 
+// the size in bytes of one element of a loose uniform, as fetched by glGetUniform*
+static uint32_t UniformValueSize(GLenum type)
+{
+  switch(type)
+  {
+    case eGL_FLOAT_MAT4: return 16 * sizeof(float);
+    case eGL_FLOAT_MAT4x3:
+    case eGL_FLOAT_MAT3x4: return 12 * sizeof(float);
+    case eGL_FLOAT_MAT3: return 9 * sizeof(float);
+    case eGL_FLOAT_MAT4x2:
+    case eGL_FLOAT_MAT2x4: return 8 * sizeof(float);
+    case eGL_FLOAT_MAT3x2:
+    case eGL_FLOAT_MAT2x3: return 6 * sizeof(float);
+    case eGL_DOUBLE_MAT4: return 16 * sizeof(double);
+    case eGL_DOUBLE_MAT4x3:
+    case eGL_DOUBLE_MAT3x4: return 12 * sizeof(double);
+    case eGL_DOUBLE_MAT3: return 9 * sizeof(double);
+    case eGL_DOUBLE_MAT4x2:
+    case eGL_DOUBLE_MAT2x4: return 8 * sizeof(double);
+    case eGL_DOUBLE_MAT3x2:
+    case eGL_DOUBLE_MAT2x3: return 6 * sizeof(double);
+    case eGL_DOUBLE_MAT2:
+    case eGL_DOUBLE_VEC4: return 4 * sizeof(double);
+    case eGL_DOUBLE_VEC3: return 3 * sizeof(double);
+    case eGL_DOUBLE_VEC2: return 2 * sizeof(double);
+    case eGL_DOUBLE: return sizeof(double);
+    case eGL_FLOAT_MAT2:
+    case eGL_FLOAT_VEC4:
+    case eGL_INT_VEC4:
+    case eGL_UNSIGNED_INT_VEC4:
+    case eGL_BOOL_VEC4: return 4 * sizeof(uint32_t);
+    case eGL_FLOAT_VEC3:
+    case eGL_INT_VEC3:
+    case eGL_UNSIGNED_INT_VEC3:
+    case eGL_BOOL_VEC3: return 3 * sizeof(uint32_t);
+    case eGL_FLOAT_VEC2:
+    case eGL_INT_VEC2:
+    case eGL_UNSIGNED_INT_VEC2:
+    case eGL_BOOL_VEC2: return 2 * sizeof(uint32_t);
+    // scalars, and samplers/images which are just an int
+    default: return sizeof(uint32_t);
+  }
+}
+
+// fetch a single uniform value with the appropriate method for its type
+static void FetchUniformValue(GLuint prog, GLenum type, GLint location, void *data)
+{
+  double *dv = (double *)data;
+  float *fv = (float *)data;
+  int32_t *iv = (int32_t *)data;
+  uint32_t *uiv = (uint32_t *)data;
+
+  switch(type)
+  {
+    case eGL_FLOAT_MAT4:
+    case eGL_FLOAT_MAT4x3:
+    case eGL_FLOAT_MAT4x2:
+    case eGL_FLOAT_MAT3:
+    case eGL_FLOAT_MAT3x4:
+    case eGL_FLOAT_MAT3x2:
+    case eGL_FLOAT_MAT2:
+    case eGL_FLOAT_MAT2x4:
+    case eGL_FLOAT_MAT2x3:
+    case eGL_FLOAT:
+    case eGL_FLOAT_VEC2:
+    case eGL_FLOAT_VEC3:
+    case eGL_FLOAT_VEC4: GL.glGetUniformfv(prog, location, fv); break;
+    case eGL_DOUBLE_MAT4:
+    case eGL_DOUBLE_MAT4x3:
+    case eGL_DOUBLE_MAT4x2:
+    case eGL_DOUBLE_MAT3:
+    case eGL_DOUBLE_MAT3x4:
+    case eGL_DOUBLE_MAT3x2:
+    case eGL_DOUBLE_MAT2:
+    case eGL_DOUBLE_MAT2x4:
+    case eGL_DOUBLE_MAT2x3:
+    case eGL_DOUBLE:
+    case eGL_DOUBLE_VEC2:
+    case eGL_DOUBLE_VEC3:
+    case eGL_DOUBLE_VEC4: GL.glGetUniformdv(prog, location, dv); break;
+
+    // treat all samplers as just an int (since they just store their binding value)
+    case eGL_SAMPLER_1D:
+    case eGL_SAMPLER_2D:
+    case eGL_SAMPLER_3D:
+    case eGL_SAMPLER_CUBE:
+    case eGL_SAMPLER_CUBE_MAP_ARRAY:
+    case eGL_SAMPLER_1D_SHADOW:
+    case eGL_SAMPLER_2D_SHADOW:
+    case eGL_SAMPLER_1D_ARRAY:
+    case eGL_SAMPLER_2D_ARRAY:
+    case eGL_SAMPLER_1D_ARRAY_SHADOW:
+    case eGL_SAMPLER_2D_ARRAY_SHADOW:
+    case eGL_SAMPLER_2D_MULTISAMPLE:
+    case eGL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case eGL_SAMPLER_CUBE_SHADOW:
+    case eGL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
+    case eGL_SAMPLER_BUFFER:
+    case eGL_SAMPLER_2D_RECT:
+    case eGL_SAMPLER_2D_RECT_SHADOW:
+    case eGL_INT_SAMPLER_1D:
+    case eGL_INT_SAMPLER_2D:
+    case eGL_INT_SAMPLER_3D:
+    case eGL_INT_SAMPLER_CUBE:
+    case eGL_INT_SAMPLER_CUBE_MAP_ARRAY:
+    case eGL_INT_SAMPLER_1D_ARRAY:
+    case eGL_INT_SAMPLER_2D_ARRAY:
+    case eGL_INT_SAMPLER_2D_MULTISAMPLE:
+    case eGL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case eGL_INT_SAMPLER_BUFFER:
+    case eGL_INT_SAMPLER_2D_RECT:
+    case eGL_UNSIGNED_INT_SAMPLER_1D:
+    case eGL_UNSIGNED_INT_SAMPLER_2D:
+    case eGL_UNSIGNED_INT_SAMPLER_3D:
+    case eGL_UNSIGNED_INT_SAMPLER_CUBE:
+    case eGL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY:
+    case eGL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+    case eGL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+    case eGL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+    case eGL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case eGL_UNSIGNED_INT_SAMPLER_BUFFER:
+    case eGL_UNSIGNED_INT_SAMPLER_2D_RECT:
+    case eGL_IMAGE_1D:
+    case eGL_IMAGE_2D:
+    case eGL_IMAGE_3D:
+    case eGL_IMAGE_2D_RECT:
+    case eGL_IMAGE_CUBE:
+    case eGL_IMAGE_BUFFER:
+    case eGL_IMAGE_1D_ARRAY:
+    case eGL_IMAGE_2D_ARRAY:
+    case eGL_IMAGE_CUBE_MAP_ARRAY:
+    case eGL_IMAGE_2D_MULTISAMPLE:
+    case eGL_IMAGE_2D_MULTISAMPLE_ARRAY:
+    case eGL_INT_IMAGE_1D:
+    case eGL_INT_IMAGE_2D:
+    case eGL_INT_IMAGE_3D:
+    case eGL_INT_IMAGE_2D_RECT:
+    case eGL_INT_IMAGE_CUBE:
+    case eGL_INT_IMAGE_BUFFER:
+    case eGL_INT_IMAGE_1D_ARRAY:
+    case eGL_INT_IMAGE_2D_ARRAY:
+    case eGL_INT_IMAGE_2D_MULTISAMPLE:
+    case eGL_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
+    case eGL_UNSIGNED_INT_IMAGE_1D:
+    case eGL_UNSIGNED_INT_IMAGE_2D:
+    case eGL_UNSIGNED_INT_IMAGE_3D:
+    case eGL_UNSIGNED_INT_IMAGE_2D_RECT:
+    case eGL_UNSIGNED_INT_IMAGE_CUBE:
+    case eGL_UNSIGNED_INT_IMAGE_BUFFER:
+    case eGL_UNSIGNED_INT_IMAGE_1D_ARRAY:
+    case eGL_UNSIGNED_INT_IMAGE_2D_ARRAY:
+    case eGL_UNSIGNED_INT_IMAGE_CUBE_MAP_ARRAY:
+    case eGL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE:
+    case eGL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
+    case eGL_INT:
+    case eGL_INT_VEC2:
+    case eGL_INT_VEC3:
+    case eGL_INT_VEC4: GL.glGetUniformiv(prog, location, iv); break;
+    // bools are unsigned integers
+    case eGL_UNSIGNED_INT:
+    case eGL_BOOL:
+    case eGL_UNSIGNED_INT_VEC2:
+    case eGL_BOOL_VEC2:
+    case eGL_UNSIGNED_INT_VEC3:
+    case eGL_BOOL_VEC3:
+    case eGL_UNSIGNED_INT_VEC4:
+    case eGL_BOOL_VEC4: GL.glGetUniformuiv(prog, location, uiv); break;
+    default: RDCERR("Unhandled uniform type '%s'", ToStr(type).c_str());
+  }
+}
+
+// apply count consecutive array elements of a uniform with the appropriate method for its type.
+// The data is tightly packed, each element being UniformValueSize(type) bytes
+static void ApplyUniformValues(GLuint prog, GLenum type, GLint location, GLsizei count,
+                               const void *data, bool spirv)
+{
+  const double *dv = (const double *)data;
+  const float *fv = (const float *)data;
+  const int32_t *iv = (const int32_t *)data;
+  const uint32_t *uiv = (const uint32_t *)data;
+
+  switch(type)
+  {
+    case eGL_FLOAT_MAT4: GL.glProgramUniformMatrix4fv(prog, location, count, false, fv); break;
+    case eGL_FLOAT_MAT4x3: GL.glProgramUniformMatrix4x3fv(prog, location, count, false, fv); break;
+    case eGL_FLOAT_MAT4x2: GL.glProgramUniformMatrix4x2fv(prog, location, count, false, fv); break;
+    case eGL_FLOAT_MAT3: GL.glProgramUniformMatrix3fv(prog, location, count, false, fv); break;
+    case eGL_FLOAT_MAT3x4: GL.glProgramUniformMatrix3x4fv(prog, location, count, false, fv); break;
+    case eGL_FLOAT_MAT3x2: GL.glProgramUniformMatrix3x2fv(prog, location, count, false, fv); break;
+    case eGL_FLOAT_MAT2: GL.glProgramUniformMatrix2fv(prog, location, count, false, fv); break;
+    case eGL_FLOAT_MAT2x4: GL.glProgramUniformMatrix2x4fv(prog, location, count, false, fv); break;
+    case eGL_FLOAT_MAT2x3: GL.glProgramUniformMatrix2x3fv(prog, location, count, false, fv); break;
+    case eGL_DOUBLE_MAT4: GL.glProgramUniformMatrix4dv(prog, location, count, false, dv); break;
+    case eGL_DOUBLE_MAT4x3: GL.glProgramUniformMatrix4x3dv(prog, location, count, false, dv); break;
+    case eGL_DOUBLE_MAT4x2: GL.glProgramUniformMatrix4x2dv(prog, location, count, false, dv); break;
+    case eGL_DOUBLE_MAT3: GL.glProgramUniformMatrix3dv(prog, location, count, false, dv); break;
+    case eGL_DOUBLE_MAT3x4: GL.glProgramUniformMatrix3x4dv(prog, location, count, false, dv); break;
+    case eGL_DOUBLE_MAT3x2: GL.glProgramUniformMatrix3x2dv(prog, location, count, false, dv); break;
+    case eGL_DOUBLE_MAT2: GL.glProgramUniformMatrix2dv(prog, location, count, false, dv); break;
+    case eGL_DOUBLE_MAT2x4: GL.glProgramUniformMatrix2x4dv(prog, location, count, false, dv); break;
+    case eGL_DOUBLE_MAT2x3: GL.glProgramUniformMatrix2x3dv(prog, location, count, false, dv); break;
+    case eGL_FLOAT: GL.glProgramUniform1fv(prog, location, count, fv); break;
+    case eGL_FLOAT_VEC2: GL.glProgramUniform2fv(prog, location, count, fv); break;
+    case eGL_FLOAT_VEC3: GL.glProgramUniform3fv(prog, location, count, fv); break;
+    case eGL_FLOAT_VEC4: GL.glProgramUniform4fv(prog, location, count, fv); break;
+    case eGL_DOUBLE: GL.glProgramUniform1dv(prog, location, count, dv); break;
+    case eGL_DOUBLE_VEC2: GL.glProgramUniform2dv(prog, location, count, dv); break;
+    case eGL_DOUBLE_VEC3: GL.glProgramUniform3dv(prog, location, count, dv); break;
+    case eGL_DOUBLE_VEC4: GL.glProgramUniform4dv(prog, location, count, dv); break;
+    case eGL_INT: GL.glProgramUniform1iv(prog, location, count, iv); break;
+    case eGL_INT_VEC2: GL.glProgramUniform2iv(prog, location, count, iv); break;
+    case eGL_INT_VEC3: GL.glProgramUniform3iv(prog, location, count, iv); break;
+    case eGL_INT_VEC4: GL.glProgramUniform4iv(prog, location, count, iv); break;
+    case eGL_UNSIGNED_INT:
+    case eGL_BOOL: GL.glProgramUniform1uiv(prog, location, count, uiv); break;
+    case eGL_UNSIGNED_INT_VEC2:
+    case eGL_BOOL_VEC2: GL.glProgramUniform2uiv(prog, location, count, uiv); break;
+    case eGL_UNSIGNED_INT_VEC3:
+    case eGL_BOOL_VEC3: GL.glProgramUniform3uiv(prog, location, count, uiv); break;
+    case eGL_UNSIGNED_INT_VEC4:
+    case eGL_BOOL_VEC4: GL.glProgramUniform4uiv(prog, location, count, uiv); break;
+
+    case eGL_IMAGE_1D:
+    case eGL_IMAGE_2D:
+    case eGL_IMAGE_3D:
+    case eGL_IMAGE_2D_RECT:
+    case eGL_IMAGE_CUBE:
+    case eGL_IMAGE_BUFFER:
+    case eGL_IMAGE_1D_ARRAY:
+    case eGL_IMAGE_2D_ARRAY:
+    case eGL_IMAGE_CUBE_MAP_ARRAY:
+    case eGL_IMAGE_2D_MULTISAMPLE:
+    case eGL_IMAGE_2D_MULTISAMPLE_ARRAY:
+    case eGL_INT_IMAGE_1D:
+    case eGL_INT_IMAGE_2D:
+    case eGL_INT_IMAGE_3D:
+    case eGL_INT_IMAGE_2D_RECT:
+    case eGL_INT_IMAGE_CUBE:
+    case eGL_INT_IMAGE_BUFFER:
+    case eGL_INT_IMAGE_1D_ARRAY:
+    case eGL_INT_IMAGE_2D_ARRAY:
+    case eGL_INT_IMAGE_2D_MULTISAMPLE:
+    case eGL_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
+    case eGL_UNSIGNED_INT_IMAGE_1D:
+    case eGL_UNSIGNED_INT_IMAGE_2D:
+    case eGL_UNSIGNED_INT_IMAGE_3D:
+    case eGL_UNSIGNED_INT_IMAGE_2D_RECT:
+    case eGL_UNSIGNED_INT_IMAGE_CUBE:
+    case eGL_UNSIGNED_INT_IMAGE_BUFFER:
+    case eGL_UNSIGNED_INT_IMAGE_1D_ARRAY:
+    case eGL_UNSIGNED_INT_IMAGE_2D_ARRAY:
+    case eGL_UNSIGNED_INT_IMAGE_CUBE_MAP_ARRAY:
+    case eGL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE:
+    case eGL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
+    case eGL_UNSIGNED_INT_ATOMIC_COUNTER:
+      if(IsGLES || spirv)
+        // Image uniforms cannot be re-assigned in GLES or with SPIR-V programs.
+        break;
+      DELIBERATE_FALLTHROUGH();
+    // treat all samplers as just an int (since they just store their binding value)
+    case eGL_SAMPLER_1D:
+    case eGL_SAMPLER_2D:
+    case eGL_SAMPLER_3D:
+    case eGL_SAMPLER_CUBE:
+    case eGL_SAMPLER_CUBE_MAP_ARRAY:
+    case eGL_SAMPLER_1D_SHADOW:
+    case eGL_SAMPLER_2D_SHADOW:
+    case eGL_SAMPLER_1D_ARRAY:
+    case eGL_SAMPLER_2D_ARRAY:
+    case eGL_SAMPLER_1D_ARRAY_SHADOW:
+    case eGL_SAMPLER_2D_ARRAY_SHADOW:
+    case eGL_SAMPLER_2D_MULTISAMPLE:
+    case eGL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case eGL_SAMPLER_CUBE_SHADOW:
+    case eGL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
+    case eGL_SAMPLER_BUFFER:
+    case eGL_SAMPLER_2D_RECT:
+    case eGL_SAMPLER_2D_RECT_SHADOW:
+    case eGL_INT_SAMPLER_1D:
+    case eGL_INT_SAMPLER_2D:
+    case eGL_INT_SAMPLER_3D:
+    case eGL_INT_SAMPLER_CUBE:
+    case eGL_INT_SAMPLER_CUBE_MAP_ARRAY:
+    case eGL_INT_SAMPLER_1D_ARRAY:
+    case eGL_INT_SAMPLER_2D_ARRAY:
+    case eGL_INT_SAMPLER_2D_MULTISAMPLE:
+    case eGL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case eGL_INT_SAMPLER_BUFFER:
+    case eGL_INT_SAMPLER_2D_RECT:
+    case eGL_UNSIGNED_INT_SAMPLER_1D:
+    case eGL_UNSIGNED_INT_SAMPLER_2D:
+    case eGL_UNSIGNED_INT_SAMPLER_3D:
+    case eGL_UNSIGNED_INT_SAMPLER_CUBE:
+    case eGL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY:
+    case eGL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+    case eGL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+    case eGL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+    case eGL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case eGL_UNSIGNED_INT_SAMPLER_BUFFER:
+    case eGL_UNSIGNED_INT_SAMPLER_2D_RECT:
+      if(!spirv)    // SPIR-V shaders treat samplers as immutable
+        GL.glProgramUniform1iv(prog, location, count, iv);
+      break;
+    default: RDCERR("Unhandled uniform type '%s'", ToStr(type).c_str());
+  }
+}
+
 template <typename SerialiserType>
 void DoSerialise(SerialiserType &ser, ProgramUniformValue &el)
 {
@@ -556,7 +863,8 @@ template <const bool CopyUniforms, const bool SerialiseUniforms, typename Serial
 static void ForAllProgramUniforms(SerialiserType *ser, CaptureState state,
                                   const PerStageReflections &srcStages, GLuint progSrc,
                                   const PerStageReflections &dstStages, GLuint progDst,
-                                  std::map<GLint, GLint> *locTranslate)
+                                  std::map<GLint, GLint> *locTranslate,
+                                  ProgramUniformLayout *layout)
 {
   const bool ReadSourceProgram = CopyUniforms || (SerialiseUniforms && ser && ser->IsWriting());
   const bool WriteDestProgram = CopyUniforms || (SerialiseUniforms && ser && ser->IsReading());
@@ -725,133 +1033,7 @@ static void ForAllProgramUniforms(SerialiserType *ser, CaptureState state,
         if(srcLocation == -1)
           continue;
 
-        // fetch the data into the ProgramUniformValue, with the appropriate method for its type
-        double *dv = uniformVal.data.dval;
-        float *fv = uniformVal.data.fval;
-        int32_t *iv = uniformVal.data.ival;
-        uint32_t *uiv = uniformVal.data.uval;
-
-        switch(type)
-        {
-          case eGL_FLOAT_MAT4:
-          case eGL_FLOAT_MAT4x3:
-          case eGL_FLOAT_MAT4x2:
-          case eGL_FLOAT_MAT3:
-          case eGL_FLOAT_MAT3x4:
-          case eGL_FLOAT_MAT3x2:
-          case eGL_FLOAT_MAT2:
-          case eGL_FLOAT_MAT2x4:
-          case eGL_FLOAT_MAT2x3:
-          case eGL_FLOAT:
-          case eGL_FLOAT_VEC2:
-          case eGL_FLOAT_VEC3:
-          case eGL_FLOAT_VEC4: GL.glGetUniformfv(progSrc, srcLocation, fv); break;
-          case eGL_DOUBLE_MAT4:
-          case eGL_DOUBLE_MAT4x3:
-          case eGL_DOUBLE_MAT4x2:
-          case eGL_DOUBLE_MAT3:
-          case eGL_DOUBLE_MAT3x4:
-          case eGL_DOUBLE_MAT3x2:
-          case eGL_DOUBLE_MAT2:
-          case eGL_DOUBLE_MAT2x4:
-          case eGL_DOUBLE_MAT2x3:
-          case eGL_DOUBLE:
-          case eGL_DOUBLE_VEC2:
-          case eGL_DOUBLE_VEC3:
-          case eGL_DOUBLE_VEC4:
-            GL.glGetUniformdv(progSrc, srcLocation, dv);
-            break;
-
-          // treat all samplers as just an int (since they just store their binding value)
-          case eGL_SAMPLER_1D:
-          case eGL_SAMPLER_2D:
-          case eGL_SAMPLER_3D:
-          case eGL_SAMPLER_CUBE:
-          case eGL_SAMPLER_CUBE_MAP_ARRAY:
-          case eGL_SAMPLER_1D_SHADOW:
-          case eGL_SAMPLER_2D_SHADOW:
-          case eGL_SAMPLER_1D_ARRAY:
-          case eGL_SAMPLER_2D_ARRAY:
-          case eGL_SAMPLER_1D_ARRAY_SHADOW:
-          case eGL_SAMPLER_2D_ARRAY_SHADOW:
-          case eGL_SAMPLER_2D_MULTISAMPLE:
-          case eGL_SAMPLER_2D_MULTISAMPLE_ARRAY:
-          case eGL_SAMPLER_CUBE_SHADOW:
-          case eGL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
-          case eGL_SAMPLER_BUFFER:
-          case eGL_SAMPLER_2D_RECT:
-          case eGL_SAMPLER_2D_RECT_SHADOW:
-          case eGL_INT_SAMPLER_1D:
-          case eGL_INT_SAMPLER_2D:
-          case eGL_INT_SAMPLER_3D:
-          case eGL_INT_SAMPLER_CUBE:
-          case eGL_INT_SAMPLER_CUBE_MAP_ARRAY:
-          case eGL_INT_SAMPLER_1D_ARRAY:
-          case eGL_INT_SAMPLER_2D_ARRAY:
-          case eGL_INT_SAMPLER_2D_MULTISAMPLE:
-          case eGL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
-          case eGL_INT_SAMPLER_BUFFER:
-          case eGL_INT_SAMPLER_2D_RECT:
-          case eGL_UNSIGNED_INT_SAMPLER_1D:
-          case eGL_UNSIGNED_INT_SAMPLER_2D:
-          case eGL_UNSIGNED_INT_SAMPLER_3D:
-          case eGL_UNSIGNED_INT_SAMPLER_CUBE:
-          case eGL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY:
-          case eGL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
-          case eGL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
-          case eGL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
-          case eGL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
-          case eGL_UNSIGNED_INT_SAMPLER_BUFFER:
-          case eGL_UNSIGNED_INT_SAMPLER_2D_RECT:
-          case eGL_IMAGE_1D:
-          case eGL_IMAGE_2D:
-          case eGL_IMAGE_3D:
-          case eGL_IMAGE_2D_RECT:
-          case eGL_IMAGE_CUBE:
-          case eGL_IMAGE_BUFFER:
-          case eGL_IMAGE_1D_ARRAY:
-          case eGL_IMAGE_2D_ARRAY:
-          case eGL_IMAGE_CUBE_MAP_ARRAY:
-          case eGL_IMAGE_2D_MULTISAMPLE:
-          case eGL_IMAGE_2D_MULTISAMPLE_ARRAY:
-          case eGL_INT_IMAGE_1D:
-          case eGL_INT_IMAGE_2D:
-          case eGL_INT_IMAGE_3D:
-          case eGL_INT_IMAGE_2D_RECT:
-          case eGL_INT_IMAGE_CUBE:
-          case eGL_INT_IMAGE_BUFFER:
-          case eGL_INT_IMAGE_1D_ARRAY:
-          case eGL_INT_IMAGE_2D_ARRAY:
-          case eGL_INT_IMAGE_2D_MULTISAMPLE:
-          case eGL_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
-          case eGL_UNSIGNED_INT_IMAGE_1D:
-          case eGL_UNSIGNED_INT_IMAGE_2D:
-          case eGL_UNSIGNED_INT_IMAGE_3D:
-          case eGL_UNSIGNED_INT_IMAGE_2D_RECT:
-          case eGL_UNSIGNED_INT_IMAGE_CUBE:
-          case eGL_UNSIGNED_INT_IMAGE_BUFFER:
-          case eGL_UNSIGNED_INT_IMAGE_1D_ARRAY:
-          case eGL_UNSIGNED_INT_IMAGE_2D_ARRAY:
-          case eGL_UNSIGNED_INT_IMAGE_CUBE_MAP_ARRAY:
-          case eGL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE:
-          case eGL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
-          case eGL_INT:
-          case eGL_INT_VEC2:
-          case eGL_INT_VEC3:
-          case eGL_INT_VEC4:
-            GL.glGetUniformiv(progSrc, srcLocation, iv);
-            break;
-          // bools are unsigned integers
-          case eGL_UNSIGNED_INT:
-          case eGL_BOOL:
-          case eGL_UNSIGNED_INT_VEC2:
-          case eGL_BOOL_VEC2:
-          case eGL_UNSIGNED_INT_VEC3:
-          case eGL_BOOL_VEC3:
-          case eGL_UNSIGNED_INT_VEC4:
-          case eGL_BOOL_VEC4: GL.glGetUniformuiv(progSrc, srcLocation, uiv); break;
-          default: RDCERR("Unhandled uniform type '%s'", ToStr(type).c_str());
-        }
+        FetchUniformValue(progSrc, type, srcLocation, uniformVal.data.dval);
       }
     }
 
@@ -915,9 +1097,19 @@ static void ForAllProgramUniforms(SerialiserType *ser, CaptureState state,
     if(IsDstProgramSPIRV)
       UnrollConstants(dstStages, spirvGlobals);
 
+    if(layout)
+    {
+      *layout = ProgramUniformLayout();
+      layout->valid = true;
+      layout->dstSPIRV = IsDstProgramSPIRV;
+    }
+
     // loop over the loose global uniforms, see if there is an equivalent, and apply it.
     for(const ProgramUniform &uniform : serialisedUniforms.ValueUniforms)
     {
+      // whether the last run in the layout is for previous elements of this uniform
+      bool continueRun = false;
+
       for(size_t arr = 0; arr < uniform.Values.size(); arr++)
       {
         const ProgramUniformValue &val = uniform.Values[arr];
@@ -959,185 +1151,45 @@ static void ForAllProgramUniforms(SerialiserType *ser, CaptureState state,
 
         // don't try and apply the uniform if the new location is -1
         if(dstLocation == -1)
+        {
+          continueRun = false;
           continue;
+        }
 
-        const double *dv = val.data.dval;
-        const float *fv = val.data.fval;
-        const int32_t *iv = val.data.ival;
-        const uint32_t *uiv = val.data.uval;
-
-        // call the appropriate function to apply the data to the destination program
-        switch(val.Type)
+        if(layout)
         {
-          case eGL_FLOAT_MAT4:
-            GL.glProgramUniformMatrix4fv(progDst, dstLocation, 1, false, fv);
-            break;
-          case eGL_FLOAT_MAT4x3:
-            GL.glProgramUniformMatrix4x3fv(progDst, dstLocation, 1, false, fv);
-            break;
-          case eGL_FLOAT_MAT4x2:
-            GL.glProgramUniformMatrix4x2fv(progDst, dstLocation, 1, false, fv);
-            break;
-          case eGL_FLOAT_MAT3:
-            GL.glProgramUniformMatrix3fv(progDst, dstLocation, 1, false, fv);
-            break;
-          case eGL_FLOAT_MAT3x4:
-            GL.glProgramUniformMatrix3x4fv(progDst, dstLocation, 1, false, fv);
-            break;
-          case eGL_FLOAT_MAT3x2:
-            GL.glProgramUniformMatrix3x2fv(progDst, dstLocation, 1, false, fv);
-            break;
-          case eGL_FLOAT_MAT2:
-            GL.glProgramUniformMatrix2fv(progDst, dstLocation, 1, false, fv);
-            break;
-          case eGL_FLOAT_MAT2x4:
-            GL.glProgramUniformMatrix2x4fv(progDst, dstLocation, 1, false, fv);
-            break;
-          case eGL_FLOAT_MAT2x3:
-            GL.glProgramUniformMatrix2x3fv(progDst, dstLocation, 1, false, fv);
-            break;
-          case eGL_DOUBLE_MAT4:
-            GL.glProgramUniformMatrix4dv(progDst, dstLocation, 1, false, dv);
-            break;
-          case eGL_DOUBLE_MAT4x3:
-            GL.glProgramUniformMatrix4x3dv(progDst, dstLocation, 1, false, dv);
-            break;
-          case eGL_DOUBLE_MAT4x2:
-            GL.glProgramUniformMatrix4x2dv(progDst, dstLocation, 1, false, dv);
-            break;
-          case eGL_DOUBLE_MAT3:
-            GL.glProgramUniformMatrix3dv(progDst, dstLocation, 1, false, dv);
-            break;
-          case eGL_DOUBLE_MAT3x4:
-            GL.glProgramUniformMatrix3x4dv(progDst, dstLocation, 1, false, dv);
-            break;
-          case eGL_DOUBLE_MAT3x2:
-            GL.glProgramUniformMatrix3x2dv(progDst, dstLocation, 1, false, dv);
-            break;
-          case eGL_DOUBLE_MAT2:
-            GL.glProgramUniformMatrix2dv(progDst, dstLocation, 1, false, dv);
-            break;
-          case eGL_DOUBLE_MAT2x4:
-            GL.glProgramUniformMatrix2x4dv(progDst, dstLocation, 1, false, dv);
-            break;
-          case eGL_DOUBLE_MAT2x3:
-            GL.glProgramUniformMatrix2x3dv(progDst, dstLocation, 1, false, dv);
-            break;
-          case eGL_FLOAT: GL.glProgramUniform1fv(progDst, dstLocation, 1, fv); break;
-          case eGL_FLOAT_VEC2: GL.glProgramUniform2fv(progDst, dstLocation, 1, fv); break;
-          case eGL_FLOAT_VEC3: GL.glProgramUniform3fv(progDst, dstLocation, 1, fv); break;
-          case eGL_FLOAT_VEC4: GL.glProgramUniform4fv(progDst, dstLocation, 1, fv); break;
-          case eGL_DOUBLE: GL.glProgramUniform1dv(progDst, dstLocation, 1, dv); break;
-          case eGL_DOUBLE_VEC2: GL.glProgramUniform2dv(progDst, dstLocation, 1, dv); break;
-          case eGL_DOUBLE_VEC3: GL.glProgramUniform3dv(progDst, dstLocation, 1, dv); break;
-          case eGL_DOUBLE_VEC4: GL.glProgramUniform4dv(progDst, dstLocation, 1, dv); break;
-          case eGL_INT: GL.glProgramUniform1iv(progDst, dstLocation, 1, iv); break;
-          case eGL_INT_VEC2: GL.glProgramUniform2iv(progDst, dstLocation, 1, iv); break;
-          case eGL_INT_VEC3: GL.glProgramUniform3iv(progDst, dstLocation, 1, iv); break;
-          case eGL_INT_VEC4: GL.glProgramUniform4iv(progDst, dstLocation, 1, iv); break;
-          case eGL_UNSIGNED_INT:
-          case eGL_BOOL: GL.glProgramUniform1uiv(progDst, dstLocation, 1, uiv); break;
-          case eGL_UNSIGNED_INT_VEC2:
-          case eGL_BOOL_VEC2: GL.glProgramUniform2uiv(progDst, dstLocation, 1, uiv); break;
-          case eGL_UNSIGNED_INT_VEC3:
-          case eGL_BOOL_VEC3: GL.glProgramUniform3uiv(progDst, dstLocation, 1, uiv); break;
-          case eGL_UNSIGNED_INT_VEC4:
-          case eGL_BOOL_VEC4: GL.glProgramUniform4uiv(progDst, dstLocation, 1, uiv); break;
-
-          case eGL_IMAGE_1D:
-          case eGL_IMAGE_2D:
-          case eGL_IMAGE_3D:
-          case eGL_IMAGE_2D_RECT:
-          case eGL_IMAGE_CUBE:
-          case eGL_IMAGE_BUFFER:
-          case eGL_IMAGE_1D_ARRAY:
-          case eGL_IMAGE_2D_ARRAY:
-          case eGL_IMAGE_CUBE_MAP_ARRAY:
-          case eGL_IMAGE_2D_MULTISAMPLE:
-          case eGL_IMAGE_2D_MULTISAMPLE_ARRAY:
-          case eGL_INT_IMAGE_1D:
-          case eGL_INT_IMAGE_2D:
-          case eGL_INT_IMAGE_3D:
-          case eGL_INT_IMAGE_2D_RECT:
-          case eGL_INT_IMAGE_CUBE:
-          case eGL_INT_IMAGE_BUFFER:
-          case eGL_INT_IMAGE_1D_ARRAY:
-          case eGL_INT_IMAGE_2D_ARRAY:
-          case eGL_INT_IMAGE_2D_MULTISAMPLE:
-          case eGL_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
-          case eGL_UNSIGNED_INT_IMAGE_1D:
-          case eGL_UNSIGNED_INT_IMAGE_2D:
-          case eGL_UNSIGNED_INT_IMAGE_3D:
-          case eGL_UNSIGNED_INT_IMAGE_2D_RECT:
-          case eGL_UNSIGNED_INT_IMAGE_CUBE:
-          case eGL_UNSIGNED_INT_IMAGE_BUFFER:
-          case eGL_UNSIGNED_INT_IMAGE_1D_ARRAY:
-          case eGL_UNSIGNED_INT_IMAGE_2D_ARRAY:
-          case eGL_UNSIGNED_INT_IMAGE_CUBE_MAP_ARRAY:
-          case eGL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE:
-          case eGL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
-          case eGL_UNSIGNED_INT_ATOMIC_COUNTER:
-            if(IsGLES || IsDstProgramSPIRV)
-              // Image uniforms cannot be re-assigned in GLES or with SPIR-V programs.
-              break;
-            DELIBERATE_FALLTHROUGH();
-          // treat all samplers as just an int (since they just store their binding value)
-          case eGL_SAMPLER_1D:
-          case eGL_SAMPLER_2D:
-          case eGL_SAMPLER_3D:
-          case eGL_SAMPLER_CUBE:
-          case eGL_SAMPLER_CUBE_MAP_ARRAY:
-          case eGL_SAMPLER_1D_SHADOW:
-          case eGL_SAMPLER_2D_SHADOW:
-          case eGL_SAMPLER_1D_ARRAY:
-          case eGL_SAMPLER_2D_ARRAY:
-          case eGL_SAMPLER_1D_ARRAY_SHADOW:
-          case eGL_SAMPLER_2D_ARRAY_SHADOW:
-          case eGL_SAMPLER_2D_MULTISAMPLE:
-          case eGL_SAMPLER_2D_MULTISAMPLE_ARRAY:
-          case eGL_SAMPLER_CUBE_SHADOW:
-          case eGL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
-          case eGL_SAMPLER_BUFFER:
-          case eGL_SAMPLER_2D_RECT:
-          case eGL_SAMPLER_2D_RECT_SHADOW:
-          case eGL_INT_SAMPLER_1D:
-          case eGL_INT_SAMPLER_2D:
-          case eGL_INT_SAMPLER_3D:
-          case eGL_INT_SAMPLER_CUBE:
-          case eGL_INT_SAMPLER_CUBE_MAP_ARRAY:
-          case eGL_INT_SAMPLER_1D_ARRAY:
-          case eGL_INT_SAMPLER_2D_ARRAY:
-          case eGL_INT_SAMPLER_2D_MULTISAMPLE:
-          case eGL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
-          case eGL_INT_SAMPLER_BUFFER:
-          case eGL_INT_SAMPLER_2D_RECT:
-          case eGL_UNSIGNED_INT_SAMPLER_1D:
-          case eGL_UNSIGNED_INT_SAMPLER_2D:
-          case eGL_UNSIGNED_INT_SAMPLER_3D:
-          case eGL_UNSIGNED_INT_SAMPLER_CUBE:
-          case eGL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY:
-          case eGL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
-          case eGL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
-          case eGL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
-          case eGL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
-          case eGL_UNSIGNED_INT_SAMPLER_BUFFER:
-          case eGL_UNSIGNED_INT_SAMPLER_2D_RECT:
-            if(!IsDstProgramSPIRV)    // SPIR-V shaders treat samplers as immutable
-              GL.glProgramUniform1iv(progDst, dstLocation, 1, iv);
-            break;
-          default: RDCERR("Unhandled uniform type '%s'", ToStr(val.Type).c_str());
+          ProgramUniformLayout::UniformRun *run = continueRun ? &layout->uniforms.back() : NULL;
+
+          // array elements that are consecutive in both programs can be copied in one go
+          if(run && run->srcLocation + run->count == val.Location &&
+             run->dstLocation + run->count == dstLocation)
+            run->count++;
+          else
+            layout->uniforms.push_back({val.Type, val.Location, dstLocation, 1});
+
+          continueRun = true;
         }
+
+        ApplyUniformValues(progDst, val.Type, dstLocation, 1, val.data.dval, IsDstProgramSPIRV);
       }
     }
 
     if(!IsDstProgramSPIRV)
     {
       // apply UBO bindings
-      for(const ProgramBinding &bind : serialisedUniforms.UBOBindings)
+      for(size_t b = 0; b < serialisedUniforms.UBOBindings.size(); b++)
       {
+        const ProgramBinding &bind = serialisedUniforms.UBOBindings[b];
+
         GLuint idx = GL.glGetUniformBlockIndex(progDst, bind.Name.c_str());
         if(idx != GL_INVALID_INDEX)
+        {
           GL.glUniformBlockBinding(progDst, idx, bind.Binding);
+
+          // bindings are fetched in block index order from the source program
+          if(layout)
+            layout->uboBlocks.push_back({(GLuint)b, idx});
+        }
       }
     }
 
@@ -1146,8 +1198,10 @@ static void ForAllProgramUniforms(SerialiserType *ser, CaptureState state,
     // them, since they're immutable.
     if(!IsDstProgramSPIRV && !IsGLES)
     {
-      for(const ProgramBinding &bind : serialisedUniforms.SSBOBindings)
+      for(size_t b = 0; b < serialisedUniforms.SSBOBindings.size(); b++)
       {
+        const ProgramBinding &bind = serialisedUniforms.SSBOBindings[b];
+
         GLuint idx =
             GL.glGetProgramResourceIndex(progDst, eGL_SHADER_STORAGE_BLOCK, bind.Name.c_str());
         if(idx != GL_INVALID_INDEX)
@@ -1155,6 +1209,9 @@ static void ForAllProgramUniforms(SerialiserType *ser, CaptureState state,
           if(GL.glShaderStorageBlockBinding)
           {
             GL.glShaderStorageBlockBinding(progDst, idx, bind.Binding);
+
+            if(layout)
+              layout->ssboBlocks.push_back({(GLuint)b, idx});
           }
           else
           {
@@ -1168,12 +1225,57 @@ static void ForAllProgramUniforms(SerialiserType *ser, CaptureState state,
 
 void CopyProgramUniforms(const PerStageReflections &srcStages, GLuint progSrc,
                          const PerStageReflections &dstStages, GLuint progDst,
-                         std::map<GLint, GLint> *locTranslate)
+                         std::map<GLint, GLint> *locTranslate, ProgramUniformLayout *layout)
 {
   const bool CopyUniforms = true;
   const bool SerialiseUniforms = false;
   ForAllProgramUniforms<CopyUniforms, SerialiseUniforms, ReadSerialiser>(
-      NULL, CaptureState::ActiveReplaying, srcStages, progSrc, dstStages, progDst, locTranslate);
+      NULL, CaptureState::ActiveReplaying, srcStages, progSrc, dstStages, progDst, locTranslate,
+      layout);
+}
+
+void CopyProgramUniforms(const ProgramUniformLayout &layout, GLuint progSrc, GLuint progDst)
+{
+  bytebuf data;
+
+  for(const ProgramUniformLayout::UniformRun &run : layout.uniforms)
+  {
+    const uint32_t size = UniformValueSize(run.type);
+
+    data.clear();
+    data.fill(size * run.count, 0);
+
+    // atomic counters can't be fetched, and a missing source location is left as zero - the same
+    // as when the layout was built.
+    if(run.type != eGL_UNSIGNED_INT_ATOMIC_COUNTER && run.srcLocation != -1)
+    {
+      for(GLsizei i = 0; i < run.count; i++)
+        FetchUniformValue(progSrc, run.type, run.srcLocation + i, data.data() + size * i);
+    }
+
+    ApplyUniformValues(progDst, run.type, run.dstLocation, run.count, data.data(),
+                       layout.dstSPIRV);
+  }
+
+  for(const rdcpair<GLuint, GLuint> &block : layout.uboBlocks)
+  {
+    GLenum prop = eGL_BUFFER_BINDING;
+    uint32_t bind = 0;
+
+    GL.glGetProgramResourceiv(progSrc, eGL_UNIFORM_BLOCK, block.first, 1, &prop, 1, NULL,
+                              (GLint *)&bind);
+    GL.glUniformBlockBinding(progDst, block.second, bind);
+  }
+
+  for(const rdcpair<GLuint, GLuint> &block : layout.ssboBlocks)
+  {
+    GLenum prop = eGL_BUFFER_BINDING;
+    uint32_t bind = 0;
+
+    GL.glGetProgramResourceiv(progSrc, eGL_SHADER_STORAGE_BLOCK, block.first, 1, &prop, 1, NULL,
+                              (GLint *)&bind);
+    GL.glShaderStorageBlockBinding(progDst, block.second, bind);
+  }
 }
 
 template <typename SerialiserType>
@@ -1184,7 +1286,7 @@ void SerialiseProgramUniforms(SerialiserType &ser, CaptureState state,
   const bool CopyUniforms = false;
   const bool SerialiseUniforms = true;
   ForAllProgramUniforms<CopyUniforms, SerialiseUniforms>(&ser, state, stages, prog, stages, prog,
-                                                         locTranslate);
+                                                         locTranslate, NULL);
 }
 
 template void SerialiseProgramUniforms(ReadSerialiser &ser, CaptureState state,
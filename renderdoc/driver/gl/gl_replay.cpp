@@ -3053,6 +3053,18 @@ void GLReplay::GetTextureData(ResourceId tex, const Subresource &sub,
     drv.glDeleteTextures(1, &tempTex);
 }
 
+void GLReplay::GetTextureDataBatch(const rdcarray<TextureReadback> &readbacks,
+                                   TextureReadbackCallback callback)
+{
+  // readbacks aren't pipelined here, fetch each one in turn
+  for(size_t i = 0; i < readbacks.size(); i++)
+  {
+    bytebuf data;
+    GetTextureData(readbacks[i].tex, readbacks[i].sub, readbacks[i].params, data);
+    callback(i, data);
+  }
+}
+
 void GLReplay::SetCustomShaderIncludes(const rdcarray<rdcstr> &directories)
 {
 }
@@ -3782,6 +3794,17 @@ ShaderDebugTrace *GLReplay::DebugPixel(uint32_t eventId, uint32_t x, uint32_t y,
   return new ShaderDebugTrace();
 }
 
+rdcarray<ShaderDebugTrace *> GLReplay::DebugPixels(
+    uint32_t eventId, const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels, uint32_t sample,
+    uint32_t primitive)
+{
+  GLNOTIMP("DebugPixels");
+  rdcarray<ShaderDebugTrace *> ret;
+  for(size_t i = 0; i < pixels.size(); i++)
+    ret.push_back(new ShaderDebugTrace());
+  return ret;
+}
+
 ShaderDebugTrace *GLReplay::DebugThread(uint32_t eventId, const rdcfixedarray<uint32_t, 3> &groupid,
                                         const rdcfixedarray<uint32_t, 3> &threadid)
 {
@@ -152,6 +152,16 @@ public:
     m_GLPipelineState = gl;
   }
   void SavePipelineState(uint32_t eventId);
+  rdcarray<VKPipe::BindingElement> GetVulkanDescriptors(bool compute, uint32_t set,
+                                                        uint32_t binding, uint32_t firstElement,
+                                                        uint32_t count)
+  {
+    return {};
+  }
+  rdcarray<uint32_t> GetVulkanUsedDescriptors(bool compute, uint32_t set, uint32_t binding)
+  {
+    return {};
+  }
   void FreeTargetResource(ResourceId id);
 
   RDResult ReadLogInitialisation(RDCFile *rdc, bool storeStructuredBuffers);
@@ -177,11 +187,14 @@ public:
 
   void InitPostVSBuffers(uint32_t eventId);
   void InitPostVSBuffers(const rdcarray<uint32_t> &passEvents);
+  PostVSCacheStatistics GetPostVSCacheStatistics();
 
   ResourceId GetLiveID(ResourceId id);
 
   void PickPixel(ResourceId texture, uint32_t x, uint32_t y, const Subresource &sub,
                  CompType typeCast, float pixel[4]);
+  bool PickPixelTile(ResourceId texture, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                     const Subresource &sub, CompType typeCast, rdcarray<float> &pixels);
   bool GetMinMax(ResourceId texid, const Subresource &sub, CompType typeCast, float *minval,
                  float *maxval);
   bool GetHistogram(ResourceId texid, const Subresource &sub, CompType typeCast, float minval,
@@ -194,6 +207,8 @@ public:
   void GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, bytebuf &ret);
   void GetTextureData(ResourceId tex, const Subresource &sub, const GetTextureDataParams &params,
                       bytebuf &data);
+  void GetTextureDataBatch(const rdcarray<TextureReadback> &readbacks,
+                           TextureReadbackCallback callback);
 
   void ReplaceResource(ResourceId from, ResourceId to);
   void RemoveReplacement(ResourceId id);
@@ -237,10 +252,16 @@ public:
 
   rdcarray<PixelModification> PixelHistory(rdcarray<EventUsage> events, ResourceId target, uint32_t x,
                                            uint32_t y, const Subresource &sub, CompType typeCast);
+  PixelRegionHistory PixelHistoryRegion(rdcarray<EventUsage> events, ResourceId target, uint32_t x,
+                                        uint32_t y, uint32_t width, uint32_t height,
+                                        const Subresource &sub, CompType typeCast);
   ShaderDebugTrace *DebugVertex(uint32_t eventId, uint32_t vertid, uint32_t instid, uint32_t idx,
                                 uint32_t view);
   ShaderDebugTrace *DebugPixel(uint32_t eventId, uint32_t x, uint32_t y, uint32_t sample,
                                uint32_t primitive);
+  rdcarray<ShaderDebugTrace *> DebugPixels(uint32_t eventId,
+                                           const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels,
+                                           uint32_t sample, uint32_t primitive);
   ShaderDebugTrace *DebugThread(uint32_t eventId, const rdcfixedarray<uint32_t, 3> &groupid,
                                 const rdcfixedarray<uint32_t, 3> &threadid);
   rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger);
@@ -434,8 +455,12 @@ private:
 
   // eventId -> data
   std::map<uint32_t, GLPostVSData> m_PostVSData;
+  PostVSCacheTracker m_PostVSCache;
 
   void ClearPostVSCache();
+  void TrimPostVSCache(const rdcarray<uint32_t> &keep);
+  void ReleasePostVSData(GLPostVSData &data);
+  void FetchPostVSData(uint32_t eventId);
 
   // cache the previous data returned
   ResourceId m_GetTexturePrevID;
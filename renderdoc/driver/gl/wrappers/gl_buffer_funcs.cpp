@@ -25,9 +25,12 @@
 
 #include "../gl_driver.h"
 #include "common/common.h"
+#include "core/settings.h"
 #include "strings/string_utils.h"
 #include "tinyfiledialogs/tinyfiledialogs.h"
 
+RDOC_EXTERN_CONFIG(uint32_t, Capture_MapDiffMergeGap);
+
 enum GLbufferbitfield
 {
   DYNAMIC_STORAGE_BIT = 0x0100,
@@ -1003,22 +1006,20 @@ void WrappedOpenGL::glNamedBufferSubDataEXT(GLuint buffer, GLintptr offset, GLsi
        IsBackgroundCapturing(m_State))
       return;
 
-    USE_SCRATCH_SERIALISER();
-    SCOPED_SERIALISE_CHUNK(gl_CurChunk);
-    Serialise_glNamedBufferSubDataEXT(ser, buffer, offset, size, data);
-
-    Chunk *chunk = scope.Get();
-
     if(IsActiveCapturing(m_State))
     {
-      GetContextRecord()->AddChunk(chunk);
+      RecordBufferSubData(record, buffer, offset, size, data);
       GetResourceManager()->MarkDirtyResource(record->GetResourceID());
       GetResourceManager()->MarkResourceFrameReferenced(record->GetResourceID(),
                                                         eFrameRef_ReadBeforeWrite);
     }
     else
     {
-      record->AddChunk(chunk);
+      USE_SCRATCH_SERIALISER();
+      SCOPED_SERIALISE_CHUNK(gl_CurChunk);
+      Serialise_glNamedBufferSubDataEXT(ser, buffer, offset, size, data);
+
+      record->AddChunk(scope.Get());
       record->UpdateCount++;
 
       if(record->UpdateCount > 10)
@@ -1030,6 +1031,70 @@ void WrappedOpenGL::glNamedBufferSubDataEXT(GLuint buffer, GLintptr offset, GLsi
   }
 }
 
+// uploads larger than this aren't merged, so that each merge's copy stays cheap
+static const uint64_t MaxMergedBufferUpload = 64 * 1024;
+
+void WrappedOpenGL::RecordBufferSubData(GLResourceRecord *record, GLuint buffer, GLintptr offset,
+                                        GLsizeiptr size, const void *data)
+{
+  ContextData::BufferUpload &last = GetCtxData().m_LastBufferUpload;
+  GLResourceRecord *ctxRecord = GetContextRecord();
+
+  // streaming geometry tends to be uploaded in many small pieces back to back. If this upload
+  // overlaps or abuts the previous one to the same buffer, and nothing at all has been recorded in
+  // between that could have used the buffer, replace the previous chunk with a single merged one.
+  uint64_t start = (uint64_t)offset, end = start + (uint64_t)size;
+  uint64_t lastEnd = last.offset + last.data.size();
+  uint64_t mergedStart = RDCMIN(start, last.offset), mergedEnd = RDCMAX(end, lastEnd);
+
+  if(data && last.chunk && last.buffer == record->GetResourceID() && start <= lastEnd &&
+     end >= last.offset && mergedEnd - mergedStart <= MaxMergedBufferUpload &&
+     GLResourceRecord::IsLatestID(last.chunkID))
+  {
+    ctxRecord->LockChunks();
+    bool merge = ctxRecord->HasChunks() && ctxRecord->GetLastChunk() == last.chunk;
+    if(merge)
+      ctxRecord->PopChunk();
+    ctxRecord->UnlockChunks();
+
+    if(merge)
+    {
+      last.chunk->Delete();
+
+      bytebuf merged;
+      merged.resize((size_t)(mergedEnd - mergedStart));
+      memcpy(merged.data() + (last.offset - mergedStart), last.data.data(), last.data.size());
+      memcpy(merged.data() + (start - mergedStart), data, (size_t)size);
+      last.data.swap(merged);
+      last.offset = mergedStart;
+
+      USE_SCRATCH_SERIALISER();
+      SCOPED_SERIALISE_CHUNK(gl_CurChunk);
+      Serialise_glNamedBufferSubDataEXT(ser, buffer, (GLintptr)last.offset,
+                                        (GLsizeiptr)last.data.size(), last.data.data());
+
+      last.chunk = scope.Get();
+      ctxRecord->AddChunk(last.chunk, last.chunkID);
+      return;
+    }
+  }
+
+  USE_SCRATCH_SERIALISER();
+  SCOPED_SERIALISE_CHUNK(gl_CurChunk);
+  Serialise_glNamedBufferSubDataEXT(ser, buffer, offset, size, data);
+
+  last.chunk = scope.Get();
+  last.chunkID = GLResourceRecord::GetID();
+  ctxRecord->AddChunk(last.chunk, last.chunkID);
+
+  last.buffer = record->GetResourceID();
+  last.offset = start;
+  if(data && (uint64_t)size <= MaxMergedBufferUpload)
+    last.data.assign((const byte *)data, (size_t)size);
+  else
+    last.chunk = NULL;
+}
+
 void WrappedOpenGL::glNamedBufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr size,
                                          const void *data)
 {
@@ -1063,22 +1128,20 @@ void WrappedOpenGL::glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr s
        IsBackgroundCapturing(m_State))
       return;
 
-    USE_SCRATCH_SERIALISER();
-    SCOPED_SERIALISE_CHUNK(gl_CurChunk);
-    Serialise_glNamedBufferSubDataEXT(ser, res.name, offset, size, data);
-
-    Chunk *chunk = scope.Get();
-
     if(IsActiveCapturing(m_State))
     {
-      GetContextRecord()->AddChunk(chunk);
+      RecordBufferSubData(record, res.name, offset, size, data);
       GetResourceManager()->MarkDirtyResource(record->GetResourceID());
       GetResourceManager()->MarkResourceFrameReferenced(record->GetResourceID(),
                                                         eFrameRef_ReadBeforeWrite);
     }
     else
     {
-      record->AddChunk(chunk);
+      USE_SCRATCH_SERIALISER();
+      SCOPED_SERIALISE_CHUNK(gl_CurChunk);
+      Serialise_glNamedBufferSubDataEXT(ser, res.name, offset, size, data);
+
+      record->AddChunk(scope.Get());
       record->UpdateCount++;
 
       if(record->UpdateCount > 10)
@@ -1592,16 +1655,17 @@ bool WrappedOpenGL::Serialise_glBindBuffersBase(SerialiserType &ser, GLenum targ
 
   if(IsReplayingAndReading())
   {
-    rdcarray<GLuint> bufs;
-    bufs.reserve(count);
+    ThreadTempMemory::Scope temp(m_TempMemory);
+
+    GLuint *bufs = temp.AllocArray<GLuint>(count);
     for(GLsizei i = 0; i < count; i++)
     {
-      bufs.push_back(buffers[i].name);
+      bufs[i] = buffers[i].name;
 
       AddResourceInitChunk(buffers[i]);
     }
 
-    GL.glBindBuffersBase(target, first, count, bufs.data());
+    GL.glBindBuffersBase(target, first, count, bufs);
   }
 
   return true;
@@ -1791,34 +1855,35 @@ bool WrappedOpenGL::Serialise_glBindBuffersRange(SerialiserType &ser, GLenum tar
 
   if(IsReplayingAndReading())
   {
-    rdcarray<GLuint> bufs;
-    rdcarray<GLintptr> offs;
-    rdcarray<GLsizeiptr> sz;
+    ThreadTempMemory::Scope temp(m_TempMemory);
+
+    GLuint *bufs = NULL;
+    GLintptr *offs = NULL;
+    GLsizeiptr *sz = NULL;
     if(!buffers.empty())
     {
-      bufs.reserve(count);
+      bufs = temp.AllocArray<GLuint>(count);
       for(GLsizei i = 0; i < count; i++)
       {
-        bufs.push_back(buffers[i].name);
+        bufs[i] = buffers[i].name;
 
         AddResourceInitChunk(buffers[i]);
       }
     }
     if(!offsets.empty())
     {
-      offs.reserve(count);
+      offs = temp.AllocArray<GLintptr>(count);
       for(GLsizei i = 0; i < count; i++)
-        offs.push_back((GLintptr)offsets[i]);
+        offs[i] = (GLintptr)offsets[i];
     }
     if(!sizes.empty())
     {
-      sz.reserve(count);
+      sz = temp.AllocArray<GLsizeiptr>(count);
       for(GLsizei i = 0; i < count; i++)
-        sz.push_back((GLintptr)sizes[i]);
+        sz[i] = (GLsizeiptr)sizes[i];
     }
 
-    GL.glBindBuffersRange(target, first, count, bufs.empty() ? NULL : bufs.data(),
-                          offs.empty() ? NULL : offs.data(), sz.empty() ? NULL : sz.data());
+    GL.glBindBuffersRange(target, first, count, bufs, offs, sz);
   }
 
   return true;
@@ -3065,28 +3130,30 @@ void WrappedOpenGL::PersistentMapMemoryBarrier(const std::set<GLResourceRecord *
 
     if(record->Map.ptr)
     {
-      size_t diffStart = 0, diffEnd = record->Map.length;
-      bool found = true;
+      rdcarray<rdcpair<size_t, size_t>> diffRanges;
+      bool hadShadow = record->GetShadowPtr(0) != NULL;
 
-      if(record->GetShadowPtr(0))
-        found = FindDiffRange(record->GetShadowPtr(0), record->Map.ptr, (size_t)record->Map.length,
-                              diffStart, diffEnd);
+      if(hadShadow)
+        FindDiffRanges(record->GetShadowPtr(0), record->Map.ptr, (size_t)record->Map.length,
+                       Capture_MapDiffMergeGap(), diffRanges);
+      else if(record->Map.length > 0)
+        diffRanges.push_back({0, (size_t)record->Map.length});
 
-      if(found && diffEnd > diffStart)
+      for(const rdcpair<size_t, size_t> &diff : diffRanges)
       {
         // update the modified region in the 'comparison' shadow buffer for next check
-        if(record->GetShadowPtr(0) == NULL)
+        if(!hadShadow)
           record->AllocShadowStorage(record->Map.length);
         else
-          memcpy(record->GetShadowPtr(0) + diffStart, record->Map.ptr + diffStart,
-                 diffEnd - diffStart);
+          memcpy(record->GetShadowPtr(0) + diff.first, record->Map.ptr + diff.first,
+                 diff.second - diff.first);
 
         // we use our own flush function so it will serialise chunks when necessary, and it
         // also handles copying into the persistent mapped pointer and flushing the real GL
         // buffer
         gl_CurChunk = GLChunk::CoherentMapWrite;
-        glFlushMappedNamedBufferRangeEXT(record->Resource.name, GLintptr(diffStart),
-                                         GLsizeiptr(diffEnd - diffStart));
+        glFlushMappedNamedBufferRangeEXT(record->Resource.name, GLintptr(diff.first),
+                                         GLsizeiptr(diff.second - diff.first));
       }
     }
   }
@@ -4924,19 +4991,21 @@ bool WrappedOpenGL::Serialise_glVertexArrayVertexBuffers(SerialiserType &ser, GL
 
   if(IsReplayingAndReading())
   {
-    rdcarray<GLuint> bufs;
-    rdcarray<GLintptr> offs;
+    ThreadTempMemory::Scope temp(m_TempMemory);
+
+    GLuint *bufs = NULL;
+    GLintptr *offs = NULL;
     if(!buffers.empty())
     {
-      bufs.reserve(count);
+      bufs = temp.AllocArray<GLuint>(count);
       for(GLsizei i = 0; i < count; i++)
-        bufs.push_back(buffers[i].name);
+        bufs[i] = buffers[i].name;
     }
     if(!offsets.empty())
     {
-      offs.reserve(count);
+      offs = temp.AllocArray<GLintptr>(count);
       for(GLsizei i = 0; i < count; i++)
-        offs.push_back((GLintptr)offsets[i]);
+        offs[i] = (GLintptr)offsets[i];
     }
 
     if(vaobj.name == 0)
@@ -4946,8 +5015,7 @@ bool WrappedOpenGL::Serialise_glVertexArrayVertexBuffers(SerialiserType &ser, GL
     // we are running without ARB_dsa support, these functions are emulated in the obvious way. This
     // is necessary since these functions can be serialised even if ARB_dsa was not used originally,
     // and we need to support this case.
-    GL.glVertexArrayVertexBuffers(vaobj.name, first, count, bufs.empty() ? NULL : bufs.data(),
-                                  offs.empty() ? NULL : offs.data(), strides);
+    GL.glVertexArrayVertexBuffers(vaobj.name, first, count, bufs, offs, strides);
 
     if(IsLoading(m_State))
     {
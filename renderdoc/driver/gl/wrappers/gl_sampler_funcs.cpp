@@ -201,12 +201,13 @@ bool WrappedOpenGL::Serialise_glBindSamplers(SerialiserType &ser, GLuint first,
 
   if(IsReplayingAndReading())
   {
-    rdcarray<GLuint> samps;
-    samps.reserve(count);
+    ThreadTempMemory::Scope temp(m_TempMemory);
+
+    GLuint *samps = temp.AllocArray<GLuint>(count);
     for(int32_t i = 0; i < count; i++)
-      samps.push_back(samplers[i].name);
+      samps[i] = samplers[i].name;
 
-    GL.glBindSamplers(first, count, samps.data());
+    GL.glBindSamplers(first, count, samps);
   }
 
   return true;
@@ -841,6 +841,7 @@ bool WrappedOpenGL::Serialise_glLinkProgram(SerialiserType &ser, GLuint programH
     ProgramData &progDetails = m_Programs[progid];
 
     progDetails.linked = true;
+    progDetails.initialUniformLayout.valid = false;
 
     for(size_t s = 0; s < 6; s++)
     {
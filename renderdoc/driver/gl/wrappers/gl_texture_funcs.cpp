@@ -357,12 +357,13 @@ bool WrappedOpenGL::Serialise_glBindTextures(SerialiserType &ser, GLuint first,
 
   if(IsReplayingAndReading())
   {
-    rdcarray<GLuint> texs;
-    texs.reserve(count);
+    ThreadTempMemory::Scope temp(m_TempMemory);
+
+    GLuint *texs = temp.AllocArray<GLuint>(count);
     for(GLsizei i = 0; i < count; i++)
-      texs.push_back(textures[i].name);
+      texs[i] = textures[i].name;
 
-    GL.glBindTextures(first, count, texs.data());
+    GL.glBindTextures(first, count, texs);
 
     if(IsLoading(m_State))
     {
@@ -644,12 +645,13 @@ bool WrappedOpenGL::Serialise_glBindImageTextures(SerialiserType &ser, GLuint fi
 
   if(IsReplayingAndReading())
   {
-    rdcarray<GLuint> texs;
-    texs.reserve(count);
+    ThreadTempMemory::Scope temp(m_TempMemory);
+
+    GLuint *texs = temp.AllocArray<GLuint>(count);
     for(GLsizei i = 0; i < count; i++)
-      texs.push_back(textures[i].name);
+      texs[i] = textures[i].name;
 
-    GL.glBindImageTextures(first, count, texs.data());
+    GL.glBindImageTextures(first, count, texs);
 
     if(IsLoading(m_State))
     {
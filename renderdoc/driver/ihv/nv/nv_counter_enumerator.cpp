@@ -26,6 +26,7 @@
 
 #include "common/common.h"
 #include "common/formatting.h"
+#include "common/threading.h"
 #include "os/os_specific.h"
 #include "strings/string_utils.h"
 
@@ -75,6 +76,21 @@ private:
   rdcarray<NVPW_MetricEvalRequest> m_AllEvalRequests;
 };
 
+// Building the config image for a set of counters can take seconds with many metrics, and the
+// result only depends on the chip and the counters selected. Since the same counters are often
+// fetched repeatedly, and the driver can't change underneath us, keep recent configs around for the
+// lifetime of the process instead of rebuilding them on every fetch.
+struct CachedCounterConfig
+{
+  rdcstr chipName;
+  rdcarray<GPUCounter> counters;
+  nv::perf::CounterConfiguration configuration;
+};
+
+static const size_t MaxCachedCounterConfigs = 8;
+static Threading::CriticalSection counterConfigCacheLock;
+static rdcarray<CachedCounterConfig> counterConfigCache;
+
 NVCounterEnumerator::NVCounterEnumerator()
 {
   m_Impl = new NVCounterEnumerator::Impl();
@@ -292,6 +308,39 @@ bool NVCounterEnumerator::CreateConfig(const char *pChipName,
                                        NVPA_RawMetricsConfig *pRawMetricsConfig,
                                        const rdcarray<GPUCounter> &counters)
 {
+  {
+    SCOPED_LOCK(counterConfigCacheLock);
+    for(size_t i = 0; i < counterConfigCache.size(); i++)
+    {
+      if(counterConfigCache[i].chipName == pChipName && counterConfigCache[i].counters == counters)
+      {
+        // the raw config would have been owned by the config builder, so free it ourselves
+        NVPW_RawMetricsConfig_Destroy_Params destroyParams = {
+            NVPW_RawMetricsConfig_Destroy_Params_STRUCT_SIZE};
+        destroyParams.pRawMetricsConfig = pRawMetricsConfig;
+        NVPW_RawMetricsConfig_Destroy(&destroyParams);
+
+        for(GPUCounter counterID : counters)
+        {
+          if(!IsNvidiaCounter(counterID))
+            continue;
+          size_t counterIndex = (uint32_t)counterID - (uint32_t)GPUCounter::FirstNvidia;
+          m_Impl->SelectedExternalIds.push_back(counterID);
+          m_Impl->SelectedEvalRequests.push_back(m_Impl->AllEvalRequests()[counterIndex]);
+        }
+
+        m_Impl->SelectedConfiguration = counterConfigCache[i].configuration;
+        m_Impl->SelectedNumPasses = counterConfigCache[i].configuration.numPasses;
+
+        // move to the back so the least recently used config is at the front
+        CachedCounterConfig cached = counterConfigCache.takeAt(i);
+        counterConfigCache.push_back(cached);
+
+        return true;
+      }
+    }
+  }
+
   nv::perf::MetricsConfigBuilder metricsConfigBuilder;
   if(!metricsConfigBuilder.Initialize(m_Impl->Evaluator, pRawMetricsConfig, pChipName))
   {
@@ -335,6 +384,15 @@ bool NVCounterEnumerator::CreateConfig(const char *pChipName,
   metricsConfigBuilder.GetCounterDataPrefix(m_Impl->SelectedConfiguration.counterDataPrefix.size(),
                                             m_Impl->SelectedConfiguration.counterDataPrefix.data());
   m_Impl->SelectedNumPasses = metricsConfigBuilder.GetNumPasses();
+  m_Impl->SelectedConfiguration.numPasses = m_Impl->SelectedNumPasses;
+
+  {
+    SCOPED_LOCK(counterConfigCacheLock);
+    if(counterConfigCache.size() >= MaxCachedCounterConfigs)
+      counterConfigCache.erase(0);
+    counterConfigCache.push_back({pChipName, counters, m_Impl->SelectedConfiguration});
+  }
+
   return true;
 }
 
@@ -337,10 +337,14 @@ bool WrappedMTLDevice::ProcessChunk(ReadSerialiser &ser, MetalChunk chunk)
       METAL_CHUNK_NOT_HANDLED();
     case MetalChunk::MTLRenderCommandEncoder_dispatchThreadsPerTile: METAL_CHUNK_NOT_HANDLED();
     case MetalChunk::MTLRenderCommandEncoder_setThreadgroupMemoryLength: METAL_CHUNK_NOT_HANDLED();
-    case MetalChunk::MTLRenderCommandEncoder_useResource: METAL_CHUNK_NOT_HANDLED();
-    case MetalChunk::MTLRenderCommandEncoder_useResource_stages: METAL_CHUNK_NOT_HANDLED();
-    case MetalChunk::MTLRenderCommandEncoder_useResources: METAL_CHUNK_NOT_HANDLED();
-    case MetalChunk::MTLRenderCommandEncoder_useResources_stages: METAL_CHUNK_NOT_HANDLED();
+    case MetalChunk::MTLRenderCommandEncoder_useResource:
+    case MetalChunk::MTLRenderCommandEncoder_useResource_stages:
+      return m_DummyReplayRenderCommandEncoder->Serialise_useResource(
+          ser, NULL, MTL::ResourceUsage(0), MTL::RenderStages(0));
+    case MetalChunk::MTLRenderCommandEncoder_useResources:
+    case MetalChunk::MTLRenderCommandEncoder_useResources_stages:
+      return m_DummyReplayRenderCommandEncoder->Serialise_useResources(
+          ser, NULL, 0, MTL::ResourceUsage(0), MTL::RenderStages(0));
     case MetalChunk::MTLRenderCommandEncoder_useHeap: METAL_CHUNK_NOT_HANDLED();
     case MetalChunk::MTLRenderCommandEncoder_useHeap_stages: METAL_CHUNK_NOT_HANDLED();
     case MetalChunk::MTLRenderCommandEncoder_useHeaps: METAL_CHUNK_NOT_HANDLED();
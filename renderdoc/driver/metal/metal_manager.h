@@ -156,6 +156,7 @@ public:
   //  void MarkDirtyResource(ResourceId id);
   //  void RemoveResourceRecord(ResourceId id);
   //  void MarkResourceFrameReferenced(ResourceId id, FrameRefType refType);
+  //  void MarkResourcesFrameReferenced(const std::unordered_map<ResourceId, FrameRefType> &refs);
   //  void DestroyResourceRecord(ResourceRecord *record);
   // ResourceRecordHandler interface
 
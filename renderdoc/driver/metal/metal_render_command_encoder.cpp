@@ -309,6 +309,130 @@ void WrappedMTLRenderCommandEncoder::drawPrimitives(MTL::PrimitiveType primitive
   drawPrimitives(primitiveType, vertexStart, vertexCount, instanceCount, 0);
 }
 
+// resources made resident with useResource are typically only accessed through argument buffers,
+// so this is the only place they are seen. Written usage could be partial so preserve the
+// previous contents.
+static FrameRefType GetUseResourceRefType(MTL::ResourceUsage usage)
+{
+  return (usage & MTL::ResourceUsageWrite) ? eFrameRef_ReadBeforeWrite : eFrameRef_Read;
+}
+
+// the deprecated overloads without stages apply to the vertex and fragment stages
+static const MTL::RenderStages DefaultUseResourceStages =
+    MTL::RenderStages(MTL::RenderStageVertex | MTL::RenderStageFragment);
+
+template <typename SerialiserType>
+bool WrappedMTLRenderCommandEncoder::Serialise_useResource(SerialiserType &ser,
+                                                           WrappedMTLResource *resource,
+                                                           MTL::ResourceUsage usage,
+                                                           MTL::RenderStages stages)
+{
+  SERIALISE_ELEMENT_LOCAL(RenderCommandEncoder, this);
+  SERIALISE_ELEMENT(resource).Important();
+  SERIALISE_ELEMENT(usage).Important();
+  SERIALISE_ELEMENT(stages);
+
+  SERIALISE_CHECK_READ_ERRORS();
+
+  // TODO: implement RD MTL replay
+  if(IsReplayingAndReading())
+  {
+  }
+  return true;
+}
+
+void WrappedMTLRenderCommandEncoder::useResource(WrappedMTLResource *resource,
+                                                 MTL::ResourceUsage usage,
+                                                 MTL::RenderStages stages)
+{
+  SERIALISE_TIME_CALL(Unwrap(this)->useResource(Unwrap(resource), usage, stages));
+
+  if(IsCaptureMode(m_State))
+  {
+    Chunk *chunk = NULL;
+    {
+      CACHE_THREAD_SERIALISER();
+      SCOPED_SERIALISE_CHUNK(MetalChunk::MTLRenderCommandEncoder_useResource_stages);
+      Serialise_useResource(ser, resource, usage, stages);
+      chunk = scope.Get();
+    }
+    MetalResourceRecord *bufferRecord = GetRecord(m_CommandBuffer);
+    bufferRecord->AddChunk(chunk);
+    bufferRecord->MarkResourceFrameReferenced(GetResID(resource), GetUseResourceRefType(usage));
+  }
+  else
+  {
+    // TODO: implement RD MTL replay
+  }
+}
+
+void WrappedMTLRenderCommandEncoder::useResource(WrappedMTLResource *resource,
+                                                 MTL::ResourceUsage usage)
+{
+  useResource(resource, usage, DefaultUseResourceStages);
+}
+
+template <typename SerialiserType>
+bool WrappedMTLRenderCommandEncoder::Serialise_useResources(SerialiserType &ser,
+                                                            WrappedMTLResource *const *resources,
+                                                            NS::UInteger count,
+                                                            MTL::ResourceUsage usage,
+                                                            MTL::RenderStages stages)
+{
+  SERIALISE_ELEMENT_LOCAL(RenderCommandEncoder, this);
+  SERIALISE_ELEMENT_ARRAY(resources, count).Important();
+  SERIALISE_ELEMENT(count);
+  SERIALISE_ELEMENT(usage).Important();
+  SERIALISE_ELEMENT(stages);
+
+  SERIALISE_CHECK_READ_ERRORS();
+
+  // TODO: implement RD MTL replay
+  if(IsReplayingAndReading())
+  {
+  }
+  return true;
+}
+
+void WrappedMTLRenderCommandEncoder::useResources(WrappedMTLResource *const *resources,
+                                                  NS::UInteger count, MTL::ResourceUsage usage,
+                                                  MTL::RenderStages stages)
+{
+  rdcarray<MTL::Resource *> unwrapped;
+  unwrapped.resize(count);
+  for(NS::UInteger i = 0; i < count; i++)
+    unwrapped[i] = Unwrap(resources[i]);
+
+  SERIALISE_TIME_CALL(Unwrap(this)->useResources(unwrapped.data(), count, usage, stages));
+
+  if(IsCaptureMode(m_State))
+  {
+    Chunk *chunk = NULL;
+    {
+      CACHE_THREAD_SERIALISER();
+      SCOPED_SERIALISE_CHUNK(MetalChunk::MTLRenderCommandEncoder_useResources_stages);
+      Serialise_useResources(ser, resources, count, usage, stages);
+      chunk = scope.Get();
+    }
+    MetalResourceRecord *bufferRecord = GetRecord(m_CommandBuffer);
+    bufferRecord->AddChunk(chunk);
+
+    FrameRefType refType = GetUseResourceRefType(usage);
+    for(NS::UInteger i = 0; i < count; i++)
+      bufferRecord->MarkResourceFrameReferenced(GetResID(resources[i]), refType);
+  }
+  else
+  {
+    // TODO: implement RD MTL replay
+  }
+}
+
+void WrappedMTLRenderCommandEncoder::useResources(WrappedMTLResource *const *resources,
+                                                  NS::UInteger count, MTL::ResourceUsage usage)
+{
+  useResources(resources, count, usage, DefaultUseResourceStages);
+}
+
 template <typename SerialiserType>
 bool WrappedMTLRenderCommandEncoder::Serialise_endEncoding(SerialiserType &ser)
 {
@@ -345,6 +469,12 @@ void WrappedMTLRenderCommandEncoder::endEncoding()
   }
 }
 
+INSTANTIATE_FUNCTION_SERIALISED(WrappedMTLRenderCommandEncoder, void, useResource,
+                                WrappedMTLResource *resource, MTL::ResourceUsage usage,
+                                MTL::RenderStages stages);
+INSTANTIATE_FUNCTION_SERIALISED(WrappedMTLRenderCommandEncoder, void, useResources,
+                                WrappedMTLResource *const *resources, NS::UInteger count,
+                                MTL::ResourceUsage usage, MTL::RenderStages stages);
 INSTANTIATE_FUNCTION_SERIALISED(WrappedMTLRenderCommandEncoder, void, endEncoding);
 INSTANTIATE_FUNCTION_SERIALISED(WrappedMTLRenderCommandEncoder, void, setRenderPipelineState,
                                 WrappedMTLRenderPipelineState *pipelineState);
@@ -51,6 +51,14 @@ public:
                       NS::UInteger vertexCount);
   void drawPrimitives(MTL::PrimitiveType primitiveType, NS::UInteger vertexStart,
                       NS::UInteger vertexCount, NS::UInteger instanceCount);
+  DECLARE_FUNCTION_SERIALISED(void, useResource, WrappedMTLResource *resource,
+                              MTL::ResourceUsage usage, MTL::RenderStages stages);
+  void useResource(WrappedMTLResource *resource, MTL::ResourceUsage usage);
+  DECLARE_FUNCTION_SERIALISED(void, useResources, WrappedMTLResource *const *resources,
+                              NS::UInteger count, MTL::ResourceUsage usage,
+                              MTL::RenderStages stages);
+  void useResources(WrappedMTLResource *const *resources, NS::UInteger count,
+                    MTL::ResourceUsage usage);
   DECLARE_FUNCTION_SERIALISED(void, endEncoding);
 
   enum
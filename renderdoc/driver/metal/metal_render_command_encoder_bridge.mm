@@ -1124,24 +1124,23 @@
 - (void)useResource:(id<MTLResource>)resource
               usage:(MTLResourceUsage)usage API_AVAILABLE(macos(10.13), ios(11.0))
 {
-  METAL_NOT_HOOKED();
-  return [self.real useResource:resource usage:usage];
+  GetWrapped(self)->useResource(GetWrapped(resource), (MTL::ResourceUsage)usage);
 }
 
 - (void)useResources:(const id<MTLResource> __nonnull[__nonnull])resources
                count:(NSUInteger)count
                usage:(MTLResourceUsage)usage API_AVAILABLE(macos(10.13), ios(11.0))
 {
-  METAL_NOT_HOOKED();
-  return [self.real useResources:resources count:count usage:usage];
+  GetWrapped(self)->useResources((WrappedMTLResource *const *)resources, count,
+                                 (MTL::ResourceUsage)usage);
 }
 
 - (void)useResource:(id<MTLResource>)resource
               usage:(MTLResourceUsage)usage
              stages:(MTLRenderStages)stages API_AVAILABLE(macos(10.15), ios(13.0))
 {
-  METAL_NOT_HOOKED();
-  return [self.real useResource:resource usage:usage stages:stages];
+  GetWrapped(self)->useResource(GetWrapped(resource), (MTL::ResourceUsage)usage,
+                                (MTL::RenderStages)stages);
 }
 
 - (void)useResources:(const id<MTLResource> __nonnull[__nonnull])resources
@@ -1149,8 +1148,8 @@
                usage:(MTLResourceUsage)usage
               stages:(MTLRenderStages)stages API_AVAILABLE(macos(10.15), ios(13.0))
 {
-  METAL_NOT_HOOKED();
-  return [self.real useResources:resources count:count usage:usage stages:stages];
+  GetWrapped(self)->useResources((WrappedMTLResource *const *)resources, count,
+                                 (MTL::ResourceUsage)usage, (MTL::RenderStages)stages);
 }
 
 - (void)useHeap:(id<MTLHeap>)heap API_AVAILABLE(macos(10.13), ios(11.0))
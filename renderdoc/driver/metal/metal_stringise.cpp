@@ -1067,6 +1067,32 @@ rdcstr DoStringise(const MTL::BlitOption &el)
   END_ENUM_STRINGISE()
 }
 
+template <>
+rdcstr DoStringise(const MTL::ResourceUsage &el)
+{
+  BEGIN_BITFIELD_STRINGISE(MTL::ResourceUsage)
+  {
+    MTL_STRINGISE_BITFIELD_BIT(ResourceUsageRead);
+    MTL_STRINGISE_BITFIELD_BIT(ResourceUsageWrite);
+    MTL_STRINGISE_BITFIELD_BIT(ResourceUsageSample);
+  }
+  END_BITFIELD_STRINGISE()
+}
+
+template <>
+rdcstr DoStringise(const MTL::RenderStages &el)
+{
+  BEGIN_BITFIELD_STRINGISE(MTL::RenderStages)
+  {
+    MTL_STRINGISE_BITFIELD_BIT(RenderStageVertex);
+    MTL_STRINGISE_BITFIELD_BIT(RenderStageFragment);
+    MTL_STRINGISE_BITFIELD_BIT(RenderStageTile);
+    MTL_STRINGISE_BITFIELD_BIT(RenderStageObject);
+    MTL_STRINGISE_BITFIELD_BIT(RenderStageMesh);
+  }
+  END_BITFIELD_STRINGISE()
+}
+
 template <>
 rdcstr DoStringise(const MTL::DeviceLocation &el)
 {
@@ -159,6 +159,8 @@ MTL_DECLARE_REFLECTION_TYPE(ArgumentBuffersTier);
 MTL_DECLARE_REFLECTION_TYPE(DepthClipMode);
 MTL_DECLARE_REFLECTION_TYPE(TriangleFillMode);
 MTL_DECLARE_REFLECTION_TYPE(CullMode);
+MTL_DECLARE_REFLECTION_TYPE(ResourceUsage);
+MTL_DECLARE_REFLECTION_TYPE(RenderStages);
 
 template <>
 inline rdcliteral TypeName<NS::Range>()
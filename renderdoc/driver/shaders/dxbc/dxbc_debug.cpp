@@ -1977,7 +1977,8 @@ void ThreadState::StepNext(ShaderDebugState *state, DebugAPIWrapper *apiWrapper,
     debug->GetCallstack(nextInstruction, nextOp.offset, state->callstack);
   }
 
-  rdcarray<ShaderVariable> srcOpers;
+  rdcarray<ShaderVariable> &srcOpers = m_SrcOpers;
+  srcOpers.clear();
 
   VarType optype = OperationType(op.operation);
 
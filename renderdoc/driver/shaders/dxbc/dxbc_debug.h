@@ -328,6 +328,10 @@ private:
 
   rdcarray<BindpointIndex> m_accessedSRVs;
   rdcarray<BindpointIndex> m_accessedUAVs;
+
+  // source operands for the current instruction. Kept between steps so that stepping doesn't need
+  // to reallocate the array every time
+  rdcarray<ShaderVariable> m_SrcOpers;
 };
 
 struct InterpretDebugger : public ShaderDebugger
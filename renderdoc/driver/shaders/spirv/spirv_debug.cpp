@@ -340,20 +340,28 @@ void ThreadState::SetDst(Id id, const ShaderVariable &val)
   if(m_State && ContainsNaNInf(val))
     m_State->flags |= ShaderEvents::GeneratedNanOrInf;
 
-  ShaderVariable prev = ids[id];
+  ShaderVariable &dst = ids[id];
 
   // if this id didn't exist before it's not a global so it's a local variable, function parameter,
   // or plain id. Track it in the current frame so it's emptied upon return
-  if(prev.name.empty() && prev.type == VarType::Unknown)
+  if(dst.name.empty() && dst.type == VarType::Unknown)
     callstack.back()->idsCreated.push_back(id);
 
-  ids[id] = val;
-  ids[id].name = GetRawName(id);
+  // only copy out the previous value when we're recording a change, lanes that aren't being traced
+  // write straight through
+  ShaderVariableChange change;
+  if(m_State)
+    change.before = debugger.GetPointerValue(dst);
+
+  dst = val;
+  dst.name = GetRawName(id);
 
   lastWrite[id] = m_State ? m_State->stepIndex : nextInstruction;
 
+  // ids written repeatedly (e.g. in a loop) are already live, don't add duplicates
   auto it = std::lower_bound(live.begin(), live.end(), id);
-  live.insert(it - live.begin(), id);
+  if(it == live.end() || *it != id)
+    live.insert(it - live.begin(), id);
 
   if(val.type == VarType::GPUPointer)
   {
@@ -367,9 +375,7 @@ void ThreadState::SetDst(Id id, const ShaderVariable &val)
 
   if(m_State)
   {
-    ShaderVariableChange change;
-    change.before = debugger.GetPointerValue(prev);
-    change.after = debugger.GetPointerValue(ids[id]);
+    change.after = debugger.GetPointerValue(dst);
     m_State->changes.push_back(change);
   }
 }
@@ -500,8 +506,9 @@ ShaderVariable ThreadState::CalcDeriv(ThreadState::DerivDir dir, ThreadState::De
     return ShaderVariable("", 0.0f, 0.0f, 0.0f, 0.0f);
   }
 
-  ShaderVariable aval = a->GetSrc(val);
-  ShaderVariable bval = b->GetSrc(val);
+  // read the other lanes' values in place, only the result needs a copy
+  const ShaderVariable &aval = a->GetSrc(val);
+  const ShaderVariable &bval = b->GetSrc(val);
   ShaderVariable var = aval;
 
   for(uint8_t c = 0; c < var.columns; c++)
@@ -1930,7 +1937,7 @@ void ThreadState::StepNext(ShaderDebugState *state, const rdcarray<ThreadState>
         }
         else
         {
-          ShaderVariable b = workgroup[i].GetSrc(group.value);
+          const ShaderVariable &b = workgroup[i].GetSrc(group.value);
 
           for(uint8_t c = 0; c < var.columns; c++)
           {
@@ -459,6 +459,7 @@ private:
   struct Function
   {
     size_t begin = 0;
+    uint32_t beginInstruction = 0;
     rdcarray<Id> parameters;
     rdcarray<Id> variables;
   };
@@ -308,12 +308,18 @@ Iter Debugger::GetIterForInstruction(uint32_t inst)
 
 uint32_t Debugger::GetInstructionForIter(Iter it)
 {
-  return instructionOffsets.indexOf(it.offs());
+  // instruction offsets are recorded in order while parsing, so we can binary search
+  const size_t *begin = instructionOffsets.begin();
+  const size_t *end = instructionOffsets.end();
+  const size_t *found = std::lower_bound(begin, end, it.offs());
+  if(found == end || *found != it.offs())
+    return ~0U;
+  return uint32_t(found - begin);
 }
 
 uint32_t Debugger::GetInstructionForFunction(Id id)
 {
-  return instructionOffsets.indexOf(functions[id].begin);
+  return functions[id].beginInstruction;
 }
 
 uint32_t Debugger::GetInstructionForLabel(Id id)
@@ -824,7 +830,7 @@ ShaderDebugTrace *Debugger::BeginDebug(DebugAPIWrapper *api, const ShaderStage s
 
   ThreadState &active = GetActiveLane();
 
-  active.nextInstruction = instructionOffsets.indexOf(functions[entryId].begin);
+  active.nextInstruction = GetInstructionForFunction(entryId);
 
   active.ids.resize(idOffsets.size());
 
@@ -2653,23 +2659,23 @@ void Debugger::CalcActiveMask(rdcarray<bool> &activeMask)
 
   if(wasDiverged || diverged)
   {
-    // for every thread, turn it off if it's in the converge block
-    rdcarray<bool> inConverge;
-    inConverge.resize(activeMask.size());
-    for(size_t i = 0; i < workgroup.size(); i++)
-      inConverge[i] = (!workgroup[i].callstack.empty() &&
-                       workgroup[i].callstack.back()->curBlock == convergeBlock);
+    // for every thread, turn it off if it's in the converge block. This runs every step while
+    // diverged so check in place rather than allocating a per-thread array each time
+    auto inConverge = [this](size_t i) {
+      return !workgroup[i].callstack.empty() &&
+             workgroup[i].callstack.back()->curBlock == convergeBlock;
+    };
 
     // is any thread active, but not converged?
     bool anyActiveNotConverged = false;
-    for(size_t i = 0; i < workgroup.size(); i++)
-      anyActiveNotConverged |= activeMask[i] && !inConverge[i];
+    for(size_t i = 0; !anyActiveNotConverged && i < workgroup.size(); i++)
+      anyActiveNotConverged = activeMask[i] && !inConverge(i);
 
     if(anyActiveNotConverged)
     {
       // if so, then only non-converged threads are active right now
       for(size_t i = 0; i < workgroup.size(); i++)
-        activeMask[i] &= !inConverge[i];
+        activeMask[i] = activeMask[i] && !inConverge(i);
     }
     else
     {
@@ -3598,6 +3604,7 @@ void Debugger::RegisterOp(Iter it)
     curFunction = &functions[func.result];
 
     curFunction->begin = it.offs();
+    curFunction->beginInstruction = (uint32_t)instructionOffsets.count();
   }
   else if(opdata.op == Op::FunctionParameter)
   {
@@ -729,6 +729,65 @@ TEST_CASE("Test ImageState type", "[imagestate]")
       CheckSubresourceState(it->state(), readSubstate);
     }
   };
+
+  SECTION("Barrier sequence optimisation")
+  {
+    VkImageMemoryBarrier barrier = {
+        /* sType = */ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        /* pNext = */ NULL,
+        /* srcAccessMask = */ VK_ACCESS_TRANSFER_WRITE_BIT,
+        /* dstAccessMask = */ VK_ACCESS_SHADER_READ_BIT,
+        /* oldLayout = */ VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        /* newLayout = */ VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        /* srcQueueFamilyIndex = */ 0,
+        /* dstQueueFamilyIndex = */ 0,
+        /* image = */ image,
+        /* subresourceRange = */ {VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1},
+    };
+
+    ImageBarrierSequence barriers;
+
+    // one barrier per mip and layer, as Transition() generates for a fully split image
+    for(uint32_t level = 0; level < 3; level++)
+    {
+      for(uint32_t layer = 0; layer < 4; layer++)
+      {
+        barrier.subresourceRange.baseMipLevel = level;
+        barrier.subresourceRange.baseArrayLayer = layer;
+        barriers.AddWrapped(1, 0, barrier);
+      }
+    }
+
+    // a transition there and back again on another image
+    VkImageMemoryBarrier other = barrier;
+    other.image = (VkImage)456;
+    other.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    barriers.AddWrapped(1, 0, other);
+    std::swap(other.oldLayout, other.newLayout);
+    barriers.AddWrapped(1, 0, other);
+
+    // ownership transfers are never folded
+    other.srcQueueFamilyIndex = 1;
+    barriers.AddWrapped(1, 0, other);
+
+    CHECK(barriers.size() == 15);
+
+    barriers.Optimise();
+
+    CHECK(barriers.size() == 2);
+    REQUIRE(barriers.batches[1][0].size() == 2);
+
+    const VkImageMemoryBarrier &combined = barriers.batches[1][0][0];
+    CHECK(combined.image == image);
+    CHECK(combined.subresourceRange.baseMipLevel == 0);
+    CHECK(combined.subresourceRange.levelCount == 3);
+    CHECK(combined.subresourceRange.baseArrayLayer == 0);
+    CHECK(combined.subresourceRange.layerCount == 4);
+
+    const VkImageMemoryBarrier &transfer = barriers.batches[1][0][1];
+    CHECK(transfer.image == other.image);
+    CHECK(transfer.srcQueueFamilyIndex == 1);
+  };
 };
 
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
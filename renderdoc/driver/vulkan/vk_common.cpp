@@ -362,6 +362,14 @@ bool VkInitParams::IsSupportedVersion(uint64_t ver)
   if(ver == CurrentVersion)
     return true;
 
+  // 0x16 -> 0x17 - identical memory and image initial contents reference the first copy
+  if(ver == 0x16)
+    return true;
+
+  // 0x15 -> 0x16 - constant tiles are elided from memory and image initial contents
+  if(ver == 0x15)
+    return true;
+
   // 0x14 -> 0x15 - added support for mutable descriptors
   if(ver == 0x14)
     return true;
@@ -566,6 +574,61 @@ VkShaderStageFlags ShaderMaskFromIndex(size_t index)
   return 0;
 }
 
+static bool IsConstantTile(const byte *data, uint64_t size, uint32_t &value)
+{
+  memcpy(&value, data, sizeof(value));
+
+  // compare 64-bits at a time, tiles are always a multiple of 8 bytes
+  uint64_t value64 = uint64_t(value) | (uint64_t(value) << 32);
+
+  const uint64_t *cur = (const uint64_t *)data;
+  const uint64_t *end = (const uint64_t *)(data + size);
+
+  for(; cur < end; cur++)
+  {
+    if(*cur != value64)
+      return false;
+  }
+
+  return true;
+}
+
+void FindConstantTiles(const byte *data, uint64_t size, uint64_t tileSize,
+                       rdcarray<uint32_t> &tiles, rdcarray<uint32_t> &values)
+{
+  tiles.clear();
+  values.clear();
+
+  if(data == NULL || tileSize == 0 || (tileSize % sizeof(uint64_t)) != 0)
+    return;
+
+  // only consider full tiles, any trailing partial tile is always stored as-is
+  const uint64_t numTiles = size / tileSize;
+
+  for(uint64_t t = 0; t < numTiles; t++)
+  {
+    uint32_t value = 0;
+    if(IsConstantTile(data + t * tileSize, tileSize, value))
+    {
+      tiles.push_back(uint32_t(t));
+      values.push_back(value);
+    }
+  }
+}
+
+void FillConstantTile(byte *data, uint64_t size, uint32_t value)
+{
+  if(value == 0)
+  {
+    memset(data, 0, (size_t)size);
+    return;
+  }
+
+  uint32_t *cur = (uint32_t *)data;
+  for(uint64_t i = 0; i < size / sizeof(uint32_t); i++)
+    cur[i] = value;
+}
+
 void DoPipelineBarrier(VkCommandBuffer cmd, size_t count, const VkImageMemoryBarrier *barriers)
 {
   RDCASSERT(cmd != VK_NULL_HANDLE);
@@ -1190,6 +1253,54 @@ void DescriptorSetSlot::SetTexelBuffer(VkDescriptorType writeType, ResourceId id
   resource = id;
 }
 
+void DescriptorSetSlot::SetBuffers(DescriptorSetSlot *slots, uint32_t count,
+                                   VkDescriptorType writeType, const VkDescriptorBufferInfo *bufInfos)
+{
+  const DescriptorSlotType slotType = convert(writeType);
+
+  for(uint32_t i = 0; i < count; i++)
+  {
+    slots[i].type = slotType;
+    slots[i].resource = GetResID(bufInfos[i].buffer);
+    slots[i].offset = bufInfos[i].offset;
+    slots[i].range = bufInfos[i].range;
+    if(bufInfos[i].range > VK_WHOLE_SIZE)
+      RDCWARN("Unrepresentable buffer range size: %llx", bufInfos[i].range);
+  }
+}
+
+void DescriptorSetSlot::SetImages(DescriptorSetSlot *slots, uint32_t count,
+                                  VkDescriptorType writeType, const VkDescriptorImageInfo *imInfos,
+                                  bool useSampler)
+{
+  const DescriptorSlotType slotType = convert(writeType);
+  const bool hasSampler = useSampler && (slotType == DescriptorSlotType::CombinedImageSampler ||
+                                         slotType == DescriptorSlotType::Sampler);
+  const bool hasImage = slotType != DescriptorSlotType::Sampler;
+
+  for(uint32_t i = 0; i < count; i++)
+  {
+    slots[i].type = slotType;
+    if(hasSampler)
+      slots[i].sampler = GetResID(imInfos[i].sampler);
+    if(hasImage)
+      slots[i].resource = GetResID(imInfos[i].imageView);
+    slots[i].imageLayout = convert(imInfos[i].imageLayout);
+  }
+}
+
+void DescriptorSetSlot::SetTexelBuffers(DescriptorSetSlot *slots, uint32_t count,
+                                        VkDescriptorType writeType, const VkBufferView *views)
+{
+  const DescriptorSlotType slotType = convert(writeType);
+
+  for(uint32_t i = 0; i < count; i++)
+  {
+    slots[i].type = slotType;
+    slots[i].resource = GetResID(views[i]);
+  }
+}
+
 void AddBindFrameRef(DescriptorBindRefs &refs, ResourceId id, FrameRefType ref)
 {
   if(id == ResourceId())
@@ -1548,4 +1659,73 @@ TEST_CASE("Validate CombineDepthStencilLayouts works", "[vulkan]")
   };
 }
 
+TEST_CASE("Validate constant tile detection", "[vulkan]")
+{
+  const uint64_t tileSize = 256;
+
+  bytebuf data;
+  data.resize(tileSize * 4 + 40);
+
+  // tile 0 is zero, tile 1 is a repeated value, tile 2 varies, tile 3 is the same value as tile 1
+  // and the trailing partial tile is constant but should not be detected
+  FillConstantTile(data.data(), tileSize, 0);
+  FillConstantTile(data.data() + tileSize, tileSize, 0xdeadbeef);
+  for(uint64_t i = 0; i < tileSize; i++)
+    data[size_t(tileSize * 2 + i)] = byte(i);
+  FillConstantTile(data.data() + tileSize * 3, tileSize, 0xdeadbeef);
+  FillConstantTile(data.data() + tileSize * 4, 40, 0);
+
+  rdcarray<uint32_t> tiles, values;
+
+  SECTION("Constant tiles are found")
+  {
+    FindConstantTiles(data.data(), data.size(), tileSize, tiles, values);
+
+    REQUIRE(tiles.size() == 3);
+    REQUIRE(values.size() == 3);
+    CHECK(tiles[0] == 0);
+    CHECK(values[0] == 0);
+    CHECK(tiles[1] == 1);
+    CHECK(values[1] == 0xdeadbeef);
+    CHECK(tiles[2] == 3);
+    CHECK(values[2] == 0xdeadbeef);
+  };
+
+  SECTION("A single differing byte makes a tile non-constant")
+  {
+    data[size_t(tileSize + tileSize - 1)] = 0;
+
+    FindConstantTiles(data.data(), data.size(), tileSize, tiles, values);
+
+    REQUIRE(tiles.size() == 2);
+    CHECK(tiles[0] == 0);
+    CHECK(tiles[1] == 3);
+  };
+
+  SECTION("Filling constant tiles reconstructs the data")
+  {
+    FindConstantTiles(data.data(), data.size(), tileSize, tiles, values);
+
+    bytebuf reconstructed = data;
+    for(size_t i = 0; i < tiles.size(); i++)
+      FillConstantTile(reconstructed.data() + tiles[i] * tileSize, tileSize, 0x12345678);
+    for(size_t i = 0; i < tiles.size(); i++)
+      FillConstantTile(reconstructed.data() + tiles[i] * tileSize, tileSize, values[i]);
+
+    CHECK(memcmp(reconstructed.data(), data.data(), data.size()) == 0);
+  };
+
+  SECTION("Invalid parameters find nothing")
+  {
+    FindConstantTiles(NULL, data.size(), tileSize, tiles, values);
+    CHECK(tiles.empty());
+
+    FindConstantTiles(data.data(), data.size(), 0, tiles, values);
+    CHECK(tiles.empty());
+
+    FindConstantTiles(data.data(), tileSize - 8, tileSize, tiles, values);
+    CHECK(tiles.empty());
+  };
+};
+
 #endif
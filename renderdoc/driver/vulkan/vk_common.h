@@ -116,6 +116,16 @@ int SampleIndex(VkSampleCountFlagBits countFlag);
 int StageIndex(VkShaderStageFlagBits stageFlag);
 VkShaderStageFlags ShaderMaskFromIndex(size_t index);
 
+// initial contents are split into tiles of this size, and any tile consisting of a single repeated
+// 32-bit value is stored as just that value rather than the full data.
+static const uint64_t InitialContentsTileSize = 64 * 1024;
+
+// find the full tiles in data which are a single repeated 32-bit value. tiles is filled with the
+// indices in ascending order and values with the corresponding repeated value.
+void FindConstantTiles(const byte *data, uint64_t size, uint64_t tileSize,
+                       rdcarray<uint32_t> &tiles, rdcarray<uint32_t> &values);
+void FillConstantTile(byte *data, uint64_t size, uint32_t value);
+
 struct PackedWindowHandle
 {
   PackedWindowHandle(WindowingSystem s, void *h) : system(s), handle(h) {}
@@ -651,6 +661,14 @@ struct DescriptorSetSlot
   void SetImage(VkDescriptorType writeType, const VkDescriptorImageInfo &imInfo, bool useSampler);
   void SetTexelBuffer(VkDescriptorType writeType, ResourceId id);
 
+  // set a run of consecutive slots from one descriptor write, converting the type only once
+  static void SetBuffers(DescriptorSetSlot *slots, uint32_t count, VkDescriptorType writeType,
+                         const VkDescriptorBufferInfo *bufInfos);
+  static void SetImages(DescriptorSetSlot *slots, uint32_t count, VkDescriptorType writeType,
+                        const VkDescriptorImageInfo *imInfos, bool useSampler);
+  static void SetTexelBuffers(DescriptorSetSlot *slots, uint32_t count, VkDescriptorType writeType,
+                              const VkBufferView *views);
+
   // 48-bit truncated VK_WHOLE_SIZE
   static const VkDeviceSize WholeSizeRange = 0xFFFFFFFFFFFF;
   VkDeviceSize GetRange() const { return range == WholeSizeRange ? VK_WHOLE_SIZE : range; }
@@ -727,6 +745,10 @@ struct BindingStorage
     memcpy(inlineData, inlineBytes.data(), inlineSize);
   }
 
+  // raw view of every slot, to cheaply check if the contents have changed
+  const byte *slotData() const { return (const byte *)elems.data(); }
+  size_t slotDataSize() const { return elems.byteSize(); }
+
 private:
   rdcarray<DescriptorSetSlot> elems;
   friend struct DescSetLayout;
@@ -38,11 +38,36 @@
 #include "stb/stb_image_write.h"
 
 RDOC_EXTERN_CONFIG(bool, Vulkan_Debug_VerboseCommandRecording);
+RDOC_EXTERN_CONFIG(bool, Capture_StoreChunkIndex);
+RDOC_EXTERN_CONFIG(uint32_t, Capture_PreSnapshotFrames);
+RDOC_EXTERN_CONFIG(bool, Capture_ZstdFrameCapture);
+
+RDOC_CONFIG(rdcstr, Vulkan_CaptureRangeLabel, "",
+            "Capture only the work inside debug labels with exactly this name, instead of whole "
+            "frames. A command buffer label captures just the submission of that command buffer. "
+            "A queue label captures everything submitted to that queue until the label ends.");
+
+RDOC_CONFIG(uint32_t, Vulkan_DebugMessageRepeatLimit, 10,
+            "While capturing with API validation enabled, how many times an identical validation "
+            "message is stored in the capture. Further repeats are only counted. 0 stores every "
+            "message.");
 
 RDOC_DEBUG_CONFIG(bool, Vulkan_Debug_SingleSubmitFlushing, false,
                   "Every command buffer is submitted and fully flushed to the GPU, to narrow down "
                   "the source of problems.");
 
+RDOC_DEBUG_CONFIG(bool, Vulkan_Debug_DisableBarrierOptimisation, false,
+                  "Submit image state barriers exactly as generated, without folding redundant "
+                  "transitions or combining barriers on neighbouring subresources.");
+
+RDOC_DEBUG_CONFIG(bool, Vulkan_Debug_DisableForwardReplay, false,
+                  "Always replay from the start of the frame when selecting a later event, instead "
+                  "of continuing on from the previously selected event where possible.");
+
+RDOC_DEBUG_CONFIG(bool, Vulkan_Debug_AlwaysResetWrittenResources, false,
+                  "Reset every resource written in the frame when replaying from the start, even if "
+                  "the previous replays didn't reach any of its writes.");
+
 uint64_t VkInitParams::GetSerialiseSize()
 {
   // misc bytes and fixed integer members
@@ -126,8 +151,8 @@ WrappedVulkan::WrappedVulkan()
   m_Replay = new VulkanReplay(this);
 
   threadSerialiserTLSSlot = Threading::AllocateTLSSlot();
-  tempMemoryTLSSlot = Threading::AllocateTLSSlot();
   debugMessageSinkTLSSlot = Threading::AllocateTLSSlot();
+  debugMessageRepeatsTLSSlot = Threading::AllocateTLSSlot();
 
   m_RootEventID = 1;
   m_RootActionID = 1;
@@ -198,11 +223,8 @@ WrappedVulkan::~WrappedVulkan()
   for(size_t i = 0; i < m_ThreadSerialisers.size(); i++)
     delete m_ThreadSerialisers[i];
 
-  for(size_t i = 0; i < m_ThreadTempMem.size(); i++)
-  {
-    delete[] m_ThreadTempMem[i]->memory;
-    delete m_ThreadTempMem[i];
-  }
+  for(size_t i = 0; i < m_DebugMessageRepeats.size(); i++)
+    delete m_DebugMessageRepeats[i];
 
   delete m_Replay;
 }
@@ -352,6 +374,8 @@ void WrappedVulkan::SubmitCmds(VkSemaphore *unwrappedWaitSemaphores,
     CheckVkResult(vkr);
   }
 
+  m_InternalSubmitCount++;
+
   m_InternalCmds.submittedcmds.append(m_InternalCmds.pendingcmds);
   m_InternalCmds.pendingcmds.clear();
 
@@ -493,6 +517,9 @@ void WrappedVulkan::SubmitAndFlushImageStateBarriers(ImageBarrierSequence &barri
   if(HasFatalError())
     return;
 
+  if(!Vulkan_Debug_DisableBarrierOptimisation())
+    barriers.Optimise();
+
   if(barriers.empty())
     return;
 
@@ -595,6 +622,9 @@ void WrappedVulkan::SubmitAndFlushImageStateBarriers(ImageBarrierSequence &barri
 
 void WrappedVulkan::InlineSetupImageBarriers(VkCommandBuffer cmd, ImageBarrierSequence &barriers)
 {
+  if(!Vulkan_Debug_DisableBarrierOptimisation())
+    barriers.Optimise();
+
   rdcarray<VkImageMemoryBarrier> batch;
   barriers.ExtractLastUnwrappedBatchForQueue(m_QueueFamilyIdx, batch);
   if(!batch.empty())
@@ -603,6 +633,9 @@ void WrappedVulkan::InlineSetupImageBarriers(VkCommandBuffer cmd, ImageBarrierSe
 
 void WrappedVulkan::InlineCleanupImageBarriers(VkCommandBuffer cmd, ImageBarrierSequence &barriers)
 {
+  if(!Vulkan_Debug_DisableBarrierOptimisation())
+    barriers.Optimise();
+
   rdcarray<VkImageMemoryBarrier> batch;
   barriers.ExtractFirstUnwrappedBatchForQueue(m_QueueFamilyIdx, batch);
   if(!batch.empty())
@@ -686,97 +719,102 @@ void WrappedVulkan::SetDebugMessageSink(WrappedVulkan::ScopedDebugMessageSink *s
   Threading::SetTLSValue(debugMessageSinkTLSSlot, (void *)sink);
 }
 
-byte *WrappedVulkan::GetRingTempMemory(size_t s)
+WriteSerialiser &WrappedVulkan::GetThreadSerialiser()
 {
-  TempMem *mem = (TempMem *)Threading::GetTLSValue(tempMemoryTLSSlot);
+  WriteSerialiser *ser = (WriteSerialiser *)Threading::GetTLSValue(threadSerialiserTLSSlot);
+  if(ser)
+    return *ser;
 
-  if(!mem || mem->size < s)
-  {
-    if(mem && mem->size < s)
-      RDCWARN("More than %zu bytes needed to unwrap!", mem->size);
+  // slow path, but rare
+  ser = new WriteSerialiser(new StreamWriter(1024), Ownership::Stream);
+
+  uint32_t flags = WriteSerialiser::ChunkDuration | WriteSerialiser::ChunkTimestamp |
+                   WriteSerialiser::ChunkThreadID;
 
-    mem = new TempMem();
-    mem->size = AlignUp(s, size_t(4 * 1024 * 1024));
-    mem->memory = mem->cur = new byte[mem->size];
+  if(RenderDoc::Inst().GetCaptureOptions().captureCallstacks)
+    flags |= WriteSerialiser::ChunkCallstack;
 
-    SCOPED_LOCK(m_ThreadTempMemLock);
-    m_ThreadTempMem.push_back(mem);
+  ser->SetChunkMetadataRecording(flags);
+  ser->SetUserData(GetResourceManager());
+  ser->SetVersion(VkInitParams::CurrentVersion);
 
-    Threading::SetTLSValue(tempMemoryTLSSlot, (void *)mem);
-  }
+  Threading::SetTLSValue(threadSerialiserTLSSlot, (void *)ser);
 
-  // if we'd wrap, go back to the start
-  if(mem->cur + s >= mem->memory + mem->size)
-    mem->cur = mem->memory;
+  {
+    SCOPED_LOCK(m_ThreadSerialisersLock);
+    m_ThreadSerialisers.push_back(ser);
+  }
 
-  // save the return value and update the cur pointer
-  byte *ret = mem->cur;
-  mem->cur = AlignUpPtr(mem->cur + s, 16);
-  return ret;
+  return *ser;
 }
 
-byte *WrappedVulkan::GetTempMemory(size_t s)
+WrappedVulkan::DebugMessageRepeats &WrappedVulkan::GetDebugMessageRepeats()
 {
-  if(IsReplayMode(m_State))
-    return GetRingTempMemory(s);
-
-  TempMem *mem = (TempMem *)Threading::GetTLSValue(tempMemoryTLSSlot);
-  if(mem && mem->size >= s)
-    return mem->memory;
+  DebugMessageRepeats *ret =
+      (DebugMessageRepeats *)Threading::GetTLSValue(debugMessageRepeatsTLSSlot);
+  if(ret)
+    return *ret;
 
-  // alloc or grow alloc
-  TempMem *newmem = mem;
+  // slow path, once per thread
+  ret = new DebugMessageRepeats;
 
-  if(!newmem)
-    newmem = new TempMem();
+  Threading::SetTLSValue(debugMessageRepeatsTLSSlot, (void *)ret);
 
-  // free old memory, don't need to keep contents
-  if(newmem->memory)
-    delete[] newmem->memory;
-
-  // alloc new memory
-  newmem->size = s;
-  newmem->memory = new byte[s];
-
-  Threading::SetTLSValue(tempMemoryTLSSlot, (void *)newmem);
-
-  // if this is entirely new, save it for deletion on shutdown
-  if(!mem)
   {
-    SCOPED_LOCK(m_ThreadTempMemLock);
-    m_ThreadTempMem.push_back(newmem);
+    SCOPED_LOCK(m_DebugMessageRepeatsLock);
+    m_DebugMessageRepeats.push_back(ret);
   }
 
-  return newmem->memory;
+  return *ret;
 }
 
-WriteSerialiser &WrappedVulkan::GetThreadSerialiser()
+bool WrappedVulkan::ShouldStoreDebugMessage(int messageCode, const char *pMessage, bool &lastStored)
 {
-  WriteSerialiser *ser = (WriteSerialiser *)Threading::GetTLSValue(threadSerialiserTLSSlot);
-  if(ser)
-    return *ser;
+  lastStored = false;
 
-  // slow path, but rare
-  ser = new WriteSerialiser(new StreamWriter(1024), Ownership::Stream);
+  const uint32_t limit = Vulkan_DebugMessageRepeatLimit();
+  if(limit == 0)
+    return true;
 
-  uint32_t flags = WriteSerialiser::ChunkDuration | WriteSerialiser::ChunkTimestamp |
-                   WriteSerialiser::ChunkThreadID;
+  DebugMessageRepeats &repeats = GetDebugMessageRepeats();
 
-  if(RenderDoc::Inst().GetCaptureOptions().captureCallstacks)
-    flags |= WriteSerialiser::ChunkCallstack;
+  // start counting afresh for each capture
+  if(repeats.captureIndex != m_DebugMessageCaptureIndex)
+  {
+    repeats.captureIndex = m_DebugMessageCaptureIndex;
+    repeats.counts.clear();
+    repeats.suppressed = 0;
+  }
 
-  ser->SetChunkMetadataRecording(flags);
-  ser->SetUserData(GetResourceManager());
-  ser->SetVersion(VkInitParams::CurrentVersion);
+  // the message text includes the objects involved, so identical text means the same problem with
+  // the same objects
+  const uint32_t len = pMessage ? (uint32_t)strlen(pMessage) : 0;
+  const uint64_t key =
+      (uint64_t(len) << 32) | strhash(pMessage ? pMessage : "", 5381 + (uint32_t)messageCode);
 
-  Threading::SetTLSValue(threadSerialiserTLSSlot, (void *)ser);
+  uint32_t &count = repeats.counts[key];
+  count++;
 
+  if(count > limit)
   {
-    SCOPED_LOCK(m_ThreadSerialisersLock);
-    m_ThreadSerialisers.push_back(ser);
+    repeats.suppressed++;
+    return false;
   }
 
-  return *ser;
+  lastStored = (count == limit);
+  return true;
+}
+
+uint64_t WrappedVulkan::GetSuppressedDebugMessageCount()
+{
+  uint64_t ret = 0;
+
+  SCOPED_LOCK(m_DebugMessageRepeatsLock);
+  for(DebugMessageRepeats *repeats : m_DebugMessageRepeats)
+    if(repeats->captureIndex == m_DebugMessageCaptureIndex)
+      ret += repeats->suppressed;
+
+  return ret;
 }
 
 static VkResult FillPropertyCountAndList(const VkExtensionProperties *src, uint32_t numExts,
@@ -1875,6 +1913,8 @@ void WrappedVulkan::StartFrameCapture(DeviceOwnedWindow devWnd)
 
   Atomic::Dec32(&m_ReuseEnabled);
 
+  Atomic::Inc32(&m_DebugMessageCaptureIndex);
+
   m_CaptureTimer.Restart();
 
   GetResourceManager()->ResetCaptureStartTime();
@@ -1899,36 +1939,7 @@ void WrappedVulkan::StartFrameCapture(DeviceOwnedWindow devWnd)
   {
     SCOPED_WRITELOCK(m_CapTransitionLock);
 
-    // wait for all work to finish and apply a memory barrier to ensure all memory is visible
-    for(size_t i = 0; i < m_QueueFamilies.size(); i++)
-    {
-      for(uint32_t q = 0; q < m_QueueFamilyCounts[i]; q++)
-      {
-        if(m_QueueFamilies[i][q] != VK_NULL_HANDLE)
-          ObjDisp(m_QueueFamilies[i][q])->QueueWaitIdle(Unwrap(m_QueueFamilies[i][q]));
-      }
-    }
-
-    {
-      VkMemoryBarrier memBarrier = {
-          VK_STRUCTURE_TYPE_MEMORY_BARRIER, NULL, VK_ACCESS_ALL_WRITE_BITS, VK_ACCESS_ALL_READ_BITS,
-      };
-
-      VkCommandBuffer cmd = GetNextCmd();
-
-      VkResult vkr = VK_SUCCESS;
-
-      VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
-                                            VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
-
-      vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
-      CheckVkResult(vkr);
-
-      DoPipelineBarrier(cmd, 1, &memBarrier);
-
-      vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
-      CheckVkResult(vkr);
-    }
+    WaitForGPUWrites();
 
     GetResourceManager()->PrepareInitialContents();
     SubmitAndFlushImageStateBarriers(m_setupImageBarriers);
@@ -2000,6 +2011,10 @@ bool WrappedVulkan::EndFrameCapture(DeviceOwnedWindow devWnd)
 
   RDCLOG("Finished capture, Frame %u", m_CapturedFrames.back().frameNumber);
 
+  uint64_t suppressedMessages = GetSuppressedDebugMessageCount();
+  if(suppressedMessages > 0)
+    RDCLOG("Dropped %llu repeated API validation messages", suppressedMessages);
+
   VkImage backbuffer = VK_NULL_HANDLE;
   const ImageInfo *swapImageInfo = NULL;
   uint32_t swapQueueIndex = 0;
@@ -2293,8 +2308,9 @@ bool WrappedVulkan::EndFrameCapture(DeviceOwnedWindow devWnd)
   {
     SectionProperties props;
 
-    // Compress with LZ4 so that it's fast
-    props.flags = SectionFlags::LZ4Compressed;
+    // Compress with LZ4 so that it's fast, unless smaller captures have been asked for
+    props.flags =
+        Capture_ZstdFrameCapture() ? SectionFlags::ZstdCompressed : SectionFlags::LZ4Compressed;
     props.version = m_SectionVersion;
     props.type = SectionType::FrameCapture;
 
@@ -2306,6 +2322,9 @@ bool WrappedVulkan::EndFrameCapture(DeviceOwnedWindow devWnd)
   }
 
   uint64_t captureSectionSize = 0;
+  bool captureFollows = false;
+
+  ChunkStatistics chunkStats;
 
   {
     WriteSerialiser ser(captureWriter, Ownership::Stream);
@@ -2324,8 +2343,17 @@ bool WrappedVulkan::EndFrameCapture(DeviceOwnedWindow devWnd)
 
     GetResourceManager()->InsertReferencedChunks(ser);
 
+    m_InitialContentsHashes.clear();
+
+    // if another capture starts straight after this one, keep what we can of the initial contents
+    // so it doesn't have to prepare everything again
+    captureFollows = RenderDoc::Inst().GetFramesUntilQueuedCapture(m_FrameCounter) == 0;
+    GetResourceManager()->SetRetainInitialContents(captureFollows);
+
     GetResourceManager()->InsertInitialContentsChunks(ser);
 
+    m_InitialContentsHashes.clear();
+
     RDCDEBUG("Creating Capture Scope");
 
     GetResourceManager()->Serialise_InitialContentsNeeded(ser);
@@ -2346,6 +2374,7 @@ bool WrappedVulkan::EndFrameCapture(DeviceOwnedWindow devWnd)
       m_HeaderChunk = scope.Get();
     }
     m_HeaderChunk->Write(ser);
+    chunkStats.Add(m_HeaderChunk);
 
     // don't need to lock access to m_CmdBufferRecords as we are no longer
     // in capframe (the transition is thread-protected) so nothing will be
@@ -2393,6 +2422,7 @@ bool WrappedVulkan::EndFrameCapture(DeviceOwnedWindow devWnd)
         RenderDoc::Inst().SetProgress(CaptureProgress::SerialiseFrameContents, idx / num);
         idx += 1.0f;
         it->second->Write(ser);
+        chunkStats.Add(it->second);
       }
 
       RDCDEBUG("Done");
@@ -2404,6 +2434,9 @@ bool WrappedVulkan::EndFrameCapture(DeviceOwnedWindow devWnd)
   RDCLOG("Captured Vulkan frame with %f MB capture section in %f seconds",
          double(captureSectionSize) / (1024.0 * 1024.0), m_CaptureTimer.GetMilliseconds() / 1000.0);
 
+  if(rdc)
+    chunkStats.Write(rdc, &GetChunkName);
+
   RenderDoc::Inst().FinishCaptureWriting(rdc, m_CapturedFrames.back().frameNumber);
 
   m_HeaderChunk->Delete();
@@ -2427,9 +2460,16 @@ bool WrappedVulkan::EndFrameCapture(DeviceOwnedWindow devWnd)
 
   GetResourceManager()->ClearReferencedResources();
 
-  GetResourceManager()->FreeInitialContents();
+  if(captureFollows)
+  {
+    GetResourceManager()->RetainInitialContentsForNextCapture();
+  }
+  else
+  {
+    GetResourceManager()->FreeInitialContents();
 
-  FreeAllMemory(MemoryScope::InitialContents);
+    FreeAllMemory(MemoryScope::InitialContents);
+  }
 
   return true;
 }
@@ -2488,6 +2528,71 @@ bool WrappedVulkan::DiscardFrameCapture(DeviceOwnedWindow devWnd)
   return true;
 }
 
+void WrappedVulkan::WaitForGPUWrites()
+{
+  // wait for all work to finish and apply a memory barrier to ensure all memory is visible
+  for(size_t i = 0; i < m_QueueFamilies.size(); i++)
+  {
+    for(uint32_t q = 0; q < m_QueueFamilyCounts[i]; q++)
+    {
+      if(m_QueueFamilies[i][q] != VK_NULL_HANDLE)
+        ObjDisp(m_QueueFamilies[i][q])->QueueWaitIdle(Unwrap(m_QueueFamilies[i][q]));
+    }
+  }
+
+  VkMemoryBarrier memBarrier = {
+      VK_STRUCTURE_TYPE_MEMORY_BARRIER, NULL, VK_ACCESS_ALL_WRITE_BITS, VK_ACCESS_ALL_READ_BITS,
+  };
+
+  VkCommandBuffer cmd = GetNextCmd();
+
+  VkResult vkr = VK_SUCCESS;
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+  CheckVkResult(vkr);
+
+  DoPipelineBarrier(cmd, 1, &memBarrier);
+
+  vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
+  CheckVkResult(vkr);
+}
+
+void WrappedVulkan::PreSnapshotInitialContents()
+{
+  if(!IsBackgroundCapturing(m_State))
+    return;
+
+  uint32_t framesLeft = RenderDoc::Inst().GetFramesUntilQueuedCapture(m_FrameCounter);
+
+  // if no capture is coming up soon, release anything from a capture that didn't happen
+  if(framesLeft == ~0U || framesLeft > Capture_PreSnapshotFrames())
+  {
+    if(GetResourceManager()->HasPreSnapshots())
+    {
+      GetResourceManager()->DiscardPreSnapshots();
+      FreeAllMemory(MemoryScope::InitialContents);
+    }
+    return;
+  }
+
+  // the capture starts this frame, it will prepare anything remaining itself
+  if(framesLeft == 0)
+    return;
+
+  SCOPED_WRITELOCK(m_CapTransitionLock);
+
+  WaitForGPUWrites();
+
+  GetResourceManager()->PreSnapshotInitialContents(framesLeft);
+  SubmitAndFlushImageStateBarriers(m_setupImageBarriers);
+  SubmitCmds();
+  FlushQ();
+  SubmitAndFlushImageStateBarriers(m_cleanupImageBarriers);
+}
+
 void WrappedVulkan::AdvanceFrame()
 {
   if(IsBackgroundCapturing(m_State))
@@ -2517,6 +2622,9 @@ void WrappedVulkan::Present(DeviceOwnedWindow devWnd)
   if(IsActiveCapturing(m_State) && !m_AppControlledCapture)
     RenderDoc::Inst().EndFrameCapture(devWnd);
 
+  if(Capture_PreSnapshotFrames() > 0 || GetResourceManager()->HasPreSnapshots())
+    PreSnapshotInitialContents();
+
   if(RenderDoc::Inst().ShouldTriggerCapture(m_FrameCounter) && IsBackgroundCapturing(m_State))
   {
     RenderDoc::Inst().StartFrameCapture(devWnd);
@@ -2563,6 +2671,74 @@ void WrappedVulkan::HandleFrameMarkers(const char *marker, VkQueue queue)
   }
 }
 
+static bool IsCaptureRangeLabel(const char *label)
+{
+  const rdcstr &name = Vulkan_CaptureRangeLabel();
+  return label && !name.empty() && name == label;
+}
+
+void WrappedVulkan::HandleCaptureRangeLabel(const char *label, VkCommandBuffer commandBuffer)
+{
+  if(!IsCaptureRangeLabel(label))
+    return;
+
+  // we can't split a submission, so capture the whole submission containing this command buffer
+  VkResourceRecord *record = GetRecord(commandBuffer);
+  record->bakedCommands->cmdInfo->beginCapture = true;
+  record->bakedCommands->cmdInfo->endCapture = true;
+}
+
+void WrappedVulkan::BeginQueueCaptureRange(const char *label, VkQueue queue)
+{
+  if(Vulkan_CaptureRangeLabel().empty())
+    return;
+
+  bool start = false;
+
+  {
+    SCOPED_LOCK(m_CaptureRangeLock);
+
+    if(m_CaptureRangeQueue == VK_NULL_HANDLE)
+    {
+      // don't take over a capture that was started some other way
+      if(IsCaptureRangeLabel(label) && IsBackgroundCapturing(m_State))
+      {
+        m_CaptureRangeQueue = queue;
+        m_CaptureRangeDepth = 1;
+        start = true;
+      }
+    }
+    else if(m_CaptureRangeQueue == queue)
+    {
+      m_CaptureRangeDepth++;
+    }
+  }
+
+  if(start)
+    RenderDoc::Inst().StartFrameCapture(DeviceOwnedWindow(LayerDisp(m_Instance), NULL));
+}
+
+void WrappedVulkan::EndQueueCaptureRange(VkQueue queue)
+{
+  if(Vulkan_CaptureRangeLabel().empty())
+    return;
+
+  bool end = false;
+
+  {
+    SCOPED_LOCK(m_CaptureRangeLock);
+
+    if(m_CaptureRangeQueue == queue && --m_CaptureRangeDepth == 0)
+    {
+      m_CaptureRangeQueue = VK_NULL_HANDLE;
+      end = true;
+    }
+  }
+
+  if(end)
+    RenderDoc::Inst().EndFrameCapture(DeviceOwnedWindow(LayerDisp(m_Instance), NULL));
+}
+
 ResourceDescription &WrappedVulkan::GetResourceDesc(ResourceId id)
 {
   return GetReplay()->GetResourceDesc(id);
@@ -2631,9 +2807,22 @@ RDResult WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStructured
     return result;
   }
 
+  if(IsLoading(m_State))
+  {
+    const SectionProperties &props = rdc->GetSectionProperties(sectionIdx);
+    m_CaptureHash =
+        strhash(StringFormat::Fmt("%s_%llu_%llu_%llu", rdc->GetDriverName().c_str(),
+                                  rdc->GetTimestampBase(), props.uncompressedSize,
+                                  props.compressedSize)
+                    .c_str());
+  }
+
+  rdc->ReadCallstackTable(m_CallstackTable);
+
   ReadSerialiser ser(reader, Ownership::Stream);
 
   ser.SetStringDatabase(&m_StringDB);
+  ser.SetCallstackTable(&m_CallstackTable);
   ser.SetUserData(GetResourceManager());
 
   ser.ConfigureStructuredExport(&GetChunkName, storeStructuredBuffers, m_TimeBase, m_TimeFrequency);
@@ -2656,6 +2845,10 @@ RDResult WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStructured
 
   std::map<VulkanChunk, chunkinfo> chunkInfos;
 
+  m_ChunkIndex.clear();
+  m_BuildChunkIndex = Capture_StoreChunkIndex() && IsLoading(m_State) &&
+                      rdc->SectionIndex(SectionType::ChunkIndex) < 0;
+
   SCOPED_TIMER("chunk initialisation");
 
   uint64_t frameDataSize = 0;
@@ -2664,6 +2857,12 @@ RDResult WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStructured
   if(m_ReplayOptions.apiValidation)
     sink = new ScopedDebugMessageSink(this);
 
+  if(IsLoading(m_State))
+  {
+    m_PipelineCompilePool = new Threading::WorkerPool(Threading::WorkerPool::DefaultThreadCount());
+    m_CreationInfo.m_ReflectionPool = m_PipelineCompilePool;
+  }
+
   for(;;)
   {
     PerformanceTimer timer;
@@ -2677,6 +2876,7 @@ RDResult WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStructured
     if(reader->IsErrored())
     {
       SAFE_DELETE(sink);
+      FinishPipelineCompiles();
       return RDResult(ResultCode::APIDataCorrupted, ser.GetError().message);
     }
 
@@ -2691,6 +2891,7 @@ RDResult WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStructured
     if(reader->IsErrored())
     {
       SAFE_DELETE(sink);
+      FinishPipelineCompiles();
       return RDResult(ResultCode::APIDataCorrupted, ser.GetError().message);
     }
 
@@ -2717,15 +2918,22 @@ RDResult WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStructured
       }
 
       SAFE_DELETE(sink);
+      FinishPipelineCompiles();
       m_FailedReplayResult.message = rdcstr(m_FailedReplayResult.message) + extra;
       return m_FailedReplayResult;
     }
 
     if(m_FatalError != ResultCode::Succeeded)
+    {
+      FinishPipelineCompiles();
       return m_FatalError;
+    }
 
     uint64_t offsetEnd = reader->GetOffset();
 
+    if(m_BuildChunkIndex)
+      m_ChunkIndex.push_back({(uint32_t)context, 0, offsetStart, offsetEnd - offsetStart});
+
     // only set progress after we've initialised the debug manager, to prevent progress jumping
     // backwards.
     if(m_DebugManager || IsStructuredExporting(m_State))
@@ -2759,10 +2967,14 @@ RDResult WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStructured
       }
 
       m_FrameReader = new StreamReader(reader, frameDataSize);
+      m_FrameDataOffset = offsetEnd;
 
       for(auto it = m_CreationInfo.m_Memory.begin(); it != m_CreationInfo.m_Memory.end(); ++it)
         it->second.SimplifyBindings();
 
+      // all pipelines must be available before we start reading the frame
+      FinishPipelineCompiles();
+
       RDResult status = ContextReplayLog(m_State, 0, 0, false);
 
       if(status != ResultCode::Succeeded)
@@ -2782,6 +2994,14 @@ RDResult WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStructured
 
   SAFE_DELETE(sink);
 
+  FinishPipelineCompiles();
+
+  if(IsLoading(m_State))
+  {
+    UpdateReplayMemoryPriorities();
+    CalculateFirstWrites();
+  }
+
 #if ENABLED(RDOC_DEVEL)
   for(auto it = chunkInfos.begin(); it != chunkInfos.end(); ++it)
   {
@@ -2836,6 +3056,45 @@ RDResult WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStructured
   return ResultCode::Succeeded;
 }
 
+void WrappedVulkan::FinishPipelineCompiles()
+{
+  // deleting the pool waits for any outstanding compiles and shader reflection
+  SAFE_DELETE(m_PipelineCompilePool);
+  m_CreationInfo.m_ReflectionPool = NULL;
+
+  for(PendingPipelineCompile *pending : m_PendingPipelineCompiles)
+  {
+    if(pending->ret != VK_SUCCESS)
+    {
+      RDCERR("Failed creating load render pass pipeline for %s, VkResult: %s",
+             ToStr(pending->live).c_str(), ToStr(pending->ret).c_str());
+    }
+    else
+    {
+      VkPipeline &subpass0pipe = m_CreationInfo.m_Pipeline[pending->live].subpass0pipe;
+      subpass0pipe = pending->pipe;
+
+      ResourceId subpass0id = GetResourceManager()->WrapResource(Unwrap(m_Device), subpass0pipe);
+
+      // register as a live-only resource, so it is cleaned up properly
+      GetResourceManager()->AddLiveResource(subpass0id, subpass0pipe);
+    }
+
+    delete pending;
+  }
+
+  m_PendingPipelineCompiles.clear();
+}
+
+void WrappedVulkan::StoreChunkIndex(RDCFile *rdc)
+{
+  if(m_BuildChunkIndex && !m_ChunkIndex.empty())
+    rdc->WriteChunkIndex(m_ChunkIndex);
+
+  m_BuildChunkIndex = false;
+  m_ChunkIndex.clear();
+}
+
 RDResult WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t startEventID,
                                          uint32_t endEventID, bool partial)
 {
@@ -2844,6 +3103,7 @@ RDResult WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t startEv
   ReadSerialiser ser(m_FrameReader, Ownership::Nothing);
 
   ser.SetStringDatabase(&m_StringDB);
+  ser.SetCallstackTable(&m_CallstackTable);
   ser.SetUserData(GetResourceManager());
   ser.SetVersion(m_SectionVersion);
 
@@ -2994,6 +3254,11 @@ RDResult WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t startEv
     if(m_FatalError != ResultCode::Succeeded)
       return m_FatalError;
 
+    if(m_BuildChunkIndex && IsLoading(m_State))
+      m_ChunkIndex.push_back({(uint32_t)chunktype, m_RootEventID,
+                              m_FrameDataOffset + m_CurChunkOffset,
+                              ser.GetReader()->GetOffset() - m_CurChunkOffset});
+
     RenderDoc::Inst().SetProgress(
         LoadProgress::FrameEventsRead,
         float(m_CurChunkOffset - startOffset) / float(ser.GetReader()->GetSize()));
@@ -3824,8 +4089,215 @@ VkResourceRecord *WrappedVulkan::RegisterSurface(WindowingSystem system, void *h
   return (VkResourceRecord *)new PackedWindowHandle(system, handle);
 }
 
+static bool IsReadOnlyUsage(ResourceUsage usage)
+{
+  switch(usage)
+  {
+    case ResourceUsage::Unused:
+    case ResourceUsage::VertexBuffer:
+    case ResourceUsage::IndexBuffer:
+    case ResourceUsage::VS_Constants:
+    case ResourceUsage::HS_Constants:
+    case ResourceUsage::DS_Constants:
+    case ResourceUsage::GS_Constants:
+    case ResourceUsage::PS_Constants:
+    case ResourceUsage::CS_Constants:
+    case ResourceUsage::All_Constants:
+    case ResourceUsage::VS_Resource:
+    case ResourceUsage::HS_Resource:
+    case ResourceUsage::DS_Resource:
+    case ResourceUsage::GS_Resource:
+    case ResourceUsage::PS_Resource:
+    case ResourceUsage::CS_Resource:
+    case ResourceUsage::All_Resource:
+    case ResourceUsage::InputTarget:
+    case ResourceUsage::Indirect:
+    case ResourceUsage::ResolveSrc:
+    case ResourceUsage::CopySrc: return true;
+    default: break;
+  }
+
+  return false;
+}
+
+void WrappedVulkan::CalculateFirstWrites()
+{
+  m_FirstWriteEvent.clear();
+
+  if(Vulkan_Debug_AlwaysResetWrittenResources())
+    return;
+
+  // some commands write to buffers without the write being tracked as usage
+  const VulkanChunk untrackedChunks[] = {
+      VulkanChunk::vkQueueBindSparse,         VulkanChunk::vkCmdCopyQueryPoolResults,
+      VulkanChunk::vkCmdWriteBufferMarkerAMD, VulkanChunk::vkCmdWriteBufferMarker2AMD,
+      VulkanChunk::vkCmdEndTransformFeedbackEXT,
+  };
+
+  bool inFrame = false;
+  for(const SDChunk *chunk : m_StructuredFile->chunks)
+  {
+    if(chunk->metadata.chunkID == (uint32_t)SystemChunk::CaptureScope)
+      inFrame = true;
+
+    for(size_t i = 0; inFrame && i < ARRAY_COUNT(untrackedChunks); i++)
+      if(chunk->metadata.chunkID == (uint32_t)untrackedChunks[i])
+        m_UntrackedWrites = true;
+  }
+
+  if(m_UntrackedWrites)
+  {
+    RDCLOG("Frame contains untracked writes, all written resources will be reset on every replay");
+    return;
+  }
+
+  VulkanResourceManager *rm = GetResourceManager();
+
+  for(auto it = m_ResourceUses.begin(); it != m_ResourceUses.end(); ++it)
+  {
+    uint32_t firstWrite = ~0U;
+    for(const EventUsage &use : it->second)
+      if(!IsReadOnlyUsage(use.usage))
+        firstWrite = RDCMIN(firstWrite, use.eventId);
+
+    if(firstWrite == ~0U)
+      continue;
+
+    rdcarray<ResourceId> written = {it->first};
+
+    // a write to a buffer or image modifies the memory it's bound to
+    const ResourceDescription &desc = GetResourceDesc(rm->GetOriginalID(it->first));
+    for(ResourceId parent : desc.parentResources)
+      if(rm->HasLiveResource(parent))
+        written.push_back(rm->GetLiveID(parent));
+
+    for(ResourceId id : written)
+    {
+      auto first = m_FirstWriteEvent.find(id);
+      if(first == m_FirstWriteEvent.end())
+        m_FirstWriteEvent[id] = firstWrite;
+      else
+        first->second = RDCMIN(first->second, firstWrite);
+    }
+  }
+
+  // memory holding buffers with device addresses can be written at any point without tracking
+  for(auto it = m_CreationInfo.m_Buffer.begin(); it != m_CreationInfo.m_Buffer.end(); ++it)
+  {
+    if(it->second.gpuAddress == 0)
+      continue;
+
+    const ResourceDescription &desc = GetResourceDesc(rm->GetOriginalID(it->first));
+    for(ResourceId parent : desc.parentResources)
+      if(rm->HasLiveResource(parent))
+        m_FirstWriteEvent[rm->GetLiveID(parent)] = 0;
+  }
+}
+
+bool WrappedVulkan::WrittenSinceReset(ResourceId id)
+{
+  // the first replay after loading has had the whole frame replayed
+  if(m_UntrackedWrites || m_ReplayedSinceReset == ~0U || Vulkan_Debug_AlwaysResetWrittenResources())
+    return true;
+
+  auto it = m_FirstWriteEvent.find(id);
+
+  // without a tracked write we can't tell, so let the frame references decide
+  if(it == m_FirstWriteEvent.end())
+    return true;
+
+  return it->second <= m_ReplayedSinceReset;
+}
+
+bool WrappedVulkan::CanReplayForward(uint32_t endEventID)
+{
+  if(Vulkan_Debug_DisableForwardReplay())
+    return false;
+
+  // we need to have fully replayed up to and including an earlier event, with nothing else done
+  if(m_ForwardReplay.eventId == 0 || m_ForwardReplay.pendingDraw ||
+     endEventID <= m_ForwardReplay.eventId)
+    return false;
+
+  // we only continue within a primary command buffer, not inside secondary executions
+  if(m_Partial[Primary].partialParent == ResourceId() ||
+     m_Partial[Secondary].partialParent != ResourceId())
+    return false;
+
+  // the new event must be in the same submission of the command buffer that's partially replayed.
+  // This is the same check vkBeginCommandBuffer uses to detect the partial command buffer.
+  const PartialReplayData &primary = m_Partial[Primary];
+  if(endEventID > primary.baseEvent + m_BakedCmdBufferInfo[primary.partialParent].eventCount)
+    return false;
+
+  // anything that changes render pass state, steps into other command buffers, or changes image
+  // layouts can't be continued safely in a standalone command buffer, so fall back to a full replay
+  for(uint32_t eid = m_ForwardReplay.eventId + 1; eid <= endEventID; eid++)
+  {
+    const ActionDescription *action = GetAction(eid);
+
+    if(action && (action->flags & (ActionFlags::PassBoundary | ActionFlags::BeginPass |
+                                   ActionFlags::EndPass | ActionFlags::CmdList |
+                                   ActionFlags::CommandBufferBoundary | ActionFlags::MultiAction |
+                                   ActionFlags::Indirect | ActionFlags::Present)))
+      return false;
+
+    const APIEvent &ev = GetEvent(eid);
+
+    if(ev.eventId != eid)
+      return false;
+
+    switch((VulkanChunk)m_StructuredFile->chunks[ev.chunkIndex]->metadata.chunkID)
+    {
+      case VulkanChunk::vkCmdPipelineBarrier:
+      case VulkanChunk::vkCmdPipelineBarrier2:
+      case VulkanChunk::vkCmdWaitEvents:
+      case VulkanChunk::vkCmdWaitEvents2:
+      case VulkanChunk::vkCmdExecuteCommands:
+      case VulkanChunk::vkCmdIndirectSubCommand: return false;
+      default: break;
+    }
+  }
+
+  return true;
+}
+
 void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType)
 {
+  // the usual pattern when selecting an event is a replay up to the event without its action,
+  // then the action alone. If nothing else was submitted in between, the GPU state afterwards is
+  // exactly the frame up to and including that event, and a later selection in the same command
+  // buffer can continue from there. Any other replay leaves things in an unknown state.
+  bool forward = false;
+
+  if(startEventID == 0 && replayType == eReplay_WithoutDraw)
+  {
+    forward = CanReplayForward(endEventID);
+
+    if(forward)
+      startEventID = m_ForwardReplay.eventId + 1;
+
+    m_ForwardReplay.eventId = endEventID;
+    m_ForwardReplay.pendingDraw = true;
+  }
+  else if(startEventID == 0 && replayType == eReplay_OnlyDraw && m_ForwardReplay.pendingDraw &&
+          m_ForwardReplay.eventId == endEventID &&
+          m_ForwardReplay.submitCount == m_InternalSubmitCount)
+  {
+    m_ForwardReplay.pendingDraw = false;
+  }
+  else
+  {
+    m_ForwardReplay.Reset();
+  }
+
+  // if the new event immediately follows the last one there's nothing to replay before its action
+  if(forward && startEventID == endEventID)
+  {
+    m_ForwardReplay.submitCount = m_InternalSubmitCount;
+    return;
+  }
+
   bool partial = true;
 
   if(startEventID == 0 && (replayType == eReplay_WithoutDraw || replayType == eReplay_Full))
@@ -3839,8 +4311,14 @@ void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, Replay
     VkMarkerRegion::Begin("!!!!RenderDoc Internal: ApplyInitialContents");
     ApplyInitialContents();
     VkMarkerRegion::End();
+
+    m_ReplayedSinceReset = 0;
   }
 
+  // this is conservative for partial replays that start later, but only the furthest write matters
+  if(m_ReplayedSinceReset != ~0U)
+    m_ReplayedSinceReset = RDCMAX(m_ReplayedSinceReset, endEventID);
+
   m_State = CaptureState::ActiveReplaying;
 
   VkMarkerRegion::Set(StringFormat::Fmt("!!!!RenderDoc Internal: RenderDoc Replay %d (%d): %u->%u",
@@ -4017,6 +4495,8 @@ void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, Replay
     });
   }
 
+  m_ForwardReplay.submitCount = m_InternalSubmitCount;
+
   VkMarkerRegion::Set("!!!!RenderDoc Internal: Done replay");
 }
 
@@ -4293,6 +4773,13 @@ VkBool32 WrappedVulkan::DebugCallback(MessageSeverity severity, MessageCategory
   {
     ScopedDebugMessageSink *sink = GetDebugMessageSink();
 
+    // buggy applications can produce the same message many thousands of times a frame, so only the
+    // first few of each are stored when capturing.
+    bool lastStored = false;
+    if(sink && IsCaptureMode(m_State) &&
+       !ShouldStoreDebugMessage(messageCode, pMessage, lastStored))
+      sink = NULL;
+
     if(sink)
     {
       DebugMessage msg;
@@ -4300,6 +4787,8 @@ VkBool32 WrappedVulkan::DebugCallback(MessageSeverity severity, MessageCategory
       msg.eventId = 0;
       msg.category = category;
       msg.description = pMessage;
+      if(lastStored)
+        msg.description += "\n\nFurther repeats of this message in the capture have been dropped.";
       msg.severity = severity;
       msg.messageID = messageCode;
       msg.source = MessageSource::API;
@@ -4825,6 +5314,10 @@ void WrappedVulkan::AddUsage(VulkanActionTreeNode &actionNode, rdcarray<DebugMes
           if(!hugeRangeWarned)
             RDCWARN("Skipping large, most likely 'bindless', descriptor range");
           hugeRangeWarned = true;
+
+          // writes through this range won't be tracked
+          if(t == 1)
+            m_UntrackedWrites = true;
           continue;
         }
 
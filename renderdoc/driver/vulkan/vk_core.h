@@ -24,7 +24,11 @@
 
 #pragma once
 
+#include "common/shader_cache.h"
+#include "common/temp_memory.h"
 #include "common/timing.h"
+#include "core/api_overhead.h"
+#include "serialise/rdcfile.h"
 #include "serialise/serialiser.h"
 #include "vk_common.h"
 #include "vk_info.h"
@@ -53,7 +57,7 @@ struct VkInitParams
   uint64_t GetSerialiseSize();
 
   // check if a frame capture section version is supported
-  static const uint64_t CurrentVersion = 0x15;
+  static const uint64_t CurrentVersion = 0x17;
   static bool IsSupportedVersion(uint64_t ver);
 };
 
@@ -191,6 +195,8 @@ struct VulkanActionTreeNode
     ser.ChunkMetadata().timestampMicro = Timing::GetTick();                                     \
     __VA_ARGS__;                                                                                \
     ser.ChunkMetadata().durationMicro = Timing::GetTick() - ser.ChunkMetadata().timestampMicro; \
+    if(APIOverhead::IsEnabled())                                                                \
+      APIOverhead::AddDriverTicks(ser.ChunkMetadata().durationMicro);                           \
   }
 
 // must be at the start of any function that serialises
@@ -318,6 +324,12 @@ private:
   bool m_AppControlledCapture = false;
   bool m_FirstFrameCapture = false;
 
+  // the queue with an open label that started the current capture, and how deeply nested its labels
+  // are
+  Threading::CriticalSection m_CaptureRangeLock;
+  VkQueue m_CaptureRangeQueue = VK_NULL_HANDLE;
+  uint32_t m_CaptureRangeDepth = 0;
+
   int32_t m_ReuseEnabled = 1;
 
   PerformanceTimer m_CaptureTimer;
@@ -330,21 +342,31 @@ private:
   Threading::CriticalSection m_ThreadSerialisersLock;
   rdcarray<WriteSerialiser *> m_ThreadSerialisers;
 
+  // per-thread counts of the API validation messages seen in the current capture, so repeats of a
+  // message can be counted and dropped on the callback thread without taking any locks
+  struct DebugMessageRepeats
+  {
+    int32_t captureIndex = -1;
+    std::unordered_map<uint64_t, uint32_t> counts;
+    uint64_t suppressed = 0;
+  };
+
+  uint64_t debugMessageRepeatsTLSSlot;
+  int32_t m_DebugMessageCaptureIndex = 0;
+
+  Threading::CriticalSection m_DebugMessageRepeatsLock;
+  rdcarray<DebugMessageRepeats *> m_DebugMessageRepeats;
+
+  DebugMessageRepeats &GetDebugMessageRepeats();
+  bool ShouldStoreDebugMessage(int messageCode, const char *pMessage, bool &lastStored);
+  uint64_t GetSuppressedDebugMessageCount();
+
   Threading::CriticalSection m_CallbacksLock;
   rdcarray<UserDebugReportCallbackData *> m_ReportCallbacks;
   rdcarray<UserDebugUtilsCallbackData *> m_UtilsCallbacks;
   void SendUserDebugMessage(const rdcstr &msg);
 
-  uint64_t tempMemoryTLSSlot;
-  struct TempMem
-  {
-    TempMem() : memory(NULL), cur(NULL), size(0) {}
-    byte *memory;
-    byte *cur;
-    size_t size;
-  };
-  Threading::CriticalSection m_ThreadTempMemLock;
-  rdcarray<TempMem *> m_ThreadTempMem;
+  ThreadTempMemory m_TempMemory;
 
   VulkanReplay *m_Replay;
   ReplayOptions m_ReplayOptions;
@@ -354,7 +376,41 @@ private:
 
   StreamReader *m_FrameReader = NULL;
 
+  // chunk index built while loading, if the capture doesn't have one and we're storing it.
+  // m_FrameDataOffset is the offset of m_FrameReader's data in the frame capture section
+  bool m_BuildChunkIndex = false;
+  rdcarray<ChunkIndexEntry> m_ChunkIndex;
+  uint64_t m_FrameDataOffset = 0;
+
+  // identifies the capture being replayed, for caching data on disk between runs
+  uint32_t m_CaptureHash = 0;
+
+  // while processing the initialisation chunks, pipelines that are only needed once we start
+  // replaying (the load render pass variants for partial replays) are compiled on these workers.
+  // They're registered with the resource manager in FinishPipelineCompiles before the frame is read.
+  struct PendingPipelineCompile
+  {
+    ResourceId live;
+    VkGraphicsPipelineCreateInfo createInfo = {};
+    VkPipeline pipe = VK_NULL_HANDLE;
+    VkResult ret = VK_SUCCESS;
+  };
+  Threading::WorkerPool *m_PipelineCompilePool = NULL;
+  rdcarray<PendingPipelineCompile *> m_PendingPipelineCompiles;
+
+  // the live graphics pipeline created on replay for each distinct create info, keyed by a hash of
+  // the serialised create info. Applications often create the same pipeline (or pipeline library)
+  // many times over, and later duplicates are aliased to the first instead of being compiled again
+  std::map<ShaderCacheHash128, ResourceId> m_ReplayPipelinesByCreateInfo;
+
+  void FinishPipelineCompiles();
+
+  // capture pipelines that use an edited shader but haven't had their replacement created yet,
+  // which happens the first time they're bound. See VulkanReplay::RefreshDerivedReplacements
+  std::set<ResourceId> m_PendingPipelineReplacements;
+
   std::set<rdcstr> m_StringDB;
+  CallstackTable m_CallstackTable;
 
   Threading::CriticalSection m_CapDescriptorsLock;
   std::set<rdcpair<ResourceId, VkResourceRecord *>> m_CapDescriptors;
@@ -579,10 +635,24 @@ private:
 
   // Internal lumped/pooled memory allocations
 
-  // Each memory scope gets a separate vector of allocation objects. The vector contains the list of
-  // all 'base' allocations. The offset is used to indicate the current offset, and the size is the
-  // total size, thus the free space can be determined with size - offset.
-  rdcarray<MemoryAllocation> m_MemoryBlocks[arraydim<MemoryScope>()];
+  // Each memory scope gets a separate vector of blocks. Each block holds one 'base' allocation
+  // whose offset is the end of the space used so far, and whose size is the total size, so the
+  // untouched space at the end is size - offset. Allocations freed before that point leave free
+  // ranges which are re-used by later allocations, and are merged with their neighbours as they're
+  // freed.
+  struct MemoryBlock
+  {
+    MemoryAllocation base;
+    // (offset, size) of each freed range below base.offs, sorted by offset and never adjacent
+    rdcarray<rdcpair<VkDeviceSize, VkDeviceSize>> freeRanges;
+    uint32_t liveAllocations = 0;
+  };
+  rdcarray<MemoryBlock> m_MemoryBlocks[arraydim<MemoryScope>()];
+
+  // Per memory scope, the bytes currently sub-allocated and the most there has been at once since
+  // the scope was last freed.
+  VkDeviceSize m_MemoryScopeUsed[arraydim<MemoryScope>()] = {};
+  VkDeviceSize m_MemoryScopePeak[arraydim<MemoryScope>()] = {};
 
   // Per memory scope, the size of the next allocation. This allows us to balance number of memory
   // allocation objects with size by incrementally allocating larger blocks.
@@ -590,6 +660,21 @@ private:
 
   void FreeAllMemory(MemoryScope scope);
   void FreeMemoryAllocation(MemoryAllocation alloc);
+  VkDeviceSize PaddedAllocationSize(VkDeviceSize size);
+  void AddFreeRange(MemoryBlock &block, VkDeviceSize offs, VkDeviceSize size);
+
+  // device-local memory in use on replay by the capture's allocations and our own blocks, and the
+  // budget it's checked against. Internal buffers that would take us over budget are placed in
+  // host-visible memory instead.
+  VkDeviceSize m_ReplayDeviceLocalBytes = 0;
+  VkDeviceSize m_ReplayDeviceLocalBudget = 0;
+  // if VK_EXT_pageable_device_local_memory is enabled on replay, so we can set memory priorities
+  bool m_PageableDeviceMemory = false;
+
+  void ChooseReplayMemoryBudget();
+  bool IsDeviceLocalMemoryType(uint32_t memoryTypeIndex);
+  void UpdateReplayMemoryPriorities();
+  bool UseHostInitialContents();
 
   // internal implementation - call one of the functions above
   MemoryAllocation AllocateMemoryForResource(bool buffer, VkMemoryRequirements mrq,
@@ -754,6 +839,42 @@ private:
   // so we just set this command buffer
   VkCommandBuffer m_OutsideCmdBuffer = VK_NULL_HANDLE;
 
+  // tracks the event that the GPU state currently corresponds to after a WithoutDraw + OnlyDraw
+  // replay pair, so that selecting a later event in the same command buffer can replay only the
+  // events in between as a partial replay instead of starting again from the initial contents.
+  struct ForwardReplayData
+  {
+    void Reset()
+    {
+      eventId = 0;
+      pendingDraw = false;
+    }
+
+    // the last event replayed, or 0 if the state is unknown
+    uint32_t eventId = 0;
+    // true between the WithoutDraw and OnlyDraw halves, when eventId itself isn't replayed yet
+    bool pendingDraw = false;
+    // the number of internal submissions at the end of the last replay. If anything else was
+    // submitted before the OnlyDraw half we can't be sure the state hasn't been modified.
+    uint64_t submitCount = 0;
+  } m_ForwardReplay;
+
+  // incremented for every submission of internal command buffers
+  uint64_t m_InternalSubmitCount = 0;
+
+  bool CanReplayForward(uint32_t endEventID);
+
+  // the first event that writes each image or memory object with initial contents, and the last
+  // event replayed since initial contents were applied. Resources whose first write hasn't been
+  // replayed since the last reset still hold their initial contents and don't need resetting.
+  std::unordered_map<ResourceId, uint32_t> m_FirstWriteEvent;
+  uint32_t m_ReplayedSinceReset = ~0U;
+  // set if the frame can write resources in ways that aren't tracked as usage
+  bool m_UntrackedWrites = false;
+
+  void CalculateFirstWrites();
+  bool WrittenSinceReset(ResourceId id);
+
   // stores the currently re-recording command buffer for any original command buffer ID (not bake
   // ID). This allows a quick check to see if an original command should be recorded, and also to
   // fetch the command buffer to record into.
@@ -865,6 +986,16 @@ private:
   std::map<RENDERDOC_WindowHandle, VkSwapchainKHR> m_SwapLookup;
   Threading::CriticalSection m_SwapLookupLock;
 
+  // capture side only, the md5 of each memory or image initial contents serialised so far in the
+  // current capture, to store identical contents as a reference to the first one.
+  std::map<rdcpair<uint64_t, uint64_t>, ResourceId> m_InitialContentsHashes;
+  // initial contents can be serialised on several threads at once, and share memory objects. Each
+  // memory object is mapped once while any of them are being written, with a refcount.
+  std::map<VkDeviceMemory, rdcpair<byte *, uint32_t>> m_InitialContentsWriteMaps;
+  Threading::CriticalSection m_InitialContentsWriteLock;
+  byte *MapInitialContentsForWrite(const MemoryAllocation &mem);
+  void UnmapInitialContentsForWrite(const MemoryAllocation &mem);
+
   // below are replay-side data only, doesn't have to be thread protected
 
   // current descriptor set contents
@@ -884,10 +1015,14 @@ private:
   // doesn't work as well. We're not quite as performance-sensitive so we allocate 4MB per thread
   // and use it in a ring-buffer fashion. This allows multiple allocations to live at once as long
   // as we don't need it all in one stack.
-  byte *GetRingTempMemory(size_t s);
-
+  byte *GetRingTempMemory(size_t s) { return m_TempMemory.GetRingTempMemory(s); }
   // returns thread-local temporary memory
-  byte *GetTempMemory(size_t s);
+  byte *GetTempMemory(size_t s)
+  {
+    if(IsReplayMode(m_State))
+      return GetRingTempMemory(s);
+    return m_TempMemory.GetTempMemory(s);
+  }
   template <class T>
   T *GetTempArray(uint32_t arraycount)
   {
@@ -949,10 +1084,17 @@ private:
 
   void AdvanceFrame();
   void Present(DeviceOwnedWindow devWnd);
+  void PreSnapshotInitialContents();
+  void WaitForGPUWrites();
 
   void HandleFrameMarkers(const char *marker, VkCommandBuffer commandBuffer);
   void HandleFrameMarkers(const char *marker, VkQueue queue);
 
+  // capturing just the region inside a named debug label, see Vulkan_CaptureRangeLabel
+  void HandleCaptureRangeLabel(const char *label, VkCommandBuffer commandBuffer);
+  void BeginQueueCaptureRange(const char *label, VkQueue queue);
+  void EndQueueCaptureRange(VkQueue queue);
+
   template <typename SerialiserType>
   bool Serialise_SetShaderDebugPath(SerialiserType &ser, VkShaderModule ShaderObject,
                                     rdcstr DebugPath);
@@ -1106,6 +1248,8 @@ public:
   void ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType);
   void ReplayDraw(VkCommandBuffer cmd, const ActionDescription &action);
   RDResult ReadLogInitialisation(RDCFile *rdc, bool storeStructuredBuffers);
+  uint32_t GetCaptureHash() { return m_CaptureHash; }
+  void StoreChunkIndex(RDCFile *rdc);
 
   SDFile *GetStructuredFile() { return m_StructuredFile; }
   SDFile *DetachStructuredFile()
@@ -1129,6 +1273,7 @@ public:
 
   uint32_t GetReadbackMemoryIndex(uint32_t resourceCompatibleBitmask);
   uint32_t GetUploadMemoryIndex(uint32_t resourceCompatibleBitmask);
+  uint32_t GetHostMemoryIndex(uint32_t resourceCompatibleBitmask);
   uint32_t GetGPULocalMemoryIndex(uint32_t resourceCompatibleBitmask);
 
   MemoryAllocation AllocateMemoryForResource(VkImage im, MemoryScope scope, MemoryType type);
@@ -125,6 +125,7 @@ rdcarray<GPUCounter> VulkanReplay::EnumerateCounters()
   VkPhysicalDeviceFeatures availableFeatures = m_pDriver->GetDeviceEnabledFeatures();
 
   ret.push_back(GPUCounter::EventGPUDuration);
+  ret.push_back(GPUCounter::EventGPUDurationStdDev);
   if(availableFeatures.pipelineStatisticsQuery)
   {
     ret.push_back(GPUCounter::InputVerticesRead);
@@ -255,6 +256,15 @@ CounterDescription VulkanReplay::DescribeCounter(GPUCounter counterID)
       desc.resultType = CompType::Float;
       desc.unit = CounterUnit::Seconds;
       break;
+    case GPUCounter::EventGPUDurationStdDev:
+      desc.name = "GPU Duration Std. Dev.";
+      desc.description =
+          "Standard deviation of the GPU duration of this event when it is timed over several "
+          "replays. 0 when only one replay is made.";
+      desc.resultByteWidth = 8;
+      desc.resultType = CompType::Float;
+      desc.unit = CounterUnit::Seconds;
+      break;
     case GPUCounter::InputVerticesRead:
       desc.name = "Input Vertices Read";
       desc.description = "Number of vertices read by input assembler.";
@@ -351,6 +361,93 @@ CounterDescription VulkanReplay::DescribeCounter(GPUCounter counterID)
   return desc;
 }
 
+// runs a second callback inside the queries of a counter pass, so that e.g. the generic
+// timestamp and pipeline statistics queries can share a replay with vendor or KHR counters
+// instead of needing one of their own. The inner callback's queries are nested inside the outer's.
+struct VulkanSharedActionCallback : public VulkanActionCallback
+{
+  VulkanSharedActionCallback(WrappedVulkan *vk, VulkanActionCallback *outer,
+                             VulkanActionCallback *inner)
+      : m_pDriver(vk), m_Outer(outer), m_Inner(inner)
+  {
+    m_pDriver->SetActionCB(this);
+  }
+  ~VulkanSharedActionCallback() { m_pDriver->SetActionCB(m_Outer); }
+  void PreDraw(uint32_t eid, VkCommandBuffer cmd) override
+  {
+    m_Outer->PreDraw(eid, cmd);
+    m_Inner->PreDraw(eid, cmd);
+  }
+  bool PostDraw(uint32_t eid, VkCommandBuffer cmd) override
+  {
+    bool ret = m_Inner->PostDraw(eid, cmd);
+    return m_Outer->PostDraw(eid, cmd) || ret;
+  }
+  void PostRedraw(uint32_t eid, VkCommandBuffer cmd) override
+  {
+    m_Inner->PostRedraw(eid, cmd);
+    m_Outer->PostRedraw(eid, cmd);
+  }
+  void PreDispatch(uint32_t eid, VkCommandBuffer cmd) override
+  {
+    m_Outer->PreDispatch(eid, cmd);
+    m_Inner->PreDispatch(eid, cmd);
+  }
+  bool PostDispatch(uint32_t eid, VkCommandBuffer cmd) override
+  {
+    bool ret = m_Inner->PostDispatch(eid, cmd);
+    return m_Outer->PostDispatch(eid, cmd) || ret;
+  }
+  void PostRedispatch(uint32_t eid, VkCommandBuffer cmd) override
+  {
+    m_Inner->PostRedispatch(eid, cmd);
+    m_Outer->PostRedispatch(eid, cmd);
+  }
+  void PreMisc(uint32_t eid, ActionFlags flags, VkCommandBuffer cmd) override
+  {
+    m_Outer->PreMisc(eid, flags, cmd);
+    m_Inner->PreMisc(eid, flags, cmd);
+  }
+  bool PostMisc(uint32_t eid, ActionFlags flags, VkCommandBuffer cmd) override
+  {
+    bool ret = m_Inner->PostMisc(eid, flags, cmd);
+    return m_Outer->PostMisc(eid, flags, cmd) || ret;
+  }
+  void PostRemisc(uint32_t eid, ActionFlags flags, VkCommandBuffer cmd) override
+  {
+    m_Inner->PostRemisc(eid, flags, cmd);
+    m_Outer->PostRemisc(eid, flags, cmd);
+  }
+  void AliasEvent(uint32_t primary, uint32_t alias) override
+  {
+    m_Outer->AliasEvent(primary, alias);
+    m_Inner->AliasEvent(primary, alias);
+  }
+  bool SplitSecondary() override { return m_Outer->SplitSecondary(); }
+  bool ForceLoadRPs() override { return m_Outer->ForceLoadRPs(); }
+  void PreCmdExecute(uint32_t baseEid, uint32_t secondaryFirst, uint32_t secondaryLast,
+                     VkCommandBuffer cmd) override
+  {
+    m_Outer->PreCmdExecute(baseEid, secondaryFirst, secondaryLast, cmd);
+    m_Inner->PreCmdExecute(baseEid, secondaryFirst, secondaryLast, cmd);
+  }
+  void PostCmdExecute(uint32_t baseEid, uint32_t secondaryFirst, uint32_t secondaryLast,
+                      VkCommandBuffer cmd) override
+  {
+    m_Inner->PostCmdExecute(baseEid, secondaryFirst, secondaryLast, cmd);
+    m_Outer->PostCmdExecute(baseEid, secondaryFirst, secondaryLast, cmd);
+  }
+  void PreEndCommandBuffer(VkCommandBuffer cmd) override
+  {
+    m_Inner->PreEndCommandBuffer(cmd);
+    m_Outer->PreEndCommandBuffer(cmd);
+  }
+
+  WrappedVulkan *m_pDriver;
+  VulkanActionCallback *m_Outer;
+  VulkanActionCallback *m_Inner;
+};
+
 struct VulkanAMDActionCallback : public VulkanActionCallback
 {
   VulkanAMDActionCallback(WrappedVulkan *dev, VulkanReplay *rp, uint32_t &sampleIndex,
@@ -452,17 +549,27 @@ struct VulkanAMDActionCallback : public VulkanActionCallback
 };
 
 void VulkanReplay::FillTimersAMD(uint32_t *eventStartID, uint32_t *sampleIndex,
-                                 rdcarray<uint32_t> *eventIDs)
+                                 rdcarray<uint32_t> *eventIDs, VulkanActionCallback *sharedCB)
 {
   uint32_t maxEID = m_pDriver->GetMaxEID();
 
+  SAFE_DELETE(m_pAMDActionCallback);
   m_pAMDActionCallback = new VulkanAMDActionCallback(m_pDriver, this, *sampleIndex, *eventIDs);
 
   // replay the events to perform all the queries
-  m_pDriver->ReplayLog(*eventStartID, maxEID, eReplay_Full);
+  if(sharedCB)
+  {
+    VulkanSharedActionCallback shared(m_pDriver, m_pAMDActionCallback, sharedCB);
+    m_pDriver->ReplayLog(*eventStartID, maxEID, eReplay_Full);
+  }
+  else
+  {
+    m_pDriver->ReplayLog(*eventStartID, maxEID, eReplay_Full);
+  }
 }
 
-rdcarray<CounterResult> VulkanReplay::FetchCountersAMD(const rdcarray<GPUCounter> &counters)
+rdcarray<CounterResult> VulkanReplay::FetchCountersAMD(const rdcarray<GPUCounter> &counters,
+                                                       VulkanActionCallback *&sharedCB)
 {
   GpaVkContextOpenInfo context = {Unwrap(m_pDriver->GetInstance()), Unwrap(m_pDriver->GetPhysDev()),
                                   Unwrap(m_pDriver->GetDev())};
@@ -502,11 +609,14 @@ rdcarray<CounterResult> VulkanReplay::FetchCountersAMD(const rdcarray<GPUCounter
 
     eventIDs.clear();
 
-    FillTimersAMD(&eventStartID, &sampleIndex, &eventIDs);
+    FillTimersAMD(&eventStartID, &sampleIndex, &eventIDs, i + 1 == passCount ? sharedCB : NULL);
 
     m_pAMDCounters->EndPass();
   }
 
+  if(passCount > 0)
+    sharedCB = NULL;
+
   m_pAMDCounters->EndSesssion(sessionID);
 
   rdcarray<CounterResult> ret =
@@ -608,7 +718,8 @@ struct VulkanKHRCallback : public VulkanActionCallback
   rdcarray<std::pair<uint32_t, uint32_t>> m_AliasEvents;
 };
 
-rdcarray<CounterResult> VulkanReplay::FetchCountersKHR(const rdcarray<GPUCounter> &counters)
+rdcarray<CounterResult> VulkanReplay::FetchCountersKHR(const rdcarray<GPUCounter> &counters,
+                                                       VulkanActionCallback *&sharedCB)
 {
   rdcarray<uint32_t> counterIndices;
   for(const GPUCounter &c : counters)
@@ -671,10 +782,21 @@ rdcarray<CounterResult> VulkanReplay::FetchCountersKHR(const rdcarray<GPUCounter
     cb.m_Results.clear();
 
     m_pDriver->SetSubmitChain(&perfSubmitInfo);
-    m_pDriver->ReplayLog(0, maxEID, eReplay_Full);
+    if(sharedCB && i + 1 == passCount)
+    {
+      VulkanSharedActionCallback shared(m_pDriver, &cb, sharedCB);
+      m_pDriver->ReplayLog(0, maxEID, eReplay_Full);
+    }
+    else
+    {
+      m_pDriver->ReplayLog(0, maxEID, eReplay_Full);
+    }
     m_pDriver->SetSubmitChain(NULL);
   }
 
+  if(passCount > 0)
+    sharedCB = NULL;
+
   rdcarray<VkPerformanceCounterResultKHR> perfResults;
   perfResults.resize(cb.m_Results.size() * counters.size());
 
@@ -748,9 +870,9 @@ struct VulkanGPUTimerCallback : public VulkanActionCallback
         m_PipeStatsQueryPool(psqp),
         m_ComputePipeStatsQueryPool(cpsqp)
   {
-    m_pDriver->SetActionCB(this);
   }
-  ~VulkanGPUTimerCallback() { m_pDriver->SetActionCB(NULL); }
+  // not registered on construction, as it may instead share a vendor or KHR counter pass
+  ~VulkanGPUTimerCallback() {}
   void PreDraw(uint32_t eid, VkCommandBuffer cmd) override
   {
     VkQueueFlags cmdType = m_pDriver->GetCommandType();
@@ -858,21 +980,20 @@ rdcarray<CounterResult> VulkanReplay::FetchCounters(const rdcarray<GPUCounter> &
   std::copy_if(counters.begin(), counters.end(), std::back_inserter(vkCounters),
                [](const GPUCounter &c) { return IsGenericCounter(c); });
 
-  rdcarray<CounterResult> ret;
-
+  rdcarray<GPUCounter> amdCounters;
   if(m_pAMDCounters)
   {
     // Filter out the AMD counters
-    rdcarray<GPUCounter> amdCounters;
     std::copy_if(counters.begin(), counters.end(), std::back_inserter(amdCounters),
                  [](const GPUCounter &c) { return IsAMDCounter(c); });
-
-    if(!amdCounters.empty())
-    {
-      ret = FetchCountersAMD(amdCounters);
-    }
   }
 
+  rdcarray<GPUCounter> vkKHRCounters;
+  std::copy_if(counters.begin(), counters.end(), std::back_inserter(vkKHRCounters),
+               [](const GPUCounter &c) { return IsVulkanExtendedCounter(c); });
+
+  rdcarray<CounterResult> ret;
+
 #if DISABLED(RDOC_ANDROID) && DISABLED(RDOC_APPLE)
   if(m_pNVCounters)
   {
@@ -888,14 +1009,6 @@ rdcarray<CounterResult> VulkanReplay::FetchCounters(const rdcarray<GPUCounter> &
   }
 #endif
 
-  rdcarray<GPUCounter> vkKHRCounters;
-  std::copy_if(counters.begin(), counters.end(), std::back_inserter(vkKHRCounters),
-               [](const GPUCounter &c) { return IsVulkanExtendedCounter(c); });
-  if(!vkKHRCounters.empty())
-  {
-    ret.append(FetchCountersKHR(vkKHRCounters));
-  }
-
   VkPhysicalDeviceFeatures availableFeatures = m_pDriver->GetDeviceEnabledFeatures();
 
   VkDevice dev = m_pDriver->GetDev();
@@ -997,24 +1110,107 @@ rdcarray<CounterResult> VulkanReplay::FetchCounters(const rdcarray<GPUCounter> &
   vkr = ObjDisp(dev)->EndCommandBuffer(Unwrap(cmd));
   CheckVkResult(vkr);
 
-  if(Vulkan_Debug_SingleSubmitFlushing())
-    m_pDriver->SubmitCmds();
-
   VulkanGPUTimerCallback cb(m_pDriver, this, timeStampPool, occlusionPool, pipeStatsPool,
                             compPipeStatsPool);
 
-  // replay the events to perform all the queries
-  m_pDriver->ReplayLog(0, maxEID, eReplay_Full);
+  // the generic queries only need a replay of their own if no AMD or KHR counter pass can carry
+  // them. The NV counters can't, as their library drives its own replays.
+  VulkanActionCallback *sharedCB = vkCounters.empty() ? NULL : &cb;
+
+  if(Vulkan_Debug_SingleSubmitFlushing() || (sharedCB && !amdCounters.empty()))
+    m_pDriver->SubmitCmds();
+
+  if(!amdCounters.empty())
+    ret.append(FetchCountersAMD(amdCounters, sharedCB));
+
+  if(!vkKHRCounters.empty())
+    ret.append(FetchCountersKHR(vkKHRCounters, sharedCB));
+
+  if(sharedCB)
+  {
+    m_pDriver->SetActionCB(&cb);
+
+    // replay the events to perform all the queries
+    m_pDriver->ReplayLog(0, maxEID, eReplay_Full);
+
+    m_pDriver->SetActionCB(NULL);
+  }
 
   rdcarray<uint64_t> timeStampData;
   timeStampData.resize(cb.m_Results.size() * 2);
 
-  vkr = ObjDisp(dev)->GetQueryPoolResults(
-      Unwrap(dev), timeStampPool, 0, (uint32_t)timeStampData.size(),
-      sizeof(uint64_t) * timeStampData.size(), &timeStampData[0], sizeof(uint64_t),
-      VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+  vkr = VK_SUCCESS;
+  if(!cb.m_Results.empty())
+    vkr = ObjDisp(dev)->GetQueryPoolResults(
+        Unwrap(dev), timeStampPool, 0, (uint32_t)timeStampData.size(),
+        sizeof(uint64_t) * timeStampData.size(), &timeStampData[0], sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
   CheckVkResult(vkr);
 
+  const double timestampPeriod = double(m_pDriver->GetDeviceProps().limits.timestampPeriod);
+
+  // each event's GPU duration in seconds, from every replay it was timed in
+  rdcarray<rdcarray<double>> durations;
+  durations.resize(cb.m_Results.size());
+
+  auto addDurations = [&]() {
+    for(size_t i = 0; i < durations.size(); i++)
+    {
+      uint64_t delta = timeStampData[i * 2 + 1] - timeStampData[i * 2 + 0];
+      durations[i].push_back((timestampPeriod * double(delta))    // nanoseconds
+                             / (1000.0 * 1000.0 * 1000.0));       // to seconds
+    }
+  };
+
+  addDurations();
+
+  uint32_t timingRepeats = 1;
+  if(!durations.empty() && (vkCounters.contains(GPUCounter::EventGPUDuration) ||
+                            vkCounters.contains(GPUCounter::EventGPUDurationStdDev)))
+    timingRepeats = GetGPUDurationRepeats();
+
+  // time the events again with nothing but timestamps. Vulkan has no way to lock the GPU clocks,
+  // so we rely on the median to discard replays that were disturbed by clock changes.
+  for(uint32_t r = 1; r < timingRepeats; r++)
+  {
+    cmd = m_pDriver->GetNextCmd();
+
+    if(cmd == VK_NULL_HANDLE)
+      break;
+
+    vkr = ObjDisp(dev)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+    CheckVkResult(vkr);
+
+    ObjDisp(dev)->CmdResetQueryPool(Unwrap(cmd), timeStampPool, 0, maxEID * 2);
+
+    vkr = ObjDisp(dev)->EndCommandBuffer(Unwrap(cmd));
+    CheckVkResult(vkr);
+
+    m_pDriver->SubmitCmds();
+
+    VulkanGPUTimerCallback timingCB(m_pDriver, this, timeStampPool, VK_NULL_HANDLE,
+                                    VK_NULL_HANDLE, VK_NULL_HANDLE);
+
+    m_pDriver->SetActionCB(&timingCB);
+    m_pDriver->ReplayLog(0, maxEID, eReplay_Full);
+    m_pDriver->SetActionCB(NULL);
+
+    if(timingCB.m_Results.size() != cb.m_Results.size())
+    {
+      RDCERR("Timing replay saw %zu events, expected %zu", timingCB.m_Results.size(),
+             cb.m_Results.size());
+      break;
+    }
+
+    vkr = ObjDisp(dev)->GetQueryPoolResults(
+        Unwrap(dev), timeStampPool, 0, (uint32_t)timeStampData.size(),
+        sizeof(uint64_t) * timeStampData.size(), &timeStampData[0], sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+    CheckVkResult(vkr);
+
+    addDurations();
+  }
+
   ObjDisp(dev)->DestroyQueryPool(Unwrap(dev), timeStampPool, NULL);
 
   rdcarray<uint64_t> occlusionData;
@@ -1097,13 +1293,11 @@ rdcarray<CounterResult> VulkanReplay::FetchCounters(const rdcarray<GPUCounter> &
       switch(vkCounters[c])
       {
         case GPUCounter::EventGPUDuration:
-        {
-          uint64_t delta = timeStampData[i * 2 + 1] - timeStampData[i * 2 + 0];
-          result.value.d = (double(m_pDriver->GetDeviceProps().limits.timestampPeriod) *
-                            double(delta))                  // nanoseconds
-                           / (1000.0 * 1000.0 * 1000.0);    // to seconds
-        }
-        break;
+          result.value.d = CalcDurationMedian(durations[i]);
+          break;
+        case GPUCounter::EventGPUDurationStdDev:
+          result.value.d = CalcDurationStdDev(durations[i]);
+          break;
         case GPUCounter::InputVerticesRead: result.value.u64 = pipeStats[0]; break;
         case GPUCounter::IAPrimitives: result.value.u64 = pipeStats[1]; break;
         case GPUCounter::GSPrimitives: result.value.u64 = pipeStats[4]; break;
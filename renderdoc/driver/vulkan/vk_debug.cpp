@@ -1180,195 +1180,213 @@ uint32_t VulkanReplay::PickVertex(uint32_t eventId, int32_t width, int32_t heigh
 
   bytebuf idxs;
 
-  uint32_t minIndex = 0;
-  uint32_t maxIndex = cfg.position.numIndices;
+  // the index and vertex data we prepare depends only on the mesh, not on the pick position. When
+  // picking repeatedly in the same mesh (e.g. while hovering) the previous data can be used as-is
+  const uint64_t pickKey = MeshPickingKey(eventId, cfg.position);
+  const bool uploadData = (pickKey != m_VertexPick.DataKey);
 
-  if(cfg.position.indexByteStride && cfg.position.indexResourceId != ResourceId())
-    GetBufferData(cfg.position.indexResourceId, cfg.position.indexByteOffset, 0, idxs);
+  if(uploadData)
+  {
+    m_VertexPick.DataKey = 0;
 
-  uint32_t idxclamp = 0;
-  if(cfg.position.baseVertex < 0)
-    idxclamp = uint32_t(-cfg.position.baseVertex);
+    uint32_t minIndex = 0;
+    uint32_t maxIndex = cfg.position.numIndices;
 
-  // We copy into our own buffers to promote to the target type (uint32) that the shader expects.
-  // Most IBs will be 16-bit indices, most VBs will not be float4. We also apply baseVertex here
+    if(cfg.position.indexByteStride && cfg.position.indexResourceId != ResourceId())
+      GetBufferData(cfg.position.indexResourceId, cfg.position.indexByteOffset, 0, idxs);
 
-  if(!idxs.empty())
-  {
-    rdcarray<uint32_t> idxtmp;
+    uint32_t idxclamp = 0;
+    if(cfg.position.baseVertex < 0)
+      idxclamp = uint32_t(-cfg.position.baseVertex);
 
-    // if it's a triangle fan that allows restart, we'll have to unpack it.
-    // Allocate enough space for the list on the GPU, and enough temporary space to upcast into
-    // first
-    if(fandecode)
-    {
-      idxtmp.resize(numIndices);
+    // We copy into our own buffers to promote to the target type (uint32) that the shader expects.
+    // Most IBs will be 16-bit indices, most VBs will not be float4. We also apply baseVertex here
 
-      numIndices *= 3;
-    }
-
-    // resize up on demand
-    if(m_VertexPick.IBSize < numIndices * sizeof(uint32_t))
+    if(!idxs.empty())
     {
-      if(m_VertexPick.IBSize > 0)
+      rdcarray<uint32_t> idxtmp;
+
+      // if it's a triangle fan that allows restart, we'll have to unpack it.
+      // Allocate enough space for the list on the GPU, and enough temporary space to upcast into
+      // first
+      if(fandecode)
       {
-        m_VertexPick.IB.Destroy();
-        m_VertexPick.IBUpload.Destroy();
+        idxtmp.resize(numIndices);
+
+        numIndices *= 3;
       }
 
-      m_VertexPick.IBSize = numIndices * sizeof(uint32_t);
+      // resize up on demand
+      if(m_VertexPick.IBSize < numIndices * sizeof(uint32_t))
+      {
+        if(m_VertexPick.IBSize > 0)
+        {
+          m_VertexPick.IB.Destroy();
+          m_VertexPick.IBUpload.Destroy();
+        }
 
-      m_VertexPick.IB.Create(m_pDriver, dev, m_VertexPick.IBSize, 1,
-                             GPUBuffer::eGPUBufferGPULocal | GPUBuffer::eGPUBufferSSBO);
-      m_VertexPick.IBUpload.Create(m_pDriver, dev, m_VertexPick.IBSize, 1, 0);
-    }
+        m_VertexPick.IBSize = numIndices * sizeof(uint32_t);
 
-    uint32_t *outidxs = (uint32_t *)m_VertexPick.IBUpload.Map();
-    uint32_t *mappedPtr = outidxs;
-    if(!mappedPtr)
-      return ~0U;
+        m_VertexPick.IB.Create(m_pDriver, dev, m_VertexPick.IBSize, 1,
+                               GPUBuffer::eGPUBufferGPULocal | GPUBuffer::eGPUBufferSSBO);
+        m_VertexPick.IBUpload.Create(m_pDriver, dev, m_VertexPick.IBSize, 1, 0);
+      }
 
-    memset(outidxs, 0, m_VertexPick.IBSize);
+      uint32_t *outidxs = (uint32_t *)m_VertexPick.IBUpload.Map();
+      uint32_t *mappedPtr = outidxs;
+      if(!mappedPtr)
+        return ~0U;
 
-    // if we're decoding a fan, we write into our temporary vector first
-    if(fandecode)
-      outidxs = idxtmp.data();
+      memset(outidxs, 0, m_VertexPick.IBSize);
 
-    uint16_t *idxs16 = (uint16_t *)&idxs[0];
-    uint32_t *idxs32 = (uint32_t *)&idxs[0];
+      // if we're decoding a fan, we write into our temporary vector first
+      if(fandecode)
+        outidxs = idxtmp.data();
 
-    size_t idxcount = 0;
+      uint16_t *idxs16 = (uint16_t *)&idxs[0];
+      uint32_t *idxs32 = (uint32_t *)&idxs[0];
 
-    if(cfg.position.indexByteStride == 2)
-    {
-      size_t bufsize = idxs.size() / 2;
+      size_t idxcount = 0;
 
-      for(uint32_t i = 0; i < bufsize && i < cfg.position.numIndices; i++)
+      if(cfg.position.indexByteStride == 2)
       {
-        uint32_t idx = idxs16[i];
-
-        if(idx < idxclamp)
-          idx = 0;
-        else if(cfg.position.baseVertex < 0)
-          idx -= idxclamp;
-        else if(cfg.position.baseVertex > 0)
-          idx += cfg.position.baseVertex;
+        size_t bufsize = idxs.size() / 2;
 
-        if(i == 0)
+        for(uint32_t i = 0; i < bufsize && i < cfg.position.numIndices; i++)
         {
-          minIndex = maxIndex = idx;
+          uint32_t idx = idxs16[i];
+
+          if(idx < idxclamp)
+            idx = 0;
+          else if(cfg.position.baseVertex < 0)
+            idx -= idxclamp;
+          else if(cfg.position.baseVertex > 0)
+            idx += cfg.position.baseVertex;
+
+          if(i == 0)
+          {
+            minIndex = maxIndex = idx;
+          }
+          else
+          {
+            minIndex = RDCMIN(idx, minIndex);
+            maxIndex = RDCMAX(idx, maxIndex);
+          }
+
+          outidxs[i] = idx;
+          idxcount++;
         }
-        else
+      }
+      else
+      {
+        uint32_t bufsize = uint32_t(idxs.size() / 4);
+
+        minIndex = maxIndex = idxs32[0];
+
+        for(uint32_t i = 0; i < RDCMIN(bufsize, cfg.position.numIndices); i++)
         {
+          uint32_t idx = idxs32[i];
+
+          if(idx < idxclamp)
+            idx = 0;
+          else if(cfg.position.baseVertex < 0)
+            idx -= idxclamp;
+          else if(cfg.position.baseVertex > 0)
+            idx += cfg.position.baseVertex;
+
           minIndex = RDCMIN(idx, minIndex);
           maxIndex = RDCMAX(idx, maxIndex);
-        }
 
-        outidxs[i] = idx;
-        idxcount++;
+          outidxs[i] = idx;
+          idxcount++;
+        }
       }
-    }
-    else
-    {
-      uint32_t bufsize = uint32_t(idxs.size() / 4);
-
-      minIndex = maxIndex = idxs32[0];
 
-      for(uint32_t i = 0; i < RDCMIN(bufsize, cfg.position.numIndices); i++)
+      // if it's a triangle fan that allows restart, unpack it
+      if(cfg.position.topology == Topology::TriangleFan && cfg.position.allowRestart)
       {
-        uint32_t idx = idxs32[i];
+        // resize to how many indices were actually read
+        idxtmp.resize(idxcount);
 
-        if(idx < idxclamp)
-          idx = 0;
-        else if(cfg.position.baseVertex < 0)
-          idx -= idxclamp;
-        else if(cfg.position.baseVertex > 0)
-          idx += cfg.position.baseVertex;
+        // patch the index buffer
+        PatchTriangleFanRestartIndexBufer(idxtmp, cfg.position.restartIndex);
 
-        minIndex = RDCMIN(idx, minIndex);
-        maxIndex = RDCMAX(idx, maxIndex);
+        for(uint32_t &idx : idxtmp)
+        {
+          if(idx == cfg.position.restartIndex)
+            idx = 0;
+        }
 
-        outidxs[i] = idx;
-        idxcount++;
+        numIndices = (uint32_t)idxtmp.size();
+
+        // now copy the decoded list to the GPU
+        memcpy(mappedPtr, idxtmp.data(), idxtmp.size() * sizeof(uint32_t));
       }
-    }
 
-    // if it's a triangle fan that allows restart, unpack it
-    if(cfg.position.topology == Topology::TriangleFan && cfg.position.allowRestart)
+      m_VertexPick.IBUpload.Unmap();
+    }
+    else
     {
-      // resize to how many indices were actually read
-      idxtmp.resize(idxcount);
-
-      // patch the index buffer
-      PatchTriangleFanRestartIndexBufer(idxtmp, cfg.position.restartIndex);
-
-      for(uint32_t &idx : idxtmp)
+      // ensure IB is non-empty so we have a valid descriptor below
+      if(m_VertexPick.IBSize == 0)
       {
-        if(idx == cfg.position.restartIndex)
-          idx = 0;
-      }
+        m_VertexPick.IBSize = 1 * sizeof(uint32_t);
 
-      numIndices = (uint32_t)idxtmp.size();
-
-      // now copy the decoded list to the GPU
-      memcpy(mappedPtr, idxtmp.data(), idxtmp.size() * sizeof(uint32_t));
+        m_VertexPick.IB.Create(m_pDriver, dev, m_VertexPick.IBSize, 1,
+                               GPUBuffer::eGPUBufferGPULocal | GPUBuffer::eGPUBufferSSBO);
+      }
     }
 
-    m_VertexPick.IBUpload.Unmap();
-  }
-  else
-  {
-    // ensure IB is non-empty so we have a valid descriptor below
-    if(m_VertexPick.IBSize == 0)
+    // unpack and linearise the data
     {
-      m_VertexPick.IBSize = 1 * sizeof(uint32_t);
+      bytebuf oldData;
+      GetBufferData(cfg.position.vertexResourceId, cfg.position.vertexByteOffset, 0, oldData);
 
-      m_VertexPick.IB.Create(m_pDriver, dev, m_VertexPick.IBSize, 1,
-                             GPUBuffer::eGPUBufferGPULocal | GPUBuffer::eGPUBufferSSBO);
-    }
-  }
+      // clamp maxIndex to upper bound in case we got invalid indices or primitive restart indices
+      maxIndex =
+          RDCMIN(maxIndex, uint32_t(oldData.size() / RDCMAX(1U, cfg.position.vertexByteStride)));
 
-  // unpack and linearise the data
-  {
-    bytebuf oldData;
-    GetBufferData(cfg.position.vertexResourceId, cfg.position.vertexByteOffset, 0, oldData);
+      if(m_VertexPick.VBSize < (maxIndex + 1) * sizeof(FloatVector))
+      {
+        if(m_VertexPick.VBSize > 0)
+        {
+          m_VertexPick.VB.Destroy();
+          m_VertexPick.VBUpload.Destroy();
+        }
 
-    // clamp maxIndex to upper bound in case we got invalid indices or primitive restart indices
-    maxIndex = RDCMIN(maxIndex, uint32_t(oldData.size() / RDCMAX(1U, cfg.position.vertexByteStride)));
+        m_VertexPick.VBSize = (maxIndex + 1) * sizeof(FloatVector);
 
-    if(m_VertexPick.VBSize < (maxIndex + 1) * sizeof(FloatVector))
-    {
-      if(m_VertexPick.VBSize > 0)
-      {
-        m_VertexPick.VB.Destroy();
-        m_VertexPick.VBUpload.Destroy();
+        m_VertexPick.VB.Create(m_pDriver, dev, m_VertexPick.VBSize, 1,
+                               GPUBuffer::eGPUBufferGPULocal | GPUBuffer::eGPUBufferSSBO);
+        m_VertexPick.VBUpload.Create(m_pDriver, dev, m_VertexPick.VBSize, 1, 0);
       }
 
-      m_VertexPick.VBSize = (maxIndex + 1) * sizeof(FloatVector);
+      byte *data = &oldData[0];
+      byte *dataEnd = data + oldData.size();
 
-      m_VertexPick.VB.Create(m_pDriver, dev, m_VertexPick.VBSize, 1,
-                             GPUBuffer::eGPUBufferGPULocal | GPUBuffer::eGPUBufferSSBO);
-      m_VertexPick.VBUpload.Create(m_pDriver, dev, m_VertexPick.VBSize, 1, 0);
-    }
-
-    byte *data = &oldData[0];
-    byte *dataEnd = data + oldData.size();
+      bool valid = true;
 
-    bool valid = true;
+      FloatVector *vbData = (FloatVector *)m_VertexPick.VBUpload.Map();
+      if(!vbData)
+        return ~0U;
 
-    FloatVector *vbData = (FloatVector *)m_VertexPick.VBUpload.Map();
-    if(!vbData)
-      return ~0U;
+      // the index buffer may refer to vertices past the start of the vertex buffer, so we can't
+      // just conver the first N vertices we'll need.
+      // Instead we grab min and max above, and convert every vertex in that range. This might
+      // slightly over-estimate but not as bad as 0-max or the whole buffer.
+      for(uint32_t idx = minIndex; idx <= maxIndex; idx++)
+        vbData[idx] = HighlightCache::InterpretVertex(data, idx, cfg.position.vertexByteStride,
+                                                      cfg.position.format, dataEnd, valid);
 
-    // the index buffer may refer to vertices past the start of the vertex buffer, so we can't just
-    // conver the first N vertices we'll need.
-    // Instead we grab min and max above, and convert every vertex in that range. This might
-    // slightly over-estimate but not as bad as 0-max or the whole buffer.
-    for(uint32_t idx = minIndex; idx <= maxIndex; idx++)
-      vbData[idx] = HighlightCache::InterpretVertex(data, idx, cfg.position.vertexByteStride,
-                                                    cfg.position.format, dataEnd, valid);
+      m_VertexPick.VBUpload.Unmap();
+    }
 
-    m_VertexPick.VBUpload.Unmap();
+    m_VertexPick.DataKey = pickKey;
+    m_VertexPick.NumIndices = numIndices;
+  }
+  else
+  {
+    numIndices = m_VertexPick.NumIndices;
   }
 
   MeshPickUBOData *ubo = (MeshPickUBOData *)m_VertexPick.UBO.Map();
@@ -1498,7 +1516,7 @@ uint32_t VulkanReplay::PickVertex(uint32_t eventId, int32_t width, int32_t heigh
   DoPipelineBarrier(cmd, 1, &bufBarrier);
 
   // copy uploaded VB and if needed IB
-  if(!idxs.empty())
+  if(uploadData && !idxs.empty())
   {
     // wait for writes
     bufBarrier.buffer = Unwrap(m_VertexPick.IBUpload.buf);
@@ -1518,22 +1536,25 @@ uint32_t VulkanReplay::PickVertex(uint32_t eventId, int32_t width, int32_t heigh
     DoPipelineBarrier(cmd, 1, &bufBarrier);
   }
 
-  // wait for writes
-  bufBarrier.buffer = Unwrap(m_VertexPick.VBUpload.buf);
-  bufBarrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT;
-  bufBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-  DoPipelineBarrier(cmd, 1, &bufBarrier);
+  if(uploadData)
+  {
+    // wait for writes
+    bufBarrier.buffer = Unwrap(m_VertexPick.VBUpload.buf);
+    bufBarrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT;
+    bufBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    DoPipelineBarrier(cmd, 1, &bufBarrier);
 
-  // do copy
-  bufCopy.size = m_VertexPick.VBSize;
-  vt->CmdCopyBuffer(Unwrap(cmd), Unwrap(m_VertexPick.VBUpload.buf), Unwrap(m_VertexPick.VB.buf), 1,
-                    &bufCopy);
+    // do copy
+    bufCopy.size = m_VertexPick.VBSize;
+    vt->CmdCopyBuffer(Unwrap(cmd), Unwrap(m_VertexPick.VBUpload.buf), Unwrap(m_VertexPick.VB.buf),
+                      1, &bufCopy);
 
-  // wait for copy
-  bufBarrier.buffer = Unwrap(m_VertexPick.VB.buf);
-  bufBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-  bufBarrier.dstAccessMask = VK_ACCESS_UNIFORM_READ_BIT;
-  DoPipelineBarrier(cmd, 1, &bufBarrier);
+    // wait for copy
+    bufBarrier.buffer = Unwrap(m_VertexPick.VB.buf);
+    bufBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    bufBarrier.dstAccessMask = VK_ACCESS_UNIFORM_READ_BIT;
+    DoPipelineBarrier(cmd, 1, &bufBarrier);
+  }
 
   vt->CmdBindPipeline(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE, Unwrap(m_VertexPick.Pipeline));
   vt->CmdBindDescriptorSets(Unwrap(cmd), VK_PIPELINE_BIND_POINT_COMPUTE, Unwrap(m_VertexPick.Layout),
@@ -3121,15 +3142,7 @@ void VulkanReplay::CreateResources()
 
   RenderDoc::Inst().SetProgress(LoadProgress::DebugManagerInit, 0.75f);
 
-  m_PixelHistory.Init(m_pDriver, m_General.DescriptorPool);
-
-  RenderDoc::Inst().SetProgress(LoadProgress::DebugManagerInit, 0.8f);
-
-  m_Histogram.Init(m_pDriver, m_General.DescriptorPool);
-
-  RenderDoc::Inst().SetProgress(LoadProgress::DebugManagerInit, 0.9f);
-
-  m_ShaderDebugData.Init(m_pDriver, m_General.DescriptorPool);
+  // pixel history, histogram/min-max and shader debugging resources are created on first use
 
   RenderDoc::Inst().SetProgress(LoadProgress::DebugManagerInit, 1.0f);
 
@@ -3179,10 +3192,31 @@ void VulkanReplay::CreateResources()
   }
 }
 
+void VulkanReplay::InitHistogramResources()
+{
+  if(m_Histogram.m_HistogramDescSetLayout == VK_NULL_HANDLE)
+    m_Histogram.Init(m_pDriver, m_General.DescriptorPool);
+}
+
+void VulkanReplay::InitPixelHistoryResources()
+{
+  if(m_PixelHistory.MSCopyDescSetLayout == VK_NULL_HANDLE)
+    m_PixelHistory.Init(m_pDriver, m_General.DescriptorPool);
+}
+
+ShaderDebugData &VulkanReplay::GetShaderDebugData()
+{
+  if(m_ShaderDebugData.DescSetLayout == VK_NULL_HANDLE)
+    m_ShaderDebugData.Init(m_pDriver, m_General.DescriptorPool);
+
+  return m_ShaderDebugData;
+}
+
 void VulkanReplay::DestroyResources()
 {
   ClearPostVSCache();
   ClearFeedbackCache();
+  ClearDisplayPyramids();
 
   m_General.Destroy(m_pDriver);
   m_TexRender.Destroy(m_pDriver);
@@ -3861,8 +3895,25 @@ void VulkanReplay::OverlayRendering::Init(WrappedVulkan *driver, VkDescriptorPoo
   driver->vkDestroyRenderPass(driver->GetDev(), SRGBA8MSRP, NULL);
 }
 
+void VulkanReplay::OverlayRendering::QuadPassCache::Release(WrappedVulkan *driver)
+{
+  if(Image == VK_NULL_HANDLE)
+    return;
+
+  driver->vkDestroyImageView(driver->GetDev(), View, NULL);
+  driver->vkDestroyImage(driver->GetDev(), Image, NULL);
+  driver->vkFreeMemory(driver->GetDev(), Mem, NULL);
+
+  Image = VK_NULL_HANDLE;
+  View = VK_NULL_HANDLE;
+  Mem = VK_NULL_HANDLE;
+  Events.clear();
+}
+
 void VulkanReplay::OverlayRendering::Destroy(WrappedVulkan *driver)
 {
+  m_QuadPass.Release(driver);
+
   if(ImageMem == VK_NULL_HANDLE)
     return;
 
@@ -4040,7 +4091,7 @@ void VulkanReplay::PixelPicking::Init(WrappedVulkan *driver, VkDescriptorPool de
       0,
       VK_IMAGE_TYPE_2D,
       VK_FORMAT_R32G32B32A32_SFLOAT,
-      {1, 1, 1},
+      {TileSize, TileSize, 1},
       1,
       1,
       VK_SAMPLE_COUNT_1_BIT,
@@ -4125,14 +4176,22 @@ void VulkanReplay::PixelPicking::Init(WrappedVulkan *driver, VkDescriptorPool de
 
   // create framebuffer
   VkFramebufferCreateInfo fbinfo = {
-      VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO, NULL, 0, RP, 1, &ImageView, 1, 1, 1,
+      VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+      NULL,
+      0,
+      RP,
+      1,
+      &ImageView,
+      TileSize,
+      TileSize,
+      1,
   };
 
   vkr = driver->vkCreateFramebuffer(driver->GetDev(), &fbinfo, NULL, &FB);
   driver->CheckVkResult(vkr);
 
   // since we always sync for readback, doesn't need to be ring'd
-  ReadbackBuffer.Create(driver, driver->GetDev(), sizeof(float) * 4, 1,
+  ReadbackBuffer.Create(driver, driver->GetDev(), sizeof(float) * 4 * TileSize * TileSize, 1,
                         GPUBuffer::eGPUBufferReadback);
 }
 
@@ -4318,6 +4377,7 @@ void VulkanReplay::PostVS::Destroy(WrappedVulkan *driver)
 
 void VulkanReplay::Feedback::Destroy(WrappedVulkan *driver)
 {
+  ClearInstrumentation(driver);
   FeedbackBuffer.Destroy();
 }
 
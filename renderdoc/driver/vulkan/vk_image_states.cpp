@@ -129,299 +129,347 @@ template typename ImageSubresourceMap::SubresourceRangeIterTemplate<
     &ImageSubresourceMap::SubresourceRangeIterTemplate<
         const ImageSubresourceMap, ImageSubresourceMap::ConstSubresourcePairRef>::operator++();
 
-void ImageSubresourceMap::Split(bool splitAspects, bool splitLevels, bool splitLayers, bool splitDepth)
+uint32_t ImageSubresourceMap::SplitCount(uint16_t flags, uint32_t dim) const
 {
-  uint16_t newFlags = m_flags;
-  if(splitAspects)
-    newFlags |= (uint16_t)FlagBits::AreAspectsSplit;
-  else
-    splitAspects = AreAspectsSplit();
-
-  if(splitLevels)
-    newFlags |= (uint16_t)FlagBits::AreLevelsSplit;
-  else
-    splitLevels = AreLevelsSplit();
-
-  if(splitLayers)
-    newFlags |= (uint16_t)FlagBits::AreLayersSplit;
-  else
-    splitLayers = AreLayersSplit();
-
-  if(splitDepth)
-    newFlags |= (uint16_t)FlagBits::IsDepthSplit;
-  else
-    splitDepth = IsDepthSplit();
-
-  if(newFlags == m_flags)
-    // not splitting anything new
-    return;
-
-  uint32_t oldSplitAspectCount = AreAspectsSplit() ? m_aspectCount : 1;
-  uint32_t newSplitAspectCount = splitAspects ? m_aspectCount : oldSplitAspectCount;
+  switch(dim)
+  {
+    case 0: return AreAspectsSplit(flags) ? m_aspectCount : 1;
+    case 1: return AreLevelsSplit(flags) ? GetImageInfo().levelCount : 1;
+    case 2: return AreLayersSplit(flags) ? GetImageInfo().layerCount : 1;
+    case 3: return IsDepthSplit(flags) ? GetImageInfo().extent.depth : 1;
+    default: return 1;
+  }
+}
 
-  uint32_t oldSplitLevelCount = AreLevelsSplit() ? GetImageInfo().levelCount : 1;
-  uint32_t newSplitLevelCount = splitLevels ? GetImageInfo().levelCount : oldSplitLevelCount;
+uint64_t ImageSubresourceMap::InnerSize(uint16_t flags, uint32_t dim) const
+{
+  uint64_t ret = 1;
+  for(uint32_t d = dim + 1; d < 4; d++)
+    ret *= SplitCount(flags, d);
+  return ret;
+}
 
-  uint32_t oldSplitLayerCount = AreLayersSplit() ? GetImageInfo().layerCount : 1;
-  uint32_t newSplitLayerCount = splitLayers ? GetImageInfo().layerCount : oldSplitLayerCount;
+uint64_t ImageSubresourceMap::OuterSize(uint16_t flags, uint32_t dim) const
+{
+  uint64_t ret = 1;
+  for(uint32_t d = 0; d < dim; d++)
+    ret *= SplitCount(flags, d);
+  return ret;
+}
 
-  uint32_t oldSplitSliceCount = IsDepthSplit() ? GetImageInfo().extent.depth : 1;
-  uint32_t newSplitSliceCount = splitDepth ? GetImageInfo().extent.depth : oldSplitSliceCount;
+static const uint16_t DimensionSplitFlags[4] = {0x1, 0x2, 0x4, 0x8};
 
-  uint32_t oldSize = (uint32_t)m_values.size();
+void ImageSubresourceMap::SplitDimension(uint32_t dim)
+{
+  const uint16_t newFlags = m_flags | DimensionSplitFlags[dim];
+  const uint64_t outerCount = OuterSize(m_flags, dim);
+  const uint64_t innerSize = InnerSize(m_flags, dim);
+  const uint32_t splitCount = SplitCount(newFlags, dim);
 
-  uint32_t newSize =
-      newSplitAspectCount * newSplitLevelCount * newSplitLayerCount * newSplitSliceCount;
-  RDCASSERT(newSize > RDCMAX(oldSize, 1U));
+  // every block of indices with the same outer indices is repeated once for each index in the new
+  // dimension.
+  Intervals<ImageSubresourceState> newValues;
+  uint64_t newIndex = 0;
+  rdcarray<rdcpair<uint64_t, ImageSubresourceState>> blockRuns;
 
-  m_values.resize(newSize);
-  // if m_values was empty before, copy the first value from our inline storage
-  if(oldSize == 0)
-    m_values[0] = m_value;
+  auto keep = [](const ImageSubresourceState &, const ImageSubresourceState &val) { return val; };
 
-  uint32_t newAspectIndex = newSplitAspectCount - 1;
-  uint32_t oldAspectIndex = AreAspectsSplit() ? newAspectIndex : 0;
-  uint32_t newLevel = newSplitLevelCount - 1;
-  uint32_t oldLevel = AreLevelsSplit() ? newLevel : 0;
-  uint32_t newLayer = newSplitLayerCount - 1;
-  uint32_t oldLayer = AreLayersSplit() ? newLayer : 0;
-  uint32_t newSlice = newSplitSliceCount - 1;
-  uint32_t oldSlice = IsDepthSplit() ? newSlice : 0;
-  uint32_t newIndex = newSize - 1;
-  while(true)
+  for(uint64_t outer = 0; outer < outerCount; outer++)
   {
-    uint32_t oldIndex =
-        ((oldAspectIndex * oldSplitLevelCount + oldLevel) * oldSplitLayerCount + oldLayer) *
-            oldSplitSliceCount +
-        oldSlice;
-    m_values[newIndex] = m_values[oldIndex];
+    const uint64_t blockStart = outer * innerSize;
+    const uint64_t blockEnd = blockStart + innerSize;
 
-    if(newIndex == 0)
-    {
-      RDCASSERT(oldIndex == 0);
-      break;
-    }
-    --newIndex;
+    auto it = m_values.find(blockStart);
 
-    if(newSlice > 0)
+    if(it->finish() >= blockEnd)
     {
-      --newSlice;
-      oldSlice = IsDepthSplit() ? newSlice : 0;
+      // the whole block is one run, so the repeated block is too
+      newValues.update(newIndex, newIndex + innerSize * splitCount, it->value(), keep);
+      newIndex += innerSize * splitCount;
       continue;
     }
-    newSlice = newSplitSliceCount - 1;
-    oldSlice = oldSplitSliceCount - 1;
 
-    if(newLayer > 0)
+    blockRuns.clear();
+    for(; it != m_values.end() && it->start() < blockEnd; ++it)
     {
-      --newLayer;
-      oldLayer = AreLayersSplit() ? newLayer : 0;
-      continue;
-    }
-    newLayer = newSplitLayerCount - 1;
-    oldLayer = oldSplitLayerCount - 1;
-
-    if(newLevel > 0)
-    {
-      --newLevel;
-      oldLevel = AreLevelsSplit() ? newLevel : 0;
-      continue;
+      uint64_t runStart = RDCMAX(it->start(), blockStart);
+      uint64_t runEnd = RDCMIN(it->finish(), blockEnd);
+      blockRuns.push_back({runEnd - runStart, it->value()});
     }
-    newLevel = newSplitLevelCount - 1;
-    oldLevel = oldSplitLevelCount - 1;
 
-    if(newAspectIndex > 0)
+    for(uint32_t i = 0; i < splitCount; i++)
     {
-      --newAspectIndex;
-      oldAspectIndex = AreAspectsSplit() ? newAspectIndex : 0;
-      continue;
+      for(const rdcpair<uint64_t, ImageSubresourceState> &run : blockRuns)
+      {
+        newValues.update(newIndex, newIndex + run.first, run.second, keep);
+        newIndex += run.first;
+      }
     }
-    RDCERR("Too many subresources in ImageSubresourceMap::Split");
-    break;
   }
 
+  m_values = std::move(newValues);
   m_flags = newFlags;
 }
 
-void ImageSubresourceMap::Unsplit(bool unsplitAspects, bool unsplitLevels, bool unsplitLayers,
-                                  bool unsplitDepth)
+void ImageSubresourceMap::UnsplitDimension(uint32_t dim)
 {
-  uint16_t newFlags = m_flags;
-  if(unsplitAspects)
-    newFlags &= ~(uint16_t)FlagBits::AreAspectsSplit;
+  const uint16_t newFlags = m_flags & ~DimensionSplitFlags[dim];
+  const uint64_t outerCount = OuterSize(m_flags, dim);
+  const uint64_t innerSize = InnerSize(m_flags, dim);
+  const uint32_t splitCount = SplitCount(m_flags, dim);
 
-  if(unsplitLevels)
-    newFlags &= ~(uint16_t)FlagBits::AreLevelsSplit;
+  // keep only the first block of indices in the dimension being unsplit
+  Intervals<ImageSubresourceState> newValues;
+  uint64_t newIndex = 0;
 
-  if(unsplitLayers)
-    newFlags &= ~(uint16_t)FlagBits::AreLayersSplit;
+  auto keep = [](const ImageSubresourceState &, const ImageSubresourceState &val) { return val; };
 
-  if(unsplitDepth)
-    newFlags &= ~(uint16_t)FlagBits::IsDepthSplit;
-
-  if(newFlags == m_flags)
-    // not splitting anything new
-    return;
+  for(uint64_t outer = 0; outer < outerCount; outer++)
+  {
+    const uint64_t blockStart = outer * innerSize * splitCount;
+    const uint64_t blockEnd = blockStart + innerSize;
 
-  uint32_t oldSplitAspectCount = AreAspectsSplit() ? m_aspectCount : 1;
-  uint32_t newSplitAspectCount = unsplitAspects ? 1 : oldSplitAspectCount;
+    for(auto it = m_values.find(blockStart); it != m_values.end() && it->start() < blockEnd; ++it)
+    {
+      uint64_t runStart = RDCMAX(it->start(), blockStart);
+      uint64_t runEnd = RDCMIN(it->finish(), blockEnd);
+      newValues.update(newIndex, newIndex + (runEnd - runStart), it->value(), keep);
+      newIndex += runEnd - runStart;
+    }
+  }
 
-  uint32_t oldSplitLevelCount = AreLevelsSplit() ? GetImageInfo().levelCount : 1;
-  uint32_t newSplitLevelCount = unsplitLevels ? 1 : oldSplitLevelCount;
+  m_values = std::move(newValues);
+  m_flags = newFlags;
+}
 
-  uint32_t oldSplitLayerCount = AreLayersSplit() ? GetImageInfo().layerCount : 1;
-  uint32_t newSplitLayerCount = unsplitLayers ? 1 : oldSplitLayerCount;
+bool ImageSubresourceMap::CanUnsplitDimension(uint32_t dim) const
+{
+  const uint64_t outerCount = OuterSize(m_flags, dim);
+  const uint64_t innerSize = InnerSize(m_flags, dim);
+  const uint32_t splitCount = SplitCount(m_flags, dim);
 
-  uint32_t oldSplitSliceCount = IsDepthSplit() ? GetImageInfo().extent.depth : 1;
-  uint32_t newSplitSliceCount = unsplitDepth ? 1 : oldSplitSliceCount;
+  for(uint64_t outer = 0; outer < outerCount; outer++)
+  {
+    const uint64_t regionStart = outer * innerSize * splitCount;
+    const uint64_t regionEnd = regionStart + innerSize * splitCount;
 
-  uint32_t oldSize = (uint32_t)m_values.size();
-  RDCASSERT(oldSize > 0);
+    // if the whole region is one run then every block in it matches
+    if(m_values.find(regionStart)->finish() >= regionEnd)
+      continue;
 
-  uint32_t newSize =
-      newSplitAspectCount * newSplitLevelCount * newSplitLayerCount * newSplitSliceCount;
-  RDCASSERT(newSize < oldSize);
+    // otherwise compare each block against the first, a run at a time
+    for(uint32_t i = 1; i < splitCount; i++)
+    {
+      uint64_t offset = 0;
+      while(offset < innerSize)
+      {
+        auto first = m_values.find(regionStart + offset);
+        auto other = m_values.find(regionStart + i * innerSize + offset);
 
-  rdcarray<ImageSubresourceState> newValues;
-  newValues.resize(newSize);
+        if(first->value() != other->value())
+          return false;
 
-  uint32_t aspectIndex = 0;
-  uint32_t level = 0;
-  uint32_t layer = 0;
-  uint32_t slice = 0;
-  uint32_t newIndex = 0;
+        uint64_t firstLen = first->finish() - (regionStart + offset);
+        uint64_t otherLen = other->finish() - (regionStart + i * innerSize + offset);
+        offset += RDCMIN(firstLen, otherLen);
+      }
+    }
+  }
 
-  while(newIndex < newValues.size())
-  {
-    uint32_t oldIndex = ((aspectIndex * oldSplitLevelCount + level) * oldSplitLayerCount + layer) *
-                            oldSplitSliceCount +
-                        slice;
-    newValues[newIndex] = m_values[oldIndex];
+  return true;
+}
 
-    ++newIndex;
+void ImageSubresourceMap::Split(bool splitAspects, bool splitLevels, bool splitLayers, bool splitDepth)
+{
+  const bool split[4] = {splitAspects, splitLevels, splitLayers, splitDepth};
 
-    ++slice;
-    if(slice < newSplitSliceCount)
-      continue;
-    slice = 0;
+  // split the least significant dimensions first, so that the blocks being repeated are as large
+  // as possible
+  for(uint32_t d = 4; d > 0;)
+  {
+    --d;
+    if(split[d] && (m_flags & DimensionSplitFlags[d]) == 0)
+      SplitDimension(d);
+  }
+}
 
-    ++layer;
-    if(layer < newSplitLayerCount)
-      continue;
-    layer = 0;
+void ImageSubresourceMap::Unsplit(bool unsplitAspects, bool unsplitLevels, bool unsplitLayers,
+                                  bool unsplitDepth)
+{
+  const bool unsplit[4] = {unsplitAspects, unsplitLevels, unsplitLayers, unsplitDepth};
 
-    ++level;
-    if(level < newSplitLevelCount)
-      continue;
-    level = 0;
+  for(uint32_t d = 0; d < 4; d++)
+  {
+    if(unsplit[d] && (m_flags & DimensionSplitFlags[d]) != 0)
+      UnsplitDimension(d);
+  }
+}
 
-    ++aspectIndex;
+void ImageSubresourceMap::Unsplit()
+{
+  // a dimension can be unsplit if every subresource has the same state as the corresponding
+  // subresource at index 0 in that dimension. Unsplitting one dimension doesn't change whether
+  // another can be unsplit, so they can be checked one at a time on the shrinking map.
+  for(uint32_t d = 0; d < 4; d++)
+  {
+    if((m_flags & DimensionSplitFlags[d]) != 0 && CanUnsplitDimension(d))
+      UnsplitDimension(d);
   }
+}
 
-  newValues.swap(m_values);
-  m_flags = newFlags;
+void ImageSubresourceMap::SetIndexValue(size_t index, const ImageSubresourceState &state)
+{
+  auto keep = [](const ImageSubresourceState &, const ImageSubresourceState &val) { return val; };
+  m_values.update(index, index + 1, state, keep);
 }
 
-void ImageSubresourceMap::Unsplit()
+template <typename Callback>
+void ImageSubresourceMap::ForEachIndexSpan(const ImageSubresourceRange &range,
+                                           Callback callback) const
 {
-  if(m_values.size() <= 1)
+  uint32_t counts[4], bases[4], nums[4];
+
+  counts[0] = SplitCount(m_flags, 0);
+  bases[0] = 0;
+  nums[0] = 1;
+
+  counts[1] = SplitCount(m_flags, 1);
+  bases[1] = AreLevelsSplit() ? range.baseMipLevel : 0;
+  nums[1] = AreLevelsSplit() ? range.levelCount : 1;
+
+  counts[2] = SplitCount(m_flags, 2);
+  bases[2] = AreLayersSplit() ? range.baseArrayLayer : 0;
+  nums[2] = AreLayersSplit() ? range.layerCount : 1;
+
+  counts[3] = SplitCount(m_flags, 3);
+  bases[3] = IsDepthSplit() ? range.baseDepthSlice : 0;
+  nums[3] = IsDepthSplit() ? range.sliceCount : 1;
+
+  if(nums[1] == 0 || nums[2] == 0 || nums[3] == 0)
     return;
 
-  uint32_t aspectCount = AreAspectsSplit() ? m_aspectCount : 1;
+  // find the most significant dimension where the range is contiguous. Every dimension less
+  // significant than it is fully covered, so each step in the dimensions above it is one span.
+  uint32_t contiguousDim = 3;
+  while(contiguousDim > 1 && bases[contiguousDim] == 0 &&
+        nums[contiguousDim] == counts[contiguousDim])
+    contiguousDim--;
+
+  const uint64_t spanLength = nums[contiguousDim] * InnerSize(m_flags, contiguousDim);
+
   uint32_t aspectIndex = 0;
-  uint32_t levelCount = AreLevelsSplit() ? m_imageInfo.levelCount : 1;
-  uint32_t level = 0;
-  uint32_t layerCount = AreLayersSplit() ? m_imageInfo.layerCount : 1;
-  uint32_t layer = 0;
-  uint32_t sliceCount = IsDepthSplit() ? m_imageInfo.extent.depth : 1;
-  uint32_t slice = 0;
-  uint32_t index = 0;
-
-  bool canUnsplitAspects = aspectCount > 1;
-  bool canUnsplitLevels = levelCount > 1;
-  bool canUnsplitLayers = layerCount > 1;
-  bool canUnsplitDepth = sliceCount > 1;
-
-  RDCASSERT(aspectCount * levelCount * layerCount * sliceCount == m_values.size());
-#define UNSPLIT_INDEX(ASPECT, LEVEL, LAYER, SLICE) \
-  ((((ASPECT)*levelCount + (LEVEL)) * layerCount + (LAYER)) * sliceCount + (SLICE))
-  while(index < m_values.size() &&
-        (canUnsplitAspects || canUnsplitLevels || canUnsplitLayers || canUnsplitDepth))
-  {
-    if(canUnsplitAspects && aspectIndex > 0)
-    {
-      uint32_t index0 = UNSPLIT_INDEX(0, level, layer, slice);
-      if(m_values[index] != m_values[index0])
-        canUnsplitAspects = false;
-    }
-    if(canUnsplitLevels && level > 0)
-    {
-      uint32_t index0 = UNSPLIT_INDEX(aspectIndex, 0, layer, slice);
-      if(m_values[index] != m_values[index0])
-        canUnsplitLevels = false;
-    }
-    if(canUnsplitLayers && layer > 0)
+  for(auto it = ImageAspectFlagIter::begin(GetImageInfo().Aspects());
+      it != ImageAspectFlagIter::end() && aspectIndex < counts[0]; ++it, ++aspectIndex)
+  {
+    if(AreAspectsSplit() && ((*it) & range.aspectMask) == 0)
+      continue;
+
+    uint32_t idx[4] = {aspectIndex, bases[1], bases[2], bases[3]};
+
+    bool done = false;
+    while(!done)
     {
-      uint32_t index0 = UNSPLIT_INDEX(aspectIndex, level, 0, slice);
-      if(m_values[index] != m_values[index0])
-        canUnsplitLayers = false;
+      uint64_t start = ((uint64_t(idx[0]) * counts[1] + idx[1]) * counts[2] + idx[2]) * counts[3] +
+                       idx[3];
+      callback(start, start + spanLength);
+
+      // step the dimensions above the contiguous one, the least significant first
+      done = true;
+      for(uint32_t d = contiguousDim - 1; d >= 1; d--)
+      {
+        if(++idx[d] < bases[d] + nums[d])
+        {
+          done = false;
+          break;
+        }
+        idx[d] = bases[d];
+      }
     }
-    if(canUnsplitDepth && slice > 0)
+  }
+}
+
+FrameRefType ImageSubresourceMap::Update(const ImageSubresourceRange &range,
+                                         const ImageSubresourceState &dst, FrameRefCompFunc compose)
+{
+  // check whether anything changes before splitting, to avoid splitting needlessly
+  bool changed = false;
+  ForEachIndexSpan(range, [&](uint64_t start, uint64_t finish) {
+    for(auto it = m_values.find(start); !changed && it != m_values.end() && it->start() < finish;
+        ++it)
     {
-      uint32_t index0 = UNSPLIT_INDEX(aspectIndex, level, layer, 0);
-      if(m_values[index] != m_values[index0])
-        canUnsplitDepth = false;
+      ImageSubresourceState subState;
+      changed = it->value().Update(dst, subState, compose);
     }
+  });
 
-    ++index;
+  if(!changed)
+    return eFrameRef_None;
 
-    ++slice;
-    if(slice < sliceCount)
-      continue;
-    slice = 0;
-
-    ++layer;
-    if(layer < layerCount)
-      continue;
-    layer = 0;
+  Split(range);
 
-    ++level;
-    if(level < levelCount)
-      continue;
-    level = 0;
+  FrameRefType maxRefType = eFrameRef_None;
+  auto update = [&](const ImageSubresourceState &oldState, const ImageSubresourceState &dstState) {
+    ImageSubresourceState subState;
+    if(oldState.Update(dstState, subState, compose))
+      maxRefType = ComposeFrameRefsDisjoint(maxRefType, subState.refType);
+    return subState;
+  };
 
-    ++aspectIndex;
-    if(aspectIndex >= aspectCount)
-      break;
-  }
-#undef UNSPLIT_INDEX
+  ForEachIndexSpan(range, [&](uint64_t start, uint64_t finish) {
+    m_values.update(start, finish, dst, update);
+  });
 
-  Unsplit(canUnsplitAspects, canUnsplitLevels, canUnsplitLayers, canUnsplitDepth);
+  return maxRefType;
 }
 
-inline FrameRefType ImageSubresourceMap::Merge(const ImageSubresourceMap &other,
-                                               FrameRefCompFunc compose)
+FrameRefType ImageSubresourceMap::Merge(const ImageSubresourceMap &other, FrameRefCompFunc compose)
 {
-  FrameRefType maxRefType = eFrameRef_None;
-  bool didSplit = false;
-  for(auto oIt = other.begin(); oIt != other.end(); ++oIt)
+  // bring both maps to the same split flags so that their indices line up
+  const uint16_t flags = m_flags | other.m_flags;
+
+  ImageSubresourceMap otherSplit;
+  const ImageSubresourceMap *src = &other;
+  if(other.m_flags != flags)
+  {
+    otherSplit = other;
+    otherSplit.Split(AreAspectsSplit(flags), AreLevelsSplit(flags), AreLayersSplit(flags),
+                     IsDepthSplit(flags));
+    src = &otherSplit;
+  }
+
+  // only split this map if something changes
+  ImageSubresourceMap thisSplit;
+  ImageSubresourceMap *dst = this;
+  if(m_flags != flags)
   {
-    for(auto it = RangeBegin(oIt->range()); it != end(); ++it)
+    thisSplit = *this;
+    thisSplit.Split(AreAspectsSplit(flags), AreLevelsSplit(flags), AreLayersSplit(flags),
+                    IsDepthSplit(flags));
+    dst = &thisSplit;
+  }
+
+  FrameRefType maxRefType = eFrameRef_None;
+  bool changed = false;
+  auto update = [&](const ImageSubresourceState &oldState, const ImageSubresourceState &srcState) {
+    ImageSubresourceState subState;
+    if(oldState.Update(srcState, subState, compose))
     {
-      ImageSubresourceState subState;
-      if(it->state().Update(oIt->state(), subState, compose))
-      {
-        if(!didSplit)
-        {
-          Split(oIt->range());
-          didSplit = true;
-        }
-        RDCASSERT(it->range().ContainedIn(oIt->range()));
-        it->SetState(subState);
-        maxRefType = ComposeFrameRefsDisjoint(maxRefType, subState.refType);
-      }
+      changed = true;
+      maxRefType = ComposeFrameRefsDisjoint(maxRefType, subState.refType);
     }
+    return subState;
+  };
+
+  const uint64_t count = src->size();
+  for(auto it = src->m_values.begin(); it != src->m_values.end() && it->start() < count; ++it)
+    dst->m_values.update(it->start(), RDCMIN(it->finish(), count), it->value(), update);
+
+  if(dst != this && changed)
+  {
+    m_values = std::move(thisSplit.m_values);
+    m_flags = flags;
   }
+
   return maxRefType;
 }
 
@@ -502,7 +550,9 @@ void ImageSubresourceMap::FromImgRefs(const ImgRefs &imgRefs)
     int aspectIndex = imgRefs.AspectIndex((VkImageAspectFlagBits)dstIt->range().aspectMask);
     int level = (int)dstIt->range().baseMipLevel;
     int layer = (int)(dstIt->range().baseArrayLayer + dstIt->range().baseDepthSlice);
-    dstIt->state().refType = imgRefs.SubresourceRef(aspectIndex, level, layer);
+    ImageSubresourceState state = dstIt->state();
+    state.refType = imgRefs.SubresourceRef(aspectIndex, level, layer);
+    dstIt->SetState(state);
   }
 }
 
@@ -712,7 +762,8 @@ template <typename Map, typename Pair>
 Pair *ImageSubresourceMap::SubresourceRangeIterTemplate<Map, Pair>::operator->()
 {
   FixSubRange();
-  m_value.m_state = &m_map->SubresourceIndexValue(m_aspectIndex, m_level, m_layer, m_slice);
+  m_value.m_map = m_map;
+  m_value.m_index = m_map->SubresourceIndex(m_aspectIndex, m_level, m_layer, m_slice);
   return &m_value;
 }
 template ImageSubresourceMap::SubresourcePairRef *ImageSubresourceMap::SubresourceRangeIterTemplate<
@@ -724,7 +775,8 @@ template <typename Map, typename Pair>
 Pair &ImageSubresourceMap::SubresourceRangeIterTemplate<Map, Pair>::operator*()
 {
   FixSubRange();
-  m_value.m_state = &m_map->SubresourceIndexValue(m_aspectIndex, m_level, m_layer, m_slice);
+  m_value.m_map = m_map;
+  m_value.m_index = m_map->SubresourceIndex(m_aspectIndex, m_level, m_layer, m_slice);
   return m_value;
 }
 template ImageSubresourceMap::SubresourcePairRef &ImageSubresourceMap::SubresourceRangeIterTemplate<
@@ -823,6 +875,138 @@ void ImageBarrierSequence::ExtractLastUnwrappedBatchForQueue(uint32_t queueFamil
   }
 }
 
+static bool IsOwnershipTransfer(const VkImageMemoryBarrier &barrier)
+{
+  return barrier.srcQueueFamilyIndex != barrier.dstQueueFamilyIndex;
+}
+
+static bool SameBarrierExceptRange(const VkImageMemoryBarrier &a, const VkImageMemoryBarrier &b)
+{
+  return a.image == b.image && a.srcAccessMask == b.srcAccessMask &&
+         a.dstAccessMask == b.dstAccessMask && a.oldLayout == b.oldLayout &&
+         a.newLayout == b.newLayout && a.srcQueueFamilyIndex == b.srcQueueFamilyIndex &&
+         a.dstQueueFamilyIndex == b.dstQueueFamilyIndex && a.pNext == NULL && b.pNext == NULL;
+}
+
+static bool SameSubresourceRange(const VkImageSubresourceRange &a, const VkImageSubresourceRange &b)
+{
+  return a.aspectMask == b.aspectMask && a.baseMipLevel == b.baseMipLevel &&
+         a.levelCount == b.levelCount && a.baseArrayLayer == b.baseArrayLayer &&
+         a.layerCount == b.layerCount;
+}
+
+// if b can be appended onto a to cover a single larger range, expand a and return true
+static bool CombineSubresourceRange(VkImageSubresourceRange &a, const VkImageSubresourceRange &b)
+{
+  if(a.levelCount == VK_REMAINING_MIP_LEVELS || a.layerCount == VK_REMAINING_ARRAY_LAYERS ||
+     b.levelCount == VK_REMAINING_MIP_LEVELS || b.layerCount == VK_REMAINING_ARRAY_LAYERS)
+    return false;
+
+  const bool sameAspects = a.aspectMask == b.aspectMask;
+  const bool sameLevels = a.baseMipLevel == b.baseMipLevel && a.levelCount == b.levelCount;
+  const bool sameLayers = a.baseArrayLayer == b.baseArrayLayer && a.layerCount == b.layerCount;
+
+  if(sameAspects && sameLevels && a.baseArrayLayer + a.layerCount == b.baseArrayLayer)
+  {
+    a.layerCount += b.layerCount;
+    return true;
+  }
+
+  if(sameAspects && sameLayers && a.baseMipLevel + a.levelCount == b.baseMipLevel)
+  {
+    a.levelCount += b.levelCount;
+    return true;
+  }
+
+  if(sameLevels && sameLayers && (a.aspectMask & b.aspectMask) == 0)
+  {
+    a.aspectMask |= b.aspectMask;
+    return true;
+  }
+
+  return false;
+}
+
+void ImageBarrierSequence::OptimiseBatch(Batch &barriers)
+{
+  if(barriers.size() < 2)
+    return;
+
+  // first fold chains of transitions on identical subresources. We only look at the most recent
+  // barrier on each image, so that any partially overlapping barrier in between stops the fold and
+  // the order of transitions is preserved.
+  Batch folded;
+  folded.reserve(barriers.size());
+  std::map<VkImage, size_t> lastBarrier;
+  rdcarray<bool> dropped;
+  dropped.reserve(barriers.size());
+
+  for(const VkImageMemoryBarrier &barrier : barriers)
+  {
+    auto it = lastBarrier.find(barrier.image);
+    if(it != lastBarrier.end() && !dropped[it->second])
+    {
+      VkImageMemoryBarrier &prev = folded[it->second];
+      if(!IsOwnershipTransfer(prev) && !IsOwnershipTransfer(barrier) &&
+         prev.srcQueueFamilyIndex == barrier.srcQueueFamilyIndex && prev.pNext == NULL &&
+         barrier.pNext == NULL && prev.newLayout == barrier.oldLayout &&
+         SameSubresourceRange(prev.subresourceRange, barrier.subresourceRange))
+      {
+        prev.newLayout = barrier.newLayout;
+        prev.srcAccessMask |= barrier.srcAccessMask;
+        prev.dstAccessMask |= barrier.dstAccessMask;
+
+        // a transition there and back again does nothing, the same as the barriers Transition()
+        // already skips
+        if(prev.oldLayout == prev.newLayout)
+          dropped[it->second] = true;
+        continue;
+      }
+    }
+
+    lastBarrier[barrier.image] = folded.size();
+    folded.push_back(barrier);
+    dropped.push_back(false);
+  }
+
+  // then combine barriers on neighbouring subresources. Transition() emits one barrier per split
+  // subresource range with layers varying fastest, so each pass combines consecutive barriers in
+  // one dimension: layers, then mips, then aspects.
+  barriers.clear();
+  for(size_t i = 0; i < folded.size(); i++)
+    if(!dropped[i])
+      barriers.push_back(folded[i]);
+
+  for(int pass = 0; pass < 3 && barriers.size() > 1; pass++)
+  {
+    size_t count = 1;
+    for(size_t i = 1; i < barriers.size(); i++)
+    {
+      VkImageMemoryBarrier &prev = barriers[count - 1];
+      if(SameBarrierExceptRange(prev, barriers[i]) &&
+         CombineSubresourceRange(prev.subresourceRange, barriers[i].subresourceRange))
+        continue;
+
+      barriers[count++] = barriers[i];
+    }
+    barriers.resize(count);
+  }
+}
+
+void ImageBarrierSequence::Optimise()
+{
+  size_t count = 0;
+  for(uint32_t batchIndex = 0; batchIndex < MAX_BATCH_COUNT; ++batchIndex)
+  {
+    for(Batch &barriers : batches[batchIndex])
+    {
+      OptimiseBatch(barriers);
+      count += barriers.size();
+    }
+  }
+  barrierCount = count;
+}
+
 ImageState ImageState::InitialState() const
 {
   ImageState result(wrappedHandle, GetImageInfo(), eFrameRef_Unknown);
@@ -833,13 +1017,13 @@ ImageState ImageState::InitialState() const
 void ImageState::InitialState(ImageState &result) const
 {
   result.subresourceStates = subresourceStates;
-  for(auto it = result.subresourceStates.begin(); it != result.subresourceStates.end(); ++it)
-  {
-    ImageSubresourceState &sub = it->state();
-    sub.newLayout = sub.oldLayout = GetImageInfo().initialLayout;
+  VkImageLayout initialLayout = GetImageInfo().initialLayout;
+  result.subresourceStates.TransformStates([initialLayout](ImageSubresourceState sub) {
+    sub.newLayout = sub.oldLayout = initialLayout;
     sub.newQueueFamilyIndex = sub.oldQueueFamilyIndex;
     sub.refType = eFrameRef_Unknown;
-  }
+    return sub;
+  });
 }
 
 ImageState ImageState::CommandBufferInitialState() const
@@ -861,18 +1045,17 @@ ImageState ImageState::ContentInitializationState(InitPolicy policy, bool initia
                                                   VkImageLayout clearLayout) const
 {
   ImageState result = *this;
-  for(auto it = result.subresourceStates.begin(); it != result.subresourceStates.end(); ++it)
-  {
-    ImageSubresourceState &sub = it->state();
+  result.subresourceStates.TransformStates([&](ImageSubresourceState sub) {
     InitReqType initReq = InitReq(sub.refType, policy, initialized);
     if(initReq == eInitReq_None)
-      continue;
+      return sub;
     sub.newQueueFamilyIndex = queueFamilyIndex;
     if(initReq == eInitReq_Copy)
       sub.newLayout = copyLayout;
     else if(initReq == eInitReq_Clear)
       sub.newLayout = clearLayout;
-  }
+    return sub;
+  });
   return result;
 }
 
@@ -889,22 +1072,8 @@ void ImageState::Update(ImageSubresourceRange range, const ImageSubresourceState
 {
   range.Sanitise(GetImageInfo());
 
-  bool didSplit = false;
-  for(auto it = subresourceStates.RangeBegin(range); it != subresourceStates.end(); ++it)
-  {
-    ImageSubresourceState subState;
-    if(it->state().Update(dst, subState, compose))
-    {
-      if(!didSplit)
-      {
-        subresourceStates.Split(range);
-        didSplit = true;
-      }
-      RDCASSERT(it->range().ContainedIn(range));
-      it->SetState(subState);
-      maxRefType = ComposeFrameRefsDisjoint(maxRefType, subState.refType);
-    }
-  }
+  maxRefType =
+      ComposeFrameRefsDisjoint(maxRefType, subresourceStates.Update(range, dst, compose));
 }
 
 void ImageState::Merge(const ImageState &other, ImageTransitionInfo info)
@@ -1119,14 +1288,16 @@ void ImageState::ResetToOldState(ImageBarrierSequence &barriers, ImageTransition
 
   for(auto subIt = subresourceStates.begin(); subIt != subresourceStates.end(); ++subIt)
   {
-    VkImageLayout oldLayout = subIt->state().newLayout;
+    ImageSubresourceState sub = subIt->state();
+    VkImageLayout oldLayout = sub.newLayout;
     if(oldLayout == UNKNOWN_PREV_IMG_LAYOUT)
       oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    VkImageLayout newLayout = subIt->state().oldLayout;
-    subIt->state().newLayout = subIt->state().oldLayout;
+    VkImageLayout newLayout = sub.oldLayout;
+    sub.newLayout = sub.oldLayout;
     if(newLayout == UNKNOWN_PREV_IMG_LAYOUT || newLayout == VK_IMAGE_LAYOUT_UNDEFINED)
     {
       // contents discarded, no barrier necessary
+      subIt->SetState(sub);
       continue;
     }
     SanitiseReplayImageLayout(oldLayout);
@@ -1137,8 +1308,12 @@ void ImageState::ResetToOldState(ImageBarrierSequence &barriers, ImageTransition
       newLayout = VK_IMAGE_LAYOUT_GENERAL;
     }
 
-    uint32_t srcQueueFamilyIndex = subIt->state().newQueueFamilyIndex;
-    uint32_t dstQueueFamilyIndex = subIt->state().oldQueueFamilyIndex;
+    uint32_t srcQueueFamilyIndex = sub.newQueueFamilyIndex;
+    uint32_t dstQueueFamilyIndex = sub.oldQueueFamilyIndex;
+
+    // whether or not a barrier is needed, the subresource is back in its old state
+    sub.newQueueFamilyIndex = sub.oldQueueFamilyIndex;
+    subIt->SetState(sub);
 
     if(srcQueueFamilyIndex == VK_QUEUE_FAMILY_EXTERNAL ||
        srcQueueFamilyIndex == VK_QUEUE_FAMILY_FOREIGN_EXT)
@@ -1173,10 +1348,7 @@ void ImageState::ResetToOldState(ImageBarrierSequence &barriers, ImageTransition
     }
 
     if(srcQueueFamilyIndex == dstQueueFamilyIndex && oldLayout == newLayout)
-    {
-      subIt->state().newQueueFamilyIndex = subIt->state().oldQueueFamilyIndex;
       continue;
-    }
 
     if(submitQueueFamilyIndex == VK_QUEUE_FAMILY_IGNORED)
     {
@@ -1186,7 +1358,6 @@ void ImageState::ResetToOldState(ImageBarrierSequence &barriers, ImageTransition
           info.defaultQueueFamilyIndex);
       submitQueueFamilyIndex = info.defaultQueueFamilyIndex;
     }
-    subIt->state().newQueueFamilyIndex = subIt->state().oldQueueFamilyIndex;
 
     ImageSubresourceRange subRange = subIt->range();
 
@@ -1264,7 +1435,11 @@ void ImageState::Transition(const ImageState &dstState, VkAccessFlags srcAccessM
         continue;
 
       subresourceStates.Split(dstRng);
-      std::swap(it->state(), srcSub);
+
+      // store the updated state, and keep the previous state in srcSub
+      ImageSubresourceState prevSub = it->state();
+      it->SetState(srcSub);
+      srcSub = prevSub;
 
       ImageSubresourceRange srcRng = it->range();
 
@@ -1476,14 +1651,12 @@ void ImageState::BeginCapture()
   // operations already submitted (and therefore not part of the capture).
   oldQueueFamilyTransfers.clear();
 
-  for(auto it = subresourceStates.begin(); it != subresourceStates.end(); ++it)
-  {
-    ImageSubresourceState state = it->state();
+  subresourceStates.TransformStates([](ImageSubresourceState state) {
     state.oldLayout = state.newLayout;
     state.oldQueueFamilyIndex = state.newQueueFamilyIndex;
     state.refType = eFrameRef_None;
-    it->SetState(state);
-  }
+    return state;
+  });
 }
 
 void ImageState::FixupStorageReferences()
@@ -1496,11 +1669,9 @@ void ImageState::FixupStorageReferences()
     // there might be a read before then which we just didn't track at the time.
     maxRefType = ComposeFrameRefsUnordered(maxRefType, eFrameRef_ReadBeforeWrite);
 
-    for(auto it = subresourceStates.begin(); it != subresourceStates.end(); ++it)
-    {
-      ImageSubresourceState state = it->state();
+    subresourceStates.TransformStates([](ImageSubresourceState state) {
       state.refType = ComposeFrameRefsUnordered(state.refType, eFrameRef_ReadBeforeWrite);
-      it->SetState(state);
-    }
+      return state;
+    });
   }
 }
@@ -26,6 +26,7 @@
 #include "core/settings.h"
 #include "lz4/lz4.h"
 #include "vk_core.h"
+#include "vk_shader_cache.h"
 
 // for compatibility we use the same DXBC name since it's now configured by the UI
 RDOC_EXTERN_CONFIG(rdcarray<rdcstr>, DXBC_Debug_SearchDirPaths);
@@ -878,7 +879,8 @@ void VulkanCreationInfo::Pipeline::Init(VulkanResourceManager *resourceMan,
     ShaderModuleReflection &reflData = info.m_ShaderModule[shadid].m_Reflections[key];
 
     reflData.Init(resourceMan, shadid, info.m_ShaderModule[shadid].spirv, shad.entryPoint,
-                  pCreateInfo->pStages[i].stage, shad.specialization);
+                  pCreateInfo->pStages[i].stage, shad.specialization, info.m_ReflectionPool,
+                  info.m_ShaderCache);
 
     shad.refl = reflData.refl;
     shad.mapping = &reflData.mapping;
@@ -1469,7 +1471,8 @@ void VulkanCreationInfo::Pipeline::Init(VulkanResourceManager *resourceMan, Vulk
     ShaderModuleReflection &reflData = info.m_ShaderModule[shadid].m_Reflections[key];
 
     reflData.Init(resourceMan, shadid, info.m_ShaderModule[shadid].spirv, shad.entryPoint,
-                  pCreateInfo->stage.stage, shad.specialization);
+                  pCreateInfo->stage.stage, shad.specialization, info.m_ReflectionPool,
+                  info.m_ShaderCache);
 
     shad.refl = reflData.refl;
     shad.mapping = &reflData.mapping;
@@ -2244,17 +2247,49 @@ void VulkanCreationInfo::ShaderModuleReflection::Init(VulkanResourceManager *res
                                                       ResourceId id, const rdcspv::Reflector &spv,
                                                       const rdcstr &entry,
                                                       VkShaderStageFlagBits stage,
-                                                      const rdcarray<SpecConstant> &specInfo)
+                                                      const rdcarray<SpecConstant> &specInfo,
+                                                      Threading::WorkerPool *pool,
+                                                      VulkanShaderCache *cache)
 {
   if(entryPoint.empty())
   {
     entryPoint = entry;
     stageIndex = StageIndex(stage);
 
-    spv.MakeReflection(GraphicsAPI::Vulkan, ShaderStage(stageIndex), entryPoint, specInfo, *refl,
-                       mapping, patchData);
+    ResourceId origId = resourceMan->GetOriginalID(id);
 
-    refl->resourceId = resourceMan->GetOriginalID(id);
+    auto reflect = [this, &spv, specInfo, origId, cache]() {
+      ShaderCacheHash128 hash;
+
+      if(cache)
+      {
+        hash = cache->GetReflectionHash(spv, entryPoint, ShaderStage(stageIndex), specInfo);
+
+        if(cache->GetCachedReflection(hash, *refl, mapping, patchData))
+        {
+          // the cache doesn't store the SPIR-V, we have it here already
+          const rdcarray<uint32_t> &spirv = spv.GetSPIRV();
+          refl->rawBytes.assign((const byte *)spirv.data(), spirv.size() * sizeof(uint32_t));
+          refl->resourceId = origId;
+          return;
+        }
+      }
+
+      spv.MakeReflection(GraphicsAPI::Vulkan, ShaderStage(stageIndex), entryPoint, specInfo,
+                         *refl, mapping, patchData);
+
+      if(cache)
+        cache->SetCachedReflection(hash, *refl, mapping, patchData);
+
+      refl->resourceId = origId;
+    };
+
+    // while loading, reflect in the background. Nothing looks at the reflection until the pool is
+    // finished before the frame is replayed, and each reflection is only written by its own job
+    if(pool)
+      pool->AddJob(reflect);
+    else
+      reflect();
   }
 }
 
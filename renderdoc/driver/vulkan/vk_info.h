@@ -30,6 +30,7 @@
 #include "vk_manager.h"
 
 struct VulkanCreationInfo;
+class VulkanShaderCache;
 
 // linearised version of VkDynamicState
 enum VulkanDynamicStateIndex
@@ -285,7 +286,8 @@ struct VulkanCreationInfo
 
     void Init(VulkanResourceManager *resourceMan, ResourceId id, const rdcspv::Reflector &spv,
               const rdcstr &entry, VkShaderStageFlagBits stage,
-              const rdcarray<SpecConstant> &specInfo);
+              const rdcarray<SpecConstant> &specInfo, Threading::WorkerPool *pool = NULL,
+              VulkanShaderCache *cache = NULL);
 
     void PopulateDisassembly(const rdcspv::Reflector &spirv);
   };
@@ -753,6 +755,11 @@ struct VulkanCreationInfo
   };
   std::unordered_map<ResourceId, ShaderModule> m_ShaderModule;
 
+  // set while loading, so that shader reflection for pipelines can happen in the background
+  Threading::WorkerPool *m_ReflectionPool = NULL;
+  // used to look up and store reflection persistently when replaying
+  VulkanShaderCache *m_ShaderCache = NULL;
+
   struct DescSetPool
   {
     void Init(VulkanResourceManager *resourceMan, VulkanCreationInfo &info,
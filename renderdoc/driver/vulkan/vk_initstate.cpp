@@ -23,11 +23,35 @@
  ******************************************************************************/
 
 #include "core/settings.h"
+#include "md5/md5.h"
 #include "vk_core.h"
 #include "vk_debug.h"
 
 RDOC_EXTERN_CONFIG(bool, Vulkan_Debug_SingleSubmitFlushing);
 
+RDOC_CONFIG(bool, Vulkan_CompactConstantInitialContents, true,
+            "Store tiles of memory and image initial contents that consist of one repeated value "
+            "as only that value, instead of serialising the full data.");
+
+RDOC_CONFIG(bool, Vulkan_DeduplicateInitialContents, true,
+            "Store memory and image initial contents that are identical to ones already stored in "
+            "the capture as a reference to the earlier copy.");
+
+RDOC_CONFIG(bool, Vulkan_HostInitialContents, false,
+            "Keep all initial contents in host memory on replay, including MSAA images, and read "
+            "them from there when resetting. This is enabled automatically for captures that "
+            "exceed the replay device-local memory budget.");
+
+bool WrappedVulkan::UseHostInitialContents()
+{
+  if(Vulkan_HostInitialContents())
+    return true;
+
+  // the capture's own allocations are all created before initial contents are loaded, so if
+  // they're already over budget avoid adding more to device memory
+  return m_ReplayDeviceLocalBudget > 0 && m_ReplayDeviceLocalBytes > m_ReplayDeviceLocalBudget;
+}
+
 // VKTODOLOW there's a lot of duplicated code in this file for creating a buffer to do
 // a memory copy and saving to disk.
 
@@ -38,6 +62,24 @@ RDOC_EXTERN_CONFIG(bool, Vulkan_Debug_SingleSubmitFlushing);
 // command buffer that stalls the GPU).
 // See INITSTATEBATCH
 
+static rdcpair<uint64_t, uint64_t> HashInitialContents(const byte *data, uint64_t size)
+{
+  MD5_CTX md5ctx = {};
+  MD5_Init(&md5ctx);
+
+  MD5_Update(&md5ctx, &size, sizeof(size));
+
+  // MD5_Update takes an unsigned long length which is only 32-bit on some platforms
+  const uint64_t pieceSize = 256 * 1024 * 1024;
+  for(uint64_t offs = 0; offs < size; offs += pieceSize)
+    MD5_Update(&md5ctx, data + offs, (unsigned long)RDCMIN(pieceSize, size - offs));
+
+  uint64_t digest[2] = {};
+  MD5_Final((unsigned char *)digest, &md5ctx);
+
+  return {digest[0], digest[1]};
+}
+
 template <typename SerialiserType>
 void DoSerialise(SerialiserType &ser, AspectSparseTable &el)
 {
@@ -280,6 +322,76 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
       DoPipelineBarrier(cmd, 1, &bufBarrier);
     }
 
+    // for sparse images only the regions with memory bound are copied, so the amount of data read
+    // back scales with what's resident. The rest of the buffer is cleared first so that unbound
+    // regions are deterministic and compress away to almost nothing in the capture.
+    const bool sparseCopy = resInfo.IsSparse() && planeCount == 1 && !wasms;
+    rdcarray<VkBufferImageCopy> sparseRegions;
+
+    if(sparseCopy)
+    {
+      ObjDisp(d)->CmdFillBuffer(Unwrap(cmd), Unwrap(dstBuf), 0, VK_WHOLE_SIZE, 0);
+
+      VkBufferMemoryBarrier fillBarrier = {
+          VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+          NULL,
+          VK_ACCESS_TRANSFER_WRITE_BIT,
+          VK_ACCESS_TRANSFER_WRITE_BIT,
+          VK_QUEUE_FAMILY_IGNORED,
+          VK_QUEUE_FAMILY_IGNORED,
+          Unwrap(dstBuf),
+          0,
+          bufInfo.size,
+      };
+
+      DoPipelineBarrier(cmd, 1, &fillBarrier);
+    }
+
+    auto copySubresource = [&](const VkBufferImageCopy &region, VkFormat copyFormat) {
+      if(!sparseCopy)
+      {
+        ObjDisp(d)->CmdCopyImageToBuffer(Unwrap(cmd), realim, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                         Unwrap(dstBuf), 1, &region);
+        return;
+      }
+
+      const VkImageSubresourceLayers &sub = region.imageSubresource;
+      const Sparse::PageTable &table = resInfo.getSparseTableForAspect(sub.aspectMask);
+
+      const rdcarray<Sparse::Box> boxes =
+          table.getMappedBoxes(table.calcSubresource(sub.baseArrayLayer, sub.mipLevel));
+
+      const VkExtent3D &mipExtent = region.imageExtent;
+      const VkDeviceSize sliceBytes =
+          GetByteSize(mipExtent.width, mipExtent.height, 1, copyFormat, 0);
+
+      sparseRegions.clear();
+      for(const Sparse::Box &box : boxes)
+      {
+        // the buffer keeps the same tightly packed layout as a full copy, each box lands at the
+        // same place it would have been
+        VkBufferImageCopy boxRegion = region;
+        boxRegion.bufferRowLength = mipExtent.width;
+        boxRegion.bufferImageHeight = mipExtent.height;
+        boxRegion.imageOffset = {(int32_t)box.offset.x, (int32_t)box.offset.y,
+                                 (int32_t)box.offset.z};
+        boxRegion.imageExtent = {box.extent.x, box.extent.y, box.extent.z};
+
+        boxRegion.bufferOffset += box.offset.z * sliceBytes;
+        if(box.offset.y > 0)
+          boxRegion.bufferOffset += GetByteSize(mipExtent.width, box.offset.y, 1, copyFormat, 0);
+        if(box.offset.x > 0)
+          boxRegion.bufferOffset += GetByteSize(box.offset.x, 1, 1, copyFormat, 0);
+
+        sparseRegions.push_back(boxRegion);
+      }
+
+      if(!sparseRegions.empty())
+        ObjDisp(d)->CmdCopyImageToBuffer(Unwrap(cmd), realim, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                         Unwrap(dstBuf), (uint32_t)sparseRegions.size(),
+                                         sparseRegions.data());
+    };
+
     VkDeviceSize bufOffset = 0;
     const int numLayersToCopy = wasms ? 0 : numLayers;
 
@@ -339,8 +451,7 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
           bufOffset += GetByteSize(imageInfo.extent.width, imageInfo.extent.height,
                                    imageInfo.extent.depth, sizeFormat, m);
 
-          ObjDisp(d)->CmdCopyImageToBuffer(
-              Unwrap(cmd), realim, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Unwrap(dstBuf), 1, &region);
+          copySubresource(region, sizeFormat);
 
           if(aspectFlags == (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT))
           {
@@ -353,9 +464,7 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
             bufOffset += GetByteSize(imageInfo.extent.width, imageInfo.extent.height,
                                      imageInfo.extent.depth, VK_FORMAT_S8_UINT, m);
 
-            ObjDisp(d)->CmdCopyImageToBuffer(Unwrap(cmd), realim,
-                                             VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Unwrap(dstBuf),
-                                             1, &region);
+            copySubresource(region, VK_FORMAT_S8_UINT);
           }
         }
 
@@ -529,7 +638,12 @@ uint64_t WrappedVulkan::GetSize_InitialState(ResourceId id, const VkInitialConte
   else if(initial.type == eResImage || initial.type == eResDeviceMemory)
   {
     // the size primarily comes from the buffer, the size of which we conveniently have stored.
-    return ret + uint64_t(128 + initial.mem.size + WriteSerialiser::GetChunkAlignment());
+    // each run of non-constant data between constant tiles may need its own alignment padding
+    uint64_t numTiles = initial.mem.size / InitialContentsTileSize;
+    uint64_t tileOverhead =
+        sizeof(uint32_t) * 2 + sizeof(uint64_t) + WriteSerialiser::GetChunkAlignment();
+    return ret + uint64_t(128 + initial.mem.size + WriteSerialiser::GetChunkAlignment()) +
+           numTiles * tileOverhead;
   }
 
   RDCERR("Unhandled resource type %s", ToStr(initial.type).c_str());
@@ -955,6 +1069,53 @@ SparseBinding::SparseBinding(WrappedVulkan *vk, VkImage unwrappedImage,
   pImageBinds = &imgBind;
 }
 
+byte *WrappedVulkan::MapInitialContentsForWrite(const MemoryAllocation &mem)
+{
+  SCOPED_LOCK(m_InitialContentsWriteLock);
+
+  rdcpair<byte *, uint32_t> &mapping = m_InitialContentsWriteMaps[mem.mem];
+
+  if(mapping.second == 0)
+  {
+    VkDevice d = GetDev();
+
+    byte *ptr = NULL;
+    VkResult vkr =
+        ObjDisp(d)->MapMemory(Unwrap(d), Unwrap(mem.mem), 0, VK_WHOLE_SIZE, 0, (void **)&ptr);
+    CheckVkResult(vkr);
+
+    if(!ptr)
+    {
+      m_InitialContentsWriteMaps.erase(mem.mem);
+      return NULL;
+    }
+
+    mapping.first = ptr;
+  }
+
+  mapping.second++;
+
+  return mapping.first + mem.offs;
+}
+
+void WrappedVulkan::UnmapInitialContentsForWrite(const MemoryAllocation &mem)
+{
+  SCOPED_LOCK(m_InitialContentsWriteLock);
+
+  auto it = m_InitialContentsWriteMaps.find(mem.mem);
+  if(it == m_InitialContentsWriteMaps.end())
+    return;
+
+  it->second.second--;
+
+  if(it->second.second == 0)
+  {
+    VkDevice d = GetDev();
+    ObjDisp(d)->UnmapMemory(Unwrap(d), Unwrap(mem.mem));
+    m_InitialContentsWriteMaps.erase(it);
+  }
+}
+
 template <typename SerialiserType>
 bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id, VkResourceRecord *,
                                            const VkInitialContents *initial)
@@ -1303,6 +1464,11 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id, V
     MemoryAllocation uploadMemory;
     VkBuffer uploadBuf = VK_NULL_HANDLE;
 
+    bool hostMSAA = false;
+    if(IsReplayingAndReading() && type == eResImage && UseHostInitialContents())
+      hostMSAA = m_CreationInfo.m_Image[GetResourceManager()->GetLiveID(id)].samples !=
+                 VK_SAMPLE_COUNT_1_BIT;
+
     // during writing, we already have the memory copied off - we just need to map it.
     if(ser.IsWriting())
     {
@@ -1311,9 +1477,7 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id, V
         VkDeviceSize size = AlignUp(initial->mem.size, nonCoherentAtomSize);
 
         mappedMem = initial->mem;
-        vkr = ObjDisp(d)->MapMemory(Unwrap(d), Unwrap(mappedMem.mem), initial->mem.offs, size, 0,
-                                    (void **)&Contents);
-        CheckVkResult(vkr);
+        Contents = MapInitialContentsForWrite(mappedMem);
 
         // invalidate the cpu cache for this memory range to avoid reading stale data
         VkMappedMemoryRange range = {
@@ -1335,6 +1499,11 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id, V
           VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO, NULL, 0, ContentsSize,
           VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT};
 
+      // MSAA images are reset by a shader reading this buffer directly when it stays in host
+      // memory, instead of from a GPU-local copy
+      if(hostMSAA)
+        bufInfo.usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+
       vkr = vkCreateBuffer(d, &bufInfo, NULL, &uploadBuf);
       CheckVkResult(vkr);
 
@@ -1365,9 +1534,105 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id, V
         return false;
     }
 
+    // contents identical to those of a resource serialised earlier in the capture aren't stored
+    // again, on replay they're copied from that resource's initial contents.
+    ResourceId DuplicateOf;
+
+    if(ser.IsWriting() && Contents && Vulkan_DeduplicateInitialContents() &&
+       ContentsSize >= InitialContentsTileSize)
+    {
+      rdcpair<uint64_t, uint64_t> hash = HashInitialContents(Contents, ContentsSize);
+
+      // initial states may be serialised in parallel, so only reference a resource whose chunk is
+      // written before this one. Otherwise this one becomes the copy that later ones reference.
+      VulkanResourceManager *rm = GetResourceManager();
+
+      SCOPED_LOCK(m_InitialContentsWriteLock);
+
+      auto it = m_InitialContentsHashes.find(hash);
+      if(it != m_InitialContentsHashes.end() &&
+         rm->GetInitialContentsChunkOrder(it->second) <= rm->GetInitialContentsChunkOrder(id))
+        DuplicateOf = it->second;
+      else
+        m_InitialContentsHashes[hash] = id;
+    }
+
+    if(ser.VersionAtLeast(0x17))
+    {
+      SERIALISE_ELEMENT(DuplicateOf).Hidden();
+    }
+
+    // tiles that are a single repeated value (most commonly cleared or never-written memory) only
+    // store the value, and only the remaining runs of data are serialised.
+    uint64_t TileSize = InitialContentsTileSize;
+    rdcarray<uint32_t> ConstantTiles;
+    rdcarray<uint32_t> ConstantTileValues;
+
+    if(ser.IsWriting() && DuplicateOf == ResourceId() && Vulkan_CompactConstantInitialContents())
+      FindConstantTiles(Contents, ContentsSize, TileSize, ConstantTiles, ConstantTileValues);
+
+    if(ser.VersionAtLeast(0x16))
+    {
+      SERIALISE_ELEMENT(TileSize).Hidden();
+      SERIALISE_ELEMENT(ConstantTiles).Hidden();
+      SERIALISE_ELEMENT(ConstantTileValues).Hidden();
+    }
+
+    if(ser.IsReading() && !ser.IsErrored() && !ConstantTiles.empty())
+    {
+      bool valid = ConstantTiles.size() == ConstantTileValues.size() && TileSize > 0 &&
+                   (TileSize % sizeof(uint32_t)) == 0;
+
+      for(size_t i = 0; valid && i < ConstantTiles.size(); i++)
+      {
+        if(i > 0 && ConstantTiles[i] <= ConstantTiles[i - 1])
+          valid = false;
+        if((uint64_t(ConstantTiles[i]) + 1) * TileSize > ContentsSize)
+          valid = false;
+      }
+
+      if(!valid)
+      {
+        RDResult res;
+        SET_ERROR_RESULT(res, ResultCode::FileCorrupted,
+                         "Invalid constant tiles in initial contents for %s", ToStr(id).c_str());
+        ser.SetError(res);
+      }
+    }
+
     // not using SERIALISE_ELEMENT_ARRAY so we can deliberately avoid allocation - we serialise
     // directly into upload memory
-    ser.Serialise("Contents"_lit, Contents, ContentsSize, SerialiserFlags::NoFlags).Important();
+    if(DuplicateOf != ResourceId())
+    {
+      // nothing to serialise, the data is copied below once the upload buffer is ready
+    }
+    else if(ConstantTiles.empty())
+    {
+      ser.Serialise("Contents"_lit, Contents, ContentsSize, SerialiserFlags::NoFlags).Important();
+    }
+    else
+    {
+      uint64_t offs = 0;
+
+      for(size_t i = 0; i <= ConstantTiles.size() && !ser.IsErrored(); i++)
+      {
+        uint64_t runEnd = i < ConstantTiles.size() ? ConstantTiles[i] * TileSize : ContentsSize;
+
+        if(runEnd > offs)
+        {
+          byte *run = Contents ? Contents + offs : NULL;
+          ser.Serialise("Contents"_lit, run, runEnd - offs, SerialiserFlags::NoFlags).Important();
+        }
+
+        if(i < ConstantTiles.size())
+        {
+          if(ser.IsReading() && Contents)
+            FillConstantTile(Contents + runEnd, TileSize, ConstantTileValues[i]);
+
+          offs = runEnd + TileSize;
+        }
+      }
+    }
 
     // unmap the resource we mapped before - we need to do this on read and on write.
     if(!IsStructuredExporting(m_State) && mappedMem.mem != VK_NULL_HANDLE)
@@ -1385,9 +1650,17 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id, V
 
         vkr = ObjDisp(d)->FlushMappedMemoryRanges(Unwrap(d), 1, &range);
         CheckVkResult(vkr);
-      }
 
-      ObjDisp(d)->UnmapMemory(Unwrap(d), Unwrap(mappedMem.mem));
+        ObjDisp(d)->UnmapMemory(Unwrap(d), Unwrap(mappedMem.mem));
+      }
+      else if(ser.IsWriting())
+      {
+        UnmapInitialContentsForWrite(mappedMem);
+      }
+      else
+      {
+        ObjDisp(d)->UnmapMemory(Unwrap(d), Unwrap(mappedMem.mem));
+      }
     }
 
     SERIALISE_CHECK_READ_ERRORS();
@@ -1398,6 +1671,55 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id, V
     {
       ResourceId liveid = GetResourceManager()->GetLiveID(id);
 
+      if(DuplicateOf != ResourceId())
+      {
+        // the earlier resource's buffer always holds the contents as serialised, even if it has
+        // since been copied to a GPU-local buffer
+        VkInitialContents dupContents = GetResourceManager()->GetInitialContents(DuplicateOf);
+
+        if(dupContents.buf == VK_NULL_HANDLE || dupContents.mem.size < ContentsSize)
+        {
+          RDCERR("Initial contents of %s duplicate those of %s which weren't loaded",
+                 ToStr(id).c_str(), ToStr(DuplicateOf).c_str());
+        }
+        else
+        {
+          VkCommandBuffer cmd = GetNextCmd();
+
+          if(cmd == VK_NULL_HANDLE)
+            return false;
+
+          VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                                VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+          vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+          CheckVkResult(vkr);
+
+          VkBufferCopy bufCopy = {0, 0, ContentsSize};
+          ObjDisp(cmd)->CmdCopyBuffer(Unwrap(cmd), Unwrap(dupContents.buf), Unwrap(uploadBuf), 1,
+                                      &bufCopy);
+
+          VkBufferMemoryBarrier bufBarrier = {
+              VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+              NULL,
+              VK_ACCESS_TRANSFER_WRITE_BIT,
+              VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT,
+              VK_QUEUE_FAMILY_IGNORED,
+              VK_QUEUE_FAMILY_IGNORED,
+              Unwrap(uploadBuf),
+              0,
+              VK_WHOLE_SIZE,
+          };
+          DoPipelineBarrier(cmd, 1, &bufBarrier);
+
+          vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
+          CheckVkResult(vkr);
+
+          SubmitCmds();
+          FlushQ();
+        }
+      }
+
       if(type == eResDeviceMemory)
       {
         VkInitialContents initialContents(type, uploadMemory);
@@ -1427,8 +1749,9 @@ bool WrappedVulkan::Serialise_InitialState(SerialiserType &ser, ResourceId id, V
         VulkanCreationInfo::Image &c = m_CreationInfo.m_Image[liveid];
 
         // for non-MSAA images, we're done - we'll do buffer-to-image copies with appropriate
-        // offsets to copy out the subresources into the image itself.
-        if(c.samples == VK_SAMPLE_COUNT_1_BIT)
+        // offsets to copy out the subresources into the image itself. The same goes for MSAA
+        // images when initial contents are kept in host memory.
+        if(c.samples == VK_SAMPLE_COUNT_1_BIT || hostMSAA)
         {
           initialContents.buf = uploadBuf;
         }
@@ -1714,6 +2037,10 @@ void WrappedVulkan::Apply_InitialState(WrappedVkRes *live, const VkInitialConten
       }
     }
 
+    // nothing replayed since the last reset has written this image yet
+    if(initialized && !WrittenSinceReset(id))
+      return;
+
     // handle any 'created' initial states, without an actual image with contents
     if(initial.tag != VkInitialContents::BufferCopy)
     {
@@ -2086,6 +2413,13 @@ void WrappedVulkan::Apply_InitialState(WrappedVkRes *live, const VkInitialConten
     {
       bool initialized = memRefs->initializedLiveRes == live;
       memRefs->initializedLiveRes = live;
+
+      if(initialized && !WrittenSinceReset(id))
+      {
+        RDCDEBUG("Apply_InitialState (Mem %s): not written since last reset", ToStr(orig).c_str());
+        return;
+      }
+
       InitPolicy policy = GetResourceManager()->GetInitPolicy();
       for(auto it = memRefs->rangeRefs.begin(); it != memRefs->rangeRefs.end(); it++)
       {
@@ -28,6 +28,7 @@
 #include "api/replay/version.h"
 #include "common/common.h"
 #include "common/threading.h"
+#include "core/api_overhead.h"
 #include "hooks/hooks.h"
 #include "os/os_specific.h"
 #include "strings/string_utils.h"
@@ -189,43 +190,54 @@ VulkanHook VulkanHook::vkhooks;
 // RenderDoc Intercepts, these must all be entry points with a dispatchable object
 // as the first parameter
 
-#define HookDefine1(ret, function, t1, p1) \
-  VKAPI_ATTR ret VKAPI_CALL CONCAT(hooked_, function)(t1 p1) { return CoreDisp(p1)->function(p1); }
+#define HookDefine1(ret, function, t1, p1)                   \
+  VKAPI_ATTR ret VKAPI_CALL CONCAT(hooked_, function)(t1 p1) \
+  {                                                          \
+    SCOPED_API_OVERHEAD(STRINGIZE(function));                \
+    return CoreDisp(p1)->function(p1);                       \
+  }
 #define HookDefine2(ret, function, t1, p1, t2, p2)                  \
   VKAPI_ATTR ret VKAPI_CALL CONCAT(hooked_, function)(t1 p1, t2 p2) \
   {                                                                 \
+    SCOPED_API_OVERHEAD(STRINGIZE(function));                       \
     return CoreDisp(p1)->function(p1, p2);                          \
   }
 #define HookDefine3(ret, function, t1, p1, t2, p2, t3, p3)                 \
   VKAPI_ATTR ret VKAPI_CALL CONCAT(hooked_, function)(t1 p1, t2 p2, t3 p3) \
   {                                                                        \
+    SCOPED_API_OVERHEAD(STRINGIZE(function));                              \
     return CoreDisp(p1)->function(p1, p2, p3);                             \
   }
 #define HookDefine4(ret, function, t1, p1, t2, p2, t3, p3, t4, p4)                \
   VKAPI_ATTR ret VKAPI_CALL CONCAT(hooked_, function)(t1 p1, t2 p2, t3 p3, t4 p4) \
   {                                                                               \
+    SCOPED_API_OVERHEAD(STRINGIZE(function));                                     \
     return CoreDisp(p1)->function(p1, p2, p3, p4);                                \
   }
 #define HookDefine5(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5)               \
   VKAPI_ATTR ret VKAPI_CALL CONCAT(hooked_, function)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5) \
   {                                                                                      \
+    SCOPED_API_OVERHEAD(STRINGIZE(function));                                            \
     return CoreDisp(p1)->function(p1, p2, p3, p4, p5);                                   \
   }
 #define HookDefine6(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6)              \
   VKAPI_ATTR ret VKAPI_CALL CONCAT(hooked_, function)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6) \
   {                                                                                             \
+    SCOPED_API_OVERHEAD(STRINGIZE(function));                                                   \
     return CoreDisp(p1)->function(p1, p2, p3, p4, p5, p6);                                      \
   }
 #define HookDefine7(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7)      \
   VKAPI_ATTR ret VKAPI_CALL CONCAT(hooked_, function)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, \
                                                       t7 p7)                                    \
   {                                                                                             \
+    SCOPED_API_OVERHEAD(STRINGIZE(function));                                                   \
     return CoreDisp(p1)->function(p1, p2, p3, p4, p5, p6, p7);                                  \
   }
 #define HookDefine8(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7, t8, p8) \
   VKAPI_ATTR ret VKAPI_CALL CONCAT(hooked_, function)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6,    \
                                                       t7 p7, t8 p8)                                \
   {                                                                                                \
+    SCOPED_API_OVERHEAD(STRINGIZE(function));                                                      \
     return CoreDisp(p1)->function(p1, p2, p3, p4, p5, p6, p7, p8);                                 \
   }
 #define HookDefine9(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7, t8, p8, \
@@ -233,6 +245,7 @@ VulkanHook VulkanHook::vkhooks;
   VKAPI_ATTR ret VKAPI_CALL CONCAT(hooked_, function)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6,    \
                                                       t7 p7, t8 p8, t9, p9)                        \
   {                                                                                                \
+    SCOPED_API_OVERHEAD(STRINGIZE(function));                                                      \
     return CoreDisp(p1)->function(p1, p2, p3, p4, p5, p6, p7, p8, p9);                             \
   }
 #define HookDefine10(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7, t8, \
@@ -240,6 +253,7 @@ VulkanHook VulkanHook::vkhooks;
   VKAPI_ATTR ret VKAPI_CALL CONCAT(hooked_, function)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, \
                                                       t7 p7, t8 p8, t9 p9, t10 p10)             \
   {                                                                                             \
+    SCOPED_API_OVERHEAD(STRINGIZE(function));                                                   \
     return CoreDisp(p1)->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10);                     \
   }
 #define HookDefine11(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7, t8, \
@@ -247,6 +261,7 @@ VulkanHook VulkanHook::vkhooks;
   VKAPI_ATTR ret VKAPI_CALL CONCAT(hooked_, function)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, \
                                                       t7 p7, t8 p8, t9 p9, t10 p10, t11 p11)    \
   {                                                                                             \
+    SCOPED_API_OVERHEAD(STRINGIZE(function));                                                   \
     return CoreDisp(p1)->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11);                \
   }
 
@@ -364,17 +364,16 @@ void VulkanResourceManager::SerialiseImageStates(SerialiserType &ser,
         if(IsReplayingAndReading() && hasLiveRes)
         {
           imageState.newQueueFamilyTransfers.clear();
-          for(auto it = imageState.subresourceStates.begin();
-              it != imageState.subresourceStates.end(); ++it)
-          {
+          VkImageLayout initialLayout = imageState.GetImageInfo().initialLayout;
+          imageState.subresourceStates.TransformStates([&](ImageSubresourceState state) {
             // Set the current image state (`newLayout`, `newQueueFamilyIndex`, `refType`) to the
             // initial image state, so that calling `ResetToOldState` will move the image from the
             // initial state to the state it was in at the beginning of the capture.
-            ImageSubresourceState &state = it->state();
-            state.newLayout = imageState.GetImageInfo().initialLayout;
+            state.newLayout = initialLayout;
             state.oldQueueFamilyIndex = m_Core->RemapQueue(state.oldQueueFamilyIndex);
             state.newQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-          }
+            return state;
+          });
         }
       }
       if(hasLiveRes)
@@ -1042,3 +1041,20 @@ bool VulkanResourceManager::IsResourceTrackedForPersistency(WrappedVkRes *const
 {
   return IsPostponableRes(res);
 }
+
+bool VulkanResourceManager::IsResourceTrackedForPreSnapshot(WrappedVkRes *const &res)
+{
+  if(!IsPostponableRes(res))
+    return false;
+
+  // host writes to mapped memory aren't seen until it's unmapped or flushed, so we can't trust a
+  // snapshot of memory that is currently mapped
+  if(WrappedVkDeviceMemory::IsAlloc(res))
+  {
+    VkResourceRecord *record = ((WrappedVkNonDispRes *)res)->record;
+    if(record->memMapState && record->memMapState->mappedPtr)
+      return false;
+  }
+
+  return true;
+}
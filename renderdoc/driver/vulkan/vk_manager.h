@@ -447,6 +447,7 @@ public:
   }
 
   bool IsResourceTrackedForPersistency(WrappedVkRes *const &res);
+  bool IsResourceTrackedForPreSnapshot(WrappedVkRes *const &res);
 
 private:
   bool ResourceTypeRelease(WrappedVkRes *res);
@@ -455,6 +456,7 @@ private:
   uint64_t GetSize_InitialState(ResourceId id, const VkInitialContents &initial);
   bool Serialise_InitialState(WriteSerialiser &ser, ResourceId id, VkResourceRecord *record,
                               const VkInitialContents *initial);
+  bool IsSerialiseInitialStateThreadSafe() { return true; }
   void Create_InitialState(ResourceId id, WrappedVkRes *live, bool hasData);
   void Apply_InitialState(WrappedVkRes *live, const VkInitialContents &initial);
   rdcarray<ResourceId> InitialContentResources();
@@ -22,12 +22,18 @@
  * THE SOFTWARE.
  ******************************************************************************/
 
+#include "core/memory_accounting.h"
 #include "core/settings.h"
 #include "vk_core.h"
 
 RDOC_CONFIG(bool, Vulkan_Debug_MemoryAllocationLogging, false,
             "Output verbose debug logging messages when allocating internal memory.");
 
+RDOC_CONFIG(uint32_t, Vulkan_ReplayMemoryBudgetMB, 0,
+            "The amount of device-local memory in MB that replay tries to stay within. Internal "
+            "buffers that would exceed it are placed in host-visible memory instead. If set to 0 "
+            "the size of the largest device-local heap is used.");
+
 void WrappedVulkan::ChooseMemoryIndices()
 {
   // we need to do this little dance because Get*MemoryIndex checks to see if the existing
@@ -72,6 +78,93 @@ void WrappedVulkan::ChooseMemoryIndices()
   }
 }
 
+void WrappedVulkan::ChooseReplayMemoryBudget()
+{
+  m_ReplayDeviceLocalBytes = 0;
+  m_ReplayDeviceLocalBudget = VkDeviceSize(Vulkan_ReplayMemoryBudgetMB()) * 1024 * 1024;
+
+  if(m_ReplayDeviceLocalBudget == 0)
+  {
+    for(uint32_t h = 0; h < m_PhysicalDeviceData.memProps.memoryHeapCount; h++)
+    {
+      const VkMemoryHeap &heap = m_PhysicalDeviceData.memProps.memoryHeaps[h];
+      if(heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+        m_ReplayDeviceLocalBudget = RDCMAX(m_ReplayDeviceLocalBudget, heap.size);
+    }
+  }
+
+  RDCLOG("Replay device-local memory budget is %llu MB%s",
+         m_ReplayDeviceLocalBudget / (1024 * 1024),
+         m_PageableDeviceMemory ? ", allocations are pageable" : "");
+}
+
+bool WrappedVulkan::IsDeviceLocalMemoryType(uint32_t memoryTypeIndex)
+{
+  if(memoryTypeIndex >= m_PhysicalDeviceData.memProps.memoryTypeCount)
+    return false;
+
+  return (m_PhysicalDeviceData.memProps.memoryTypes[memoryTypeIndex].propertyFlags &
+          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0;
+}
+
+void WrappedVulkan::UpdateReplayMemoryPriorities()
+{
+  // nothing to do unless the driver can page memory and we're actually oversubscribed
+  if(!m_PageableDeviceMemory || m_ReplayDeviceLocalBytes <= m_ReplayDeviceLocalBudget)
+    return;
+
+  VkDevice d = GetDev();
+
+  uint32_t count = 0;
+  VkDeviceSize size = 0;
+
+  for(auto it = m_CreationInfo.m_Memory.begin(); it != m_CreationInfo.m_Memory.end(); ++it)
+  {
+    if(!IsDeviceLocalMemoryType(it->second.memoryTypeIndex))
+      continue;
+
+    ResourceId live = it->first;
+
+    bool used = !m_ResourceUses[live].empty();
+
+    // memory is in use if any resource bound to it is used in the frame. Buffers with a device
+    // address may be accessed without any tracked usage, so they always count as used.
+    const ResourceDescription &desc = GetResourceDesc(GetResourceManager()->GetOriginalID(live));
+    for(size_t i = 0; !used && i < desc.derivedResources.size(); i++)
+    {
+      ResourceId origDerived = desc.derivedResources[i];
+
+      if(!GetResourceManager()->HasLiveResource(origDerived))
+        continue;
+
+      ResourceId derived = GetResourceManager()->GetLiveID(origDerived);
+
+      auto buf = m_CreationInfo.m_Buffer.find(derived);
+      if(buf != m_CreationInfo.m_Buffer.end() && buf->second.gpuAddress != 0)
+        used = true;
+
+      auto uses = m_ResourceUses.find(derived);
+      if(uses != m_ResourceUses.end() && !uses->second.empty())
+        used = true;
+    }
+
+    if(used)
+      continue;
+
+    // let the driver page out memory the frame never touches before anything it does
+    VkDeviceMemory mem = GetResourceManager()->GetCurrentHandle<VkDeviceMemory>(live);
+    ObjDisp(d)->SetDeviceMemoryPriorityEXT(Unwrap(d), Unwrap(mem), 0.0f);
+
+    count++;
+    size += it->second.allocSize;
+  }
+
+  RDCLOG("Capture uses %llu MB of device-local memory over a %llu MB budget. Lowered priority of "
+         "%u allocations (%llu MB) unused in the frame",
+         m_ReplayDeviceLocalBytes / (1024 * 1024), m_ReplayDeviceLocalBudget / (1024 * 1024), count,
+         size / (1024 * 1024));
+}
+
 uint32_t WrappedVulkan::GetReadbackMemoryIndex(uint32_t resourceCompatibleBitmask)
 {
   if(m_PhysicalDeviceData.readbackMemIndex < 32 &&
@@ -99,6 +192,26 @@ uint32_t WrappedVulkan::GetUploadMemoryIndex(uint32_t resourceCompatibleBitmask)
                                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, 0);
 }
 
+uint32_t WrappedVulkan::GetHostMemoryIndex(uint32_t resourceCompatibleBitmask)
+{
+  // the upload index only requires host visible, which may be device-local memory mapped through
+  // the BAR. Look for host visible memory that lives in system memory instead.
+  for(uint32_t memIndex = 0; memIndex < m_PhysicalDeviceData.memProps.memoryTypeCount; memIndex++)
+  {
+    if((resourceCompatibleBitmask & (1 << memIndex)) == 0)
+      continue;
+
+    uint32_t memTypeFlags = m_PhysicalDeviceData.memProps.memoryTypes[memIndex].propertyFlags;
+
+    if((memTypeFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) &&
+       (memTypeFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) == 0)
+      return memIndex;
+  }
+
+  // on UMA systems everything is device local, so any upload memory is fine
+  return GetUploadMemoryIndex(resourceCompatibleBitmask);
+}
+
 uint32_t WrappedVulkan::GetGPULocalMemoryIndex(uint32_t resourceCompatibleBitmask)
 {
   if(m_PhysicalDeviceData.GPULocalMemIndex < 32 &&
@@ -157,6 +270,12 @@ uint32_t WrappedVulkan::PhysicalDeviceData::GetMemoryIndex(uint32_t resourceComp
   return best;
 }
 
+static MemoryCategory GetMemoryCategory(MemoryScope scope)
+{
+  return scope == MemoryScope::IndirectReadback ? MemoryCategory::GPUIndirectReadback
+                                                : MemoryCategory::GPUInitialContents;
+}
+
 MemoryAllocation WrappedVulkan::AllocateMemoryForResource(bool buffer, VkMemoryRequirements mrq,
                                                           MemoryScope scope, MemoryType type)
 {
@@ -166,10 +285,24 @@ MemoryAllocation WrappedVulkan::AllocateMemoryForResource(bool buffer, VkMemoryR
   ret.scope = scope;
   ret.type = type;
   ret.buffer = buffer;
-  ret.size = AlignUp(mrq.size, mrq.alignment);
   // for ease, ensure all allocations are multiples of the non-coherent atom size, so we can
-  // invalidate/flush safely. This is at most 256 bytes which is likely already satisfied.
-  ret.size = AlignUp(ret.size, nonCoherentAtomSize);
+  // invalidate/flush safely. This is at most 256 bytes which is likely already satisfied. The size
+  // must be recomputable from the requested size alone so that the same range is freed later.
+  ret.size = PaddedAllocationSize(mrq.size);
+
+  // once the device-local budget is used up, put internal buffers in host-visible memory so the
+  // capture's own resources keep the device memory. Images might not support any host-visible
+  // memory type so they are always allocated as requested.
+  if(ret.type == MemoryType::GPULocal && buffer && m_ReplayDeviceLocalBudget > 0 &&
+     m_ReplayDeviceLocalBytes + ret.size > m_ReplayDeviceLocalBudget)
+  {
+    if(Vulkan_Debug_MemoryAllocationLogging())
+    {
+      RDCLOG("Device-local budget exceeded, allocating buffer in upload memory instead");
+    }
+
+    ret.type = MemoryType::Upload;
+  }
 
   if(Vulkan_Debug_MemoryAllocationLogging())
   {
@@ -178,19 +311,23 @@ MemoryAllocation WrappedVulkan::AllocateMemoryForResource(bool buffer, VkMemoryR
            ToStr(type).c_str(), ToStr(scope).c_str());
   }
 
-  rdcarray<MemoryAllocation> &blockList = m_MemoryBlocks[(size_t)scope];
+  rdcarray<MemoryBlock> &blockList = m_MemoryBlocks[(size_t)scope];
+
+  const VkDeviceSize granularity = m_PhysicalDeviceData.props.limits.bufferImageGranularity;
 
   // first try to find a match
   int i = 0;
-  for(MemoryAllocation &block : blockList)
+  for(MemoryBlock &b : blockList)
   {
+    MemoryAllocation &block = b.base;
+
     if(Vulkan_Debug_MemoryAllocationLogging())
     {
       RDCLOG(
           "Considering block %d: memory type %u and type %s. Total size 0x%llx, current offset "
-          "0x%llx, last alloc was %s",
+          "0x%llx, %zu free ranges, last alloc was %s",
           i, block.memoryTypeIndex, ToStr(block.type).c_str(), block.size, block.offs,
-          block.buffer ? "buffer" : "image");
+          b.freeRanges.size(), block.buffer ? "buffer" : "image");
     }
     i++;
 
@@ -204,6 +341,45 @@ MemoryAllocation WrappedVulkan::AllocateMemoryForResource(bool buffer, VkMemoryR
       continue;
     }
 
+    // try to re-use a freed range first. We don't know whether buffers or images are either side
+    // of it, so stay out of the bufferImageGranularity pages at each end that the neighbours touch.
+    for(size_t r = 0; r < b.freeRanges.size(); r++)
+    {
+      const VkDeviceSize rangeStart = b.freeRanges[r].first;
+      const VkDeviceSize rangeEnd = rangeStart + b.freeRanges[r].second;
+
+      VkDeviceSize offs = AlignUp(rangeStart, nonCoherentAtomSize);
+      offs = AlignUp(offs, granularity);
+      offs = AlignUp(offs, mrq.alignment);
+
+      if(offs + ret.size > rangeEnd - (rangeEnd % granularity))
+        continue;
+
+      if(Vulkan_Debug_MemoryAllocationLogging())
+      {
+        RDCLOG("Re-using free range 0x%llx -> 0x%llx at 0x%llx", rangeStart, rangeEnd, offs);
+      }
+
+      // split whatever is left over either side back into free ranges
+      const VkDeviceSize allocEnd = offs + ret.size;
+      if(allocEnd < rangeEnd)
+        b.freeRanges.insert(r + 1, {allocEnd, rangeEnd - allocEnd});
+      if(offs > rangeStart)
+        b.freeRanges[r].second = offs - rangeStart;
+      else
+        b.freeRanges.erase(r);
+
+      ret.offs = offs;
+      ret.mem = block.mem;
+      break;
+    }
+
+    if(ret.mem != VK_NULL_HANDLE)
+    {
+      b.liveAllocations++;
+      break;
+    }
+
     // offs is where we can put our next sub-allocation
     VkDeviceSize offs = block.offs;
 
@@ -213,7 +389,7 @@ MemoryAllocation WrappedVulkan::AllocateMemoryForResource(bool buffer, VkMemoryR
 
     // if we are on a buffer/image, account for any alignment we might have to do
     if(ret.buffer != block.buffer)
-      offs = AlignUp(offs, m_PhysicalDeviceData.props.limits.bufferImageGranularity);
+      offs = AlignUp(offs, granularity);
 
     // align as required by the resource
     offs = AlignUp(offs, mrq.alignment);
@@ -239,9 +415,14 @@ MemoryAllocation WrappedVulkan::AllocateMemoryForResource(bool buffer, VkMemoryR
     // if the allocation will fit, we've found our candidate.
     if(ret.size <= avail)
     {
+      // any gap left by aligning can be used by a later allocation
+      if(offs > block.offs)
+        AddFreeRange(b, block.offs, offs - block.offs);
+
       // update the block offset and buffer/image bit
       block.offs = offs + ret.size;
       block.buffer = ret.buffer;
+      b.liveAllocations++;
 
       // update our return value
       ret.offs = offs;
@@ -306,7 +487,12 @@ MemoryAllocation WrappedVulkan::AllocateMemoryForResource(bool buffer, VkMemoryR
 
     switch(ret.type)
     {
-      case MemoryType::Upload: memoryTypeIndex = GetUploadMemoryIndex(mrq.memoryTypeBits); break;
+      case MemoryType::Upload:
+        if(scope == MemoryScope::InitialContents && UseHostInitialContents())
+          memoryTypeIndex = GetHostMemoryIndex(mrq.memoryTypeBits);
+        else
+          memoryTypeIndex = GetUploadMemoryIndex(mrq.memoryTypeBits);
+        break;
       case MemoryType::GPULocal:
         memoryTypeIndex = GetGPULocalMemoryIndex(mrq.memoryTypeBits);
         break;
@@ -346,7 +532,7 @@ MemoryAllocation WrappedVulkan::AllocateMemoryForResource(bool buffer, VkMemoryR
     chunk.buffer = ret.buffer;
     chunk.memoryTypeIndex = memoryTypeIndex;
     chunk.scope = scope;
-    chunk.type = type;
+    chunk.type = ret.type;
     chunk.size = info.allocationSize;
 
     // the offset starts immediately after this allocation
@@ -364,15 +550,34 @@ MemoryAllocation WrappedVulkan::AllocateMemoryForResource(bool buffer, VkMemoryR
     if(vkr != VK_SUCCESS)
       return ret;
 
+    if(IsDeviceLocalMemoryType(memoryTypeIndex))
+    {
+      m_ReplayDeviceLocalBytes += chunk.size;
+
+      // initial contents are only read when resetting, so they can be paged out before anything
+      // the capture uses
+      if(m_PageableDeviceMemory && scope == MemoryScope::InitialContents)
+        ObjDisp(d)->SetDeviceMemoryPriorityEXT(Unwrap(d), chunk.mem, 0.0f);
+    }
+
+    MemoryAccounting::Allocated(GetMemoryCategory(scope), chunk.size);
+
     GetResourceManager()->WrapResource(Unwrap(d), chunk.mem);
 
     // push the new chunk
-    blockList.push_back(chunk);
+    MemoryBlock block;
+    block.base = chunk;
+    block.liveAllocations = 1;
+    blockList.push_back(block);
 
     // return the first bytes in the new chunk
     ret.mem = chunk.mem;
   }
 
+  m_MemoryScopeUsed[(size_t)scope] += ret.size;
+  m_MemoryScopePeak[(size_t)scope] =
+      RDCMAX(m_MemoryScopePeak[(size_t)scope], m_MemoryScopeUsed[(size_t)scope]);
+
   // ensure the returned size is accurate to what was requested, not what we padded
   ret.size = mrq.size;
 
@@ -401,25 +606,147 @@ MemoryAllocation WrappedVulkan::AllocateMemoryForResource(VkBuffer buf, MemorySc
   return AllocateMemoryForResource(true, mrq, scope, type);
 }
 
+VkDeviceSize WrappedVulkan::PaddedAllocationSize(VkDeviceSize size)
+{
+  return AlignUp(size, GetDeviceProps().limits.nonCoherentAtomSize);
+}
+
+void WrappedVulkan::AddFreeRange(MemoryBlock &block, VkDeviceSize offs, VkDeviceSize size)
+{
+  rdcarray<rdcpair<VkDeviceSize, VkDeviceSize>> &ranges = block.freeRanges;
+
+  // find the first range after this one
+  size_t idx = 0;
+  while(idx < ranges.size() && ranges[idx].first < offs)
+    idx++;
+
+  RDCASSERTMSG("Freed memory overlaps a free range",
+               (idx == 0 || ranges[idx - 1].first + ranges[idx - 1].second <= offs) &&
+                   (idx == ranges.size() || offs + size <= ranges[idx].first),
+               offs, size);
+
+  // merge with the next range if it starts where we end
+  if(idx < ranges.size() && offs + size == ranges[idx].first)
+  {
+    size += ranges[idx].second;
+    ranges.erase(idx);
+  }
+
+  // merge with the previous range if it ends where we start, otherwise insert a new range
+  if(idx > 0 && ranges[idx - 1].first + ranges[idx - 1].second == offs)
+  {
+    idx--;
+    ranges[idx].second += size;
+  }
+  else
+  {
+    ranges.insert(idx, {offs, size});
+  }
+}
+
 void WrappedVulkan::FreeAllMemory(MemoryScope scope)
 {
-  rdcarray<MemoryAllocation> &allocList = m_MemoryBlocks[(size_t)scope];
+  rdcarray<MemoryBlock> &blockList = m_MemoryBlocks[(size_t)scope];
 
-  if(allocList.empty())
+  if(blockList.empty())
     return;
 
+  RDCLOG("Freeing %zu blocks of %s memory, at most %llu MB was in use at once", blockList.size(),
+         ToStr(scope).c_str(), m_MemoryScopePeak[(size_t)scope] / (1024 * 1024));
+
   VkDevice d = GetDev();
 
-  for(MemoryAllocation alloc : allocList)
+  for(const MemoryBlock &block : blockList)
   {
+    const MemoryAllocation &alloc = block.base;
+
+    if(IsDeviceLocalMemoryType(alloc.memoryTypeIndex))
+      m_ReplayDeviceLocalBytes -= RDCMIN(m_ReplayDeviceLocalBytes, alloc.size);
+
+    MemoryAccounting::Freed(GetMemoryCategory(scope), alloc.size);
+
     ObjDisp(d)->FreeMemory(Unwrap(d), Unwrap(alloc.mem), NULL);
     GetResourceManager()->ReleaseWrappedResource(alloc.mem);
   }
 
-  allocList.clear();
+  blockList.clear();
+  m_MemoryScopeUsed[(size_t)scope] = 0;
+  m_MemoryScopePeak[(size_t)scope] = 0;
 }
 
 void WrappedVulkan::FreeMemoryAllocation(MemoryAllocation alloc)
 {
-  // don't do anything at the moment, we only support freeing the whole scope at once.
+  if(alloc.mem == VK_NULL_HANDLE)
+    return;
+
+  rdcarray<MemoryBlock> &blockList = m_MemoryBlocks[(size_t)alloc.scope];
+
+  size_t idx = 0;
+  while(idx < blockList.size() && blockList[idx].base.mem != alloc.mem)
+    idx++;
+
+  if(idx == blockList.size())
+  {
+    RDCERR("Freeing allocation at 0x%llx that isn't in any %s block", alloc.offs,
+           ToStr(alloc.scope).c_str());
+    return;
+  }
+
+  MemoryBlock &block = blockList[idx];
+  const VkDeviceSize size = PaddedAllocationSize(alloc.size);
+
+  m_MemoryScopeUsed[(size_t)alloc.scope] -= RDCMIN(m_MemoryScopeUsed[(size_t)alloc.scope], size);
+
+  if(Vulkan_Debug_MemoryAllocationLogging())
+  {
+    RDCLOG("Freeing 0x%llx bytes at 0x%llx in block %zu", size, alloc.offs, idx);
+  }
+
+  block.liveAllocations--;
+
+  if(block.liveAllocations == 0)
+  {
+    // the block is empty, so start again from the beginning
+    block.freeRanges.clear();
+    block.base.offs = 0;
+
+    // blocks larger than the usual maximum were dedicated to one over-sized allocation and are
+    // unlikely to be re-used, so give the memory back
+    if(block.base.size > 256 * 1024 * 1024)
+    {
+      if(IsDeviceLocalMemoryType(block.base.memoryTypeIndex))
+        m_ReplayDeviceLocalBytes -= RDCMIN(m_ReplayDeviceLocalBytes, block.base.size);
+
+      MemoryAccounting::Freed(GetMemoryCategory(alloc.scope), block.base.size);
+
+      VkDevice d = GetDev();
+      ObjDisp(d)->FreeMemory(Unwrap(d), Unwrap(block.base.mem), NULL);
+      GetResourceManager()->ReleaseWrappedResource(block.base.mem);
+
+      blockList.erase(idx);
+    }
+
+    return;
+  }
+
+  AddFreeRange(block, alloc.offs, size);
+
+  // if the last range now runs up to the end of the used space, hand it back to the end of the
+  // block. Stop at a bufferImageGranularity boundary since we don't know what the allocation before
+  // it was, and keep what's before that as a free range.
+  rdcpair<VkDeviceSize, VkDeviceSize> &last = block.freeRanges.back();
+  if(last.first + last.second == block.base.offs)
+  {
+    const VkDeviceSize granularity = m_PhysicalDeviceData.props.limits.bufferImageGranularity;
+    const VkDeviceSize end = AlignUp(last.first, granularity);
+
+    if(end < block.base.offs)
+    {
+      block.base.offs = end;
+      if(end > last.first)
+        last.second = end - last.first;
+      else
+        block.freeRanges.pop_back();
+    }
+  }
 }
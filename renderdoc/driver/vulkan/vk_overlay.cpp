@@ -2104,65 +2104,88 @@ ResourceId VulkanReplay::RenderOverlay(ResourceId texid, FloatVector clearCol, D
           events.erase(0);
       }
 
-      VkImage quadImg;
-      VkDeviceMemory quadImgMem;
-      VkImageView quadImgView;
-
-      VkImageCreateInfo imInfo = {
-          VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-          NULL,
-          0,
-          VK_IMAGE_TYPE_2D,
-          VK_FORMAT_R32_UINT,
-          {RDCMAX(1U, m_Overlay.ImageDim.width >> 1), RDCMAX(1U, m_Overlay.ImageDim.height >> 1), 1},
-          1,
-          4,
-          VK_SAMPLE_COUNT_1_BIT,
-          VK_IMAGE_TILING_OPTIMAL,
-          VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-          VK_SHARING_MODE_EXCLUSIVE,
-          0,
-          NULL,
-          VK_IMAGE_LAYOUT_UNDEFINED,
-      };
+      OverlayRendering::QuadPassCache &quadPass = m_Overlay.m_QuadPass;
+
+      // if we have the counts for an earlier part of this same pass, only the events since then
+      // need to be added
+      bool incremental = overlay == DebugOverlay::QuadOverdrawPass &&
+                         quadPass.Image != VK_NULL_HANDLE && quadPass.TexId == texid &&
+                         quadPass.Mip == sub.mip && quadPass.Slice == sub.slice &&
+                         quadPass.NumSlices == sub.numSlices &&
+                         quadPass.Dim.width == m_Overlay.ImageDim.width &&
+                         quadPass.Dim.height == m_Overlay.ImageDim.height &&
+                         quadPass.Events.size() < events.size() &&
+                         std::equal(quadPass.Events.begin(), quadPass.Events.end(), events.begin());
+
+      if(incremental)
+        events.erase(0, quadPass.Events.size());
+      else if(overlay == DebugOverlay::QuadOverdrawPass)
+        quadPass.Release(m_pDriver);
+
+      VkImage quadImg = quadPass.Image;
+      VkDeviceMemory quadImgMem = quadPass.Mem;
+      VkImageView quadImgView = quadPass.View;
+
+      if(!incremental)
+      {
+        VkImageCreateInfo imInfo = {
+            VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            NULL,
+            0,
+            VK_IMAGE_TYPE_2D,
+            VK_FORMAT_R32_UINT,
+            {RDCMAX(1U, m_Overlay.ImageDim.width >> 1), RDCMAX(1U, m_Overlay.ImageDim.height >> 1),
+             1},
+            1,
+            4,
+            VK_SAMPLE_COUNT_1_BIT,
+            VK_IMAGE_TILING_OPTIMAL,
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_STORAGE_BIT |
+                VK_IMAGE_USAGE_SAMPLED_BIT,
+            VK_SHARING_MODE_EXCLUSIVE,
+            0,
+            NULL,
+            VK_IMAGE_LAYOUT_UNDEFINED,
+        };
 
-      vkr = m_pDriver->vkCreateImage(m_Device, &imInfo, NULL, &quadImg);
-      CheckVkResult(vkr);
+        vkr = m_pDriver->vkCreateImage(m_Device, &imInfo, NULL, &quadImg);
+        CheckVkResult(vkr);
 
-      NameVulkanObject(quadImg, "m_Overlay.quadImg");
+        NameVulkanObject(quadImg, "m_Overlay.quadImg");
 
-      VkMemoryRequirements mrq = {0};
+        VkMemoryRequirements mrq = {0};
 
-      m_pDriver->vkGetImageMemoryRequirements(m_Device, quadImg, &mrq);
+        m_pDriver->vkGetImageMemoryRequirements(m_Device, quadImg, &mrq);
 
-      VkMemoryAllocateInfo allocInfo = {
-          VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, mrq.size,
-          m_pDriver->GetGPULocalMemoryIndex(mrq.memoryTypeBits),
-      };
+        VkMemoryAllocateInfo allocInfo = {
+            VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, mrq.size,
+            m_pDriver->GetGPULocalMemoryIndex(mrq.memoryTypeBits),
+        };
 
-      vkr = m_pDriver->vkAllocateMemory(m_Device, &allocInfo, NULL, &quadImgMem);
-      CheckVkResult(vkr);
+        vkr = m_pDriver->vkAllocateMemory(m_Device, &allocInfo, NULL, &quadImgMem);
+        CheckVkResult(vkr);
 
-      if(vkr != VK_SUCCESS)
-        return ResourceId();
+        if(vkr != VK_SUCCESS)
+          return ResourceId();
 
-      vkr = m_pDriver->vkBindImageMemory(m_Device, quadImg, quadImgMem, 0);
-      CheckVkResult(vkr);
+        vkr = m_pDriver->vkBindImageMemory(m_Device, quadImg, quadImgMem, 0);
+        CheckVkResult(vkr);
 
-      VkImageViewCreateInfo viewinfo = {
-          VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-          NULL,
-          0,
-          quadImg,
-          VK_IMAGE_VIEW_TYPE_2D_ARRAY,
-          VK_FORMAT_R32_UINT,
-          {VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY,
-           VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY},
-          {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 4},
-      };
+        VkImageViewCreateInfo viewinfo = {
+            VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            NULL,
+            0,
+            quadImg,
+            VK_IMAGE_VIEW_TYPE_2D_ARRAY,
+            VK_FORMAT_R32_UINT,
+            {VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY,
+             VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY},
+            {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 4},
+        };
 
-      vkr = m_pDriver->vkCreateImageView(m_Device, &viewinfo, NULL, &quadImgView);
-      CheckVkResult(vkr);
+        vkr = m_pDriver->vkCreateImageView(m_Device, &viewinfo, NULL, &quadImgView);
+        CheckVkResult(vkr);
+      }
 
       // update descriptor to point to our R32 result image
       VkDescriptorImageInfo imdesc = {0};
@@ -2195,13 +2218,22 @@ ResourceId VulkanReplay::RenderOverlay(ResourceId texid, FloatVector clearCol, D
           {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 4},
       };
 
-      // clear all to black
-      DoPipelineBarrier(cmd, 1, &quadImBarrier);
-      vt->CmdClearColorImage(Unwrap(cmd), Unwrap(quadImg), VK_IMAGE_LAYOUT_GENERAL,
-                             (VkClearColorValue *)&black, 1, &quadImBarrier.subresourceRange);
+      if(incremental)
+      {
+        // keep the counts, just wait for the last resolve to finish reading them
+        quadImBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        quadImBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+      }
+      else
+      {
+        // clear all to black
+        DoPipelineBarrier(cmd, 1, &quadImBarrier);
+        vt->CmdClearColorImage(Unwrap(cmd), Unwrap(quadImg), VK_IMAGE_LAYOUT_GENERAL,
+                               (VkClearColorValue *)&black, 1, &quadImBarrier.subresourceRange);
 
-      quadImBarrier.srcAccessMask = quadImBarrier.dstAccessMask;
-      quadImBarrier.oldLayout = quadImBarrier.newLayout;
+        quadImBarrier.srcAccessMask = quadImBarrier.dstAccessMask;
+        quadImBarrier.oldLayout = quadImBarrier.newLayout;
+      }
 
       quadImBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
 
@@ -2281,9 +2313,24 @@ ResourceId VulkanReplay::RenderOverlay(ResourceId texid, FloatVector clearCol, D
         m_pDriver->SubmitCmds();
         m_pDriver->FlushQ();
 
-        m_pDriver->vkDestroyImageView(m_Device, quadImgView, NULL);
-        m_pDriver->vkDestroyImage(m_Device, quadImg, NULL);
-        m_pDriver->vkFreeMemory(m_Device, quadImgMem, NULL);
+        if(overlay == DebugOverlay::QuadOverdrawPass)
+        {
+          quadPass.Image = quadImg;
+          quadPass.Mem = quadImgMem;
+          quadPass.View = quadImgView;
+          quadPass.TexId = texid;
+          quadPass.Mip = sub.mip;
+          quadPass.Slice = sub.slice;
+          quadPass.NumSlices = sub.numSlices;
+          quadPass.Dim = m_Overlay.ImageDim;
+          quadPass.Events.append(events);
+        }
+        else
+        {
+          m_pDriver->vkDestroyImageView(m_Device, quadImgView, NULL);
+          m_pDriver->vkDestroyImage(m_Device, quadImg, NULL);
+          m_pDriver->vkFreeMemory(m_Device, quadImgMem, NULL);
+        }
       }
 
       // restore back to normal
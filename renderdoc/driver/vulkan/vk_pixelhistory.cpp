@@ -1429,11 +1429,10 @@ struct VulkanOcclusionCallback : public VulkanPixelHistoryCallback
 {
   VulkanOcclusionCallback(WrappedVulkan *vk, PixelHistoryShaderCache *shaderCache,
                           const PixelHistoryCallbackInfo &callbackInfo, VkQueryPool occlusionPool,
-                          const rdcarray<EventUsage> &allEvents)
-      : VulkanPixelHistoryCallback(vk, shaderCache, callbackInfo, occlusionPool)
+                          const rdcarray<uint32_t> &events)
+      : VulkanPixelHistoryCallback(vk, shaderCache, callbackInfo, occlusionPool),
+        m_Events(events.begin(), events.end())
   {
-    for(size_t i = 0; i < allEvents.size(); i++)
-      m_Events.push_back(allEvents[i].eventId);
   }
 
   ~VulkanOcclusionCallback()
@@ -1444,7 +1443,7 @@ struct VulkanOcclusionCallback : public VulkanPixelHistoryCallback
 
   void PreDraw(uint32_t eid, VkCommandBuffer cmd)
   {
-    if(!m_Events.contains(eid))
+    if(m_Events.find(eid) == m_Events.end())
       return;
     VulkanRenderState prevState = m_pDriver->GetCmdRenderState();
     VulkanRenderState &pipestate = m_pDriver->GetCmdRenderState();
@@ -1558,7 +1557,8 @@ private:
 
 private:
   std::map<ResourceId, VkPipeline> m_PipeCache;
-  rdcarray<uint32_t> m_Events;
+  // every draw that writes to the target is checked, so use a set for quick lookups
+  std::set<uint32_t> m_Events;
   // Key is event ID, and value is an index of where the occlusion result.
   std::map<uint32_t, uint32_t> m_OcclusionQueries;
   rdcarray<uint64_t> m_OcclusionResults;
@@ -3316,6 +3316,216 @@ private:
   rdcarray<VkPipeline> m_PipesToDestroy;
 };
 
+// VulkanRegionCountCallback counts the fragments each draw rasterises at every pixel in a region in
+// a single replay. Like VulkanColorAndStencilCallback it replays each draw with a fixed colour
+// shader and stencil increment, but with the scissor covering the whole region, then copies the
+// stencil counts out as a tightly packed block per draw.
+struct VulkanRegionCountCallback : public VulkanPixelHistoryCallback
+{
+  VulkanRegionCountCallback(WrappedVulkan *vk, PixelHistoryShaderCache *shaderCache,
+                            const PixelHistoryCallbackInfo &callbackInfo, uint32_t width,
+                            uint32_t height, uint32_t countStride, const rdcarray<uint32_t> &events)
+      : VulkanPixelHistoryCallback(vk, shaderCache, callbackInfo, VK_NULL_HANDLE),
+        m_Width(width),
+        m_Height(height),
+        m_CountStride(countStride),
+        m_Events(events)
+  {
+  }
+
+  ~VulkanRegionCountCallback()
+  {
+    for(auto it = m_PipeCache.begin(); it != m_PipeCache.end(); ++it)
+      m_pDriver->vkDestroyPipeline(m_pDriver->GetDev(), it->second, NULL);
+  }
+
+  void PreDraw(uint32_t eid, VkCommandBuffer cmd)
+  {
+    if(!m_Events.contains(eid) || !m_pDriver->IsCmdPrimary())
+      return;
+
+    if(HasMultipleSubpasses())
+    {
+      if(!m_MultipleSubpassWarningPrinted)
+      {
+        RDCWARN("Multiple subpasses in a render pass are not supported for pixel history.");
+        m_MultipleSubpassWarningPrinted = true;
+      }
+      return;
+    }
+
+    VulkanRenderState prevState = m_pDriver->GetCmdRenderState();
+    VulkanRenderState &pipestate = m_pDriver->GetCmdRenderState();
+
+    pipestate.EndRenderPass(cmd);
+    // if dynamic rendering is in use and the renderpass just suspended, we need to be sure it is
+    // really finished. This will just store as we always patch the load/store ops.
+    pipestate.FinishSuspendedRenderPass(cmd);
+
+    bool multiview = false;
+    VkRenderPass newRp = PatchRenderPass(pipestate, multiview);
+    PatchFramebuffer(pipestate, newRp);
+
+    VkPipeline pipe = GetCountPipeline(eid, pipestate.graphics.pipeline, newRp,
+                                       GetColorAttachmentIndex(prevState));
+
+    VkRect2D region = {
+        {(int32_t)m_CallbackInfo.x, (int32_t)m_CallbackInfo.y},
+        {m_Width, m_Height},
+    };
+
+    for(uint32_t i = 0; i < pipestate.scissors.size(); i++)
+      pipestate.scissors[i] = region;
+
+    pipestate.graphics.pipeline = GetResID(pipe);
+    pipestate.front.compare = pipestate.front.write = 0xff;
+    pipestate.front.ref = 0;
+    pipestate.back = pipestate.front;
+
+    pipestate.BeginRenderPassAndApplyState(m_pDriver, cmd, VulkanRenderState::BindGraphics, false);
+
+    VkClearAttachment att = {};
+    att.aspectMask = VK_IMAGE_ASPECT_STENCIL_BIT;
+    VkClearRect rect = {};
+    rect.rect = region;
+    rect.baseArrayLayer = 0;
+    rect.layerCount = 1;
+    ObjDisp(cmd)->CmdClearAttachments(Unwrap(cmd), 1, &att, 1, &rect);
+
+    const ActionDescription *action = m_pDriver->GetAction(eid);
+    m_pDriver->ReplayDraw(cmd, *action);
+
+    pipestate.EndRenderPass(cmd);
+
+    size_t eventIndex = m_EventIndices.size();
+    CopyStencilRegion(cmd, multiview, eventIndex * m_CountStride);
+    m_EventIndices[eid] = eventIndex;
+
+    // Restore the state.
+    pipestate = prevState;
+
+    if(pipestate.graphics.pipeline != ResourceId())
+      pipestate.BeginRenderPassAndApplyState(m_pDriver, cmd, VulkanRenderState::BindGraphics, true);
+  }
+
+  bool PostDraw(uint32_t eid, VkCommandBuffer cmd) { return false; }
+  void PostRedraw(uint32_t eid, VkCommandBuffer cmd) {}
+  void PreDispatch(uint32_t eid, VkCommandBuffer cmd) {}
+  bool PostDispatch(uint32_t eid, VkCommandBuffer cmd) { return false; }
+  void PostRedispatch(uint32_t eid, VkCommandBuffer cmd) {}
+  void PreMisc(uint32_t eid, ActionFlags flags, VkCommandBuffer cmd) {}
+  bool PostMisc(uint32_t eid, ActionFlags flags, VkCommandBuffer cmd) { return false; }
+  void PostRemisc(uint32_t eid, ActionFlags flags, VkCommandBuffer cmd) {}
+  void PreEndCommandBuffer(VkCommandBuffer cmd) {}
+  void AliasEvent(uint32_t primary, uint32_t alias)
+  {
+    RDCWARN(
+        "Aliased events are not supported, results might be inaccurate. Primary event id: %u, "
+        "alias: %u.",
+        primary, alias);
+  }
+  bool SplitSecondary() { return true; }
+  bool ForceLoadRPs() { return true; }
+  void PreCmdExecute(uint32_t baseEid, uint32_t secondaryFirst, uint32_t secondaryLast,
+                     VkCommandBuffer cmd)
+  {
+  }
+  void PostCmdExecute(uint32_t baseEid, uint32_t secondaryFirst, uint32_t secondaryLast,
+                      VkCommandBuffer cmd)
+  {
+  }
+
+  // Returns the offset of the given event's counts in the destination buffer, or -1 if the event
+  // wasn't counted (e.g. it's in a secondary command buffer).
+  int64_t GetCountOffset(uint32_t eventId)
+  {
+    auto it = m_EventIndices.find(eventId);
+    if(it == m_EventIndices.end())
+      return -1;
+    return int64_t(it->second * m_CountStride);
+  }
+
+private:
+  void CopyStencilRegion(VkCommandBuffer cmd, bool multiview, size_t offset)
+  {
+    // as in CopyImagePixel, our depth-stencil image only matches the target's mip/slice layout when
+    // rendering with multiview
+    uint32_t baseMip = multiview ? m_CallbackInfo.targetSubresource.mip : 0;
+    uint32_t baseSlice = multiview ? m_CallbackInfo.targetSubresource.slice : 0;
+
+    VkImageMemoryBarrier barrier = {
+        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        NULL,
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        VK_ACCESS_TRANSFER_READ_BIT,
+        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        Unwrap(m_CallbackInfo.dsImage),
+        {VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT, baseMip, 1, baseSlice, 1},
+    };
+    DoPipelineBarrier(cmd, 1, &barrier);
+
+    VkBufferImageCopy region = {};
+    region.bufferOffset = (uint64_t)offset;
+    region.imageSubresource = {VK_IMAGE_ASPECT_STENCIL_BIT, baseMip, baseSlice, 1};
+    region.imageOffset = {(int32_t)m_CallbackInfo.x, (int32_t)m_CallbackInfo.y, 0};
+    region.imageExtent = {m_Width, m_Height, 1};
+
+    ObjDisp(cmd)->CmdCopyImageToBuffer(Unwrap(cmd), Unwrap(m_CallbackInfo.dsImage),
+                                       VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                       Unwrap(m_CallbackInfo.dstBuffer), 1, &region);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    DoPipelineBarrier(cmd, 1, &barrier);
+  }
+
+  // GetCountPipeline creates a pipeline replacement that uses a fixed colour shader and increments
+  // stencil for every fragment, the same as PipelineReplacements::fixedShaderStencil.
+  VkPipeline GetCountPipeline(uint32_t eid, ResourceId pipeline, VkRenderPass rp,
+                              uint32_t outputIndex)
+  {
+    auto it = m_PipeCache.find(pipeline);
+    if(it != m_PipeCache.end())
+      return it->second;
+
+    VkGraphicsPipelineCreateInfo pipeCreateInfo = {};
+    rdcarray<VkPipelineShaderStageCreateInfo> stages;
+    MakeIncrementStencilPipelineCI(eid, pipeline, pipeCreateInfo, stages, false, true);
+    pipeCreateInfo.renderPass = rp;
+
+    for(uint32_t i = 0; i < pipeCreateInfo.stageCount; i++)
+    {
+      if(stages[i].stage == VK_SHADER_STAGE_FRAGMENT_BIT)
+      {
+        stages[i].module = m_ShaderCache->GetFixedColShader(outputIndex);
+        stages[i].pName = "main";
+        break;
+      }
+    }
+
+    VkPipeline pipe;
+    VkResult vkr = m_pDriver->vkCreateGraphicsPipelines(m_pDriver->GetDev(), VK_NULL_HANDLE, 1,
+                                                        &pipeCreateInfo, NULL, &pipe);
+    m_pDriver->CheckVkResult(vkr);
+    m_PipeCache.insert(std::make_pair(pipeline, pipe));
+    return pipe;
+  }
+
+  uint32_t m_Width;
+  uint32_t m_Height;
+  uint32_t m_CountStride;
+  std::map<ResourceId, VkPipeline> m_PipeCache;
+  rdcarray<uint32_t> m_Events;
+  // Key is event ID, and value is an index of where the event's counts are stored.
+  std::map<uint32_t, size_t> m_EventIndices;
+  bool m_MultipleSubpassWarningPrinted = false;
+};
+
 bool VulkanDebugManager::PixelHistorySetupResources(PixelHistoryResources &resources,
                                                     VkImage targetImage, VkExtent3D extent,
                                                     VkFormat format, VkSampleCountFlagBits samples,
@@ -3729,6 +3939,8 @@ rdcarray<PixelModification> VulkanReplay::PixelHistory(rdcarray<EventUsage> even
   if(events.empty())
     return history;
 
+  InitPixelHistoryResources();
+
   const VulkanCreationInfo::Image &imginfo = GetDebugManager()->GetImageInfo(target);
   if(imginfo.format == VK_FORMAT_UNDEFINED)
     return history;
@@ -3759,16 +3971,34 @@ rdcarray<PixelModification> VulkanReplay::PixelHistory(rdcarray<EventUsage> even
     sampleIdx = 0;
 
   VkDevice dev = m_pDriver->GetDev();
-  VkQueryPool occlusionPool;
-  CreateOcclusionPool(m_pDriver, (uint32_t)events.size(), &occlusionPool);
 
-  PixelHistoryResources resources = {};
-  // TODO: perhaps should do this after making an occlusion query, since we will
-  // get a smaller subset of events that passed the occlusion query.
+  // Split the events into ones that always modify the pixel (clears and direct writes) and draws
+  // that might, dropping any that refer to a different slice.
+  rdcarray<EventUsage> candidateEvents;
+  rdcarray<uint32_t> candidateDraws;
+  for(size_t ev = 0; ev < events.size(); ev++)
+  {
+    if(events[ev].view != ResourceId())
+    {
+      // TODO: Check that the slice and mip matches.
+      VulkanCreationInfo::ImageView viewInfo =
+          m_pDriver->GetDebugManager()->GetImageViewInfo(events[ev].view);
+      uint32_t layerEnd = viewInfo.range.baseArrayLayer + viewInfo.range.layerCount;
+      if(sub.slice < viewInfo.range.baseArrayLayer || sub.slice >= layerEnd)
+      {
+        RDCDEBUG("Usage %d at %u didn't refer to the matching mip/slice (%u/%u)", events[ev].usage,
+                 events[ev].eventId, sub.mip, sub.slice);
+        continue;
+      }
+    }
+
+    candidateEvents.push_back(events[ev]);
+
+    if(events[ev].usage != ResourceUsage::Clear && !isDirectWrite(events[ev].usage))
+      candidateDraws.push_back(events[ev].eventId);
+  }
+
   VkImage targetImage = GetResourceManager()->GetCurrentHandle<VkImage>(target);
-  GetDebugManager()->PixelHistorySetupResources(resources, targetImage, imginfo.extent,
-                                                imginfo.format, imginfo.samples, sub,
-                                                (uint32_t)events.size());
 
   PixelHistoryShaderCache *shaderCache = new PixelHistoryShaderCache(m_pDriver);
 
@@ -3783,65 +4013,80 @@ rdcarray<PixelModification> VulkanReplay::PixelHistory(rdcarray<EventUsage> even
   callbackInfo.x = x;
   callbackInfo.y = y;
   callbackInfo.sampleMask = sampleMask;
-  callbackInfo.subImage = resources.colorImage;
-  callbackInfo.subImageView = resources.colorImageView;
-  callbackInfo.dsImage = resources.dsImage;
-  callbackInfo.dsFormat = resources.dsFormat;
-  callbackInfo.dsImageView = resources.dsImageView;
-  callbackInfo.dstBuffer = resources.dstBuffer;
 
-  VulkanOcclusionCallback occlCb(m_pDriver, shaderCache, callbackInfo, occlusionPool, events);
-  {
-    VkMarkerRegion occlRegion("VulkanOcclusionCallback");
-    m_pDriver->ReplayLog(0, events.back().eventId, eReplay_Full);
-    m_pDriver->SubmitCmds();
-    m_pDriver->FlushQ();
-    occlCb.FetchOcclusionResults();
-  }
-
-  // Gather all draw events that could have written to pixel for another replay pass,
-  // to determine if these draws failed for some reason (for ex., depth test).
+  // Cull the draws with a single replay that runs each one scissored to the pixel inside an
+  // occlusion query, and reads back all the queries at once. Only the draws that touched the pixel
+  // go through the more expensive passes below, so their cost scales with the number of events
+  // that actually contribute rather than with every event that wrote to the target.
   rdcarray<uint32_t> modEvents;
   rdcarray<uint32_t> drawEvents;
-  for(size_t ev = 0; ev < events.size(); ev++)
   {
-    bool clear = (events[ev].usage == ResourceUsage::Clear);
-    bool directWrite = isDirectWrite(events[ev].usage);
+    VkQueryPool occlusionPool = VK_NULL_HANDLE;
+    CreateOcclusionPool(m_pDriver, RDCMAX(1U, (uint32_t)candidateDraws.size()), &occlusionPool);
 
-    if(events[ev].view != ResourceId())
+    VulkanOcclusionCallback occlCb(m_pDriver, shaderCache, callbackInfo, occlusionPool,
+                                   candidateDraws);
+    if(!candidateDraws.empty())
     {
-      // TODO: Check that the slice and mip matches.
-      VulkanCreationInfo::ImageView viewInfo =
-          m_pDriver->GetDebugManager()->GetImageViewInfo(events[ev].view);
-      uint32_t layerEnd = viewInfo.range.baseArrayLayer + viewInfo.range.layerCount;
-      if(sub.slice < viewInfo.range.baseArrayLayer || sub.slice >= layerEnd)
-      {
-        RDCDEBUG("Usage %d at %u didn't refer to the matching mip/slice (%u/%u)", events[ev].usage,
-                 events[ev].eventId, sub.mip, sub.slice);
-        continue;
-      }
+      VkMarkerRegion occlRegion("VulkanOcclusionCallback");
+      m_pDriver->ReplayLog(0, candidateDraws.back(), eReplay_Full);
+      m_pDriver->SubmitCmds();
+      m_pDriver->FlushQ();
+      occlCb.FetchOcclusionResults();
     }
 
-    if(directWrite || clear)
+    // Gather all draw events that could have written to pixel for another replay pass,
+    // to determine if these draws failed for some reason (for ex., depth test).
+    for(size_t ev = 0; ev < candidateEvents.size(); ev++)
     {
-      modEvents.push_back(events[ev].eventId);
-    }
-    else
-    {
-      uint64_t occlData = occlCb.GetOcclusionResult((uint32_t)events[ev].eventId);
-      VkMarkerRegion::Set(StringFormat::Fmt("%u has occl %llu", events[ev].eventId, occlData));
-      if(occlData > 0)
+      uint32_t eventId = candidateEvents[ev].eventId;
+
+      if(candidateEvents[ev].usage == ResourceUsage::Clear ||
+         isDirectWrite(candidateEvents[ev].usage))
       {
-        drawEvents.push_back(events[ev].eventId);
-        modEvents.push_back(events[ev].eventId);
+        modEvents.push_back(eventId);
+      }
+      else
+      {
+        uint64_t occlData = occlCb.GetOcclusionResult(eventId);
+        VkMarkerRegion::Set(StringFormat::Fmt("%u has occl %llu", eventId, occlData));
+        if(occlData > 0)
+        {
+          drawEvents.push_back(eventId);
+          modEvents.push_back(eventId);
+        }
       }
     }
+
+    ObjDisp(dev)->DestroyQueryPool(Unwrap(dev), occlusionPool, NULL);
+  }
+
+  RDCDEBUG("PixelHistory culled %zu candidate draws to %zu", candidateDraws.size(),
+           drawEvents.size());
+
+  if(modEvents.empty())
+  {
+    delete shaderCache;
+    return history;
   }
 
+  // the resources only need to hold data for the events that survived culling
+  PixelHistoryResources resources = {};
+  GetDebugManager()->PixelHistorySetupResources(resources, targetImage, imginfo.extent,
+                                                imginfo.format, imginfo.samples, sub,
+                                                (uint32_t)modEvents.size());
+
+  callbackInfo.subImage = resources.colorImage;
+  callbackInfo.subImageView = resources.colorImageView;
+  callbackInfo.dsImage = resources.dsImage;
+  callbackInfo.dsFormat = resources.dsFormat;
+  callbackInfo.dsImageView = resources.dsImageView;
+  callbackInfo.dstBuffer = resources.dstBuffer;
+
   VulkanColorAndStencilCallback cb(m_pDriver, shaderCache, callbackInfo, modEvents);
   {
     VkMarkerRegion colorStencilRegion("VulkanColorAndStencilCallback");
-    m_pDriver->ReplayLog(0, events.back().eventId, eReplay_Full);
+    m_pDriver->ReplayLog(0, modEvents.back(), eReplay_Full);
     m_pDriver->SubmitCmds();
     m_pDriver->FlushQ();
   }
@@ -3856,7 +4101,7 @@ rdcarray<PixelModification> VulkanReplay::PixelHistory(rdcarray<EventUsage> even
     CreateOcclusionPool(m_pDriver, (uint32_t)drawEvents.size() * 6, &tfOcclusionPool);
 
     tfCb = new TestsFailedCallback(m_pDriver, shaderCache, callbackInfo, tfOcclusionPool, drawEvents);
-    m_pDriver->ReplayLog(0, events.back().eventId, eReplay_Full);
+    m_pDriver->ReplayLog(0, drawEvents.back(), eReplay_Full);
     m_pDriver->SubmitCmds();
     m_pDriver->FlushQ();
     tfCb->FetchOcclusionResults();
@@ -4157,8 +4402,166 @@ rdcarray<PixelModification> VulkanReplay::PixelHistory(rdcarray<EventUsage> even
   SAFE_DELETE(tfCb);
 
   GetDebugManager()->PixelHistoryDestroyResources(resources);
-  ObjDisp(dev)->DestroyQueryPool(Unwrap(dev), occlusionPool, NULL);
   delete shaderCache;
 
   return history;
 }
+
+PixelRegionHistory VulkanReplay::PixelHistoryRegion(rdcarray<EventUsage> events, ResourceId target,
+                                                    uint32_t x, uint32_t y, uint32_t width,
+                                                    uint32_t height, const Subresource &sub,
+                                                    CompType typeCast)
+{
+  InitPixelHistoryResources();
+
+  const VulkanCreationInfo::Image &imginfo = GetDebugManager()->GetImageInfo(target);
+
+  // stencil counts can't be copied directly out of a multisampled image, so fetch the history of
+  // each pixel in turn instead
+  if(imginfo.samples != VK_SAMPLE_COUNT_1_BIT)
+    return StandardPixelHistoryRegion(this, events, target, x, y, width, height, sub, typeCast);
+
+  PixelRegionHistory ret;
+  ret.x = x;
+  ret.y = y;
+  ret.width = width;
+  ret.height = height;
+
+  if(events.empty() || imginfo.format == VK_FORMAT_UNDEFINED)
+  {
+    ret.pixelOffsets.fill(width * height + 1, 0);
+    return ret;
+  }
+
+  rdcstr regionName = StringFormat::Fmt(
+      "PixelHistoryRegion: (%u, %u) %ux%u on %s subresource (%u, %u) with %zu events", x, y, width,
+      height, ToStr(target).c_str(), sub.mip, sub.slice, events.size());
+
+  RDCDEBUG("%s", regionName.c_str());
+
+  VkMarkerRegion region(regionName);
+
+  SCOPED_TIMER("VkDebugManager::PixelHistoryRegion");
+
+  // drop events that touch other slices, and count fragments for every remaining draw. Clears and
+  // direct writes are assumed to modify every pixel, as in PixelHistory.
+  rdcarray<EventUsage> regionEvents;
+  rdcarray<uint32_t> drawEvents;
+  for(size_t ev = 0; ev < events.size(); ev++)
+  {
+    if(events[ev].view != ResourceId())
+    {
+      const VulkanCreationInfo::ImageView &viewInfo =
+          m_pDriver->GetDebugManager()->GetImageViewInfo(events[ev].view);
+      uint32_t layerEnd = viewInfo.range.baseArrayLayer + viewInfo.range.layerCount;
+      if(sub.slice < viewInfo.range.baseArrayLayer || sub.slice >= layerEnd)
+        continue;
+    }
+
+    regionEvents.push_back(events[ev]);
+
+    if(events[ev].usage != ResourceUsage::Clear && !isDirectWrite(events[ev].usage))
+      drawEvents.push_back(events[ev].eventId);
+  }
+
+  // depth-stencil copies to buffers must be 4-byte aligned
+  const uint32_t countStride = AlignUp4(width * height);
+
+  size_t countsSize = (size_t)countStride * RDCMAX((size_t)1, drawEvents.size());
+
+  VkDevice dev = m_pDriver->GetDev();
+
+  PixelHistoryResources resources = {};
+  VkImage targetImage = GetResourceManager()->GetCurrentHandle<VkImage>(target);
+  GetDebugManager()->PixelHistorySetupResources(
+      resources, targetImage, imginfo.extent, imginfo.format, imginfo.samples, sub,
+      (uint32_t)(AlignUp(countsSize, sizeof(EventInfo)) / sizeof(EventInfo)));
+
+  PixelHistoryShaderCache *shaderCache = new PixelHistoryShaderCache(m_pDriver);
+
+  PixelHistoryCallbackInfo callbackInfo = {};
+  callbackInfo.targetImage = targetImage;
+  callbackInfo.targetImageFormat = imginfo.format;
+  callbackInfo.layers = imginfo.arrayLayers;
+  callbackInfo.mipLevels = imginfo.mipLevels;
+  callbackInfo.samples = imginfo.samples;
+  callbackInfo.extent = imginfo.extent;
+  callbackInfo.targetSubresource = sub;
+  callbackInfo.x = x;
+  callbackInfo.y = y;
+  callbackInfo.sampleMask = ~0U;
+  callbackInfo.subImage = resources.colorImage;
+  callbackInfo.subImageView = resources.colorImageView;
+  callbackInfo.dsImage = resources.dsImage;
+  callbackInfo.dsFormat = resources.dsFormat;
+  callbackInfo.dsImageView = resources.dsImageView;
+  callbackInfo.dstBuffer = resources.dstBuffer;
+
+  {
+    VulkanRegionCountCallback cb(m_pDriver, shaderCache, callbackInfo, width, height, countStride,
+                                 drawEvents);
+
+    if(!drawEvents.empty())
+    {
+      VkMarkerRegion countRegion("VulkanRegionCountCallback");
+      m_pDriver->ReplayLog(0, events.back().eventId, eReplay_Full);
+      m_pDriver->SubmitCmds();
+      m_pDriver->FlushQ();
+    }
+
+    byte *counts = NULL;
+    VkResult vkr =
+        m_pDriver->vkMapMemory(dev, resources.bufferMemory, 0, VK_WHOLE_SIZE, 0, (void **)&counts);
+    CheckVkResult(vkr);
+
+    if(vkr == VK_SUCCESS && counts)
+    {
+      rdcarray<int64_t> countOffsets;
+      countOffsets.resize(regionEvents.size());
+      for(size_t ev = 0; ev < regionEvents.size(); ev++)
+        countOffsets[ev] = cb.GetCountOffset(regionEvents[ev].eventId);
+
+      ret.pixelOffsets.reserve(width * height + 1);
+
+      for(uint32_t p = 0; p < width * height; p++)
+      {
+        ret.pixelOffsets.push_back((uint32_t)ret.eventIds.size());
+
+        for(size_t ev = 0; ev < regionEvents.size(); ev++)
+        {
+          uint32_t frags = 0;
+
+          if(regionEvents[ev].usage != ResourceUsage::Clear &&
+             !isDirectWrite(regionEvents[ev].usage))
+          {
+            // draws that couldn't be counted are listed for every pixel with no fragment count,
+            // the same way PixelHistory lists them with invalid values
+            if(countOffsets[ev] >= 0)
+            {
+              frags = counts[countOffsets[ev] + p];
+              if(frags == 0)
+                continue;
+            }
+          }
+
+          ret.eventIds.push_back(regionEvents[ev].eventId);
+          ret.fragments.push_back(frags);
+        }
+      }
+
+      ret.pixelOffsets.push_back((uint32_t)ret.eventIds.size());
+
+      m_pDriver->vkUnmapMemory(dev, resources.bufferMemory);
+    }
+    else
+    {
+      RDCERR("Failed to map region pixel history counts");
+      ret.pixelOffsets.fill(width * height + 1, 0);
+    }
+  }
+
+  GetDebugManager()->PixelHistoryDestroyResources(resources);
+  delete shaderCache;
+
+  return ret;
+}
@@ -1473,28 +1473,77 @@ static void ConvertToMeshOutputCompute(const ShaderReflection &refl,
   }
 }
 
-void VulkanReplay::ClearPostVSCache()
+void VulkanReplay::ReleasePostVSData(VulkanPostVSData &data)
 {
   VkDevice dev = m_Device;
 
+  if(data.vsout.idxbuf != VK_NULL_HANDLE)
+  {
+    m_pDriver->vkDestroyBuffer(dev, data.vsout.idxbuf, NULL);
+    m_pDriver->vkFreeMemory(dev, data.vsout.idxbufmem, NULL);
+  }
+  m_pDriver->vkDestroyBuffer(dev, data.vsout.buf, NULL);
+  m_pDriver->vkFreeMemory(dev, data.vsout.bufmem, NULL);
+
+  if(data.gsout.buf != VK_NULL_HANDLE)
+  {
+    m_pDriver->vkDestroyBuffer(dev, data.gsout.buf, NULL);
+    m_pDriver->vkFreeMemory(dev, data.gsout.bufmem, NULL);
+  }
+}
+
+void VulkanReplay::ClearPostVSCache()
+{
   for(auto it = m_PostVS.Data.begin(); it != m_PostVS.Data.end(); ++it)
+    ReleasePostVSData(it->second);
+
+  m_PostVS.Data.clear();
+  m_PostVS.Cache.Clear();
+  m_PostVS.PatchedShaders.clear();
+}
+
+void VulkanReplay::TrimPostVSCache(const rdcarray<uint32_t> &keep)
+{
+  VkDevice dev = m_Device;
+
+  for(uint32_t eventId : m_PostVS.Cache.GetUnsizedEvents())
   {
-    if(it->second.vsout.idxbuf != VK_NULL_HANDLE)
-    {
-      m_pDriver->vkDestroyBuffer(dev, it->second.vsout.idxbuf, NULL);
-      m_pDriver->vkFreeMemory(dev, it->second.vsout.idxbufmem, NULL);
-    }
-    m_pDriver->vkDestroyBuffer(dev, it->second.vsout.buf, NULL);
-    m_pDriver->vkFreeMemory(dev, it->second.vsout.bufmem, NULL);
+    const VulkanPostVSData &data = m_PostVS.Data[eventId];
 
-    if(it->second.gsout.buf != VK_NULL_HANDLE)
+    uint64_t size = 0;
+    for(VkBuffer buf : {data.vsout.buf, data.vsout.idxbuf, data.gsout.buf})
     {
-      m_pDriver->vkDestroyBuffer(dev, it->second.gsout.buf, NULL);
-      m_pDriver->vkFreeMemory(dev, it->second.gsout.bufmem, NULL);
+      if(buf == VK_NULL_HANDLE)
+        continue;
+
+      VkMemoryRequirements mrq = {};
+      m_pDriver->vkGetBufferMemoryRequirements(dev, buf, &mrq);
+      size += mrq.size;
     }
+
+    m_PostVS.Cache.SetSize(eventId, size);
   }
 
-  m_PostVS.Data.clear();
+  rdcarray<uint32_t> keepData;
+  for(uint32_t eventId : keep)
+  {
+    auto it = m_PostVS.Alias.find(eventId);
+    keepData.push_back(it != m_PostVS.Alias.end() ? it->second : eventId);
+  }
+
+  rdcarray<uint32_t> evict = m_PostVS.Cache.Trim(keepData);
+
+  if(evict.empty())
+    return;
+
+  // the data may still be in use by previously submitted mesh rendering
+  m_pDriver->FlushQ();
+
+  for(uint32_t eventId : evict)
+  {
+    ReleasePostVSData(m_PostVS.Data[eventId]);
+    m_PostVS.Data.erase(eventId);
+  }
 }
 
 void VulkanReplay::FetchVSOut(uint32_t eventId, VulkanRenderState &state)
@@ -1758,8 +1807,8 @@ void VulkanReplay::FetchVSOut(uint32_t eventId, VulkanRenderState &state)
 
     // fetch ibuffer
     if(state.ibuffer.buf != ResourceId())
-      GetBufferData(state.ibuffer.buf, state.ibuffer.offs + action->indexOffset * idxsize,
-                    uint64_t(action->numIndices) * idxsize, idxdata);
+      GetPostVSSourceData(state.ibuffer.buf, state.ibuffer.offs + action->indexOffset * idxsize,
+                          uint64_t(action->numIndices) * idxsize, idxdata);
 
     // figure out what the maximum index could be, so we can clamp our index buffer to something
     // sane
@@ -2110,7 +2159,7 @@ void VulkanReplay::FetchVSOut(uint32_t eventId, VulkanRenderState &state)
 
       origVBs.push_back(bytebuf());
       if(state.vbuffers[binding].buf != ResourceId())
-        GetBufferData(state.vbuffers[binding].buf, offs, len, origVBs.back());
+        GetPostVSSourceData(state.vbuffers[binding].buf, offs, len, origVBs.back());
     }
 
     for(uint32_t i = 0; i < state.vertexAttributes.size(); i++)
@@ -2446,9 +2495,54 @@ void VulkanReplay::FetchVSOut(uint32_t eventId, VulkanRenderState &state)
   if(!Vulkan_Debug_PostVSDumpDirPath().empty())
     FileIO::WriteAll(Vulkan_Debug_PostVSDumpDirPath() + "/debug_postvs_vert.spv", modSpirv);
 
-  ConvertToMeshOutputCompute(*refl, *pipeInfo.shaders[0].patchData,
-                             pipeInfo.shaders[0].entryPoint.c_str(), storageMode, attrInstDivisor,
-                             action, numVerts, numViews, baseSpecConstant, modSpirv, bufStride);
+  {
+    // the patched shader only depends on these parameters, and the same mesh is often drawn many
+    // times with identical ones (or re-fetched after being evicted), so don't patch it again
+    bytebuf patchKey;
+    auto addKey = [&patchKey](const void *data, size_t size) {
+      patchKey.append((const byte *)data, size);
+    };
+
+    ResourceId moduleId = pipeInfo.shaders[0].module;
+    uint32_t indexed = (action->flags & ActionFlags::Indexed) ? 1U : 0U;
+    uint32_t keyParams[] = {
+        (uint32_t)storageMode,
+        indexed,
+        action->numInstances,
+        action->vertexOffset,
+        action->instanceOffset,
+        (uint32_t)action->baseVertex,
+        action->drawIndex,
+        numVerts,
+        numViews,
+        baseSpecConstant,
+    };
+    addKey(&moduleId, sizeof(moduleId));
+    addKey(&refl, sizeof(refl));
+    addKey(keyParams, sizeof(keyParams));
+    addKey(attrInstDivisor.data(), attrInstDivisor.byteSize());
+    addKey(pipeInfo.shaders[0].entryPoint.c_str(), pipeInfo.shaders[0].entryPoint.size());
+
+    auto patched = m_PostVS.PatchedShaders.find(patchKey);
+    if(patched != m_PostVS.PatchedShaders.end())
+    {
+      modSpirv = patched->second.spirv;
+      bufStride = patched->second.bufStride;
+    }
+    else
+    {
+      ConvertToMeshOutputCompute(*refl, *pipeInfo.shaders[0].patchData,
+                                 pipeInfo.shaders[0].entryPoint.c_str(), storageMode,
+                                 attrInstDivisor, action, numVerts, numViews, baseSpecConstant,
+                                 modSpirv, bufStride);
+
+      // keep the number of patched shaders bounded, they can be large
+      if(m_PostVS.PatchedShaders.size() >= 64)
+        m_PostVS.PatchedShaders.clear();
+
+      m_PostVS.PatchedShaders[patchKey] = {modSpirv, bufStride};
+    }
+  }
 
   if(!Vulkan_Debug_PostVSDumpDirPath().empty())
     FileIO::WriteAll(Vulkan_Debug_PostVSDumpDirPath() + "/debug_postvs_comp.spv", modSpirv);
@@ -2740,20 +2834,98 @@ void VulkanReplay::FetchVSOut(uint32_t eventId, VulkanRenderState &state)
     vkr = ObjDisp(dev)->EndCommandBuffer(Unwrap(cmd));
     CheckVkResult(vkr);
 
-    // submit & flush so that we don't have to keep pipeline around for a while
     m_pDriver->SubmitCmds();
-    m_pDriver->FlushQ();
+
+    // when fetching a whole pass, wait for all the fetches together at the end. Otherwise flush
+    // now so that we don't have to keep the pipeline around for a while
+    if(!m_PostVS.Batching)
+      m_pDriver->FlushQ();
+  }
+
+  // fill out m_PostVS.Data
+  ret.vsin.topo = state.primitiveTopology;
+  ret.vsout.topo = state.primitiveTopology;
+  ret.vsout.buf = meshBuffer;
+  ret.vsout.bufmem = meshMem;
+
+  ret.vsout.baseVertex = 0;
+
+  ret.vsout.numViews = numViews;
+
+  ret.vsout.vertStride = bufStride;
+  ret.vsout.nearPlane = 0.1f;
+  ret.vsout.farPlane = 100.0f;
+
+  ret.vsout.useIndices = bool(action->flags & ActionFlags::Indexed);
+  ret.vsout.numVerts = action->numIndices;
+
+  ret.vsout.instStride = 0;
+  if(action->flags & ActionFlags::Instanced)
+    ret.vsout.instStride = uint32_t(bufSize / (action->numInstances * numViews));
+
+  ret.vsout.idxbuf = VK_NULL_HANDLE;
+  if(ret.vsout.useIndices && state.ibuffer.buf != ResourceId())
+  {
+    VkIndexType type = VK_INDEX_TYPE_UINT16;
+    if(idxsize == 4)
+      type = VK_INDEX_TYPE_UINT32;
+    else if(idxsize == 1)
+      type = VK_INDEX_TYPE_UINT8_EXT;
+
+    ret.vsout.idxbuf = rebasedIdxBuf;
+    ret.vsout.idxbufmem = rebasedIdxBufMem;
+    ret.vsout.idxFmt = type;
   }
 
+  ret.vsout.hasPosOut = refl->outputSignature[0].systemValue == ShaderBuiltin::Position;
+  ret.vsout.flipY = state.views.empty() ? false : state.views[0].height < 0.0f;
+
+  VulkanPostVSPendingFetch fetch;
+  fetch.eventId = eventId;
+  fetch.readbackBuffer = readbackBuffer;
+  fetch.readbackMem = readbackMem;
+  fetch.numVerts = numVerts;
+  fetch.bufStride = bufStride;
+  fetch.hasPosOut = ret.vsout.hasPosOut;
+
   for(CompactedAttrBuffer attrBuf : vbuffers)
   {
-    m_pDriver->vkDestroyBuffer(dev, attrBuf.buf, NULL);
-    m_pDriver->vkFreeMemory(dev, attrBuf.mem, NULL);
+    fetch.tempBuffers.push_back(attrBuf.buf);
+    fetch.tempMems.push_back(attrBuf.mem);
   }
 
+  if(uniqIdxBuf != VK_NULL_HANDLE)
+  {
+    fetch.tempBuffers.push_back(uniqIdxBuf);
+    fetch.tempMems.push_back(uniqIdxBufMem);
+  }
+
+  fetch.descpool = descpool;
+  fetch.descSets = descSets;
+  fetch.setLayouts = setLayouts;
+  fetch.pipeLayout = pipeLayout;
+  fetch.pipe = pipe;
+  fetch.module = module;
+
+  if(m_PostVS.Batching)
+    m_PostVS.BatchPending.push_back(fetch);
+  else
+    FinishVSOut(fetch);
+}
+
+void VulkanReplay::FinishVSOut(VulkanPostVSPendingFetch &fetch)
+{
+  VkDevice dev = m_Device;
+
+  VulkanPostVSData &ret = m_PostVS.Data[fetch.eventId];
+
+  const uint32_t numVerts = fetch.numVerts;
+  const uint32_t bufStride = fetch.bufStride;
+
   // readback mesh data
   byte *byteData = NULL;
-  vkr = m_pDriver->vkMapMemory(m_Device, readbackMem, 0, VK_WHOLE_SIZE, 0, (void **)&byteData);
+  VkResult vkr =
+      m_pDriver->vkMapMemory(dev, fetch.readbackMem, 0, VK_WHOLE_SIZE, 0, (void **)&byteData);
   CheckVkResult(vkr);
   if(vkr != VK_SUCCESS || !byteData)
   {
@@ -2763,154 +2935,163 @@ void VulkanReplay::FetchVSOut(uint32_t eventId, VulkanRenderState &state)
       CheckVkResult(VK_ERROR_MEMORY_MAP_FAILED);
     }
     ret.vsout.status = "Couldn't read back vertex output data from GPU";
-    return;
   }
+  else
+  {
+    VkMappedMemoryRange range = {
+        VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, NULL, fetch.readbackMem, 0, VK_WHOLE_SIZE,
+    };
 
-  VkMappedMemoryRange range = {
-      VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, NULL, readbackMem, 0, VK_WHOLE_SIZE,
-  };
+    vkr = m_pDriver->vkInvalidateMappedMemoryRanges(dev, 1, &range);
+    CheckVkResult(vkr);
 
-  vkr = m_pDriver->vkInvalidateMappedMemoryRanges(m_Device, 1, &range);
-  CheckVkResult(vkr);
+    // do near/far calculations
 
-  // do near/far calculations
+    float nearp = 0.1f;
+    float farp = 100.0f;
 
-  float nearp = 0.1f;
-  float farp = 100.0f;
+    Vec4f *pos0 = (Vec4f *)byteData;
 
-  Vec4f *pos0 = (Vec4f *)byteData;
+    bool found = false;
 
-  bool found = false;
+    // expect position at the start of the buffer, as system values are sorted first
+    // and position is the first value
 
-  // expect position at the start of the buffer, as system values are sorted first
-  // and position is the first value
+    for(uint32_t i = 1; fetch.hasPosOut && i < numVerts; i++)
+    {
+      //////////////////////////////////////////////////////////////////////////////////
+      // derive near/far, assuming a standard perspective matrix
+      //
+      // the transformation from from pre-projection {Z,W} to post-projection {Z,W}
+      // is linear. So we can say Zpost = Zpre*m + c . Here we assume Wpre = 1
+      // and we know Wpost = Zpre from the perspective matrix.
+      // we can then see from the perspective matrix that
+      // m = F/(F-N)
+      // c = -(F*N)/(F-N)
+      //
+      // with re-arranging and substitution, we then get:
+      // N = -c/m
+      // F = c/(1-m)
+      //
+      // so if we can derive m and c then we can determine N and F. We can do this with
+      // two points, and we pick them reasonably distinct on z to reduce floating-point
+      // error
 
-  for(uint32_t i = 1;
-      refl->outputSignature[0].systemValue == ShaderBuiltin::Position && i < numVerts; i++)
-  {
-    //////////////////////////////////////////////////////////////////////////////////
-    // derive near/far, assuming a standard perspective matrix
-    //
-    // the transformation from from pre-projection {Z,W} to post-projection {Z,W}
-    // is linear. So we can say Zpost = Zpre*m + c . Here we assume Wpre = 1
-    // and we know Wpost = Zpre from the perspective matrix.
-    // we can then see from the perspective matrix that
-    // m = F/(F-N)
-    // c = -(F*N)/(F-N)
-    //
-    // with re-arranging and substitution, we then get:
-    // N = -c/m
-    // F = c/(1-m)
-    //
-    // so if we can derive m and c then we can determine N and F. We can do this with
-    // two points, and we pick them reasonably distinct on z to reduce floating-point
-    // error
+      Vec4f *pos = (Vec4f *)(byteData + i * bufStride);
 
-    Vec4f *pos = (Vec4f *)(byteData + i * bufStride);
+      // skip invalid vertices (w=0)
+      if(pos->w != 0.0f && fabs(pos->w - pos0->w) > 0.01f && fabs(pos->z - pos0->z) > 0.01f)
+      {
+        Vec2f A(pos0->w, pos0->z);
+        Vec2f B(pos->w, pos->z);
 
-    // skip invalid vertices (w=0)
-    if(pos->w != 0.0f && fabs(pos->w - pos0->w) > 0.01f && fabs(pos->z - pos0->z) > 0.01f)
-    {
-      Vec2f A(pos0->w, pos0->z);
-      Vec2f B(pos->w, pos->z);
+        float m = (B.y - A.y) / (B.x - A.x);
+        float c = B.y - B.x * m;
 
-      float m = (B.y - A.y) / (B.x - A.x);
-      float c = B.y - B.x * m;
+        if(m == 1.0f || c == 0.0f)
+          continue;
 
-      if(m == 1.0f || c == 0.0f)
-        continue;
+        if(-c / m <= 0.000001f)
+          continue;
 
-      if(-c / m <= 0.000001f)
-        continue;
+        nearp = -c / m;
+        farp = c / (1 - m);
 
-      nearp = -c / m;
-      farp = c / (1 - m);
+        found = true;
 
-      found = true;
+        break;
+      }
+    }
 
-      break;
+    // if we didn't find anything, all z's and w's were identical.
+    // If the z is positive and w greater for the first element then
+    // we detect this projection as reversed z with infinite far plane
+    if(!found && pos0->z > 0.0f && pos0->w > pos0->z)
+    {
+      nearp = pos0->z;
+      farp = FLT_MAX;
     }
-  }
 
-  // if we didn't find anything, all z's and w's were identical.
-  // If the z is positive and w greater for the first element then
-  // we detect this projection as reversed z with infinite far plane
-  if(!found && pos0->z > 0.0f && pos0->w > pos0->z)
-  {
-    nearp = pos0->z;
-    farp = FLT_MAX;
-  }
+    m_pDriver->vkUnmapMemory(dev, fetch.readbackMem);
 
-  m_pDriver->vkUnmapMemory(m_Device, readbackMem);
+    ret.vsout.nearPlane = nearp;
+    ret.vsout.farPlane = farp;
+  }
 
   // clean up temporary memories
-  m_pDriver->vkDestroyBuffer(m_Device, readbackBuffer, NULL);
-  m_pDriver->vkFreeMemory(m_Device, readbackMem, NULL);
+  m_pDriver->vkDestroyBuffer(dev, fetch.readbackBuffer, NULL);
+  m_pDriver->vkFreeMemory(dev, fetch.readbackMem, NULL);
 
-  if(uniqIdxBuf != VK_NULL_HANDLE)
+  for(size_t i = 0; i < fetch.tempBuffers.size(); i++)
   {
-    m_pDriver->vkDestroyBuffer(m_Device, uniqIdxBuf, NULL);
-    m_pDriver->vkFreeMemory(m_Device, uniqIdxBufMem, NULL);
+    m_pDriver->vkDestroyBuffer(dev, fetch.tempBuffers[i], NULL);
+    m_pDriver->vkFreeMemory(dev, fetch.tempMems[i], NULL);
   }
 
-  // fill out m_PostVS.Data
-  ret.vsin.topo = state.primitiveTopology;
-  ret.vsout.topo = state.primitiveTopology;
-  ret.vsout.buf = meshBuffer;
-  ret.vsout.bufmem = meshMem;
+  if(fetch.descpool != VK_NULL_HANDLE)
+  {
+    // delete descriptors. Technically we don't have to free the descriptor sets, but our tracking
+    // on replay doesn't handle destroying children of pooled objects so we do it explicitly anyway.
+    m_pDriver->vkFreeDescriptorSets(dev, fetch.descpool, (uint32_t)fetch.descSets.size(),
+                                    fetch.descSets.data());
 
-  ret.vsout.baseVertex = 0;
+    m_pDriver->vkDestroyDescriptorPool(dev, fetch.descpool, NULL);
 
-  ret.vsout.numViews = numViews;
+    for(VkDescriptorSetLayout layout : fetch.setLayouts)
+      m_pDriver->vkDestroyDescriptorSetLayout(dev, layout, NULL);
+  }
 
-  ret.vsout.vertStride = bufStride;
-  ret.vsout.nearPlane = nearp;
-  ret.vsout.farPlane = farp;
+  // delete pipeline layout
+  m_pDriver->vkDestroyPipelineLayout(dev, fetch.pipeLayout, NULL);
 
-  ret.vsout.useIndices = bool(action->flags & ActionFlags::Indexed);
-  ret.vsout.numVerts = action->numIndices;
+  // delete pipeline
+  m_pDriver->vkDestroyPipeline(dev, fetch.pipe, NULL);
 
-  ret.vsout.instStride = 0;
-  if(action->flags & ActionFlags::Instanced)
-    ret.vsout.instStride = uint32_t(bufSize / (action->numInstances * numViews));
+  // delete shader/shader module
+  m_pDriver->vkDestroyShaderModule(dev, fetch.module, NULL);
+}
 
-  ret.vsout.idxbuf = VK_NULL_HANDLE;
-  if(ret.vsout.useIndices && state.ibuffer.buf != ResourceId())
+void VulkanReplay::GetPostVSSourceData(ResourceId buff, uint64_t offset, uint64_t len,
+                                       bytebuf &retData)
+{
+  // outside of a batched fetch, or for memory rather than buffers, read just the range needed
+  auto bufit = m_pDriver->m_CreationInfo.m_Buffer.find(buff);
+  if(!m_PostVS.Batching || bufit == m_pDriver->m_CreationInfo.m_Buffer.end())
   {
-    VkIndexType type = VK_INDEX_TYPE_UINT16;
-    if(idxsize == 4)
-      type = VK_INDEX_TYPE_UINT32;
-    else if(idxsize == 1)
-      type = VK_INDEX_TYPE_UINT8_EXT;
-
-    ret.vsout.idxbuf = rebasedIdxBuf;
-    ret.vsout.idxbufmem = rebasedIdxBufMem;
-    ret.vsout.idxFmt = type;
+    GetBufferData(buff, offset, len, retData);
+    return;
   }
 
-  ret.vsout.hasPosOut = refl->outputSignature[0].systemValue == ShaderBuiltin::Position;
-  ret.vsout.flipY = state.views.empty() ? false : state.views[0].height < 0.0f;
-
-  if(descpool != VK_NULL_HANDLE)
+  auto it = m_PostVS.BatchSourceData.find(buff);
+  if(it == m_PostVS.BatchSourceData.end())
   {
-    // delete descriptors. Technically we don't have to free the descriptor sets, but our tracking
-    // on replay doesn't handle destroying children of pooled objects so we do it explicitly anyway.
-    m_pDriver->vkFreeDescriptorSets(dev, descpool, (uint32_t)descSets.size(), descSets.data());
+    const uint64_t bufSize = bufit->second.size;
 
-    m_pDriver->vkDestroyDescriptorPool(dev, descpool, NULL);
+    // don't hold onto enormous buffers, read back only what's needed from those
+    const uint64_t maxBufferSize = 64ULL * 1024 * 1024;
+    const uint64_t maxTotalSize = 256ULL * 1024 * 1024;
+    if(bufSize > maxBufferSize || m_PostVS.BatchSourceDataSize + bufSize > maxTotalSize)
+    {
+      GetBufferData(buff, offset, len, retData);
+      return;
+    }
 
-    for(VkDescriptorSetLayout layout : setLayouts)
-      m_pDriver->vkDestroyDescriptorSetLayout(dev, layout, NULL);
+    it = m_PostVS.BatchSourceData.insert(std::make_pair(buff, bytebuf())).first;
+    GetBufferData(buff, 0, bufSize, it->second);
+    m_PostVS.BatchSourceDataSize += it->second.size();
   }
 
-  // delete pipeline layout
-  m_pDriver->vkDestroyPipelineLayout(dev, pipeLayout, NULL);
+  const bytebuf &data = it->second;
 
-  // delete pipeline
-  m_pDriver->vkDestroyPipeline(dev, pipe, NULL);
+  retData.clear();
 
-  // delete shader/shader module
-  m_pDriver->vkDestroyShaderModule(dev, module, NULL);
+  if(offset >= data.size())
+    return;
+
+  if(len == 0 || len > data.size() - offset)
+    len = data.size() - offset;
+
+  retData.assign(data.data() + (size_t)offset, (size_t)len);
 }
 
 void VulkanReplay::FetchTessGSOut(uint32_t eventId, VulkanRenderState &state)
@@ -3473,7 +3654,10 @@ void VulkanReplay::InitPostVSBuffers(uint32_t eventId, VulkanRenderState state)
     eventId = m_PostVS.Alias[eventId];
 
   if(m_PostVS.Data.find(eventId) != m_PostVS.Data.end())
+  {
+    m_PostVS.Cache.Touch(eventId);
     return;
+  }
 
   // we handle out-of-memory errors while processing postvs, don't treat it as a fatal error
   ScopedOOMHandleVk oom(m_pDriver);
@@ -3481,6 +3665,7 @@ void VulkanReplay::InitPostVSBuffers(uint32_t eventId, VulkanRenderState state)
   VulkanCreationInfo &creationInfo = m_pDriver->m_CreationInfo;
 
   VulkanPostVSData &ret = m_PostVS.Data[eventId];
+  m_PostVS.Cache.Add(eventId);
 
   if(state.graphics.pipeline == ResourceId() ||
      (state.GetRenderPass() == ResourceId() && !state.dynamicRendering.active))
@@ -3539,6 +3724,8 @@ void VulkanReplay::InitPostVSBuffers(uint32_t eventId, VulkanRenderState state)
 
 void VulkanReplay::InitPostVSBuffers(uint32_t eventId)
 {
+  TrimPostVSCache({eventId});
+
   InitPostVSBuffers(eventId, m_pDriver->GetRenderState());
 }
 
@@ -3589,6 +3776,8 @@ struct VulkanInitPostVSCallback : public VulkanActionCallback
 
 void VulkanReplay::InitPostVSBuffers(const rdcarray<uint32_t> &events)
 {
+  TrimPostVSCache(events);
+
   size_t first = 0;
 
   for(; first < events.size(); first++)
@@ -3606,10 +3795,26 @@ void VulkanReplay::InitPostVSBuffers(const rdcarray<uint32_t> &events)
 
   VulkanInitPostVSCallback cb(m_pDriver, events);
 
+  // the pass is recorded into one command buffer that isn't submitted until the replay finishes,
+  // so no draw within it can modify the source data of another. Read each source buffer only
+  // once and wait for all the fetches together at the end instead of once per draw.
+  m_PostVS.Batching = true;
+
   // now we replay the events, which are guaranteed (because we generated them in
   // GetPassEvents above) to come from the same command buffer, so the event IDs are
   // still locally continuous, even if we jump into replaying.
   m_pDriver->ReplayLog(events[first], events.back(), eReplay_Full);
+
+  m_PostVS.Batching = false;
+
+  m_pDriver->FlushQ();
+
+  for(VulkanPostVSPendingFetch &fetch : m_PostVS.BatchPending)
+    FinishVSOut(fetch);
+
+  m_PostVS.BatchPending.clear();
+  m_PostVS.BatchSourceData.clear();
+  m_PostVS.BatchSourceDataSize = 0;
 }
 
 MeshFormat VulkanReplay::GetPostVSBuffers(uint32_t eventId, uint32_t instID, uint32_t viewID,
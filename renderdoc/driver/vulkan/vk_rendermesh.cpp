@@ -520,53 +520,84 @@ void VulkanReplay::RenderMesh(uint32_t eventId, const rdcarray<MeshFormat> &seco
   {
     size_t mapsUsed = 0;
 
+    // the secondary draws' UBO data only varies by colour and Y flip, and in practice there are
+    // only a couple of combinations. Share one upload between all the draws that match, instead
+    // of mapping per draw and stalling on a flush each time the ring fills up.
+    struct SecondaryUBO
+    {
+      FloatVector color;
+      uint32_t flipY;
+      uint32_t offs;
+    };
+    rdcarray<SecondaryUBO> secondaryUBOs;
+
     for(size_t i = 0; i < secondaryDraws.size(); i++)
     {
       const MeshFormat &fmt = secondaryDraws[i];
 
       if(fmt.vertexResourceId != ResourceId())
       {
-        // TODO should move the color to a push constant so we don't have to map all the time
-        uint32_t uboOffs = 0;
-        MeshUBOData *data = (MeshUBOData *)m_MeshRender.UBO.Map(&uboOffs);
-        if(!data)
-          return;
+        uint32_t flipY = (cfg.position.flipY == fmt.flipY) ? 0 : 1;
+
+        uint32_t uboOffs = ~0U;
+        for(const SecondaryUBO &ubo : secondaryUBOs)
+        {
+          if(ubo.flipY == flipY && ubo.color.x == fmt.meshColor.x &&
+             ubo.color.y == fmt.meshColor.y && ubo.color.z == fmt.meshColor.z &&
+             ubo.color.w == fmt.meshColor.w)
+          {
+            uboOffs = ubo.offs;
+            break;
+          }
+        }
 
-        data->mvp = ModelViewProj;
-        data->color = Vec4f(fmt.meshColor.x, fmt.meshColor.y, fmt.meshColor.z, fmt.meshColor.w);
-        data->homogenousInput = cfg.position.unproject;
-        data->pointSpriteSize = Vec2f(0.0f, 0.0f);
-        data->displayFormat = MESHDISPLAY_SOLID;
-        data->rawoutput = 0;
-        data->flipY = (cfg.position.flipY == fmt.flipY) ? 0 : 1;
+        if(uboOffs == ~0U)
+        {
+          if(mapsUsed + 1 >= m_MeshRender.UBO.GetRingCount())
+          {
+            // flush and sync so we can use more maps
+            vt->CmdEndRenderPass(Unwrap(cmd));
 
-        m_MeshRender.UBO.Unmap();
+            vkr = vt->EndCommandBuffer(Unwrap(cmd));
+            CheckVkResult(vkr);
 
-        mapsUsed++;
+            m_pDriver->SubmitCmds();
+            m_pDriver->FlushQ();
 
-        if(mapsUsed + 1 >= m_MeshRender.UBO.GetRingCount())
-        {
-          // flush and sync so we can use more maps
-          vt->CmdEndRenderPass(Unwrap(cmd));
+            mapsUsed = 0;
 
-          vkr = vt->EndCommandBuffer(Unwrap(cmd));
-          CheckVkResult(vkr);
+            // the ring will be re-used from here on
+            secondaryUBOs.clear();
 
-          m_pDriver->SubmitCmds();
-          m_pDriver->FlushQ();
+            cmd = m_pDriver->GetNextCmd();
 
-          mapsUsed = 0;
+            if(cmd == VK_NULL_HANDLE)
+              return;
 
-          cmd = m_pDriver->GetNextCmd();
+            vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+            CheckVkResult(vkr);
+            vt->CmdBeginRenderPass(Unwrap(cmd), &rpbegin, VK_SUBPASS_CONTENTS_INLINE);
 
-          if(cmd == VK_NULL_HANDLE)
+            vt->CmdSetViewport(Unwrap(cmd), 0, 1, &viewport);
+          }
+
+          MeshUBOData *data = (MeshUBOData *)m_MeshRender.UBO.Map(&uboOffs);
+          if(!data)
             return;
 
-          vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
-          CheckVkResult(vkr);
-          vt->CmdBeginRenderPass(Unwrap(cmd), &rpbegin, VK_SUBPASS_CONTENTS_INLINE);
+          data->mvp = ModelViewProj;
+          data->color = Vec4f(fmt.meshColor.x, fmt.meshColor.y, fmt.meshColor.z, fmt.meshColor.w);
+          data->homogenousInput = cfg.position.unproject;
+          data->pointSpriteSize = Vec2f(0.0f, 0.0f);
+          data->displayFormat = MESHDISPLAY_SOLID;
+          data->rawoutput = 0;
+          data->flipY = flipY;
+
+          m_MeshRender.UBO.Unmap();
+
+          mapsUsed++;
 
-          vt->CmdSetViewport(Unwrap(cmd), 0, 1, &viewport);
+          secondaryUBOs.push_back({fmt.meshColor, flipY, uboOffs});
         }
 
         VKMeshDisplayPipelines secondaryCache = GetDebugManager()->CacheMeshDisplayPipelines(
@@ -602,22 +602,36 @@ void VulkanTextRenderer::BeginText(const TextPrintState &textstate)
 void VulkanTextRenderer::RenderText(const TextPrintState &textstate, float x, float y,
                                     const rdcstr &text)
 {
-  rdcarray<rdcstr> lines;
-  split(text, lines, '\n');
-
-  for(const rdcstr &line : lines)
+  if(text != m_LayoutText)
   {
-    RenderTextInternal(textstate, x, y, line);
-    y += 1.0f;
+    m_LayoutText = text;
+    m_LayoutChars.clear();
+
+    uint32_t line = 0, col = 0;
+    for(char c : text)
+    {
+      if(c == '\n')
+      {
+        line++;
+        col = 0;
+        continue;
+      }
+
+      // spaces still draw the background, so they're kept
+      m_LayoutChars.push_back(Vec4u(uint32_t(c - ' '), line, col, 0));
+      col++;
+    }
   }
+
+  // draw as many characters at once as fit in the string uniforms, which is usually all of them
+  for(size_t i = 0; i < m_LayoutChars.size(); i += MAX_SINGLE_LINE_LENGTH)
+    DrawChars(textstate, x, y, m_LayoutChars.data() + i,
+              RDCMIN(m_LayoutChars.size() - i, size_t(MAX_SINGLE_LINE_LENGTH)));
 }
 
-void VulkanTextRenderer::RenderTextInternal(const TextPrintState &textstate, float x, float y,
-                                            const rdcstr &text)
+void VulkanTextRenderer::DrawChars(const TextPrintState &textstate, float x, float y,
+                                   const Vec4u *chars, size_t count)
 {
-  if(text.empty())
-    return;
-
   uint32_t offsets[2] = {0};
 
   FontUBOData *ubo = (FontUBOData *)m_TextGeneralUBO.Map(&offsets[0]);
@@ -636,15 +650,13 @@ void VulkanTextRenderer::RenderTextInternal(const TextPrintState &textstate, flo
 
   m_TextGeneralUBO.Unmap();
 
-  size_t len = text.size();
-
-  RDCASSERT(len <= MAX_SINGLE_LINE_LENGTH);
+  RDCASSERT(count <= MAX_SINGLE_LINE_LENGTH);
 
-  // only map enough for our string
-  StringUBOData *stringData = (StringUBOData *)m_TextStringUBO.Map(&offsets[1], len * sizeof(Vec4u));
+  // only map enough for our characters
+  StringUBOData *stringData =
+      (StringUBOData *)m_TextStringUBO.Map(&offsets[1], count * sizeof(Vec4u));
 
-  for(size_t i = 0; i < len; i++)
-    stringData->chars[i].x = uint32_t(text[i] - ' ');
+  memcpy(stringData->chars, chars, count * sizeof(Vec4u));
 
   m_TextStringUBO.Unmap();
 
@@ -652,7 +664,7 @@ void VulkanTextRenderer::RenderTextInternal(const TextPrintState &textstate, flo
       ->CmdBindDescriptorSets(Unwrap(textstate.cmd), VK_PIPELINE_BIND_POINT_GRAPHICS,
                               Unwrap(m_TextPipeLayout), 0, 1, UnwrapPtr(m_TextDescSet), 2, offsets);
 
-  ObjDisp(textstate.cmd)->CmdDraw(Unwrap(textstate.cmd), 6 * (uint32_t)len, 1, 0, 0);
+  ObjDisp(textstate.cmd)->CmdDraw(Unwrap(textstate.cmd), 6 * (uint32_t)count, 1, 0, 0);
 }
 
 void VulkanTextRenderer::EndText(const TextPrintState &textstate)
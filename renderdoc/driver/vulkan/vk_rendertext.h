@@ -48,7 +48,8 @@ public:
   void EndText(const TextPrintState &textstate);
 
 private:
-  void RenderTextInternal(const TextPrintState &textstate, float x, float y, const rdcstr &text);
+  void DrawChars(const TextPrintState &textstate, float x, float y, const Vec4u *chars,
+                 size_t count);
 
   static const uint32_t FONT_TEX_WIDTH = 256;
   static const uint32_t FONT_TEX_HEIGHT = 128;
@@ -76,4 +77,9 @@ private:
   VkDeviceMemory m_TextAtlasMem = VK_NULL_HANDLE;
   VkImageView m_TextAtlasView = VK_NULL_HANDLE;
   GPUBuffer m_TextAtlasUpload;
+
+  // the glyph, line and column of each character in the last text rendered. The overlay text is
+  // usually the same from one frame to the next, so it's only laid out again when it changes.
+  rdcstr m_LayoutText;
+  rdcarray<Vec4u> m_LayoutChars;
 };
@@ -34,6 +34,9 @@
 
 RDOC_EXTERN_CONFIG(bool, Vulkan_Debug_SingleSubmitFlushing);
 
+// smaller textures are cheap enough to sample directly even when zoomed out
+static const uint32_t DisplayPyramidMinSize = 4096;
+
 void VulkanReplay::CreateTexImageView(VkImage liveIm, const VulkanCreationInfo::Image &iminfo,
                                       CompType typeCast, TextureDisplayViews &views)
 {
@@ -128,6 +131,247 @@ void VulkanReplay::CreateTexImageView(VkImage liveIm, const VulkanCreationInfo::
   }
 }
 
+void VulkanReplay::ClearDisplayPyramids()
+{
+  if(m_DisplayPyramids.empty())
+    return;
+
+  VkDevice dev = m_pDriver->GetDev();
+  const VkDevDispatchTable *vt = ObjDisp(dev);
+
+  // a display could still be using a pyramid
+  m_pDriver->SubmitCmds();
+  m_pDriver->FlushQ();
+
+  for(auto it = m_DisplayPyramids.begin(); it != m_DisplayPyramids.end(); ++it)
+  {
+    vt->DestroyImageView(Unwrap(dev), it->second.view, NULL);
+    vt->DestroyImage(Unwrap(dev), it->second.image, NULL);
+    vt->FreeMemory(Unwrap(dev), it->second.mem, NULL);
+  }
+
+  m_DisplayPyramids.clear();
+  m_DisplayPyramidBytes = 0;
+}
+
+bool VulkanReplay::GetDisplayPyramid(const TextureDisplay &cfg, VkFormat castedFormat,
+                                     const ImageState &imageState, VkImageView &view,
+                                     uint32_t &level)
+{
+  const VulkanCreationInfo::Image &iminfo = m_pDriver->m_CreationInfo.m_Image[cfg.resourceId];
+
+  // only plain 2D colour textures viewed at mip 0 without a typecast, that we can filter with
+  // blits. Anything else is displayed from the texture itself.
+  if(cfg.scale > 0.5f || cfg.subresource.mip != 0 || cfg.rawOutput ||
+     cfg.customShaderId != ResourceId() || iminfo.type != VK_IMAGE_TYPE_2D ||
+     iminfo.samples != VK_SAMPLE_COUNT_1_BIT || castedFormat != iminfo.format ||
+     IsDepthOrStencilFormat(iminfo.format) || IsYUVFormat(iminfo.format) ||
+     IsUIntFormat(iminfo.format) || IsSIntFormat(iminfo.format) ||
+     RDCMAX(iminfo.extent.width, iminfo.extent.height) < DisplayPyramidMinSize)
+    return false;
+
+  const VkFormatFeatureFlags requiredFeatures =
+      VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+      VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+  if((m_pDriver->GetFormatProperties(iminfo.format).optimalTilingFeatures & requiredFeatures) !=
+     requiredFeatures)
+    return false;
+
+  VkDevice dev = m_pDriver->GetDev();
+  const VkDevDispatchTable *vt = ObjDisp(dev);
+
+  rdcpair<ResourceId, uint32_t> key = {cfg.resourceId, cfg.subresource.slice};
+
+  auto it = m_DisplayPyramids.find(key);
+  if(it == m_DisplayPyramids.end())
+  {
+    DisplayPyramid pyramid;
+
+    // level 0 is half the size of the texture, and each level halves again down to 1x1
+    uint32_t dim = RDCMAX(iminfo.extent.width, iminfo.extent.height);
+    while(dim > 1)
+    {
+      pyramid.levels++;
+      dim >>= 1;
+    }
+
+    VkImageCreateInfo imInfo = {
+        VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        NULL,
+        0,
+        VK_IMAGE_TYPE_2D,
+        iminfo.format,
+        {RDCMAX(1U, iminfo.extent.width / 2), RDCMAX(1U, iminfo.extent.height / 2), 1},
+        pyramid.levels,
+        1,
+        VK_SAMPLE_COUNT_1_BIT,
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        VK_SHARING_MODE_EXCLUSIVE,
+        0,
+        NULL,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+
+    VkResult vkr = vt->CreateImage(Unwrap(dev), &imInfo, NULL, &pyramid.image);
+    CheckVkResult(vkr);
+    if(vkr != VK_SUCCESS)
+      return false;
+
+    VkMemoryRequirements mrq = {0};
+    vt->GetImageMemoryRequirements(Unwrap(dev), pyramid.image, &mrq);
+
+    if(m_DisplayPyramidBytes + mrq.size > MaxDisplayPyramidBytes)
+      ClearDisplayPyramids();
+
+    if(mrq.size > MaxDisplayPyramidBytes)
+    {
+      vt->DestroyImage(Unwrap(dev), pyramid.image, NULL);
+      return false;
+    }
+
+    VkMemoryAllocateInfo allocInfo = {
+        VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, mrq.size,
+        m_pDriver->GetGPULocalMemoryIndex(mrq.memoryTypeBits),
+    };
+
+    vkr = vt->AllocateMemory(Unwrap(dev), &allocInfo, NULL, &pyramid.mem);
+    CheckVkResult(vkr);
+    if(vkr != VK_SUCCESS)
+    {
+      vt->DestroyImage(Unwrap(dev), pyramid.image, NULL);
+      return false;
+    }
+
+    vkr = vt->BindImageMemory(Unwrap(dev), pyramid.image, pyramid.mem, 0);
+    CheckVkResult(vkr);
+
+    pyramid.size = mrq.size;
+
+    VkImageViewCreateInfo viewInfo = {
+        VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        NULL,
+        0,
+        pyramid.image,
+        VK_IMAGE_VIEW_TYPE_2D_ARRAY,
+        iminfo.format,
+        {VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY,
+         VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY},
+        {VK_IMAGE_ASPECT_COLOR_BIT, 0, pyramid.levels, 0, 1},
+    };
+
+    vkr = vt->CreateImageView(Unwrap(dev), &viewInfo, NULL, &pyramid.view);
+    CheckVkResult(vkr);
+    NameUnwrappedVulkanObject(pyramid.view, "Display pyramid view");
+
+    VkCommandBuffer cmd = m_pDriver->GetNextCmd();
+
+    if(cmd == VK_NULL_HANDLE)
+    {
+      vt->DestroyImageView(Unwrap(dev), pyramid.view, NULL);
+      vt->DestroyImage(Unwrap(dev), pyramid.image, NULL);
+      vt->FreeMemory(Unwrap(dev), pyramid.mem, NULL);
+      return false;
+    }
+
+    VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                          VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+    vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+
+    VkMarkerRegion::Begin("Display pyramid", cmd);
+
+    ImageBarrierSequence setupBarriers, cleanupBarriers;
+    imageState.TempTransition(m_pDriver->GetQueueFamilyIndex(),
+                              VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_READ_BIT,
+                              setupBarriers, cleanupBarriers, m_pDriver->GetImageTransitionInfo());
+    m_pDriver->InlineSetupImageBarriers(cmd, setupBarriers);
+    m_pDriver->SubmitAndFlushImageStateBarriers(setupBarriers);
+
+    VkImageMemoryBarrier barrier = {
+        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        NULL,
+        0,
+        VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        pyramid.image,
+        {VK_IMAGE_ASPECT_COLOR_BIT, 0, pyramid.levels, 0, 1},
+    };
+
+    DoPipelineBarrier(cmd, 1, &barrier);
+
+    VkImage srcImage = Unwrap(m_pDriver->GetResourceManager()->GetCurrentHandle<VkImage>(
+        cfg.resourceId));
+    uint32_t srcSlice = RDCMIN(cfg.subresource.slice, uint32_t(iminfo.arrayLayers - 1));
+    int32_t srcWidth = int32_t(iminfo.extent.width);
+    int32_t srcHeight = int32_t(iminfo.extent.height);
+
+    // each level is filtered down from the one above it, starting from the texture itself
+    for(uint32_t i = 0; i < pyramid.levels; i++)
+    {
+      int32_t dstWidth = RDCMAX(1, srcWidth / 2);
+      int32_t dstHeight = RDCMAX(1, srcHeight / 2);
+
+      VkImageBlit blit = {
+          {VK_IMAGE_ASPECT_COLOR_BIT, i == 0 ? 0 : i - 1, i == 0 ? srcSlice : 0, 1},
+          {{0, 0, 0}, {srcWidth, srcHeight, 1}},
+          {VK_IMAGE_ASPECT_COLOR_BIT, i, 0, 1},
+          {{0, 0, 0}, {dstWidth, dstHeight, 1}},
+      };
+
+      vt->CmdBlitImage(Unwrap(cmd), i == 0 ? srcImage : pyramid.image,
+                       VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, pyramid.image,
+                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+      // the level just written becomes the source for the next
+      barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+      barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+      barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+      barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+      barrier.subresourceRange.baseMipLevel = i;
+      barrier.subresourceRange.levelCount = 1;
+      DoPipelineBarrier(cmd, 1, &barrier);
+
+      srcWidth = dstWidth;
+      srcHeight = dstHeight;
+    }
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = pyramid.levels;
+    DoPipelineBarrier(cmd, 1, &barrier);
+
+    m_pDriver->InlineCleanupImageBarriers(cmd, cleanupBarriers);
+    VkMarkerRegion::End(cmd);
+    vt->EndCommandBuffer(Unwrap(cmd));
+    if(!cleanupBarriers.empty())
+    {
+      m_pDriver->SubmitCmds();
+      m_pDriver->FlushQ();
+      m_pDriver->SubmitAndFlushImageStateBarriers(cleanupBarriers);
+    }
+
+    m_DisplayPyramidBytes += pyramid.size;
+    it = m_DisplayPyramids.insert(std::make_pair(key, pyramid)).first;
+  }
+
+  // pick the smallest level that is still at least as large as the display, so it's only ever
+  // minified. Level N of the pyramid is downsampled by 2^(N+1).
+  level = 0;
+  while(level + 1 < it->second.levels && cfg.scale * float(4U << level) <= 1.0f)
+    level++;
+
+  view = it->second.view;
+  return true;
+}
+
 bool VulkanReplay::RenderTexture(TextureDisplay cfg)
 {
   auto it = m_OutputWindows.find(m_ActiveWinID);
@@ -399,6 +643,17 @@ bool VulkanReplay::RenderTextureInternal(TextureDisplay cfg, const ImageState &i
     customData->SelectedRange.y = cfg.rangeMax;
   }
 
+  // zoomed out views of large textures are sampled from a downsampled copy instead
+  VkImageView pyramidView = VK_NULL_HANDLE;
+  uint32_t pyramidLevel = 0;
+  if(linearSample && (displayformat & TEXDISPLAY_TYPEMASK) == RESTYPE_TEX2D &&
+     GetYUVPlaneCount(texviews.castedFormat) == 1 &&
+     GetDisplayPyramid(cfg, texviews.castedFormat, imageState, pyramidView, pyramidLevel))
+  {
+    data->MipLevel = (int)pyramidLevel;
+    data->Slice = 0.001f;
+  }
+
   m_TexRender.UBO.Unmap();
 
   HeatmapData heatmapData = {};
@@ -439,6 +694,8 @@ bool VulkanReplay::RenderTextureInternal(TextureDisplay cfg, const ImageState &i
   imdesc.sampler = Unwrap(m_General.PointSampler);
   if(linearSample)
     imdesc.sampler = Unwrap(m_TexRender.LinearSampler);
+  if(pyramidView != VK_NULL_HANDLE)
+    imdesc.imageView = pyramidView;
 
   VkDescriptorImageInfo altimdesc[2] = {};
   for(uint32_t i = 1; i < GetYUVPlaneCount(texviews.castedFormat); i++)
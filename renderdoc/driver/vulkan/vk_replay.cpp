@@ -33,6 +33,7 @@
 #include "driver/shaders/spirv/glslang_compile.h"
 #include "maths/formatpacking.h"
 #include "maths/matrix.h"
+#include "md5/md5.h"
 #include "replay/dummy_driver.h"
 #include "serialise/rdcfile.h"
 #include "strings/string_utils.h"
@@ -198,7 +199,13 @@ APIProperties VulkanReplay::GetAPIProperties()
 
 RDResult VulkanReplay::ReadLogInitialisation(RDCFile *rdc, bool storeStructuredBuffers)
 {
-  return m_pDriver->ReadLogInitialisation(rdc, storeStructuredBuffers);
+  RDResult result = m_pDriver->ReadLogInitialisation(rdc, storeStructuredBuffers);
+
+  // this has to happen once the frame capture section is no longer being read
+  if(result == ResultCode::Succeeded)
+    m_pDriver->StoreChunkIndex(rdc);
+
+  return result;
 }
 
 void VulkanReplay::ReplayLog(uint32_t endEventID, ReplayLogType replayType)
@@ -209,6 +216,8 @@ void VulkanReplay::ReplayLog(uint32_t endEventID, ReplayLogType replayType)
     if(replayed)
       return;
   }
+  ClearMSAAReadbackCache();
+  ClearDisplayPyramids();
   m_pDriver->ReplayLog(0, endEventID, replayType);
 }
 
@@ -1049,6 +1058,8 @@ void VulkanReplay::SavePipelineState(uint32_t eventId)
 
   VulkanResourceManager *rm = m_pDriver->GetResourceManager();
 
+  m_PipelineStateEventId = eventId;
+
   VkMarkerRegion::Begin(StringFormat::Fmt("FetchShaderFeedback for %u", eventId));
 
   FetchShaderFeedback(eventId);
@@ -1850,6 +1861,14 @@ void VulkanReplay::SavePipelineState(uint32_t eventId)
   ret.graphics.descriptorSets.resize(state.graphics.descSets.size());
   ret.compute.descriptorSets.resize(state.compute.descSets.size());
 
+  // the cached conversions are only valid for the sets we filled out last time
+  if(m_DescriptorSetCacheState != &ret)
+  {
+    m_DescriptorSetCache[0].clear();
+    m_DescriptorSetCache[1].clear();
+    m_DescriptorSetCacheState = &ret;
+  }
+
   {
     rdcarray<VKPipe::DescriptorSet> *dsts[] = {
         &ret.graphics.descriptorSets, &ret.compute.descriptorSets,
@@ -1865,43 +1884,21 @@ void VulkanReplay::SavePipelineState(uint32_t eventId)
 
     for(size_t p = 0; p < ARRAY_COUNT(srcs); p++)
     {
-      bool hasUsedBinds = false;
       const BindpointIndex *usedBindsData = NULL;
       size_t usedBindsSize = 0;
-
-      {
-        bool curCompute = (p == 1);
-        if(usage.valid && usage.compute == curCompute)
-        {
-          hasUsedBinds = true;
-          usedBindsData = usage.used.data();
-          usedBindsSize = usage.used.size();
-        }
-
-        const ActionDescription *action = m_pDriver->GetAction(eventId);
-        if(action)
-        {
-          bool isDispatch = bool(action->flags & ActionFlags::Dispatch);
-
-          // ifor compute stage on draws, and non-compute stages on dispatches, pretend all
-          // resources are dynamically unused, to prevent the lack of data from causing large arrays
-          // to be force-expanded
-          if((curCompute && !isDispatch) || (!curCompute && isDispatch))
-          {
-            hasUsedBinds = true;
-            usedBindsData = NULL;
-            usedBindsSize = 0;
-          }
-        }
-      }
+      bool hasUsedBinds = GetDynamicDescriptorUsage(eventId, p == 1, usedBindsData, usedBindsSize);
 
       BindpointIndex curBind;
 
+      rdcarray<DescriptorSetCacheEntry> &cache = m_DescriptorSetCache[p];
+      cache.resize(srcs[p]->size());
+
       for(size_t i = 0; i < srcs[p]->size(); i++)
       {
         ResourceId sourceSet = (*srcs[p])[i].descSet;
         const uint32_t *srcOffset = (*srcs[p])[i].offsets.begin();
         VKPipe::DescriptorSet &destSet = (*dsts[p])[i];
+        DescriptorSetCacheEntry &cached = cache[i];
 
         if(sourceSet == ResourceId())
         {
@@ -1910,9 +1907,53 @@ void VulkanReplay::SavePipelineState(uint32_t eventId)
           destSet.pushDescriptor = false;
           destSet.layoutResourceId = ResourceId();
           destSet.bindings.clear();
+          cached = DescriptorSetCacheEntry();
           continue;
         }
 
+        // find this set's entries in the sorted list of used binds, skipping any left over from
+        // earlier sets
+        while(usedBindsSize > 0 && usedBindsData->bindset < (int32_t)i)
+        {
+          usedBindsData++;
+          usedBindsSize--;
+        }
+
+        size_t setUsedCount = 0;
+        while(setUsedCount < usedBindsSize && usedBindsData[setUsedCount].bindset == (int32_t)i)
+          setUsedCount++;
+
+        {
+          const WrappedVulkan::DescriptorSetInfo &setInfo =
+              m_pDriver->m_DescriptorSetState[sourceSet];
+          const rdcarray<uint32_t> &offsets = (*srcs[p])[i].offsets;
+
+          // if the set, its contents and its dynamic usage are all the same as when this set was
+          // last converted, there's nothing to do
+          if(cached.set == sourceSet && cached.layout == setInfo.layout &&
+             cached.offsets == offsets &&
+             cached.variableDescriptorCount == setInfo.data.variableDescriptorCount &&
+             cached.hasUsedBinds == hasUsedBinds && cached.usedBinds.size() == setUsedCount &&
+             std::equal(cached.usedBinds.begin(), cached.usedBinds.end(), usedBindsData) &&
+             cached.inlineData == setInfo.data.inlineBytes &&
+             cached.slots.size() == setInfo.data.slotDataSize() &&
+             memcmp(cached.slots.data(), setInfo.data.slotData(), cached.slots.size()) == 0)
+          {
+            usedBindsData += setUsedCount;
+            usedBindsSize -= setUsedCount;
+            continue;
+          }
+
+          cached.set = sourceSet;
+          cached.layout = setInfo.layout;
+          cached.offsets = offsets;
+          cached.variableDescriptorCount = setInfo.data.variableDescriptorCount;
+          cached.hasUsedBinds = hasUsedBinds;
+          cached.usedBinds.assign(usedBindsData, setUsedCount);
+          cached.inlineData = setInfo.data.inlineBytes;
+          cached.slots.assign(setInfo.data.slotData(), setInfo.data.slotDataSize());
+        }
+
         destSet.inlineData = m_pDriver->m_DescriptorSetState[sourceSet].data.inlineBytes;
 
         curBind.bindset = (uint32_t)i;
@@ -1963,8 +2004,7 @@ void VulkanReplay::SavePipelineState(uint32_t eventId)
             const DescriptorSetSlot &srcel = sourceSlots[a];
             VKPipe::BindingElement &dstel = destSlots.binds[a];
 
-            // clear it so we don't have to manually reset all elements back to normal
-            memset(&dstel, 0, sizeof(dstel));
+            FillDescriptor(layoutBind, descriptorCount, a, srcel, srcOffset, dstel);
 
             curBind.arrayIndex = a;
 
@@ -2018,205 +2058,6 @@ void VulkanReplay::SavePipelineState(uint32_t eventId)
               if(destSlots.firstUsedIndex < 0)
                 destSlots.firstUsedIndex = a;
             }
-
-            DescriptorSlotType descriptorType = srcel.type;
-
-            // immutable samplers cannot be used with mutable descriptors, so if we have immutable
-            // samplers set the type from the layout. That way even if the descriptor is never
-            // written we still process immutable samplers properly.
-            if(layoutBind.immutableSampler)
-              descriptorType = convert(layoutBind.layoutDescType);
-
-            switch(descriptorType)
-            {
-              case DescriptorSlotType::Sampler: dstel.type = BindType::Sampler; break;
-              case DescriptorSlotType::CombinedImageSampler:
-                dstel.type = BindType::ImageSampler;
-                break;
-              case DescriptorSlotType::SampledImage: dstel.type = BindType::ReadOnlyImage; break;
-              case DescriptorSlotType::StorageImage: dstel.type = BindType::ReadWriteImage; break;
-              case DescriptorSlotType::UniformTexelBuffer:
-                dstel.type = BindType::ReadOnlyTBuffer;
-                break;
-              case DescriptorSlotType::StorageTexelBuffer:
-                dstel.type = BindType::ReadWriteTBuffer;
-                break;
-              case DescriptorSlotType::UniformBuffer: dstel.type = BindType::ConstantBuffer; break;
-              case DescriptorSlotType::StorageBuffer: dstel.type = BindType::ReadWriteBuffer; break;
-              case DescriptorSlotType::UniformBufferDynamic:
-                dstel.type = BindType::ConstantBuffer;
-                break;
-              case DescriptorSlotType::StorageBufferDynamic:
-                dstel.type = BindType::ReadWriteBuffer;
-                break;
-              case DescriptorSlotType::InputAttachment:
-                dstel.type = BindType::InputAttachment;
-                break;
-              case DescriptorSlotType::InlineBlock: dstel.type = BindType::ConstantBuffer; break;
-              case DescriptorSlotType::Unwritten:
-              case DescriptorSlotType::Count: dstel.type = BindType::Unknown; break;
-            }
-
-            // first handle the sampler separately because it might be in a combined descriptor
-            if(descriptorType == DescriptorSlotType::Sampler ||
-               descriptorType == DescriptorSlotType::CombinedImageSampler)
-            {
-              if(layoutBind.immutableSampler)
-              {
-                destSlots.binds[a].samplerResourceId = layoutBind.immutableSampler[a];
-                destSlots.binds[a].immutableSampler = true;
-              }
-              else if(srcel.sampler != ResourceId())
-              {
-                destSlots.binds[a].samplerResourceId = srcel.sampler;
-              }
-
-              if(destSlots.binds[a].samplerResourceId != ResourceId())
-              {
-                VKPipe::BindingElement &el = destSlots.binds[a];
-                const VulkanCreationInfo::Sampler &sampl = c.m_Sampler[el.samplerResourceId];
-
-                ResourceId liveId = el.samplerResourceId;
-
-                el.samplerResourceId = rm->GetOriginalID(el.samplerResourceId);
-
-                // sampler info
-                el.filter = MakeFilter(sampl.minFilter, sampl.magFilter, sampl.mipmapMode,
-                                       sampl.maxAnisotropy >= 1.0f, sampl.compareEnable,
-                                       sampl.reductionMode);
-                el.addressU = MakeAddressMode(sampl.address[0]);
-                el.addressV = MakeAddressMode(sampl.address[1]);
-                el.addressW = MakeAddressMode(sampl.address[2]);
-                el.mipBias = sampl.mipLodBias;
-                el.maxAnisotropy = sampl.maxAnisotropy;
-                el.compareFunction = MakeCompareFunc(sampl.compareOp);
-                el.minLOD = sampl.minLod;
-                el.maxLOD = sampl.maxLod;
-                MakeBorderColor(sampl.borderColor, el.borderColor);
-                el.unnormalized = sampl.unnormalizedCoordinates;
-                el.seamless = sampl.seamless;
-
-                if(sampl.ycbcr != ResourceId())
-                {
-                  const VulkanCreationInfo::YCbCrSampler &ycbcr = c.m_YCbCrSampler[sampl.ycbcr];
-                  el.ycbcrSampler = rm->GetOriginalID(sampl.ycbcr);
-
-                  el.ycbcrModel = ycbcr.ycbcrModel;
-                  el.ycbcrRange = ycbcr.ycbcrRange;
-                  Convert(el.samplerSwizzle, ycbcr.componentMapping);
-                  el.xChromaOffset = ycbcr.xChromaOffset;
-                  el.yChromaOffset = ycbcr.yChromaOffset;
-                  el.chromaFilter = ycbcr.chromaFilter;
-                  el.forceExplicitReconstruction = ycbcr.forceExplicitReconstruction;
-                }
-                else
-                {
-                  Convert(el.samplerSwizzle, sampl.componentMapping);
-                  el.srgbBorder = sampl.srgbBorder;
-                }
-
-                if(sampl.customBorder)
-                {
-                  if(sampl.borderColor == VK_BORDER_COLOR_INT_CUSTOM_EXT)
-                  {
-                    for(int bord = 0; bord < 4; bord++)
-                      el.borderColor[bord] = float(sampl.customBorderColor.int32[bord]);
-                  }
-                  else
-                  {
-                    el.borderColor = sampl.customBorderColor.float32;
-                  }
-                }
-              }
-            }
-
-            // now look at the 'base' type. Sampler is excluded from these ifs
-            if(descriptorType == DescriptorSlotType::SampledImage ||
-               descriptorType == DescriptorSlotType::CombinedImageSampler ||
-               descriptorType == DescriptorSlotType::InputAttachment ||
-               descriptorType == DescriptorSlotType::StorageImage)
-            {
-              ResourceId viewid = srcel.resource;
-
-              if(viewid != ResourceId())
-              {
-                destSlots.binds[a].viewResourceId = rm->GetOriginalID(viewid);
-                destSlots.binds[a].resourceResourceId =
-                    rm->GetOriginalID(c.m_ImageView[viewid].image);
-                destSlots.binds[a].viewFormat = MakeResourceFormat(c.m_ImageView[viewid].format);
-
-                Convert(destSlots.binds[a].swizzle, c.m_ImageView[viewid].componentMapping);
-                destSlots.binds[a].firstMip = c.m_ImageView[viewid].range.baseMipLevel;
-                destSlots.binds[a].firstSlice = c.m_ImageView[viewid].range.baseArrayLayer;
-                destSlots.binds[a].numMips = c.m_ImageView[viewid].range.levelCount;
-                destSlots.binds[a].numSlices = c.m_ImageView[viewid].range.layerCount;
-
-                // temporary hack, store image layout enum in byteOffset as it's not used for images
-                destSlots.binds[a].byteOffset = convert(srcel.imageLayout);
-
-                destSlots.binds[a].minLOD = c.m_ImageView[viewid].minLOD;
-              }
-              else
-              {
-                destSlots.binds[a].viewResourceId = ResourceId();
-                destSlots.binds[a].resourceResourceId = ResourceId();
-                destSlots.binds[a].firstMip = 0;
-                destSlots.binds[a].firstSlice = 0;
-                destSlots.binds[a].numMips = 1;
-                destSlots.binds[a].numSlices = 1;
-                destSlots.binds[a].minLOD = 0.0f;
-              }
-            }
-            else if(descriptorType == DescriptorSlotType::UniformTexelBuffer ||
-                    descriptorType == DescriptorSlotType::StorageTexelBuffer)
-            {
-              ResourceId viewid = srcel.resource;
-
-              if(viewid != ResourceId())
-              {
-                destSlots.binds[a].viewResourceId = rm->GetOriginalID(viewid);
-                destSlots.binds[a].resourceResourceId =
-                    rm->GetOriginalID(c.m_BufferView[viewid].buffer);
-                destSlots.binds[a].byteOffset = c.m_BufferView[viewid].offset;
-                destSlots.binds[a].viewFormat = MakeResourceFormat(c.m_BufferView[viewid].format);
-                destSlots.binds[a].byteSize = c.m_BufferView[viewid].size;
-              }
-              else
-              {
-                destSlots.binds[a].viewResourceId = ResourceId();
-                destSlots.binds[a].resourceResourceId = ResourceId();
-                destSlots.binds[a].byteOffset = 0;
-                destSlots.binds[a].byteSize = 0;
-              }
-            }
-            else if(descriptorType == DescriptorSlotType::InlineBlock)
-            {
-              destSlots.binds[a].viewResourceId = ResourceId();
-              destSlots.binds[a].resourceResourceId = ResourceId();
-              destSlots.binds[a].inlineBlock = true;
-              destSlots.binds[a].byteOffset = srcel.offset;
-              destSlots.binds[a].byteSize = descriptorCount;
-            }
-            else if(descriptorType == DescriptorSlotType::StorageBuffer ||
-                    descriptorType == DescriptorSlotType::StorageBufferDynamic ||
-                    descriptorType == DescriptorSlotType::UniformBuffer ||
-                    descriptorType == DescriptorSlotType::UniformBufferDynamic)
-            {
-              destSlots.binds[a].viewResourceId = ResourceId();
-
-              if(srcel.resource != ResourceId())
-                destSlots.binds[a].resourceResourceId = rm->GetOriginalID(srcel.resource);
-
-              destSlots.binds[a].byteOffset = srcel.offset;
-              if(descriptorType == DescriptorSlotType::StorageBufferDynamic ||
-                 descriptorType == DescriptorSlotType::UniformBufferDynamic)
-              {
-                destSlots.binds[a].byteOffset += *srcOffset;
-                srcOffset++;
-              }
-
-              destSlots.binds[a].byteSize = srcel.GetRange();
-            }
           }
 
           // if no bindings were set these will still be negative. Set them to something sensible.
@@ -2288,6 +2129,391 @@ void VulkanReplay::SavePipelineState(uint32_t eventId)
   }
 }
 
+bool VulkanReplay::GetDynamicDescriptorUsage(uint32_t eventId, bool compute,
+                                             const BindpointIndex *&used, size_t &usedCount)
+{
+  used = NULL;
+  usedCount = 0;
+
+  bool hasUsedBinds = false;
+
+  const VKDynamicShaderFeedback &usage = m_BindlessFeedback.Usage[eventId];
+  if(usage.valid && usage.compute == compute)
+  {
+    hasUsedBinds = true;
+    used = usage.used.data();
+    usedCount = usage.used.size();
+  }
+
+  const ActionDescription *action = m_pDriver->GetAction(eventId);
+  if(action)
+  {
+    bool isDispatch = bool(action->flags & ActionFlags::Dispatch);
+
+    // for compute stage on draws, and non-compute stages on dispatches, pretend all resources are
+    // dynamically unused, to prevent the lack of data from causing large arrays to be
+    // force-expanded
+    if((compute && !isDispatch) || (!compute && isDispatch))
+    {
+      hasUsedBinds = true;
+      used = NULL;
+      usedCount = 0;
+    }
+  }
+
+  return hasUsedBinds;
+}
+
+rdcarray<VKPipe::BindingElement> VulkanReplay::GetVulkanDescriptors(bool compute, uint32_t set,
+                                                                    uint32_t binding,
+                                                                    uint32_t firstElement,
+                                                                    uint32_t count)
+{
+  rdcarray<VKPipe::BindingElement> ret;
+
+  const VulkanRenderState &state = m_pDriver->m_RenderState;
+  const rdcarray<VulkanStatePipeline::DescriptorAndOffsets> &descSets =
+      compute ? state.compute.descSets : state.graphics.descSets;
+
+  if(set >= descSets.size() || descSets[set].descSet == ResourceId())
+    return ret;
+
+  const WrappedVulkan::DescriptorSetInfo &setInfo =
+      m_pDriver->m_DescriptorSetState[descSets[set].descSet];
+  const DescSetLayout &layout = m_pDriver->m_CreationInfo.m_DescSetLayout[setInfo.layout];
+
+  if(binding >= layout.bindings.size() || binding >= setInfo.data.binds.size())
+    return ret;
+
+  const DescSetLayout::Binding &layoutBind = layout.bindings[binding];
+
+  uint32_t descriptorCount = layoutBind.descriptorCount;
+  if(layoutBind.variableSize)
+    descriptorCount = setInfo.data.variableDescriptorCount;
+
+  uint32_t elementCount = descriptorCount;
+  if(layoutBind.layoutDescType == VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK)
+    elementCount = 1;
+
+  if(firstElement >= elementCount)
+    return ret;
+
+  count = RDCMIN(count, elementCount - firstElement);
+
+  // dynamic offsets are consumed in binding order by every written dynamic descriptor, so count
+  // how many come before the first element we want
+  auto isDynamic = [](DescriptorSlotType type) {
+    return type == DescriptorSlotType::UniformBufferDynamic ||
+           type == DescriptorSlotType::StorageBufferDynamic;
+  };
+
+  size_t dynamicIndex = 0;
+  for(uint32_t b = 0; b <= binding; b++)
+  {
+    VkDescriptorType type = layout.bindings[b].layoutDescType;
+    if(type != VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC &&
+       type != VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)
+      continue;
+
+    uint32_t end = (b == binding) ? firstElement : layout.bindings[b].descriptorCount;
+    for(uint32_t a = 0; a < end; a++)
+      if(isDynamic(setInfo.data.binds[b][a].type))
+        dynamicIndex++;
+  }
+
+  const rdcarray<uint32_t> &offsets = descSets[set].offsets;
+  const uint32_t *srcOffset = offsets.begin() + RDCMIN(dynamicIndex, offsets.size());
+
+  const BindpointIndex *used = NULL;
+  size_t usedCount = 0;
+  bool hasUsedBinds = GetDynamicDescriptorUsage(m_PipelineStateEventId, compute, used, usedCount);
+
+  const BindpointIndex *usedEnd = used + usedCount;
+  if(used)
+    used = std::lower_bound(used, usedEnd,
+                            BindpointIndex((int32_t)set, (int32_t)binding, firstElement));
+
+  ret.resize(count);
+  for(uint32_t i = 0; i < count; i++)
+  {
+    uint32_t a = firstElement + i;
+    const DescriptorSetSlot &srcel = setInfo.data.binds[binding][a];
+
+    // don't read past the end of the offsets for bad or partially written sets
+    uint32_t dummyOffset = 0;
+    const uint32_t *elOffset = srcOffset < offsets.end() ? srcOffset : &dummyOffset;
+    FillDescriptor(layoutBind, descriptorCount, a, srcel, elOffset, ret[i]);
+    if(elOffset != &dummyOffset)
+      srcOffset = elOffset;
+
+    // same rule as when building the pipeline state, non-arrayed descriptors are always used
+    if(elementCount > 1 && hasUsedBinds)
+    {
+      BindpointIndex cur((int32_t)set, (int32_t)binding, a);
+      while(used && used < usedEnd && *used < cur)
+        used++;
+      ret[i].dynamicallyUsed = (used && used < usedEnd && *used == cur);
+    }
+    else
+    {
+      ret[i].dynamicallyUsed = true;
+    }
+  }
+
+  return ret;
+}
+
+rdcarray<uint32_t> VulkanReplay::GetVulkanUsedDescriptors(bool compute, uint32_t set,
+                                                          uint32_t binding)
+{
+  rdcarray<uint32_t> ret;
+
+  const VulkanRenderState &state = m_pDriver->m_RenderState;
+  const rdcarray<VulkanStatePipeline::DescriptorAndOffsets> &descSets =
+      compute ? state.compute.descSets : state.graphics.descSets;
+
+  if(set >= descSets.size() || descSets[set].descSet == ResourceId())
+    return ret;
+
+  const WrappedVulkan::DescriptorSetInfo &setInfo =
+      m_pDriver->m_DescriptorSetState[descSets[set].descSet];
+  const DescSetLayout &layout = m_pDriver->m_CreationInfo.m_DescSetLayout[setInfo.layout];
+
+  if(binding >= layout.bindings.size())
+    return ret;
+
+  const DescSetLayout::Binding &layoutBind = layout.bindings[binding];
+
+  uint32_t elementCount = layoutBind.descriptorCount;
+  if(layoutBind.variableSize)
+    elementCount = setInfo.data.variableDescriptorCount;
+  if(layoutBind.layoutDescType == VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK)
+    elementCount = 1;
+
+  const BindpointIndex *used = NULL;
+  size_t usedCount = 0;
+  bool hasUsedBinds = GetDynamicDescriptorUsage(m_PipelineStateEventId, compute, used, usedCount);
+
+  // without feedback, or for non-arrayed descriptors, everything is considered used
+  if(!hasUsedBinds || elementCount <= 1)
+  {
+    ret.resize(elementCount);
+    for(uint32_t a = 0; a < elementCount; a++)
+      ret[a] = a;
+    return ret;
+  }
+
+  if(!used)
+    return ret;
+
+  const BindpointIndex *usedEnd = used + usedCount;
+  used = std::lower_bound(used, usedEnd, BindpointIndex((int32_t)set, (int32_t)binding, 0));
+  for(; used < usedEnd && used->bindset == (int32_t)set && used->bind == (int32_t)binding; used++)
+  {
+    if(used->arrayIndex < elementCount)
+      ret.push_back(used->arrayIndex);
+  }
+
+  return ret;
+}
+
+void VulkanReplay::FillDescriptor(const DescSetLayout::Binding &layoutBind,
+                                  uint32_t descriptorCount, uint32_t a,
+                                  const DescriptorSetSlot &srcel, const uint32_t *&srcOffset,
+                                  VKPipe::BindingElement &dstel)
+{
+  VulkanCreationInfo &c = m_pDriver->m_CreationInfo;
+  VulkanResourceManager *rm = m_pDriver->GetResourceManager();
+
+  // clear it so we don't have to manually reset all elements back to normal
+  memset(&dstel, 0, sizeof(dstel));
+
+  DescriptorSlotType descriptorType = srcel.type;
+
+  // immutable samplers cannot be used with mutable descriptors, so if we have immutable
+  // samplers set the type from the layout. That way even if the descriptor is never
+  // written we still process immutable samplers properly.
+  if(layoutBind.immutableSampler)
+    descriptorType = convert(layoutBind.layoutDescType);
+
+  switch(descriptorType)
+  {
+    case DescriptorSlotType::Sampler: dstel.type = BindType::Sampler; break;
+    case DescriptorSlotType::CombinedImageSampler: dstel.type = BindType::ImageSampler; break;
+    case DescriptorSlotType::SampledImage: dstel.type = BindType::ReadOnlyImage; break;
+    case DescriptorSlotType::StorageImage: dstel.type = BindType::ReadWriteImage; break;
+    case DescriptorSlotType::UniformTexelBuffer: dstel.type = BindType::ReadOnlyTBuffer; break;
+    case DescriptorSlotType::StorageTexelBuffer: dstel.type = BindType::ReadWriteTBuffer; break;
+    case DescriptorSlotType::UniformBuffer: dstel.type = BindType::ConstantBuffer; break;
+    case DescriptorSlotType::StorageBuffer: dstel.type = BindType::ReadWriteBuffer; break;
+    case DescriptorSlotType::UniformBufferDynamic: dstel.type = BindType::ConstantBuffer; break;
+    case DescriptorSlotType::StorageBufferDynamic: dstel.type = BindType::ReadWriteBuffer; break;
+    case DescriptorSlotType::InputAttachment: dstel.type = BindType::InputAttachment; break;
+    case DescriptorSlotType::InlineBlock: dstel.type = BindType::ConstantBuffer; break;
+    case DescriptorSlotType::Unwritten:
+    case DescriptorSlotType::Count: dstel.type = BindType::Unknown; break;
+  }
+
+  // first handle the sampler separately because it might be in a combined descriptor
+  if(descriptorType == DescriptorSlotType::Sampler ||
+     descriptorType == DescriptorSlotType::CombinedImageSampler)
+  {
+    if(layoutBind.immutableSampler)
+    {
+      dstel.samplerResourceId = layoutBind.immutableSampler[a];
+      dstel.immutableSampler = true;
+    }
+    else if(srcel.sampler != ResourceId())
+    {
+      dstel.samplerResourceId = srcel.sampler;
+    }
+
+    if(dstel.samplerResourceId != ResourceId())
+    {
+      VKPipe::BindingElement &el = dstel;
+      const VulkanCreationInfo::Sampler &sampl = c.m_Sampler[el.samplerResourceId];
+
+      ResourceId liveId = el.samplerResourceId;
+
+      el.samplerResourceId = rm->GetOriginalID(el.samplerResourceId);
+
+      // sampler info
+      el.filter = MakeFilter(sampl.minFilter, sampl.magFilter, sampl.mipmapMode,
+                             sampl.maxAnisotropy >= 1.0f, sampl.compareEnable,
+                             sampl.reductionMode);
+      el.addressU = MakeAddressMode(sampl.address[0]);
+      el.addressV = MakeAddressMode(sampl.address[1]);
+      el.addressW = MakeAddressMode(sampl.address[2]);
+      el.mipBias = sampl.mipLodBias;
+      el.maxAnisotropy = sampl.maxAnisotropy;
+      el.compareFunction = MakeCompareFunc(sampl.compareOp);
+      el.minLOD = sampl.minLod;
+      el.maxLOD = sampl.maxLod;
+      MakeBorderColor(sampl.borderColor, el.borderColor);
+      el.unnormalized = sampl.unnormalizedCoordinates;
+      el.seamless = sampl.seamless;
+
+      if(sampl.ycbcr != ResourceId())
+      {
+        const VulkanCreationInfo::YCbCrSampler &ycbcr = c.m_YCbCrSampler[sampl.ycbcr];
+        el.ycbcrSampler = rm->GetOriginalID(sampl.ycbcr);
+
+        el.ycbcrModel = ycbcr.ycbcrModel;
+        el.ycbcrRange = ycbcr.ycbcrRange;
+        Convert(el.samplerSwizzle, ycbcr.componentMapping);
+        el.xChromaOffset = ycbcr.xChromaOffset;
+        el.yChromaOffset = ycbcr.yChromaOffset;
+        el.chromaFilter = ycbcr.chromaFilter;
+        el.forceExplicitReconstruction = ycbcr.forceExplicitReconstruction;
+      }
+      else
+      {
+        Convert(el.samplerSwizzle, sampl.componentMapping);
+        el.srgbBorder = sampl.srgbBorder;
+      }
+
+      if(sampl.customBorder)
+      {
+        if(sampl.borderColor == VK_BORDER_COLOR_INT_CUSTOM_EXT)
+        {
+          for(int bord = 0; bord < 4; bord++)
+            el.borderColor[bord] = float(sampl.customBorderColor.int32[bord]);
+        }
+        else
+        {
+          el.borderColor = sampl.customBorderColor.float32;
+        }
+      }
+    }
+  }
+
+  // now look at the 'base' type. Sampler is excluded from these ifs
+  if(descriptorType == DescriptorSlotType::SampledImage ||
+     descriptorType == DescriptorSlotType::CombinedImageSampler ||
+     descriptorType == DescriptorSlotType::InputAttachment ||
+     descriptorType == DescriptorSlotType::StorageImage)
+  {
+    ResourceId viewid = srcel.resource;
+
+    if(viewid != ResourceId())
+    {
+      dstel.viewResourceId = rm->GetOriginalID(viewid);
+      dstel.resourceResourceId = rm->GetOriginalID(c.m_ImageView[viewid].image);
+      dstel.viewFormat = MakeResourceFormat(c.m_ImageView[viewid].format);
+
+      Convert(dstel.swizzle, c.m_ImageView[viewid].componentMapping);
+      dstel.firstMip = c.m_ImageView[viewid].range.baseMipLevel;
+      dstel.firstSlice = c.m_ImageView[viewid].range.baseArrayLayer;
+      dstel.numMips = c.m_ImageView[viewid].range.levelCount;
+      dstel.numSlices = c.m_ImageView[viewid].range.layerCount;
+
+      // temporary hack, store image layout enum in byteOffset as it's not used for images
+      dstel.byteOffset = convert(srcel.imageLayout);
+
+      dstel.minLOD = c.m_ImageView[viewid].minLOD;
+    }
+    else
+    {
+      dstel.viewResourceId = ResourceId();
+      dstel.resourceResourceId = ResourceId();
+      dstel.firstMip = 0;
+      dstel.firstSlice = 0;
+      dstel.numMips = 1;
+      dstel.numSlices = 1;
+      dstel.minLOD = 0.0f;
+    }
+  }
+  else if(descriptorType == DescriptorSlotType::UniformTexelBuffer ||
+          descriptorType == DescriptorSlotType::StorageTexelBuffer)
+  {
+    ResourceId viewid = srcel.resource;
+
+    if(viewid != ResourceId())
+    {
+      dstel.viewResourceId = rm->GetOriginalID(viewid);
+      dstel.resourceResourceId = rm->GetOriginalID(c.m_BufferView[viewid].buffer);
+      dstel.byteOffset = c.m_BufferView[viewid].offset;
+      dstel.viewFormat = MakeResourceFormat(c.m_BufferView[viewid].format);
+      dstel.byteSize = c.m_BufferView[viewid].size;
+    }
+    else
+    {
+      dstel.viewResourceId = ResourceId();
+      dstel.resourceResourceId = ResourceId();
+      dstel.byteOffset = 0;
+      dstel.byteSize = 0;
+    }
+  }
+  else if(descriptorType == DescriptorSlotType::InlineBlock)
+  {
+    dstel.viewResourceId = ResourceId();
+    dstel.resourceResourceId = ResourceId();
+    dstel.inlineBlock = true;
+    dstel.byteOffset = srcel.offset;
+    dstel.byteSize = descriptorCount;
+  }
+  else if(descriptorType == DescriptorSlotType::StorageBuffer ||
+          descriptorType == DescriptorSlotType::StorageBufferDynamic ||
+          descriptorType == DescriptorSlotType::UniformBuffer ||
+          descriptorType == DescriptorSlotType::UniformBufferDynamic)
+  {
+    dstel.viewResourceId = ResourceId();
+
+    if(srcel.resource != ResourceId())
+      dstel.resourceResourceId = rm->GetOriginalID(srcel.resource);
+
+    dstel.byteOffset = srcel.offset;
+    if(descriptorType == DescriptorSlotType::StorageBufferDynamic ||
+       descriptorType == DescriptorSlotType::UniformBufferDynamic)
+    {
+      dstel.byteOffset += *srcOffset;
+      srcOffset++;
+    }
+
+    dstel.byteSize = srcel.GetRange();
+  }
+}
+
 void VulkanReplay::FillCBufferVariables(ResourceId pipeline, ResourceId shader, ShaderStage stage,
                                         rdcstr entryPoint, uint32_t cbufSlot,
                                         rdcarray<ShaderVariable> &outvars, const bytebuf &data)
@@ -2377,19 +2603,35 @@ void VulkanReplay::FillCBufferVariables(ResourceId pipeline, ResourceId shader,
 void VulkanReplay::PickPixel(ResourceId texture, uint32_t x, uint32_t y, const Subresource &sub,
                              CompType typeCast, float pixel[4])
 {
-  int oldW = m_DebugWidth, oldH = m_DebugHeight;
+  rdcarray<float> pixels;
+  if(PickPixelTile(texture, x, y, 1, 1, sub, typeCast, pixels))
+    memcpy(pixel, pixels.data(), sizeof(float) * 4);
+}
 
-  m_DebugWidth = m_DebugHeight = 1;
+bool VulkanReplay::PickPixelTile(ResourceId texture, uint32_t x, uint32_t y, uint32_t width,
+                                 uint32_t height, const Subresource &sub, CompType typeCast,
+                                 rdcarray<float> &pixels)
+{
+  if(width == 0 || height == 0 || width > PixelPicking::TileSize ||
+     height > PixelPicking::TileSize)
+    return false;
 
   VulkanCreationInfo::Image &iminfo = m_pDriver->m_CreationInfo.m_Image[texture];
   LockedConstImageStateRef imageState = m_pDriver->FindConstImageState(texture);
   if(!imageState)
   {
     RDCWARN("Could not find image info for image %s", ToStr(texture).c_str());
-    return;
+    return false;
   }
   if(!imageState->isMemoryBound)
-    return;
+    return false;
+
+  int oldW = m_DebugWidth, oldH = m_DebugHeight;
+
+  m_DebugWidth = width;
+  m_DebugHeight = height;
+
+  pixels.fill(width * height * 4, 0.0f);
 
   bool isStencil = IsStencilFormat(iminfo.format);
 
@@ -2436,7 +2678,7 @@ void VulkanReplay::PickPixel(ResourceId texture, uint32_t x, uint32_t y, const S
           {{
                0, 0,
            },
-           {1, 1}},
+           {width, height}},
           1,
           &clearval,
       };
@@ -2450,7 +2692,7 @@ void VulkanReplay::PickPixel(ResourceId texture, uint32_t x, uint32_t y, const S
     const VkDevDispatchTable *vt = ObjDisp(dev);
 
     if(cmd == VK_NULL_HANDLE)
-      return;
+      return false;
 
     VkResult vkr = VK_SUCCESS;
 
@@ -2482,7 +2724,7 @@ void VulkanReplay::PickPixel(ResourceId texture, uint32_t x, uint32_t y, const S
 
       // do copy
       VkBufferImageCopy region = {
-          0, 128, 1, {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1}, {0, 0, 0}, {1, 1, 1},
+          0, width, height, {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1}, {0, 0, 0}, {width, height, 1},
       };
       vt->CmdCopyImageToBuffer(Unwrap(cmd), Unwrap(m_PixelPick.Image),
                                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
@@ -2505,12 +2747,12 @@ void VulkanReplay::PickPixel(ResourceId texture, uint32_t x, uint32_t y, const S
                         (void **)&pData);
     CheckVkResult(vkr);
     if(vkr != VK_SUCCESS)
-      return;
+      return false;
     if(!pData)
     {
       RDCERR("Manually reporting failed memory map");
       CheckVkResult(VK_ERROR_MEMORY_MAP_FAILED);
-      return;
+      return false;
     }
 
     VkMappedMemoryRange range = {
@@ -2535,14 +2777,12 @@ void VulkanReplay::PickPixel(ResourceId texture, uint32_t x, uint32_t y, const S
       // only write stencil to .y
       if(pass == 1)
       {
-        pixel[1] = ((uint32_t *)pData)[0] / 255.0f;
+        for(size_t i = 0; i < pixels.size(); i += 4)
+          pixels[i + 1] = ((uint32_t *)pData)[i] / 255.0f;
       }
       else
       {
-        pixel[0] = pData[0];
-        pixel[1] = pData[1];
-        pixel[2] = pData[2];
-        pixel[3] = pData[3];
+        memcpy(pixels.data(), pData, pixels.byteSize());
       }
     }
 
@@ -2551,6 +2791,8 @@ void VulkanReplay::PickPixel(ResourceId texture, uint32_t x, uint32_t y, const S
 
   m_DebugWidth = oldW;
   m_DebugHeight = oldH;
+
+  return true;
 }
 
 bool VulkanReplay::GetMinMax(ResourceId texid, const Subresource &sub, CompType typeCast,
@@ -2599,6 +2841,8 @@ bool VulkanReplay::GetMinMax(ResourceId texid, const Subresource &sub, CompType
 bool VulkanReplay::GetMinMax(ResourceId texid, const Subresource &sub, CompType typeCast,
                              bool stencil, float *minval, float *maxval)
 {
+  InitHistogramResources();
+
   VkDevice dev = m_pDriver->GetDev();
   const VkDevDispatchTable *vt = ObjDisp(dev);
 
@@ -2918,6 +3162,8 @@ bool VulkanReplay::GetHistogram(ResourceId texid, const Subresource &sub, CompTy
   if(minval >= maxval)
     return false;
 
+  InitHistogramResources();
+
   VkDevice dev = m_pDriver->GetDev();
   const VkDevDispatchTable *vt = ObjDisp(dev);
 
@@ -3255,6 +3501,137 @@ void VulkanReplay::CopyPixelForPixelHistory(VkCommandBuffer cmd, VkOffset2D offs
 
 void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
                                   const GetTextureDataParams &params, bytebuf &data)
+{
+  if(GetCachedMSAAReadback(tex, sub, params, data))
+    return;
+
+  PendingTextureReadback readback;
+  if(!QueueTextureReadback(tex, sub, params, readback))
+    return;
+
+  m_pDriver->FlushQ();
+
+  FinishTextureReadback(readback, data);
+}
+
+void VulkanReplay::GetTextureDataBatch(const rdcarray<TextureReadback> &readbacks,
+                                       TextureReadbackCallback callback)
+{
+  VkDevice dev = m_pDriver->GetDev();
+  const VkDevDispatchTable *vt = ObjDisp(dev);
+
+  // Each readback is submitted followed by its own fence, so the oldest can be mapped and handed to
+  // the callback while the copies queued after it are still executing. Readbacks that aren't
+  // queued yet wait until a slot in the ring is free, which bounds the readback memory in use.
+  const size_t RingSize = 4;
+
+  VkFence fences[RingSize] = {};
+  rdcarray<PendingTextureReadback> pending;
+  pending.resize(RingSize);
+  bool queued[RingSize] = {};
+
+  VkFenceCreateInfo fenceInfo = {VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+  for(size_t i = 0; i < RingSize; i++)
+  {
+    VkResult vkr = vt->CreateFence(Unwrap(dev), &fenceInfo, NULL, &fences[i]);
+    CheckVkResult(vkr);
+  }
+
+  size_t oldest = 0;
+
+  auto finishOldest = [&]() {
+    size_t slot = oldest % RingSize;
+
+    bytebuf data;
+    if(queued[slot])
+    {
+      VkResult vkr = vt->WaitForFences(Unwrap(dev), 1, &fences[slot], VK_TRUE, UINT64_MAX);
+      CheckVkResult(vkr);
+      vkr = vt->ResetFences(Unwrap(dev), 1, &fences[slot]);
+      CheckVkResult(vkr);
+
+      FinishTextureReadback(pending[slot], data);
+    }
+    else
+    {
+      data.swap(pending[slot].cachedData);
+    }
+
+    callback(oldest, data);
+
+    pending[slot] = PendingTextureReadback();
+    queued[slot] = false;
+    oldest++;
+  };
+
+  for(size_t i = 0; i < readbacks.size(); i++)
+  {
+    if(i - oldest == RingSize)
+      finishOldest();
+
+    size_t slot = i % RingSize;
+
+    // MSAA readbacks use shared resources so the previous sample has finished and been cached
+    if(GetCachedMSAAReadback(readbacks[i].tex, readbacks[i].sub, readbacks[i].params,
+                             pending[slot].cachedData))
+    {
+      queued[slot] = false;
+      continue;
+    }
+
+    queued[slot] = QueueTextureReadback(readbacks[i].tex, readbacks[i].sub, readbacks[i].params,
+                                        pending[slot]);
+
+    if(!queued[slot])
+      continue;
+
+    // an empty submit signals the fence once all previously submitted work has completed
+    VkResult vkr = ObjDisp(m_pDriver->GetQ())
+                       ->QueueSubmit(Unwrap(m_pDriver->GetQ()), 0, NULL, fences[slot]);
+    CheckVkResult(vkr);
+
+    // anything using the shared rendering resources can't be overlapped with the next readback,
+    // as it would overwrite the same descriptors and constants while they're still in use
+    if(pending[slot].usedSharedResources)
+    {
+      while(oldest <= i)
+        finishOldest();
+    }
+  }
+
+  while(oldest < readbacks.size())
+    finishOldest();
+
+  // recycle the command buffers used by the readbacks
+  m_pDriver->FlushQ();
+
+  for(size_t i = 0; i < RingSize; i++)
+    vt->DestroyFence(Unwrap(dev), fences[i], NULL);
+}
+
+bool VulkanReplay::GetCachedMSAAReadback(ResourceId tex, const Subresource &sub,
+                                         const GetTextureDataParams &params, bytebuf &data)
+{
+  if(params.remap != RemapTexture::NoRemap || params.resolve)
+    return false;
+
+  auto it = m_MSAAReadbackCache.find({tex, sub.slice, params.standardLayout});
+  if(it == m_MSAAReadbackCache.end() || sub.sample >= it->second.size())
+    return false;
+
+  data = it->second[sub.sample];
+  return true;
+}
+
+void VulkanReplay::ClearMSAAReadbackCache()
+{
+  m_MSAAReadbackCache.clear();
+  m_MSAAReadbackCacheBytes = 0;
+}
+
+bool VulkanReplay::QueueTextureReadback(ResourceId tex, const Subresource &sub,
+                                        const GetTextureDataParams &params,
+                                        PendingTextureReadback &readback)
 {
   bool wasms = false;
   bool resolve = params.resolve;
@@ -3263,14 +3640,14 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
   if(m_pDriver->m_CreationInfo.m_Image.find(tex) == m_pDriver->m_CreationInfo.m_Image.end())
   {
     RDCERR("Trying to get texture data for unknown ID %s!", ToStr(tex).c_str());
-    return;
+    return false;
   }
 
   const VulkanCreationInfo::Image &imInfo = m_pDriver->m_CreationInfo.m_Image[tex];
 
   LockedConstImageStateRef lockedImage = m_pDriver->FindConstImageState(tex);
   if(!lockedImage || !lockedImage->isMemoryBound)
-    return;
+    return false;
   const ImageState *srcImageState = &*lockedImage;
   ImageState tmpImageState;
 
@@ -3325,7 +3702,7 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
   const VkDevDispatchTable *vt = ObjDisp(dev);
 
   if(cmd == VK_NULL_HANDLE)
-    return;
+    return false;
 
   VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
                                         VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
@@ -3433,7 +3810,7 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
     CheckVkResult(vkr);
 
     if(vkr != VK_SUCCESS)
-      return;
+      return false;
 
     vkr = vt->BindImageMemory(Unwrap(dev), tmpImage, tmpMemory, 0);
     CheckVkResult(vkr);
@@ -3635,7 +4012,7 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
     cmd = m_pDriver->GetNextCmd();
 
     if(cmd == VK_NULL_HANDLE)
-      return;
+      return false;
 
     vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
     CheckVkResult(vkr);
@@ -3683,7 +4060,7 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
     CheckVkResult(vkr);
 
     if(vkr != VK_SUCCESS)
-      return;
+      return false;
 
     vkr = vt->BindImageMemory(Unwrap(dev), tmpImage, tmpMemory, 0);
     CheckVkResult(vkr);
@@ -3733,7 +4110,7 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
       cmd = m_pDriver->GetNextCmd();
 
       if(cmd == VK_NULL_HANDLE)
-        return;
+        return false;
 
       vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
       CheckVkResult(vkr);
@@ -3752,6 +4129,21 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
     dataSize = GetByteSize(imInfo.extent.width, imInfo.extent.height, imInfo.extent.depth,
                            imCreateInfo.format, s.mip);
 
+    // convert every sample at once so the others can be read from the cache. Samples are packed
+    // at dword offsets by the shader, so this only works when they're a whole number of dwords.
+    readback.allSamples = !isDepth && !isStencil && (dataSize % 4) == 0 &&
+                          size_t(dataSize) * imInfo.samples <= MaxMSAAReadbackCacheBytes;
+
+    if(readback.allSamples)
+    {
+      readback.tex = tex;
+      readback.slice = s.slice;
+      readback.sample = s.sample;
+      readback.numSamples = imInfo.samples;
+
+      dataSize *= imInfo.samples;
+    }
+
     // buffer size needs to be align to the int for shader writing
     VkBufferCreateInfo bufInfo = {VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO, NULL, 0,
                                   AlignUp(dataSize, 4U), VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
@@ -3773,7 +4165,7 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
     CheckVkResult(vkr);
 
     if(vkr != VK_SUCCESS)
-      return;
+      return false;
 
     vkr = vt->BindBufferMemory(Unwrap(dev), readbackBuf, readbackMem, 0);
     CheckVkResult(vkr);
@@ -3790,14 +4182,18 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
     vkr = vt->EndCommandBuffer(Unwrap(cmd));
     CheckVkResult(vkr);
 
-    GetDebugManager()->CopyTex2DMSToBuffer(readbackBuf, srcImage, imCreateInfo.extent, s.slice, 1,
-                                           s.sample, 1, imCreateInfo.format);
+    if(readback.allSamples)
+      GetDebugManager()->CopyTex2DMSToBuffer(readbackBuf, srcImage, imCreateInfo.extent, s.slice,
+                                             1, 0, imInfo.samples, imCreateInfo.format);
+    else
+      GetDebugManager()->CopyTex2DMSToBuffer(readbackBuf, srcImage, imCreateInfo.extent, s.slice,
+                                             1, s.sample, 1, imCreateInfo.format);
 
     // fetch a new command buffer for copy & readback
     cmd = m_pDriver->GetNextCmd();
 
     if(cmd == VK_NULL_HANDLE)
-      return;
+      return false;
 
     vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
     CheckVkResult(vkr);
@@ -3819,7 +4215,7 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
       cmd = m_pDriver->GetNextCmd();
 
       if(cmd == VK_NULL_HANDLE)
-        return;
+        return false;
 
       vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
       CheckVkResult(vkr);
@@ -3939,7 +4335,7 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
     CheckVkResult(vkr);
 
     if(vkr != VK_SUCCESS)
-      return;
+      return false;
 
     vkr = vt->BindBufferMemory(Unwrap(dev), readbackBuf, readbackMem, 0);
     CheckVkResult(vkr);
@@ -3987,7 +4383,7 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
         cmd = m_pDriver->GetNextCmd();
 
         if(cmd == VK_NULL_HANDLE)
-          return;
+          return false;
 
         vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
         CheckVkResult(vkr);
@@ -4013,11 +4409,41 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
   vt->EndCommandBuffer(Unwrap(cmd));
 
   m_pDriver->SubmitCmds();
-  m_pDriver->FlushQ();
+
+  readback.params = params;
+  readback.readbackBuf = readbackBuf;
+  readback.readbackMem = readbackMem;
+  readback.dataSize = dataSize;
+  readback.stencilOffset = stencilOffset;
+  readback.imageFormat = imInfo.format;
+  readback.format = imCreateInfo.format;
+  readback.extent = imCreateInfo.extent;
+  readback.mip = s.mip;
+  readback.isDepth = isDepth;
+  readback.isStencil = isStencil;
+  readback.copyToBuffer = copyToBuffer;
+  readback.usedSharedResources = (params.remap != RemapTexture::NoRemap) || (wasms && !resolve);
+  readback.tmpImage = tmpImage;
+  readback.wrappedTmpImage = wrappedTmpImage;
+  readback.tmpMemory = tmpMemory;
+  readback.tmpFB = tmpFB;
+  readback.tmpView = tmpView;
+  readback.numFBs = numFBs;
+  readback.tmpRP = tmpRP;
+  readback.tmpRPStencil = tmpRPStencil;
+
+  return true;
+}
+
+void VulkanReplay::FinishTextureReadback(PendingTextureReadback &readback, bytebuf &data)
+{
+  VkDevice dev = m_pDriver->GetDev();
+  const VkDevDispatchTable *vt = ObjDisp(dev);
 
   // map the buffer and copy to return buffer
   byte *pData = NULL;
-  vkr = vt->MapMemory(Unwrap(dev), readbackMem, 0, VK_WHOLE_SIZE, 0, (void **)&pData);
+  VkResult vkr =
+      vt->MapMemory(Unwrap(dev), readback.readbackMem, 0, VK_WHOLE_SIZE, 0, (void **)&pData);
   CheckVkResult(vkr);
   if(vkr != VK_SUCCESS)
     return;
@@ -4029,7 +4455,7 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
   }
 
   VkMappedMemoryRange range = {
-      VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, NULL, readbackMem, 0, VK_WHOLE_SIZE,
+      VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, NULL, readback.readbackMem, 0, VK_WHOLE_SIZE,
   };
 
   vkr = vt->InvalidateMappedMemoryRanges(Unwrap(dev), 1, &range);
@@ -4037,35 +4463,35 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
 
   RDCASSERT(pData != NULL);
 
-  data.resize(dataSize);
+  data.resize(readback.dataSize);
 
-  if(params.remap == RemapTexture::RGBA32 && IsDepthAndStencilFormat(imInfo.format))
+  if(readback.params.remap == RemapTexture::RGBA32 && IsDepthAndStencilFormat(readback.imageFormat))
   {
-    memcpy(data.data(), pData, dataSize);
+    memcpy(data.data(), pData, readback.dataSize);
 
     Vec4f *output = (Vec4f *)data.data();
     Vec4u *input = (Vec4u *)pData;
-    for(size_t i = 0; i < dataSize / sizeof(Vec4u); i++)
+    for(size_t i = 0; i < readback.dataSize / sizeof(Vec4u); i++)
       output[i].y = float(input[i].y) / 255.0f;
   }
-  else if(isDepth && isStencil && copyToBuffer)
+  else if(readback.isDepth && readback.isStencil && readback.copyToBuffer)
   {
     // We only need to manually interleave if we use CmdCopyImageToBuffer.
     // CopyDepthTex2DMS2Buffer will produce interleaved results.
-    size_t pixelCount = std::max(1U, imCreateInfo.extent.width >> s.mip) *
-                        std::max(1U, imCreateInfo.extent.height >> s.mip) *
-                        std::max(1U, imCreateInfo.extent.depth >> s.mip);
+    size_t pixelCount = std::max(1U, readback.extent.width >> readback.mip) *
+                        std::max(1U, readback.extent.height >> readback.mip) *
+                        std::max(1U, readback.extent.depth >> readback.mip);
 
     // for some reason reading direct from mapped memory here is *super* slow on android (1.5s to
     // iterate over the image), so we memcpy to a temporary buffer.
     rdcarray<byte> tmp;
-    tmp.resize((size_t)stencilOffset + pixelCount * sizeof(uint8_t));
+    tmp.resize((size_t)readback.stencilOffset + pixelCount * sizeof(uint8_t));
     memcpy(tmp.data(), pData, tmp.size());
 
-    if(imCreateInfo.format == VK_FORMAT_D16_UNORM_S8_UINT)
+    if(readback.format == VK_FORMAT_D16_UNORM_S8_UINT)
     {
       uint16_t *dSrc = (uint16_t *)tmp.data();
-      uint8_t *sSrc = (uint8_t *)(tmp.data() + stencilOffset);
+      uint8_t *sSrc = (uint8_t *)(tmp.data() + readback.stencilOffset);
 
       uint16_t *dDst = (uint16_t *)data.data();
       uint16_t *sDst = dDst + 1;    // interleaved, next pixel
@@ -4084,12 +4510,12 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
         dSrc++;
       }
     }
-    else if(imCreateInfo.format == VK_FORMAT_D24_UNORM_S8_UINT)
+    else if(readback.format == VK_FORMAT_D24_UNORM_S8_UINT)
     {
       // we can copy the depth from D24 as a 32-bit integer, since the remaining bits are garbage
       // and we overwrite them with stencil
       uint32_t *dSrc = (uint32_t *)tmp.data();
-      uint8_t *sSrc = (uint8_t *)(tmp.data() + stencilOffset);
+      uint8_t *sSrc = (uint8_t *)(tmp.data() + readback.stencilOffset);
 
       uint32_t *dst = (uint32_t *)data.data();
 
@@ -4106,7 +4532,7 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
     else
     {
       uint32_t *dSrc = (uint32_t *)tmp.data();
-      uint8_t *sSrc = (uint8_t *)(tmp.data() + stencilOffset);
+      uint8_t *sSrc = (uint8_t *)(tmp.data() + readback.stencilOffset);
 
       uint32_t *dDst = (uint32_t *)data.data();
       uint32_t *sDst = dDst + 1;    // interleaved, next pixel
@@ -4129,30 +4555,30 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
   }
   else
   {
-    memcpy(data.data(), pData, dataSize);
+    memcpy(data.data(), pData, readback.dataSize);
 
     // vulkan's bitpacking of some layouts puts alpha in the low bits, which is not our 'standard'
     // layout and is not representable in our resource formats
-    if(params.standardLayout)
+    if(readback.params.standardLayout)
     {
-      if(imCreateInfo.format == VK_FORMAT_R4G4B4A4_UNORM_PACK16 ||
-         imCreateInfo.format == VK_FORMAT_B4G4R4A4_UNORM_PACK16)
+      if(readback.format == VK_FORMAT_R4G4B4A4_UNORM_PACK16 ||
+         readback.format == VK_FORMAT_B4G4R4A4_UNORM_PACK16)
       {
         uint16_t *ptr = (uint16_t *)data.data();
 
-        for(uint32_t i = 0; i < dataSize; i += sizeof(uint16_t))
+        for(uint32_t i = 0; i < readback.dataSize; i += sizeof(uint16_t))
         {
           const uint16_t val = *ptr;
           *ptr = (val >> 4) | ((val & 0xf) << 12);
           ptr++;
         }
       }
-      else if(imCreateInfo.format == VK_FORMAT_R5G5B5A1_UNORM_PACK16 ||
-              imCreateInfo.format == VK_FORMAT_B5G5R5A1_UNORM_PACK16)
+      else if(readback.format == VK_FORMAT_R5G5B5A1_UNORM_PACK16 ||
+              readback.format == VK_FORMAT_B5G5R5A1_UNORM_PACK16)
       {
         uint16_t *ptr = (uint16_t *)data.data();
 
-        for(uint32_t i = 0; i < dataSize; i += sizeof(uint16_t))
+        for(uint32_t i = 0; i < readback.dataSize; i += sizeof(uint16_t))
         {
           const uint16_t val = *ptr;
           *ptr = (val >> 1) | ((val & 0x1) << 15);
@@ -4162,33 +4588,50 @@ void VulkanReplay::GetTextureData(ResourceId tex, const Subresource &sub,
     }
   }
 
-  vt->UnmapMemory(Unwrap(dev), readbackMem);
+  vt->UnmapMemory(Unwrap(dev), readback.readbackMem);
+
+  if(readback.allSamples)
+  {
+    const size_t sampleSize = readback.dataSize / readback.numSamples;
+
+    if(m_MSAAReadbackCacheBytes + readback.dataSize > MaxMSAAReadbackCacheBytes)
+      ClearMSAAReadbackCache();
+
+    rdcarray<bytebuf> &samples =
+        m_MSAAReadbackCache[{readback.tex, readback.slice, readback.params.standardLayout}];
+    samples.resize(readback.numSamples);
+    for(uint32_t i = 0; i < readback.numSamples; i++)
+      samples[i].assign(data.data() + sampleSize * i, sampleSize);
+    m_MSAAReadbackCacheBytes += readback.dataSize;
+
+    data = samples[readback.sample];
+  }
 
   // clean up temporary objects
-  vt->DestroyBuffer(Unwrap(dev), readbackBuf, NULL);
-  vt->FreeMemory(Unwrap(dev), readbackMem, NULL);
+  vt->DestroyBuffer(Unwrap(dev), readback.readbackBuf, NULL);
+  vt->FreeMemory(Unwrap(dev), readback.readbackMem, NULL);
 
-  if(tmpImage != VK_NULL_HANDLE)
+  if(readback.tmpImage != VK_NULL_HANDLE)
   {
-    GetResourceManager()->ReleaseWrappedResource(wrappedTmpImage, true);
-    vt->DestroyImage(Unwrap(dev), tmpImage, NULL);
-    vt->FreeMemory(Unwrap(dev), tmpMemory, NULL);
+    GetResourceManager()->ReleaseWrappedResource(readback.wrappedTmpImage, true);
+    vt->DestroyImage(Unwrap(dev), readback.tmpImage, NULL);
+    vt->FreeMemory(Unwrap(dev), readback.tmpMemory, NULL);
   }
 
-  if(tmpFB != NULL)
+  if(readback.tmpFB != NULL)
   {
-    if(IsStencilFormat(imInfo.format))
-      numFBs *= 2;
+    if(IsStencilFormat(readback.imageFormat))
+      readback.numFBs *= 2;
 
-    for(uint32_t i = 0; i < numFBs; i++)
+    for(uint32_t i = 0; i < readback.numFBs; i++)
     {
-      vt->DestroyFramebuffer(Unwrap(dev), tmpFB[i], NULL);
-      vt->DestroyImageView(Unwrap(dev), tmpView[i], NULL);
+      vt->DestroyFramebuffer(Unwrap(dev), readback.tmpFB[i], NULL);
+      vt->DestroyImageView(Unwrap(dev), readback.tmpView[i], NULL);
     }
-    delete[] tmpFB;
-    delete[] tmpView;
-    vt->DestroyRenderPass(Unwrap(dev), tmpRP, NULL);
-    vt->DestroyRenderPass(Unwrap(dev), tmpRPStencil, NULL);
+    delete[] readback.tmpFB;
+    delete[] readback.tmpView;
+    vt->DestroyRenderPass(Unwrap(dev), readback.tmpRP, NULL);
+    vt->DestroyRenderPass(Unwrap(dev), readback.tmpRPStencil, NULL);
   }
 }
 
@@ -4324,12 +4767,10 @@ void VulkanReplay::BuildTargetShader(ShaderEncoding sourceEncoding, const bytebu
         return;
     }
 
-    rdcarray<rdcstr> sources;
-    sources.push_back(rdcstr((char *)source.begin(), source.size()));
-
     rdcspv::CompilationSettings settings(rdcspv::InputLanguage::VulkanGLSL, stage);
 
-    rdcstr output = rdcspv::Compile(settings, sources, spirv);
+    rdcstr output = m_pDriver->GetShaderCache()->GetCustomSPIRV(
+        settings, rdcstr((char *)source.begin(), source.size()), spirv);
 
     if(spirv.empty())
     {
@@ -4377,6 +4818,7 @@ void VulkanReplay::ReplaceResource(ResourceId from, ResourceId to)
 
   ClearPostVSCache();
   ClearFeedbackCache();
+  m_Overlay.m_QuadPass.Release(m_pDriver);
 }
 
 void VulkanReplay::RemoveReplacement(ResourceId id)
@@ -4389,25 +4831,24 @@ void VulkanReplay::RemoveReplacement(ResourceId id)
 
     ClearPostVSCache();
     ClearFeedbackCache();
+    m_Overlay.m_QuadPass.Release(m_pDriver);
   }
 }
 
 void VulkanReplay::RefreshDerivedReplacements()
 {
-  VkDevice dev = m_pDriver->GetDev();
-
   VulkanResourceManager *rm = m_pDriver->GetResourceManager();
 
-  // we defer deletes of old replaced resources since it will invalidate elements in the vector
-  // we're iterating
-  rdcarray<VkPipeline> deletequeue;
+  m_pDriver->m_PendingPipelineReplacements.clear();
 
-  // remake and replace any pipelines that reference a replaced shader
+  // find any pipelines that reference a replaced shader. Their replacements aren't created here,
+  // since most captures have far more pipelines than are used in any one replay and each can take
+  // a long time to compile. Instead they're created when they're first bound, in
+  // CreateReplacementPipeline
   for(auto it = m_pDriver->m_CreationInfo.m_Pipeline.begin();
       it != m_pDriver->m_CreationInfo.m_Pipeline.end(); ++it)
   {
     ResourceId pipesrcid = it->first;
-    const VulkanCreationInfo::Pipeline &pipeInfo = it->second;
 
     ResourceId origsrcid = rm->GetOriginalID(pipesrcid);
 
@@ -4415,103 +4856,93 @@ void VulkanReplay::RefreshDerivedReplacements()
     if(origsrcid == pipesrcid)
       continue;
 
-    // if this pipeline has a replacement, remove it and delete the program generated for it
+    // if this pipeline has a replacement, remove it. The pipeline itself is kept in
+    // m_ReplacementPipelines in case the same shaders are used again
     if(rm->HasReplacement(origsrcid))
-    {
-      deletequeue.push_back(rm->GetLiveHandle<VkPipeline>(origsrcid));
-
       rm->RemoveReplacement(origsrcid);
-    }
 
-    bool usesReplacedShader = false;
     for(size_t i = 0; i < ARRAY_COUNT(it->second.shaders); i++)
     {
       if(rm->HasReplacement(rm->GetOriginalID(it->second.shaders[i].module)))
       {
-        usesReplacedShader = true;
+        m_pDriver->m_PendingPipelineReplacements.insert(pipesrcid);
         break;
       }
     }
+  }
+}
 
-    // if there are replaced shaders in use, create a new pipeline with any/all replaced shaders.
-    if(usesReplacedShader)
-    {
-      VkPipeline pipe = VK_NULL_HANDLE;
+VkPipeline VulkanReplay::CreateReplacementPipeline(ResourceId pipesrcid)
+{
+  VkDevice dev = m_pDriver->GetDev();
 
-      // check if this is a graphics or compute pipeline
-      if(pipeInfo.graphicsPipe)
-      {
-        VkGraphicsPipelineCreateInfo pipeCreateInfo;
-        m_pDriver->GetShaderCache()->MakeGraphicsPipelineInfo(pipeCreateInfo, it->first);
+  VulkanResourceManager *rm = m_pDriver->GetResourceManager();
 
-        rdcarray<rdcstr> entrynames;
-        entrynames.reserve(pipeCreateInfo.stageCount);
+  m_pDriver->m_PendingPipelineReplacements.erase(pipesrcid);
 
-        // replace the modules by going via the live ID to pick up any replacements
-        for(uint32_t i = 0; i < pipeCreateInfo.stageCount; i++)
-        {
-          VkPipelineShaderStageCreateInfo &sh =
-              (VkPipelineShaderStageCreateInfo &)pipeCreateInfo.pStages[i];
+  const VulkanCreationInfo::Pipeline &pipeInfo = m_pDriver->m_CreationInfo.m_Pipeline[pipesrcid];
 
-          ResourceId shadOrigId = rm->GetOriginalID(GetResID(sh.module));
+  // the replacement depends only on the contents of the shaders bound to it, so hash those to see
+  // if we've made this pipeline before. This is common when iterating on an edit and reverting it,
+  // or toggling between a few versions of a shader.
+  MD5_CTX md5ctx = {};
+  MD5_Init(&md5ctx);
 
-          sh.module = rm->GetLiveHandle<VkShaderModule>(shadOrigId);
+  for(size_t i = 0; i < ARRAY_COUNT(pipeInfo.shaders); i++)
+  {
+    ResourceId mod = pipeInfo.shaders[i].module;
+    if(mod == ResourceId())
+      continue;
 
-          if(rm->HasReplacement(shadOrigId))
-          {
-            rdcarray<ShaderEntryPoint> entries =
-                m_pDriver->m_CreationInfo.m_ShaderModule[GetResID(sh.module)].spirv.EntryPoints();
-            if(entries.size() > 1)
-            {
-              if(entries.contains({sh.pName, ShaderStage(StageIndex(sh.stage))}))
-              {
-                // nothing to do!
-              }
-              else
-              {
-                RDCWARN(
-                    "Multiple entry points in edited shader, none matching original, using first "
-                    "one '%s'",
-                    entries[0].name.c_str());
-                entrynames.push_back(entries[0].name);
-                sh.pName = entrynames.back().c_str();
-              }
-            }
-            else
-            {
-              entrynames.push_back(entries[0].name);
-              sh.pName = entrynames.back().c_str();
-            }
-          }
-        }
+    ResourceId liveMod = GetResID(rm->GetLiveHandle<VkShaderModule>(rm->GetOriginalID(mod)));
 
-        // if we have pipeline executable properties, capture the data
-        if(m_pDriver->GetExtensions(NULL).ext_KHR_pipeline_executable_properties)
-        {
-          pipeCreateInfo.flags |= (VK_PIPELINE_CREATE_CAPTURE_STATISTICS_BIT_KHR |
-                                   VK_PIPELINE_CREATE_CAPTURE_INTERNAL_REPRESENTATIONS_BIT_KHR);
-        }
+    const rdcarray<uint32_t> &spirv =
+        m_pDriver->m_CreationInfo.m_ShaderModule[liveMod].spirv.GetSPIRV();
+    MD5_Update(&md5ctx, &i, sizeof(i));
+    MD5_Update(&md5ctx, spirv.data(), (unsigned long)(spirv.size() * sizeof(uint32_t)));
+  }
 
-        // create the new graphics pipeline
-        VkResult vkr = m_pDriver->vkCreateGraphicsPipelines(dev, VK_NULL_HANDLE, 1, &pipeCreateInfo,
-                                                            NULL, &pipe);
-        CheckVkResult(vkr);
-      }
-      else
+  ShaderCacheHash128 key;
+  MD5_Final((unsigned char *)key.hash, &md5ctx);
+
+  rdcarray<ReplacementPipeline> &cache = m_ReplacementPipelines[pipesrcid];
+
+  VkPipeline pipe = VK_NULL_HANDLE;
+
+  for(const ReplacementPipeline &p : cache)
+  {
+    if(p.key == key)
+    {
+      pipe = p.pipe;
+      break;
+    }
+  }
+
+  if(pipe == VK_NULL_HANDLE)
+  {
+    // check if this is a graphics or compute pipeline
+    if(pipeInfo.graphicsPipe)
+    {
+      VkGraphicsPipelineCreateInfo pipeCreateInfo;
+      m_pDriver->GetShaderCache()->MakeGraphicsPipelineInfo(pipeCreateInfo, pipesrcid);
+
+      rdcarray<rdcstr> entrynames;
+      entrynames.reserve(pipeCreateInfo.stageCount);
+
+      // replace the modules by going via the live ID to pick up any replacements
+      for(uint32_t i = 0; i < pipeCreateInfo.stageCount; i++)
       {
-        VkComputePipelineCreateInfo pipeCreateInfo;
-        m_pDriver->GetShaderCache()->MakeComputePipelineInfo(pipeCreateInfo, it->first);
+        VkPipelineShaderStageCreateInfo &sh =
+            (VkPipelineShaderStageCreateInfo &)pipeCreateInfo.pStages[i];
 
-        // replace the module by going via the live ID to pick up any replacements
-        VkPipelineShaderStageCreateInfo &sh = pipeCreateInfo.stage;
-        ResourceId shadOrigId = rm->GetOriginalID(pipeInfo.shaders[5].module);
-        sh.module = rm->GetLiveHandle<VkShaderModule>(shadOrigId);
+        ResourceId shadOrigId = rm->GetOriginalID(GetResID(sh.module));
 
-        rdcarray<ShaderEntryPoint> entries;
+        sh.module = rm->GetLiveHandle<VkShaderModule>(shadOrigId);
 
         if(rm->HasReplacement(shadOrigId))
         {
-          entries = m_pDriver->m_CreationInfo.m_ShaderModule[GetResID(sh.module)].spirv.EntryPoints();
+          rdcarray<ShaderEntryPoint> entries =
+              m_pDriver->m_CreationInfo.m_ShaderModule[GetResID(sh.module)].spirv.EntryPoints();
           if(entries.size() > 1)
           {
             if(entries.contains({sh.pName, ShaderStage(StageIndex(sh.stage))}))
@@ -4524,35 +4955,93 @@ void VulkanReplay::RefreshDerivedReplacements()
                   "Multiple entry points in edited shader, none matching original, using first "
                   "one '%s'",
                   entries[0].name.c_str());
-              sh.pName = entries[0].name.c_str();
+              entrynames.push_back(entries[0].name);
+              sh.pName = entrynames.back().c_str();
             }
           }
           else
           {
-            sh.pName = entries[0].name.c_str();
+            entrynames.push_back(entries[0].name);
+            sh.pName = entrynames.back().c_str();
           }
         }
+      }
+
+      // if we have pipeline executable properties, capture the data
+      if(m_pDriver->GetExtensions(NULL).ext_KHR_pipeline_executable_properties)
+      {
+        pipeCreateInfo.flags |= (VK_PIPELINE_CREATE_CAPTURE_STATISTICS_BIT_KHR |
+                                 VK_PIPELINE_CREATE_CAPTURE_INTERNAL_REPRESENTATIONS_BIT_KHR);
+      }
 
-        // if we have pipeline executable properties, capture the data
-        if(m_pDriver->GetExtensions(NULL).ext_KHR_pipeline_executable_properties)
+      // create the new graphics pipeline
+      VkResult vkr = m_pDriver->vkCreateGraphicsPipelines(dev, VK_NULL_HANDLE, 1, &pipeCreateInfo,
+                                                          NULL, &pipe);
+      CheckVkResult(vkr);
+    }
+    else
+    {
+      VkComputePipelineCreateInfo pipeCreateInfo;
+      m_pDriver->GetShaderCache()->MakeComputePipelineInfo(pipeCreateInfo, pipesrcid);
+
+      // replace the module by going via the live ID to pick up any replacements
+      VkPipelineShaderStageCreateInfo &sh = pipeCreateInfo.stage;
+      ResourceId shadOrigId = rm->GetOriginalID(pipeInfo.shaders[5].module);
+      sh.module = rm->GetLiveHandle<VkShaderModule>(shadOrigId);
+
+      rdcarray<ShaderEntryPoint> entries;
+
+      if(rm->HasReplacement(shadOrigId))
+      {
+        entries = m_pDriver->m_CreationInfo.m_ShaderModule[GetResID(sh.module)].spirv.EntryPoints();
+        if(entries.size() > 1)
         {
-          pipeCreateInfo.flags |= (VK_PIPELINE_CREATE_CAPTURE_STATISTICS_BIT_KHR |
-                                   VK_PIPELINE_CREATE_CAPTURE_INTERNAL_REPRESENTATIONS_BIT_KHR);
+          if(entries.contains({sh.pName, ShaderStage(StageIndex(sh.stage))}))
+          {
+            // nothing to do!
+          }
+          else
+          {
+            RDCWARN(
+                "Multiple entry points in edited shader, none matching original, using first "
+                "one '%s'",
+                entries[0].name.c_str());
+            sh.pName = entries[0].name.c_str();
+          }
         }
+        else
+        {
+          sh.pName = entries[0].name.c_str();
+        }
+      }
 
-        // create the new compute pipeline
-        VkResult vkr = m_pDriver->vkCreateComputePipelines(dev, VK_NULL_HANDLE, 1, &pipeCreateInfo,
-                                                           NULL, &pipe);
-        CheckVkResult(vkr);
+      // if we have pipeline executable properties, capture the data
+      if(m_pDriver->GetExtensions(NULL).ext_KHR_pipeline_executable_properties)
+      {
+        pipeCreateInfo.flags |= (VK_PIPELINE_CREATE_CAPTURE_STATISTICS_BIT_KHR |
+                                 VK_PIPELINE_CREATE_CAPTURE_INTERNAL_REPRESENTATIONS_BIT_KHR);
       }
 
-      // remove the replacements
-      rm->ReplaceResource(origsrcid, GetResID(pipe));
+      // create the new compute pipeline
+      VkResult vkr = m_pDriver->vkCreateComputePipelines(dev, VK_NULL_HANDLE, 1, &pipeCreateInfo,
+                                                         NULL, &pipe);
+      CheckVkResult(vkr);
     }
+
+
+    // only keep the most recent few variants of each pipeline
+    if(cache.size() >= MaxReplacementPipelineVariants)
+    {
+      m_pDriver->vkDestroyPipeline(dev, cache[0].pipe, NULL);
+      cache.erase(0);
+    }
+
+    cache.push_back({key, pipe});
   }
 
-  for(VkPipeline pipe : deletequeue)
-    m_pDriver->vkDestroyPipeline(dev, pipe, NULL);
+  rm->ReplaceResource(rm->GetOriginalID(pipesrcid), GetResID(pipe));
+
+  return pipe;
 }
 
 ResourceId VulkanReplay::CreateProxyTexture(const TextureDescription &templateTex)
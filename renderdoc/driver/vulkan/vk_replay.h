@@ -25,6 +25,7 @@
 #pragma once
 
 #include "api/replay/renderdoc_replay.h"
+#include "common/shader_cache.h"
 #include "core/core.h"
 #include "replay/replay_driver.h"
 #include "vk_common.h"
@@ -151,6 +152,8 @@ class VulkanDebugManager;
 class VulkanResourceManager;
 struct VulkanStatePipeline;
 struct VulkanAMDActionCallback;
+struct VulkanActionCallback;
+struct VKFeedbackInstrumentation;
 
 class NVVulkanCounters;
 
@@ -213,6 +216,29 @@ struct VulkanPostVSData
   }
 };
 
+// a vertex output fetch that has been submitted but not yet waited on. When fetching a whole pass
+// these are completed together at the end so the GPU isn't drained once per draw.
+struct VulkanPostVSPendingFetch
+{
+  uint32_t eventId = 0;
+
+  VkBuffer readbackBuffer = VK_NULL_HANDLE;
+  VkDeviceMemory readbackMem = VK_NULL_HANDLE;
+  uint32_t numVerts = 0;
+  uint32_t bufStride = 0;
+  bool hasPosOut = false;
+
+  // temporary objects used by the fetch, destroyed once it has completed
+  rdcarray<VkBuffer> tempBuffers;
+  rdcarray<VkDeviceMemory> tempMems;
+  VkDescriptorPool descpool = VK_NULL_HANDLE;
+  rdcarray<VkDescriptorSet> descSets;
+  rdcarray<VkDescriptorSetLayout> setLayouts;
+  VkPipelineLayout pipeLayout = VK_NULL_HANDLE;
+  VkPipeline pipe = VK_NULL_HANDLE;
+  VkShaderModule module = VK_NULL_HANDLE;
+};
+
 struct VKDynamicShaderFeedback
 {
   bool compute = false, valid = false;
@@ -278,6 +304,11 @@ public:
   void CreateResources();
   void DestroyResources();
 
+  // resources for features that most replays never use - particularly scripted or headless ones -
+  // are created the first time they're needed rather than in CreateResources
+  void InitHistogramResources();
+  void InitPixelHistoryResources();
+
   DriverInformation GetDriverInfo() { return m_DriverInfo; }
   rdcarray<GPUDevice> GetAvailableGPUs();
   APIProperties GetAPIProperties();
@@ -299,7 +330,7 @@ public:
 
   rdcarray<EventUsage> GetUsage(ResourceId id);
 
-  ShaderDebugData &GetShaderDebugData() { return m_ShaderDebugData; }
+  ShaderDebugData &GetShaderDebugData();
   FrameRecord &WriteFrameRecord() { return m_FrameRecord; }
   FrameRecord GetFrameRecord() { return m_FrameRecord; }
   rdcarray<DebugMessage> GetDebugMessages();
@@ -310,6 +341,10 @@ public:
     m_VulkanPipelineState = vk;
   }
   void SavePipelineState(uint32_t eventId);
+  rdcarray<VKPipe::BindingElement> GetVulkanDescriptors(bool compute, uint32_t set,
+                                                        uint32_t binding, uint32_t firstElement,
+                                                        uint32_t count);
+  rdcarray<uint32_t> GetVulkanUsedDescriptors(bool compute, uint32_t set, uint32_t binding);
   void FreeTargetResource(ResourceId id);
 
   RDResult ReadLogInitialisation(RDCFile *rdc, bool storeStructuredBuffers);
@@ -341,6 +376,8 @@ public:
 
   void PickPixel(ResourceId texture, uint32_t x, uint32_t y, const Subresource &sub,
                  CompType typeCast, float pixel[4]);
+  bool PickPixelTile(ResourceId texture, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                     const Subresource &sub, CompType typeCast, rdcarray<float> &pixels);
   bool GetMinMax(ResourceId texid, const Subresource &sub, CompType typeCast, float *minval,
                  float *maxval);
   bool GetHistogram(ResourceId texid, const Subresource &sub, CompType typeCast, float minval,
@@ -355,6 +392,7 @@ public:
   void InitPostVSBuffers(uint32_t eventId);
   void InitPostVSBuffers(uint32_t eventId, VulkanRenderState state);
   void InitPostVSBuffers(const rdcarray<uint32_t> &passEvents);
+  PostVSCacheStatistics GetPostVSCacheStatistics() { return m_PostVS.Cache.GetStatistics(); }
 
   // indicates that EID alias is the same as eventId
   void AliasPostVSBuffers(uint32_t eventId, uint32_t alias) { m_PostVS.Alias[alias] = eventId; }
@@ -364,8 +402,11 @@ public:
   void GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, bytebuf &retData);
   void GetTextureData(ResourceId tex, const Subresource &sub, const GetTextureDataParams &params,
                       bytebuf &data);
+  void GetTextureDataBatch(const rdcarray<TextureReadback> &readbacks,
+                           TextureReadbackCallback callback);
 
   void ReplaceResource(ResourceId from, ResourceId to);
+  VkPipeline CreateReplacementPipeline(ResourceId pipesrcid);
   void RemoveReplacement(ResourceId id);
 
   void RenderMesh(uint32_t eventId, const rdcarray<MeshFormat> &secondaryDraws,
@@ -401,10 +442,16 @@ public:
 
   rdcarray<PixelModification> PixelHistory(rdcarray<EventUsage> events, ResourceId target, uint32_t x,
                                            uint32_t y, const Subresource &sub, CompType typeCast);
+  PixelRegionHistory PixelHistoryRegion(rdcarray<EventUsage> events, ResourceId target, uint32_t x,
+                                        uint32_t y, uint32_t width, uint32_t height,
+                                        const Subresource &sub, CompType typeCast);
   ShaderDebugTrace *DebugVertex(uint32_t eventId, uint32_t vertid, uint32_t instid, uint32_t idx,
                                 uint32_t view);
   ShaderDebugTrace *DebugPixel(uint32_t eventId, uint32_t x, uint32_t y, uint32_t sample,
                                uint32_t primitive);
+  rdcarray<ShaderDebugTrace *> DebugPixels(uint32_t eventId,
+                                           const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels,
+                                           uint32_t sample, uint32_t primitive);
   ShaderDebugTrace *DebugThread(uint32_t eventId, const rdcfixedarray<uint32_t, 3> &groupid,
                                 const rdcfixedarray<uint32_t, 3> &threadid);
   rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger);
@@ -452,6 +499,11 @@ public:
   bool DepthCubeSupported() { return m_TexRender.DepthCubesSupported; }
 private:
   bool FetchShaderFeedback(uint32_t eventId);
+  bool GetDynamicDescriptorUsage(uint32_t eventId, bool compute, const BindpointIndex *&used,
+                                 size_t &usedCount);
+  void FillDescriptor(const DescSetLayout::Binding &layoutBind, uint32_t descriptorCount,
+                      uint32_t a, const DescriptorSetSlot &srcel, const uint32_t *&srcOffset,
+                      VKPipe::BindingElement &dstel);
   void ClearFeedbackCache();
 
   void PatchReservedDescriptors(const VulkanStatePipeline &pipe, VkDescriptorPool &descpool,
@@ -462,17 +514,127 @@ private:
                                 size_t newBindingsCount);
 
   void FetchVSOut(uint32_t eventId, VulkanRenderState &state);
+  void FinishVSOut(VulkanPostVSPendingFetch &fetch);
   void FetchTessGSOut(uint32_t eventId, VulkanRenderState &state);
+  void GetPostVSSourceData(ResourceId buff, uint64_t offset, uint64_t len, bytebuf &retData);
   void ClearPostVSCache();
+  void TrimPostVSCache(const rdcarray<uint32_t> &keep);
+  void ReleasePostVSData(VulkanPostVSData &data);
 
   void RefreshDerivedReplacements();
 
+  // replacement pipelines made for edited shaders, keyed by the live ID of the capture pipeline.
+  // Several variants are kept for each so that switching back to a previous edit is quick.
+  struct ReplacementPipeline
+  {
+    ShaderCacheHash128 key;
+    VkPipeline pipe;
+  };
+  static const size_t MaxReplacementPipelineVariants = 4;
+  std::map<ResourceId, rdcarray<ReplacementPipeline>> m_ReplacementPipelines;
+
   bool RenderTextureInternal(TextureDisplay cfg, const ImageState &imageState,
                              VkRenderPassBeginInfo rpbegin, int flags);
 
+  // Displaying a very large texture zoomed out samples a tiny fraction of its texels spread over
+  // the whole image, which thrashes the texture cache. Instead a slice is downsampled into a
+  // pyramid of half-size levels once, and the display samples the level closest to the zoom.
+  // Pyramids are built on first use and thrown away when the capture is replayed.
+  struct DisplayPyramid
+  {
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory mem = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+    uint32_t levels = 0;
+    VkDeviceSize size = 0;
+  };
+  static const VkDeviceSize MaxDisplayPyramidBytes = 512 * 1024 * 1024;
+  std::map<rdcpair<ResourceId, uint32_t>, DisplayPyramid> m_DisplayPyramids;
+  VkDeviceSize m_DisplayPyramidBytes = 0;
+
+  bool GetDisplayPyramid(const TextureDisplay &cfg, VkFormat castedFormat,
+                         const ImageState &imageState, VkImageView &view, uint32_t &level);
+  void ClearDisplayPyramids();
+
   bool GetMinMax(ResourceId texid, const Subresource &sub, CompType typeCast, bool stencil,
                  float *minval, float *maxval);
 
+  // a texture readback that has been recorded and submitted, but not yet mapped and copied out
+  struct PendingTextureReadback
+  {
+    GetTextureDataParams params;
+
+    VkBuffer readbackBuf = VK_NULL_HANDLE;
+    VkDeviceMemory readbackMem = VK_NULL_HANDLE;
+    uint32_t dataSize = 0;
+    VkDeviceSize stencilOffset = 0;
+
+    // the format of the texture, and the format/extent of the data that was copied after any remap
+    VkFormat imageFormat = VK_FORMAT_UNDEFINED;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    VkExtent3D extent = {};
+    uint32_t mip = 0;
+
+    bool isDepth = false;
+    bool isStencil = false;
+    bool copyToBuffer = true;
+
+    // the readback rendered or dispatched using our shared debug resources, so it must complete
+    // before any other readback can be recorded
+    bool usedSharedResources = false;
+
+    // every sample of the slice was read back, to be split up into the MSAA readback cache
+    bool allSamples = false;
+    ResourceId tex;
+    uint32_t slice = 0;
+    uint32_t sample = 0;
+    uint32_t numSamples = 0;
+
+    // for readbacks that were satisfied from the cache and not queued at all
+    bytebuf cachedData;
+
+    VkImage tmpImage = VK_NULL_HANDLE;
+    VkImage wrappedTmpImage = VK_NULL_HANDLE;
+    VkDeviceMemory tmpMemory = VK_NULL_HANDLE;
+
+    VkFramebuffer *tmpFB = NULL;
+    VkImageView *tmpView = NULL;
+    uint32_t numFBs = 0;
+    VkRenderPass tmpRP = VK_NULL_HANDLE;
+    VkRenderPass tmpRPStencil = VK_NULL_HANDLE;
+  };
+
+  bool QueueTextureReadback(ResourceId tex, const Subresource &sub,
+                            const GetTextureDataParams &params, PendingTextureReadback &readback);
+  void FinishTextureReadback(PendingTextureReadback &readback, bytebuf &data);
+
+  // The first readback of any sample in a slice of an MSAA colour texture converts all of the
+  // slice's samples in one dispatch and keeps them here, so that reading or saving each sample in
+  // turn only converts once. The contents can only change when the capture is replayed, so the
+  // cache is cleared in ReplayLog.
+  struct MSAAReadbackKey
+  {
+    ResourceId tex;
+    uint32_t slice;
+    bool standardLayout;
+
+    bool operator<(const MSAAReadbackKey &o) const
+    {
+      if(tex != o.tex)
+        return tex < o.tex;
+      if(slice != o.slice)
+        return slice < o.slice;
+      return standardLayout < o.standardLayout;
+    }
+  };
+  static const size_t MaxMSAAReadbackCacheBytes = 256 * 1024 * 1024;
+  std::map<MSAAReadbackKey, rdcarray<bytebuf>> m_MSAAReadbackCache;
+  size_t m_MSAAReadbackCacheBytes = 0;
+
+  bool GetCachedMSAAReadback(ResourceId tex, const Subresource &sub,
+                             const GetTextureDataParams &params, bytebuf &data);
+  void ClearMSAAReadbackCache();
+
   void CheckVkResult(VkResult vkr);
   VulkanDebugManager *GetDebugManager();
   VulkanResourceManager *GetResourceManager();
@@ -650,6 +812,22 @@ private:
     VkPipelineLayout m_QuadResolvePipeLayout = VK_NULL_HANDLE;
     VkPipeline m_QuadResolvePipeline[8] = {VK_NULL_HANDLE};
 
+    // the quad counts accumulated for QuadOverdrawPass are kept, so that moving on to a later event
+    // in the same pass only has to render the events since the last one
+    struct QuadPassCache
+    {
+      void Release(WrappedVulkan *driver);
+
+      VkImage Image = VK_NULL_HANDLE;
+      VkDeviceMemory Mem = VK_NULL_HANDLE;
+      VkImageView View = VK_NULL_HANDLE;
+      ResourceId TexId;
+      uint32_t Mip = 0, Slice = 0, NumSlices = 0;
+      VkExtent2D Dim = {0, 0};
+      // the events whose counts are in the image
+      rdcarray<uint32_t> Events;
+    } m_QuadPass;
+
     GPUBuffer m_TriSizeUBO;
     VkDescriptorSetLayout m_TriSizeDescSetLayout = VK_NULL_HANDLE;
     VkDescriptorSet m_TriSizeDescSet = VK_NULL_HANDLE;
@@ -683,6 +861,9 @@ private:
     GPUBuffer VB;
     GPUBuffer VBUpload;
     uint32_t IBSize = 0, VBSize = 0;
+    // identifies the mesh data currently in IB and VB, see MeshPickingKey
+    uint64_t DataKey = 0;
+    uint32_t NumIndices = 0;
     GPUBuffer Result, ResultReadback;
     VkDescriptorSetLayout DescSetLayout = VK_NULL_HANDLE;
     VkDescriptorSet DescSet = VK_NULL_HANDLE;
@@ -692,6 +873,10 @@ private:
 
   struct PixelPicking
   {
+    // the pick image is large enough to pick a whole tile at once, single pixels only render to
+    // the top-left corner
+    static const uint32_t TileSize = 64;
+
     void Init(WrappedVulkan *driver, VkDescriptorPool descriptorPool);
     void Destroy(WrappedVulkan *driver);
 
@@ -750,14 +935,38 @@ private:
 
     std::map<uint32_t, VulkanPostVSData> Data;
     std::map<uint32_t, uint32_t> Alias;
+    PostVSCacheTracker Cache;
+
+    // vertex shaders patched for output fetching, keyed by everything that affects the patching
+    struct PatchedShader
+    {
+      rdcarray<uint32_t> spirv;
+      uint32_t bufStride;
+    };
+    std::map<bytebuf, PatchedShader> PatchedShaders;
+
+    // set while a whole pass is fetched in one replay. Source buffers can't change between the
+    // draws so each one is read back once, and vertex output fetches are completed at the end.
+    bool Batching = false;
+    std::map<ResourceId, bytebuf> BatchSourceData;
+    uint64_t BatchSourceDataSize = 0;
+    rdcarray<VulkanPostVSPendingFetch> BatchPending;
   } m_PostVS;
 
   struct Feedback
   {
     void Destroy(WrappedVulkan *driver);
+    void ClearInstrumentation(WrappedVulkan *driver);
 
     GPUBuffer FeedbackBuffer;
 
+    // instrumented shaders for each pipeline, re-used between events
+    std::map<ResourceId, VKFeedbackInstrumentation *> Instrumented;
+
+    // the printf buffer starts at Vulkan_Debug_PrintfBufferSize and grows whenever an event
+    // overflows it, so that later events with as much output don't need to be run twice.
+    uint32_t PrintfBufferSize = 0;
+
     std::map<uint32_t, VKDynamicShaderFeedback> Usage;
   } m_BindlessFeedback;
 
@@ -768,6 +977,28 @@ private:
 
   VKPipe::State *m_VulkanPipelineState = NULL;
 
+  // everything the last conversion of each bound descriptor set in m_VulkanPipelineState was built
+  // from. If none of it changes by the next event the converted set is still valid, which saves
+  // rebuilding very large bindless sets every time the selected event changes.
+  struct DescriptorSetCacheEntry
+  {
+    ResourceId set;
+    ResourceId layout;
+    rdcarray<uint32_t> offsets;
+    bytebuf slots;
+    bytebuf inlineData;
+    uint32_t variableDescriptorCount = 0;
+    bool hasUsedBinds = false;
+    rdcarray<BindpointIndex> usedBinds;
+  };
+
+  // [0] is graphics, [1] is compute, parallel to the descriptorSets arrays in the pipeline state
+  rdcarray<DescriptorSetCacheEntry> m_DescriptorSetCache[2];
+  VKPipe::State *m_DescriptorSetCacheState = NULL;
+
+  // the event the pipeline state was last fetched for, which descriptors are fetched on demand at
+  uint32_t m_PipelineStateEventId = 0;
+
   DriverInformation m_DriverInfo;
 
   struct PipelineExecutables
@@ -789,9 +1020,13 @@ private:
   void CreateTexImageView(VkImage liveIm, const VulkanCreationInfo::Image &iminfo,
                           CompType typeCast, TextureDisplayViews &views);
 
-  void FillTimersAMD(uint32_t *eventStartID, uint32_t *sampleIndex, rdcarray<uint32_t> *eventIDs);
+  void FillTimersAMD(uint32_t *eventStartID, uint32_t *sampleIndex, rdcarray<uint32_t> *eventIDs,
+                     VulkanActionCallback *sharedCB);
 
-  rdcarray<CounterResult> FetchCountersAMD(const rdcarray<GPUCounter> &counters);
+  // sharedCB, if set, is run alongside the last counter pass so that its queries don't need a
+  // replay of their own. It's cleared once that has happened.
+  rdcarray<CounterResult> FetchCountersAMD(const rdcarray<GPUCounter> &counters,
+                                           VulkanActionCallback *&sharedCB);
 
   AMDCounters *m_pAMDCounters = NULL;
   AMDRGPControl *m_RGP = NULL;
@@ -802,7 +1037,8 @@ private:
   NVVulkanCounters *m_pNVCounters = NULL;
 #endif
 
-  rdcarray<CounterResult> FetchCountersKHR(const rdcarray<GPUCounter> &counters);
+  rdcarray<CounterResult> FetchCountersKHR(const rdcarray<GPUCounter> &counters,
+                                           VulkanActionCallback *&sharedCB);
 
   rdcarray<VkPerformanceCounterKHR> m_KHRCounters;
   rdcarray<VkPerformanceCounterDescriptionKHR> m_KHRCountersDescriptions;
@@ -998,6 +998,10 @@ struct ResourceInfo
     RDCERR("Unexpected aspect %s for sparse table", ToStr((VkImageAspectFlagBits)aspects).c_str());
     return sparseTable;
   }
+  const Sparse::PageTable &getSparseTableForAspect(VkImageAspectFlags aspects) const
+  {
+    return const_cast<ResourceInfo *>(this)->getSparseTableForAspect(aspects);
+  }
 
   VkMemoryRequirements memreqs = {};
 
@@ -1142,6 +1146,11 @@ struct MemMapState
   bool needRefData = false;
   bool mapCoherent = false;
   bool readbackOnGPU = false;
+  // if true, the OS is tracking CPU writes to the mapped range so refData isn't needed to find what
+  // has changed. writeWatchBaseline is set once the whole range has been serialised since
+  // tracking started.
+  bool writeWatched = false;
+  bool writeWatchBaseline = false;
   // pointer to base of memory, may not be valid until after mapOffset bytes
   byte *mappedPtr = NULL;
   // this is map sized, not memory sized, rebased at the map offset.
@@ -1451,14 +1460,14 @@ class ImageSubresourceMap
 
   ImageInfo m_imageInfo;
 
-  // The states of the subresources, without explicit ranges.
-  // The ranges associated with each state are determined by the index in
-  // `m_values` and the `*Split` flags in `m_flags`.
-  rdcarray<ImageSubresourceState> m_values;
-
-  // commonly there will only be one value, in that case we inline it here. This is only valid if
-  // m_values is empty.
-  ImageSubresourceState m_value;
+  // The states of the subresources, without explicit ranges, stored as runs over the subresource
+  // index (see SubresourceIndex). The ranges associated with each index are determined by the
+  // `*Split` flags in `m_flags`.
+  // Neighbouring subresources with the same state share a single interval, so the cost of updating
+  // and merging scales with the number of distinct states rather than the number of subresources.
+  // Only indices below size() are meaningful, the value of the final interval past that is
+  // unspecified.
+  Intervals<ImageSubresourceState> m_values;
 
   // The bit count of `m_aspectMask`
   uint16_t m_aspectCount = 0;
@@ -1497,6 +1506,27 @@ class ImageSubresourceMap
   void Unsplit(bool unsplitAspects, bool unsplitLevels, bool unsplitLayers, bool unsplitDepth);
   size_t SubresourceIndex(uint32_t aspectIndex, uint32_t level, uint32_t layer, uint32_t z) const;
 
+  // the subresource index space has four dimensions - aspect, level, layer and depth slice, from
+  // most to least significant. These return the number of indices in a dimension given a set of
+  // split flags, and the number of indices covered by one step in a dimension.
+  uint32_t SplitCount(uint16_t flags, uint32_t dim) const;
+  uint64_t InnerSize(uint16_t flags, uint32_t dim) const;
+  uint64_t OuterSize(uint16_t flags, uint32_t dim) const;
+  void SplitDimension(uint32_t dim);
+  void UnsplitDimension(uint32_t dim);
+  bool CanUnsplitDimension(uint32_t dim) const;
+
+  // calls `callback(start, finish)` for each contiguous span of subresource indices that overlaps
+  // `range` with the current split flags.
+  template <typename Callback>
+  void ForEachIndexSpan(const ImageSubresourceRange &range, Callback callback) const;
+
+  inline const ImageSubresourceState &IndexValue(size_t index) const
+  {
+    return m_values.find(index)->value();
+  }
+  void SetIndexValue(size_t index, const ImageSubresourceState &state);
+
 public:
   inline const ImageInfo &GetImageInfo() const { return m_imageInfo; }
   inline ImageSubresourceMap() {}
@@ -1507,7 +1537,8 @@ public:
         it != ImageAspectFlagIter::end(); ++it)
       ++m_aspectCount;
 
-    m_value = ImageSubresourceState(VK_QUEUE_FAMILY_IGNORED, UNKNOWN_PREV_IMG_LAYOUT, refType);
+    m_values.begin()->setValue(
+        ImageSubresourceState(VK_QUEUE_FAMILY_IGNORED, UNKNOWN_PREV_IMG_LAYOUT, refType));
   }
 
   void ToArray(rdcarray<ImageSubresourceStateForRange> &arr);
@@ -1516,29 +1547,10 @@ public:
 
   void FromImgRefs(const ImgRefs &imgRefs);
 
-  inline ImageSubresourceState &SubresourceIndexValue(uint32_t aspectIndex, uint32_t level,
-                                                      uint32_t layer, uint32_t slice)
-  {
-    if(m_values.empty())
-      return m_value;
-    return m_values[SubresourceIndex(aspectIndex, level, layer, slice)];
-  }
   inline const ImageSubresourceState &SubresourceIndexValue(uint32_t aspectIndex, uint32_t level,
                                                             uint32_t layer, uint32_t slice) const
   {
-    if(m_values.empty())
-      return m_value;
-    return m_values[SubresourceIndex(aspectIndex, level, layer, slice)];
-  }
-  inline ImageSubresourceState &SubresourceAspectValue(VkImageAspectFlagBits aspect, uint32_t level,
-                                                       uint32_t layer, uint32_t slice)
-  {
-    uint32_t aspectIndex = 0;
-    for(auto it = ImageAspectFlagIter::begin(GetImageInfo().Aspects());
-        it != ImageAspectFlagIter::end() && *it != aspect; ++it, ++aspectIndex)
-    {
-    }
-    return SubresourceIndexValue(aspectIndex, level, layer, slice);
+    return IndexValue(SubresourceIndex(aspectIndex, level, layer, slice));
   }
   inline const ImageSubresourceState &SubresourceAspectValue(VkImageAspectFlagBits aspect,
                                                              uint32_t level, uint32_t layer,
@@ -1562,6 +1574,22 @@ public:
   void Unsplit();
   FrameRefType Merge(const ImageSubresourceMap &other, FrameRefCompFunc compose);
 
+  // Update the state of every subresource in `range`. The map is only split if some state actually
+  // changes. Returns the combined reference type of the subresources that changed.
+  FrameRefType Update(const ImageSubresourceRange &range, const ImageSubresourceState &dst,
+                      FrameRefCompFunc compose);
+
+  // Replace the state of every subresource with `transform(state)`. This visits each run of
+  // identical states once, rather than each subresource.
+  template <typename Transform>
+  void TransformStates(Transform transform)
+  {
+    for(auto it = m_values.begin(); it != m_values.end(); ++it)
+      it->setValue(transform(it->value()));
+    for(auto it = m_values.begin(); it != m_values.end(); ++it)
+      it->mergeLeft();
+  }
+
   template <typename Map, typename Pair>
   class SubresourceRangeIterTemplate
   {
@@ -1605,33 +1633,35 @@ public:
     void FixSubRange();
   };
 
-  template <typename State>
+  // states are shared between runs of subresources, so they can't be modified in place. The
+  // reference returned by state() is only valid until the map is next modified.
+  template <typename Map>
   class SubresourcePairRefTemplate
   {
   public:
     inline const ImageSubresourceRange &range() const { return m_range; }
-    inline State &state() { return *m_state; }
-    inline const State &state() const { return *m_state; }
+    inline const ImageSubresourceState &state() const { return m_map->IndexValue(m_index); }
     operator ImageSubresourceStateForRange() const { return {range(), state()}; }
     SubresourcePairRefTemplate &operator=(const SubresourcePairRefTemplate &other) = delete;
 
   protected:
-    template <typename Map, typename Pair>
+    template <typename IterMap, typename Pair>
     friend class SubresourceRangeIterTemplate;
     ImageSubresourceRange m_range;
-    State *m_state;
+    Map *m_map = NULL;
+    size_t m_index = 0;
   };
 
-  class SubresourcePairRef : public SubresourcePairRefTemplate<ImageSubresourceState>
+  class SubresourcePairRef : public SubresourcePairRefTemplate<ImageSubresourceMap>
   {
   public:
     inline SubresourcePairRef &SetState(const ImageSubresourceState &state)
     {
-      *m_state = state;
+      m_map->SetIndexValue(m_index, state);
       return *this;
     }
   };
-  using ConstSubresourcePairRef = SubresourcePairRefTemplate<const ImageSubresourceState>;
+  using ConstSubresourcePairRef = SubresourcePairRefTemplate<const ImageSubresourceMap>;
 
   using SubresourceRangeIter = SubresourceRangeIterTemplate<ImageSubresourceMap, SubresourcePairRef>;
   using SubresourceRangeConstIter =
@@ -1649,7 +1679,10 @@ public:
   inline SubresourceRangeConstIter begin() const { return RangeBegin(GetImageInfo().FullRange()); }
   inline SubresourceRangeIter end() { return SubresourceRangeIter(); }
   inline SubresourceRangeConstIter end() const { return SubresourceRangeConstIter(); }
-  inline size_t size() const { return RDCMAX(m_values.size(), (size_t)1); }
+  inline size_t size() const
+  {
+    return size_t(OuterSize(m_flags, 3) * SplitCount(m_flags, 3));
+  }
 };
 
 struct ImageBarrierSequence
@@ -1668,6 +1701,12 @@ struct ImageBarrierSequence
   void ExtractUnwrappedBatch(uint32_t batchIndex, uint32_t queueFamilyIndex, Batch &result);
   void ExtractFirstUnwrappedBatchForQueue(uint32_t queueFamilyIndex, Batch &result);
   void ExtractLastUnwrappedBatchForQueue(uint32_t queueFamilyIndex, Batch &result);
+
+  // folds chains of layout transitions on the same subresources within each batch, drops any that
+  // end up as no-ops, and combines barriers that differ only in adjacent subresource ranges.
+  // Sequences accumulated over several operations with Merge() often transition an image there and
+  // back again, which would otherwise cost a pipeline drain for nothing.
+  void Optimise();
   inline bool empty() const { return barrierCount == 0; }
   inline size_t size() const { return barrierCount; }
   static void UnwrapBarriers(Batch &barriers);
@@ -1689,6 +1728,8 @@ private:
   // used to reserve the size of batches above on construction to avoid copying large arrays when
   // resizing it
   static uint32_t MaxQueueFamilyIndex;
+
+  static void OptimiseBatch(Batch &barriers);
 };
 
 struct ImageTransitionInfo
@@ -23,10 +23,53 @@
  ******************************************************************************/
 
 #include "vk_shader_cache.h"
-#include "common/shader_cache.h"
+#include "api/replay/version.h"
 #include "data/glsl_shaders.h"
+#include "md5/md5.h"
+#include "serialise/serialiser.h"
 #include "strings/string_utils.h"
 
+RDOC_CONFIG(bool, Vulkan_PersistentPipelineCache, true,
+            "Keep a pipeline cache on disk for each capture that is opened, so that pipelines "
+            "don't need to be compiled from scratch the next time the capture is opened.");
+
+RDOC_CONFIG(bool, Vulkan_PersistentReflectionCache, true,
+            "Keep shader reflection on disk, so that captures using the same shaders don't need "
+            "to reflect them again when they're opened.");
+
+// the reflection cache is bounded so it can't grow without limit across many different captures
+static const uint64_t ReflectionCacheMaxBytes = 256 * 1024 * 1024;
+
+// likewise for compiled custom shaders, which are much smaller and fewer
+static const uint64_t CustomShaderCacheMaxBytes = 32 * 1024 * 1024;
+
+DECLARE_REFLECTION_STRUCT(SPIRVInterfaceAccess);
+DECLARE_REFLECTION_STRUCT(SPIRVPatchData);
+
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, SPIRVInterfaceAccess &el)
+{
+  uint32_t ID = el.ID.value(), structID = el.structID.value();
+  SERIALISE_ELEMENT(ID);
+  SERIALISE_ELEMENT(structID);
+  el.ID = rdcspv::Id::fromWord(ID);
+  el.structID = rdcspv::Id::fromWord(structID);
+
+  SERIALISE_MEMBER(structMemberIndex);
+  SERIALISE_MEMBER(accessChain);
+  SERIALISE_MEMBER(isArraySubsequentElement);
+}
+
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, SPIRVPatchData &el)
+{
+  SERIALISE_MEMBER(inputs);
+  SERIALISE_MEMBER(outputs);
+  SERIALISE_MEMBER(specIDs);
+  SERIALISE_MEMBER(outTopo);
+  SERIALISE_MEMBER(usesPrintf);
+}
+
 enum class FeatureCheck
 {
   NoCheck = 0x0,
@@ -206,6 +249,22 @@ struct VulkanBlobShaderCallbacks
   const byte *GetData(SPIRVBlob blob) const { return (const byte *)blob->data(); }
 } VulkanShaderCacheCallbacks;
 
+struct VulkanReflectionCacheCallbacks
+{
+  bool Create(uint32_t size, byte *data, bytebuf **ret) const
+  {
+    RDCASSERT(ret);
+
+    *ret = new bytebuf(data, size);
+
+    return true;
+  }
+
+  void Destroy(bytebuf *blob) const { delete blob; }
+  uint32_t GetSize(bytebuf *blob) const { return (uint32_t)blob->size(); }
+  const byte *GetData(bytebuf *blob) const { return blob->data(); }
+} VulkanReflectionCacheCallbacks;
+
 struct VkPipeCacheHeader
 {
   uint32_t length;
@@ -339,46 +398,8 @@ VulkanShaderCache::VulkanShaderCache(WrappedVulkan *driver)
 
     GetPipeCacheBlob();
 
-    if(!m_PipeCacheBlob.empty())
-    {
-      if(m_PipeCacheBlob.size() < sizeof(VkPipeCacheHeader))
-      {
-        m_PipeCacheBlob.clear();
-      }
-      else
-      {
-        VkPipeCacheHeader *header = (VkPipeCacheHeader *)m_PipeCacheBlob.data();
-
-        // check explicitly for incompatibility
-        if(header->length != sizeof(VkPipeCacheHeader))
-        {
-          m_PipeCacheBlob.clear();
-          RDCLOG("Pipeline cache header length %u is unexpected, not using cache", header->length);
-        }
-        else if(header->version != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
-        {
-          m_PipeCacheBlob.clear();
-          RDCLOG("Pipeline cache header version %u is unexpected, not using cache", header->version);
-        }
-        else if(header->vendorID != m_pDriver->GetDeviceProps().vendorID)
-        {
-          m_PipeCacheBlob.clear();
-          RDCLOG("Pipeline cache header vendorID %u doesn't match %u", header->vendorID,
-                 m_pDriver->GetDeviceProps().vendorID);
-        }
-        else if(header->deviceID != m_pDriver->GetDeviceProps().deviceID)
-        {
-          m_PipeCacheBlob.clear();
-          RDCLOG("Pipeline cache header deviceID %u doesn't match %u", header->deviceID,
-                 m_pDriver->GetDeviceProps().deviceID);
-        }
-        else if(memcmp(header->uuid, m_pDriver->GetDeviceProps().pipelineCacheUUID, VK_UUID_SIZE) != 0)
-        {
-          m_PipeCacheBlob.clear();
-          RDCLOG("Pipeline cache UUID doesn't match");
-        }
-      }
-    }
+    if(!IsPipeCacheCompatible(m_PipeCacheBlob))
+      m_PipeCacheBlob.clear();
 
     if(!m_PipeCacheBlob.empty())
     {
@@ -408,11 +429,16 @@ VulkanShaderCache::VulkanShaderCache(WrappedVulkan *driver)
     }
   }
 
+  if(IsReplayMode(m_pDriver->GetState()) && Vulkan_PersistentPipelineCache())
+    CreateCapturePipeCache();
+
   SetCaching(false);
 }
 
 VulkanShaderCache::~VulkanShaderCache()
 {
+  SaveCapturePipeCache();
+
   if(m_PipelineCache != VK_NULL_HANDLE)
   {
     bytebuf blob;
@@ -436,6 +462,28 @@ VulkanShaderCache::~VulkanShaderCache()
       VulkanShaderCacheCallbacks.Destroy(it->second);
   }
 
+  if(m_ReflectionCacheDirty)
+  {
+    SaveShaderCache("vkreflection.cache", m_ShaderCacheMagic, m_ReflectionCacheVersion,
+                    m_ReflectionCache, VulkanReflectionCacheCallbacks);
+  }
+  else
+  {
+    for(auto it = m_ReflectionCache.begin(); it != m_ReflectionCache.end(); ++it)
+      VulkanReflectionCacheCallbacks.Destroy(it->second);
+  }
+
+  if(m_CustomShaderCacheDirty)
+  {
+    SaveShaderCache("vkcustomshaders.cache", m_ShaderCacheMagic, m_CustomShaderCacheVersion,
+                    m_CustomShaderCache, VulkanReflectionCacheCallbacks);
+  }
+  else
+  {
+    for(auto it = m_CustomShaderCache.begin(); it != m_CustomShaderCache.end(); ++it)
+      VulkanReflectionCacheCallbacks.Destroy(it->second);
+  }
+
   for(size_t i = 0; i < ARRAY_COUNT(m_BuiltinShaderModules); i++)
     for(size_t b = 0; b < ARRAY_COUNT(m_BuiltinShaderModules[0]); b++)
       for(size_t t = 0; t < ARRAY_COUNT(m_BuiltinShaderModules[0][0]); t++)
@@ -487,6 +535,316 @@ rdcstr VulkanShaderCache::GetSPIRVBlob(const rdcspv::CompilationSettings &settin
   return errors;
 }
 
+rdcstr VulkanShaderCache::GetCustomSPIRV(const rdcspv::CompilationSettings &settings,
+                                         const rdcstr &src, rdcarray<uint32_t> &spirv)
+{
+  MD5_CTX md5ctx = {};
+  MD5_Init(&md5ctx);
+
+  // glslang is built in, so the build identifies the compiler version
+  MD5_Update(&md5ctx, GitVersionHash, sizeof(GitVersionHash));
+  MD5_Update(&md5ctx, &settings.lang, sizeof(settings.lang));
+  MD5_Update(&md5ctx, &settings.stage, sizeof(settings.stage));
+  MD5_Update(&md5ctx, &settings.debugInfo, sizeof(settings.debugInfo));
+  MD5_Update(&md5ctx, &settings.gles, sizeof(settings.gles));
+  MD5_Update(&md5ctx, settings.entryPoint.c_str(), (unsigned long)settings.entryPoint.size() + 1);
+  MD5_Update(&md5ctx, src.c_str(), (unsigned long)src.size());
+
+  ShaderCacheHash128 hash;
+  MD5_Final((unsigned char *)hash.hash, &md5ctx);
+
+  // load the cache the first time it's needed, most replays never compile a custom shader
+  if(!m_CustomShaderCacheLoaded)
+  {
+    m_CustomShaderCacheLoaded = true;
+    LoadShaderCache("vkcustomshaders.cache", m_ShaderCacheMagic, m_CustomShaderCacheVersion,
+                    m_CustomShaderCache, VulkanReflectionCacheCallbacks);
+
+    for(auto it = m_CustomShaderCache.begin(); it != m_CustomShaderCache.end(); ++it)
+      m_CustomShaderCacheBytes += it->second->size();
+  }
+
+  auto it = m_CustomShaderCache.find(hash);
+  if(it != m_CustomShaderCache.end())
+  {
+    spirv.resize(it->second->size() / sizeof(uint32_t));
+    memcpy(spirv.data(), it->second->data(), spirv.byteSize());
+    return rdcstr();
+  }
+
+  rdcstr output = rdcspv::Compile(settings, {src}, spirv);
+
+  // only cache successful compiles, and don't grow past the limit
+  if(!spirv.empty() && m_CustomShaderCacheBytes + spirv.byteSize() <= CustomShaderCacheMaxBytes)
+  {
+    m_CustomShaderCache[hash] = new bytebuf((const byte *)spirv.data(), spirv.byteSize());
+    m_CustomShaderCacheBytes += spirv.byteSize();
+    m_CustomShaderCacheDirty = true;
+  }
+
+  return output;
+}
+
+bool VulkanShaderCache::IsPipeCacheCompatible(const bytebuf &blob)
+{
+  if(blob.empty())
+    return false;
+
+  if(blob.size() < sizeof(VkPipeCacheHeader))
+    return false;
+
+  const VkPipeCacheHeader *header = (const VkPipeCacheHeader *)blob.data();
+
+  // check explicitly for incompatibility
+  if(header->length != sizeof(VkPipeCacheHeader))
+  {
+    RDCLOG("Pipeline cache header length %u is unexpected, not using cache", header->length);
+    return false;
+  }
+  else if(header->version != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+  {
+    RDCLOG("Pipeline cache header version %u is unexpected, not using cache", header->version);
+    return false;
+  }
+  else if(header->vendorID != m_pDriver->GetDeviceProps().vendorID)
+  {
+    RDCLOG("Pipeline cache header vendorID %u doesn't match %u", header->vendorID,
+           m_pDriver->GetDeviceProps().vendorID);
+    return false;
+  }
+  else if(header->deviceID != m_pDriver->GetDeviceProps().deviceID)
+  {
+    RDCLOG("Pipeline cache header deviceID %u doesn't match %u", header->deviceID,
+           m_pDriver->GetDeviceProps().deviceID);
+    return false;
+  }
+  else if(memcmp(header->uuid, m_pDriver->GetDeviceProps().pipelineCacheUUID, VK_UUID_SIZE) != 0)
+  {
+    RDCLOG("Pipeline cache UUID doesn't match");
+    return false;
+  }
+
+  return true;
+}
+
+ShaderCacheHash128 VulkanShaderCache::GetReflectionHash(const rdcspv::Reflector &spv,
+                                                        const rdcstr &entry, ShaderStage stage,
+                                                        const rdcarray<SpecConstant> &specInfo)
+{
+  MD5_CTX md5ctx = {};
+  MD5_Init(&md5ctx);
+
+  // the serialised reflection format can change with any build, so include our version
+  MD5_Update(&md5ctx, GitVersionHash, sizeof(GitVersionHash));
+
+  const rdcarray<uint32_t> &spirv = spv.GetSPIRV();
+  MD5_Update(&md5ctx, spirv.data(), (unsigned long)(spirv.size() * sizeof(uint32_t)));
+
+  MD5_Update(&md5ctx, entry.c_str(), (unsigned long)entry.size());
+  MD5_Update(&md5ctx, &stage, sizeof(stage));
+
+  for(const SpecConstant &spec : specInfo)
+  {
+    MD5_Update(&md5ctx, &spec.specID, sizeof(spec.specID));
+    MD5_Update(&md5ctx, &spec.value, sizeof(spec.value));
+    uint64_t dataSize = spec.dataSize;
+    MD5_Update(&md5ctx, &dataSize, sizeof(dataSize));
+  }
+
+  ShaderCacheHash128 ret;
+  MD5_Final((unsigned char *)ret.hash, &md5ctx);
+  return ret;
+}
+
+bool VulkanShaderCache::GetCachedReflection(const ShaderCacheHash128 &hash,
+                                            ShaderReflection &refl, ShaderBindpointMapping &mapping,
+                                            SPIRVPatchData &patchData)
+{
+  if(!Vulkan_PersistentReflectionCache())
+    return false;
+
+  bytebuf data;
+
+  {
+    SCOPED_LOCK(m_ReflectionCacheLock);
+
+    // load the cache the first time it's needed, rather than every time a device is created
+    if(!m_ReflectionCacheLoaded)
+    {
+      m_ReflectionCacheLoaded = true;
+      LoadShaderCache("vkreflection.cache", m_ShaderCacheMagic, m_ReflectionCacheVersion,
+                      m_ReflectionCache, VulkanReflectionCacheCallbacks);
+
+      for(auto it = m_ReflectionCache.begin(); it != m_ReflectionCache.end(); ++it)
+        m_ReflectionCacheBytes += it->second->size();
+    }
+
+    auto it = m_ReflectionCache.find(hash);
+    if(it == m_ReflectionCache.end())
+      return false;
+
+    data = *it->second;
+  }
+
+  ReadSerialiser ser(new StreamReader(data.data(), data.size()), Ownership::Stream);
+
+  ser.Serialise("refl"_lit, refl);
+  ser.Serialise("mapping"_lit, mapping);
+  ser.Serialise("patchData"_lit, patchData);
+
+  if(ser.IsErrored())
+  {
+    // reset anything partially read so the caller can reflect from scratch
+    refl = ShaderReflection();
+    mapping = ShaderBindpointMapping();
+    patchData = SPIRVPatchData();
+    return false;
+  }
+
+  return true;
+}
+
+void VulkanShaderCache::SetCachedReflection(const ShaderCacheHash128 &hash, ShaderReflection &refl,
+                                            ShaderBindpointMapping &mapping,
+                                            SPIRVPatchData &patchData)
+{
+  if(!Vulkan_PersistentReflectionCache())
+    return;
+
+  // the SPIR-V itself is already in the capture, don't store a second copy
+  bytebuf rawBytes;
+  rawBytes.swap(refl.rawBytes);
+
+  WriteSerialiser ser(new StreamWriter(StreamWriter::DefaultScratchSize), Ownership::Stream);
+
+  ser.Serialise("refl"_lit, refl);
+  ser.Serialise("mapping"_lit, mapping);
+  ser.Serialise("patchData"_lit, patchData);
+
+  rawBytes.swap(refl.rawBytes);
+
+  StreamWriter *writer = ser.GetWriter();
+
+  SCOPED_LOCK(m_ReflectionCacheLock);
+
+  if(m_ReflectionCacheBytes + writer->GetOffset() > ReflectionCacheMaxBytes)
+    return;
+
+  bytebuf *&blob = m_ReflectionCache[hash];
+  if(blob)
+    return;
+
+  blob = new bytebuf(writer->GetData(), (size_t)writer->GetOffset());
+  m_ReflectionCacheBytes += blob->size();
+  m_ReflectionCacheDirty = true;
+}
+
+void VulkanShaderCache::CreateCapturePipeCache()
+{
+  uint32_t captureHash = m_pDriver->GetCaptureHash();
+
+  if(captureHash == 0)
+    return;
+
+  const VkPhysicalDeviceProperties &props = m_pDriver->GetDeviceProps();
+
+  // the pipeline cache UUID should change with any driver update that invalidates the data, but
+  // key on the driver version as well so that an update doesn't load a stale cache only to discard
+  // it, and the old file is left to be overwritten.
+  rdcstr driverIdent =
+      StringFormat::Fmt("%x_%x_%x_", props.vendorID, props.deviceID, props.driverVersion);
+  for(size_t i = 0; i < VK_UUID_SIZE; i++)
+    driverIdent += StringFormat::Fmt("%02x", props.pipelineCacheUUID[i]);
+
+  uint32_t driverHash = strhash(driverIdent.c_str());
+
+  m_CapturePipeCacheFilename =
+      StringFormat::Fmt("vkpipelines_%08x_%08x.cache", captureHash, driverHash);
+
+  std::map<uint32_t, SPIRVBlob> fileCache;
+
+  if(LoadShaderCache(m_CapturePipeCacheFilename, m_ShaderCacheMagic, m_ShaderCacheVersion,
+                     fileCache, VulkanShaderCacheCallbacks))
+  {
+    auto it = fileCache.find(captureHash);
+
+    // first uint32_t is the real byte size, as with the internal pipeline cache
+    if(it != fileCache.end() && !it->second->empty() &&
+       it->second->at(0) <= (it->second->size() - 1) * sizeof(uint32_t))
+    {
+      m_CapturePipeCacheBlob.resize(it->second->at(0));
+      memcpy(m_CapturePipeCacheBlob.data(), it->second->data() + 1, m_CapturePipeCacheBlob.size());
+    }
+  }
+
+  for(auto it = fileCache.begin(); it != fileCache.end(); ++it)
+    VulkanShaderCacheCallbacks.Destroy(it->second);
+
+  if(!IsPipeCacheCompatible(m_CapturePipeCacheBlob))
+    m_CapturePipeCacheBlob.clear();
+
+  VkPipelineCacheCreateInfo createInfo = {VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+
+  if(!m_CapturePipeCacheBlob.empty())
+  {
+    createInfo.initialDataSize = m_CapturePipeCacheBlob.size();
+    createInfo.pInitialData = m_CapturePipeCacheBlob.data();
+
+    RDCLOG("Loaded %zu byte pipeline cache for capture", m_CapturePipeCacheBlob.size());
+  }
+
+  VkResult vkr = ObjDisp(m_Device)->CreatePipelineCache(Unwrap(m_Device), &createInfo, NULL,
+                                                        &m_CapturePipelineCache);
+  m_pDriver->CheckVkResult(vkr);
+
+  if(vkr == VK_SUCCESS)
+  {
+    ResourceId id =
+        m_pDriver->GetResourceManager()->WrapResource(Unwrap(m_Device), m_CapturePipelineCache);
+    m_pDriver->GetResourceManager()->AddLiveResource(id, m_CapturePipelineCache);
+  }
+  else
+  {
+    m_CapturePipelineCache = VK_NULL_HANDLE;
+  }
+}
+
+void VulkanShaderCache::SaveCapturePipeCache()
+{
+  if(m_CapturePipelineCache == VK_NULL_HANDLE)
+    return;
+
+  bytebuf blob;
+  size_t size = 0;
+  ObjDisp(m_Device)->GetPipelineCacheData(Unwrap(m_Device), Unwrap(m_CapturePipelineCache), &size,
+                                          NULL);
+  blob.resize(size);
+  ObjDisp(m_Device)->GetPipelineCacheData(Unwrap(m_Device), Unwrap(m_CapturePipelineCache), &size,
+                                          blob.data());
+  blob.resize(size);
+
+  m_pDriver->vkDestroyPipelineCache(m_Device, m_CapturePipelineCache, NULL);
+  m_CapturePipelineCache = VK_NULL_HANDLE;
+
+  // nothing new was compiled
+  if(blob.empty() || blob == m_CapturePipeCacheBlob)
+    return;
+
+  std::map<uint32_t, SPIRVBlob> fileCache;
+
+  // align the size up to the nearest 4, and add one extra for us to store the real byte size
+  SPIRVBlob spirvBlob = new rdcarray<uint32_t>();
+  spirvBlob->resize(AlignUp4(blob.size()) / 4 + 1);
+  (*spirvBlob)[0] = (uint32_t)blob.size();
+  memcpy(spirvBlob->data() + 1, blob.data(), blob.size());
+
+  fileCache[m_pDriver->GetCaptureHash()] = spirvBlob;
+
+  // this destroys the blobs in the cache
+  SaveShaderCache(m_CapturePipeCacheFilename, m_ShaderCacheMagic, m_ShaderCacheVersion, fileCache,
+                  VulkanShaderCacheCallbacks);
+}
+
 void VulkanShaderCache::GetPipeCacheBlob()
 {
   m_PipeCacheBlob.clear();
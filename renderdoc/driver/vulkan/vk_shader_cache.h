@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include "common/shader_cache.h"
 #include "core/core.h"
 #include "driver/shaders/spirv/spirv_compile.h"
 #include "vk_core.h"
@@ -97,6 +98,11 @@ public:
   rdcstr GetSPIRVBlob(const rdcspv::CompilationSettings &settings, const rdcstr &src,
                       SPIRVBlob &outBlob);
 
+  // compiles user-provided shaders such as custom display shaders and edited shaders, with the
+  // results cached on disk keyed by a hash of the source, settings and build.
+  rdcstr GetCustomSPIRV(const rdcspv::CompilationSettings &settings, const rdcstr &src,
+                        rdcarray<uint32_t> &spirv);
+
   SPIRVBlob GetBuiltinBlob(BuiltinShader builtin)
   {
     return m_BuiltinShaderBlobs[(size_t)builtin][(size_t)BuiltinShaderBaseType::First]
@@ -109,17 +115,33 @@ public:
     return m_BuiltinShaderModules[(size_t)builtin][(size_t)baseType][(size_t)texType];
   }
   VkPipelineCache GetPipeCache() { return m_PipelineCache; }
+  VkPipelineCache GetCapturePipeCache() { return m_CapturePipelineCache; }
   void MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &pipeCreateInfo, ResourceId pipeline);
   void MakeComputePipelineInfo(VkComputePipelineCreateInfo &pipeCreateInfo, ResourceId pipeline);
 
   bool IsBuffer2MSSupported() { return m_Buffer2MSSupported; }
   void SetCaching(bool enabled) { m_CacheShaders = enabled; }
+
+  // reflection for application shaders is cached on disk, keyed by a hash of the SPIR-V and of
+  // everything else that affects the reflection. These can be called from multiple threads.
+  ShaderCacheHash128 GetReflectionHash(const rdcspv::Reflector &spv, const rdcstr &entry,
+                                       ShaderStage stage, const rdcarray<SpecConstant> &specInfo);
+  bool GetCachedReflection(const ShaderCacheHash128 &hash, ShaderReflection &refl,
+                           ShaderBindpointMapping &mapping, SPIRVPatchData &patchData);
+  void SetCachedReflection(const ShaderCacheHash128 &hash, ShaderReflection &refl,
+                           ShaderBindpointMapping &mapping, SPIRVPatchData &patchData);
+
 private:
   static const uint32_t m_ShaderCacheMagic = 0xf00d00d5;
   static const uint32_t m_ShaderCacheVersion = 1;
+  static const uint32_t m_ReflectionCacheVersion = 1;
+  static const uint32_t m_CustomShaderCacheVersion = 1;
 
   void GetPipeCacheBlob();
   void SetPipeCacheBlob(bytebuf &blob);
+  bool IsPipeCacheCompatible(const bytebuf &blob);
+  void CreateCapturePipeCache();
+  void SaveCapturePipeCache();
 
   WrappedVulkan *m_pDriver = NULL;
   VkDevice m_Device = VK_NULL_HANDLE;
@@ -131,11 +153,26 @@ private:
   bytebuf m_PipeCacheBlob;
   VkPipelineCache m_PipelineCache = VK_NULL_HANDLE;
 
+  // pipeline cache used for the capture's own pipelines on replay, stored separately for each
+  // capture and driver so that re-opening a capture doesn't need to compile everything again
+  rdcstr m_CapturePipeCacheFilename;
+  bytebuf m_CapturePipeCacheBlob;
+  VkPipelineCache m_CapturePipelineCache = VK_NULL_HANDLE;
+
   bool m_Buffer2MSSupported = false;
 
   bool m_ShaderCacheDirty = false, m_CacheShaders = false;
   std::map<uint32_t, SPIRVBlob> m_ShaderCache;
 
+  Threading::CriticalSection m_ReflectionCacheLock;
+  bool m_ReflectionCacheLoaded = false, m_ReflectionCacheDirty = false;
+  uint64_t m_ReflectionCacheBytes = 0;
+  std::map<ShaderCacheHash128, bytebuf *> m_ReflectionCache;
+
+  bool m_CustomShaderCacheLoaded = false, m_CustomShaderCacheDirty = false;
+  uint64_t m_CustomShaderCacheBytes = 0;
+  std::map<ShaderCacheHash128, bytebuf *> m_CustomShaderCache;
+
   SPIRVBlob m_BuiltinShaderBlobs[arraydim<BuiltinShader>()][arraydim<BuiltinShaderBaseType>()]
                                 [arraydim<BuiltinShaderTextureType>()] = {};
   VkShaderModule m_BuiltinShaderModules[arraydim<BuiltinShader>()][arraydim<BuiltinShaderBaseType>()]
@@ -41,10 +41,16 @@ RDOC_CONFIG(
 RDOC_CONFIG(bool, Vulkan_PrintfFetch, true, "Enable fetching printf messages from GPU.");
 RDOC_CONFIG(uint32_t, Vulkan_Debug_PrintfBufferSize, 64 * 1024,
             "How many bytes to reserve for a printf output buffer.");
+RDOC_CONFIG(bool, Vulkan_Debug_ShaderBlockProfiling, false,
+            "Count how many times each basic block in a shader runs when fetching shader feedback "
+            "for an event, and report the counts as shader messages on each block's label.");
 RDOC_EXTERN_CONFIG(bool, Vulkan_Debug_DisableBufferDeviceAddress);
 
 static const uint32_t ShaderStageHeaderBitShift = 28U;
 
+// the largest the printf buffer will grow to when re-running an event whose output overflowed
+static const uint32_t MaxPrintfBufferSize = 256 * 1024 * 1024;
+
 struct feedbackData
 {
   uint64_t offset;
@@ -60,6 +66,44 @@ struct PrintfData
   size_t payloadWords;
 };
 
+// counters for how many times each basic block in a shader ran
+struct BlockCounters
+{
+  // byte offset of the first counter in the feedback buffer
+  uint64_t offset = 0;
+  // the instruction offset of each counted block's OpLabel, in counter order
+  rdcarray<uint32_t> labels;
+};
+
+// the instrumented shaders for one pipeline, kept so that selecting other events that use the same
+// pipeline doesn't need to annotate and compile them again
+struct VKFeedbackInstrumentation
+{
+  void Destroy(WrappedVulkan *driver)
+  {
+    VkDevice dev = driver->GetDev();
+
+    driver->vkDestroyPipeline(dev, pipe, NULL);
+
+    for(size_t i = 0; i < ARRAY_COUNT(modules); i++)
+      if(modules[i] != VK_NULL_HANDLE)
+        driver->vkDestroyShaderModule(dev, modules[i], NULL);
+  }
+
+  // the shaders depend on where each binding's feedback is written, so any change to the layout of
+  // the feedback buffer needs them to be instrumented again
+  VkDeviceSize feedbackStorageSize = 0;
+  bool usesMultiview = false;
+
+  VkShaderModule modules[6] = {};
+  std::map<uint32_t, PrintfData> printfData[6];
+  BlockCounters blockCounters[6];
+
+  // only kept when using buffer device addresses. Otherwise the pipeline uses layouts created for
+  // each event's patched descriptor sets, and is created each time.
+  VkPipeline pipe = VK_NULL_HANDLE;
+};
+
 struct ShaderPrintfArgs : public StringFormat::Args
 {
 public:
@@ -315,11 +359,22 @@ rdcspv::Id MakeOffsettedPointer<uint32_t>(rdcspv::Editor &editor, rdcspv::Iter &
   return editor.AddOperation(it, rdcspv::OpBitcast(ptrType, editor.MakeId(), finalAddr));
 }
 
+// an upper bound on the number of blocks AnnotateShader will count, to size the counters
+static uint32_t CountBlocks(const rdcarray<uint32_t> &spirv)
+{
+  uint32_t count = 0;
+  for(rdcspv::ConstIter it(spirv, rdcspv::FirstRealWord); it; it++)
+    if(it.opcode() == rdcspv::Op::Label)
+      count++;
+  return count;
+}
+
 template <typename uintvulkanmax_t>
 void AnnotateShader(const ShaderReflection &refl, const SPIRVPatchData &patchData, ShaderStage stage,
                     const char *entryName, const std::map<rdcspv::Binding, feedbackData> &offsetMap,
                     uint32_t maxSlot, bool usePrimitiveID, VkDeviceAddress addr,
-                    bool bufferAddressKHR, bool usesMultiview, rdcarray<uint32_t> &modSpirv,
+                    bool bufferAddressKHR, bool usesMultiview, uint32_t printfBufferSize,
+                    BlockCounters *blockCounters, rdcarray<uint32_t> &modSpirv,
                     std::map<uint32_t, PrintfData> &printfData)
 {
   // calculate offsets for IDs on the original unmodified SPIR-V. The editor may insert some nops,
@@ -344,7 +399,7 @@ void AnnotateShader(const ShaderReflection &refl, const SPIRVPatchData &patchDat
                                                 : editor.AddConstantImmediate<uint32_t>(maxSlot);
 
   rdcspv::Id maxPrintfWordOffset =
-      editor.AddConstantImmediate<uint32_t>(Vulkan_Debug_PrintfBufferSize() / sizeof(uint32_t));
+      editor.AddConstantImmediate<uint32_t>(printfBufferSize / sizeof(uint32_t));
 
   rdcspv::Id falsePrintfValue = editor.AddConstantImmediate<uint32_t>(0U);
   rdcspv::Id truePrintfValue = editor.AddConstantImmediate<uint32_t>(1U);
@@ -565,6 +620,37 @@ void AnnotateShader(const ShaderReflection &refl, const SPIRVPatchData &patchDat
 
   rdcspv::Id glsl450 = editor.ImportExtInst("GLSL.std.450");
 
+  // adds an atomic increment of the next block counter at it, leaving it on the added increment
+  auto countBlock = [&](rdcspv::Iter &it, rdcspv::Id label) {
+    const uint64_t slot = blockCounters->labels.size();
+    blockCounters->labels.push_back(idToOffset[label]);
+
+    rdcspv::Id counterptr;
+
+    if(useBufferAddress)
+    {
+      rdcspv::Id offset = editor.AddConstantDeferred<uintvulkanmax_t>(
+          uintvulkanmax_t(blockCounters->offset + slot * sizeof(uint32_t)));
+
+      counterptr = MakeOffsettedPointer<uintvulkanmax_t>(editor, it, uint32ptrtype, carryStructType,
+                                                         bufferAddressConst, offset);
+      it++;
+    }
+    else
+    {
+      rdcspv::Id index =
+          editor.AddConstantDeferred<uint32_t>(uint32_t(blockCounters->offset / 4 + slot));
+
+      counterptr =
+          editor.AddOperation(it, rdcspv::OpAccessChain(uint32ptrtype, editor.MakeId(), ssboVar,
+                                                        {rtarrayOffset, index}));
+      it++;
+    }
+
+    editor.AddOperation(it, rdcspv::OpAtomicIAdd(uint32Type, editor.MakeId(), counterptr, scope,
+                                                 semantics, truePrintfValue));
+  };
+
   std::map<rdcspv::Id, rdcspv::Scalar> intTypeLookup;
 
   for(auto scalarType : editor.GetTypeInfo<rdcspv::Scalar>())
@@ -930,10 +1016,12 @@ void AnnotateShader(const ShaderReflection &refl, const SPIRVPatchData &patchDat
     }
 
     // continue to the first label so we can insert things at the start of the entry point
+    rdcspv::Id firstLabel;
     for(; it; ++it)
     {
       if(it.opcode() == rdcspv::Op::Label)
       {
+        firstLabel = rdcspv::OpLabel(it).result;
         ++it;
         break;
       }
@@ -952,6 +1040,12 @@ void AnnotateShader(const ShaderReflection &refl, const SPIRVPatchData &patchDat
       }
     }
 
+    if(blockCounters)
+    {
+      countBlock(it, firstLabel);
+      ++it;
+    }
+
     // now patch accesses in the function body
     for(; it; ++it)
     {
@@ -959,6 +1053,20 @@ void AnnotateShader(const ShaderReflection &refl, const SPIRVPatchData &patchDat
       if(it.opcode() == rdcspv::Op::FunctionEnd)
         break;
 
+      // count each block at its start, after any phis which must come first
+      if(it.opcode() == rdcspv::Op::Label && blockCounters)
+      {
+        rdcspv::Id label = rdcspv::OpLabel(it).result;
+
+        ++it;
+        while(it.opcode() == rdcspv::Op::Phi || it.opcode() == rdcspv::Op::Line ||
+              it.opcode() == rdcspv::Op::NoLine)
+          ++it;
+
+        countBlock(it, label);
+        continue;
+      }
+
       // if we see an OpCopyObject, just add it to the map pointing to the same value
       if(it.opcode() == rdcspv::Op::CopyObject)
       {
@@ -1435,9 +1543,22 @@ void AnnotateShader(const ShaderReflection &refl, const SPIRVPatchData &patchDat
   }
 }
 
+void VulkanReplay::Feedback::ClearInstrumentation(WrappedVulkan *driver)
+{
+  for(auto it = Instrumented.begin(); it != Instrumented.end(); ++it)
+  {
+    if(it->second)
+      it->second->Destroy(driver);
+    delete it->second;
+  }
+
+  Instrumented.clear();
+}
+
 void VulkanReplay::ClearFeedbackCache()
 {
   m_BindlessFeedback.Usage.clear();
+  m_BindlessFeedback.ClearInstrumentation(m_pDriver);
 }
 
 bool VulkanReplay::FetchShaderFeedback(uint32_t eventId)
@@ -1466,6 +1587,11 @@ bool VulkanReplay::FetchShaderFeedback(uint32_t eventId)
 
   const ActionDescription *action = m_pDriver->GetAction(eventId);
 
+  if(m_BindlessFeedback.PrintfBufferSize == 0)
+    m_BindlessFeedback.PrintfBufferSize = AlignUp4(RDCMAX(Vulkan_Debug_PrintfBufferSize(), 1024U));
+
+  const uint32_t printfBufferSize = m_BindlessFeedback.PrintfBufferSize;
+
   if(action == NULL || !(action->flags & (ActionFlags::Dispatch | ActionFlags::Drawcall)))
   {
     // deliberately show no bindings as used for non-draws
@@ -1530,7 +1656,7 @@ bool VulkanReplay::FetchShaderFeedback(uint32_t eventId)
   {
     // reserve some space at the start for an atomic offset counter then the buffer size, and an
     // overflow section for any clamped messages
-    feedbackStorageSize += 16 + Vulkan_Debug_PrintfBufferSize() + 1024;
+    feedbackStorageSize += 16 + printfBufferSize + 1024;
   }
 
   ResourceId pipeLayouts[] = {pipeInfo.vertLayout, pipeInfo.fragLayout};
@@ -1578,13 +1704,33 @@ bool VulkanReplay::FetchShaderFeedback(uint32_t eventId)
     }
   }
 
+  const bool profileBlocks = Vulkan_Debug_ShaderBlockProfiling();
+
+  // a counter for every block in each shader, if we're profiling them
+  uint64_t blockCounterOffsets[6] = {};
+
+  if(profileBlocks)
+  {
+    for(uint32_t idx = 0; idx < ARRAY_COUNT(blockCounterOffsets); idx++)
+    {
+      if(pipeInfo.shaders[idx].module == ResourceId() || result.compute != (idx == 5))
+        continue;
+
+      const VulkanCreationInfo::ShaderModule &moduleInfo =
+          creationInfo.m_ShaderModule[pipeInfo.shaders[idx].module];
+
+      blockCounterOffsets[idx] = feedbackStorageSize;
+      feedbackStorageSize += CountBlocks(moduleInfo.spirv.GetSPIRV()) * sizeof(uint32_t);
+    }
+  }
+
   uint32_t maxSlot = uint32_t(feedbackStorageSize / sizeof(uint32_t));
 
   // add some extra padding just in case of out-of-bounds writes
   feedbackStorageSize += 128;
 
   // if we don't have any array descriptors or printf's to feedback then just return now
-  if(offsetMap.empty() && !usesPrintf)
+  if(offsetMap.empty() && !usesPrintf && !profileBlocks)
   {
     return false;
   }
@@ -1622,6 +1768,9 @@ bool VulkanReplay::FetchShaderFeedback(uint32_t eventId)
 
     m_BindlessFeedback.FeedbackBuffer.Destroy();
     m_BindlessFeedback.FeedbackBuffer.Create(m_pDriver, dev, feedbackStorageSize, 1, flags);
+
+    // any instrumented shaders may have the old buffer's address baked in
+    m_BindlessFeedback.ClearInstrumentation(m_pDriver);
   }
 
   VkDeviceAddress bufferAddress = 0;
@@ -1713,148 +1862,204 @@ bool VulkanReplay::FetchShaderFeedback(uint32_t eventId)
     ObjDisp(dev)->UpdateDescriptorSets(Unwrap(dev), 1, &write, 0, NULL);
   }
 
-  // create vertex shader with modified code
-  VkShaderModuleCreateInfo moduleCreateInfo = {VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
-
-  VkShaderModule modules[6] = {};
-
-  const rdcstr filename[6] = {
-      "bindless_vertex.spv",   "bindless_hull.spv",  "bindless_domain.spv",
-      "bindless_geometry.spv", "bindless_pixel.spv", "bindless_compute.spv",
-  };
-
-  std::map<uint32_t, PrintfData> printfData[6];
+  bool usesMultiview = false;
 
-  if(result.compute)
+  if(!result.compute)
   {
-    VkPipelineShaderStageCreateInfo &stage = computeInfo.stage;
-
-    const VulkanCreationInfo::ShaderModule &moduleInfo =
-        creationInfo.m_ShaderModule[pipeInfo.shaders[5].module];
-
-    rdcarray<uint32_t> modSpirv = moduleInfo.spirv.GetSPIRV();
-
-    if(!Vulkan_Debug_FeedbackDumpDirPath().empty())
-      FileIO::WriteAll(Vulkan_Debug_FeedbackDumpDirPath() + "/before_" + filename[5], modSpirv);
-
-    if(m_pDriver->GetDeviceEnabledFeatures().shaderInt64)
-    {
-      AnnotateShader<uint64_t>(*pipeInfo.shaders[5].refl, *pipeInfo.shaders[5].patchData,
-                               ShaderStage(StageIndex(stage.stage)), stage.pName, offsetMap,
-                               maxSlot, false, bufferAddress, useBufferAddressKHR, false, modSpirv,
-                               printfData[5]);
-    }
-    else
-    {
-      AnnotateShader<uint32_t>(*pipeInfo.shaders[5].refl, *pipeInfo.shaders[5].patchData,
-                               ShaderStage(StageIndex(stage.stage)), stage.pName, offsetMap,
-                               maxSlot, false, bufferAddress, useBufferAddressKHR, false, modSpirv,
-                               printfData[5]);
-    }
-
-    if(!Vulkan_Debug_FeedbackDumpDirPath().empty())
-      FileIO::WriteAll(Vulkan_Debug_FeedbackDumpDirPath() + "/after_" + filename[5], modSpirv);
-
-    moduleCreateInfo.pCode = modSpirv.data();
-    moduleCreateInfo.codeSize = modSpirv.size() * sizeof(uint32_t);
+    usesMultiview = state.GetRenderPass() != ResourceId()
+                        ? creationInfo.m_RenderPass[state.GetRenderPass()]
+                                  .subpasses[state.subpass]
+                                  .multiviews.size() > 1
+                        : pipeInfo.viewMask != 0;
+  }
 
-    vkr = m_pDriver->vkCreateShaderModule(dev, &moduleCreateInfo, NULL, &modules[0]);
-    CheckVkResult(vkr);
+  // instrumenting the shaders only depends on the pipeline and the feedback buffer layout, so the
+  // modules are kept and re-used when another event with the same pipeline is selected
+  VKFeedbackInstrumentation *&instrumented = m_BindlessFeedback.Instrumented[pipe.pipeline];
 
-    stage.module = modules[0];
-  }
-  else
+  if(instrumented && (instrumented->feedbackStorageSize != feedbackStorageSize ||
+                      instrumented->usesMultiview != usesMultiview))
   {
-    bool hasGeom = false;
+    instrumented->Destroy(m_pDriver);
+    SAFE_DELETE(instrumented);
+  }
 
-    for(uint32_t i = 0; i < graphicsInfo.stageCount; i++)
-    {
-      VkPipelineShaderStageCreateInfo &stage =
-          (VkPipelineShaderStageCreateInfo &)graphicsInfo.pStages[i];
+  if(!instrumented)
+  {
+    instrumented = new VKFeedbackInstrumentation;
+    instrumented->feedbackStorageSize = feedbackStorageSize;
+    instrumented->usesMultiview = usesMultiview;
 
-      if((stage.stage & VK_SHADER_STAGE_GEOMETRY_BIT) != 0)
-      {
-        hasGeom = true;
-        break;
-      }
-    }
+    for(uint32_t idx = 0; idx < ARRAY_COUNT(blockCounterOffsets); idx++)
+      instrumented->blockCounters[idx].offset = blockCounterOffsets[idx];
 
-    bool usePrimitiveID =
-        !hasGeom && m_pDriver->GetDeviceEnabledFeatures().geometryShader != VK_FALSE;
+    VkShaderModuleCreateInfo moduleCreateInfo = {VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
 
-    bool usesMultiview = state.GetRenderPass() != ResourceId()
-                             ? creationInfo.m_RenderPass[state.GetRenderPass()]
-                                       .subpasses[state.subpass]
-                                       .multiviews.size() > 1
-                             : pipeInfo.viewMask != 0;
+    const rdcstr filename[6] = {
+        "bindless_vertex.spv",   "bindless_hull.spv",  "bindless_domain.spv",
+        "bindless_geometry.spv", "bindless_pixel.spv", "bindless_compute.spv",
+    };
 
-    for(uint32_t i = 0; i < graphicsInfo.stageCount; i++)
+    if(result.compute)
     {
-      VkPipelineShaderStageCreateInfo &stage =
-          (VkPipelineShaderStageCreateInfo &)graphicsInfo.pStages[i];
-
-      if(stage.stage & VK_SHADER_STAGE_FRAGMENT_BIT)
-      {
-        if(!m_pDriver->GetDeviceEnabledFeatures().fragmentStoresAndAtomics)
-          continue;
-      }
-      else
-      {
-        if(!m_pDriver->GetDeviceEnabledFeatures().vertexPipelineStoresAndAtomics)
-          continue;
-      }
-
-      int idx = StageIndex(stage.stage);
+      VkPipelineShaderStageCreateInfo &stage = computeInfo.stage;
 
       const VulkanCreationInfo::ShaderModule &moduleInfo =
-          creationInfo.m_ShaderModule[pipeInfo.shaders[idx].module];
+          creationInfo.m_ShaderModule[pipeInfo.shaders[5].module];
 
       rdcarray<uint32_t> modSpirv = moduleInfo.spirv.GetSPIRV();
 
       if(!Vulkan_Debug_FeedbackDumpDirPath().empty())
-        FileIO::WriteAll(Vulkan_Debug_FeedbackDumpDirPath() + "/before_" + filename[idx], modSpirv);
+        FileIO::WriteAll(Vulkan_Debug_FeedbackDumpDirPath() + "/before_" + filename[5], modSpirv);
 
       if(m_pDriver->GetDeviceEnabledFeatures().shaderInt64)
       {
-        AnnotateShader<uint64_t>(*pipeInfo.shaders[idx].refl, *pipeInfo.shaders[idx].patchData,
+        AnnotateShader<uint64_t>(*pipeInfo.shaders[5].refl, *pipeInfo.shaders[5].patchData,
                                  ShaderStage(StageIndex(stage.stage)), stage.pName, offsetMap,
-                                 maxSlot, usePrimitiveID, bufferAddress, useBufferAddressKHR,
-                                 usesMultiview, modSpirv, printfData[idx]);
+                                 maxSlot, false, bufferAddress, useBufferAddressKHR, false,
+                                 printfBufferSize,
+                                 profileBlocks ? &instrumented->blockCounters[5] : NULL,
+                                 modSpirv, instrumented->printfData[5]);
       }
       else
       {
-        AnnotateShader<uint32_t>(*pipeInfo.shaders[idx].refl, *pipeInfo.shaders[idx].patchData,
+        AnnotateShader<uint32_t>(*pipeInfo.shaders[5].refl, *pipeInfo.shaders[5].patchData,
                                  ShaderStage(StageIndex(stage.stage)), stage.pName, offsetMap,
-                                 maxSlot, usePrimitiveID, bufferAddress, useBufferAddressKHR,
-                                 usesMultiview, modSpirv, printfData[idx]);
+                                 maxSlot, false, bufferAddress, useBufferAddressKHR, false,
+                                 printfBufferSize,
+                                 profileBlocks ? &instrumented->blockCounters[5] : NULL,
+                                 modSpirv, instrumented->printfData[5]);
       }
 
       if(!Vulkan_Debug_FeedbackDumpDirPath().empty())
-        FileIO::WriteAll(Vulkan_Debug_FeedbackDumpDirPath() + "/after_" + filename[idx], modSpirv);
+        FileIO::WriteAll(Vulkan_Debug_FeedbackDumpDirPath() + "/after_" + filename[5], modSpirv);
 
       moduleCreateInfo.pCode = modSpirv.data();
       moduleCreateInfo.codeSize = modSpirv.size() * sizeof(uint32_t);
 
-      vkr = m_pDriver->vkCreateShaderModule(dev, &moduleCreateInfo, NULL, &modules[i]);
+      vkr = m_pDriver->vkCreateShaderModule(dev, &moduleCreateInfo, NULL,
+                                            &instrumented->modules[0]);
       CheckVkResult(vkr);
+    }
+    else
+    {
+      bool hasGeom = false;
+
+      for(uint32_t i = 0; i < graphicsInfo.stageCount; i++)
+      {
+        VkPipelineShaderStageCreateInfo &stage =
+            (VkPipelineShaderStageCreateInfo &)graphicsInfo.pStages[i];
 
-      stage.module = modules[i];
+        if((stage.stage & VK_SHADER_STAGE_GEOMETRY_BIT) != 0)
+        {
+          hasGeom = true;
+          break;
+        }
+      }
+
+      bool usePrimitiveID =
+          !hasGeom && m_pDriver->GetDeviceEnabledFeatures().geometryShader != VK_FALSE;
+
+      for(uint32_t i = 0; i < graphicsInfo.stageCount; i++)
+      {
+        VkPipelineShaderStageCreateInfo &stage =
+            (VkPipelineShaderStageCreateInfo &)graphicsInfo.pStages[i];
+
+        if(stage.stage & VK_SHADER_STAGE_FRAGMENT_BIT)
+        {
+          if(!m_pDriver->GetDeviceEnabledFeatures().fragmentStoresAndAtomics)
+            continue;
+        }
+        else
+        {
+          if(!m_pDriver->GetDeviceEnabledFeatures().vertexPipelineStoresAndAtomics)
+            continue;
+        }
+
+        int idx = StageIndex(stage.stage);
+
+        const VulkanCreationInfo::ShaderModule &moduleInfo =
+            creationInfo.m_ShaderModule[pipeInfo.shaders[idx].module];
+
+        rdcarray<uint32_t> modSpirv = moduleInfo.spirv.GetSPIRV();
+
+        if(!Vulkan_Debug_FeedbackDumpDirPath().empty())
+          FileIO::WriteAll(Vulkan_Debug_FeedbackDumpDirPath() + "/before_" + filename[idx],
+                           modSpirv);
+
+        if(m_pDriver->GetDeviceEnabledFeatures().shaderInt64)
+        {
+          AnnotateShader<uint64_t>(*pipeInfo.shaders[idx].refl, *pipeInfo.shaders[idx].patchData,
+                                   ShaderStage(StageIndex(stage.stage)), stage.pName, offsetMap,
+                                   maxSlot, usePrimitiveID, bufferAddress, useBufferAddressKHR,
+                                   usesMultiview, printfBufferSize,
+                                   profileBlocks ? &instrumented->blockCounters[idx] : NULL,
+                                   modSpirv, instrumented->printfData[idx]);
+        }
+        else
+        {
+          AnnotateShader<uint32_t>(*pipeInfo.shaders[idx].refl, *pipeInfo.shaders[idx].patchData,
+                                   ShaderStage(StageIndex(stage.stage)), stage.pName, offsetMap,
+                                   maxSlot, usePrimitiveID, bufferAddress, useBufferAddressKHR,
+                                   usesMultiview, printfBufferSize,
+                                   profileBlocks ? &instrumented->blockCounters[idx] : NULL,
+                                   modSpirv, instrumented->printfData[idx]);
+        }
+
+        if(!Vulkan_Debug_FeedbackDumpDirPath().empty())
+          FileIO::WriteAll(Vulkan_Debug_FeedbackDumpDirPath() + "/after_" + filename[idx],
+                           modSpirv);
+
+        moduleCreateInfo.pCode = modSpirv.data();
+        moduleCreateInfo.codeSize = modSpirv.size() * sizeof(uint32_t);
+
+        vkr = m_pDriver->vkCreateShaderModule(dev, &moduleCreateInfo, NULL,
+                                              &instrumented->modules[i]);
+        CheckVkResult(vkr);
+      }
     }
   }
 
-  VkPipeline feedbackPipe;
+  std::map<uint32_t, PrintfData> *printfData = instrumented->printfData;
 
   if(result.compute)
   {
-    vkr = m_pDriver->vkCreateComputePipelines(m_Device, VK_NULL_HANDLE, 1, &computeInfo, NULL,
-                                              &feedbackPipe);
-    CheckVkResult(vkr);
+    computeInfo.stage.module = instrumented->modules[0];
   }
   else
   {
-    vkr = m_pDriver->vkCreateGraphicsPipelines(m_Device, VK_NULL_HANDLE, 1, &graphicsInfo, NULL,
-                                               &feedbackPipe);
-    CheckVkResult(vkr);
+    for(uint32_t i = 0; i < graphicsInfo.stageCount; i++)
+    {
+      VkPipelineShaderStageCreateInfo &stage =
+          (VkPipelineShaderStageCreateInfo &)graphicsInfo.pStages[i];
+
+      // stages that couldn't be instrumented keep their original module
+      if(instrumented->modules[i] != VK_NULL_HANDLE)
+        stage.module = instrumented->modules[i];
+    }
+  }
+
+  // with buffer addresses nothing in the pipeline is specific to this event, so it can be kept
+  // too. Otherwise it's created against this event's patched descriptor set layouts.
+  VkPipeline feedbackPipe = instrumented->pipe;
+
+  if(feedbackPipe == VK_NULL_HANDLE)
+  {
+    if(result.compute)
+    {
+      vkr = m_pDriver->vkCreateComputePipelines(m_Device, VK_NULL_HANDLE, 1, &computeInfo, NULL,
+                                                &feedbackPipe);
+      CheckVkResult(vkr);
+    }
+    else
+    {
+      vkr = m_pDriver->vkCreateGraphicsPipelines(m_Device, VK_NULL_HANDLE, 1, &graphicsInfo, NULL,
+                                                 &feedbackPipe);
+      CheckVkResult(vkr);
+    }
+
+    if(useBufferAddress)
+      instrumented->pipe = feedbackPipe;
   }
 
   // make copy of state to draw from
@@ -1961,18 +2166,64 @@ bool VulkanReplay::FetchShaderFeedback(uint32_t eventId)
 
   result.valid = true;
 
+  // find the line in a stage's disassembly for an instruction offset in the original module
+  auto getDisassemblyLine = [&](ShaderStage stage, size_t instruction) -> int32_t {
+    const VulkanCreationInfo::Pipeline::Shader &sh = pipeInfo.shaders[(uint32_t)stage];
+
+    VulkanCreationInfo::ShaderModule &mod = creationInfo.m_ShaderModule[sh.module];
+    VulkanCreationInfo::ShaderModuleReflection &modrefl =
+        mod.GetReflection(stage, sh.entryPoint, pipe.pipeline);
+    modrefl.PopulateDisassembly(mod.spirv);
+
+    auto instit = modrefl.instructionLines.find(instruction);
+    if(instit != modrefl.instructionLines.end())
+      return (int32_t)instit->second;
+
+    return -1;
+  };
+
   uint32_t *printfBuf = (uint32_t *)data.data();
-  uint32_t *printfBufEnd = (uint32_t *)(data.data() + Vulkan_Debug_PrintfBufferSize());
+  uint32_t *printfBufEnd = (uint32_t *)(data.data() + printfBufferSize);
+
+  uint32_t printfBytesNeeded = 0;
   if(usesPrintf && *printfBuf > 0)
   {
     uint32_t wordsNeeded = *printfBuf;
 
-    if(wordsNeeded > Vulkan_Debug_PrintfBufferSize())
+    // the GPU side counter keeps counting past the end of the buffer, so we know exactly how much
+    // space the event needed even though the messages themselves were clamped
+    if(wordsNeeded >= printfBufferSize / sizeof(uint32_t))
+      printfBytesNeeded = (wordsNeeded + 1) * sizeof(uint32_t);
+  }
+
+  // if the printf output didn't fit, grow the buffer to fit it and run this event again rather than
+  // returning truncated messages. The messages are packed on the GPU by the atomic counter so the
+  // size needed only depends on how much was actually printed.
+  bool rerun = false;
+  if(printfBytesNeeded > 0)
+  {
+    if(printfBufferSize < MaxPrintfBufferSize)
+    {
+      uint32_t newSize = printfBufferSize;
+      while(newSize < printfBytesNeeded && newSize < MaxPrintfBufferSize)
+        newSize *= 2;
+      newSize = RDCMIN(newSize, MaxPrintfBufferSize);
+
+      RDCLOG("printf buffer overflowed at event %u, needed %u bytes. Growing from %u to %u bytes",
+             eventId, printfBytesNeeded, printfBufferSize, newSize);
+
+      m_BindlessFeedback.PrintfBufferSize = newSize;
+      rerun = true;
+    }
+    else
     {
       RDCLOG("printf buffer overflowed, needed %u bytes but printf buffer is only %u bytes",
-             wordsNeeded * 4, Vulkan_Debug_PrintfBufferSize());
+             printfBytesNeeded, printfBufferSize);
     }
+  }
 
+  if(!rerun && usesPrintf && *printfBuf > 0)
+  {
     printfBuf++;
 
     while(*printfBuf && printfBuf < printfBufEnd)
@@ -2012,20 +2263,7 @@ bool VulkanReplay::FetchShaderFeedback(uint32_t eventId)
 
         const VulkanCreationInfo::Pipeline::Shader &sh = pipeInfo.shaders[(uint32_t)stage];
 
-        {
-          VulkanCreationInfo::ShaderModule &mod = creationInfo.m_ShaderModule[sh.module];
-          VulkanCreationInfo::ShaderModuleReflection &modrefl =
-              mod.GetReflection(stage, sh.entryPoint, pipe.pipeline);
-          modrefl.PopulateDisassembly(mod.spirv);
-
-          const std::map<size_t, uint32_t> instructionLines = modrefl.instructionLines;
-
-          auto instit = instructionLines.find(printfID);
-          if(instit != instructionLines.end())
-            msg.disassemblyLine = (int32_t)instit->second;
-          else
-            msg.disassemblyLine = -1;
-        }
+        msg.disassemblyLine = getDisassemblyLine(stage, printfID);
 
         if(stage == ShaderStage::Compute)
         {
@@ -2082,6 +2320,30 @@ bool VulkanReplay::FetchShaderFeedback(uint32_t eventId)
     }
   }
 
+  if(!rerun && profileBlocks)
+  {
+    // report each block that ran as a message on its label, so the counts can be found from the
+    // disassembly
+    for(uint32_t idx = 0; idx < ARRAY_COUNT(instrumented->blockCounters); idx++)
+    {
+      const BlockCounters &counters = instrumented->blockCounters[idx];
+      const uint32_t *counts = (const uint32_t *)(data.data() + counters.offset);
+
+      for(size_t b = 0; b < counters.labels.size(); b++)
+      {
+        if(counts[b] == 0)
+          continue;
+
+        ShaderMessage msg;
+        msg.stage = ShaderStage(idx);
+        msg.disassemblyLine = getDisassemblyLine(msg.stage, counters.labels[b]);
+        msg.message = StringFormat::Fmt("Block executed %u times", counts[b]);
+
+        result.messages.push_back(msg);
+      }
+    }
+  }
+
   if(descpool != VK_NULL_HANDLE)
   {
     // delete descriptors. Technically we don't have to free the descriptor sets, but our tracking
@@ -2098,13 +2360,17 @@ bool VulkanReplay::FetchShaderFeedback(uint32_t eventId)
   // delete pipeline layout
   m_pDriver->vkDestroyPipelineLayout(dev, pipeLayout, NULL);
 
-  // delete pipeline
-  m_pDriver->vkDestroyPipeline(dev, feedbackPipe, NULL);
+  // delete pipeline, if it wasn't kept with the instrumented shaders
+  if(feedbackPipe != instrumented->pipe)
+    m_pDriver->vkDestroyPipeline(dev, feedbackPipe, NULL);
 
-  // delete shader/shader module
-  for(size_t i = 0; i < ARRAY_COUNT(modules); i++)
-    if(modules[i] != VK_NULL_HANDLE)
-      m_pDriver->vkDestroyShaderModule(dev, modules[i], NULL);
+  if(rerun)
+  {
+    // only this event is fetched again, with the larger buffer. Other events already fetched had
+    // output that fit so they don't need to be re-run.
+    m_BindlessFeedback.Usage.erase(eventId);
+    return FetchShaderFeedback(eventId);
+  }
 
   return true;
 }
@@ -1382,6 +1382,26 @@ public:
   {
     RDCASSERT(params.size() <= 3, params.size());
 
+    // math ops are pure functions of their inputs, and the lanes of a quad or the iterations of a
+    // loop often evaluate the same op on identical values. Remember results to skip the round-trip
+    bytebuf key;
+    key.append((const byte *)&op, sizeof(op));
+    key.push_back((byte)output.type);
+    for(const ShaderVariable &p : params)
+    {
+      key.push_back((byte)p.type);
+      key.push_back(p.columns);
+      key.append(p.value.u8v.data(), VarTypeByteSize(p.type) * p.columns);
+    }
+
+    auto cached = m_MathOpResults.find(key);
+    if(cached != m_MathOpResults.end())
+    {
+      output.columns = cached->second.columns;
+      output.value = cached->second.value;
+      return true;
+    }
+
     int floatSizeIdx = 0;
     if(params[0].type == VarType::Half)
       floatSizeIdx = 1;
@@ -1499,6 +1519,12 @@ public:
 
     m_DebugData.ReadbackBuffer.Unmap();
 
+    // bound the cache for very long traces, it's only an optimisation
+    if(m_MathOpResults.size() >= 16384)
+      m_MathOpResults.clear();
+
+    m_MathOpResults[key] = {output.columns, output.value};
+
     return true;
   }
 
@@ -1523,6 +1549,13 @@ private:
 
   bytebuf pushData;
 
+  struct MathOpResult
+  {
+    uint8_t columns;
+    ShaderValue value;
+  };
+  std::map<bytebuf, MathOpResult> m_MathOpResults;
+
   std::map<BindpointIndex, bytebuf> bufferCache;
 
   struct ImageData
@@ -2913,12 +2946,18 @@ enum class InputSpecConstant
   ArrayLength,
   DestX,
   DestY,
+  DestHalfWidth,
+  DestHalfHeight,
   AddressMSB,
   Count,
 };
 
 static const uint32_t validMagicNumber = 12345;
 
+// the largest rectangle of pixels that DebugPixels will fetch inputs for in one pass. The output
+// buffer holds every overdraw of every pixel in the rectangle so it grows quickly
+static const uint32_t MaxPixelDebugBatchArea = 8 * 8;
+
 struct PSHit
 {
   Vec4f pos;
@@ -3246,6 +3285,19 @@ static void CreatePSInputFetcher(rdcarray<uint32_t> &fragspv, uint32_t &structSt
 
   editor.SetName(destXY, "destXY");
 
+  // the half-size of the rectangle of pixels to fetch, centred on destXY. This is 0.5 to fetch a
+  // single pixel
+  rdcspv::Id destHalfW =
+      editor.AddSpecConstantImmediate<float>(0.5f, (uint32_t)InputSpecConstant::DestHalfWidth);
+  rdcspv::Id destHalfH =
+      editor.AddSpecConstantImmediate<float>(0.5f, (uint32_t)InputSpecConstant::DestHalfHeight);
+
+  editor.SetName(destHalfW, "destHalfW");
+  editor.SetName(destHalfH, "destHalfH");
+
+  rdcspv::Id destHalfSize = editor.AddConstant(
+      rdcspv::OpSpecConstantComposite(float2Type, editor.MakeId(), {destHalfW, destHalfH}));
+
   rdcspv::Id PSHit = editor.DeclareStructType({
       // float4 pos;
       float4Type,
@@ -3640,18 +3692,14 @@ static void CreatePSInputFetcher(rdcarray<uint32_t> &fragspv, uint32_t &structSt
       rdcspv::Id fragXYAbs = ops.add(rdcspv::OpGLSL450(float2Type, editor.MakeId(), glsl450,
                                                        rdcspv::GLSLstd450::FAbs, {fragXYRelative}));
 
-      rdcspv::Id half = editor.AddConstantImmediate<float>(0.5f);
-      rdcspv::Id threshold =
-          editor.AddConstant(rdcspv::OpConstantComposite(float2Type, editor.MakeId(), {half, half}));
-
-      // less than 0.5
+      // less than the half size
       rdcspv::Id inPixelXY =
-          ops.add(rdcspv::OpFOrdLessThan(bool2Type, editor.MakeId(), fragXYAbs, threshold));
+          ops.add(rdcspv::OpFOrdLessThan(bool2Type, editor.MakeId(), fragXYAbs, destHalfSize));
 
-      // both less than 0.5
+      // both less than the half size
       rdcspv::Id inPixel = ops.add(rdcspv::OpAll(boolType, editor.MakeId(), inPixelXY));
 
-      // bool inPixel = all(abs(gl_FragCoord.xy - dest.xy) < 0.5f);
+      // bool inPixel = all(abs(gl_FragCoord.xy - dest.xy) < destHalfSize);
 
       rdcspv::Id killLabel = editor.MakeId();
       rdcspv::Id continueLabel = editor.MakeId();
@@ -4049,16 +4097,57 @@ ShaderDebugTrace *VulkanReplay::DebugVertex(uint32_t eventId, uint32_t vertid, u
 ShaderDebugTrace *VulkanReplay::DebugPixel(uint32_t eventId, uint32_t x, uint32_t y,
                                            uint32_t sample, uint32_t primitive)
 {
+  return DebugPixels(eventId, {{x, y}}, sample, primitive)[0];
+}
+
+rdcarray<ShaderDebugTrace *> VulkanReplay::DebugPixels(
+    uint32_t eventId, const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels, uint32_t sample,
+    uint32_t primitive)
+{
+  // one trace is always returned per pixel, even when debugging fails
+  auto emptyTraces = [&pixels]() {
+    rdcarray<ShaderDebugTrace *> ret;
+    for(size_t i = 0; i < pixels.size(); i++)
+      ret.push_back(new ShaderDebugTrace);
+    return ret;
+  };
+
+  if(pixels.empty())
+    return {};
+
   if(!GetAPIProperties().shaderDebugging)
   {
     RDCUNIMPLEMENTED("Pixel debugging not yet implemented for Vulkan");
-    return new ShaderDebugTrace;
+    return emptyTraces();
   }
 
   if(!m_pDriver->GetDeviceEnabledFeatures().fragmentStoresAndAtomics)
   {
     RDCWARN("Pixel debugging is not supported without fragment stores");
-    return new ShaderDebugTrace;
+    return emptyTraces();
+  }
+
+  // all pixels are fetched in one pass over the rectangle that bounds them, with room in the
+  // output for the same overdraw per pixel as when debugging a single one. If they're spread too
+  // far apart that would be too large, so debug them one by one instead.
+  uint32_t minX = ~0U, minY = ~0U, maxX = 0, maxY = 0;
+  for(const rdcpair<uint32_t, uint32_t> &p : pixels)
+  {
+    minX = RDCMIN(minX, p.first);
+    minY = RDCMIN(minY, p.second);
+    maxX = RDCMAX(maxX, p.first);
+    maxY = RDCMAX(maxY, p.second);
+  }
+
+  const uint32_t rectWidth = maxX - minX + 1;
+  const uint32_t rectHeight = maxY - minY + 1;
+
+  if(pixels.size() > 1 && uint64_t(rectWidth) * rectHeight > MaxPixelDebugBatchArea)
+  {
+    rdcarray<ShaderDebugTrace *> ret;
+    for(const rdcpair<uint32_t, uint32_t> &p : pixels)
+      ret.push_back(DebugPixel(eventId, p.first, p.second, sample, primitive));
+    return ret;
   }
 
   VkDevice dev = m_pDriver->GetDev();
@@ -4067,8 +4156,14 @@ ShaderDebugTrace *VulkanReplay::DebugPixel(uint32_t eventId, uint32_t x, uint32_
   const VulkanRenderState &state = m_pDriver->GetRenderState();
   VulkanCreationInfo &c = m_pDriver->m_CreationInfo;
 
-  rdcstr regionName = StringFormat::Fmt("DebugPixel @ %u of (%u,%u) sample %u primitive %u",
-                                        eventId, x, y, sample, primitive);
+  rdcstr regionName;
+  if(pixels.size() == 1)
+    regionName = StringFormat::Fmt("DebugPixel @ %u of (%u,%u) sample %u primitive %u", eventId,
+                                   minX, minY, sample, primitive);
+  else
+    regionName =
+        StringFormat::Fmt("DebugPixels @ %u of %zu in (%u,%u)-(%u,%u) sample %u primitive %u",
+                          eventId, pixels.size(), minX, minY, maxX, maxY, sample, primitive);
 
   VkMarkerRegion region(regionName);
 
@@ -4080,7 +4175,7 @@ ShaderDebugTrace *VulkanReplay::DebugPixel(uint32_t eventId, uint32_t x, uint32_
   if(!(action->flags & ActionFlags::Drawcall))
   {
     RDCLOG("No drawcall selected");
-    return new ShaderDebugTrace();
+    return emptyTraces();
   }
 
   const VulkanCreationInfo::Pipeline &pipe = c.m_Pipeline[state.graphics.pipeline];
@@ -4088,7 +4183,7 @@ ShaderDebugTrace *VulkanReplay::DebugPixel(uint32_t eventId, uint32_t x, uint32_
   if(pipe.shaders[4].module == ResourceId())
   {
     RDCLOG("No pixel shader bound at draw");
-    return new ShaderDebugTrace();
+    return emptyTraces();
   }
 
   // get ourselves in pristine state before this action (without any side effects it may have had)
@@ -4104,20 +4199,11 @@ ShaderDebugTrace *VulkanReplay::DebugPixel(uint32_t eventId, uint32_t x, uint32_
   if(!shadRefl.refl->debugInfo.debuggable)
   {
     RDCLOG("Shader is not debuggable: %s", shadRefl.refl->debugInfo.debugStatus.c_str());
-    return new ShaderDebugTrace();
+    return emptyTraces();
   }
 
   shadRefl.PopulateDisassembly(shader.spirv);
 
-  VulkanAPIWrapper *apiWrapper =
-      new VulkanAPIWrapper(m_pDriver, c, VK_SHADER_STAGE_FRAGMENT_BIT, eventId);
-
-  std::map<ShaderBuiltin, ShaderVariable> &builtins = apiWrapper->builtin_inputs;
-  builtins[ShaderBuiltin::DeviceIndex] = ShaderVariable(rdcstr(), 0U, 0U, 0U, 0U);
-  builtins[ShaderBuiltin::DrawIndex] = ShaderVariable(rdcstr(), action->drawIndex, 0U, 0U, 0U);
-  builtins[ShaderBuiltin::Position] =
-      ShaderVariable(rdcstr(), float(x) + 0.5f, float(y) + 0.5f, 0.0f, 0.0f);
-
   // If the pipe contains a geometry shader, then Primitive ID cannot be used in the pixel
   // shader without being emitted from the geometry shader. For now, check if this semantic
   // will succeed in a new pixel shader with the rest of the pipe unchanged
@@ -4221,7 +4307,8 @@ ShaderDebugTrace *VulkanReplay::DebugPixel(uint32_t eventId, uint32_t x, uint32_
   if(!Vulkan_Debug_PSDebugDumpDirPath().empty())
     FileIO::WriteAll(Vulkan_Debug_PSDebugDumpDirPath() + "/debug_psinput_after.spv", fragspv);
 
-  uint32_t overdrawLevels = 100;    // maximum number of overdraw levels
+  // maximum number of overdraw levels, per pixel in the fetched rectangle
+  uint32_t overdrawLevels = 100 * rectWidth * rectHeight;
 
   VkGraphicsPipelineCreateInfo graphicsInfo = {};
 
@@ -4255,11 +4342,15 @@ ShaderDebugTrace *VulkanReplay::DebugPixel(uint32_t eventId, uint32_t x, uint32_
     uint32_t arrayLength;
     float destX;
     float destY;
+    float destHalfWidth;
+    float destHalfHeight;
   } specData = {};
 
   specData.arrayLength = overdrawLevels;
-  specData.destX = float(x) + 0.5f;
-  specData.destY = float(y) + 0.5f;
+  specData.destX = float(minX) + float(rectWidth) * 0.5f;
+  specData.destY = float(minY) + float(rectHeight) * 0.5f;
+  specData.destHalfWidth = float(rectWidth) * 0.5f;
+  specData.destHalfHeight = float(rectHeight) * 0.5f;
 
   VkDescriptorPool descpool = VK_NULL_HANDLE;
   rdcarray<VkDescriptorSetLayout> setLayouts;
@@ -4302,10 +4393,9 @@ ShaderDebugTrace *VulkanReplay::DebugPixel(uint32_t eventId, uint32_t x, uint32_
     // if the pool failed due to limits, it will be NULL so bail now
     if(descpool == VK_NULL_HANDLE)
     {
-      delete apiWrapper;
-
-      ShaderDebugTrace *ret = new ShaderDebugTrace;
-      ret->stage = ShaderStage::Pixel;
+      rdcarray<ShaderDebugTrace *> ret = emptyTraces();
+      for(ShaderDebugTrace *trace : ret)
+        trace->stage = ShaderStage::Pixel;
 
       return ret;
     }
@@ -4367,6 +4457,14 @@ ShaderDebugTrace *VulkanReplay::DebugPixel(uint32_t eventId, uint32_t x, uint32_
       {
           (uint32_t)InputSpecConstant::DestY, offsetof(SpecData, destY), sizeof(SpecData::destY),
       },
+      {
+          (uint32_t)InputSpecConstant::DestHalfWidth, offsetof(SpecData, destHalfWidth),
+          sizeof(SpecData::destHalfWidth),
+      },
+      {
+          (uint32_t)InputSpecConstant::DestHalfHeight, offsetof(SpecData, destHalfHeight),
+          sizeof(SpecData::destHalfHeight),
+      },
       {
           (uint32_t)InputSpecConstant::AddressMSB, offsetof(SpecData, bufferAddress) + 4,
           sizeof(uint32_t),
@@ -4482,7 +4580,7 @@ ShaderDebugTrace *VulkanReplay::DebugPixel(uint32_t eventId, uint32_t x, uint32_
     VkCommandBuffer cmd = m_pDriver->GetNextCmd();
 
     if(cmd == VK_NULL_HANDLE)
-      return new ShaderDebugTrace;
+      return emptyTraces();
 
     VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
                                           VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
@@ -4538,187 +4636,210 @@ ShaderDebugTrace *VulkanReplay::DebugPixel(uint32_t eventId, uint32_t x, uint32_
 
   base += sizeof(Vec4f);
 
-  PSHit *winner = NULL;
-
   RDCLOG("Got %u hit candidates out of %u total instances", numHits, totalHits);
 
-  // if we encounter multiple hits at our destination pixel co-ord (or any other) we
-  // check to see if a specific primitive was requested (via primitive parameter not
-  // being set to ~0U). If it was, debug that pixel, otherwise do a best-estimate
-  // of which fragment was the last to successfully depth test and debug that, just by
-  // checking if the depth test is ordered and picking the final fragment in the series
-
-  // figure out the TL pixel's coords. Assume even top left (towards 0,0)
-  // this isn't spec'd but is a reasonable assumption.
-  int xTL = x & (~1);
-  int yTL = y & (~1);
-
-  // get the index of our desired pixel
-  int destIdx = (x - xTL) + 2 * (y - yTL);
-
   VkCompareOp depthOp = state.depthCompareOp;
 
   // depth tests disabled acts the same as always compare mode
   if(!state.depthTestEnable)
     depthOp = VK_COMPARE_OP_ALWAYS;
 
-  for(uint32_t i = 0; i < numHits; i++)
+  rdcarray<ShaderDebugTrace *> traces;
+
+  for(const rdcpair<uint32_t, uint32_t> &p : pixels)
   {
-    PSHit *hit = (PSHit *)(base + structSize * i);
+    const uint32_t x = p.first, y = p.second;
 
-    if(hit->valid != validMagicNumber)
-    {
-      RDCWARN("Hit %u doesn't have valid magic number", i);
-      continue;
-    }
+    PSHit *winner = NULL;
 
-    if(hit->ddxDerivCheck != 1.0f)
-    {
-      RDCWARN("Hit %u doesn't have valid derivatives", i);
-      continue;
-    }
+    // if we encounter multiple hits at our destination pixel co-ord (or any other) we
+    // check to see if a specific primitive was requested (via primitive parameter not
+    // being set to ~0U). If it was, debug that pixel, otherwise do a best-estimate
+    // of which fragment was the last to successfully depth test and debug that, just by
+    // checking if the depth test is ordered and picking the final fragment in the series
 
-    // see if this hit is a closer match than the previous winner.
+    // figure out the TL pixel's coords. Assume even top left (towards 0,0)
+    // this isn't spec'd but is a reasonable assumption.
+    int xTL = x & (~1);
+    int yTL = y & (~1);
 
-    // if there's no previous winner it's clearly better
-    if(winner == NULL)
-    {
-      winner = hit;
-      continue;
-    }
+    // get the index of our desired pixel
+    int destIdx = (x - xTL) + 2 * (y - yTL);
 
-    // if we're looking for a specific primitive
-    if(primitive != ~0U)
+    for(uint32_t i = 0; i < numHits; i++)
     {
-      // and this hit is a match and the winner isn't, it's better
-      if(winner->prim != primitive && hit->prim == primitive)
-      {
-        winner = hit;
+      PSHit *hit = (PSHit *)(base + structSize * i);
+
+      // hits are for every pixel in the rectangle, skip any that aren't for this one
+      if(uint32_t(hit->pos.x) != x || uint32_t(hit->pos.y) != y)
         continue;
-      }
 
-      // if the winner is a match and we're not, we can't be better so stop now
-      if(winner->prim == primitive && hit->prim != primitive)
+      if(hit->valid != validMagicNumber)
       {
+        RDCWARN("Hit %u doesn't have valid magic number", i);
         continue;
       }
-    }
 
-    // if we're looking for a particular sample, check that
-    if(sample != ~0U)
-    {
-      if(winner->sample != sample && hit->sample == sample)
+      if(hit->ddxDerivCheck != 1.0f)
       {
-        winner = hit;
+        RDCWARN("Hit %u doesn't have valid derivatives", i);
         continue;
       }
 
-      if(winner->sample == sample && hit->sample != sample)
+      // see if this hit is a closer match than the previous winner.
+
+      // if there's no previous winner it's clearly better
+      if(winner == NULL)
       {
+        winner = hit;
         continue;
       }
-    }
 
-    // otherwise apply depth test
-    switch(depthOp)
-    {
-      case VK_COMPARE_OP_NEVER:
-      case VK_COMPARE_OP_EQUAL:
-      case VK_COMPARE_OP_NOT_EQUAL:
-      case VK_COMPARE_OP_ALWAYS:
-      default:
-        // don't emulate equal or not equal since we don't know the reference value. Take any hit
-        // (thus meaning the last hit)
-        winner = hit;
-        break;
-      case VK_COMPARE_OP_LESS:
-        if(hit->pos.z < winner->pos.z)
-          winner = hit;
-        break;
-      case VK_COMPARE_OP_LESS_OR_EQUAL:
-        if(hit->pos.z <= winner->pos.z)
-          winner = hit;
-        break;
-      case VK_COMPARE_OP_GREATER:
-        if(hit->pos.z > winner->pos.z)
-          winner = hit;
-        break;
-      case VK_COMPARE_OP_GREATER_OR_EQUAL:
-        if(hit->pos.z >= winner->pos.z)
+      // if we're looking for a specific primitive
+      if(primitive != ~0U)
+      {
+        // and this hit is a match and the winner isn't, it's better
+        if(winner->prim != primitive && hit->prim == primitive)
+        {
           winner = hit;
-        break;
-    }
-  }
+          continue;
+        }
 
-  ShaderDebugTrace *ret = NULL;
+        // if the winner is a match and we're not, we can't be better so stop now
+        if(winner->prim == primitive && hit->prim != primitive)
+        {
+          continue;
+        }
+      }
 
-  if(winner)
-  {
-    rdcspv::Debugger *debugger = new rdcspv::Debugger;
-    debugger->Parse(shader.spirv.GetSPIRV());
-
-    // the data immediately follows the PSHit header. Every piece of data is uniformly aligned,
-    // either 16-byte by default or 32-byte if larger components exist. The output is in input
-    // signature order.
-    byte *PSInputs = (byte *)(winner + 1);
-    byte *value = (byte *)(PSInputs + 0 * structStride);
-    byte *ddxcoarse = (byte *)(PSInputs + 1 * structStride);
-    byte *ddycoarse = (byte *)(PSInputs + 2 * structStride);
-    byte *ddxfine = (byte *)(PSInputs + 3 * structStride);
-    byte *ddyfine = (byte *)(PSInputs + 4 * structStride);
+      // if we're looking for a particular sample, check that
+      if(sample != ~0U)
+      {
+        if(winner->sample != sample && hit->sample == sample)
+        {
+          winner = hit;
+          continue;
+        }
 
-    for(size_t i = 0; i < shadRefl.refl->inputSignature.size(); i++)
-    {
-      const SigParameter &param = shadRefl.refl->inputSignature[i];
+        if(winner->sample == sample && hit->sample != sample)
+        {
+          continue;
+        }
+      }
 
-      bool builtin = true;
-      if(param.systemValue == ShaderBuiltin::Undefined)
+      // otherwise apply depth test
+      switch(depthOp)
       {
-        builtin = false;
-        apiWrapper->location_inputs.resize(
-            RDCMAX((uint32_t)apiWrapper->location_inputs.size(), param.regIndex + 1));
-        apiWrapper->location_derivatives.resize(
-            RDCMAX((uint32_t)apiWrapper->location_derivatives.size(), param.regIndex + 1));
+        case VK_COMPARE_OP_NEVER:
+        case VK_COMPARE_OP_EQUAL:
+        case VK_COMPARE_OP_NOT_EQUAL:
+        case VK_COMPARE_OP_ALWAYS:
+        default:
+          // don't emulate equal or not equal since we don't know the reference value. Take any hit
+          // (thus meaning the last hit)
+          winner = hit;
+          break;
+        case VK_COMPARE_OP_LESS:
+          if(hit->pos.z < winner->pos.z)
+            winner = hit;
+          break;
+        case VK_COMPARE_OP_LESS_OR_EQUAL:
+          if(hit->pos.z <= winner->pos.z)
+            winner = hit;
+          break;
+        case VK_COMPARE_OP_GREATER:
+          if(hit->pos.z > winner->pos.z)
+            winner = hit;
+          break;
+        case VK_COMPARE_OP_GREATER_OR_EQUAL:
+          if(hit->pos.z >= winner->pos.z)
+            winner = hit;
+          break;
       }
+    }
 
-      ShaderVariable &var = builtin ? apiWrapper->builtin_inputs[param.systemValue]
-                                    : apiWrapper->location_inputs[param.regIndex];
-      rdcspv::DebugAPIWrapper::DerivativeDeltas &deriv =
-          builtin ? apiWrapper->builtin_derivatives[param.systemValue]
-                  : apiWrapper->location_derivatives[param.regIndex];
-
-      var.rows = 1;
-      var.columns = param.compCount & 0xff;
-      var.type = param.varType;
+    ShaderDebugTrace *ret = NULL;
 
-      deriv.ddxcoarse = var;
-      deriv.ddycoarse = var;
-      deriv.ddxfine = var;
-      deriv.ddyfine = var;
+    if(winner)
+    {
+      VulkanAPIWrapper *apiWrapper =
+          new VulkanAPIWrapper(m_pDriver, c, VK_SHADER_STAGE_FRAGMENT_BIT, eventId);
+
+      std::map<ShaderBuiltin, ShaderVariable> &builtins = apiWrapper->builtin_inputs;
+      builtins[ShaderBuiltin::DeviceIndex] = ShaderVariable(rdcstr(), 0U, 0U, 0U, 0U);
+      builtins[ShaderBuiltin::DrawIndex] = ShaderVariable(rdcstr(), action->drawIndex, 0U, 0U, 0U);
+      builtins[ShaderBuiltin::Position] =
+          ShaderVariable(rdcstr(), float(x) + 0.5f, float(y) + 0.5f, 0.0f, 0.0f);
+
+      rdcspv::Debugger *debugger = new rdcspv::Debugger;
+      debugger->Parse(shader.spirv.GetSPIRV());
+
+      // the data immediately follows the PSHit header. Every piece of data is uniformly aligned,
+      // either 16-byte by default or 32-byte if larger components exist. The output is in input
+      // signature order.
+      byte *PSInputs = (byte *)(winner + 1);
+      byte *value = (byte *)(PSInputs + 0 * structStride);
+      byte *ddxcoarse = (byte *)(PSInputs + 1 * structStride);
+      byte *ddycoarse = (byte *)(PSInputs + 2 * structStride);
+      byte *ddxfine = (byte *)(PSInputs + 3 * structStride);
+      byte *ddyfine = (byte *)(PSInputs + 4 * structStride);
+
+      for(size_t i = 0; i < shadRefl.refl->inputSignature.size(); i++)
+      {
+        const SigParameter &param = shadRefl.refl->inputSignature[i];
 
-      const uint32_t comp = Bits::CountTrailingZeroes(uint32_t(param.regChannelMask));
-      const uint32_t elemSize = VarTypeByteSize(param.varType);
+        bool builtin = true;
+        if(param.systemValue == ShaderBuiltin::Undefined)
+        {
+          builtin = false;
+          apiWrapper->location_inputs.resize(
+              RDCMAX((uint32_t)apiWrapper->location_inputs.size(), param.regIndex + 1));
+          apiWrapper->location_derivatives.resize(
+              RDCMAX((uint32_t)apiWrapper->location_derivatives.size(), param.regIndex + 1));
+        }
 
-      const size_t sz = elemSize * param.compCount;
+        ShaderVariable &var = builtin ? apiWrapper->builtin_inputs[param.systemValue]
+                                      : apiWrapper->location_inputs[param.regIndex];
+        rdcspv::DebugAPIWrapper::DerivativeDeltas &deriv =
+            builtin ? apiWrapper->builtin_derivatives[param.systemValue]
+                    : apiWrapper->location_derivatives[param.regIndex];
+
+        var.rows = 1;
+        var.columns = param.compCount & 0xff;
+        var.type = param.varType;
+
+        deriv.ddxcoarse = var;
+        deriv.ddycoarse = var;
+        deriv.ddxfine = var;
+        deriv.ddyfine = var;
+
+        const uint32_t comp = Bits::CountTrailingZeroes(uint32_t(param.regChannelMask));
+        const uint32_t elemSize = VarTypeByteSize(param.varType);
+
+        const size_t sz = elemSize * param.compCount;
+
+        memcpy((var.value.u8v.data()) + elemSize * comp, value + i * paramAlign, sz);
+        memcpy((deriv.ddxcoarse.value.u8v.data()) + elemSize * comp, ddxcoarse + i * paramAlign,
+               sz);
+        memcpy((deriv.ddycoarse.value.u8v.data()) + elemSize * comp, ddycoarse + i * paramAlign,
+               sz);
+        memcpy((deriv.ddxfine.value.u8v.data()) + elemSize * comp, ddxfine + i * paramAlign, sz);
+        memcpy((deriv.ddyfine.value.u8v.data()) + elemSize * comp, ddyfine + i * paramAlign, sz);
+      }
 
-      memcpy((var.value.u8v.data()) + elemSize * comp, value + i * paramAlign, sz);
-      memcpy((deriv.ddxcoarse.value.u8v.data()) + elemSize * comp, ddxcoarse + i * paramAlign, sz);
-      memcpy((deriv.ddycoarse.value.u8v.data()) + elemSize * comp, ddycoarse + i * paramAlign, sz);
-      memcpy((deriv.ddxfine.value.u8v.data()) + elemSize * comp, ddxfine + i * paramAlign, sz);
-      memcpy((deriv.ddyfine.value.u8v.data()) + elemSize * comp, ddyfine + i * paramAlign, sz);
+      ret = debugger->BeginDebug(apiWrapper, ShaderStage::Pixel, entryPoint, spec,
+                                 shadRefl.instructionLines, shadRefl.patchData, destIdx);
+      apiWrapper->ResetReplay();
     }
+    else
+    {
+      RDCLOG("Didn't get any valid hit to debug at (%u,%u)", x, y);
 
-    ret = debugger->BeginDebug(apiWrapper, ShaderStage::Pixel, entryPoint, spec,
-                               shadRefl.instructionLines, shadRefl.patchData, destIdx);
-    apiWrapper->ResetReplay();
-  }
-  else
-  {
-    RDCLOG("Didn't get any valid hit to debug");
-    delete apiWrapper;
+      ret = new ShaderDebugTrace;
+      ret->stage = ShaderStage::Pixel;
+    }
 
-    ret = new ShaderDebugTrace;
-    ret->stage = ShaderStage::Pixel;
+    traces.push_back(ret);
   }
 
   if(descpool != VK_NULL_HANDLE)
@@ -4743,7 +4864,7 @@ ShaderDebugTrace *VulkanReplay::DebugPixel(uint32_t eventId, uint32_t x, uint32_
   for(VkShaderModule s : modules)
     m_pDriver->vkDestroyShaderModule(dev, s, NULL);
 
-  return ret;
+  return traces;
 }
 
 ShaderDebugTrace *VulkanReplay::DebugThread(uint32_t eventId,
@@ -24,6 +24,8 @@
 
 #include "../vk_core.h"
 #include "../vk_debug.h"
+#include "../vk_replay.h"
+#include "common/inline_array.h"
 #include "core/settings.h"
 
 RDOC_DEBUG_CONFIG(
@@ -104,34 +106,25 @@ void WrappedVulkan::AddImplicitResolveResourceUsage(uint32_t subpass)
 
 rdcarray<VkImageMemoryBarrier> WrappedVulkan::GetImplicitRenderPassBarriers(uint32_t subpass)
 {
-  ResourceId rp, fb;
-  rdcarray<ResourceId> fbattachments;
-
-  if(m_LastCmdBufferID == ResourceId())
-  {
-    rp = m_RenderState.GetRenderPass();
-    fb = m_RenderState.GetFramebuffer();
-    fbattachments = m_RenderState.GetFramebufferAttachments();
-  }
-  else
-  {
-    const VulkanRenderState &renderstate = GetCmdRenderState();
-    rp = renderstate.GetRenderPass();
-    fb = renderstate.GetFramebuffer();
-    fbattachments = renderstate.GetFramebufferAttachments();
-  }
+  // this is called for every render pass begin/next/end, so avoid copying any of the render pass
+  // or framebuffer information and keep the attachment list off the heap
+  const VulkanRenderState &renderstate =
+      m_LastCmdBufferID == ResourceId() ? m_RenderState : GetCmdRenderState();
+  const ResourceId rp = renderstate.GetRenderPass();
+  const ResourceId fb = renderstate.GetFramebuffer();
+  const rdcarray<ResourceId> &fbattachments = renderstate.GetFramebufferAttachments();
 
   rdcarray<VkImageMemoryBarrier> ret;
 
-  VulkanCreationInfo::Framebuffer fbinfo = m_CreationInfo.m_Framebuffer[fb];
-  VulkanCreationInfo::RenderPass rpinfo = m_CreationInfo.m_RenderPass[rp];
+  const VulkanCreationInfo::Framebuffer &fbinfo = m_CreationInfo.m_Framebuffer[fb];
+  const VulkanCreationInfo::RenderPass &rpinfo = m_CreationInfo.m_RenderPass[rp];
 
   struct AttachmentRefSeparateStencil : VkAttachmentReference
   {
     VkImageLayout stencilLayout;
   };
 
-  rdcarray<AttachmentRefSeparateStencil> atts;
+  rdcinlinearray<AttachmentRefSeparateStencil, 8> atts;
 
   // a bit of dancing to get a subpass index. Because we don't increment
   // the subpass counter on EndRenderPass the value is the same for the last
@@ -3092,6 +3085,11 @@ bool WrappedVulkan::Serialise_vkCmdBindPipeline(SerialiserType &ser, VkCommandBu
       {
         commandBuffer = RerecordCmdBuf(m_LastCmdBufferID);
 
+        if(!m_PendingPipelineReplacements.empty() &&
+           m_PendingPipelineReplacements.find(GetResID(pipeline)) !=
+               m_PendingPipelineReplacements.end())
+          pipeline = GetReplay()->CreateReplacementPipeline(GetResID(pipeline));
+
         ResourceId liveid = GetResID(pipeline);
 
         {
@@ -3883,8 +3881,8 @@ bool WrappedVulkan::Serialise_vkCmdPipelineBarrier(
 
   SERIALISE_CHECK_READ_ERRORS();
 
-  rdcarray<VkImageMemoryBarrier> imgBarriers;
-  rdcarray<VkBufferMemoryBarrier> bufBarriers;
+  rdcinlinearray<VkImageMemoryBarrier, 8> imgBarriers;
+  rdcinlinearray<VkBufferMemoryBarrier, 8> bufBarriers;
 
   // it's possible for buffer or image to be NULL if it refers to a resource that is otherwise
   // not in the log (barriers do not mark resources referenced). If the resource in question does
@@ -4125,8 +4123,8 @@ bool WrappedVulkan::Serialise_vkCmdPipelineBarrier2(SerialiserType &ser,
 
   SERIALISE_CHECK_READ_ERRORS();
 
-  rdcarray<VkImageMemoryBarrier2> imgBarriers;
-  rdcarray<VkBufferMemoryBarrier2> bufBarriers;
+  rdcinlinearray<VkImageMemoryBarrier2, 8> imgBarriers;
+  rdcinlinearray<VkBufferMemoryBarrier2, 8> bufBarriers;
 
   // it's possible for buffer or image to be NULL if it refers to a resource that is otherwise
   // not in the log (barriers do not mark resources referenced). If the resource in question does
@@ -5014,6 +5012,8 @@ void WrappedVulkan::vkCmdDebugMarkerBeginEXT(VkCommandBuffer commandBuffer,
         ObjDisp(commandBuffer)->CmdDebugMarkerBeginEXT(Unwrap(commandBuffer), pMarker));
   }
 
+  if(pMarker)
+    HandleCaptureRangeLabel(pMarker->pMarkerName, commandBuffer);
   if(IsCaptureMode(m_State))
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
@@ -6011,6 +6011,8 @@ void WrappedVulkan::vkCmdBeginDebugUtilsLabelEXT(VkCommandBuffer commandBuffer,
         ObjDisp(commandBuffer)->CmdBeginDebugUtilsLabelEXT(Unwrap(commandBuffer), pLabelInfo));
   }
 
+  if(pLabelInfo)
+    HandleCaptureRangeLabel(pLabelInfo->pLabelName, commandBuffer);
   if(IsCaptureMode(m_State))
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
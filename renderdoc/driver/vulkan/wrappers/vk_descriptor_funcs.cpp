@@ -1262,10 +1262,34 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
       //
       // This is handled by RemoveBindFrameRef silently dropping id == ResourceId()
 
+      if(descWrite.descriptorType == VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK)
+      {
+        VkWriteDescriptorSetInlineUniformBlock *inlineWrite =
+            (VkWriteDescriptorSetInlineUniformBlock *)FindNextStruct(
+                &descWrite, VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_INLINE_UNIFORM_BLOCK);
+        memcpy(inlineData.data() + (*binding)->offset + descWrite.dstArrayElement,
+               inlineWrite->pData, inlineWrite->dataSize);
+
+        // the descriptorCount is not the number of descriptors, so there's nothing else to do
+        continue;
+      }
+
+      const bool texelBuffer =
+          (descWrite.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER ||
+           descWrite.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER);
+      const bool image = (descWrite.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER ||
+                          descWrite.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ||
+                          descWrite.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE ||
+                          descWrite.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ||
+                          descWrite.descriptorType == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT);
+
       // start at the dstArrayElement
       uint32_t curIdx = descWrite.dstArrayElement;
 
-      for(uint32_t d = 0; d < descWrite.descriptorCount; d++, curIdx++)
+      // descriptors are set in runs of consecutive array elements within one binding, so that the
+      // per-write work is only done once per run. This matters for applications doing many large
+      // writes every frame, as this tracking happens even when not capturing.
+      for(uint32_t d = 0; d < descWrite.descriptorCount;)
       {
         // roll over onto the next binding, on the assumption that it is the same
         // type and there is indeed a next binding at all. See spec language:
@@ -1293,39 +1317,28 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
             layoutBinding++;
             binding++;
           }
+
+          continue;
         }
 
-        DescriptorSetSlot &bind = (*binding)[curIdx];
+        uint32_t count =
+            RDCMIN(descWrite.descriptorCount - d, layoutBinding->descriptorCount - curIdx);
 
-        if(descWrite.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER ||
-           descWrite.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER)
-        {
-          bind.SetTexelBuffer(descWrite.descriptorType, GetResID(descWrite.pTexelBufferView[d]));
-        }
-        else if(descWrite.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER ||
-                descWrite.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ||
-                descWrite.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE ||
-                descWrite.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ||
-                descWrite.descriptorType == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT)
-        {
-          bind.SetImage(descWrite.descriptorType, descWrite.pImageInfo[d],
-                        layoutBinding->immutableSampler == NULL);
-        }
-        else if(descWrite.descriptorType == VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK)
-        {
-          VkWriteDescriptorSetInlineUniformBlock *inlineWrite =
-              (VkWriteDescriptorSetInlineUniformBlock *)FindNextStruct(
-                  &descWrite, VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_INLINE_UNIFORM_BLOCK);
-          memcpy(inlineData.data() + (*binding)->offset + descWrite.dstArrayElement,
-                 inlineWrite->pData, inlineWrite->dataSize);
+        DescriptorSetSlot *slots = (*binding) + curIdx;
 
-          // break now because the descriptorCount is not the number of descriptors
-          break;
-        }
+        if(texelBuffer)
+          DescriptorSetSlot::SetTexelBuffers(slots, count, descWrite.descriptorType,
+                                             descWrite.pTexelBufferView + d);
+        else if(image)
+          DescriptorSetSlot::SetImages(slots, count, descWrite.descriptorType,
+                                       descWrite.pImageInfo + d,
+                                       layoutBinding->immutableSampler == NULL);
         else
-        {
-          bind.SetBuffer(descWrite.descriptorType, descWrite.pBufferInfo[d]);
-        }
+          DescriptorSetSlot::SetBuffers(slots, count, descWrite.descriptorType,
+                                        descWrite.pBufferInfo + d);
+
+        d += count;
+        curIdx += count;
       }
     }
 
@@ -38,6 +38,11 @@ RDOC_CONFIG(
     "This behaviour can be disabled with this flag, which lets it through both during capture and "
     "on replay.");
 
+RDOC_CONFIG(bool, Vulkan_ReplayPageableMemory, true,
+            "Enable VK_EXT_pageable_device_local_memory on replay where available, so that captures "
+            "using more device memory than the replay GPU has can be paged to system memory by the "
+            "driver instead of failing to allocate.");
+
 // intercept and overwrite the application info if present. We must use the same appinfo on
 // capture and replay, and the safer default is not to replay as if we were the original app but
 // with a slightly different workload. So instead we trample what the app reported and put in our
@@ -970,6 +975,7 @@ void WrappedVulkan::Shutdown()
   // destroy debug manager and any objects it created
   SAFE_DELETE(m_DebugManager);
   SAFE_DELETE(m_ShaderCache);
+  m_CreationInfo.m_ShaderCache = NULL;
 
   if(m_Instance && ObjDisp(m_Instance)->DestroyDebugReportCallbackEXT &&
      m_DbgReportCallback != VK_NULL_HANDLE)
@@ -1801,6 +1807,29 @@ bool WrappedVulkan::Serialise_vkCreateDevice(SerialiserType &ser, VkPhysicalDevi
           "geometry/tessellation stages will not be available");
     }
 
+    bool pageable = false, addedPageable = false;
+
+    // enable VK_EXT_pageable_device_local_memory if it's available, to let the driver page
+    // allocations out of device memory when the replay GPU is smaller than the captured one.
+    if(Vulkan_ReplayPageableMemory() &&
+       supportedExtensions.find(VK_EXT_PAGEABLE_DEVICE_LOCAL_MEMORY_EXTENSION_NAME) !=
+           supportedExtensions.end() &&
+       supportedExtensions.find(VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME) != supportedExtensions.end())
+    {
+      pageable = true;
+
+      if(!Extensions.contains(VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME))
+        Extensions.push_back(VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME);
+
+      if(!Extensions.contains(VK_EXT_PAGEABLE_DEVICE_LOCAL_MEMORY_EXTENSION_NAME))
+      {
+        addedPageable = true;
+        Extensions.push_back(VK_EXT_PAGEABLE_DEVICE_LOCAL_MEMORY_EXTENSION_NAME);
+      }
+
+      RDCLOG("Enabling VK_EXT_pageable_device_local_memory");
+    }
+
     bool KHRbuffer = false, EXTbuffer = false;
 
     if(supportedExtensions.find(VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME) !=
@@ -3328,6 +3357,51 @@ bool WrappedVulkan::Serialise_vkCreateDevice(SerialiserType &ser, VkPhysicalDevi
       }
     }
 
+    VkPhysicalDevicePageableDeviceLocalMemoryFeaturesEXT pageableFeatures = {
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PAGEABLE_DEVICE_LOCAL_MEMORY_FEATURES_EXT,
+    };
+
+    if(pageable)
+    {
+      VkPhysicalDeviceFeatures2 availBase = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
+      availBase.pNext = &pageableFeatures;
+      ObjDisp(physicalDevice)->GetPhysicalDeviceFeatures2(Unwrap(physicalDevice), &availBase);
+
+      if(pageableFeatures.pageableDeviceLocalMemory)
+      {
+        // see if there's an existing struct
+        VkPhysicalDevicePageableDeviceLocalMemoryFeaturesEXT *existing =
+            (VkPhysicalDevicePageableDeviceLocalMemoryFeaturesEXT *)FindNextStruct(
+                &createInfo,
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PAGEABLE_DEVICE_LOCAL_MEMORY_FEATURES_EXT);
+
+        if(existing)
+        {
+          // if so, make sure the feature is enabled
+          existing->pageableDeviceLocalMemory = VK_TRUE;
+        }
+        else
+        {
+          // otherwise, add our own, and push it onto the pNext array
+          pageableFeatures.pageableDeviceLocalMemory = VK_TRUE;
+
+          pageableFeatures.pNext = (void *)createInfo.pNext;
+          createInfo.pNext = &pageableFeatures;
+        }
+      }
+      else
+      {
+        RDCWARN(
+            "VK_EXT_pageable_device_local_memory is available, but the physical device feature is "
+            "not. Disabling");
+
+        pageable = false;
+
+        if(addedPageable)
+          Extensions.removeOne(VK_EXT_PAGEABLE_DEVICE_LOCAL_MEMORY_EXTENSION_NAME);
+      }
+    }
+
     VkPhysicalDevicePerformanceQueryFeaturesKHR perfFeatures = {
         VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PERFORMANCE_QUERY_FEATURES_KHR,
     };
@@ -3766,6 +3840,9 @@ bool WrappedVulkan::Serialise_vkCreateDevice(SerialiserType &ser, VkPhysicalDevi
 
     ChooseMemoryIndices();
 
+    m_PageableDeviceMemory = pageable;
+    ChooseReplayMemoryBudget();
+
     APIProps.vendor = GetDriverInfo().Vendor();
 
     // temporarily disable the debug message sink, to ignore any false positive messages from our
@@ -3774,6 +3851,7 @@ bool WrappedVulkan::Serialise_vkCreateDevice(SerialiserType &ser, VkPhysicalDevi
     SetDebugMessageSink(NULL);
 
     m_ShaderCache = new VulkanShaderCache(this);
+    m_CreationInfo.m_ShaderCache = m_ShaderCache;
 
     m_DebugManager = new VulkanDebugManager(this);
 
@@ -4255,6 +4333,7 @@ void WrappedVulkan::vkDestroyDevice(VkDevice device, const VkAllocationCallbacks
   // delete all debug manager objects
   SAFE_DELETE(m_DebugManager);
   SAFE_DELETE(m_ShaderCache);
+  m_CreationInfo.m_ShaderCache = NULL;
   SAFE_DELETE(m_TextRenderer);
 
   // since we didn't create proper registered resources for our command buffers,
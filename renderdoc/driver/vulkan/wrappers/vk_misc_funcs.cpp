@@ -2147,6 +2147,10 @@ bool WrappedVulkan::Serialise_SetShaderDebugPath(SerialiserType &ser, VkShaderMo
 
   if(IsReplayingAndReading())
   {
+    // background reflection may still be reading this module's SPIR-V
+    if(m_PipelineCompilePool)
+      m_PipelineCompilePool->WaitForIdle();
+
     m_CreationInfo.m_ShaderModule[GetResID(ShaderObject)].unstrippedPath = DebugPath;
     m_CreationInfo.m_ShaderModule[GetResID(ShaderObject)].Reinit();
 
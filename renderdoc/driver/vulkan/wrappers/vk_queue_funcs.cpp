@@ -29,6 +29,7 @@
 
 RDOC_EXTERN_CONFIG(bool, Vulkan_Debug_VerboseCommandRecording);
 RDOC_EXTERN_CONFIG(bool, Vulkan_Debug_SingleSubmitFlushing);
+RDOC_EXTERN_CONFIG(uint32_t, Capture_MapDiffMergeGap);
 
 template <typename SerialiserType>
 bool WrappedVulkan::Serialise_vkGetDeviceQueue(SerialiserType &ser, VkDevice device,
@@ -1043,10 +1044,8 @@ void WrappedVulkan::CaptureQueueSubmit(VkQueue queue,
       // the first recorded reference is a complete write then a later readbeforewrite won't
       // properly mark it as needing initial states preserved. So we do that here. Images are
       // handled separately
-      for(auto refit = refs.storableRefs.begin(); refit != refs.storableRefs.end(); ++refit)
-      {
+      if(!refs.storableRefs.empty())
         GetResourceManager()->FixupStorageBufferMemory(refs.storableRefs);
-      }
     }
 
     // now we can insert frame references from command buffers, to have a conservative ordering vs.
@@ -1091,16 +1090,13 @@ void WrappedVulkan::CaptureQueueSubmit(VkQueue queue,
           continue;
         }
 
-        size_t diffStart = 0, diffEnd = 0;
-        bool found = true;
-
         // this causes vkFlushMappedMemoryRanges call to allocate and copy to refData
         // from serialised buffer. We want to copy *precisely* the serialised data,
         // otherwise there is a gap in time between serialising out a snapshot of
         // the buffer and whenever we then copy into the ref data, e.g. below.
         // during this time, data could be written to the buffer and it won't have
         // been caught in the serialised snapshot, and if it doesn't change then
-        // it *also* won't be caught in any future FindDiffRange() calls.
+        // it *also* won't be caught in any future FindDiffRanges() calls.
         //
         // Likewise once refData is allocated, the call below will also update it
         // with the data serialised out for the same reason.
@@ -1111,7 +1107,9 @@ void WrappedVulkan::CaptureQueueSubmit(VkQueue queue,
         // data that would be needed by the GPU in this submit. As long as the
         // refdata we use for future use is identical to what was serialised, we
         // shouldn't miss anything
-        state.needRefData = true;
+        //
+        // When the OS is tracking writes for us there's no need for refData at all.
+        state.needRefData = !state.writeWatched;
 
         if(state.readbackOnGPU)
         {
@@ -1195,37 +1193,63 @@ void WrappedVulkan::CaptureQueueSubmit(VkQueue queue,
           state.cpuReadPtr = state.mappedPtr;
         }
 
-        // if we have a previous set of data, compare.
+        // if we have a previous set of data, compare and only serialise the ranges that changed.
         // otherwise just serialise it all
-        if(state.refData)
-          found = FindDiffRange(((byte *)state.cpuReadPtr) + state.mapOffset, state.refData,
-                                (size_t)state.mapSize, diffStart, diffEnd);
-        else
-          diffEnd = (size_t)state.mapSize;
+        rdcarray<rdcpair<size_t, size_t>> diffRanges;
+        if(state.writeWatched)
+        {
+          // fetching the written ranges resets them, so any writes from this point on - including
+          // while we serialise - will be found next time.
+          bool tracked = WriteWatch::GetWrittenRanges(state.mappedPtr + state.mapOffset,
+                                                      (size_t)state.mapSize, diffRanges);
+
+          // until we've serialised all of the memory once we must write it all, since we don't
+          // know what it contained before tracking started
+          if(!tracked || !state.writeWatchBaseline)
+          {
+            diffRanges.clear();
+            if(state.mapSize > 0)
+              diffRanges.push_back({0, (size_t)state.mapSize});
+            state.writeWatchBaseline = true;
+          }
 
-        // sanitise diff start/end. Since the mapped pointer might be written on another thread
-        // (or even the GPU) this could cause a difference to appear and disappear transiently. In
-        // this case FindDiffRange could find the difference when locating the start but not find
-        // it when locating the end. In this case we don't need to write the difference (the
-        // application is responsible for ensuring it's not writing to memory the GPU might need)
-        if(diffEnd <= diffStart)
-          found = false;
+          // if tracking broke, stop using it and fall back to comparing against refData
+          if(!tracked)
+          {
+            RDCWARN("Lost track of writes to %s, falling back to comparisons",
+                    ToStr(record->GetResourceID()).c_str());
+            WriteWatch::StopTracking(state.mappedPtr + state.mapOffset, (size_t)state.mapSize);
+            state.writeWatched = false;
+            state.needRefData = true;
+          }
+        }
+        else if(state.refData)
+        {
+          FindDiffRanges(((byte *)state.cpuReadPtr) + state.mapOffset, state.refData,
+                         (size_t)state.mapSize, Capture_MapDiffMergeGap(), diffRanges);
+        }
+        else if(state.mapSize > 0)
+        {
+          diffRanges.push_back({0, (size_t)state.mapSize});
+        }
 
-        if(found)
+        if(!diffRanges.empty())
         {
           // MULTIDEVICE should find the device for this queue.
           // MULTIDEVICE only want to flush maps associated with this queue
           VkDevice dev = GetDev();
 
+          for(const rdcpair<size_t, size_t> &diff : diffRanges)
           {
             RDCLOG("Persistent map flush forced for %s (%llu -> %llu)",
-                   ToStr(record->GetResourceID()).c_str(), (uint64_t)diffStart, (uint64_t)diffEnd);
+                   ToStr(record->GetResourceID()).c_str(), (uint64_t)diff.first,
+                   (uint64_t)diff.second);
             VkMappedMemoryRange range = {
                 VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
                 NULL,
                 (VkDeviceMemory)(uint64_t)record->Resource,
-                state.mapOffset + diffStart,
-                diffEnd - diffStart,
+                state.mapOffset + diff.first,
+                diff.second - diff.first,
             };
             InternalFlushMemoryRange(dev, range, true, capframe);
           }
@@ -1987,6 +2011,8 @@ void WrappedVulkan::vkQueueBeginDebugUtilsLabelEXT(VkQueue queue,
     SERIALISE_TIME_CALL(ObjDisp(queue)->QueueBeginDebugUtilsLabelEXT(Unwrap(queue), pLabelInfo));
   }
 
+  if(pLabelInfo)
+    BeginQueueCaptureRange(pLabelInfo->pLabelName, queue);
   if(IsActiveCapturing(m_State))
   {
     CACHE_THREAD_SERIALISER();
@@ -2044,6 +2070,8 @@ void WrappedVulkan::vkQueueEndDebugUtilsLabelEXT(VkQueue queue)
     m_FrameCaptureRecord->AddChunk(scope.Get());
     GetResourceManager()->MarkResourceFrameReferenced(GetResID(queue), eFrameRef_Read);
   }
+
+  EndQueueCaptureRange(queue);
 }
 
 template <typename SerialiserType>
@@ -31,6 +31,8 @@ RDOC_CONFIG(bool, Vulkan_GPUReadbackDeviceLocal, true,
             "When reading back mapped device-local memory, use a GPU copy "
             "instead of a CPU side comparison directly to mapped memory.");
 
+RDOC_EXTERN_CONFIG(bool, Capture_TrackMapWrites);
+
 /************************************************************************
  *
  * Mapping is simpler in Vulkan, at least in concept, but that comes with
@@ -330,6 +332,19 @@ bool WrappedVulkan::Serialise_vkAllocateMemory(SerialiserType &ser, VkDevice dev
     }
     else
     {
+      if(IsDeviceLocalMemoryType(patched.memoryTypeIndex))
+      {
+        bool wasInBudget = m_ReplayDeviceLocalBytes <= m_ReplayDeviceLocalBudget;
+
+        m_ReplayDeviceLocalBytes += AllocateInfo.allocationSize;
+
+        if(wasInBudget && m_ReplayDeviceLocalBytes > m_ReplayDeviceLocalBudget)
+          RDCWARN("Capture allocates more than the %llu MB device-local budget%s",
+                  m_ReplayDeviceLocalBudget / (1024 * 1024),
+                  m_PageableDeviceMemory ? ", relying on the driver to page memory"
+                                         : ", replay may run out of memory");
+      }
+
       ResourceId live = GetResourceManager()->WrapResource(Unwrap(device), mem);
       GetResourceManager()->AddLiveResource(Memory, mem);
 
@@ -868,6 +883,13 @@ VkResult WrappedVulkan::vkMapMemory(VkDevice device, VkDeviceMemory mem, VkDevic
 
       if(state.mapCoherent)
       {
+        // memory we read back on the GPU is not cached, so it's unlikely to be trackable and we'd
+        // need to compare the readback anyway
+        state.writeWatched = false;
+        state.writeWatchBaseline = false;
+        if(Capture_TrackMapWrites() && !state.readbackOnGPU)
+          state.writeWatched = WriteWatch::StartTracking(realData, (size_t)state.mapSize);
+
         SCOPED_LOCK(m_CoherentMapsLock);
         m_CoherentMaps.push_back(memrecord);
       }
@@ -1084,6 +1106,12 @@ void WrappedVulkan::vkUnmapMemory(VkDevice device, VkDeviceMemory mem)
         }
       }
 
+      if(state.writeWatched)
+      {
+        WriteWatch::StopTracking(state.mappedPtr + state.mapOffset, (size_t)state.mapSize);
+        state.writeWatched = false;
+      }
+
       state.cpuReadPtr = state.mappedPtr = NULL;
     }
 
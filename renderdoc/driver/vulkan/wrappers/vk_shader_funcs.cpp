@@ -24,7 +24,37 @@
 
 #include "../vk_core.h"
 #include "../vk_replay.h"
+#include "../vk_shader_cache.h"
+#include "core/settings.h"
 #include "driver/shaders/spirv/spirv_reflect.h"
+#include "md5/md5.h"
+
+RDOC_DEBUG_CONFIG(bool, Vulkan_Debug_ReplayDuplicatePipelines, false,
+                  "Create every graphics pipeline on replay, even when an identical one has "
+                  "already been created, instead of sharing the first.");
+
+// hashes a create info the way it's serialised, with handles identified by resource ID, so that
+// pipelines that would be created identically get the same hash
+static ShaderCacheHash128 HashCreateInfo(VulkanResourceManager *rm,
+                                         const VkGraphicsPipelineCreateInfo &info)
+{
+  WriteSerialiser ser(new StreamWriter(StreamWriter::DefaultScratchSize), Ownership::Stream);
+  ser.SetUserData(rm);
+  ser.SetVersion(VkInitParams::CurrentVersion);
+
+  VkGraphicsPipelineCreateInfo createInfo = info;
+  ser.Serialise("CreateInfo"_lit, createInfo);
+
+  StreamWriter *writer = ser.GetWriter();
+
+  MD5_CTX md5ctx = {};
+  MD5_Init(&md5ctx);
+  MD5_Update(&md5ctx, writer->GetData(), (unsigned long)writer->GetOffset());
+
+  ShaderCacheHash128 ret;
+  MD5_Final((unsigned char *)ret.hash, &md5ctx);
+  return ret;
+}
 
 template <>
 VkComputePipelineCreateInfo *WrappedVulkan::UnwrapInfos(CaptureState state,
@@ -438,12 +468,14 @@ bool WrappedVulkan::Serialise_vkCreateGraphicsPipelines(
   if(IsReplayingAndReading())
   {
     VkPipeline pipe = VK_NULL_HANDLE;
+    bool deferredCompile = false;
 
     VkRenderPass origRP = CreateInfo.renderPass;
     VkPipelineCache origCache = pipelineCache;
 
-    // don't use pipeline caches on replay
-    pipelineCache = VK_NULL_HANDLE;
+    // don't use the application's pipeline caches on replay, but use our own persistent cache for
+    // the capture if we have one
+    pipelineCache = m_ShaderCache ? m_ShaderCache->GetCapturePipeCache() : VK_NULL_HANDLE;
 
     // if we have pipeline executable properties, capture the data
     if(GetExtensions(NULL).ext_KHR_pipeline_executable_properties)
@@ -457,9 +489,24 @@ bool WrappedVulkan::Serialise_vkCreateGraphicsPipelines(
     // valid
     CreateInfo.flags &= ~VK_PIPELINE_CREATE_FAIL_ON_PIPELINE_COMPILE_REQUIRED_BIT;
 
-    VkGraphicsPipelineCreateInfo *unwrapped = UnwrapInfos(m_State, &CreateInfo, 1);
-    VkResult ret = ObjDisp(device)->CreateGraphicsPipelines(Unwrap(device), Unwrap(pipelineCache),
-                                                            1, unwrapped, NULL, &pipe);
+    // if an identical pipeline was already created, use it for this one too. Libraries are shared
+    // this way as well, and then pipelines linked from identical libraries match in turn.
+    ResourceId *dedupLive = NULL;
+    if(!Vulkan_Debug_ReplayDuplicatePipelines())
+      dedupLive = &m_ReplayPipelinesByCreateInfo[HashCreateInfo(GetResourceManager(), CreateInfo)];
+
+    bool duplicate = dedupLive && *dedupLive != ResourceId() &&
+                     GetResourceManager()->HasCurrentResource(*dedupLive);
+
+    VkGraphicsPipelineCreateInfo *unwrapped = NULL;
+    VkResult ret = VK_SUCCESS;
+
+    if(!duplicate)
+    {
+      unwrapped = UnwrapInfos(m_State, &CreateInfo, 1);
+      ret = ObjDisp(device)->CreateGraphicsPipelines(Unwrap(device), Unwrap(pipelineCache), 1,
+                                                     unwrapped, NULL, &pipe);
+    }
 
     AddResource(Pipeline, ResourceType::PipelineState, "Graphics Pipeline");
 
@@ -469,6 +516,13 @@ bool WrappedVulkan::Serialise_vkCreateGraphicsPipelines(
                        "Failed creating graphics pipeline, VkResult: %s", ToStr(ret).c_str());
       return false;
     }
+    else if(duplicate)
+    {
+      // the same as when the driver returns an existing pipeline below, return the first
+      // pipeline whenever this one is requested
+      GetResourceManager()->ReplaceResource(Pipeline,
+                                            GetResourceManager()->GetOriginalID(*dedupLive));
+    }
     else
     {
       ResourceId live;
@@ -489,6 +543,9 @@ bool WrappedVulkan::Serialise_vkCreateGraphicsPipelines(
         live = GetResourceManager()->WrapResource(Unwrap(device), pipe);
         GetResourceManager()->AddLiveResource(Pipeline, pipe);
 
+        if(dedupLive)
+          *dedupLive = live;
+
         VkGraphicsPipelineCreateInfo shadInstantiatedInfo = CreateInfo;
         VkPipelineShaderStageCreateInfo shadInstantiations[6];
 
@@ -549,16 +606,40 @@ bool WrappedVulkan::Serialise_vkCreateGraphicsPipelines(
               m_CreationInfo.m_RenderPass[renderPassID].loadRPs[CreateInfo.subpass];
           CreateInfo.subpass = 0;
 
-          unwrapped = UnwrapInfos(m_State, &CreateInfo, 1);
-          ret = ObjDisp(device)->CreateGraphicsPipelines(Unwrap(device), Unwrap(pipelineCache), 1,
-                                                         unwrapped, NULL, &pipeInfo.subpass0pipe);
-          RDCASSERTEQUAL(ret, VK_SUCCESS);
+          if(m_PipelineCompilePool)
+          {
+            // this pipeline isn't needed until we replay, so compile it in the background while
+            // loading continues. The deferred compile takes ownership of the deserialised create
+            // info, since the chunk will be gone by the time it runs.
+            PendingPipelineCompile *pending = new PendingPipelineCompile;
+            pending->live = live;
+            pending->createInfo = CreateInfo;
+            m_PendingPipelineCompiles.push_back(pending);
+
+            m_PipelineCompilePool->AddJob([this, device, pipelineCache, pending]() {
+              VkGraphicsPipelineCreateInfo *unwrappedInfo =
+                  UnwrapInfos(m_State, &pending->createInfo, 1);
+              pending->ret = ObjDisp(device)->CreateGraphicsPipelines(
+                  Unwrap(device), Unwrap(pipelineCache), 1, unwrappedInfo, NULL, &pending->pipe);
+              Deserialise(pending->createInfo);
+            });
+
+            deferredCompile = true;
+          }
+          else
+          {
+            unwrapped = UnwrapInfos(m_State, &CreateInfo, 1);
+            ret = ObjDisp(device)->CreateGraphicsPipelines(Unwrap(device), Unwrap(pipelineCache),
+                                                           1, unwrapped, NULL,
+                                                           &pipeInfo.subpass0pipe);
+            RDCASSERTEQUAL(ret, VK_SUCCESS);
 
-          ResourceId subpass0id =
-              GetResourceManager()->WrapResource(Unwrap(device), pipeInfo.subpass0pipe);
+            ResourceId subpass0id =
+                GetResourceManager()->WrapResource(Unwrap(device), pipeInfo.subpass0pipe);
 
-          // register as a live-only resource, so it is cleaned up properly
-          GetResourceManager()->AddLiveResource(subpass0id, pipeInfo.subpass0pipe);
+            // register as a live-only resource, so it is cleaned up properly
+            GetResourceManager()->AddLiveResource(subpass0id, pipeInfo.subpass0pipe);
+          }
         }
       }
     }
@@ -591,6 +672,10 @@ bool WrappedVulkan::Serialise_vkCreateGraphicsPipelines(
         DerivedResource(libraryInfo->pLibraries[l], Pipeline);
       }
     }
+
+    // the deferred compile owns the create info's allocations now, don't free them here
+    if(deferredCompile)
+      CreateInfo = {};
   }
 
   return true;
@@ -747,8 +832,9 @@ bool WrappedVulkan::Serialise_vkCreateComputePipelines(SerialiserType &ser, VkDe
 
     VkPipelineCache origCache = pipelineCache;
 
-    // don't use pipeline caches on replay
-    pipelineCache = VK_NULL_HANDLE;
+    // don't use the application's pipeline caches on replay, but use our own persistent cache for
+    // the capture if we have one
+    pipelineCache = m_ShaderCache ? m_ShaderCache->GetCapturePipeCache() : VK_NULL_HANDLE;
 
     // if we have pipeline executable properties, capture the data
     if(GetExtensions(NULL).ext_KHR_pipeline_executable_properties)
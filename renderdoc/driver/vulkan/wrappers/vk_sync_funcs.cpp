@@ -24,6 +24,7 @@
 
 #include "../vk_core.h"
 #include "../vk_debug.h"
+#include "common/inline_array.h"
 
 /*
  * Events and fences need careful handling.
@@ -783,8 +784,8 @@ bool WrappedVulkan::Serialise_vkCmdWaitEvents(
 
   SERIALISE_CHECK_READ_ERRORS();
 
-  rdcarray<VkImageMemoryBarrier> imgBarriers;
-  rdcarray<VkBufferMemoryBarrier> bufBarriers;
+  rdcinlinearray<VkImageMemoryBarrier, 8> imgBarriers;
+  rdcinlinearray<VkBufferMemoryBarrier, 8> bufBarriers;
 
   // it's possible for buffer or image to be NULL if it refers to a resource that is otherwise
   // not in the log (barriers do not mark resources referenced). If the resource in question does
@@ -1279,8 +1280,8 @@ bool WrappedVulkan::Serialise_vkCmdWaitEvents2(SerialiserType &ser, VkCommandBuf
   {
     m_LastCmdBufferID = GetResourceManager()->GetOriginalID(GetResID(commandBuffer));
 
-    rdcarray<VkImageMemoryBarrier2> imgBarriers;
-    rdcarray<VkBufferMemoryBarrier2> bufBarriers;
+    rdcinlinearray<VkImageMemoryBarrier2, 8> imgBarriers;
+    rdcinlinearray<VkBufferMemoryBarrier2, 8> bufBarriers;
 
     for(uint32_t evIdx = 0; evIdx < eventCount; evIdx++)
     {
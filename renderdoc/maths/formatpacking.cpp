@@ -828,6 +828,188 @@ void EncodeFormattedComponents(const ResourceFormat &fmt, FloatVector v, byte *d
   }
 }
 
+// lookup tables for the 8-bit normalised formats, so that bulk decoding is a table lookup per
+// component with no divide or branch. Indexed by the raw byte value.
+struct Norm8Tables
+{
+  float unorm[256];
+  float snorm[256];
+
+  Norm8Tables()
+  {
+    for(int i = 0; i < 256; i++)
+    {
+      unorm[i] = float(i) / 255.0f;
+
+      int8_t s = int8_t(uint8_t(i));
+      snorm[i] = s == -128 ? -1.0f : float(s) / 127.0f;
+    }
+  }
+};
+
+static const Norm8Tables &GetNorm8Tables()
+{
+  static Norm8Tables tables;
+  return tables;
+}
+
+template <uint32_t compCount>
+static void DecodeNorm8(const byte *data, size_t stride, size_t count, FloatVector *out,
+                        const float *colourLUT, const float *alphaLUT, bool bgra)
+{
+  for(size_t i = 0; i < count; i++, data += stride, out++)
+  {
+    FloatVector ret(0.0f, 0.0f, 0.0f, 1.0f);
+
+    float *comp = &ret.x;
+    for(uint32_t c = 0; c < compCount; c++)
+      comp[c] = (c == 3 ? alphaLUT : colourLUT)[data[c]];
+
+    if(bgra)
+      std::swap(ret.x, ret.z);
+
+    *out = ret;
+  }
+}
+
+template <uint32_t compCount>
+static void DecodeHalf(const byte *data, size_t stride, size_t count, FloatVector *out)
+{
+  for(size_t i = 0; i < count; i++, data += stride, out++)
+  {
+    FloatVector ret(0.0f, 0.0f, 0.0f, 1.0f);
+
+    uint16_t u16[compCount];
+    memcpy(u16, data, sizeof(u16));
+
+    ConvertFromHalf(u16, &ret.x, compCount);
+
+    *out = ret;
+  }
+}
+
+template <uint32_t compCount>
+static void EncodeUNorm8(const FloatVector *v, size_t count, byte *data, size_t stride)
+{
+  for(size_t i = 0; i < count; i++, data += stride, v++)
+  {
+    const float *comp = &v->x;
+    for(uint32_t c = 0; c < compCount; c++)
+      data[c] = uint8_t(RDCCLAMP(comp[c], 0.0f, 1.0f) * float(0xff) + 0.5f);
+  }
+}
+
+template <uint32_t compCount>
+static void EncodeHalf(const FloatVector *v, size_t count, byte *data, size_t stride)
+{
+  for(size_t i = 0; i < count; i++, data += stride, v++)
+  {
+    uint16_t u16[compCount];
+    ConvertToHalf(&v->x, u16, compCount);
+
+    memcpy(data, u16, sizeof(u16));
+  }
+}
+
+#define DISPATCH_COMP_COUNT(func, ...)   \
+  switch(fmt.compCount)                  \
+  {                                      \
+    case 1: return func<1>(__VA_ARGS__); \
+    case 2: return func<2>(__VA_ARGS__); \
+    case 3: return func<3>(__VA_ARGS__); \
+    case 4: return func<4>(__VA_ARGS__); \
+    default: break;                      \
+  }
+
+void DecodeFormattedComponents(const ResourceFormat &fmt, const byte *data, size_t stride,
+                               size_t count, FloatVector *out, bool *success)
+{
+  if(success)
+    *success = true;
+
+  if(fmt.type == ResourceFormatType::Regular && fmt.compByteWidth == 1)
+  {
+    const Norm8Tables &tables = GetNorm8Tables();
+
+    const float *colourLUT = NULL;
+    const float *alphaLUT = NULL;
+    if(fmt.compType == CompType::UNorm)
+    {
+      colourLUT = alphaLUT = tables.unorm;
+    }
+    else if(fmt.compType == CompType::UNormSRGB)
+    {
+      // alpha is never interpreted as sRGB
+      colourLUT = SRGB8_lookuptable;
+      alphaLUT = tables.unorm;
+    }
+    else if(fmt.compType == CompType::SNorm)
+    {
+      colourLUT = alphaLUT = tables.snorm;
+    }
+
+    if(colourLUT)
+    {
+      DISPATCH_COMP_COUNT(DecodeNorm8, data, stride, count, out, colourLUT, alphaLUT,
+                          fmt.BGRAOrder());
+    }
+  }
+  else if(fmt.type == ResourceFormatType::Regular && fmt.compByteWidth == 2 &&
+          fmt.compType == CompType::Float)
+  {
+    DISPATCH_COMP_COUNT(DecodeHalf, data, stride, count, out);
+  }
+  else if(fmt.type == ResourceFormatType::R11G11B10)
+  {
+    for(size_t i = 0; i < count; i++, data += stride)
+    {
+      uint32_t u;
+      memcpy(&u, data, sizeof(u));
+      Vec3f v = ConvertFromR11G11B10(u);
+      out[i] = FloatVector(v.x, v.y, v.z, 1.0f);
+    }
+    return;
+  }
+  else if(fmt.type == ResourceFormatType::R9G9B9E5)
+  {
+    for(size_t i = 0; i < count; i++, data += stride)
+    {
+      uint32_t u;
+      memcpy(&u, data, sizeof(u));
+      Vec3f v = ConvertFromR9G9B9E5(u);
+      out[i] = FloatVector(v.x, v.y, v.z, 1.0f);
+    }
+    return;
+  }
+
+  // anything else goes through the generic per-element path
+  for(size_t i = 0; i < count; i++, data += stride)
+    out[i] = DecodeFormattedComponents(fmt, data, success);
+}
+
+void EncodeFormattedComponents(const ResourceFormat &fmt, const FloatVector *v, size_t count,
+                               byte *data, size_t stride, bool *success)
+{
+  if(success)
+    *success = true;
+
+  if(fmt.type == ResourceFormatType::Regular && fmt.compByteWidth == 1 &&
+     fmt.compType == CompType::UNorm)
+  {
+    DISPATCH_COMP_COUNT(EncodeUNorm8, v, count, data, stride);
+  }
+  else if(fmt.type == ResourceFormatType::Regular && fmt.compByteWidth == 2 &&
+          fmt.compType == CompType::Float)
+  {
+    DISPATCH_COMP_COUNT(EncodeHalf, v, count, data, stride);
+  }
+
+  for(size_t i = 0; i < count; i++, data += stride)
+    EncodeFormattedComponents(fmt, v[i], data, success);
+}
+
+#undef DISPATCH_COMP_COUNT
+
 #if ENABLED(ENABLE_UNIT_TESTS)
 
 #undef None
@@ -1291,6 +1473,38 @@ TEST_CASE("Check format conversion", "[format]")
     }
   }
 
+  SECTION("Check batch half conversions match single conversions")
+  {
+    rdcarray<uint16_t> halfs;
+    rdcarray<float> floats;
+    halfs.resize(65536);
+    floats.resize(65536);
+
+    for(uint32_t i = 0; i < 65536; i++)
+      halfs[i] = uint16_t(i);
+
+    ConvertFromHalf(halfs.data(), floats.data(), halfs.size());
+
+    for(uint32_t i = 0; i < 65536; i++)
+    {
+      float f = ConvertFromHalf(halfs[i]);
+      CHECK(memcmp(&f, &floats[i], sizeof(float)) == 0);
+    }
+
+    // sample float bit patterns across the whole range, with a stride that hits every exponent
+    // and a spread of mantissas including rounding boundaries
+    for(uint32_t i = 0; i < 65536; i++)
+    {
+      uint32_t u = i * 65537U + (i & 0x1fff);
+      memcpy(&floats[i], &u, sizeof(float));
+    }
+
+    ConvertToHalf(floats.data(), halfs.data(), floats.size());
+
+    for(uint32_t i = 0; i < 65536; i++)
+      CHECK(ConvertToHalf(floats[i]) == halfs[i]);
+  }
+
   SECTION("Check SRGB <-> Linear conversions are reflexive")
   {
     for(uint16_t i = 0;; i++)
@@ -1557,4 +1771,91 @@ TEST_CASE("Check format conversion", "[format]")
   };
 }
 
+TEST_CASE("Check bulk format conversion matches per-element", "[format]")
+{
+  rdcarray<ResourceFormat> formats;
+
+  for(CompType compType : {CompType::UNorm, CompType::UNormSRGB, CompType::SNorm, CompType::UInt})
+  {
+    for(uint8_t compCount = 1; compCount <= 4; compCount++)
+    {
+      ResourceFormat fmt;
+      fmt.type = ResourceFormatType::Regular;
+      fmt.compType = compType;
+      fmt.compByteWidth = 1;
+      fmt.compCount = compCount;
+      formats.push_back(fmt);
+
+      if(compCount == 4)
+      {
+        fmt.SetBGRAOrder(true);
+        formats.push_back(fmt);
+      }
+    }
+  }
+
+  for(uint8_t compCount = 1; compCount <= 4; compCount++)
+  {
+    ResourceFormat fmt;
+    fmt.type = ResourceFormatType::Regular;
+    fmt.compType = CompType::Float;
+    fmt.compByteWidth = 2;
+    fmt.compCount = compCount;
+    formats.push_back(fmt);
+  }
+
+  {
+    ResourceFormat fmt;
+    fmt.compType = CompType::Float;
+    fmt.compByteWidth = 4;
+    fmt.compCount = 3;
+    fmt.type = ResourceFormatType::R11G11B10;
+    formats.push_back(fmt);
+    fmt.type = ResourceFormatType::R9G9B9E5;
+    formats.push_back(fmt);
+  }
+
+  // pseudo-random data, with an odd stride so that elements are unaligned
+  const size_t count = 1024;
+  const size_t stride = 9;
+  bytebuf data;
+  data.resize(count * stride);
+  uint32_t seed = 0x12345678;
+  for(byte &b : data)
+  {
+    seed = seed * 1103515245 + 12345;
+    b = byte(seed >> 16);
+  }
+
+  for(const ResourceFormat &fmt : formats)
+  {
+    INFO(fmt.Name());
+
+    rdcarray<FloatVector> bulk;
+    bulk.resize(count);
+    bool bulkSuccess = false;
+    DecodeFormattedComponents(fmt, data.data(), stride, count, bulk.data(), &bulkSuccess);
+    CHECK(bulkSuccess);
+
+    for(size_t i = 0; i < count; i++)
+    {
+      FloatVector single = DecodeFormattedComponents(fmt, data.data() + i * stride);
+
+      // compare bitwise so that NaNs from half or float formats match
+      CHECK(memcmp(&single, &bulk[i], sizeof(FloatVector)) == 0);
+    }
+
+    bytebuf bulkEncoded, singleEncoded;
+    bulkEncoded.resize(data.size());
+    singleEncoded.resize(data.size());
+    EncodeFormattedComponents(fmt, bulk.data(), count, bulkEncoded.data(), stride, &bulkSuccess);
+    CHECK(bulkSuccess);
+
+    for(size_t i = 0; i < count; i++)
+      EncodeFormattedComponents(fmt, bulk[i], singleEncoded.data() + i * stride);
+
+    CHECK(bulkEncoded == singleEncoded);
+  }
+}
+
 #endif
@@ -182,3 +182,11 @@ FloatVector DecodeFormattedComponents(const ResourceFormat &fmt, const byte *dat
                                       bool *success = NULL);
 void EncodeFormattedComponents(const ResourceFormat &fmt, FloatVector v, byte *data,
                                bool *success = NULL);
+
+// bulk versions of the above, converting count elements that are stride bytes apart. Common
+// formats are converted in a tight loop without the per-element format dispatch, everything else
+// falls back to converting one element at a time.
+void DecodeFormattedComponents(const ResourceFormat &fmt, const byte *data, size_t stride,
+                               size_t count, FloatVector *out, bool *success = NULL);
+void EncodeFormattedComponents(const ResourceFormat &fmt, const FloatVector *v, size_t count,
+                               byte *data, size_t stride, bool *success = NULL);
@@ -135,3 +135,103 @@ inline float ConvertFromHalf(uint16_t comp)
     return ret.f;
   }
 }
+
+// batch versions of the above. These give bit-identical results to the single conversions but
+// avoid the nested data-dependent branches, so the loop bodies are simple enough for the compiler
+// to vectorise. They are worth using anywhere large arrays of halfs are converted.
+inline void ConvertFromHalf(const uint16_t *src, float *dst, size_t count)
+{
+  union FloatBits
+  {
+    uint32_t u;
+    float f;
+  };
+
+  // 2^-14, the scale of the smallest half normal
+  FloatBits magic;
+  magic.u = 113 << 23;
+
+  for(size_t i = 0; i < count; i++)
+  {
+    const uint32_t h = src[i];
+
+    // shift exponent and mantissa into place and rebias the exponent
+    FloatBits o;
+    o.u = (h & 0x7fff) << 13;
+    const uint32_t exponent = o.u & 0x0f800000;
+    o.u += (127 - 15) << 23;
+
+    if(exponent == 0x0f800000)
+    {
+      // infinity gets the exponent pushed up to the max, NaNs all map to the same value
+      o.u = (h & 0x03ff) ? 0x7f800001 : (o.u + ((128 - 16) << 23)) | ((h & 0x8000) << 16);
+    }
+    else
+    {
+      // subnormals and zero are renormalised by letting the FPU do it
+      if(exponent == 0)
+      {
+        o.u += 1 << 23;
+        o.f -= magic.f;
+      }
+
+      o.u |= (h & 0x8000) << 16;
+    }
+
+    dst[i] = o.f;
+  }
+}
+
+inline void ConvertToHalf(const float *src, uint16_t *dst, size_t count)
+{
+  union FloatBits
+  {
+    uint32_t u;
+    float f;
+  };
+
+  // adding this pushes a value that's subnormal in half precision into a float with the half
+  // mantissa in the bottom bits, rounded to nearest even by the FPU
+  FloatBits denormMagic;
+  denormMagic.u = ((127 - 15) + (23 - 10) + 1) << 23;
+
+  for(size_t i = 0; i < count; i++)
+  {
+    FloatBits f;
+    f.f = src[i];
+
+    const uint32_t sign = f.u & 0x80000000;
+    f.u ^= sign;
+
+    uint32_t o;
+
+    if(f.u >= 0x7f800000)
+    {
+      // infinity, or NaN which keeps the top bits of its mantissa and stays a NaN
+      uint32_t mantissa = (f.u & 0x007fffff) >> 13;
+      o = f.u == 0x7f800000 ? 0x7c00 : (0x7c00 | mantissa | (mantissa == 0));
+    }
+    else if(f.u >= ((127 + 16) << 23))
+    {
+      // too large, overflows to infinity
+      o = 0x7c00;
+    }
+    else if(f.u < (113 << 23))
+    {
+      // half subnormal or zero
+      f.f += denormMagic.f;
+      o = f.u - denormMagic.u;
+    }
+    else
+    {
+      // rebias the exponent and round to nearest even on the mantissa. A carry out of the mantissa
+      // correctly increments the exponent, up to and including infinity
+      const uint32_t mantissaOdd = (f.u >> 13) & 1;
+      f.u -= ((127 - 15) << 23) - 0xfff;
+      f.u += mantissaOdd;
+      o = f.u >> 13;
+    }
+
+    dst[i] = uint16_t(o | (sign >> 16));
+  }
+}
@@ -25,6 +25,7 @@
 
 #include "os/os_specific.h"
 #include "api/replay/control_types.h"
+#include "common/common.h"
 #include "common/formatting.h"
 #include "strings/string_utils.h"
 
@@ -679,6 +680,39 @@ TEST_CASE("Test OS-specific functions", "[osspecific]")
     CHECK(ip == Network::MakeIP(216, 58, 211, 174));
     CHECK(mask == 0xFFFFFFFe);
   };
+  SECTION("Write watching")
+  {
+    const size_t size = 64 * 1024;
+    byte *mem = AllocAlignedBuffer(size, size);
+    memset(mem, 0, size);
+
+    // tracking isn't available everywhere, but when it is it must find every write
+    if(WriteWatch::StartTracking(mem, size))
+    {
+      rdcarray<rdcpair<size_t, size_t>> ranges;
+      REQUIRE(WriteWatch::GetWrittenRanges(mem, size, ranges));
+      CHECK(ranges.empty());
+
+      mem[20000] = 1;
+      mem[20001] = 1;
+      mem[size - 1] = 1;
+
+      REQUIRE(WriteWatch::GetWrittenRanges(mem, size, ranges));
+      REQUIRE(ranges.size() == 2);
+      CHECK(ranges[0].first <= 20000);
+      CHECK(ranges[0].second > 20001);
+      CHECK(ranges[1].first < size - 1);
+      CHECK(ranges[1].second == size);
+
+      // fetching the ranges resets them
+      REQUIRE(WriteWatch::GetWrittenRanges(mem, size, ranges));
+      CHECK(ranges.empty());
+
+      WriteWatch::StopTracking(mem, size);
+    }
+
+    FreeAlignedBuffer(mem);
+  };
 };
 
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -139,6 +139,25 @@ public:
   data m_Data;
 };
 
+template <class data>
+class SemaphoreTemplate
+{
+public:
+  SemaphoreTemplate();
+  ~SemaphoreTemplate();
+
+  // increment the count, waking up to numToWake waiting threads
+  void Wake(uint32_t numToWake);
+  // block until the count is non-zero, then decrement it
+  void WaitForWake();
+
+  // no copying
+  SemaphoreTemplate &operator=(const SemaphoreTemplate &other) = delete;
+  SemaphoreTemplate(const SemaphoreTemplate &other) = delete;
+
+  data m_Data;
+};
+
 void Init();
 void Shutdown();
 uint64_t AllocateTLSSlot();
@@ -146,7 +165,8 @@ uint64_t AllocateTLSSlot();
 void *GetTLSValue(uint64_t slot);
 void SetTLSValue(uint64_t slot, void *value);
 
-// must typedef CriticalSectionTemplate<X> CriticalSection
+// must typedef CriticalSectionTemplate<X> CriticalSection, RWLockTemplate<Y> RWLock and
+// SemaphoreTemplate<Z> Semaphore
 
 void SetCurrentThreadName(const rdcstr &name);
 
@@ -158,6 +178,9 @@ void DetachThread(ThreadHandle handle);
 void CloseThread(ThreadHandle handle);
 void Sleep(uint32_t milliseconds);
 
+// returns the number of logical processors available to this process, always at least 1
+uint32_t GetNumCores();
+
 // kind of windows specific, to handle this case:
 // http://blogs.msdn.com/b/oldnewthing/archive/2013/11/05/10463645.aspx
 void KeepModuleAlive();
@@ -234,6 +257,26 @@ int64_t Inc64(int64_t *i);
 int64_t Dec64(int64_t *i);
 int64_t ExchAdd64(int64_t *i, int64_t a);
 int32_t CmpExch32(int32_t *dest, int32_t oldVal, int32_t newVal);
+int64_t CmpExch64(int64_t *dest, int64_t oldVal, int64_t newVal);
+void *CmpExchPtr(void **dest, void *oldVal, void *newVal);
+};
+
+// Tracks which pages of a region of memory have been written by the CPU, so that changes can be
+// found without keeping a copy of the memory to compare against. This isn't available on every
+// platform, or for every kind of memory (e.g. device memory mapped directly into the process), so
+// users must be prepared to fall back to comparing memory when StartTracking fails.
+namespace WriteWatch
+{
+// start tracking writes to the given region. Returns false if writes can't be tracked
+bool StartTracking(void *base, size_t size);
+void StopTracking(void *base, size_t size);
+
+// fetches the [start, end) byte ranges relative to base of any pages that have been written since
+// tracking started or the previous call, and atomically resets them so writes after this point
+// are returned from the next call. Ranges are page granularity, clamped to the region. Returns
+// false if the written pages couldn't be determined, in which case the whole region should be
+// treated as written.
+bool GetWrittenRanges(void *base, size_t size, rdcarray<rdcpair<size_t, size_t>> &ranges);
 };
 
 namespace Callstack
@@ -263,6 +306,17 @@ class StackResolver
 public:
   virtual ~StackResolver() {}
   virtual AddressDetails GetAddr(uint64_t addr) = 0;
+
+  // resolves a whole set of addresses, which resolvers can implement more efficiently than looking
+  // up each address individually
+  virtual rdcarray<AddressDetails> GetAddrs(const rdcarray<uint64_t> &addrs)
+  {
+    rdcarray<AddressDetails> ret;
+    ret.reserve(addrs.size());
+    for(uint64_t addr : addrs)
+      ret.push_back(GetAddr(addr));
+    return ret;
+  }
 };
 
 void Init();
@@ -333,6 +387,23 @@ bool feof(FILE *f);
 
 int fclose(FILE *f);
 
+// a read-only view of a range of an open file, mapped into memory. data points at the requested
+// offset, the rest is platform-specific bookkeeping to unmap it.
+struct MappedFileRegion
+{
+  const byte *data = NULL;
+  uint64_t size = 0;
+
+  void *mapBase = NULL;
+  uint64_t mapSize = 0;
+  void *mapHandle = NULL;
+};
+
+// the file must remain unmodified while mapped, but can be closed. Returns false if the region
+// couldn't be mapped, in which case the caller should fall back to reading normally.
+bool MapFileRegion(FILE *f, uint64_t offset, uint64_t length, MappedFileRegion &region);
+void UnmapFileRegion(MappedFileRegion &region);
+
 // functions for atomically appending to a log that may be in use in multiple
 // processes
 struct LogFileHandle;
@@ -196,3 +196,18 @@ uint64_t Process::GetMemoryUsage()
 
   return 0;
 }
+
+bool WriteWatch::StartTracking(void *base, size_t size)
+{
+  return false;
+}
+
+void WriteWatch::StopTracking(void *base, size_t size)
+{
+}
+
+bool WriteWatch::GetWrittenRanges(void *base, size_t size,
+                                  rdcarray<rdcpair<size_t, size_t>> &ranges)
+{
+  return false;
+}
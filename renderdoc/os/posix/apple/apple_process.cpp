@@ -220,6 +220,21 @@ uint64_t Process::GetMemoryUsage()
   return taskInfo.resident_size;
 }
 
+bool WriteWatch::StartTracking(void *base, size_t size)
+{
+  return false;
+}
+
+void WriteWatch::StopTracking(void *base, size_t size)
+{
+}
+
+bool WriteWatch::GetWrittenRanges(void *base, size_t size,
+                                  rdcarray<rdcpair<size_t, size_t>> &ranges)
+{
+  return false;
+}
+
 // Helper method to avoid #include file conflicts between
 // <Carbon/Carbon.h> and "core/core.h"
 bool ShouldOutputDebugMon()
@@ -29,16 +29,96 @@
 
 #include <execinfo.h>
 #include <link.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <string.h>
+#include <unwind.h>
 #include <map>
 #include "common/common.h"
 #include "common/formatting.h"
+#include "core/settings.h"
 #include "os/os_specific.h"
 
+RDOC_CONFIG(bool, Linux_FramePointerCallstacks, false,
+            "Collect callstacks by following the application's frame pointers once outside of "
+            "RenderDoc, instead of unwinding every frame with backtrace(). This is much cheaper but "
+            "only gives complete callstacks if the application and its libraries are built with "
+            "frame pointers.");
+
 void *renderdocBase = NULL;
 void *renderdocEnd = NULL;
 
+// the DWARF register number of the frame pointer, for reading it out of an unwind context
+#if defined(__x86_64__)
+#define FRAME_POINTER_DWARF_REG 6
+#elif defined(__aarch64__)
+#define FRAME_POINTER_DWARF_REG 29
+#endif
+
+// per-thread cached stack extents, to bounds check the frame pointer chain
+static uint64_t stackLowSlot = 0, stackHighSlot = 0;
+
+static bool GetThreadStackBounds(uintptr_t &low, uintptr_t &high)
+{
+  low = (uintptr_t)Threading::GetTLSValue(stackLowSlot);
+  high = (uintptr_t)Threading::GetTLSValue(stackHighSlot);
+
+  if(high != 0)
+    return true;
+
+  pthread_attr_t attr;
+  if(pthread_getattr_np(pthread_self(), &attr) != 0)
+    return false;
+
+  void *stackAddr = NULL;
+  size_t stackSize = 0;
+  int ret = pthread_attr_getstack(&attr, &stackAddr, &stackSize);
+  pthread_attr_destroy(&attr);
+
+  if(ret != 0 || stackAddr == NULL)
+    return false;
+
+  low = (uintptr_t)stackAddr;
+  high = low + stackSize;
+
+  Threading::SetTLSValue(stackLowSlot, (void *)low);
+  Threading::SetTLSValue(stackHighSlot, (void *)high);
+
+  return true;
+}
+
+struct FrameWalkState
+{
+  uint64_t *addrs;
+  size_t maxLevels;
+  size_t numLevels;
+  uintptr_t framePointer;
+};
+
+static _Unwind_Reason_Code FrameWalkCallback(_Unwind_Context *ctx, void *data)
+{
+  FrameWalkState &state = *(FrameWalkState *)data;
+
+  void *ip = (void *)_Unwind_GetIP(ctx);
+
+  if(ip == NULL)
+    return _URC_END_OF_STACK;
+
+  // unwind fully through our own frames, these are not recorded
+  if(ip >= renderdocBase && ip < renderdocEnd)
+    return _URC_NO_REASON;
+
+  state.addrs[state.numLevels++] = (uint64_t)ip;
+
+#if defined(FRAME_POINTER_DWARF_REG)
+  // as soon as we're in the application's code, stop unwinding and take over with its frame pointer
+  state.framePointer = (uintptr_t)_Unwind_GetGR(ctx, FRAME_POINTER_DWARF_REG);
+  return _URC_END_OF_STACK;
+#else
+  return state.numLevels < state.maxLevels ? _URC_NO_REASON : _URC_END_OF_STACK;
+#endif
+}
+
 class LinuxCallstack : public Callstack::Stackwalk
 {
 public:
@@ -64,6 +144,9 @@ private:
 
   void Collect()
   {
+    if(Linux_FramePointerCallstacks() && CollectFramePointers())
+      return;
+
     void *addrs_ptr[ARRAY_COUNT(addrs)];
 
     int ret = backtrace(addrs_ptr, ARRAY_COUNT(addrs));
@@ -85,6 +168,44 @@ private:
       addrs[i] = (uint64_t)addrs_ptr[i + offs];
   }
 
+  bool CollectFramePointers()
+  {
+    uintptr_t low = 0, high = 0;
+    if(!GetThreadStackBounds(low, high))
+      return false;
+
+    FrameWalkState state = {addrs, ARRAY_COUNT(addrs), 0, 0};
+
+    _Unwind_Backtrace(&FrameWalkCallback, &state);
+
+    uintptr_t fp = state.framePointer;
+
+    // each frame record is the caller's frame pointer followed by the return address. Stop as soon
+    // as the chain leaves the stack or doesn't move strictly upwards, which will happen at the
+    // first frame compiled without a frame pointer.
+    while(state.numLevels < ARRAY_COUNT(addrs))
+    {
+      if(fp < low || fp + sizeof(uintptr_t) * 2 > high || (fp & (sizeof(uintptr_t) - 1)) != 0)
+        break;
+
+      uintptr_t *record = (uintptr_t *)fp;
+
+      if(record[1] == 0)
+        break;
+
+      addrs[state.numLevels++] = (uint64_t)record[1];
+
+      if(record[0] <= fp)
+        break;
+
+      fp = record[0];
+    }
+
+    numLevels = state.numLevels;
+
+    return numLevels > 0;
+  }
+
   uint64_t addrs[128];
   size_t numLevels;
 };
@@ -93,6 +214,9 @@ namespace Callstack
 {
 void Init()
 {
+  stackLowSlot = Threading::AllocateTLSSlot();
+  stackHighSlot = Threading::AllocateTLSSlot();
+
   // look for our own line
   FILE *f = FileIO::fopen("/proc/self/maps", FileIO::ReadText);
 
@@ -191,85 +315,163 @@ struct LookupModule
   char path[2048];
 };
 
+// addr2line takes addresses on the command line, so limit how many we pass in one invocation
+static const size_t MaxAddr2LineBatch = 256;
+
 class LinuxResolver : public Callstack::StackResolver
 {
 public:
   LinuxResolver(rdcarray<LookupModule> modules) { m_Modules = modules; }
-  Callstack::AddressDetails GetAddr(uint64_t addr)
+  Callstack::AddressDetails GetAddr(uint64_t addr) { return GetAddrs({addr})[0]; }
+  rdcarray<Callstack::AddressDetails> GetAddrs(const rdcarray<uint64_t> &addrs)
   {
-    EnsureCached(addr);
+    EnsureCached(addrs);
 
-    return m_Cache[addr];
+    rdcarray<Callstack::AddressDetails> ret;
+    ret.reserve(addrs.size());
+    for(uint64_t addr : addrs)
+      ret.push_back(m_Cache[addr]);
+    return ret;
   }
 
 private:
-  void EnsureCached(uint64_t addr)
+  struct ModuleBatch
+  {
+    size_t module;
+    rdcarray<uint64_t> addrs;
+    rdcarray<Callstack::AddressDetails> details;
+  };
+
+  void EnsureCached(const rdcarray<uint64_t> &addrs)
   {
-    auto it = m_Cache.insert(
-        std::pair<uint64_t, Callstack::AddressDetails>(addr, Callstack::AddressDetails()));
-    if(!it.second)
+    // each addr2line invocation has to load the module's debug info, which dominates the cost. So
+    // gather every uncached address by module and resolve each module's addresses in one go.
+    std::map<size_t, ModuleBatch> batches;
+
+    for(uint64_t addr : addrs)
+    {
+      auto it = m_Cache.insert(
+          std::pair<uint64_t, Callstack::AddressDetails>(addr, Callstack::AddressDetails()));
+      if(!it.second)
+        continue;
+
+      Callstack::AddressDetails &ret = it.first->second;
+
+      ret.filename = "Unknown";
+      ret.line = 0;
+      ret.function = StringFormat::Fmt("0x%08llx", addr);
+
+      for(size_t i = 0; i < m_Modules.size(); i++)
+      {
+        if(addr >= m_Modules[i].base && addr < m_Modules[i].end)
+        {
+          ModuleBatch &batch = batches[i];
+          batch.module = i;
+          batch.addrs.push_back(addr);
+          batch.details.push_back(ret);
+          break;
+        }
+      }
+    }
+
+    if(batches.empty())
       return;
 
-    Callstack::AddressDetails &ret = it.first->second;
+    // modules are independent, so resolve them in parallel
+    rdcarray<Threading::ThreadHandle> threads;
+    for(auto it = batches.begin(); it != batches.end(); ++it)
+    {
+      ModuleBatch *batch = &it->second;
+      if(batches.size() == 1)
+        Resolve(*batch);
+      else
+        threads.push_back(Threading::CreateThread([this, batch]() { Resolve(*batch); }));
+    }
 
-    ret.filename = "Unknown";
-    ret.line = 0;
-    ret.function = StringFormat::Fmt("0x%08llx", addr);
+    for(Threading::ThreadHandle t : threads)
+    {
+      Threading::JoinThread(t);
+      Threading::CloseThread(t);
+    }
 
-    for(size_t i = 0; i < m_Modules.size(); i++)
+    for(auto it = batches.begin(); it != batches.end(); ++it)
     {
-      if(addr >= m_Modules[i].base && addr < m_Modules[i].end)
-      {
-        RDCLOG("%llx relative to module %llx-%llx, with offset %llx", addr, m_Modules[i].base,
-               m_Modules[i].end, m_Modules[i].offset);
-        uint64_t relative = addr - m_Modules[i].base + m_Modules[i].offset;
-        rdcstr cmd = StringFormat::Fmt("addr2line -fCe \"%s\" 0x%llx", m_Modules[i].path, relative);
+      const ModuleBatch &batch = it->second;
+      for(size_t i = 0; i < batch.addrs.size(); i++)
+        m_Cache[batch.addrs[i]] = batch.details[i];
+    }
+  }
+
+  void Resolve(ModuleBatch &batch)
+  {
+    const LookupModule &mod = m_Modules[batch.module];
 
-        RDCLOG(": %s", cmd.c_str());
+    for(size_t first = 0; first < batch.addrs.size(); first += MaxAddr2LineBatch)
+    {
+      size_t count = RDCMIN(MaxAddr2LineBatch, batch.addrs.size() - first);
 
-        FILE *f = ::popen(cmd.c_str(), "r");
+      rdcstr cmd = StringFormat::Fmt("addr2line -fCe \"%s\"", mod.path);
+      for(size_t i = first; i < first + count; i++)
+        cmd += StringFormat::Fmt(" 0x%llx", batch.addrs[i] - mod.base + mod.offset);
 
-        char result[2048] = {0};
-        fread(result, 1, 2047, f);
+      RDCLOG("Resolving %zu addresses in %s", count, mod.path);
 
-        ::pclose(f);
+      FILE *f = ::popen(cmd.c_str(), "r");
 
-        char *line2 = strchr(result, '\n');
-        if(line2)
-        {
-          *line2 = 0;
-          line2++;
-        }
+      if(!f)
+        continue;
 
-        ret.function = result;
+      // addr2line prints two lines for every address, the function name and then file:line
+      for(size_t i = first; i < first + count; i++)
+      {
+        char function[2048] = {0};
+        char fileline[2048] = {0};
 
-        if(line2)
-        {
-          char *linenum = line2 + strlen(line2) - 1;
-          while(linenum > line2 && *linenum != ':')
-            linenum--;
+        if(!fgets(function, sizeof(function) - 1, f) || !fgets(fileline, sizeof(fileline) - 1, f))
+          break;
 
-          ret.line = 0;
+        batch.details[i] = ParseAddr2Line(function, fileline);
+      }
 
-          if(*linenum == ':')
-          {
-            *linenum = 0;
-            linenum++;
+      ::pclose(f);
+    }
+  }
 
-            while(*linenum >= '0' && *linenum <= '9')
-            {
-              ret.line *= 10;
-              ret.line += (uint32_t(*linenum) - uint32_t('0'));
-              linenum++;
-            }
-          }
+  static Callstack::AddressDetails ParseAddr2Line(char *function, char *line2)
+  {
+    Callstack::AddressDetails ret;
 
-          ret.filename = line2;
-        }
+    char *nl = strchr(function, '\n');
+    if(nl)
+      *nl = 0;
+    nl = strchr(line2, '\n');
+    if(nl)
+      *nl = 0;
 
-        break;
+    ret.function = function;
+
+    char *linenum = line2 + strlen(line2) - 1;
+    while(linenum > line2 && *linenum != ':')
+      linenum--;
+
+    ret.line = 0;
+
+    if(*linenum == ':')
+    {
+      *linenum = 0;
+      linenum++;
+
+      while(*linenum >= '0' && *linenum <= '9')
+      {
+        ret.line *= 10;
+        ret.line += (uint32_t(*linenum) - uint32_t('0'));
+        linenum++;
       }
     }
+
+    ret.filename = line2;
+
+    return ret;
   }
 
   rdcarray<LookupModule> m_Modules;
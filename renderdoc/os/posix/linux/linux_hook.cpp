@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include <dlfcn.h>
+#include <link.h>
 #include <string.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -43,6 +44,15 @@ RDOC_EXTERN_CONFIG(bool, Linux_Debug_PtraceLogging);
 static std::map<rdcstr, rdcarray<FunctionLoadCallback>> libraryCallbacks;
 static rdcarray<rdcstr> libraryHooks;
 static rdcarray<FunctionHook> functionHooks;
+// function name to indices in functionHooks, so that a library's imports can be matched against
+// the hooks in one pass instead of searching the imports once per hook
+static std::map<rdcstr, rdcarray<size_t>> functionHookIndex;
+// the handle each hooked library was last processed with, so already-processed libraries aren't
+// searched again for functions they didn't have the first time
+static std::map<rdcstr, void *> processedLibraries;
+// the number of libraries the loader had loaded when we last checked for hooked libraries. If
+// nothing new has been loaded since then, there's nothing to check
+static unsigned long long checkedLoadCount = 0;
 
 void *intercept_dlopen(const char *filename, int flag, void *ret);
 void plthook_lib(void *handle);
@@ -426,10 +436,37 @@ void plthook_lib(void *handle)
   if(plthook_open_by_handle(&plthook, handle))
     return;
 
-  plthook_replace(plthook, "dlopen", (void *)dlopen, NULL);
+  // walk the library's imports once to find which of them we hook. Most libraries import few or
+  // none of them, so this avoids searching the whole import table for every registered hook.
+  bool importsDlopen = false;
+  rdcarray<size_t> hooks;
 
-  for(FunctionHook &hook : functionHooks)
+  unsigned int pos = 0;
+  const char *name = NULL;
+  void **addr = NULL;
+  while(plthook_enum(plthook, &pos, &name, &addr) == 0)
   {
+    // imports may be versioned as name@VERSION
+    const char *version = strchr(name, '@');
+    rdcstr funcName = version ? rdcstr(name, version - name) : rdcstr(name);
+
+    if(funcName == "dlopen")
+    {
+      importsDlopen = true;
+      continue;
+    }
+
+    auto it = functionHookIndex.find(funcName);
+    if(it != functionHookIndex.end())
+      hooks.append(it->second);
+  }
+
+  if(importsDlopen)
+    plthook_replace(plthook, "dlopen", (void *)dlopen, NULL);
+
+  for(size_t i : hooks)
+  {
+    FunctionHook &hook = functionHooks[i];
     void *orig = NULL;
     plthook_replace(plthook, hook.function.c_str(), hook.hook, &orig);
     if(hook.orig && *hook.orig == NULL && orig)
@@ -439,6 +476,25 @@ void plthook_lib(void *handle)
   plthook_close(plthook);
 }
 
+static int dl_load_count_callback(struct dl_phdr_info *info, size_t size, void *data)
+{
+  unsigned long long *count = (unsigned long long *)data;
+
+  // older loaders don't provide the load count, leave it at 0 so we always check
+  if(size >= offsetof(dl_phdr_info, dlpi_adds) + sizeof(info->dlpi_adds))
+    *count = info->dlpi_adds;
+
+  // the count is the same for every object, so stop after the first
+  return 1;
+}
+
+static unsigned long long GetLoadCount()
+{
+  unsigned long long count = 0;
+  dl_iterate_phdr(dl_load_count_callback, &count);
+  return count;
+}
+
 // multiple libraries names pointing at the same file are declared as hooks
 // in this case, if the second version gets loaded or when CheckLoadedLibraries is run,
 // hooks are run another time. Avoid this by clearing callbacks of hooks pointing at the same
@@ -467,6 +523,18 @@ static void CheckLoadedLibraries()
   if(Atomic::CmpExch32(&tlsbusyflag, 0, 1) != 0)
     return;
 
+  // if no libraries have been loaded since we last checked, none of the hooked libraries can have
+  // been loaded either. This is the common case when applications dlopen libraries that are
+  // already loaded, or that don't pull in anything we hook.
+  unsigned long long loadCount = GetLoadCount();
+  if(loadCount != 0 && loadCount == checkedLoadCount)
+  {
+    Atomic::Dec32(&tlsbusyflag);
+    return;
+  }
+
+  checkedLoadCount = loadCount;
+
   // iterate over the libraries and see which ones are already loaded, process function hooks for
   // them and call callbacks.
   for(auto it = libraryHooks.begin(); it != libraryHooks.end(); ++it)
@@ -476,6 +544,12 @@ static void CheckLoadedLibraries()
 
     if(handle)
     {
+      // already processed, nothing more will be found in it
+      if(processedLibraries[libName] == handle && libraryCallbacks[libName].empty())
+        continue;
+
+      processedLibraries[libName] = handle;
+
       for(FunctionHook &hook : functionHooks)
       {
         if(hook.orig && *hook.orig == NULL)
@@ -590,7 +664,11 @@ void LibraryHooks::RegisterFunctionHook(const char *libraryName, const FunctionH
   (void)libraryName;
 
   SCOPED_LOCK(libLock);
+  functionHookIndex[hook.function].push_back(functionHooks.size());
   functionHooks.push_back(hook);
+  // re-check loaded libraries for the new function
+  processedLibraries.clear();
+  checkedLoadCount = 0;
 }
 
 void LibraryHooks::RegisterLibraryHook(char const *name, FunctionLoadCallback cb)
@@ -602,6 +680,9 @@ void LibraryHooks::RegisterLibraryHook(char const *name, FunctionLoadCallback cb
 
   if(cb)
     libraryCallbacks[name].push_back(cb);
+
+  // re-check loaded libraries for the new library
+  checkedLoadCount = 0;
 }
 
 void LibraryHooks::IgnoreLibrary(const char *libraryName)
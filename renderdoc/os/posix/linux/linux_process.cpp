@@ -23,8 +23,13 @@
  ******************************************************************************/
 
 #include <elf.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/userfaultfd.h>
 #include <stdlib.h>
+#include <sys/ioctl.h>
 #include <sys/ptrace.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/uio.h>
 #include <sys/user.h>
@@ -746,3 +751,194 @@ uint64_t Process::GetMemoryUsage()
 
   return 0;
 }
+
+// these are only present in recent kernel headers, but are stable ABI so define them ourselves.
+// The page map scan types are mirrored from <linux/fs.h> under our own names to avoid clashing
+// with headers that do have them.
+#ifndef UFFD_USER_MODE_ONLY
+#define UFFD_USER_MODE_ONLY 1
+#endif
+
+#ifndef UFFD_FEATURE_WP_UNPOPULATED
+#define UFFD_FEATURE_WP_UNPOPULATED (1 << 13)
+#endif
+
+#ifndef UFFD_FEATURE_WP_ASYNC
+#define UFFD_FEATURE_WP_ASYNC (1 << 15)
+#endif
+
+namespace
+{
+struct PageRegion
+{
+  uint64_t start;
+  uint64_t end;
+  uint64_t categories;
+};
+
+struct PageMapScanArg
+{
+  uint64_t size;
+  uint64_t flags;
+  uint64_t start;
+  uint64_t end;
+  uint64_t walk_end;
+  uint64_t vec;
+  uint64_t vec_len;
+  uint64_t max_pages;
+  uint64_t category_inverted;
+  uint64_t category_mask;
+  uint64_t category_anyof_mask;
+  uint64_t return_mask;
+};
+
+static const unsigned long PageMapScanIoctl = _IOWR('f', 16, PageMapScanArg);
+static const uint64_t PageMapScanWPMatching = 1 << 0;
+static const uint64_t PageMapScanCheckWPAsync = 1 << 1;
+static const uint64_t PageIsWritten = 1 << 1;
+
+// Writes are tracked with an asynchronous write-protect userfaultfd: the kernel resolves write
+// faults itself and just marks the page as written, and PAGEMAP_SCAN can then atomically fetch the
+// written pages and re-protect them. This needs linux 6.7 or newer, and only works for anonymous
+// or shmem memory - registering any other kind of mapping fails.
+struct WriteWatchState
+{
+  int uffd = -1;
+  int pagemap = -1;
+  uint64_t pageSize = 4096;
+
+  WriteWatchState()
+  {
+    pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+
+    uffd = (int)syscall(SYS_userfaultfd, O_CLOEXEC | O_NONBLOCK | UFFD_USER_MODE_ONLY);
+    if(uffd < 0)
+    {
+      RDCLOG("userfaultfd is not available (%d), can't track memory writes", errno);
+      return;
+    }
+
+    uffdio_api api = {};
+    api.api = UFFD_API;
+    api.features = UFFD_FEATURE_WP_ASYNC | UFFD_FEATURE_WP_UNPOPULATED;
+
+    if(ioctl(uffd, UFFDIO_API, &api) == 0)
+      pagemap = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+
+    if(pagemap < 0)
+    {
+      RDCLOG("Asynchronous write-protect userfaultfd is not available, can't track memory writes");
+      close(uffd);
+      uffd = -1;
+    }
+  }
+};
+
+WriteWatchState &GetWriteWatchState()
+{
+  // deliberately leaked, the file descriptors live as long as the process
+  static WriteWatchState *state = new WriteWatchState;
+  return *state;
+}
+};
+
+bool WriteWatch::StartTracking(void *base, size_t size)
+{
+  WriteWatchState &state = GetWriteWatchState();
+
+  if(state.uffd < 0 || size == 0)
+    return false;
+
+  uint64_t start = (uint64_t)(uintptr_t)base & ~(state.pageSize - 1);
+  uint64_t end = AlignUp((uint64_t)(uintptr_t)base + size, state.pageSize);
+
+  uffdio_register reg = {};
+  reg.range.start = start;
+  reg.range.len = end - start;
+  reg.mode = UFFDIO_REGISTER_MODE_WP;
+
+  if(ioctl(state.uffd, UFFDIO_REGISTER, &reg) != 0)
+    return false;
+
+  uffdio_writeprotect wp = {};
+  wp.range = reg.range;
+  wp.mode = UFFDIO_WRITEPROTECT_MODE_WP;
+
+  if(ioctl(state.uffd, UFFDIO_WRITEPROTECT, &wp) != 0)
+  {
+    ioctl(state.uffd, UFFDIO_UNREGISTER, &reg.range);
+    return false;
+  }
+
+  return true;
+}
+
+void WriteWatch::StopTracking(void *base, size_t size)
+{
+  WriteWatchState &state = GetWriteWatchState();
+
+  if(state.uffd < 0 || size == 0)
+    return;
+
+  uffdio_range range = {};
+  range.start = (uint64_t)(uintptr_t)base & ~(state.pageSize - 1);
+  range.len = AlignUp((uint64_t)(uintptr_t)base + size, state.pageSize) - range.start;
+
+  ioctl(state.uffd, UFFDIO_UNREGISTER, &range);
+}
+
+bool WriteWatch::GetWrittenRanges(void *base, size_t size,
+                                  rdcarray<rdcpair<size_t, size_t>> &ranges)
+{
+  ranges.clear();
+
+  WriteWatchState &state = GetWriteWatchState();
+
+  if(state.pagemap < 0)
+    return false;
+
+  const uint64_t regionStart = (uint64_t)(uintptr_t)base;
+  const uint64_t regionEnd = regionStart + size;
+
+  PageRegion regions[64];
+
+  PageMapScanArg arg = {};
+  arg.size = sizeof(arg);
+  arg.flags = PageMapScanWPMatching | PageMapScanCheckWPAsync;
+  arg.start = regionStart & ~(state.pageSize - 1);
+  arg.end = AlignUp(regionEnd, state.pageSize);
+  arg.vec = (uint64_t)(uintptr_t)regions;
+  arg.vec_len = ARRAY_COUNT(regions);
+  arg.category_mask = PageIsWritten;
+  arg.return_mask = PageIsWritten;
+
+  while(arg.start < arg.end)
+  {
+    int numRegions = ioctl(state.pagemap, PageMapScanIoctl, &arg);
+
+    if(numRegions < 0)
+      return false;
+
+    for(int i = 0; i < numRegions; i++)
+    {
+      size_t start = size_t(RDCMAX(regions[i].start, regionStart) - regionStart);
+      size_t end = size_t(RDCMIN(regions[i].end, regionEnd) - regionStart);
+
+      if(end <= start)
+        continue;
+
+      if(!ranges.empty() && ranges.back().second == start)
+        ranges.back().second = end;
+      else
+        ranges.push_back({start, end});
+    }
+
+    // the scan stops early when the output is full, so continue from where it stopped
+    if(arg.walk_end <= arg.start)
+      return false;
+
+    arg.start = arg.walk_end;
+  }
+
+  return true;
+}
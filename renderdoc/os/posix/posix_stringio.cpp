@@ -32,6 +32,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/file.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <time.h>
@@ -451,6 +452,40 @@ int fclose(FILE *f)
   return ::fclose(f);
 }
 
+bool MapFileRegion(FILE *f, uint64_t offset, uint64_t length, MappedFileRegion &region)
+{
+  region = MappedFileRegion();
+
+  if(length == 0)
+    return false;
+
+  // mmap offsets must be page aligned, so map from the page containing the offset
+  uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+  uint64_t alignedOffset = offset - (offset % pageSize);
+  uint64_t mapSize = length + (offset - alignedOffset);
+
+  void *base =
+      ::mmap(NULL, (size_t)mapSize, PROT_READ, MAP_PRIVATE, ::fileno(f), (off_t)alignedOffset);
+
+  if(base == MAP_FAILED)
+    return false;
+
+  region.data = (const byte *)base + (offset - alignedOffset);
+  region.size = length;
+  region.mapBase = base;
+  region.mapSize = mapSize;
+
+  return true;
+}
+
+void UnmapFileRegion(MappedFileRegion &region)
+{
+  if(region.mapBase)
+    ::munmap(region.mapBase, (size_t)region.mapSize);
+
+  region = MappedFileRegion();
+}
+
 bool IsUntrustedFile(const rdcstr &filename)
 {
   // do android/linux have any way of marking files as potentially unsafe?
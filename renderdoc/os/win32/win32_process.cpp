@@ -1745,3 +1745,59 @@ void Process::Shutdown()
 {
   // nothing to do
 }
+
+// write watching can only be enabled when memory is allocated with MEM_WRITE_WATCH, so this only
+// succeeds for memory that was allocated that way. Resetting fails for any other memory.
+bool WriteWatch::StartTracking(void *base, size_t size)
+{
+  return size > 0 && ResetWriteWatch(base, size) == 0;
+}
+
+void WriteWatch::StopTracking(void *base, size_t size)
+{
+  // nothing to do, tracking is tied to the allocation
+}
+
+bool WriteWatch::GetWrittenRanges(void *base, size_t size,
+                                  rdcarray<rdcpair<size_t, size_t>> &ranges)
+{
+  ranges.clear();
+
+  const uintptr_t regionStart = (uintptr_t)base;
+  const uintptr_t regionEnd = regionStart + size;
+
+  PVOID addresses[256];
+
+  for(;;)
+  {
+    ULONG_PTR count = ARRAY_COUNT(addresses);
+    ULONG granularity = 0;
+
+    // resetting as we fetch is atomic, so no writes can be missed between the two
+    if(GetWriteWatch(WRITE_WATCH_FLAG_RESET, base, size, addresses, &count, &granularity) != 0)
+      return false;
+
+    for(ULONG_PTR i = 0; i < count; i++)
+    {
+      uintptr_t page = (uintptr_t)addresses[i];
+
+      size_t start = size_t(RDCMAX(page, regionStart) - regionStart);
+      size_t end = size_t(RDCMIN(page + granularity, regionEnd) - regionStart);
+
+      if(end <= start)
+        continue;
+
+      if(!ranges.empty() && ranges.back().second == start)
+        ranges.back().second = end;
+      else
+        ranges.push_back({start, end});
+    }
+
+    // if the output wasn't filled there are no more written pages. Otherwise the pages we fetched
+    // were reset so fetch again to get the rest
+    if(count < ARRAY_COUNT(addresses))
+      break;
+  }
+
+  return true;
+}
@@ -59,6 +59,7 @@ namespace Threading
 {
 typedef CriticalSectionTemplate<CRITICAL_SECTION> CriticalSection;
 typedef RWLockTemplate<SRWLOCK> RWLock;
+typedef SemaphoreTemplate<HANDLE> Semaphore;
 };
 
 namespace Bits
@@ -705,6 +705,55 @@ int fclose(FILE *f)
   return ::fclose(f);
 }
 
+bool MapFileRegion(FILE *f, uint64_t offset, uint64_t length, MappedFileRegion &region)
+{
+  region = MappedFileRegion();
+
+  if(length == 0)
+    return false;
+
+  HANDLE file = (HANDLE)::_get_osfhandle(::_fileno(f));
+
+  HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+  if(mapping == NULL)
+    return false;
+
+  // view offsets must be aligned to the allocation granularity
+  SYSTEM_INFO sysInfo;
+  GetSystemInfo(&sysInfo);
+
+  uint64_t alignedOffset = offset - (offset % sysInfo.dwAllocationGranularity);
+  uint64_t mapSize = length + (offset - alignedOffset);
+
+  void *base = MapViewOfFile(mapping, FILE_MAP_READ, DWORD(alignedOffset >> 32),
+                             DWORD(alignedOffset & 0xffffffff), (SIZE_T)mapSize);
+
+  if(base == NULL)
+  {
+    CloseHandle(mapping);
+    return false;
+  }
+
+  region.data = (const byte *)base + (offset - alignedOffset);
+  region.size = length;
+  region.mapBase = base;
+  region.mapSize = mapSize;
+  region.mapHandle = mapping;
+
+  return true;
+}
+
+void UnmapFileRegion(MappedFileRegion &region)
+{
+  if(region.mapBase)
+    UnmapViewOfFile(region.mapBase);
+  if(region.mapHandle)
+    CloseHandle((HANDLE)region.mapHandle);
+
+  region = MappedFileRegion();
+}
+
 LogFileHandle *logfile_open(const rdcstr &filename)
 {
   rdcwstr wfn = StringFormat::UTF82Wide(filename);
@@ -83,6 +83,16 @@ int32_t CmpExch32(int32_t *dest, int32_t oldVal, int32_t newVal)
 {
   return (int32_t)InterlockedCompareExchange((volatile LONG *)dest, newVal, oldVal);
 }
+
+int64_t CmpExch64(int64_t *dest, int64_t oldVal, int64_t newVal)
+{
+  return (int64_t)InterlockedCompareExchange64((volatile LONG64 *)dest, newVal, oldVal);
+}
+
+void *CmpExchPtr(void **dest, void *oldVal, void *newVal)
+{
+  return InterlockedCompareExchangePointer((volatile PVOID *)dest, newVal, oldVal);
+}
 };
 
 namespace Threading
@@ -164,6 +174,30 @@ void RWLock::ReadUnlock()
   ReleaseSRWLockShared(&m_Data);
 }
 
+template <>
+Semaphore::SemaphoreTemplate()
+{
+  m_Data = CreateSemaphore(NULL, 0, LONG_MAX, NULL);
+}
+
+template <>
+Semaphore::~SemaphoreTemplate()
+{
+  CloseHandle(m_Data);
+}
+
+template <>
+void Semaphore::Wake(uint32_t numToWake)
+{
+  ReleaseSemaphore(m_Data, (LONG)numToWake, NULL);
+}
+
+template <>
+void Semaphore::WaitForWake()
+{
+  WaitForSingleObject(m_Data, INFINITE);
+}
+
 struct ThreadInitData
 {
   std::function<void()> entryFunc;
@@ -343,6 +377,13 @@ void DetachThread(ThreadHandle handle)
   CloseHandle((HANDLE)handle);
 }
 
+uint32_t GetNumCores()
+{
+  SYSTEM_INFO info = {};
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 0 ? (uint32_t)info.dwNumberOfProcessors : 1;
+}
+
 void CloseThread(ThreadHandle handle)
 {
   if(handle == 0)
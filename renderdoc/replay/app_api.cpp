@@ -27,6 +27,7 @@
 #include "api/replay/apidefs.h"    // for RENDERDOC_API to export the RENDERDOC_GetAPI function
 #include "common/common.h"
 #include "common/formatting.h"
+#include "core/api_overhead.h"
 #include "core/core.h"
 #include "hooks/hooks.h"
 #include "serialise/rdcfile.h"
@@ -251,28 +252,46 @@ static uint32_t ShowReplayUI()
   return RenderDoc::Inst().ShowReplayUI() ? 1 : 0;
 }
 
+static uint32_t GetAPIOverheadCounters(RENDERDOC_APIOverheadCounter *counters, uint32_t count)
+{
+  APIOverhead::Enable();
+
+  rdcarray<APIOverheadStat> stats = APIOverhead::GetStats();
+
+  for(uint32_t i = 0; counters && i < count && i < stats.size(); i++)
+  {
+    counters[i].function = stats[i].function;
+    counters[i].calls = stats[i].calls;
+    counters[i].wrapperNanoseconds = stats[i].wrapperNanoseconds;
+    counters[i].driverNanoseconds = stats[i].driverNanoseconds;
+    counters[i].serialisedBytes = stats[i].serialisedBytes;
+  }
+
+  return (uint32_t)stats.size();
+}
+
 // defined in capture_options.cpp
 int RENDERDOC_CC SetCaptureOptionU32(RENDERDOC_CaptureOption opt, uint32_t val);
 int RENDERDOC_CC SetCaptureOptionF32(RENDERDOC_CaptureOption opt, float val);
 uint32_t RENDERDOC_CC GetCaptureOptionU32(RENDERDOC_CaptureOption opt);
 float RENDERDOC_CC GetCaptureOptionF32(RENDERDOC_CaptureOption opt);
 
-void RENDERDOC_CC GetAPIVersion_1_6_0(int *major, int *minor, int *patch)
+void RENDERDOC_CC GetAPIVersion_1_7_0(int *major, int *minor, int *patch)
 {
   if(major)
     *major = 1;
   if(minor)
-    *minor = 6;
+    *minor = 7;
   if(patch)
     *patch = 0;
 }
 
-RENDERDOC_API_1_6_0 api_1_6_0;
-void Init_1_6_0()
+RENDERDOC_API_1_7_0 api_1_7_0;
+void Init_1_7_0()
 {
-  RENDERDOC_API_1_6_0 &api = api_1_6_0;
+  RENDERDOC_API_1_7_0 &api = api_1_7_0;
 
-  api.GetAPIVersion = &GetAPIVersion_1_6_0;
+  api.GetAPIVersion = &GetAPIVersion_1_7_0;
 
   api.SetCaptureOptionU32 = &SetCaptureOptionU32;
   api.SetCaptureOptionF32 = &SetCaptureOptionF32;
@@ -315,6 +334,8 @@ void Init_1_6_0()
   api.ShowReplayUI = &ShowReplayUI;
 
   api.SetCaptureTitle = &SetCaptureTitle;
+
+  api.GetAPIOverheadCounters = &GetAPIOverheadCounters;
 }
 
 extern "C" RENDERDOC_API int RENDERDOC_CC RENDERDOC_GetAPI(RENDERDOC_Version version,
@@ -341,19 +362,20 @@ extern "C" RENDERDOC_API int RENDERDOC_CC RENDERDOC_GetAPI(RENDERDOC_Version ver
     ret = 1;                                                       \
   }
 
-  API_VERSION_HANDLE(1_0_0, 1_6_0);
-  API_VERSION_HANDLE(1_0_1, 1_6_0);
-  API_VERSION_HANDLE(1_0_2, 1_6_0);
-  API_VERSION_HANDLE(1_1_0, 1_6_0);
-  API_VERSION_HANDLE(1_1_1, 1_6_0);
-  API_VERSION_HANDLE(1_1_2, 1_6_0);
-  API_VERSION_HANDLE(1_2_0, 1_6_0);
-  API_VERSION_HANDLE(1_3_0, 1_6_0);
-  API_VERSION_HANDLE(1_4_0, 1_6_0);
-  API_VERSION_HANDLE(1_4_1, 1_6_0);
-  API_VERSION_HANDLE(1_4_2, 1_6_0);
-  API_VERSION_HANDLE(1_5_0, 1_6_0);
-  API_VERSION_HANDLE(1_6_0, 1_6_0);
+  API_VERSION_HANDLE(1_0_0, 1_7_0);
+  API_VERSION_HANDLE(1_0_1, 1_7_0);
+  API_VERSION_HANDLE(1_0_2, 1_7_0);
+  API_VERSION_HANDLE(1_1_0, 1_7_0);
+  API_VERSION_HANDLE(1_1_1, 1_7_0);
+  API_VERSION_HANDLE(1_1_2, 1_7_0);
+  API_VERSION_HANDLE(1_2_0, 1_7_0);
+  API_VERSION_HANDLE(1_3_0, 1_7_0);
+  API_VERSION_HANDLE(1_4_0, 1_7_0);
+  API_VERSION_HANDLE(1_4_1, 1_7_0);
+  API_VERSION_HANDLE(1_4_2, 1_7_0);
+  API_VERSION_HANDLE(1_5_0, 1_7_0);
+  API_VERSION_HANDLE(1_6_0, 1_7_0);
+  API_VERSION_HANDLE(1_7_0, 1_7_0);
 
 #undef API_VERSION_HANDLE
 
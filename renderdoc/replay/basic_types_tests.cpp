@@ -33,6 +33,7 @@
 #include "api/replay/resourceid.h"
 #include "common/formatting.h"
 #include "common/globalconfig.h"
+#include "common/inline_array.h"
 #include "common/timing.h"
 #include "os/os_specific.h"
 
@@ -2437,4 +2438,101 @@ TEST_CASE("Test rdcfixedarray type", "[basictypes][rdcfixedarray]")
   };
 };
 
+TEST_CASE("Test rdcinlinearray type", "[basictypes][rdcinlinearray]")
+{
+  SECTION("Basic test")
+  {
+    rdcinlinearray<int32_t, 4> test;
+
+    CHECK(test.empty());
+    CHECK(test.size() == 0);
+    CHECK(test.capacity() == 4);
+    CHECK(test.begin() == test.end());
+
+    test.push_back(5);
+    test.push_back(6);
+    test.push_back(7);
+
+    CHECK(test.size() == 3);
+    CHECK(test.isInline());
+    CHECK(test[0] == 5);
+    CHECK(test.front() == 5);
+    CHECK(test.back() == 7);
+
+    test.resize(6);
+
+    CHECK(test.size() == 6);
+    CHECK_FALSE(test.isInline());
+    CHECK(test[2] == 7);
+    CHECK(test[3] == 0);
+    CHECK(test[5] == 0);
+
+    int32_t sum = 0;
+    for(int32_t i : test)
+      sum += i;
+    CHECK(sum == 18);
+
+    test.pop_back();
+    CHECK(test.size() == 5);
+
+    // clearing keeps the allocation
+    size_t cap = test.capacity();
+    test.clear();
+    CHECK(test.empty());
+    CHECK(test.capacity() == cap);
+  };
+
+  SECTION("Growing past the inline storage")
+  {
+    rdcinlinearray<uint64_t, 2> test;
+
+    for(uint64_t i = 0; i < 100; i++)
+    {
+      test.push_back(i * 3);
+      CHECK(test.isInline() == (i < 2));
+    }
+
+    CHECK(test.size() == 100);
+    for(uint64_t i = 0; i < 100; i++)
+      CHECK(test[i] == i * 3);
+
+    // pushing back one of our own elements while growing
+    rdcinlinearray<uint64_t, 2> test2;
+    test2.push_back(9);
+    test2.push_back(10);
+    test2.push_back(test2[0]);
+    CHECK(test2.size() == 3);
+    CHECK(test2[2] == 9);
+  };
+
+  SECTION("Copying and appending")
+  {
+    rdcarray<int32_t> src = {1, 2, 3, 4, 5, 6};
+
+    rdcinlinearray<int32_t, 4> test;
+    test.push_back(0);
+    test.append(src);
+
+    CHECK(test.size() == 7);
+    CHECK(test[0] == 0);
+    CHECK(test[6] == 6);
+
+    rdcinlinearray<int32_t, 4> copy = test;
+    CHECK(copy.size() == 7);
+    CHECK(copy[6] == 6);
+    CHECK(copy.data() != test.data());
+
+    rdcinlinearray<int32_t, 4> small;
+    small.push_back(42);
+
+    copy = small;
+    CHECK(copy.size() == 1);
+    CHECK(copy[0] == 42);
+
+    small = test;
+    CHECK(small.size() == 7);
+    CHECK(small[3] == 3);
+  };
+};
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
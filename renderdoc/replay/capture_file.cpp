@@ -175,6 +175,8 @@ private:
 
   RDCFile *m_RDC = NULL;
   Callstack::StackResolver *m_Resolver = NULL;
+  // chunks share a small number of unique callstacks, so each one is only resolved once
+  std::map<rdcarray<uint64_t>, rdcarray<rdcstr>> m_ResolveCache;
 
   SDFile m_StructuredData;
 
@@ -527,7 +529,10 @@ ResultDetails CaptureFile::Convert(const rdcstr &filename, const rdcstr &filetyp
   {
     const SectionProperties &props = m_RDC->GetSectionProperties(i);
 
-    if(props.type == SectionType::FrameCapture)
+    // the block and chunk indices describe the original frame capture section, they're regenerated
+    // for the new frame capture.
+    if(props.type == SectionType::FrameCapture || props.type == SectionType::BlockIndex ||
+       props.type == SectionType::ChunkIndex)
       continue;
 
     StreamWriter *writer = output.WriteSection(props);
@@ -816,6 +821,9 @@ ResultDetails CaptureFile::InitResolver(bool interactive, RENDERDOC_ProgressCall
   if(progress)
     progress(0.002f);
 
+  SAFE_DELETE(m_Resolver);
+  m_ResolveCache.clear();
+
   m_Resolver = Callstack::MakeResolver(interactive, buf.data(), buf.size(), progress);
 
   if(!m_Resolver)
@@ -841,12 +849,17 @@ rdcarray<rdcstr> CaptureFile::GetResolve(const rdcarray<uint64_t> &callstack)
     return ret;
   }
 
-  ret.reserve(callstack.size());
-  for(uint64_t frame : callstack)
-  {
-    Callstack::AddressDetails info = m_Resolver->GetAddr(frame);
+  auto it = m_ResolveCache.find(callstack);
+  if(it != m_ResolveCache.end())
+    return it->second;
+
+  rdcarray<Callstack::AddressDetails> details = m_Resolver->GetAddrs(callstack);
+
+  ret.reserve(details.size());
+  for(Callstack::AddressDetails &info : details)
     ret.push_back(info.formattedString());
-  }
+
+  m_ResolveCache[callstack] = ret;
 
   return ret;
 }
@@ -143,6 +143,20 @@ void DummyDriver::SavePipelineState(uint32_t eventId)
 {
 }
 
+rdcarray<VKPipe::BindingElement> DummyDriver::GetVulkanDescriptors(bool compute, uint32_t set,
+                                                                   uint32_t binding,
+                                                                   uint32_t firstElement,
+                                                                   uint32_t count)
+{
+  return {};
+}
+
+rdcarray<uint32_t> DummyDriver::GetVulkanUsedDescriptors(bool compute, uint32_t set,
+                                                         uint32_t binding)
+{
+  return {};
+}
+
 FrameRecord DummyDriver::GetFrameRecord()
 {
   return m_FrameRecord;
@@ -175,6 +189,11 @@ void DummyDriver::InitPostVSBuffers(const rdcarray<uint32_t> &passEvents)
 {
 }
 
+PostVSCacheStatistics DummyDriver::GetPostVSCacheStatistics()
+{
+  return {};
+}
+
 ResourceId DummyDriver::GetLiveID(ResourceId id)
 {
   return id;
@@ -197,6 +216,16 @@ void DummyDriver::GetTextureData(ResourceId tex, const Subresource &sub,
   data.clear();
 }
 
+void DummyDriver::GetTextureDataBatch(const rdcarray<TextureReadback> &readbacks,
+                                      TextureReadbackCallback callback)
+{
+  for(size_t i = 0; i < readbacks.size(); i++)
+  {
+    bytebuf data;
+    callback(i, data);
+  }
+}
+
 void DummyDriver::BuildTargetShader(ShaderEncoding sourceEncoding, const bytebuf &source,
                                     const rdcstr &entry, const ShaderCompileFlags &compileFlags,
                                     ShaderStage type, ResourceId &id, rdcstr &errors)
@@ -251,6 +280,14 @@ rdcarray<PixelModification> DummyDriver::PixelHistory(rdcarray<EventUsage> event
   return {};
 }
 
+PixelRegionHistory DummyDriver::PixelHistoryRegion(rdcarray<EventUsage> events, ResourceId target,
+                                                   uint32_t x, uint32_t y, uint32_t width,
+                                                   uint32_t height, const Subresource &sub,
+                                                   CompType typeCast)
+{
+  return {};
+}
+
 ShaderDebugTrace *DummyDriver::DebugVertex(uint32_t eventId, uint32_t vertid, uint32_t instid,
                                            uint32_t idx, uint32_t view)
 {
@@ -263,6 +300,16 @@ ShaderDebugTrace *DummyDriver::DebugPixel(uint32_t eventId, uint32_t x, uint32_t
   return new ShaderDebugTrace;
 }
 
+rdcarray<ShaderDebugTrace *> DummyDriver::DebugPixels(
+    uint32_t eventId, const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels, uint32_t sample,
+    uint32_t primitive)
+{
+  rdcarray<ShaderDebugTrace *> ret;
+  for(size_t i = 0; i < pixels.size(); i++)
+    ret.push_back(new ShaderDebugTrace);
+  return ret;
+}
+
 ShaderDebugTrace *DummyDriver::DebugThread(uint32_t eventId,
                                            const rdcfixedarray<uint32_t, 3> &groupid,
                                            const rdcfixedarray<uint32_t, 3> &threadid)
@@ -431,6 +478,13 @@ void DummyDriver::PickPixel(ResourceId texture, uint32_t x, uint32_t y, const Su
 {
 }
 
+bool DummyDriver::PickPixelTile(ResourceId texture, uint32_t x, uint32_t y, uint32_t width,
+                                uint32_t height, const Subresource &sub, CompType typeCast,
+                                rdcarray<float> &pixels)
+{
+  return false;
+}
+
 ResourceId DummyDriver::CreateProxyTexture(const TextureDescription &templateTex)
 {
   return ResourceId();
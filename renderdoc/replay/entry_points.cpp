@@ -30,6 +30,7 @@
 #include "common/formatting.h"
 #include "common/threading.h"
 #include "core/core.h"
+#include "core/settings.h"
 #include "maths/camera.h"
 #include "maths/formatpacking.h"
 #include "miniz/miniz.h"
@@ -996,12 +997,147 @@ extern "C" RENDERDOC_API int RENDERDOC_CC RENDERDOC_RunFunctionalTests(int pytho
   return mainFunc((int)wideArgStrings.size(), wideArgStrings.data());
 }
 
+RDOC_CONFIG(bool, Replay_ProfileTrace, false,
+            "Record profile regions in memory as they happen, so that they can be saved as a "
+            "Chrome trace with SaveProfileTrace.");
+
+namespace
+{
+struct ProfileEvent
+{
+  rdcstr name;
+  uint64_t tick;
+  bool begin;
+};
+
+// each thread records into its own fixed-size ring so that recording never contends with other
+// threads and memory use is bounded. Only the oldest events are lost when a ring wraps. The lock is
+// only ever contended while a trace is being saved.
+struct ProfileThreadEvents
+{
+  static const size_t MaxEvents = 256 * 1024;
+
+  uint64_t threadID = 0;
+  Threading::CriticalSection lock;
+  rdcarray<ProfileEvent> events;
+  size_t next = 0;
+};
+
+Threading::CriticalSection profileThreadsLock;
+rdcarray<ProfileThreadEvents *> profileThreads;
+
+void RecordProfileEvent(const rdcstr *name)
+{
+  static uint64_t slot = Threading::AllocateTLSSlot();
+
+  ProfileThreadEvents *thread = (ProfileThreadEvents *)Threading::GetTLSValue(slot);
+  if(!thread)
+  {
+    thread = new ProfileThreadEvents;
+    thread->threadID = Threading::GetCurrentID();
+    Threading::SetTLSValue(slot, thread);
+
+    SCOPED_LOCK(profileThreadsLock);
+    profileThreads.push_back(thread);
+  }
+
+  SCOPED_LOCK(thread->lock);
+
+  if(thread->events.size() < ProfileThreadEvents::MaxEvents)
+    thread->events.push_back({});
+
+  ProfileEvent &ev = thread->events[thread->next];
+  thread->next = (thread->next + 1) % ProfileThreadEvents::MaxEvents;
+
+  ev.name = name ? *name : rdcstr();
+  ev.tick = Timing::GetTick();
+  ev.begin = name != NULL;
+}
+};
+
 extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_BeginProfileRegion(const rdcstr &name)
 {
   Superluminal::BeginProfileRange(name);
+
+  if(Replay_ProfileTrace())
+    RecordProfileEvent(&name);
 }
 
 extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_EndProfileRegion()
 {
   Superluminal::EndProfileRange();
+
+  if(Replay_ProfileTrace())
+    RecordProfileEvent(NULL);
+}
+
+extern "C" RENDERDOC_API bool RENDERDOC_CC RENDERDOC_SaveProfileTrace(const rdcstr &filename)
+{
+  FILE *f = FileIO::fopen(filename, FileIO::WriteText);
+
+  if(!f)
+  {
+    RDCERR("Failed to open '%s' for write: %s", filename.c_str(), FileIO::ErrorString().c_str());
+    return false;
+  }
+
+  const double ticksPerMicro = Timing::GetTickFrequency() / 1000.0;
+
+  rdcstr str = R"({
+  "displayTimeUnit": "ns",
+  "traceEvents": [)";
+
+  bool first = true;
+
+  SCOPED_LOCK(profileThreadsLock);
+
+  for(ProfileThreadEvents *thread : profileThreads)
+  {
+    SCOPED_LOCK(thread->lock);
+
+    // if the ring has wrapped the oldest event is the next one to be overwritten
+    size_t start = thread->events.size() < ProfileThreadEvents::MaxEvents ? 0 : thread->next;
+
+    for(size_t i = 0; i < thread->events.size(); i++)
+    {
+      const ProfileEvent &ev = thread->events[(start + i) % thread->events.size()];
+
+      if(!first)
+        str += ",";
+
+      first = false;
+
+      uint64_t ts = uint64_t(double(ev.tick) / ticksPerMicro);
+
+      if(ev.begin)
+      {
+        rdcstr name = ev.name;
+        for(size_t c = 0; c < name.size(); c++)
+        {
+          if(name[c] == '"' || name[c] == '\\')
+            name.insert(c++, '\\');
+        }
+
+        str += StringFormat::Fmt(R"(
+    { "name": "%s", "ph": "B", "ts": %llu, "pid": 1, "tid": %llu })",
+                                 name.c_str(), ts, thread->threadID);
+      }
+      else
+      {
+        str += StringFormat::Fmt(R"(
+    { "ph": "E", "ts": %llu, "pid": 1, "tid": %llu })",
+                                 ts, thread->threadID);
+      }
+    }
+  }
+
+  str += R"(
+  ]
+})";
+
+  bool success = FileIO::fwrite(str.data(), 1, str.size(), f) == str.size();
+
+  FileIO::fclose(f);
+
+  return success;
 }
@@ -234,6 +234,18 @@ void DoSerialise(SerialiserType &ser, ShaderEntryPoint &el)
   SIZE_CHECK(32);
 }
 
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, ShaderSearchResult &el)
+{
+  SERIALISE_MEMBER(shader);
+  SERIALISE_MEMBER(entryPoint);
+  SERIALISE_MEMBER(location);
+  SERIALISE_MEMBER(lineNumber);
+  SERIALISE_MEMBER(lineText);
+
+  SIZE_CHECK(96);
+}
+
 template <typename SerialiserType>
 void DoSerialise(SerialiserType &ser, ShaderCompileFlag &el)
 {
@@ -808,6 +820,19 @@ void DoSerialise(SerialiserType &ser, MeshFormat &el)
   SIZE_CHECK(152);
 }
 
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, PostVSCacheStatistics &el)
+{
+  SERIALISE_MEMBER(hits);
+  SERIALISE_MEMBER(misses);
+  SERIALISE_MEMBER(evictions);
+  SERIALISE_MEMBER(bytesUsed);
+  SERIALISE_MEMBER(budget);
+  SERIALISE_MEMBER(entries);
+
+  SIZE_CHECK(48);
+}
+
 template <typename SerialiserType>
 void DoSerialise(SerialiserType &ser, Offset &el)
 {
@@ -908,6 +933,21 @@ void DoSerialise(SerialiserType &ser, PixelModification &el)
   SIZE_CHECK(100);
 }
 
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, PixelRegionHistory &el)
+{
+  SERIALISE_MEMBER(x);
+  SERIALISE_MEMBER(y);
+  SERIALISE_MEMBER(width);
+  SERIALISE_MEMBER(height);
+
+  SERIALISE_MEMBER(pixelOffsets);
+  SERIALISE_MEMBER(eventIds);
+  SERIALISE_MEMBER(fragments);
+
+  SIZE_CHECK(88);
+}
+
 template <typename SerialiserType>
 void DoSerialise(SerialiserType &ser, EventUsage &el)
 {
@@ -2378,6 +2418,7 @@ INSTANTIATE_SERIALISE_TYPE(ShaderSampler)
 INSTANTIATE_SERIALISE_TYPE(ShaderMessage);
 INSTANTIATE_SERIALISE_TYPE(ShaderResource)
 INSTANTIATE_SERIALISE_TYPE(ShaderEntryPoint)
+INSTANTIATE_SERIALISE_TYPE(ShaderSearchResult)
 INSTANTIATE_SERIALISE_TYPE(ShaderCompileFlags)
 INSTANTIATE_SERIALISE_TYPE(ShaderDebugInfo)
 INSTANTIATE_SERIALISE_TYPE(ShaderReflection)
@@ -2411,6 +2452,7 @@ INSTANTIATE_SERIALISE_TYPE(FrameStatistics)
 INSTANTIATE_SERIALISE_TYPE(FrameDescription)
 INSTANTIATE_SERIALISE_TYPE(FrameRecord)
 INSTANTIATE_SERIALISE_TYPE(MeshFormat)
+INSTANTIATE_SERIALISE_TYPE(PostVSCacheStatistics)
 INSTANTIATE_SERIALISE_TYPE(FloatVector)
 INSTANTIATE_SERIALISE_TYPE(Offset);
 INSTANTIATE_SERIALISE_TYPE(Uuid)
@@ -2418,6 +2460,7 @@ INSTANTIATE_SERIALISE_TYPE(CounterDescription)
 INSTANTIATE_SERIALISE_TYPE(PixelValue)
 INSTANTIATE_SERIALISE_TYPE(Subresource)
 INSTANTIATE_SERIALISE_TYPE(PixelModification)
+INSTANTIATE_SERIALISE_TYPE(PixelRegionHistory)
 INSTANTIATE_SERIALISE_TYPE(EventUsage)
 INSTANTIATE_SERIALISE_TYPE(CounterResult)
 INSTANTIATE_SERIALISE_TYPE(CounterValue)
@@ -27,6 +27,7 @@
 #include <string.h>
 #include <time.h>
 #include "common/dds_readwrite.h"
+#include "common/threading.h"
 #include "driver/ihv/amd/amd_isa.h"
 #include "driver/ihv/amd/amd_rgp.h"
 #include "jpeg-compressor/jpgd.h"
@@ -75,6 +76,15 @@ void ReplayController::SetFrameEvent(uint32_t eventId, bool force)
   {
     m_EventID = eventId;
 
+    // a forced refresh means something like a resource replacement has changed what the replay
+    // produces, so cached texture statistics can't be trusted any more
+    if(force)
+    {
+      m_MinMaxCache.clear();
+      m_HistogramCache.clear();
+      m_PickTileCache.clear();
+    }
+
     m_pDevice->ReplayLog(eventId, eReplay_WithoutDraw);
     FatalErrorCheck();
 
@@ -88,6 +98,54 @@ void ReplayController::SetFrameEvent(uint32_t eventId, bool force)
   }
 }
 
+void ReplayController::VisitEvents(const rdcarray<uint32_t> &eventIds,
+                                   RENDERDOC_EventCallback callback)
+{
+  CHECK_REPLAY_THREAD();
+  RENDERDOC_PROFILEFUNCTION();
+
+  rdcarray<uint32_t> events;
+  events.reserve(eventIds.size());
+
+  for(uint32_t eventId : eventIds)
+  {
+    // use remapped event if there's a match
+    auto it = m_EventRemap.find(eventId);
+    if(it != m_EventRemap.end())
+      eventId = it->second;
+
+    events.push_back(eventId);
+  }
+
+  std::sort(events.begin(), events.end());
+  events.resize(std::unique(events.begin(), events.end()) - events.begin());
+
+  if(events.empty())
+    return;
+
+  // replay the same way as SetFrameEvent, but don't update the outputs for every event. Refreshing
+  // an overlay is an extra replay of its own, and would prevent the driver from continuing on from
+  // the previous event for the next one.
+  for(uint32_t eventId : events)
+  {
+    m_EventID = eventId;
+
+    m_pDevice->ReplayLog(eventId, eReplay_WithoutDraw);
+    FatalErrorCheck();
+
+    m_pDevice->ReplayLog(eventId, eReplay_OnlyDraw);
+    FatalErrorCheck();
+
+    FetchPipelineState(eventId);
+
+    if(callback)
+      callback(eventId);
+  }
+
+  for(size_t i = 0; i < m_Outputs.size(); i++)
+    m_Outputs[i]->SetFrameEvent(m_EventID);
+}
+
 const D3D11Pipe::State *ReplayController::GetD3D11PipelineState()
 {
   CHECK_REPLAY_THREAD();
@@ -123,6 +181,32 @@ const PipeState &ReplayController::GetPipelineState()
   return m_PipeState;
 }
 
+rdcarray<VKPipe::BindingElement> ReplayController::GetVulkanDescriptors(bool compute, uint32_t set,
+                                                                        uint32_t binding,
+                                                                        uint32_t firstElement,
+                                                                        uint32_t count)
+{
+  CHECK_REPLAY_THREAD();
+  RENDERDOC_PROFILEFUNCTION();
+
+  if(m_APIProps.pipelineType != GraphicsAPI::Vulkan || count == 0)
+    return {};
+
+  return m_pDevice->GetVulkanDescriptors(compute, set, binding, firstElement, count);
+}
+
+rdcarray<uint32_t> ReplayController::GetVulkanUsedDescriptors(bool compute, uint32_t set,
+                                                              uint32_t binding)
+{
+  CHECK_REPLAY_THREAD();
+  RENDERDOC_PROFILEFUNCTION();
+
+  if(m_APIProps.pipelineType != GraphicsAPI::Vulkan)
+    return {};
+
+  return m_pDevice->GetVulkanUsedDescriptors(compute, set, binding);
+}
+
 rdcarray<rdcstr> ReplayController::GetDisassemblyTargets(bool withPipeline)
 {
   CHECK_REPLAY_THREAD();
@@ -294,7 +378,11 @@ void ReplayController::AddFakeMarkers()
   uint32_t newEventId = actions.back().events.back().eventId + 1;
   uint32_t newActionId = actions.back().actionId + 1;
 
+  // actions are moved rather than copied into the new list, as each one owns its events and
+  // children and on large captures copying them all can take a good part of the load time.
+  // Everything needed from an action is read before it's moved out.
   rdcarray<ActionDescription> ret;
+  ret.reserve(actions.size());
 
   int depthpassID = 1;
   int copypassID = 1;
@@ -326,7 +414,7 @@ void ReplayController::AddFakeMarkers()
     if(end - start < 2 || !actions[i].children.empty() || !actions[refaction].children.empty())
     {
       for(int j = start; j <= end; j++)
-        ret.push_back(actions[j]);
+        ret.push_back(std::move(actions[j]));
 
       start = i;
       refaction = i;
@@ -380,7 +468,7 @@ void ReplayController::AddFakeMarkers()
     mark.children.resize(end - start + 1);
 
     for(int j = start; j <= end; j++)
-      mark.children[j - start] = actions[j];
+      mark.children[j - start] = std::move(actions[j]);
 
     APIEvent ev;
     ev.eventId = mark.eventId;
@@ -392,7 +480,7 @@ void ReplayController::AddFakeMarkers()
     // first event. This is effectively what would be the case if there was a real marker here.
     m_EventRemap[mark.eventId] = mark.children[0].events[0].eventId - 1;
 
-    ret.push_back(mark);
+    ret.push_back(std::move(mark));
 
     start = i;
     refaction = i;
@@ -401,10 +489,10 @@ void ReplayController::AddFakeMarkers()
   if(start < actions.count())
   {
     for(int j = start; j < actions.count(); j++)
-      ret.push_back(actions[j]);
+      ret.push_back(std::move(actions[j]));
   }
 
-  m_FrameRecord.actionList = ret;
+  m_FrameRecord.actionList.swap(ret);
 
   // re-configure the previous/next pointeres
   m_Actions.clear();
@@ -479,6 +567,152 @@ const ShaderReflection *ReplayController::GetShader(ResourceId pipeline, Resourc
   return m_pDevice->GetShader(m_pDevice->GetLiveID(pipeline), m_pDevice->GetLiveID(shader), entry);
 }
 
+static void AddConstantNames(rdcstr &names, const rdcarray<ShaderConstant> &constants)
+{
+  for(const ShaderConstant &c : constants)
+  {
+    names += c.name + "\n";
+    if(!c.type.name.empty())
+      names += c.type.name + "\n";
+    AddConstantNames(names, c.type.members);
+  }
+}
+
+void ReplayController::GatherShaderSearchText()
+{
+  RENDERDOC_PROFILEFUNCTION();
+
+  m_ShaderSearchTextReady = true;
+
+  for(const ResourceDescription &res : m_Resources)
+  {
+    if(res.type != ResourceType::Shader)
+      continue;
+
+    ResourceId live = m_pDevice->GetLiveID(res.resourceId);
+
+    for(const ShaderEntryPoint &entry : m_pDevice->GetShaderEntryPoints(live))
+    {
+      const ShaderReflection *refl = m_pDevice->GetShader(ResourceId(), live, entry);
+      if(!refl)
+        continue;
+
+      ShaderSearchText search;
+      search.shader = res.resourceId;
+      search.entry = entry;
+
+      for(const ShaderSourceFile &f : refl->debugInfo.files)
+        search.sections.push_back({f.filename, f.contents});
+
+      search.sections.push_back(
+          {"Disassembly", m_pDevice->DisassembleShader(ResourceId(), refl, "")});
+
+      // one name per line, so they can be matched the same way as the text
+      rdcstr names = refl->entryPoint + "\n";
+      for(const SigParameter &sig : refl->inputSignature)
+        names += sig.varName + "\n" + sig.semanticIdxName + "\n";
+      for(const SigParameter &sig : refl->outputSignature)
+        names += sig.varName + "\n" + sig.semanticIdxName + "\n";
+      for(const ConstantBlock &cb : refl->constantBlocks)
+      {
+        names += cb.name + "\n";
+        AddConstantNames(names, cb.variables);
+      }
+      for(const ShaderSampler &samp : refl->samplers)
+        names += samp.name + "\n";
+      for(const ShaderResource &r : refl->readOnlyResources)
+        names += r.name + "\n";
+      for(const ShaderResource &r : refl->readWriteResources)
+        names += r.name + "\n";
+      search.sections.push_back({"Reflection", names});
+
+      m_ShaderSearchText.push_back(search);
+    }
+  }
+
+  FatalErrorCheck();
+}
+
+rdcarray<ShaderSearchResult> ReplayController::SearchShaders(const rdcstr &text, bool caseSensitive)
+{
+  CHECK_REPLAY_THREAD();
+
+  RENDERDOC_PROFILEFUNCTION();
+
+  if(text.empty())
+    return {};
+
+  // shader reflection and disassembly don't change for a capture, so they're only fetched once
+  if(!m_ShaderSearchTextReady)
+    GatherShaderSearchText();
+
+  rdcstr needle = text;
+  if(!caseSensitive)
+    needle = strlower(needle);
+
+  // each shader is searched independently into its own results, which are concatenated in order
+  rdcarray<rdcarray<ShaderSearchResult>> shaderResults;
+  shaderResults.resize(m_ShaderSearchText.size());
+
+  {
+    Threading::WorkerPool pool(Threading::WorkerPool::DefaultThreadCount());
+
+    for(size_t i = 0; i < m_ShaderSearchText.size(); i++)
+    {
+      pool.AddJob([this, i, &needle, caseSensitive, &shaderResults]() {
+        const ShaderSearchText &search = m_ShaderSearchText[i];
+        rdcarray<ShaderSearchResult> &results = shaderResults[i];
+
+        for(const rdcpair<rdcstr, rdcstr> &section : search.sections)
+        {
+          rdcstr lowered;
+          const rdcstr &haystack =
+              caseSensitive ? section.second : (lowered = strlower(section.second));
+
+          uint32_t line = 1;
+          int32_t lineStart = 0;
+          int32_t found = haystack.find(needle);
+
+          while(found >= 0)
+          {
+            // count lines up to the match
+            for(int32_t c = lineStart; c < found; c++)
+            {
+              if(haystack[c] == '\n')
+              {
+                line++;
+                lineStart = c + 1;
+              }
+            }
+
+            int32_t lineEnd = haystack.find('\n', found);
+            if(lineEnd < 0)
+              lineEnd = haystack.count();
+
+            ShaderSearchResult res;
+            res.shader = search.shader;
+            res.entryPoint = search.entry;
+            res.location = section.first;
+            res.lineNumber = line;
+            res.lineText = section.second.substr(lineStart, lineEnd - lineStart).trimmed();
+            results.push_back(res);
+
+            // only report each line once
+            found = haystack.find(needle, lineEnd);
+          }
+        }
+      });
+    }
+
+    pool.WaitForIdle();
+  }
+
+  rdcarray<ShaderSearchResult> ret;
+  for(rdcarray<ShaderSearchResult> &results : shaderResults)
+    ret.append(results);
+  return ret;
+}
+
 rdcarray<EventUsage> ReplayController::GetUsage(ResourceId id)
 {
   CHECK_REPLAY_THREAD();
@@ -492,6 +726,7 @@ rdcarray<EventUsage> ReplayController::GetUsage(ResourceId id)
 MeshFormat ReplayController::GetPostVSData(uint32_t instID, uint32_t viewID, MeshDataStage stage)
 {
   CHECK_REPLAY_THREAD();
+  RENDERDOC_PROFILEFUNCTION();
 
   ActionDescription *action = GetActionByEID(m_EventID);
 
@@ -509,6 +744,16 @@ MeshFormat ReplayController::GetPostVSData(uint32_t instID, uint32_t viewID, Mes
   return ret;
 }
 
+PostVSCacheStatistics ReplayController::GetPostVSCacheStatistics()
+{
+  CHECK_REPLAY_THREAD();
+
+  PostVSCacheStatistics ret = m_pDevice->GetPostVSCacheStatistics();
+  FatalErrorCheck();
+
+  return ret;
+}
+
 bytebuf ReplayController::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len)
 {
   CHECK_REPLAY_THREAD();
@@ -553,12 +798,83 @@ bytebuf ReplayController::GetTextureData(ResourceId tex, const Subresource &sub)
   return ret;
 }
 
-ResultDetails ReplayController::SaveTexture(const TextureSave &saveData, const rdcstr &path)
+void ReplayController::GetTextureDataBatch(const rdcarray<ResourceId> &textures,
+                                           const rdcarray<Subresource> &subs,
+                                           RENDERDOC_TextureDataCallback callback)
 {
   CHECK_REPLAY_THREAD();
   RENDERDOC_PROFILEFUNCTION();
 
-  TextureSave sd = saveData;    // mutable copy
+  if(textures.size() != subs.size())
+  {
+    RDCERR("Mismatched texture and subresource lists (%zu vs %zu) getting texture data",
+           textures.size(), subs.size());
+    return;
+  }
+
+  rdcarray<TextureReadback> readbacks;
+  rdcarray<uint32_t> indices;
+
+  for(uint32_t i = 0; i < textures.size(); i++)
+  {
+    ResourceId liveId = m_pDevice->GetLiveID(textures[i]);
+
+    if(liveId == ResourceId())
+    {
+      RDCERR("Couldn't get Live ID for %s getting texture data", ToStr(textures[i]).c_str());
+      continue;
+    }
+
+    readbacks.push_back({liveId, subs[i], GetTextureDataParams()});
+    indices.push_back(i);
+  }
+
+  const bytebuf empty;
+  uint32_t next = 0;
+
+  m_pDevice->GetTextureDataBatch(readbacks, [&](size_t idx, bytebuf &data) {
+    // any textures we skipped above are reported in order with no data
+    for(; next < indices[idx]; next++)
+      callback(next, empty);
+
+    callback(next++, data);
+  });
+  FatalErrorCheck();
+
+  for(; next < textures.size(); next++)
+    callback(next, empty);
+}
+
+// a texture save is split into preparing the list of subresources to fetch and fetching them,
+// which needs the replay, then converting and writing out the data which can happen on any thread.
+struct TextureSaveJob
+{
+  TextureSave sd;
+  TextureDescription td;
+  rdcstr path;
+
+  uint32_t sliceOffset = 0;
+  uint32_t numSlices = 0;
+  uint32_t numMips = 0;
+  bool singleSlice = false;
+
+  uint32_t rowPitch = 0;
+  uint32_t slicePitch = 0;
+  bool blockformat = false;
+  int blockSize = 0;
+  uint32_t bytesPerPixel = 1;
+
+  // the subresources to fetch, with the mip of each relative to the first mip being saved, and the
+  // data once it's been fetched
+  rdcarray<TextureReadback> readbacks;
+  rdcarray<uint32_t> readbackMips;
+  rdcarray<bytebuf> data;
+};
+
+RDResult ReplayController::PrepareTextureSave(const TextureSave &saveData, TextureSaveJob &job)
+{
+  TextureSave &sd = job.sd;
+  sd = saveData;    // mutable copy
   ResourceId liveid = m_pDevice->GetLiveID(sd.resourceId);
 
   if(liveid == ResourceId())
@@ -568,7 +884,8 @@ ResultDetails ReplayController::SaveTexture(const TextureSave &saveData, const r
                         ToStr(sd.resourceId).c_str());
   }
 
-  TextureDescription td = m_pDevice->GetTexture(liveid);
+  TextureDescription &td = job.td;
+  td = m_pDevice->GetTexture(liveid);
 
   // clamp sample/mip/slice indices
   if(td.msSamp == 1)
@@ -719,8 +1036,6 @@ ResultDetails ReplayController::SaveTexture(const TextureSave &saveData, const r
     // otherwise take all mips, as by default
   }
 
-  rdcarray<byte *> subdata;
-
   bool downcast = false;
 
   // don't support slice mappings for DDS - it supports slices natively
@@ -843,7 +1158,7 @@ ResultDetails ReplayController::SaveTexture(const TextureSave &saveData, const r
     slicePitch = rowPitch * td.height;
   }
 
-  // loop over fetching subresources
+  // list the subresources to fetch
   for(uint32_t s = 0; s < numSlices; s++)
   {
     uint32_t slice = s * sliceStride + sliceOffset;
@@ -863,72 +1178,137 @@ ResultDetails ReplayController::SaveTexture(const TextureSave &saveData, const r
 
       Subresource sub = {mip, slice / sampleCount, slice % sampleCount};
 
-      bytebuf data;
-      m_pDevice->GetTextureData(liveid, sub, params, data);
-      FatalErrorCheck();
+      job.readbacks.push_back({liveid, sub, params});
+      job.readbackMips.push_back(m);
 
-      if(data.empty())
-      {
-        for(size_t i = 0; i < subdata.size(); i++)
-          delete[] subdata[i];
+      // a single readback of a 3D texture returns all of its depth slices, so skip past them
+      if(td.depth > 1 && numSlices != 1)
+        s += (RDCMAX(1U, td.depth >> m) - 1);
+    }
+  }
 
-        RETURN_ERROR_RESULT(ResultCode::DataNotAvailable,
-                            "Couldn't readback bytes for mip %u, slice %u, sample %u", sub.mip,
-                            sub.slice, sub.sample);
-      }
+  job.sliceOffset = sliceOffset;
+  job.numSlices = numSlices;
+  job.numMips = numMips;
+  job.singleSlice = singleSlice;
+  job.rowPitch = rowPitch;
+  job.slicePitch = slicePitch;
+  job.blockformat = blockformat;
+  job.blockSize = blockSize;
+  job.bytesPerPixel = bytesPerPixel;
 
-      if(td.depth == 1)
-      {
-        byte *bytes = new byte[data.size()];
-        memcpy(bytes, data.data(), data.size());
-        subdata.push_back(bytes);
-        continue;
-      }
+  return RDResult();
+}
+
+static RDResult EncodeTextureSave(TextureSaveJob &job)
+{
+  RENDERDOC_PROFILEFUNCTION();
 
-      uint32_t mipSlicePitch = slicePitch;
+  TextureSave &sd = job.sd;
+  TextureDescription &td = job.td;
+  const rdcstr &path = job.path;
 
-      uint32_t w = RDCMAX(1U, td.width >> m);
-      uint32_t h = RDCMAX(1U, td.height >> m);
+  const uint32_t sliceOffset = job.sliceOffset;
+  const uint32_t numSlices = job.numSlices;
+  const uint32_t numMips = job.numMips;
+  const bool singleSlice = job.singleSlice;
+  uint32_t rowPitch = job.rowPitch;
+  const uint32_t slicePitch = job.slicePitch;
+  const bool blockformat = job.blockformat;
+  const int blockSize = job.blockSize;
+  const uint32_t bytesPerPixel = job.bytesPerPixel;
+
+  rdcarray<byte *> subdata;
+
+  // DDS files store each 2D slice as-is, so unless slices are being combined into one image we can
+  // point straight into the fetched data instead of copying every slice out first.
+  const bool ownsSubdata =
+      sd.destType != FileType::DDS || sd.slice.slicesAsGrid || sd.slice.cubeCruciform;
+
+  // split the fetched subresources into one subdata per 2D slice
+  for(size_t r = 0; r < job.readbacks.size(); r++)
+  {
+    const Subresource &sub = job.readbacks[r].sub;
+    const uint32_t m = job.readbackMips[r];
+    bytebuf &data = job.data[r];
+
+    if(data.empty())
+    {
+      for(size_t i = 0; ownsSubdata && i < subdata.size(); i++)
+        delete[] subdata[i];
+
+      RETURN_ERROR_RESULT(ResultCode::DataNotAvailable,
+                          "Couldn't readback bytes for mip %u, slice %u, sample %u", sub.mip,
+                          sub.slice, sub.sample);
+    }
+
+    if(!ownsSubdata)
+    {
+      byte *b = data.data();
       uint32_t d = RDCMAX(1U, td.depth >> m);
+      uint32_t mipSlicePitch = (uint32_t)data.size() / d;
 
-      if(blockformat)
+      if(td.depth > 1 && numSlices == 1)
       {
-        mipSlicePitch = RDCMAX(1U, ((w + 3) / 4)) * blockSize * RDCMAX(1U, h / 4);
-      }
-      else
-      {
-        mipSlicePitch = w * bytesPerPixel * h;
+        subdata.push_back(b + mipSlicePitch * sliceOffset);
+        continue;
       }
 
-      // we don't support slice ranges, only all-or-nothing
-      // we're also not dealing with multisampled slices if
-      // depth > 1. So if we only want one slice out of a 3D texture
-      // then make sure we get it
-      if(numSlices == 1)
-      {
-        byte *depthslice = new byte[mipSlicePitch];
-        byte *b = data.data() + mipSlicePitch * sliceOffset;
-        memcpy(depthslice, b, slicePitch);
-        subdata.push_back(depthslice);
+      for(uint32_t di = 0; di < d; di++)
+        subdata.push_back(b + mipSlicePitch * di);
 
-        continue;
-      }
+      continue;
+    }
 
-      s += (d - 1);
+    if(td.depth == 1)
+    {
+      byte *bytes = new byte[data.size()];
+      memcpy(bytes, data.data(), data.size());
+      subdata.push_back(bytes);
+      continue;
+    }
 
-      byte *b = data.data();
+    uint32_t mipSlicePitch = slicePitch;
 
-      // add each depth slice as a separate subdata
-      for(uint32_t di = 0; di < d; di++)
-      {
-        byte *depthslice = new byte[mipSlicePitch];
+    uint32_t w = RDCMAX(1U, td.width >> m);
+    uint32_t h = RDCMAX(1U, td.height >> m);
+    uint32_t d = RDCMAX(1U, td.depth >> m);
 
-        memcpy(depthslice, b, mipSlicePitch);
+    if(blockformat)
+    {
+      mipSlicePitch = RDCMAX(1U, ((w + 3) / 4)) * blockSize * RDCMAX(1U, h / 4);
+    }
+    else
+    {
+      mipSlicePitch = w * bytesPerPixel * h;
+    }
 
-        subdata.push_back(depthslice);
+    // we don't support slice ranges, only all-or-nothing
+    // we're also not dealing with multisampled slices if
+    // depth > 1. So if we only want one slice out of a 3D texture
+    // then make sure we get it
+    if(numSlices == 1)
+    {
+      byte *depthslice = new byte[mipSlicePitch];
+      byte *b = data.data() + mipSlicePitch * sliceOffset;
+      memcpy(depthslice, b, slicePitch);
+      subdata.push_back(depthslice);
 
-        b += mipSlicePitch;
-      }
+      continue;
+    }
+
+    byte *b = data.data();
+
+    // add each depth slice as a separate subdata
+    for(uint32_t di = 0; di < d; di++)
+    {
+      byte *depthslice = new byte[mipSlicePitch];
+
+      memcpy(depthslice, b, mipSlicePitch);
+
+      subdata.push_back(depthslice);
+
+      b += mipSlicePitch;
     }
   }
 
@@ -1280,12 +1660,17 @@ ResultDetails ReplayController::SaveTexture(const TextureSave &saveData, const r
       if(saveFmt.compType == CompType::Depth && pixStride == 3)
         pixStride = 4;
 
+      rdcarray<FloatVector> row;
+      row.resize(td.width);
+
       for(uint32_t y = 0; y < td.height; y++)
       {
+        DecodeFormattedComponents(saveFmt, srcData, pixStride, td.width, row.data());
+        srcData += pixStride * td.width;
+
         for(uint32_t x = 0; x < td.width; x++)
         {
-          FloatVector pixel = DecodeFormattedComponents(saveFmt, srcData);
-          srcData += pixStride;
+          FloatVector pixel = row[x];
 
           // HDR can't represent negative values
           if(sd.destType == FileType::HDR)
@@ -1406,22 +1791,105 @@ ResultDetails ReplayController::SaveTexture(const TextureSave &saveData, const r
     FileIO::fclose(f);
   }
 
-  for(size_t i = 0; i < subdata.size(); i++)
+  for(size_t i = 0; ownsSubdata && i < subdata.size(); i++)
     delete[] subdata[i];
 
   return res;
 }
 
-rdcarray<PixelModification> ReplayController::PixelHistory(ResourceId target, uint32_t x, uint32_t y,
-                                                           const Subresource &sub, CompType typeCast)
+
+ResultDetails ReplayController::SaveTexture(const TextureSave &saveData, const rdcstr &path)
 {
   CHECK_REPLAY_THREAD();
+  RENDERDOC_PROFILEFUNCTION();
+
+  TextureSaveJob job;
+  job.path = path;
+
+  RDResult res = PrepareTextureSave(saveData, job);
+  if(res != ResultCode::Succeeded)
+    return res;
+
+  job.data.resize(job.readbacks.size());
+  m_pDevice->GetTextureDataBatch(
+      job.readbacks, [&job](size_t idx, bytebuf &data) { job.data[idx].swap(data); });
+  FatalErrorCheck();
+
+  return EncodeTextureSave(job);
+}
 
+ResultDetails ReplayController::SaveTextures(const rdcarray<TextureSave> &saveData,
+                                             const rdcarray<rdcstr> &paths)
+{
+  CHECK_REPLAY_THREAD();
   RENDERDOC_PROFILEFUNCTION();
 
-  rdcarray<PixelModification> ret;
+  if(saveData.size() != paths.size())
+  {
+    RETURN_ERROR_RESULT(ResultCode::InvalidParameter,
+                        "Mismatched texture and path lists (%zu vs %zu) saving textures",
+                        saveData.size(), paths.size());
+  }
 
-  Subresource subresource = sub;
+  rdcarray<TextureSaveJob> jobs;
+  rdcarray<RDResult> results;
+  jobs.resize(saveData.size());
+  results.resize(saveData.size());
+
+  // fetch every texture's subresources in one batch, remembering which job each belongs to
+  rdcarray<TextureReadback> readbacks;
+  rdcarray<rdcpair<size_t, size_t>> readbackJobs;
+
+  for(size_t i = 0; i < saveData.size(); i++)
+  {
+    jobs[i].path = paths[i];
+    results[i] = PrepareTextureSave(saveData[i], jobs[i]);
+
+    if(results[i] != ResultCode::Succeeded)
+      continue;
+
+    jobs[i].data.resize(jobs[i].readbacks.size());
+
+    for(size_t r = 0; r < jobs[i].readbacks.size(); r++)
+    {
+      readbacks.push_back(jobs[i].readbacks[r]);
+      readbackJobs.push_back({i, r});
+    }
+  }
+
+  Threading::WorkerPool pool(Threading::WorkerPool::DefaultThreadCount());
+
+  m_pDevice->GetTextureDataBatch(readbacks, [&](size_t idx, bytebuf &data) {
+    const size_t j = readbackJobs[idx].first;
+    const size_t r = readbackJobs[idx].second;
+
+    jobs[j].data[r].swap(data);
+
+    // once a texture's last subresource has arrived, encode it while the rest are still fetched
+    if(r + 1 == jobs[j].readbacks.size())
+    {
+      pool.AddJob([&jobs, &results, j]() {
+        results[j] = EncodeTextureSave(jobs[j]);
+        jobs[j].data.clear();
+      });
+    }
+  });
+  FatalErrorCheck();
+
+  pool.WaitForIdle();
+
+  for(size_t i = 0; i < results.size(); i++)
+    if(results[i] != ResultCode::Succeeded)
+      return results[i];
+
+  return RDResult();
+}
+
+rdcarray<EventUsage> ReplayController::GetPixelHistoryEvents(ResourceId target, uint32_t x,
+                                                            uint32_t y, uint32_t &width,
+                                                            uint32_t &height, Subresource &subresource)
+{
+  rdcarray<EventUsage> events;
 
   for(size_t t = 0; t < m_Textures.size(); t++)
   {
@@ -1431,9 +1899,12 @@ rdcarray<PixelModification> ReplayController::PixelHistory(ResourceId target, ui
       {
         RDCDEBUG("PixelHistory out of bounds on %s (%u,%u) vs (%u,%u)", ToStr(target).c_str(), x, y,
                  m_Textures[t].width, m_Textures[t].height);
-        return ret;
+        return events;
       }
 
+      width = RDCMIN(width, m_Textures[t].width - x);
+      height = RDCMIN(height, m_Textures[t].height - y);
+
       if(m_Textures[t].msSamp == 1)
         subresource.sample = ~0U;
 
@@ -1455,12 +1926,10 @@ rdcarray<PixelModification> ReplayController::PixelHistory(ResourceId target, ui
   ResourceId id = m_pDevice->GetLiveID(target);
 
   if(id == ResourceId())
-    return ret;
+    return events;
 
   rdcarray<EventUsage> usage = m_pDevice->GetUsage(id);
 
-  rdcarray<EventUsage> events;
-
   for(size_t i = 0; i < usage.size(); i++)
   {
     if(usage[i].eventId > m_EventID)
@@ -1525,12 +1994,29 @@ rdcarray<PixelModification> ReplayController::PixelHistory(ResourceId target, ui
   }
 
   if(events.empty())
-  {
     RDCDEBUG("Target %s not written to before %u", ToStr(target).c_str(), m_EventID);
+
+  return events;
+}
+
+rdcarray<PixelModification> ReplayController::PixelHistory(ResourceId target, uint32_t x, uint32_t y,
+                                                           const Subresource &sub, CompType typeCast)
+{
+  CHECK_REPLAY_THREAD();
+
+  RENDERDOC_PROFILEFUNCTION();
+
+  rdcarray<PixelModification> ret;
+
+  Subresource subresource = sub;
+  uint32_t width = 1, height = 1;
+
+  rdcarray<EventUsage> events = GetPixelHistoryEvents(target, x, y, width, height, subresource);
+
+  if(events.empty())
     return ret;
-  }
 
-  id = m_pDevice->GetLiveID(target);
+  ResourceId id = m_pDevice->GetLiveID(target);
 
   if(id == ResourceId())
     return ret;
@@ -1543,6 +2029,41 @@ rdcarray<PixelModification> ReplayController::PixelHistory(ResourceId target, ui
   return ret;
 }
 
+PixelRegionHistory ReplayController::PixelHistoryRegion(ResourceId target, uint32_t x, uint32_t y,
+                                                        uint32_t width, uint32_t height,
+                                                        const Subresource &sub, CompType typeCast)
+{
+  CHECK_REPLAY_THREAD();
+
+  RENDERDOC_PROFILEFUNCTION();
+
+  PixelRegionHistory ret;
+
+  Subresource subresource = sub;
+
+  rdcarray<EventUsage> events = GetPixelHistoryEvents(target, x, y, width, height, subresource);
+
+  ResourceId id = m_pDevice->GetLiveID(target);
+
+  if(events.empty() || id == ResourceId() || width == 0 || height == 0)
+  {
+    // nothing modified the region, every pixel has an empty list
+    ret.x = x;
+    ret.y = y;
+    ret.width = width;
+    ret.height = height;
+    ret.pixelOffsets.fill(width * height + 1, 0);
+    return ret;
+  }
+
+  ret = m_pDevice->PixelHistoryRegion(events, id, x, y, width, height, subresource, typeCast);
+  FatalErrorCheck();
+
+  SetFrameEvent(m_EventID, true);
+
+  return ret;
+}
+
 PixelValue ReplayController::PickPixel(ResourceId tex, uint32_t x, uint32_t y,
                                        const Subresource &sub, CompType typeCast)
 {
@@ -1556,16 +2077,173 @@ PixelValue ReplayController::PickPixel(ResourceId tex, uint32_t x, uint32_t y,
   if(tex == ResourceId())
     return ret;
 
-  m_pDevice->PickPixel(m_pDevice->GetLiveID(tex), x, y, sub, typeCast, ret.floatValue.data());
+  ResourceId liveId = m_pDevice->GetLiveID(tex);
+
+  const TextureDescription *desc = NULL;
+  for(const TextureDescription &t : m_Textures)
+  {
+    if(t.resourceId == tex)
+    {
+      desc = &t;
+      break;
+    }
+  }
+
+  PickTileKey key = {{tex, sub, typeCast, desc ? GetTextureContentsEvent(tex) : ~0U},
+                     x & ~(PickTileSize - 1),
+                     y & ~(PickTileSize - 1)};
+
+  const uint32_t mipWidth = desc ? RDCMAX(1U, desc->width >> sub.mip) : 0;
+  const uint32_t mipHeight = desc ? RDCMAX(1U, desc->height >> sub.mip) : 0;
+
+  // only textures from the capture have contents we can track, anything else is always picked
+  if(key.tex.contentsEvent != ~0U && x < mipWidth && y < mipHeight)
+  {
+    auto it = m_PickTileCache.find(key);
+    if(it == m_PickTileCache.end())
+    {
+      PickTile tile;
+      tile.width = RDCMIN(uint32_t(PickTileSize), mipWidth - key.x);
+      uint32_t height = RDCMIN(uint32_t(PickTileSize), mipHeight - key.y);
+
+      bool picked = m_pDevice->PickPixelTile(liveId, key.x, key.y, tile.width, height, sub,
+                                             typeCast, tile.pixels);
+      FatalErrorCheck();
+
+      if(picked && tile.pixels.size() == tile.width * height * 4)
+      {
+        // each tile is 64kB, keep enough for hovering around a few areas of interest
+        if(m_PickTileCache.size() >= 64)
+          m_PickTileCache.clear();
+        it = m_PickTileCache.insert(std::make_pair(key, tile)).first;
+      }
+    }
+
+    if(it != m_PickTileCache.end())
+    {
+      const float *pixel = &it->second.pixels[((y - key.y) * it->second.width + (x - key.x)) * 4];
+      memcpy(ret.floatValue.data(), pixel, sizeof(float) * 4);
+      return ret;
+    }
+  }
+
+  m_pDevice->PickPixel(liveId, x, y, sub, typeCast, ret.floatValue.data());
   FatalErrorCheck();
 
   return ret;
 }
 
+bool ReplayController::PickTileKey::operator<(const PickTileKey &o) const
+{
+  if(tex < o.tex)
+    return true;
+  if(o.tex < tex)
+    return false;
+  if(y != o.y)
+    return y < o.y;
+  return x < o.x;
+}
+
+bool ReplayController::TextureStatsKey::operator<(const TextureStatsKey &o) const
+{
+  if(id != o.id)
+    return id < o.id;
+  if(sub != o.sub)
+    return sub < o.sub;
+  if(typeCast != o.typeCast)
+    return typeCast < o.typeCast;
+  if(contentsEvent != o.contentsEvent)
+    return contentsEvent < o.contentsEvent;
+  if(rangeMin != o.rangeMin)
+    return rangeMin < o.rangeMin;
+  if(rangeMax != o.rangeMax)
+    return rangeMax < o.rangeMax;
+  return channelMask < o.channelMask;
+}
+
+static bool IsReadOnlyUsage(ResourceUsage usage)
+{
+  switch(usage)
+  {
+    case ResourceUsage::VertexBuffer:
+    case ResourceUsage::IndexBuffer:
+    case ResourceUsage::VS_Constants:
+    case ResourceUsage::HS_Constants:
+    case ResourceUsage::DS_Constants:
+    case ResourceUsage::GS_Constants:
+    case ResourceUsage::PS_Constants:
+    case ResourceUsage::CS_Constants:
+    case ResourceUsage::All_Constants:
+    case ResourceUsage::VS_Resource:
+    case ResourceUsage::HS_Resource:
+    case ResourceUsage::DS_Resource:
+    case ResourceUsage::GS_Resource:
+    case ResourceUsage::PS_Resource:
+    case ResourceUsage::CS_Resource:
+    case ResourceUsage::All_Resource:
+    case ResourceUsage::InputTarget:
+    case ResourceUsage::CopySrc:
+    case ResourceUsage::ResolveSrc:
+    case ResourceUsage::Indirect: return true;
+    // barriers can discard contents with layout transitions, so treat them like any other write
+    default: return false;
+  }
+}
+
+uint32_t ReplayController::GetTextureContentsEvent(ResourceId textureId)
+{
+  auto it = m_TextureWrites.find(textureId);
+  if(it == m_TextureWrites.end())
+  {
+    TextureWrites &writes = m_TextureWrites[textureId];
+
+    for(const TextureDescription &tex : m_Textures)
+    {
+      if(tex.resourceId == textureId)
+      {
+        writes.tracked = true;
+        break;
+      }
+    }
+
+    if(writes.tracked)
+    {
+      rdcarray<EventUsage> usage = m_pDevice->GetUsage(m_pDevice->GetLiveID(textureId));
+      FatalErrorCheck();
+
+      for(const EventUsage &u : usage)
+        if(!IsReadOnlyUsage(u.usage))
+          writes.events.push_back(u.eventId);
+
+      std::sort(writes.events.begin(), writes.events.end());
+    }
+
+    it = m_TextureWrites.find(textureId);
+  }
+
+  if(!it->second.tracked)
+    return ~0U;
+
+  // the last write at or before the current event, 0 if there is none
+  const rdcarray<uint32_t> &events = it->second.events;
+  auto write = std::upper_bound(events.begin(), events.end(), m_EventID);
+  return write == events.begin() ? 0 : *(write - 1);
+}
+
 rdcpair<PixelValue, PixelValue> ReplayController::GetMinMax(ResourceId textureId,
                                                             const Subresource &sub, CompType typeCast)
 {
   CHECK_REPLAY_THREAD();
+  RENDERDOC_PROFILEFUNCTION();
+
+  TextureStatsKey key = {textureId, sub, typeCast, GetTextureContentsEvent(textureId)};
+
+  if(key.contentsEvent != ~0U)
+  {
+    auto it = m_MinMaxCache.find(key);
+    if(it != m_MinMaxCache.end())
+      return it->second;
+  }
 
   PixelValue minval = {{0.0f, 0.0f, 0.0f, 0.0f}};
   PixelValue maxval = {{1.0f, 1.0f, 1.0f, 1.0f}};
@@ -1574,6 +2252,17 @@ rdcpair<PixelValue, PixelValue> ReplayController::GetMinMax(ResourceId textureId
                        &maxval.floatValue[0]);
   FatalErrorCheck();
 
+  if(m_FatalError != ResultCode::Succeeded)
+    return make_rdcpair(minval, maxval);
+
+  // the results are tiny, just bound the entry count against pathological use
+  if(key.contentsEvent != ~0U)
+  {
+    if(m_MinMaxCache.size() >= 4096)
+      m_MinMaxCache.clear();
+    m_MinMaxCache[key] = make_rdcpair(minval, maxval);
+  }
+
   return make_rdcpair(minval, maxval);
 }
 
@@ -1582,6 +2271,21 @@ rdcarray<uint32_t> ReplayController::GetHistogram(ResourceId textureId, const Su
                                                   const rdcfixedarray<bool, 4> &channels)
 {
   CHECK_REPLAY_THREAD();
+  RENDERDOC_PROFILEFUNCTION();
+
+  uint32_t channelMask = 0;
+  for(uint32_t c = 0; c < 4; c++)
+    channelMask |= channels[c] ? (1U << c) : 0U;
+
+  TextureStatsKey key = {textureId, sub, typeCast, GetTextureContentsEvent(textureId),
+                         minval, maxval, channelMask};
+
+  if(key.contentsEvent != ~0U)
+  {
+    auto it = m_HistogramCache.find(key);
+    if(it != m_HistogramCache.end())
+      return it->second;
+  }
 
   rdcarray<uint32_t> hist;
 
@@ -1589,6 +2293,16 @@ rdcarray<uint32_t> ReplayController::GetHistogram(ResourceId textureId, const Su
                           hist);
   FatalErrorCheck();
 
+  if(m_FatalError != ResultCode::Succeeded)
+    return hist;
+
+  if(key.contentsEvent != ~0U)
+  {
+    if(m_HistogramCache.size() >= 1024)
+      m_HistogramCache.clear();
+    m_HistogramCache[key] = hist;
+  }
+
   return hist;
 }
 
@@ -1628,6 +2342,25 @@ ShaderDebugTrace *ReplayController::DebugPixel(uint32_t x, uint32_t y, uint32_t
   return ret;
 }
 
+rdcarray<ShaderDebugTrace *> ReplayController::DebugPixels(
+    const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels, uint32_t sample, uint32_t primitive)
+{
+  CHECK_REPLAY_THREAD();
+
+  RENDERDOC_PROFILEFUNCTION();
+
+  rdcarray<ShaderDebugTrace *> ret = m_pDevice->DebugPixels(m_EventID, pixels, sample, primitive);
+  FatalErrorCheck();
+
+  SetFrameEvent(m_EventID, true);
+
+  for(ShaderDebugTrace *trace : ret)
+    if(trace->debugger)
+      m_Debuggers.push_back(trace->debugger);
+
+  return ret;
+}
+
 ShaderDebugTrace *ReplayController::DebugThread(const rdcfixedarray<uint32_t, 3> &groupid,
                                                 const rdcfixedarray<uint32_t, 3> &threadid)
 {
@@ -2187,6 +2920,11 @@ void ReplayController::FileChanged()
 {
   CHECK_REPLAY_THREAD();
 
+  // the contents of the file's textures may have changed under us
+  m_MinMaxCache.clear();
+  m_HistogramCache.clear();
+  m_PickTileCache.clear();
+
   m_pDevice->FileChanged();
 }
 
@@ -34,6 +34,7 @@
 #define CHECK_REPLAY_THREAD() RDCASSERT(Threading::GetCurrentID() == m_ThreadID);
 
 struct ReplayController;
+struct TextureSaveJob;
 
 struct ReplayOutput : public IReplayOutput
 {
@@ -144,12 +145,17 @@ public:
   void FileChanged();
 
   void SetFrameEvent(uint32_t eventId, bool force);
+  void VisitEvents(const rdcarray<uint32_t> &eventIds, RENDERDOC_EventCallback callback);
 
   const D3D11Pipe::State *GetD3D11PipelineState();
   const D3D12Pipe::State *GetD3D12PipelineState();
   const GLPipe::State *GetGLPipelineState();
   const VKPipe::State *GetVulkanPipelineState();
   const PipeState &GetPipelineState();
+  rdcarray<VKPipe::BindingElement> GetVulkanDescriptors(bool compute, uint32_t set,
+                                                        uint32_t binding, uint32_t firstElement,
+                                                        uint32_t count);
+  rdcarray<uint32_t> GetVulkanUsedDescriptors(bool compute, uint32_t set, uint32_t binding);
 
   rdcarray<rdcstr> GetDisassemblyTargets(bool withPipeline);
   rdcstr DisassembleShader(ResourceId pipeline, const ShaderReflection *refl, const rdcstr &target);
@@ -193,6 +199,7 @@ public:
   }
   rdcarray<ShaderEntryPoint> GetShaderEntryPoints(ResourceId shader);
   const ShaderReflection *GetShader(ResourceId pipeline, ResourceId shader, ShaderEntryPoint entry);
+  rdcarray<ShaderSearchResult> SearchShaders(const rdcstr &text, bool caseSensitive);
 
   PixelValue PickPixel(ResourceId textureId, uint32_t x, uint32_t y, const Subresource &sub,
                        CompType typeCast);
@@ -202,21 +209,29 @@ public:
                                   float minval, float maxval, const rdcfixedarray<bool, 4> &channels);
   rdcarray<PixelModification> PixelHistory(ResourceId target, uint32_t x, uint32_t y,
                                            const Subresource &sub, CompType typeCast);
+  PixelRegionHistory PixelHistoryRegion(ResourceId target, uint32_t x, uint32_t y, uint32_t width,
+                                        uint32_t height, const Subresource &sub, CompType typeCast);
   ShaderDebugTrace *DebugVertex(uint32_t vertid, uint32_t instid, uint32_t idx, uint32_t view);
   ShaderDebugTrace *DebugPixel(uint32_t x, uint32_t y, uint32_t sample, uint32_t primitive);
+  rdcarray<ShaderDebugTrace *> DebugPixels(const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels,
+                                           uint32_t sample, uint32_t primitive);
   ShaderDebugTrace *DebugThread(const rdcfixedarray<uint32_t, 3> &groupid,
                                 const rdcfixedarray<uint32_t, 3> &threadid);
   rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger);
   void FreeTrace(ShaderDebugTrace *trace);
 
   MeshFormat GetPostVSData(uint32_t instID, uint32_t viewID, MeshDataStage stage);
+  PostVSCacheStatistics GetPostVSCacheStatistics();
 
   rdcarray<EventUsage> GetUsage(ResourceId id);
 
   bytebuf GetBufferData(ResourceId buff, uint64_t offset, uint64_t len);
   bytebuf GetTextureData(ResourceId buff, const Subresource &sub);
+  void GetTextureDataBatch(const rdcarray<ResourceId> &textures, const rdcarray<Subresource> &subs,
+                           RENDERDOC_TextureDataCallback callback);
 
   ResultDetails SaveTexture(const TextureSave &saveData, const rdcstr &path);
+  ResultDetails SaveTextures(const rdcarray<TextureSave> &saveData, const rdcarray<rdcstr> &paths);
 
   rdcarray<ShaderVariable> GetCBufferVariableContents(ResourceId pipeline, ResourceId shader,
                                                       ShaderStage stage, const rdcstr &entryPoint,
@@ -243,6 +258,13 @@ private:
 
   void FetchPipelineState(uint32_t eventId);
 
+  RDResult PrepareTextureSave(const TextureSave &saveData, TextureSaveJob &job);
+
+  rdcarray<EventUsage> GetPixelHistoryEvents(ResourceId target, uint32_t x, uint32_t y,
+                                             uint32_t &width, uint32_t &height, Subresource &sub);
+
+  uint32_t GetTextureContentsEvent(ResourceId textureId);
+
   ActionDescription *GetActionByEID(uint32_t eventId);
   bool ContainsMarker(const rdcarray<ActionDescription> &actions);
   bool PassEquivalent(const ActionDescription &a, const ActionDescription &b);
@@ -276,8 +298,64 @@ private:
 
   rdcarray<ResourceDescription> m_Resources;
   rdcarray<BufferDescription> m_Buffers;
+
+  // the searchable text from every shader in the capture, gathered by the first SearchShaders
+  struct ShaderSearchText
+  {
+    ResourceId shader;
+    ShaderEntryPoint entry;
+    // pairs of location and text
+    rdcarray<rdcpair<rdcstr, rdcstr>> sections;
+  };
+  bool m_ShaderSearchTextReady = false;
+  rdcarray<ShaderSearchText> m_ShaderSearchText;
+
+  void GatherShaderSearchText();
   rdcarray<TextureDescription> m_Textures;
 
+  struct TextureStatsKey
+  {
+    ResourceId id;
+    Subresource sub;
+    CompType typeCast;
+    // the last event that could have modified the texture's contents
+    uint32_t contentsEvent;
+    // histogram parameters, left at 0 for min/max
+    float rangeMin, rangeMax;
+    uint32_t channelMask;
+
+    bool operator<(const TextureStatsKey &o) const;
+  };
+
+  // capture textures' write events, used to tell when min/max and histogram results can be re-used.
+  // Textures that aren't from the capture have no usage to check and are never cached.
+  struct TextureWrites
+  {
+    bool tracked = false;
+    rdcarray<uint32_t> events;
+  };
+
+  std::map<ResourceId, TextureWrites> m_TextureWrites;
+  std::map<TextureStatsKey, rdcpair<PixelValue, PixelValue>> m_MinMaxCache;
+  std::map<TextureStatsKey, rdcarray<uint32_t>> m_HistogramCache;
+
+  // pixels are picked a tile at a time, so hovering over a texture only reads back from the GPU
+  // when the cursor moves into a new tile. Tiles are aligned to multiples of PickTileSize.
+  static const uint32_t PickTileSize = 64;
+  struct PickTileKey
+  {
+    TextureStatsKey tex;
+    uint32_t x, y;
+
+    bool operator<(const PickTileKey &o) const;
+  };
+  struct PickTile
+  {
+    uint32_t width;
+    rdcarray<float> pixels;
+  };
+  std::map<PickTileKey, PickTile> m_PickTileCache;
+
   IReplayDriver *m_pDevice;
 
   rdcarray<ShaderDebugger *> m_Debuggers;
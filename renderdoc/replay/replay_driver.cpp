@@ -23,7 +23,9 @@
  ******************************************************************************/
 
 #include "replay_driver.h"
+#include <math.h>
 #include "compressonator/CMP_Core.h"
+#include "core/settings.h"
 #include "maths/formatpacking.h"
 #include "maths/half_convert.h"
 #include "serialise/serialiser.h"
@@ -56,6 +58,15 @@ void DoSerialise(SerialiserType &ser, GetTextureDataParams &el)
 
 INSTANTIATE_SERIALISE_TYPE(GetTextureDataParams);
 
+RDOC_CONFIG(uint32_t, Replay_PostVSCacheBudgetMB, 1024,
+            "The GPU memory in MB that cached post-transform vertex data can use before the least "
+            "recently used events are released. 0 means unlimited.");
+
+RDOC_CONFIG(uint32_t, Replay_GPUDurationRepeats, 1,
+            "The number of replays used to time each event when fetching GPU durations. With more "
+            "than one the duration reported is the median, and the standard deviation is "
+            "available as a separate counter.");
+
 static bool PreviousNextExcludedMarker(ActionDescription *action)
 {
   return bool(action->flags & (ActionFlags::PushMarker | ActionFlags::PopMarker |
@@ -853,6 +864,69 @@ uint64_t inthash(ResourceId id, uint64_t seed)
   return (seed << 5) + seed + val; /* hash * 33 + c */
 }
 
+uint64_t MeshPickingKey(uint32_t eventId, const MeshFormat &fmt)
+{
+  uint64_t key = 5381;
+
+  key = inthash(eventId, key);
+  key = inthash(fmt.indexResourceId, key);
+  key = inthash(fmt.indexByteOffset, key);
+  key = inthash(fmt.indexByteStride, key);
+  key = inthash((uint64_t)fmt.baseVertex, key);
+  key = inthash(fmt.vertexResourceId, key);
+  key = inthash(fmt.vertexByteOffset, key);
+  key = inthash(fmt.vertexByteStride, key);
+  key = inthash((uint64_t)fmt.format.type, key);
+  key = inthash((uint64_t)fmt.format.compType, key);
+  key = inthash(fmt.format.compCount, key);
+  key = inthash(fmt.format.compByteWidth, key);
+  key = inthash((uint64_t)fmt.format.BGRAOrder(), key);
+  key = inthash((uint64_t)fmt.topology, key);
+  key = inthash(fmt.numIndices, key);
+  key = inthash((uint64_t)fmt.allowRestart, key);
+  key = inthash(fmt.restartIndex, key);
+
+  return key;
+}
+
+uint32_t GetGPUDurationRepeats()
+{
+  // clamp to something sane, each repeat is a full replay of the frame
+  return RDCCLAMP(Replay_GPUDurationRepeats(), 1U, 100U);
+}
+
+double CalcDurationMedian(rdcarray<double> samples)
+{
+  if(samples.empty())
+    return 0.0;
+
+  std::sort(samples.begin(), samples.end());
+
+  size_t mid = samples.size() / 2;
+  if(samples.size() % 2 == 1)
+    return samples[mid];
+
+  return (samples[mid - 1] + samples[mid]) * 0.5;
+}
+
+double CalcDurationStdDev(const rdcarray<double> &samples)
+{
+  if(samples.size() < 2)
+    return 0.0;
+
+  double mean = 0.0;
+  for(double s : samples)
+    mean += s;
+  mean /= double(samples.size());
+
+  double variance = 0.0;
+  for(double s : samples)
+    variance += (s - mean) * (s - mean);
+  variance /= double(samples.size() - 1);
+
+  return sqrt(variance);
+}
+
 void HighlightCache::CacheHighlightingData(uint32_t eventId, const MeshDisplay &cfg)
 {
   rdcstr ident;
@@ -1798,3 +1872,236 @@ bytebuf GetDiscardPattern(DiscardType type, const ResourceFormat &fmt, uint32_t
 
   return ret;
 }
+
+PixelRegionHistory StandardPixelHistoryRegion(IRemoteDriver *driver,
+                                              const rdcarray<EventUsage> &events,
+                                              ResourceId target, uint32_t x, uint32_t y,
+                                              uint32_t width, uint32_t height,
+                                              const Subresource &sub, CompType typeCast)
+{
+  PixelRegionHistory ret;
+  ret.x = x;
+  ret.y = y;
+  ret.width = width;
+  ret.height = height;
+  ret.pixelOffsets.reserve(width * height + 1);
+
+  std::map<uint32_t, ResourceUsage> eventUsage;
+  for(const EventUsage &u : events)
+    eventUsage[u.eventId] = u.usage;
+
+  for(uint32_t py = y; py < y + height; py++)
+  {
+    for(uint32_t px = x; px < x + width; px++)
+    {
+      ret.pixelOffsets.push_back((uint32_t)ret.eventIds.size());
+
+      rdcarray<PixelModification> mods = driver->PixelHistory(events, target, px, py, sub, typeCast);
+
+      // each fragment of a draw is a separate modification, collapse them into one entry
+      for(size_t i = 0; i < mods.size(); i++)
+      {
+        if(i > 0 && mods[i].eventId == mods[i - 1].eventId)
+          continue;
+
+        ResourceUsage usage = eventUsage[mods[i].eventId];
+        bool draw = (usage == ResourceUsage::ColorTarget || usage == ResourceUsage::DepthStencilTarget);
+
+        uint32_t frags = 0;
+        for(size_t j = i; draw && j < mods.size() && mods[j].eventId == mods[i].eventId; j++)
+          frags++;
+
+        ret.eventIds.push_back(mods[i].eventId);
+        ret.fragments.push_back(frags);
+      }
+    }
+  }
+
+  ret.pixelOffsets.push_back((uint32_t)ret.eventIds.size());
+
+  return ret;
+}
+
+void PostVSCacheTracker::Touch(uint32_t eventId)
+{
+  m_Hits++;
+
+  for(size_t i = 0; i < m_Entries.size(); i++)
+  {
+    if(m_Entries[i].eventId == eventId)
+    {
+      Entry e = m_Entries.takeAt(i);
+      m_Entries.push_back(e);
+      return;
+    }
+  }
+}
+
+void PostVSCacheTracker::Add(uint32_t eventId)
+{
+  m_Misses++;
+
+  m_Entries.push_back({eventId, false, 0});
+}
+
+void PostVSCacheTracker::SetSize(uint32_t eventId, uint64_t bytes)
+{
+  for(Entry &e : m_Entries)
+  {
+    if(e.eventId == eventId)
+    {
+      m_Bytes -= e.bytes;
+      e.sized = true;
+      e.bytes = bytes;
+      m_Bytes += e.bytes;
+      return;
+    }
+  }
+}
+
+rdcarray<uint32_t> PostVSCacheTracker::GetUnsizedEvents() const
+{
+  rdcarray<uint32_t> ret;
+  for(const Entry &e : m_Entries)
+    if(!e.sized)
+      ret.push_back(e.eventId);
+  return ret;
+}
+
+rdcarray<uint32_t> PostVSCacheTracker::Trim(const rdcarray<uint32_t> &keep, uint64_t budget)
+{
+  rdcarray<uint32_t> ret;
+
+  if(budget == 0)
+    return ret;
+
+  for(size_t i = 0; i < m_Entries.size() && m_Bytes > budget;)
+  {
+    if(keep.contains(m_Entries[i].eventId))
+    {
+      i++;
+      continue;
+    }
+
+    m_Bytes -= m_Entries[i].bytes;
+    m_Evictions++;
+    ret.push_back(m_Entries.takeAt(i).eventId);
+  }
+
+  return ret;
+}
+
+void PostVSCacheTracker::Clear()
+{
+  m_Entries.clear();
+  m_Bytes = 0;
+}
+
+PostVSCacheStatistics PostVSCacheTracker::GetStatistics() const
+{
+  PostVSCacheStatistics ret;
+  ret.hits = m_Hits;
+  ret.misses = m_Misses;
+  ret.evictions = m_Evictions;
+  ret.bytesUsed = m_Bytes;
+  ret.budget = GetBudget();
+  ret.entries = (uint32_t)m_Entries.size();
+  return ret;
+}
+
+uint64_t PostVSCacheTracker::GetBudget()
+{
+  return uint64_t(Replay_PostVSCacheBudgetMB()) * 1024 * 1024;
+}
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "catch/catch.hpp"
+
+TEST_CASE("Test post-VS cache tracking", "[postvs]")
+{
+  PostVSCacheTracker cache;
+
+  cache.Add(10);
+  cache.Add(20);
+  cache.Add(30);
+
+  CHECK(cache.GetUnsizedEvents() == rdcarray<uint32_t>({10, 20, 30}));
+
+  cache.SetSize(10, 100);
+  cache.SetSize(20, 200);
+  cache.SetSize(30, 300);
+
+  CHECK(cache.GetUnsizedEvents().empty());
+  CHECK(cache.GetStatistics().bytesUsed == 600);
+  CHECK(cache.GetStatistics().misses == 3);
+
+  SECTION("Nothing is evicted within budget")
+  {
+    CHECK(cache.Trim({}, 600).empty());
+    CHECK(cache.Trim({}, 0).empty());
+    CHECK(cache.GetStatistics().entries == 3);
+  };
+
+  SECTION("Least recently used events are evicted first")
+  {
+    cache.Touch(10);
+
+    CHECK(cache.GetStatistics().hits == 1);
+    CHECK(cache.Trim({}, 450) == rdcarray<uint32_t>({20}));
+    CHECK(cache.GetStatistics().bytesUsed == 400);
+
+    CHECK(cache.Trim({}, 350) == rdcarray<uint32_t>({30}));
+    CHECK(cache.GetStatistics().bytesUsed == 100);
+    CHECK(cache.GetStatistics().evictions == 2);
+  };
+
+  SECTION("Kept events are never evicted")
+  {
+    CHECK(cache.Trim({10, 20}, 1) == rdcarray<uint32_t>({30}));
+    CHECK(cache.GetStatistics().bytesUsed == 300);
+    CHECK(cache.GetStatistics().entries == 2);
+  };
+
+  SECTION("Clearing keeps the counters")
+  {
+    cache.Clear();
+
+    PostVSCacheStatistics stats = cache.GetStatistics();
+    CHECK(stats.entries == 0);
+    CHECK(stats.bytesUsed == 0);
+    CHECK(stats.misses == 3);
+  };
+}
+
+TEST_CASE("Test GPU duration statistics", "[counters]")
+{
+  SECTION("Empty and single samples")
+  {
+    CHECK(CalcDurationMedian({}) == 0.0);
+    CHECK(CalcDurationStdDev({}) == 0.0);
+
+    CHECK(CalcDurationMedian({2.5}) == 2.5);
+    CHECK(CalcDurationStdDev({2.5}) == 0.0);
+  };
+
+  SECTION("Median")
+  {
+    CHECK(CalcDurationMedian({3.0, 1.0, 2.0}) == 2.0);
+    CHECK(CalcDurationMedian({4.0, 1.0, 3.0, 2.0}) == 2.5);
+
+    // an outlier doesn't move the median
+    CHECK(CalcDurationMedian({1.0, 1.0, 100.0}) == 1.0);
+  };
+
+  SECTION("Standard deviation")
+  {
+    CHECK(CalcDurationStdDev({5.0, 5.0, 5.0}) == 0.0);
+
+    // sample standard deviation, variance is 32/7
+    CHECK(CalcDurationStdDev({2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0}) ==
+          Approx(sqrt(32.0 / 7.0)));
+  };
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
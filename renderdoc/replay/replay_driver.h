@@ -101,6 +101,17 @@ struct GetTextureDataParams
 
 DECLARE_REFLECTION_STRUCT(GetTextureDataParams);
 
+struct TextureReadback
+{
+  ResourceId tex;
+  Subresource sub;
+  GetTextureDataParams params;
+};
+
+// called once for each readback in a batch, in the order they were requested. The data can be
+// moved out of if it's going to be kept
+typedef std::function<void(size_t idx, bytebuf &data)> TextureReadbackCallback;
+
 CompType BaseRemapType(RemapTexture remap, CompType typeCast);
 inline CompType BaseRemapType(const GetTextureDataParams &params)
 {
@@ -161,6 +172,12 @@ public:
   virtual void SetPipelineStates(D3D11Pipe::State *d3d11, D3D12Pipe::State *d3d12,
                                  GLPipe::State *gl, VKPipe::State *vk) = 0;
   virtual void SavePipelineState(uint32_t eventId) = 0;
+  virtual rdcarray<VKPipe::BindingElement> GetVulkanDescriptors(bool compute, uint32_t set,
+                                                                uint32_t binding,
+                                                                uint32_t firstElement,
+                                                                uint32_t count) = 0;
+  virtual rdcarray<uint32_t> GetVulkanUsedDescriptors(bool compute, uint32_t set,
+                                                      uint32_t binding) = 0;
 
   virtual FrameRecord GetFrameRecord() = 0;
 
@@ -172,6 +189,7 @@ public:
 
   virtual void InitPostVSBuffers(uint32_t eventId) = 0;
   virtual void InitPostVSBuffers(const rdcarray<uint32_t> &passEvents) = 0;
+  virtual PostVSCacheStatistics GetPostVSCacheStatistics() = 0;
 
   virtual ResourceId GetLiveID(ResourceId id) = 0;
 
@@ -181,6 +199,8 @@ public:
   virtual void GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, bytebuf &retData) = 0;
   virtual void GetTextureData(ResourceId tex, const Subresource &sub,
                               const GetTextureDataParams &params, bytebuf &data) = 0;
+  virtual void GetTextureDataBatch(const rdcarray<TextureReadback> &readbacks,
+                                   TextureReadbackCallback callback) = 0;
 
   virtual void BuildTargetShader(ShaderEncoding sourceEncoding, const bytebuf &source,
                                  const rdcstr &entry, const ShaderCompileFlags &compileFlags,
@@ -201,10 +221,19 @@ public:
   virtual rdcarray<PixelModification> PixelHistory(rdcarray<EventUsage> events, ResourceId target,
                                                    uint32_t x, uint32_t y, const Subresource &sub,
                                                    CompType typeCast) = 0;
+  virtual PixelRegionHistory PixelHistoryRegion(rdcarray<EventUsage> events, ResourceId target,
+                                                uint32_t x, uint32_t y, uint32_t width,
+                                                uint32_t height, const Subresource &sub,
+                                                CompType typeCast) = 0;
   virtual ShaderDebugTrace *DebugVertex(uint32_t eventId, uint32_t vertid, uint32_t instid,
                                         uint32_t idx, uint32_t view) = 0;
   virtual ShaderDebugTrace *DebugPixel(uint32_t eventId, uint32_t x, uint32_t y, uint32_t sample,
                                        uint32_t primitive) = 0;
+  // debugs each of a set of pixels, returning one trace per pixel in the same order.
+  // Implementations can gather the inputs for all of them in a single replay
+  virtual rdcarray<ShaderDebugTrace *> DebugPixels(
+      uint32_t eventId, const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels, uint32_t sample,
+      uint32_t primitive) = 0;
   virtual ShaderDebugTrace *DebugThread(uint32_t eventId, const rdcfixedarray<uint32_t, 3> &groupid,
                                         const rdcfixedarray<uint32_t, 3> &threadid) = 0;
   virtual rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger) = 0;
@@ -255,6 +284,11 @@ public:
                             rdcarray<uint32_t> &histogram) = 0;
   virtual void PickPixel(ResourceId texture, uint32_t x, uint32_t y, const Subresource &sub,
                          CompType typeCast, float pixel[4]) = 0;
+  // picks a width x height block of pixels starting at x,y in one go, returning 4 floats per pixel
+  // in rows. Returns false if the driver can't, in which case each pixel must be picked on its own.
+  virtual bool PickPixelTile(ResourceId texture, uint32_t x, uint32_t y, uint32_t width,
+                             uint32_t height, const Subresource &sub, CompType typeCast,
+                             rdcarray<float> &pixels) = 0;
 
   virtual ResourceId CreateProxyTexture(const TextureDescription &templateTex) = 0;
   virtual void SetProxyTextureData(ResourceId texid, const Subresource &sub, byte *data,
@@ -316,6 +350,17 @@ void PatchTriangleFanRestartIndexBufer(rdcarray<uint32_t> &patchedIndices, uint3
 
 uint64_t CalcMeshOutputSize(uint64_t curSize, uint64_t requiredOutput);
 
+// identifies the vertex and index data that vertex picking prepares from a mesh, so that it can be
+// re-used while picking repeatedly in the same mesh.
+uint64_t MeshPickingKey(uint32_t eventId, const MeshFormat &fmt);
+
+// the number of replays to time each event over when fetching GPU durations, at least 1
+uint32_t GetGPUDurationRepeats();
+
+// reduce the durations measured for one event over repeated replays
+double CalcDurationMedian(rdcarray<double> samples);
+double CalcDurationStdDev(const rdcarray<double> &samples);
+
 void StandardFillCBufferVariable(ResourceId shader, const ShaderConstantType &desc,
                                  uint32_t dataOffset, const bytebuf &data, ShaderVariable &outvar,
                                  uint32_t matStride);
@@ -323,6 +368,13 @@ void StandardFillCBufferVariables(ResourceId shader, const rdcarray<ShaderConsta
                                   rdcarray<ShaderVariable> &outvars, const bytebuf &data);
 void PreprocessLineDirectives(rdcarray<ShaderSourceFile> &sourceFiles);
 
+// region pixel history for drivers that can't do better than fetching each pixel's history in turn
+PixelRegionHistory StandardPixelHistoryRegion(IRemoteDriver *driver,
+                                              const rdcarray<EventUsage> &events,
+                                              ResourceId target, uint32_t x, uint32_t y,
+                                              uint32_t width, uint32_t height,
+                                              const Subresource &sub, CompType typeCast);
+
 // simple cache for when we need buffer data for highlighting
 // vertices, typical use will be lots of vertices in the same
 // mesh, not jumping back and forth much between meshes.
@@ -351,6 +403,43 @@ struct HighlightCache
                               const byte *end, bool useidx, bool &valid);
 };
 
+// tracks the GPU memory used by each event's cached post-transform data in least-recently-used
+// order, so drivers can release the oldest events once the cache goes over budget.
+struct PostVSCacheTracker
+{
+  // the event's data was found in the cache
+  void Touch(uint32_t eventId);
+  // the event's data was added to the cache. Its size is filled in later with SetSize
+  void Add(uint32_t eventId);
+  void SetSize(uint32_t eventId, uint64_t bytes);
+  rdcarray<uint32_t> GetUnsizedEvents() const;
+
+  // returns the least recently used events the driver must release to get back within budget,
+  // never including any of the events in keep. A budget of 0 is unlimited.
+  rdcarray<uint32_t> Trim(const rdcarray<uint32_t> &keep, uint64_t budget = GetBudget());
+  void Clear();
+
+  PostVSCacheStatistics GetStatistics() const;
+
+  static uint64_t GetBudget();
+
+private:
+  struct Entry
+  {
+    uint32_t eventId;
+    bool sized;
+    uint64_t bytes;
+  };
+
+  // ordered from least to most recently used
+  rdcarray<Entry> m_Entries;
+  uint64_t m_Bytes = 0;
+
+  uint64_t m_Hits = 0;
+  uint64_t m_Misses = 0;
+  uint64_t m_Evictions = 0;
+};
+
 extern const Vec4f colorRamp[22];
 
 enum class DiscardType : int
@@ -292,6 +292,8 @@ void ReplayOutput::RefreshOverlay()
     {
       FloatVector f = m_RenderData.texDisplay.backgroundColor;
 
+      RENDERDOC_PROFILEREGION("RenderOverlay");
+
       m_OverlayResourceId =
           m_pDevice->RenderOverlay(id, f, m_RenderData.texDisplay.overlay, m_EventID, passEvents);
       m_pController->FatalErrorCheck();
@@ -0,0 +1,413 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2023 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#include <map>
+#include "api/replay/structured_data.h"
+#include "common/common.h"
+#include "serialise/rdcfile.h"
+#include "serialise/streamio.h"
+
+#include "zstd/zstd.h"
+
+// A binary export of the per-chunk metadata, laid out in columns so that tools can scan event
+// timings across many captures without loading or parsing the structured data. The file contains:
+//
+//   ColumnarHeader
+//   ColumnarColumnDesc[header.numColumns]
+//   a block containing the chunk name table
+//   a block containing the callstack table
+//   header.numGroups row groups, each containing one block per column in the order of the column
+//   descriptions. Every group except the last has header.rowsPerGroup rows.
+//
+// Each block is a ColumnarBlockHeader followed by storedSize bytes which are either raw or zstd
+// compressed, then padded to an 8-byte boundary.
+//
+// The name table is a uint64 count N, N+1 uint64 offsets and then the characters, so name i is the
+// characters in [offsets[i], offsets[i+1]). The callstack table is the same with a uint64 count N,
+// N+1 uint64 offsets then the uint64 frame addresses.
+
+static const char ColumnarMagic[8] = {'R', 'D', 'C', 'C', 'O', 'L', 'S', '\0'};
+static const uint32_t ColumnarVersion = 1;
+static const uint32_t ColumnarRowsPerGroup = 64 * 1024;
+static const uint32_t ColumnarNoCallstack = ~0U;
+
+struct ColumnarHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t numColumns;
+  uint64_t numRows;
+  uint32_t rowsPerGroup;
+  uint32_t numGroups;
+  uint64_t captureVersion;
+  uint32_t driver;
+  uint32_t padding;
+};
+
+enum class ColumnarType : uint32_t
+{
+  UInt32,
+  UInt64,
+  Int64,
+};
+
+struct ColumnarColumnDesc
+{
+  char name[16];
+  ColumnarType type;
+  uint32_t elemSize;
+};
+
+enum class ColumnarCompression : uint32_t
+{
+  None,
+  Zstd,
+};
+
+struct ColumnarBlockHeader
+{
+  uint64_t uncompressedSize;
+  uint64_t storedSize;
+  ColumnarCompression compression;
+  uint32_t padding;
+};
+
+// the order of these must match the order the columns are written in each row group
+static const ColumnarColumnDesc columnarColumns[] = {
+    {"chunkID", ColumnarType::UInt32, 4},
+    // index into the name table
+    {"name", ColumnarType::UInt32, 4},
+    {"flags", ColumnarType::UInt64, 8},
+    {"length", ColumnarType::UInt64, 8},
+    {"threadID", ColumnarType::UInt64, 8},
+    {"timestamp", ColumnarType::UInt64, 8},
+    // -1 if no duration was recorded
+    {"duration", ColumnarType::Int64, 8},
+    // index into the callstack table, or ColumnarNoCallstack
+    {"callstack", ColumnarType::UInt32, 4},
+};
+
+static void WriteColumnarBlock(StreamWriter &writer, const void *data, uint64_t size,
+                               bytebuf &scratch)
+{
+  ColumnarBlockHeader block = {};
+  block.uncompressedSize = size;
+  block.storedSize = size;
+  block.compression = ColumnarCompression::None;
+
+  const void *stored = data;
+
+  if(size > 0)
+  {
+    scratch.resize(ZSTD_compressBound((size_t)size));
+    size_t compSize = ZSTD_compress(scratch.data(), scratch.size(), data, (size_t)size, 3);
+
+    // only keep the compressed data if it's actually smaller
+    if(!ZSTD_isError(compSize) && compSize < size)
+    {
+      block.storedSize = compSize;
+      block.compression = ColumnarCompression::Zstd;
+      stored = scratch.data();
+    }
+  }
+
+  writer.Write(block);
+  writer.Write(stored, block.storedSize);
+  writer.AlignTo<8>();
+}
+
+template <typename T>
+static void WriteColumnarColumn(StreamWriter &writer, const rdcarray<T> &column, bytebuf &scratch)
+{
+  WriteColumnarBlock(writer, column.data(), column.byteSize(), scratch);
+}
+
+template <typename T>
+static void WriteColumnarTable(StreamWriter &writer, const rdcarray<rdcarray<T>> &entries,
+                               bytebuf &scratch)
+{
+  bytebuf table;
+
+  uint64_t count = entries.size();
+  table.append((const byte *)&count, sizeof(count));
+
+  uint64_t offset = 0;
+  for(size_t i = 0; i <= entries.size(); i++)
+  {
+    table.append((const byte *)&offset, sizeof(offset));
+    if(i < entries.size())
+      offset += entries[i].size();
+  }
+
+  for(const rdcarray<T> &entry : entries)
+    table.append((const byte *)entry.data(), entry.byteSize());
+
+  WriteColumnarBlock(writer, table.data(), table.size(), scratch);
+}
+
+RDResult exportColumnar(const rdcstr &filename, const RDCFile &rdc, const SDFile &structData,
+                        RENDERDOC_ProgressCallback progress)
+{
+  FILE *f = FileIO::fopen(filename, FileIO::WriteBinary);
+
+  if(!f)
+    RETURN_ERROR_RESULT(ResultCode::FileIOFailed, "Failed to open '%s' for write: %s",
+                        filename.c_str(), FileIO::ErrorString().c_str());
+
+  StreamWriter writer(f, Ownership::Stream);
+
+  const size_t numChunks = structData.chunks.size();
+
+  // deduplicate names and callstacks up front so that the tables can be written before the rows
+  rdcarray<uint32_t> nameIndices, callstackIndices;
+  nameIndices.resize(numChunks);
+  callstackIndices.resize(numChunks);
+
+  rdcarray<rdcarray<char>> names;
+  rdcarray<rdcarray<uint64_t>> callstacks;
+
+  {
+    std::map<rdcstr, uint32_t> nameLookup;
+    std::map<rdcarray<uint64_t>, uint32_t> callstackLookup;
+
+    for(size_t i = 0; i < numChunks; i++)
+    {
+      const SDChunk *chunk = structData.chunks[i];
+
+      rdcstr name = chunk->name;
+      auto it = nameLookup.find(name);
+      if(it == nameLookup.end())
+      {
+        it = nameLookup.insert(std::make_pair(name, (uint32_t)names.size())).first;
+        names.push_back(rdcarray<char>(name.c_str(), name.size()));
+      }
+      nameIndices[i] = it->second;
+
+      callstackIndices[i] = ColumnarNoCallstack;
+      if(chunk->metadata.flags & SDChunkFlags::HasCallstack)
+      {
+        const rdcarray<uint64_t> &stack = chunk->metadata.callstack;
+        auto cit = callstackLookup.find(stack);
+        if(cit == callstackLookup.end())
+        {
+          cit = callstackLookup.insert(std::make_pair(stack, (uint32_t)callstacks.size())).first;
+          callstacks.push_back(stack);
+        }
+        callstackIndices[i] = cit->second;
+      }
+    }
+  }
+
+  ColumnarHeader header = {};
+  memcpy(header.magic, ColumnarMagic, sizeof(ColumnarMagic));
+  header.version = ColumnarVersion;
+  header.numColumns = (uint32_t)ARRAY_COUNT(columnarColumns);
+  header.numRows = numChunks;
+  header.rowsPerGroup = ColumnarRowsPerGroup;
+  header.numGroups = uint32_t((numChunks + ColumnarRowsPerGroup - 1) / ColumnarRowsPerGroup);
+  header.captureVersion = structData.version;
+  header.driver = (uint32_t)rdc.GetDriver();
+
+  writer.Write(header);
+  writer.Write(columnarColumns);
+
+  bytebuf scratch;
+
+  WriteColumnarTable(writer, names, scratch);
+  WriteColumnarTable(writer, callstacks, scratch);
+
+  rdcarray<uint32_t> chunkIDs;
+  rdcarray<uint64_t> flags, lengths, threadIDs, timestamps;
+  rdcarray<int64_t> durations;
+
+  for(uint32_t g = 0; g < header.numGroups; g++)
+  {
+    const size_t begin = size_t(g) * ColumnarRowsPerGroup;
+    const size_t end = RDCMIN(begin + ColumnarRowsPerGroup, numChunks);
+
+    chunkIDs.clear();
+    flags.clear();
+    lengths.clear();
+    threadIDs.clear();
+    timestamps.clear();
+    durations.clear();
+
+    for(size_t i = begin; i < end; i++)
+    {
+      const SDChunkMetaData &metadata = structData.chunks[i]->metadata;
+
+      chunkIDs.push_back(metadata.chunkID);
+      flags.push_back((uint64_t)metadata.flags);
+      lengths.push_back(metadata.length);
+      threadIDs.push_back(metadata.threadID);
+      timestamps.push_back(metadata.timestampMicro);
+      durations.push_back(metadata.durationMicro);
+    }
+
+    WriteColumnarColumn(writer, chunkIDs, scratch);
+    WriteColumnarBlock(writer, nameIndices.data() + begin, (end - begin) * sizeof(uint32_t),
+                       scratch);
+    WriteColumnarColumn(writer, flags, scratch);
+    WriteColumnarColumn(writer, lengths, scratch);
+    WriteColumnarColumn(writer, threadIDs, scratch);
+    WriteColumnarColumn(writer, timestamps, scratch);
+    WriteColumnarColumn(writer, durations, scratch);
+    WriteColumnarBlock(writer, callstackIndices.data() + begin, (end - begin) * sizeof(uint32_t),
+                       scratch);
+
+    if(progress)
+      progress(float(end) / float(numChunks));
+  }
+
+  if(progress)
+    progress(1.0f);
+
+  writer.Finish();
+
+  return writer.GetError();
+}
+
+static ConversionRegistration ColumnarConversionRegistration(
+    &exportColumnar,
+    {
+        "columns.bin", "Binary columnar chunk data",
+        R"(Exports the chunk ID, name, flags, length, threadID, timestamp, duration and callstack of
+every chunk in compressed binary columns, for fast bulk analysis of API event timings.)",
+        false,
+    });
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "catch/catch.hpp"
+
+static bytebuf ReadColumnarBlock(StreamReader &reader)
+{
+  ColumnarBlockHeader block;
+  reader.Read(block);
+
+  bytebuf stored;
+  stored.resize((size_t)block.storedSize);
+  reader.Read(stored.data(), stored.size());
+  reader.AlignTo<8>();
+
+  if(block.compression == ColumnarCompression::None)
+    return stored;
+
+  bytebuf ret;
+  ret.resize((size_t)block.uncompressedSize);
+  size_t size = ZSTD_decompress(ret.data(), ret.size(), stored.data(), stored.size());
+  CHECK(size == block.uncompressedSize);
+  return ret;
+}
+
+TEST_CASE("Columnar export of chunk metadata", "[columnar]")
+{
+  rdcstr filename = FileIO::GetTempFolderFilename() + "renderdoc_columnar_export_test.bin";
+
+  RDCFile rdc;
+  rdc.SetData(RDCDriver::Vulkan, "Vulkan", 0, NULL, 0, 1);
+
+  SDFile structData;
+  structData.version = 7;
+
+  const uint32_t numChunks = 1000;
+
+  for(uint32_t i = 0; i < numChunks; i++)
+  {
+    SDChunk *chunk = new SDChunk(i % 2 ? "vkCmdDraw"_lit : "vkCmdDispatch"_lit);
+    chunk->metadata.chunkID = 100 + (i % 2);
+    chunk->metadata.threadID = 55;
+    chunk->metadata.timestampMicro = i * 10;
+    chunk->metadata.durationMicro = i % 3 ? int64_t(i) : -1;
+
+    if(i % 4 == 0)
+    {
+      chunk->metadata.flags |= SDChunkFlags::HasCallstack;
+      chunk->metadata.callstack = {0x1000, 0x2000 + (i % 8)};
+    }
+
+    structData.chunks.push_back(chunk);
+  }
+
+  RDResult res = exportColumnar(filename, rdc, structData, NULL);
+  REQUIRE(res.code == ResultCode::Succeeded);
+
+  {
+    StreamReader reader(FileIO::fopen(filename, FileIO::ReadBinary));
+
+    ColumnarHeader header;
+    reader.Read(header);
+
+    CHECK(memcmp(header.magic, ColumnarMagic, sizeof(ColumnarMagic)) == 0);
+    CHECK(header.version == ColumnarVersion);
+    CHECK(header.numRows == numChunks);
+    CHECK(header.numGroups == 1);
+    CHECK(header.captureVersion == 7);
+    REQUIRE(header.numColumns == ARRAY_COUNT(columnarColumns));
+
+    ColumnarColumnDesc descs[ARRAY_COUNT(columnarColumns)];
+    reader.Read(descs);
+    CHECK(rdcstr(descs[6].name) == "duration");
+
+    bytebuf nameTable = ReadColumnarBlock(reader);
+    const uint64_t *nameData = (const uint64_t *)nameTable.data();
+    REQUIRE(nameData[0] == 2);
+    rdcstr firstName((const char *)&nameData[4], size_t(nameData[2] - nameData[1]));
+    CHECK(firstName == "vkCmdDispatch");
+
+    bytebuf callstackTable = ReadColumnarBlock(reader);
+    // the callstacks repeat every 8 chunks, and every 4th chunk has one
+    CHECK(((const uint64_t *)callstackTable.data())[0] == 2);
+
+    rdcarray<bytebuf> columns;
+    for(uint32_t c = 0; c < header.numColumns; c++)
+    {
+      columns.push_back(ReadColumnarBlock(reader));
+      CHECK(columns.back().size() == numChunks * descs[c].elemSize);
+    }
+
+    CHECK_FALSE(reader.IsErrored());
+    CHECK(reader.AtEnd());
+
+    const uint32_t *chunkIDs = (const uint32_t *)columns[0].data();
+    const uint32_t *nameIdx = (const uint32_t *)columns[1].data();
+    const uint64_t *timestamps = (const uint64_t *)columns[5].data();
+    const int64_t *durations = (const int64_t *)columns[6].data();
+    const uint32_t *callstackIdx = (const uint32_t *)columns[7].data();
+
+    for(uint32_t i = 0; i < numChunks; i++)
+    {
+      CHECK(chunkIDs[i] == 100 + (i % 2));
+      CHECK(nameIdx[i] == i % 2);
+      CHECK(timestamps[i] == i * 10);
+      CHECK(durations[i] == (i % 3 ? int64_t(i) : -1));
+      CHECK(callstackIdx[i] == (i % 4 == 0 ? (i % 8) / 4 : ColumnarNoCallstack));
+    }
+  }
+
+  FileIO::Delete(filename);
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
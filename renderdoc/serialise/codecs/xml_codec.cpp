@@ -26,12 +26,21 @@
 #include "api/replay/structured_data.h"
 #include "common/common.h"
 #include "common/formatting.h"
+#include "common/threading.h"
+#include "core/settings.h"
 #include "serialise/rdcfile.h"
 #include "strings/string_utils.h"
 
 #include "miniz/miniz.h"
 #include "pugixml/pugixml.hpp"
 
+RDOC_CONFIG(uint32_t, Export_XMLThreads, 0,
+            "The number of threads to use when converting chunks to XML. 0 chooses automatically "
+            "based on the number of cores, and 1 converts on the writing thread.");
+
+// the number of chunks converted together as one job when exporting to XML
+static const size_t XMLChunksPerJob = 64;
+
 struct ThumbTypeAndData
 {
   FileType format;
@@ -102,6 +111,13 @@ struct xml_file_writer : pugi::xml_writer
   void write(const void *data, size_t size) { stream.Write(data, size); }
 };
 
+struct xml_string_writer : pugi::xml_writer
+{
+  rdcstr str;
+
+  void write(const void *data, size_t size) { str.append((const char *)data, size); }
+};
+
 // avoid &, <, and > since they throw off the ascii alignment
 static constexpr bool IsXMLPrintable(const char c)
 {
@@ -315,6 +331,45 @@ static void Obj2XML(pugi::xml_node &parent, SDObject &child)
   }
 }
 
+static void Chunk2XML(pugi::xml_node &xChunks, SDChunk *chunk)
+{
+  pugi::xml_node xChunk = xChunks.append_child("chunk");
+
+  xChunk.append_attribute("id") = chunk->metadata.chunkID;
+  xChunk.append_attribute("name") = chunk->name.c_str();
+  xChunk.append_attribute("length") = chunk->metadata.length;
+  if(chunk->metadata.threadID)
+    xChunk.append_attribute("threadID") = chunk->metadata.threadID;
+  if(chunk->metadata.timestampMicro)
+    xChunk.append_attribute("timestamp") = chunk->metadata.timestampMicro;
+  if(chunk->metadata.durationMicro >= 0)
+    xChunk.append_attribute("duration") = chunk->metadata.durationMicro;
+  if(chunk->metadata.flags & SDChunkFlags::HasCallstack)
+  {
+    pugi::xml_node stack = xChunk.append_child("callstack");
+
+    for(size_t i = 0; i < chunk->metadata.callstack.size(); i++)
+    {
+      stack.append_child("address").text() = chunk->metadata.callstack[i];
+    }
+  }
+
+  if(chunk->metadata.flags & SDChunkFlags::OpaqueChunk)
+  {
+    xChunk.append_attribute("opaque") = true;
+
+    RDCASSERT(chunk->NumChildren() > 0);
+    pugi::xml_node opaque = xChunk.append_child("buffer");
+    opaque.append_attribute("byteLength") = chunk->GetChild(0)->type.byteSize;
+    opaque.text() = chunk->GetChild(0)->data.basic.u;
+  }
+  else
+  {
+    for(size_t o = 0; o < chunk->NumChildren(); o++)
+      Obj2XML(xChunk, *chunk->GetChild(o));
+  }
+}
+
 static RDResult Structured2XML(const rdcstr &filename, const RDCFile &file, uint64_t version,
                                const StructuredChunkList &chunks, RENDERDOC_ProgressCallback progress)
 {
@@ -365,7 +420,10 @@ static RDResult Structured2XML(const rdcstr &filename, const RDCFile &file, uint
   {
     const SectionProperties &props = file.GetSectionProperties(i);
 
-    if(props.type == SectionType::FrameCapture)
+    // the block and chunk indices describe the original frame capture section, they're regenerated
+    // for the new frame capture.
+    if(props.type == SectionType::FrameCapture || props.type == SectionType::BlockIndex ||
+       props.type == SectionType::ChunkIndex)
       continue;
 
     StreamReader *reader = file.ReadSection(i);
@@ -467,59 +525,110 @@ static RDResult Structured2XML(const rdcstr &filename, const RDCFile &file, uint
 
   xChunks.append_attribute("version") = version;
 
-  for(size_t c = 0; c < chunks.size(); c++)
+  // chunks are converted to text independently on worker threads, then written out in order
+  // between the text for the rest of the document. Save the document with a placeholder where the
+  // chunks go, and split it there.
+  xChunks.append_child(pugi::node_comment).set_value("chunks");
+
+  rdcstr prefix, suffix;
   {
-    pugi::xml_node xChunk = xChunks.append_child("chunk");
-    SDChunk *chunk = chunks[c];
-
-    xChunk.append_attribute("id") = chunk->metadata.chunkID;
-    xChunk.append_attribute("name") = chunk->name.c_str();
-    xChunk.append_attribute("length") = chunk->metadata.length;
-    if(chunk->metadata.threadID)
-      xChunk.append_attribute("threadID") = chunk->metadata.threadID;
-    if(chunk->metadata.timestampMicro)
-      xChunk.append_attribute("timestamp") = chunk->metadata.timestampMicro;
-    if(chunk->metadata.durationMicro >= 0)
-      xChunk.append_attribute("duration") = chunk->metadata.durationMicro;
-    if(chunk->metadata.flags & SDChunkFlags::HasCallstack)
-    {
-      pugi::xml_node stack = xChunk.append_child("callstack");
+    xml_string_writer docText;
+    doc.save(docText);
+
+    const rdcstr placeholder = "\t\t<!--chunks-->\n";
+    int32_t offs = docText.str.find(placeholder);
+    RDCASSERT(offs >= 0);
+
+    prefix = docText.str.substr(0, offs);
+    suffix = docText.str.substr(offs + placeholder.size());
+  }
+
+  struct ChunkRange
+  {
+    size_t begin, end;
+    rdcstr text;
+    int32_t done;
+  };
+
+  rdcarray<ChunkRange> ranges;
+  ranges.resize((chunks.size() + XMLChunksPerJob - 1) / XMLChunksPerJob);
 
-      for(size_t i = 0; i < chunk->metadata.callstack.size(); i++)
+  uint32_t numThreads = Export_XMLThreads();
+  if(numThreads == 0)
+    numThreads = Threading::WorkerPool::DefaultThreadCount();
+
+  // with a pool of 0 threads, each job runs immediately on this thread when it's added
+  Threading::WorkerPool pool(numThreads > 1 ? numThreads : 0);
+  Threading::Semaphore rangeDone;
+
+  // limit how many ranges are converted ahead of the writer, to bound the memory used for text
+  // that is waiting to be written
+  const size_t maxInFlight = RDCMAX(pool.GetNumThreads(), 1U) * 4;
+  size_t nextRange = 0;
+
+  auto queueRange = [&]() {
+    ChunkRange &range = ranges[nextRange];
+    range.begin = nextRange * XMLChunksPerJob;
+    range.end = RDCMIN(range.begin + XMLChunksPerJob, chunks.size());
+    range.done = 0;
+
+    pool.AddJob([&range, &chunks, &rangeDone]() {
+      xml_string_writer rangeText;
+
+      for(size_t c = range.begin; c < range.end; c++)
       {
-        stack.append_child("address").text() = chunk->metadata.callstack[i];
+        pugi::xml_document chunkDoc;
+        pugi::xml_node xParent = chunkDoc.append_child("chunks");
+
+        Chunk2XML(xParent, chunks[c]);
+
+        // print at the depth the chunk will have in the full document
+        xParent.first_child().print(rangeText, "\t", pugi::format_default, pugi::encoding_auto, 2);
       }
-    }
 
-    if(chunk->metadata.flags & SDChunkFlags::OpaqueChunk)
-    {
-      xChunk.append_attribute("opaque") = true;
+      range.text.swap(rangeText.str);
 
-      RDCASSERT(chunk->NumChildren() > 0);
-      pugi::xml_node opaque = xChunk.append_child("buffer");
-      opaque.append_attribute("byteLength") = chunk->GetChild(0)->type.byteSize;
-      opaque.text() = chunk->GetChild(0)->data.basic.u;
-    }
-    else
-    {
-      for(size_t o = 0; o < chunk->NumChildren(); o++)
-        Obj2XML(xChunk, *chunk->GetChild(o));
-    }
+      Atomic::Inc32(&range.done);
+      rangeDone.Wake(1);
+    });
+
+    nextRange++;
+  };
+
+  while(nextRange < ranges.size() && nextRange < maxInFlight)
+    queueRange();
+
+  xml_file_writer writer(filename);
+  writer.write(prefix.data(), prefix.size());
+
+  for(size_t r = 0; r < ranges.size(); r++)
+  {
+    // every completed range wakes the semaphore once, so we can't wait more times than there will
+    // be completions
+    while(Atomic::CmpExch32(&ranges[r].done, 0, 0) == 0)
+      rangeDone.WaitForWake();
+
+    writer.write(ranges[r].text.data(), ranges[r].text.size());
+    ranges[r].text = rdcstr();
+
+    if(nextRange < ranges.size())
+      queueRange();
 
     if(progress)
-      progress(StructuredProgress(0.2f + 0.8f * (float(c) / float(chunks.size()))));
+      progress(StructuredProgress(0.2f + 0.8f * (float(ranges[r].end) / float(chunks.size()))));
   }
 
-  xml_file_writer writer(filename);
-  doc.save(writer);
+  writer.write(suffix.data(), suffix.size());
 
   return writer.stream.GetError();
 }
 
 static SDObject *XML2Obj(pugi::xml_node &obj)
 {
-  SDObject *ret = new SDObject(rdcstr(obj.attribute("name").as_string()),
-                               rdcstr(obj.attribute("typename").as_string()));
+  // names and type names are heavily repeated across the document, so intern them rather than
+  // allocating a copy for every object
+  SDObject *ret = new SDObject(InternString(obj.attribute("name").as_string()),
+                               InternString(obj.attribute("typename").as_string()));
 
   rdcstr name = obj.name();
 
@@ -560,11 +669,6 @@ static SDObject *XML2Obj(pugi::xml_node &obj)
   if(obj.attribute("hiddenchildren"))
     ret->type.flags |= SDTypeFlags::HiddenChildren;
 
-  if(obj.attribute("typename"))
-    ret->type.name = obj.attribute("typename").as_string();
-
-  ret->name = obj.attribute("name").as_string();
-
   if(ret->type.basetype == SDBasic::Chunk)
   {
     RDCFATAL("Nested chunks!");
@@ -580,7 +684,7 @@ static SDObject *XML2Obj(pugi::xml_node &obj)
       SDObject *c = ret->AddAndOwnChild(XML2Obj(child));
 
       if(ret->type.basetype == SDBasic::Array)
-        c->name = "$el";
+        c->name = "$el"_lit;
     }
 
     if(ret->type.basetype == SDBasic::Array && ret->NumChildren() > 0)
@@ -849,7 +953,7 @@ static RDResult XML2Structured(const rdcstr &xml, const ThumbTypeAndData &thumb,
                           "Malformed xml document, expected <chunk> child under <chunks>, got <%s>",
                           xChunk.name());
 
-    SDChunk *chunk = new SDChunk(rdcstr(xChunk.attribute("name").as_string()));
+    SDChunk *chunk = new SDChunk(InternString(xChunk.attribute("name").as_string()));
 
     chunk->metadata.chunkID = xChunk.attribute("id").as_uint();
     chunk->metadata.length = xChunk.attribute("length").as_uint();
@@ -1202,4 +1306,57 @@ TEST_CASE("XML/SDObject round trip", "[xml serialiser]")
   }
 }
 
+TEST_CASE("XML export of many chunks", "[xml serialiser]")
+{
+  rdcstr filename = FileIO::GetTempFolderFilename() + "renderdoc_xml_export_test.xml";
+
+  RDCFile rdc;
+  rdc.SetData(RDCDriver::Vulkan, "Vulkan", 0, NULL, 0, 1);
+
+  SDFile structData;
+  structData.version = 5;
+
+  // enough chunks to be split over several conversion jobs, with an uneven final job
+  const size_t numChunks = XMLChunksPerJob * 5 + 3;
+
+  for(size_t i = 0; i < numChunks; i++)
+  {
+    SDChunk *chunk = new SDChunk(InternString(StringFormat::Fmt("chunk%u", uint32_t(i))));
+    chunk->metadata.chunkID = uint32_t(i);
+    chunk->AddAndOwnChild(makeSDUInt32("value"_lit, uint32_t(i * 3)));
+    structData.chunks.push_back(chunk);
+  }
+
+  RDResult res = exportXMLOnly(filename, rdc, structData, NULL);
+  REQUIRE(res.code == ResultCode::Succeeded);
+
+  rdcstr text;
+  REQUIRE(FileIO::ReadAll(filename, text));
+  FileIO::Delete(filename);
+
+  pugi::xml_document doc;
+  REQUIRE(bool(doc.load_string(text.c_str())));
+
+  pugi::xml_node xChunks = doc.child("rdc").child("chunks");
+  CHECK(xChunks.attribute("version").as_ullong() == 5);
+
+  size_t i = 0;
+  for(pugi::xml_node xChunk = xChunks.first_child(); xChunk; xChunk = xChunk.next_sibling())
+  {
+    CHECK(xChunk.attribute("id").as_uint() == i);
+    rdcstr name = xChunk.attribute("name").as_string();
+    CHECK(name == StringFormat::Fmt("chunk%u", uint32_t(i)));
+    CHECK(xChunk.child("uint").text().as_uint() == i * 3);
+    i++;
+  }
+
+  CHECK(i == numChunks);
+
+  // the chunks are converted separately, but the output should be formatted exactly as if the
+  // whole document was saved at once
+  xml_string_writer resaved;
+  doc.save(resaved);
+  CHECK(resaved.str == text);
+}
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
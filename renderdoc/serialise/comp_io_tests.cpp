@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  ******************************************************************************/
 
+#include "common/timing.h"
 #include "lz4io.h"
 #include "serialiser.h"
 #include "zstdio.h"
@@ -190,4 +191,231 @@ TEST_CASE("Test ZSTD compression/decompression", "[streamio][zstd]")
   delete[] randomData;
 };
 
+template <typename ParallelComp, typename Decomp>
+void TestParallelCompression(uint64_t minCompressed, uint64_t maxCompressed)
+{
+  // use an odd total size so that the final block is partial, and write in varying sizes so that
+  // writes span blocks and batches
+  const uint64_t dataSize = 5 * 1024 * 1024 + 123;
+
+  byte *data = new byte[dataSize];
+
+  for(uint64_t i = 0; i < dataSize; i++)
+  {
+    if(i < 2 * 1024 * 1024)
+      data[i] = rand() & 0xff;
+    else
+      data[i] = (i / 1000) & 0xff;
+  }
+
+  for(uint32_t numThreads : {0U, 1U, 3U})
+  {
+    StreamWriter buf(StreamWriter::DefaultScratchSize);
+
+    {
+      StreamWriter writer(new ParallelComp(&buf, Ownership::Nothing, numThreads),
+                          Ownership::Stream);
+
+      uint64_t offs = 0;
+      uint64_t writeSize = 1;
+      while(offs < dataSize)
+      {
+        uint64_t size = RDCMIN(writeSize, dataSize - offs);
+        writer.Write(data + offs, size);
+        offs += size;
+        writeSize = (writeSize * 7 + 13) % (300 * 1024);
+      }
+
+      CHECK(writer.GetOffset() == dataSize);
+
+      writer.Finish();
+
+      CHECK_FALSE(writer.IsErrored());
+    }
+
+    CHECK(buf.GetOffset() > minCompressed);
+    CHECK(buf.GetOffset() < maxCompressed);
+
+    StreamReader reader(
+        new Decomp(new StreamReader(buf.GetData(), buf.GetOffset()), Ownership::Stream), dataSize,
+        Ownership::Stream);
+
+    byte *readData = new byte[dataSize];
+
+    reader.Read(readData, dataSize);
+    CHECK_FALSE(memcmp(readData, data, dataSize));
+
+    CHECK_FALSE(reader.IsErrored());
+    CHECK(reader.AtEnd());
+
+    delete[] readData;
+  }
+
+  delete[] data;
+}
+
+TEST_CASE("Test parallel LZ4 compression", "[streamio][lz4]")
+{
+  TestParallelCompression<LZ4ParallelCompressor, LZ4Decompressor>(2 * 1024 * 1024,
+                                                                   2 * 1024 * 1024 + 256 * 1024);
+};
+
+TEST_CASE("Test parallel ZSTD compression", "[streamio][zstd]")
+{
+  TestParallelCompression<ZSTDParallelCompressor, ZSTDDecompressor>(2 * 1024 * 1024,
+                                                                    2 * 1024 * 1024 + 64 * 1024);
+};
+
+template <typename Decomp>
+void TestBlockIndexSeeking(std::function<Compressor *(StreamWriter *)> makeCompressor)
+{
+  const uint64_t dataSize = 3 * 1024 * 1024 + 77;
+
+  rdcarray<uint32_t> data;
+  data.resize(dataSize / sizeof(uint32_t) + 1);
+  for(size_t i = 0; i < data.size(); i++)
+    data[i] = uint32_t(i * 2654435761U);
+
+  StreamWriter buf(StreamWriter::DefaultScratchSize);
+
+  CompressedBlockIndex index;
+
+  {
+    Compressor *comp = makeCompressor(&buf);
+    StreamWriter writer(comp, Ownership::Stream);
+
+    writer.Write(data.data(), dataSize);
+    writer.Finish();
+
+    CHECK_FALSE(writer.IsErrored());
+
+    index = comp->GetBlockIndex();
+  }
+
+  REQUIRE(index.blockSize > 0);
+  CHECK(index.offsets.size() == (dataSize + index.blockSize - 1) / index.blockSize);
+
+  Decomp *decomp = new Decomp(new StreamReader(buf.GetData(), buf.GetOffset()), Ownership::Stream);
+  decomp->SetBlockIndex(index);
+
+  StreamReader reader(decomp, dataSize, Ownership::Stream);
+
+  const byte *ref = (const byte *)data.data();
+
+  // jump around both backwards and forwards, including to the very start and end of blocks
+  uint64_t offsets[] = {
+      2 * 1024 * 1024 + 5, 100, index.blockSize * 3, index.blockSize * 3 - 1, dataSize - 16, 0,
+      index.blockSize + 1, dataSize - 4,
+  };
+
+  for(uint64_t offs : offsets)
+  {
+    reader.SetOffset(offs);
+    CHECK(reader.GetOffset() == offs);
+
+    byte readData[16];
+    uint64_t readSize = RDCMIN(uint64_t(sizeof(readData)), dataSize - offs);
+    reader.Read(readData, readSize);
+    CHECK_FALSE(memcmp(readData, ref + offs, (size_t)readSize));
+    CHECK_FALSE(reader.IsErrored());
+  }
+}
+
+TEST_CASE("Test seeking compressed streams with a block index", "[streamio]")
+{
+  SECTION("ZSTD")
+  {
+    TestBlockIndexSeeking<ZSTDDecompressor>(
+        [](StreamWriter *w) { return new ZSTDCompressor(w, Ownership::Nothing); });
+  };
+
+  SECTION("Parallel LZ4")
+  {
+    TestBlockIndexSeeking<LZ4Decompressor>(
+        [](StreamWriter *w) { return new LZ4ParallelCompressor(w, Ownership::Nothing, 2); });
+  };
+
+  SECTION("Serial LZ4 is not indexed")
+  {
+    StreamWriter buf(StreamWriter::DefaultScratchSize);
+    LZ4Compressor comp(&buf, Ownership::Nothing);
+    comp.Write("test", 4);
+    comp.Finish();
+    CHECK(comp.GetBlockIndex().offsets.empty());
+  };
+}
+
+// hidden by default, run explicitly with the [benchmark] tag to get throughput numbers reported
+TEST_CASE("Compression throughput", "[.][benchmark][streamio]")
+{
+  const size_t dataSize = 64 * 1024 * 1024;
+
+  // mix runs of repeated, regular and random data, roughly like capture contents
+  byte *data = AllocAlignedBuffer(dataSize);
+  for(size_t i = 0; i < dataSize; i++)
+  {
+    switch((i / 4096) % 3)
+    {
+      case 0: data[i] = 0x7c; break;
+      case 1: data[i] = byte(i & 0xff); break;
+      default: data[i] = byte(rand() & 0xff); break;
+    }
+  }
+
+  const double MB = double(dataSize) / (1024.0 * 1024.0);
+
+  for(bool zstd : {false, true})
+  {
+    for(uint64_t writeSize : {4 * 1024ULL, 64 * 1024ULL, 1024 * 1024ULL})
+    {
+      StreamWriter buf(StreamWriter::DefaultScratchSize);
+
+      PerformanceTimer timer;
+
+      {
+        Compressor *comp = zstd ? (Compressor *)new ZSTDCompressor(&buf, Ownership::Nothing)
+                                : (Compressor *)new LZ4Compressor(&buf, Ownership::Nothing);
+        StreamWriter writer(comp, Ownership::Stream);
+
+        for(uint64_t offs = 0; offs < dataSize; offs += writeSize)
+          writer.Write(data + offs, RDCMIN(writeSize, dataSize - offs));
+
+        writer.Finish();
+      }
+
+      double compressMS = timer.GetMilliseconds();
+
+      timer.Restart();
+
+      {
+        StreamReader compressed(buf.GetData(), buf.GetOffset());
+
+        Decompressor *decomp =
+            zstd ? (Decompressor *)new ZSTDDecompressor(&compressed, Ownership::Nothing)
+                 : (Decompressor *)new LZ4Decompressor(&compressed, Ownership::Nothing);
+        StreamReader reader(decomp, dataSize, Ownership::Stream);
+
+        byte *out = AllocAlignedBuffer(writeSize);
+        for(uint64_t offs = 0; offs < dataSize; offs += writeSize)
+          reader.Read(out, RDCMIN(writeSize, dataSize - offs));
+
+        CHECK(!reader.IsErrored());
+
+        FreeAlignedBuffer(out);
+      }
+
+      double decompressMS = timer.GetMilliseconds();
+
+      WARN(StringFormat::Fmt("%s with %llu byte writes: %.2f MB to %.2f MB. Compress %.2f MB/s, "
+                             "decompress %.2f MB/s",
+                             zstd ? "ZSTD" : "LZ4", writeSize, MB,
+                             double(buf.GetOffset()) / (1024.0 * 1024.0),
+                             MB / (compressMS / 1000.0), MB / (decompressMS / 1000.0))
+               .c_str());
+    }
+  }
+
+  FreeAlignedBuffer(data);
+}
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
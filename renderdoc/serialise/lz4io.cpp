@@ -157,6 +157,41 @@ bool LZ4Compressor::FlushPage0()
   return success;
 }
 
+LZ4ParallelCompressor::LZ4ParallelCompressor(StreamWriter *write, Ownership own,
+                                             uint32_t numThreads)
+    : ParallelCompressor(write, own, lz4BlockSize, LZ4_COMPRESSBOUND(lz4BlockSize), numThreads)
+{
+  m_States.resize(GetNumContexts());
+  for(byte *&state : m_States)
+    state = AllocAlignedBuffer(LZ4_sizeofState());
+}
+
+LZ4ParallelCompressor::~LZ4ParallelCompressor()
+{
+  StopWorkers();
+
+  for(byte *state : m_States)
+    FreeAlignedBuffer(state);
+}
+
+uint64_t LZ4ParallelCompressor::CompressBlock(uint32_t context, const byte *src, uint64_t srcSize,
+                                              byte *dst, RDResult &error)
+{
+  // each block is compressed with no history, which LZ4Decompressor handles the same as a block
+  // that happens to not reference the previous page.
+  const int dstCapacity = (int)LZ4_COMPRESSBOUND(lz4BlockSize);
+  int32_t compSize = LZ4_compress_fast_extState(m_States[context], (const char *)src, (char *)dst,
+                                                (int)srcSize, dstCapacity, 20);
+
+  if(compSize <= 0)
+  {
+    SET_ERROR_RESULT(error, ResultCode::CompressionFailed, "LZ4 compression failed: %i", compSize);
+    return 0;
+  }
+
+  return (uint64_t)compSize;
+}
+
 LZ4Decompressor::LZ4Decompressor(StreamReader *read, Ownership own) : Decompressor(read, own)
 {
   m_Page[0] = AllocAlignedBuffer(lz4BlockSize);
@@ -200,6 +235,16 @@ bool LZ4Decompressor::Recompress(Compressor *comp)
   return success;
 }
 
+void LZ4Decompressor::ResetBlock()
+{
+  // we can only be seeked if every block was compressed independently, so there's no history to
+  // preserve.
+  m_PageOffset = 0;
+  m_PageLength = 0;
+
+  LZ4_setStreamDecode(m_LZ4Decomp, NULL, 0);
+}
+
 bool LZ4Decompressor::Read(void *data, uint64_t numBytes)
 {
   // if we encountered a stream error this will be NULL
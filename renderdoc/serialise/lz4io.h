@@ -46,6 +46,22 @@ private:
   LZ4_stream_t *m_LZ4Comp;
 };
 
+// compresses blocks independently on worker threads. This gives up the 64kb of history that
+// LZ4Compressor keeps between blocks, in exchange for scaling across cores.
+class LZ4ParallelCompressor : public ParallelCompressor
+{
+public:
+  LZ4ParallelCompressor(StreamWriter *write, Ownership own, uint32_t numThreads);
+  ~LZ4ParallelCompressor();
+
+protected:
+  uint64_t CompressBlock(uint32_t context, const byte *src, uint64_t srcSize, byte *dst,
+                         RDResult &error);
+
+private:
+  rdcarray<byte *> m_States;
+};
+
 class LZ4Decompressor : public Decompressor
 {
 public:
@@ -55,6 +71,9 @@ public:
   bool Recompress(Compressor *comp);
   bool Read(void *data, uint64_t numBytes);
 
+protected:
+  void ResetBlock();
+
 private:
   bool FillPage0();
 
@@ -24,14 +24,36 @@
 
 #include "rdcfile.h"
 #include <errno.h>
+#include <algorithm>
 #include "api/replay/version.h"
 #include "common/dds_readwrite.h"
 #include "common/formatting.h"
+#include "common/threading.h"
+#include "core/settings.h"
+#include "md5/md5.h"
+#include "strings/string_utils.h"
+#include "serialiser.h"
 #include "jpeg-compressor/jpge.h"
 #include "stb/stb_image.h"
 #include "lz4io.h"
 #include "zstdio.h"
 
+RDOC_CONFIG(uint32_t, Capture_CompressionThreads, 0,
+            "The number of threads to use when compressing the frame capture section. 0 chooses "
+            "automatically based on the number of cores, and 1 compresses on the writing thread.");
+
+RDOC_CONFIG(uint32_t, Capture_MapSectionThreshold, 1024 * 1024,
+            "Uncompressed sections at least this many bytes large are memory-mapped when read, "
+            "instead of being read through a copy. 0 disables mapping.");
+
+RDOC_CONFIG(bool, Capture_StoreChunkIndex, false,
+            "Store an index of the frame capture's chunks in the capture file after it is first "
+            "loaded for replay, if it doesn't already have one.");
+
+RDOC_CONFIG(uint32_t, Capture_DecompressedCacheSizeMB, 0,
+            "If non-zero, compressed capture sections are decompressed into an on-disk cache of at "
+            "most this many megabytes, so that re-opening the same capture skips decompression.");
+
 // not provided by tinyexr, just do by hand
 bool is_exr_file(FILE *f)
 {
@@ -136,6 +158,11 @@ bool is_exr_file(FILE *f)
    }
  };
 
+ A binary section with type SectionType::Unknown and a name that is entirely NUL bytes is unused
+ space, left behind when a section was replaced by appending a new copy at the end of the file
+ instead of moving everything after it. It's skipped when loading and not written when the file is
+ rewritten, e.g. by converting it.
+
  // remainder of the file is tightly packed/unaligned section structures.
  // The first section must always be the actual frame capture data in
  // binary form, other sections can follow in any order
@@ -338,8 +365,10 @@ void RDCFile::Init(StreamReader &reader)
   m_SerVer = header.version;
 
   // in v1.1 we changed chunk flags such that we could support 64-bit length. This is a backwards
-  // compatible change
-  if(m_SerVer != SERIALISE_VERSION && m_SerVer != V1_0_VERSION && m_SerVer != V1_1_VERSION)
+  // compatible change. v1.2 added the capture timebase, and v1.3 added a chunk flag for callstacks
+  // stored by index, both also backwards compatible.
+  if(m_SerVer != SERIALISE_VERSION && m_SerVer != V1_0_VERSION && m_SerVer != V1_1_VERSION &&
+     m_SerVer != V1_2_VERSION)
   {
     if(header.version < V1_0_VERSION)
     {
@@ -637,8 +666,14 @@ void RDCFile::Init(StreamReader &reader)
       loc.dataOffset = reader.GetOffset();
       loc.diskLength = sectionHeader.sectionCompressedLength;
 
-      m_Sections.push_back(props);
-      m_SectionLocations.push_back(loc);
+      // skip over unused space from replaced sections
+      bool unused = props.type == SectionType::Unknown && props.name[0] == '\0';
+
+      if(!unused)
+      {
+        m_Sections.push_back(props);
+        m_SectionLocations.push_back(loc);
+      }
 
       reader.SkipBytes(loc.diskLength);
 
@@ -664,6 +699,8 @@ void RDCFile::Init(StreamReader &reader)
     return;
   }
 
+  LoadBlockIndex();
+
   int index = SectionIndex(SectionType::ExtendedThumbnail);
   if(index >= 0)
   {
@@ -689,6 +726,66 @@ void RDCFile::Init(StreamReader &reader)
   }
 }
 
+bool RDCFile::IsValidBlockIndex(const CompressedBlockIndex &index, const SectionProperties &props)
+{
+  if(index.blockSize == 0 || index.offsets.empty())
+    return false;
+
+  // there's always at least one block, and every block but the last is full
+  uint64_t numBlocks =
+      RDCMAX(uint64_t(1), (props.uncompressedSize + index.blockSize - 1) / index.blockSize);
+  if(index.offsets.size() != numBlocks)
+    return false;
+
+  for(size_t i = 0; i < index.offsets.size(); i++)
+  {
+    if(index.offsets[i] >= props.compressedSize)
+      return false;
+    if(i > 0 && index.offsets[i] <= index.offsets[i - 1])
+      return false;
+  }
+
+  return true;
+}
+
+void RDCFile::LoadBlockIndex()
+{
+  m_FrameBlockIndex = CompressedBlockIndex();
+
+  int index = SectionIndex(SectionType::BlockIndex);
+  if(index < 0 || m_Sections[index].version != BlockIndexVersion)
+    return;
+
+  const SectionProperties &frameProps = m_Sections[SectionIndex(SectionType::FrameCapture)];
+
+  StreamReader *reader = ReadSection(index);
+
+  uint64_t compressedSize = 0, uncompressedSize = 0, numBlocks = 0;
+  CompressedBlockIndex blockIndex;
+
+  reader->Read(compressedSize);
+  reader->Read(uncompressedSize);
+  reader->Read(blockIndex.blockSize);
+  reader->Read(numBlocks);
+
+  // the index is only valid if it matches the frame capture section as it is now
+  if(!reader->IsErrored() && compressedSize == frameProps.compressedSize &&
+     uncompressedSize == frameProps.uncompressedSize &&
+     numBlocks * sizeof(uint64_t) == reader->GetSize() - reader->GetOffset())
+  {
+    blockIndex.offsets.resize((size_t)numBlocks);
+    reader->Read(blockIndex.offsets.data(), blockIndex.offsets.byteSize());
+
+    if(!reader->IsErrored() && IsValidBlockIndex(blockIndex, frameProps))
+      m_FrameBlockIndex = blockIndex;
+  }
+
+  delete reader;
+
+  if(m_FrameBlockIndex.offsets.empty())
+    RDCWARN("Ignoring invalid or out of date frame capture block index");
+}
+
 RDResult RDCFile::CopyFileTo(const rdcstr &filename)
 {
   if(!m_File)
@@ -749,6 +846,34 @@ void RDCFile::Create(const rdcstr &filename)
 
   RDCDEBUG("Opened capture file for write");
 
+  {
+    StreamWriter writer(m_File, Ownership::Nothing);
+
+    WriteFileHeader(writer);
+
+    if(writer.IsErrored())
+    {
+      SET_ERROR_RESULT(m_Error, ResultCode::FileIOFailed, "Error writing file header");
+      return;
+    }
+  }
+
+  // re-open as read-only now.
+  FileIO::fclose(m_File);
+  m_File = FileIO::fopen(filename, FileIO::ReadBinary);
+
+  if(!m_File)
+  {
+    SET_ERROR_RESULT(m_Error, ResultCode::FileIOFailed,
+                     "Can't open capture file '%s' as read-only, errno %d", filename.c_str(), errno);
+    return;
+  }
+
+  FileIO::fseek64(m_File, 0, SEEK_END);
+}
+
+void RDCFile::WriteFileHeader(StreamWriter &writer)
+{
   FileHeader header;    // automagically initialised with correct data apart from length
 
   BinaryThumbnail thumbHeader = {0};
@@ -813,40 +938,126 @@ void RDCFile::Create(const rdcstr &filename)
   timeBase.timeBase = m_TimeBase;
   timeBase.timeFreq = m_TimeFrequency;
 
-  {
-    StreamWriter writer(m_File, Ownership::Nothing);
+  writer.Write(header);
+  writer.Write(&thumbHeader, offsetof(BinaryThumbnail, data));
+
+  if(thumbHeader.length > 0)
+    writer.Write(jpgPixels, thumbHeader.length);
 
-    writer.Write(header);
-    writer.Write(&thumbHeader, offsetof(BinaryThumbnail, data));
+  writer.Write(&meta, offsetof(CaptureMetaData, driverName));
 
-    if(thumbHeader.length > 0)
-      writer.Write(jpgPixels, thumbHeader.length);
+  writer.Write(m_DriverName.c_str(), meta.driverNameLength);
 
-    writer.Write(&meta, offsetof(CaptureMetaData, driverName));
+  writer.Write(timeBase);
+}
 
-    writer.Write(m_DriverName.c_str(), meta.driverNameLength);
+void RDCFile::CreateFromMemory(const rdcstr &filename)
+{
+  rdcarray<SectionProperties> sections;
+  rdcarray<bytebuf> sectionData;
+  sections.swap(m_Sections);
+  sectionData.swap(m_MemorySections);
 
-    writer.Write(timeBase);
+  Create(filename);
 
-    if(writer.IsErrored())
-    {
-      SET_ERROR_RESULT(m_Error, ResultCode::FileIOFailed, "Error writing file header");
+  for(size_t i = 0; i < sections.size() && i < sectionData.size(); i++)
+  {
+    if(m_Error != ResultCode::Succeeded)
       return;
-    }
-  }
 
-  // re-open as read-only now.
-  FileIO::fclose(m_File);
-  m_File = FileIO::fopen(filename, FileIO::ReadBinary);
+    StreamWriter *w = WriteSection(sections[i]);
 
-  if(!m_File)
+    w->Write(sectionData[i].data(), sectionData[i].size());
+
+    w->Finish();
+
+    if(w->IsErrored())
+      m_Error = w->GetError();
+
+    delete w;
+
+    // free each section as soon as it's written, the frame capture in particular can be large
+    bytebuf().swap(sectionData[i]);
+  }
+}
+
+void RDCFile::WriteToStream(StreamWriter &writer)
+{
+  if(m_File)
   {
-    SET_ERROR_RESULT(m_Error, ResultCode::FileIOFailed,
-                     "Can't open capture file '%s' as read-only, errno %d", filename.c_str(), errno);
+    RDCERR("Only captures built in memory can be written to a stream");
     return;
   }
 
-  FileIO::fseek64(m_File, 0, SEEK_END);
+  rdcarray<SectionProperties> sections;
+  rdcarray<bytebuf> sectionData;
+  sections.swap(m_Sections);
+  sectionData.swap(m_MemorySections);
+
+  WriteFileHeader(writer);
+
+  for(size_t i = 0; i < sections.size() && i < sectionData.size(); i++)
+  {
+    const SectionProperties &props = sections[i];
+
+    rdcstr name = props.name;
+    if(props.type != SectionType::Unknown && props.type < SectionType::Count)
+      name = ToStr(props.type);
+
+    // the stream can't be seeked back to fix up the header afterwards like a file, so compress
+    // the whole section first to know its length up front.
+    bytebuf compressed;
+    const bytebuf *data = &sectionData[i];
+
+    if(props.flags & (SectionFlags::LZ4Compressed | SectionFlags::ZstdCompressed))
+    {
+      StreamWriter memWriter(sectionData[i].size() / 2 + 1024);
+
+      Compressor *comp = NULL;
+      if(props.flags & SectionFlags::LZ4Compressed)
+        comp = new LZ4Compressor(&memWriter, Ownership::Nothing);
+      else
+        comp = new ZSTDCompressor(&memWriter, Ownership::Nothing);
+
+      {
+        StreamWriter compWriter(comp, Ownership::Stream);
+        compWriter.Write(sectionData[i].data(), sectionData[i].size());
+        compWriter.Finish();
+      }
+
+      compressed.assign(memWriter.GetData(), (size_t)memWriter.GetOffset());
+      data = &compressed;
+    }
+
+    BinarySectionHeader header = {// IsASCII
+                                  '\0',
+                                  // zero
+                                  {0, 0, 0},
+                                  // sectionType
+                                  props.type,
+                                  // sectionCompressedLength
+                                  data->size(),
+                                  // sectionUncompressedLength
+                                  sectionData[i].size(),
+                                  // sectionVersion
+                                  props.version,
+                                  // sectionFlags
+                                  props.flags,
+                                  // sectionNameLength
+                                  uint32_t(name.length() + 1)};
+
+    writer.Write(&header, offsetof(BinarySectionHeader, name));
+    writer.Write(name.c_str(), name.size() + 1);
+    writer.Write(data->data(), data->size());
+
+    bytebuf().swap(sectionData[i]);
+
+    if(writer.IsErrored())
+    {
+      m_Error = writer.GetError();
+      return;
+    }
+  }
 }
 
 int RDCFile::SectionIndex(SectionType type) const
@@ -894,6 +1105,35 @@ StreamReader *RDCFile::ReadSection(int index) const
     return new StreamReader(StreamReader::InvalidStream, res);
   }
 
+  const SectionProperties &props = m_Sections[index];
+  SectionLocation offsetSize = m_SectionLocations[index];
+
+  if(props.flags & (SectionFlags::LZ4Compressed | SectionFlags::ZstdCompressed))
+  {
+    if(Capture_DecompressedCacheSizeMB() > 0 &&
+       props.uncompressedSize <= uint64_t(Capture_DecompressedCacheSizeMB()) * 1024 * 1024)
+    {
+      StreamReader *cached = ReadCachedSection(index);
+      if(cached)
+        return cached;
+    }
+  }
+  else if(Capture_MapSectionThreshold() > 0 &&
+          offsetSize.diskLength >= Capture_MapSectionThreshold())
+  {
+    // large uncompressed sections can be read straight out of a mapping of the file with no copies
+    FileIO::MappedFileRegion region;
+    if(FileIO::MapFileRegion(m_File, offsetSize.dataOffset, offsetSize.diskLength, region))
+      return new StreamReader(region);
+
+    RDCWARN("Couldn't map section %d, falling back to reading it", index);
+  }
+
+  return OpenSectionReader(index);
+}
+
+StreamReader *RDCFile::OpenSectionReader(int index) const
+{
   const SectionProperties &props = m_Sections[index];
   SectionLocation offsetSize = m_SectionLocations[index];
   FileIO::fseek64(m_File, offsetSize.dataOffset, SEEK_SET);
@@ -902,23 +1142,172 @@ StreamReader *RDCFile::ReadSection(int index) const
 
   StreamReader *compReader = NULL;
 
+  Decompressor *decomp = NULL;
+
   if(props.flags & SectionFlags::LZ4Compressed)
-  {
-    // the user will delete the compressed reader, and then it will delete the compressor and the
-    // file reader
-    compReader = new StreamReader(new LZ4Decompressor(fileReader, Ownership::Stream),
-                                  props.uncompressedSize, Ownership::Stream);
-  }
+    decomp = new LZ4Decompressor(fileReader, Ownership::Stream);
   else if(props.flags & SectionFlags::ZstdCompressed)
+    decomp = new ZSTDDecompressor(fileReader, Ownership::Stream);
+
+  if(decomp)
   {
-    compReader = new StreamReader(new ZSTDDecompressor(fileReader, Ownership::Stream),
-                                  props.uncompressedSize, Ownership::Stream);
+    if(props.type == SectionType::FrameCapture && !m_FrameBlockIndex.offsets.empty())
+      decomp->SetBlockIndex(m_FrameBlockIndex);
+
+    // the user will delete the compressed reader, and then it will delete the decompressor and
+    // the file reader
+    compReader = new StreamReader(decomp, props.uncompressedSize, Ownership::Stream);
   }
 
   // if we're compressing return that writer, otherwise return the file writer directly
   return compReader ? compReader : fileReader;
 }
 
+rdcstr RDCFile::GetSectionCacheFilename(int index) const
+{
+  const SectionProperties &props = m_Sections[index];
+  const SectionLocation &loc = m_SectionLocations[index];
+
+  // hashing the whole compressed section would cost about as much as decompressing it, so the key
+  // is a fingerprint of the file and section layout plus the start and end of the section's data.
+  // Any change to the file that doesn't resize it still has to rewrite the section contents.
+  MD5_CTX md5ctx = {};
+  MD5_Init(&md5ctx);
+
+  uint64_t fileSize = FileIO::GetFileSize(m_Filename);
+  MD5_Update(&md5ctx, &fileSize, sizeof(fileSize));
+  MD5_Update(&md5ctx, &loc.dataOffset, sizeof(loc.dataOffset));
+  MD5_Update(&md5ctx, &loc.diskLength, sizeof(loc.diskLength));
+  MD5_Update(&md5ctx, &props.type, sizeof(props.type));
+  MD5_Update(&md5ctx, &props.flags, sizeof(props.flags));
+  MD5_Update(&md5ctx, &props.version, sizeof(props.version));
+  MD5_Update(&md5ctx, &props.uncompressedSize, sizeof(props.uncompressedSize));
+  MD5_Update(&md5ctx, props.name.c_str(), (unsigned long)props.name.size());
+
+  const uint64_t sampleSize = RDCMIN(loc.diskLength, uint64_t(64 * 1024));
+  bytebuf sample;
+  sample.resize((size_t)sampleSize);
+
+  FileIO::fseek64(m_File, loc.dataOffset, SEEK_SET);
+  FileIO::fread(sample.data(), 1, sample.size(), m_File);
+  MD5_Update(&md5ctx, sample.data(), (unsigned long)sample.size());
+
+  FileIO::fseek64(m_File, loc.dataOffset + loc.diskLength - sampleSize, SEEK_SET);
+  FileIO::fread(sample.data(), 1, sample.size(), m_File);
+  MD5_Update(&md5ctx, sample.data(), (unsigned long)sample.size());
+
+  byte hash[16];
+  MD5_Final(hash, &md5ctx);
+
+  rdcstr name;
+  for(byte b : hash)
+    name += StringFormat::Fmt("%02x", b);
+
+  return FileIO::GetAppFolderFilename(
+      StringFormat::Fmt("capturecache/%s_%d.bin", name.c_str(), index));
+}
+
+StreamReader *RDCFile::ReadCachedSection(int index) const
+{
+  const SectionProperties &props = m_Sections[index];
+
+  rdcstr cacheFilename = GetSectionCacheFilename(index);
+
+  if(!FileIO::exists(cacheFilename))
+  {
+    // decompress the section into a temporary file first, then move it into place so that other
+    // processes sharing the cache never see a partially written entry.
+    rdcstr tempFilename =
+        StringFormat::Fmt("%s.%u.tmp", cacheFilename.c_str(), Process::GetCurrentPID());
+
+    FileIO::CreateParentDirectory(tempFilename);
+
+    FILE *f = FileIO::fopen(tempFilename, FileIO::WriteBinary);
+    if(!f)
+    {
+      RDCWARN("Couldn't create capture cache entry %s", tempFilename.c_str());
+      return NULL;
+    }
+
+    bool success = false;
+    {
+      StreamReader *reader = OpenSectionReader(index);
+      StreamWriter writer(f, Ownership::Stream);
+
+      StreamTransfer(&writer, reader, NULL);
+
+      success = !reader->IsErrored() && !writer.IsErrored();
+
+      delete reader;
+    }
+
+    if(!success || !FileIO::Move(tempFilename, cacheFilename, true))
+    {
+      RDCWARN("Couldn't write capture cache entry %s", cacheFilename.c_str());
+      FileIO::Delete(tempFilename);
+      return NULL;
+    }
+
+    EvictSectionCache(cacheFilename);
+  }
+
+  if(FileIO::GetFileSize(cacheFilename) != props.uncompressedSize)
+  {
+    RDCWARN("Capture cache entry %s is corrupt, discarding", cacheFilename.c_str());
+    FileIO::Delete(cacheFilename);
+    return NULL;
+  }
+
+  FILE *f = FileIO::fopen(cacheFilename, FileIO::ReadBinary);
+  if(!f)
+    return NULL;
+
+  RDCLOG("Reading section %d from capture cache %s", index, cacheFilename.c_str());
+
+  FileIO::MappedFileRegion region;
+  if(FileIO::MapFileRegion(f, 0, props.uncompressedSize, region))
+  {
+    FileIO::fclose(f);
+    return new StreamReader(region);
+  }
+
+  return new StreamReader(f, props.uncompressedSize, Ownership::Stream);
+}
+
+void RDCFile::EvictSectionCache(const rdcstr &keepFilename)
+{
+  rdcstr cacheDir = get_dirname(keepFilename);
+  rdcstr keep = get_basename(keepFilename);
+
+  rdcarray<PathEntry> entries;
+  FileIO::GetFilesInDirectory(cacheDir, entries);
+
+  uint64_t totalSize = 0;
+  for(const PathEntry &e : entries)
+    totalSize += e.size;
+
+  const uint64_t limit = uint64_t(Capture_DecompressedCacheSizeMB()) * 1024 * 1024;
+
+  if(totalSize <= limit)
+    return;
+
+  // evict the oldest entries first, never the one we just added
+  std::sort(entries.begin(), entries.end(),
+            [](const PathEntry &a, const PathEntry &b) { return a.lastmod < b.lastmod; });
+
+  for(const PathEntry &e : entries)
+  {
+    if(totalSize <= limit)
+      break;
+
+    if(e.filename == keep || (e.flags & PathProperty::Directory))
+      continue;
+
+    FileIO::Delete(cacheDir + "/" + e.filename);
+    totalSize -= e.size;
+  }
+}
+
 StreamWriter *RDCFile::WriteSection(const SectionProperties &props)
 {
   if(m_Error != ResultCode::Succeeded)
@@ -1033,6 +1422,21 @@ StreamWriter *RDCFile::WriteSection(const SectionProperties &props)
         origSections.erase(0);
         origSectionLocations.erase(0);
 
+        // any block or chunk index for the old frame capture is no longer valid, they will be
+        // re-written for the new one.
+        for(size_t i = 0; i < origSections.size();)
+        {
+          if(origSections[i].type == SectionType::BlockIndex ||
+             origSections[i].type == SectionType::ChunkIndex)
+          {
+            origSections.erase(i);
+            origSectionLocations.erase(i);
+            continue;
+          }
+
+          i++;
+        }
+
         rdcstr tempFilename = FileIO::GetTempFolderFilename() + "capture_rewrite.rdc";
 
         // create the file, this will overwrite m_File with the new file and file header using the
@@ -1114,80 +1518,141 @@ StreamWriter *RDCFile::WriteSection(const SectionProperties &props)
 
       RDCASSERT(index >= 0);
 
-      rdcarray<bytebuf> origSectionData;
-      rdcarray<uint64_t> origHeaderSizes;
+      const SectionLocation &oldLoc = m_SectionLocations[index];
+      const uint64_t oldSize = oldLoc.dataOffset + oldLoc.diskLength - oldLoc.headerOffset;
 
-      uint64_t overwriteLocation = m_SectionLocations[index].headerOffset;
-      uint64_t oldLength = m_SectionLocations[index].diskLength;
+      uint64_t followingSize = 0;
+      for(int i = index + 1; i < NumSections(); i++)
+        followingSize += m_SectionLocations[i].dataOffset + m_SectionLocations[i].diskLength -
+                         m_SectionLocations[i].headerOffset;
 
-      // erase the target section. The others will be moved up to match
-      m_Sections.erase(index);
-      m_SectionLocations.erase(index);
+      // if there's more after this section than in it, e.g. the block index of a large capture,
+      // it's cheaper to leave the old section as unused space and append the new one than to move
+      // everything after it. ASCII sections have no room to mark them as unused.
+      if(followingSize > oldSize && !(m_Sections[index].flags & SectionFlags::ASCIIStored))
+      {
+        if(!MarkSectionUnused(index))
+          return new StreamWriter(StreamWriter::InvalidStream);
 
-      origSectionData.reserve(NumSections() - index);
-      origHeaderSizes.reserve(NumSections() - index);
+        m_Sections.erase(index);
+        m_SectionLocations.erase(index);
 
-      // go through all subsequent sections after this one in the file, read them into memory.
-      // this could be optimised since we're going to write them back out below, we could do this
-      // just with an in-memory window large enough.
-      for(int i = index; i < NumSections(); i++)
+        FileIO::fseek64(m_File, 0, SEEK_END);
+      }
+      else
       {
-        const SectionLocation &loc = m_SectionLocations[i];
+        ReplaceSectionInPlace(index, modifySectionCallback);
+      }
+
+      // fall through - we now write to m_File with the new section wherever we left off
+    }
+  }
+  else
+  {
+    // we're adding a new section - seek to the end of the file to append it
+    FileIO::fseek64(m_File, 0, SEEK_END);
+  }
+
+  return WriteSectionHeader(props, type, name, modifySectionCallback);
+}
 
-        FileIO::fseek64(m_File, loc.headerOffset, SEEK_SET);
+bool RDCFile::MarkSectionUnused(int index)
+{
+  const SectionLocation &loc = m_SectionLocations[index];
 
-        uint64_t headerLen = loc.dataOffset - loc.headerOffset;
+  const uint64_t nameOffset = loc.headerOffset + offsetof(BinarySectionHeader, name);
 
-        // read header and data together
-        StreamReader reader(m_File, headerLen + loc.diskLength, Ownership::Nothing);
+  SectionType unknown = SectionType::Unknown;
+  bytebuf zeroName;
+  zeroName.resize((size_t)(loc.dataOffset - nameOffset));
 
-        origHeaderSizes.push_back(headerLen);
-        origSectionData.push_back(bytebuf());
+  FileIO::fseek64(m_File, loc.headerOffset + offsetof(BinarySectionHeader, sectionType), SEEK_SET);
+  size_t numWritten = FileIO::fwrite(&unknown, 1, sizeof(unknown), m_File);
 
-        bytebuf &data = origSectionData.back();
-        data.resize((size_t)reader.GetSize());
-        reader.Read(data.data(), data.size());
-      }
+  FileIO::fseek64(m_File, nameOffset, SEEK_SET);
+  numWritten += FileIO::fwrite(zeroName.data(), 1, zeroName.size(), m_File);
 
-      // we write the sections now over where the old section used to be, so the newly written
-      // section is last in the file. This means if the same section is updated over and over, it
-      // doesn't require moving any sections once it's already at the end.
+  if(numWritten != sizeof(unknown) + zeroName.size())
+  {
+    SET_ERROR_RESULT(m_Error, ResultCode::FileIOFailed, "Error marking old section unused: %s",
+                     FileIO::ErrorString().c_str());
+    return false;
+  }
 
-      // seek to write to where the removed section started
-      FileIO::fseek64(m_File, overwriteLocation, SEEK_SET);
+  return true;
+}
 
-      // write the old sections
-      for(size_t i = 0; i < origSectionData.size(); i++)
-      {
-        // update the offsets to where they are in the new file
-        m_SectionLocations[index + i].headerOffset = FileIO::ftell64(m_File);
-        m_SectionLocations[index + i].dataOffset =
-            m_SectionLocations[index + i].headerOffset + origHeaderSizes[i];
-
-        // write the data
-        StreamWriter writer(m_File, Ownership::Nothing);
-        writer.Write(origSectionData[i].data(), origSectionData[i].size());
-      }
+void RDCFile::ReplaceSectionInPlace(int index, StreamCloseCallback &modifySectionCallback)
+{
+  rdcarray<bytebuf> origSectionData;
+  rdcarray<uint64_t> origHeaderSizes;
 
-      // after writing, we need to be sure to fixup the size (in case we wrote less data).
-      modifySectionCallback = [this, oldLength]() {
-        if(oldLength > m_SectionLocations.back().diskLength)
-        {
-          FileIO::ftruncateat(
-              m_File, m_SectionLocations.back().dataOffset + m_SectionLocations.back().diskLength);
-        }
-      };
+  uint64_t overwriteLocation = m_SectionLocations[index].headerOffset;
+  uint64_t oldLength = m_SectionLocations[index].diskLength;
 
-      // fall through - we now write to m_File with the new section wherever we left off after the
-      // moved sections.
-    }
+  // erase the target section. The others will be moved up to match
+  m_Sections.erase(index);
+  m_SectionLocations.erase(index);
+
+  origSectionData.reserve(NumSections() - index);
+  origHeaderSizes.reserve(NumSections() - index);
+
+  // go through all subsequent sections after this one in the file, read them into memory.
+  // this could be optimised since we're going to write them back out below, we could do this
+  // just with an in-memory window large enough.
+  for(int i = index; i < NumSections(); i++)
+  {
+    const SectionLocation &loc = m_SectionLocations[i];
+
+    FileIO::fseek64(m_File, loc.headerOffset, SEEK_SET);
+
+    uint64_t headerLen = loc.dataOffset - loc.headerOffset;
+
+    // read header and data together
+    StreamReader reader(m_File, headerLen + loc.diskLength, Ownership::Nothing);
+
+    origHeaderSizes.push_back(headerLen);
+    origSectionData.push_back(bytebuf());
+
+    bytebuf &data = origSectionData.back();
+    data.resize((size_t)reader.GetSize());
+    reader.Read(data.data(), data.size());
   }
-  else
+
+  // we write the sections now over where the old section used to be, so the newly written
+  // section is last in the file. This means if the same section is updated over and over, it
+  // doesn't require moving any sections once it's already at the end.
+
+  // seek to write to where the removed section started
+  FileIO::fseek64(m_File, overwriteLocation, SEEK_SET);
+
+  // write the old sections
+  for(size_t i = 0; i < origSectionData.size(); i++)
   {
-    // we're adding a new section - seek to the end of the file to append it
-    FileIO::fseek64(m_File, 0, SEEK_END);
+    // update the offsets to where they are in the new file
+    m_SectionLocations[index + i].headerOffset = FileIO::ftell64(m_File);
+    m_SectionLocations[index + i].dataOffset =
+        m_SectionLocations[index + i].headerOffset + origHeaderSizes[i];
+
+    // write the data
+    StreamWriter writer(m_File, Ownership::Nothing);
+    writer.Write(origSectionData[i].data(), origSectionData[i].size());
   }
 
+  // after writing, we need to be sure to fixup the size (in case we wrote less data).
+  modifySectionCallback = [this, oldLength]() {
+    if(oldLength > m_SectionLocations.back().diskLength)
+    {
+      FileIO::ftruncateat(
+          m_File, m_SectionLocations.back().dataOffset + m_SectionLocations.back().diskLength);
+    }
+  };
+}
+
+StreamWriter *RDCFile::WriteSectionHeader(const SectionProperties &props, SectionType type,
+                                          const rdcstr &name,
+                                          StreamCloseCallback modifySectionCallback)
+{
   uint64_t headerOffset = FileIO::ftell64(m_File);
 
   size_t numWritten;
@@ -1226,17 +1691,36 @@ StreamWriter *RDCFile::WriteSection(const SectionProperties &props)
 
   StreamWriter *compWriter = NULL;
 
+  // the frame capture is by far the largest section so compress it in parallel if we can. The
+  // blocks are compressed independently so the ratio is slightly worse for LZ4, but the on-disk
+  // format is unchanged.
+  uint32_t numThreads = 1;
+  if(type == SectionType::FrameCapture)
+  {
+    numThreads = Capture_CompressionThreads();
+    if(numThreads == 0)
+      numThreads = Threading::WorkerPool::DefaultThreadCount();
+  }
+
+  Compressor *comp = NULL;
+
   if(props.flags & SectionFlags::LZ4Compressed)
   {
     // the user will delete the compressed writer, and then it will delete the compressor and the
     // file writer
-    compWriter =
-        new StreamWriter(new LZ4Compressor(fileWriter, Ownership::Stream), Ownership::Stream);
+    if(numThreads > 1)
+      comp = new LZ4ParallelCompressor(fileWriter, Ownership::Stream, numThreads);
+    else
+      comp = new LZ4Compressor(fileWriter, Ownership::Stream);
+    compWriter = new StreamWriter(comp, Ownership::Stream);
   }
   else if(props.flags & SectionFlags::ZstdCompressed)
   {
-    compWriter =
-        new StreamWriter(new ZSTDCompressor(fileWriter, Ownership::Stream), Ownership::Stream);
+    if(numThreads > 1)
+      comp = new ZSTDParallelCompressor(fileWriter, Ownership::Stream, numThreads);
+    else
+      comp = new ZSTDCompressor(fileWriter, Ownership::Stream);
+    compWriter = new StreamWriter(comp, Ownership::Stream);
   }
 
   uint64_t dataOffset = FileIO::ftell64(m_File);
@@ -1303,10 +1787,264 @@ StreamWriter *RDCFile::WriteSection(const SectionProperties &props)
     FileIO::fseek64(m_File, prevPos, SEEK_SET);
   });
 
+  // if the frame capture was compressed as independent blocks, write out an index of them as a
+  // separate section so that it can be seeked into without decompressing from the start. This is
+  // done last, once the frame capture section is completely done with. The compressor itself is
+  // being destroyed at this point but the index is in the base class which is still valid.
+  if(type == SectionType::FrameCapture && comp)
+  {
+    fileWriter->AddCloseCallback([this, comp]() {
+      m_FrameBlockIndex = CompressedBlockIndex();
+
+      const CompressedBlockIndex &index = comp->GetBlockIndex();
+
+      if(m_Error != ResultCode::Succeeded || !IsValidBlockIndex(index, m_Sections[0]))
+        return;
+
+      SectionProperties indexProps;
+      indexProps.type = SectionType::BlockIndex;
+      indexProps.version = BlockIndexVersion;
+
+      StreamWriter *w = WriteSection(indexProps);
+
+      w->Write(m_Sections[0].compressedSize);
+      w->Write(m_Sections[0].uncompressedSize);
+      w->Write(index.blockSize);
+      w->Write((uint64_t)index.offsets.size());
+      w->Write(index.offsets.data(), index.offsets.byteSize());
+
+      delete w;
+
+      m_FrameBlockIndex = index;
+    });
+  }
+
   // if we're compressing return that writer, otherwise return the file writer directly
   return compWriter ? compWriter : fileWriter;
 }
 
+bool RDCFile::ReadChunkIndex(rdcarray<ChunkIndexEntry> &index) const
+{
+  index.clear();
+
+  int sectionIdx = SectionIndex(SectionType::ChunkIndex);
+  int frameIdx = SectionIndex(SectionType::FrameCapture);
+  if(sectionIdx < 0 || frameIdx < 0 || m_Sections[sectionIdx].version != ChunkIndexVersion)
+    return false;
+
+  StreamReader *reader = ReadSection(sectionIdx);
+
+  uint64_t uncompressedSize = 0, numChunks = 0;
+  reader->Read(uncompressedSize);
+  reader->Read(numChunks);
+
+  bool valid = !reader->IsErrored() &&
+               uncompressedSize == m_Sections[frameIdx].uncompressedSize &&
+               numChunks * sizeof(ChunkIndexEntry) == reader->GetSize() - reader->GetOffset();
+
+  if(valid)
+  {
+    index.resize((size_t)numChunks);
+    reader->Read(index.data(), index.byteSize());
+
+    valid = !reader->IsErrored();
+
+    // chunks must be in order and lie within the frame capture
+    for(size_t i = 0; valid && i < index.size(); i++)
+    {
+      valid = index[i].offset + index[i].length <= uncompressedSize &&
+              (i == 0 || index[i].offset >= index[i - 1].offset + index[i - 1].length);
+    }
+  }
+
+  delete reader;
+
+  if(!valid)
+  {
+    RDCWARN("Chunk index doesn't match frame capture, ignoring");
+    index.clear();
+  }
+
+  return valid;
+}
+
+void RDCFile::WriteChunkIndex(const rdcarray<ChunkIndexEntry> &index)
+{
+  int frameIdx = SectionIndex(SectionType::FrameCapture);
+  if(frameIdx < 0)
+    return;
+
+  SectionProperties props;
+  props.type = SectionType::ChunkIndex;
+  props.version = ChunkIndexVersion;
+  props.flags = SectionFlags::ZstdCompressed;
+
+  StreamWriter *w = WriteSection(props);
+
+  w->Write(m_Sections[frameIdx].uncompressedSize);
+  w->Write((uint64_t)index.size());
+  w->Write(index.data(), index.byteSize());
+
+  delete w;
+}
+
+bool RDCFile::ReadCallstackTable(rdcarray<rdcarray<uint64_t>> &table) const
+{
+  table.clear();
+
+  int sectionIdx = SectionIndex(SectionType::CallstackTable);
+  if(sectionIdx < 0 || m_Sections[sectionIdx].version != CallstackTableVersion)
+    return false;
+
+  StreamReader *reader = ReadSection(sectionIdx);
+
+  uint32_t numCallstacks = 0;
+  reader->Read(numCallstacks);
+
+  // each callstack takes at least 4 bytes, use that to sanity check the count
+  bool valid = !reader->IsErrored() &&
+               numCallstacks <= (reader->GetSize() - reader->GetOffset()) / sizeof(uint32_t);
+
+  if(valid)
+  {
+    table.resize(numCallstacks);
+
+    for(size_t i = 0; valid && i < table.size(); i++)
+    {
+      uint32_t numLevels = 0;
+      reader->Read(numLevels);
+
+      valid = !reader->IsErrored() &&
+              numLevels <= (reader->GetSize() - reader->GetOffset()) / sizeof(uint64_t);
+
+      if(valid)
+      {
+        table[i].resize(numLevels);
+        reader->Read(table[i].data(), table[i].byteSize());
+      }
+    }
+
+    valid = valid && !reader->IsErrored();
+  }
+
+  delete reader;
+
+  if(!valid)
+  {
+    RDCERR("Callstack table is corrupted, callstacks will not be available");
+    table.clear();
+  }
+
+  return valid;
+}
+
+void RDCFile::WriteCallstackTable(const rdcarray<rdcarray<uint64_t>> &table)
+{
+  SectionProperties props;
+  props.type = SectionType::CallstackTable;
+  props.version = CallstackTableVersion;
+  props.flags = SectionFlags::ZstdCompressed;
+
+  StreamWriter *w = WriteSection(props);
+
+  w->Write((uint32_t)table.size());
+  for(const rdcarray<uint64_t> &callstack : table)
+  {
+    w->Write((uint32_t)callstack.size());
+    w->Write(callstack.data(), callstack.byteSize());
+  }
+
+  w->Finish();
+
+  delete w;
+}
+
+void ChunkStatistics::Add(const Chunk *chunk)
+{
+  SDChunkMetaData metadata = chunk->GetMetadata();
+
+  TypeStatistics &stats = m_Types[metadata.chunkID];
+
+  stats.count++;
+  stats.bytes += chunk->GetLength();
+  if(metadata.durationMicro >= 0)
+    stats.durations.push_back(metadata.durationMicro);
+}
+
+void ChunkStatistics::Write(RDCFile *rdc, rdcstr (*chunkName)(uint32_t)) const
+{
+  if(m_Types.empty())
+    return;
+
+  rdcstr json = ToJSON(chunkName, rdc->GetTimestampFrequency());
+
+  SectionProperties props;
+  props.type = SectionType::ChunkStatistics;
+  props.version = 1;
+  props.flags = SectionFlags::ZstdCompressed;
+
+  StreamWriter *w = rdc->WriteSection(props);
+
+  w->Write(json.data(), json.size());
+
+  w->Finish();
+
+  delete w;
+}
+
+rdcstr ChunkStatistics::ToJSON(rdcstr (*chunkName)(uint32_t), double ticksPerMicrosecond) const
+{
+  rdcstr ret = "{\n  \"version\": 1,\n  \"chunks\": [";
+
+  bool first = true;
+
+  for(auto it = m_Types.begin(); it != m_Types.end(); ++it)
+  {
+    const TypeStatistics &stats = it->second;
+
+    rdcarray<int64_t> durations = stats.durations;
+    std::sort(durations.begin(), durations.end());
+
+    double minimum = 0.0, mean = 0.0, p99 = 0.0, maximum = 0.0;
+
+    if(!durations.empty())
+    {
+      double total = 0.0;
+      for(int64_t d : durations)
+        total += double(d);
+
+      size_t p99Index = (durations.size() * 99 + 99) / 100 - 1;
+
+      minimum = double(durations.front()) / ticksPerMicrosecond;
+      mean = total / double(durations.size()) / ticksPerMicrosecond;
+      p99 = double(durations[p99Index]) / ticksPerMicrosecond;
+      maximum = double(durations.back()) / ticksPerMicrosecond;
+    }
+
+    // chunk names are identifiers, but escape anything that would break the string
+    rdcstr name;
+    for(char c : chunkName(it->first))
+    {
+      if(c == '"' || c == '\\')
+        name.push_back('\\');
+      name.push_back(c);
+    }
+
+    ret += StringFormat::Fmt(
+        "%s\n    {\"chunk\": %u, \"name\": \"%s\", \"count\": %u, \"bytes\": %llu, "
+        "\"minDurationMicro\": %.3f, \"meanDurationMicro\": %.3f, \"p99DurationMicro\": %.3f, "
+        "\"maxDurationMicro\": %.3f}",
+        first ? "" : ",", it->first, name.c_str(), stats.count, stats.bytes, minimum, mean, p99,
+        maximum);
+
+    first = false;
+  }
+
+  ret += "\n  ]\n}\n";
+
+  return ret;
+}
+
 FILE *RDCFile::StealImageFileHandle(rdcstr &filename)
 {
   if(m_Driver != RDCDriver::Image)
@@ -1321,3 +2059,322 @@ FILE *RDCFile::StealImageFileHandle(rdcstr &filename)
   m_File = NULL;
   return ret;
 }
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "catch/catch.hpp"
+
+static void WriteTestSection(RDCFile &rdc, SectionType type, const rdcstr &name,
+                             const bytebuf &data)
+{
+  SectionProperties props;
+  props.type = type;
+  props.name = name;
+
+  StreamWriter *w = rdc.WriteSection(props);
+  w->Write(data.data(), data.size());
+  delete w;
+}
+
+static bytebuf ReadTestSection(RDCFile &rdc, int idx)
+{
+  bytebuf ret;
+  ret.resize((size_t)rdc.GetSectionProperties(idx).uncompressedSize);
+
+  StreamReader *reader = rdc.ReadSection(idx);
+  reader->Read(ret.data(), ret.size());
+  CHECK_FALSE(reader->IsErrored());
+  delete reader;
+
+  return ret;
+}
+
+TEST_CASE("Write capture file built in memory", "[rdcfile]")
+{
+  rdcstr filename = FileIO::GetTempFolderFilename() + "renderdoc_rdcfile_memory_test.rdc";
+
+  rdcarray<uint32_t> frameData;
+  frameData.resize(256 * 1024);
+  for(size_t i = 0; i < frameData.size(); i++)
+    frameData[i] = uint32_t(i * 7);
+
+  {
+    RDCFile rdc;
+    rdc.SetData(RDCDriver::Vulkan, "Vulkan", 0, NULL, 0, 1.0);
+
+    SectionProperties props;
+    props.type = SectionType::FrameCapture;
+    props.flags = SectionFlags::LZ4Compressed;
+    props.version = 5;
+
+    StreamWriter *w = rdc.WriteSection(props);
+    w->Write(frameData.data(), frameData.byteSize());
+    delete w;
+
+    props = SectionProperties();
+    props.type = SectionType::Notes;
+    props.version = 1;
+
+    w = rdc.WriteSection(props);
+    w->Write("notes", 5);
+    delete w;
+
+    CHECK_FALSE(rdc.IsFileBacked());
+
+    rdc.CreateFromMemory(filename);
+
+    REQUIRE(rdc.Error().code == ResultCode::Succeeded);
+    CHECK(rdc.IsFileBacked());
+  }
+
+  {
+    RDCFile rdc;
+    rdc.Open(filename);
+
+    REQUIRE(rdc.Error().code == ResultCode::Succeeded);
+    CHECK(rdc.GetDriver() == RDCDriver::Vulkan);
+
+    int idx = rdc.SectionIndex(SectionType::FrameCapture);
+    REQUIRE(idx == 0);
+    CHECK(rdc.GetSectionProperties(idx).version == 5);
+    CHECK(rdc.GetSectionProperties(idx).flags == SectionFlags::LZ4Compressed);
+    CHECK(rdc.GetSectionProperties(idx).uncompressedSize == frameData.byteSize());
+
+    rdcarray<uint32_t> readData;
+    readData.resize(frameData.size());
+
+    StreamReader *reader = rdc.ReadSection(idx);
+    reader->Read(readData.data(), readData.byteSize());
+    CHECK_FALSE(reader->IsErrored());
+    delete reader;
+
+    CHECK(readData == frameData);
+
+    CHECK(rdc.SectionIndex(SectionType::Notes) == 1);
+  }
+
+  FileIO::Delete(filename);
+};
+
+TEST_CASE("Write capture file built in memory to a stream", "[rdcfile]")
+{
+  bytebuf frameData;
+  frameData.resize(256 * 1024);
+  for(size_t i = 0; i < frameData.size(); i++)
+    frameData[i] = byte((i * 7) & 0x3f);
+
+  const bytebuf notes = {'n', 'o', 't', 'e', 's'};
+
+  StreamWriter stream(StreamWriter::DefaultScratchSize);
+
+  {
+    RDCFile rdc;
+    rdc.SetData(RDCDriver::Vulkan, "Vulkan", 0, NULL, 0, 1.0);
+
+    SectionProperties props;
+    props.type = SectionType::FrameCapture;
+    props.flags = SectionFlags::ZstdCompressed;
+    props.version = 5;
+
+    StreamWriter *w = rdc.WriteSection(props);
+    w->Write(frameData.data(), frameData.size());
+    delete w;
+
+    props = SectionProperties();
+    props.type = SectionType::Notes;
+
+    w = rdc.WriteSection(props);
+    w->Write(notes.data(), notes.size());
+    delete w;
+
+    rdc.WriteToStream(stream);
+
+    REQUIRE(rdc.Error().code == ResultCode::Succeeded);
+  }
+
+  // sections can only be read back from a file
+  rdcstr filename = FileIO::GetTempFolderFilename() + "renderdoc_rdcfile_stream_test.rdc";
+  FileIO::WriteAll(filename, stream.GetData(), (size_t)stream.GetOffset());
+
+  {
+    RDCFile rdc;
+    rdc.Open(filename);
+
+    REQUIRE(rdc.Error().code == ResultCode::Succeeded);
+    CHECK(rdc.GetDriver() == RDCDriver::Vulkan);
+    REQUIRE(rdc.NumSections() == 2);
+
+    CHECK(rdc.GetSectionProperties(0).type == SectionType::FrameCapture);
+    CHECK(rdc.GetSectionProperties(0).version == 5);
+    CHECK(rdc.GetSectionProperties(0).flags == SectionFlags::ZstdCompressed);
+    CHECK(rdc.GetSectionProperties(0).compressedSize < frameData.size());
+    CHECK(rdc.GetSectionProperties(1).name == ToStr(SectionType::Notes));
+
+    CHECK(ReadTestSection(rdc, 0) == frameData);
+    CHECK(ReadTestSection(rdc, 1) == notes);
+  }
+
+  FileIO::Delete(filename);
+};
+
+TEST_CASE("Replace sections in an existing capture file", "[rdcfile]")
+{
+  rdcstr filename = FileIO::GetTempFolderFilename() + "renderdoc_rdcfile_replace_test.rdc";
+
+  bytebuf frameData, bigData;
+  frameData.resize(64 * 1024);
+  bigData.resize(256 * 1024);
+  for(size_t i = 0; i < frameData.size(); i++)
+    frameData[i] = byte(i * 7);
+  for(size_t i = 0; i < bigData.size(); i++)
+    bigData[i] = byte(i * 13);
+
+  const bytebuf oldNotes = {'o', 'l', 'd'};
+  const bytebuf newNotes = {'n', 'e', 'w', ' ', 'n', 'o', 't', 'e', 's'};
+
+  {
+    RDCFile rdc;
+    rdc.SetData(RDCDriver::Vulkan, "Vulkan", 0, NULL, 0, 1.0);
+    rdc.Create(filename);
+
+    WriteTestSection(rdc, SectionType::FrameCapture, "", frameData);
+    WriteTestSection(rdc, SectionType::Notes, "", oldNotes);
+    WriteTestSection(rdc, SectionType::Unknown, "test.big", bigData);
+
+    REQUIRE(rdc.Error().code == ResultCode::Succeeded);
+  }
+
+  uint64_t origSize = FileIO::GetFileSize(filename);
+
+  SECTION("replacing a section before a larger one appends it")
+  {
+    {
+      RDCFile rdc;
+      rdc.Open(filename);
+      REQUIRE(rdc.Error().code == ResultCode::Succeeded);
+
+      WriteTestSection(rdc, SectionType::Notes, "", newNotes);
+
+      REQUIRE(rdc.Error().code == ResultCode::Succeeded);
+      CHECK(rdc.NumSections() == 3);
+      CHECK(rdc.SectionIndex(SectionType::Notes) == 2);
+    }
+
+    // the big section wasn't moved, the file only grew by the new section
+    CHECK(FileIO::GetFileSize(filename) > origSize);
+    CHECK(FileIO::GetFileSize(filename) < origSize + 1024);
+
+    RDCFile rdc;
+    rdc.Open(filename);
+    REQUIRE(rdc.Error().code == ResultCode::Succeeded);
+
+    // the old section is skipped on load
+    REQUIRE(rdc.NumSections() == 3);
+    CHECK(ReadTestSection(rdc, 0) == frameData);
+    CHECK(ReadTestSection(rdc, rdc.SectionIndex("test.big")) == bigData);
+    CHECK(ReadTestSection(rdc, rdc.SectionIndex(SectionType::Notes)) == newNotes);
+
+    // replacing the last section again overwrites it where it is
+    WriteTestSection(rdc, SectionType::Notes, "", oldNotes);
+    REQUIRE(rdc.Error().code == ResultCode::Succeeded);
+    CHECK(rdc.NumSections() == 3);
+    CHECK(ReadTestSection(rdc, rdc.SectionIndex(SectionType::Notes)) == oldNotes);
+  };
+
+  SECTION("replacing a section before a smaller one moves the smaller one")
+  {
+    {
+      RDCFile rdc;
+      rdc.Open(filename);
+      REQUIRE(rdc.Error().code == ResultCode::Succeeded);
+
+      WriteTestSection(rdc, SectionType::Unknown, "test.small", oldNotes);
+      WriteTestSection(rdc, SectionType::Unknown, "test.big", newNotes);
+
+      REQUIRE(rdc.Error().code == ResultCode::Succeeded);
+    }
+
+    // the big section's space was reclaimed
+    CHECK(FileIO::GetFileSize(filename) < origSize);
+
+    RDCFile rdc;
+    rdc.Open(filename);
+    REQUIRE(rdc.Error().code == ResultCode::Succeeded);
+
+    REQUIRE(rdc.NumSections() == 4);
+    CHECK(rdc.SectionIndex("test.small") == 2);
+    CHECK(rdc.SectionIndex("test.big") == 3);
+    CHECK(ReadTestSection(rdc, 0) == frameData);
+    CHECK(ReadTestSection(rdc, rdc.SectionIndex(SectionType::Notes)) == oldNotes);
+    CHECK(ReadTestSection(rdc, rdc.SectionIndex("test.small")) == oldNotes);
+    CHECK(ReadTestSection(rdc, rdc.SectionIndex("test.big")) == newNotes);
+  };
+
+  FileIO::Delete(filename);
+};
+
+static rdcstr TestChunkName(uint32_t idx)
+{
+  return idx == 5 ? "Draw" : "Quoted\"Name";
+}
+
+TEST_CASE("Aggregate chunk statistics", "[rdcfile]")
+{
+  WriteSerialiser ser(new StreamWriter(StreamWriter::DefaultScratchSize), Ownership::Stream);
+
+  ser.SetChunkMetadataRecording(WriteSerialiser::ChunkCallstack | WriteSerialiser::ChunkDuration |
+                                WriteSerialiser::ChunkThreadID);
+
+  ChunkStatistics stats;
+
+  uint32_t dummy = 99;
+  uint64_t drawBytes = 0;
+
+  // durations of 10, 20, ... 1000 ticks, so the 99th percentile is 990
+  for(int64_t i = 1; i <= 100; i++)
+  {
+    ser.ChunkMetadata().durationMicro = i * 10;
+    ser.ChunkMetadata().callstack = {101, 102, 103};
+
+    ser.WriteChunk(5);
+    ser.Serialise("dummy"_lit, dummy);
+    ser.EndChunk();
+
+    Chunk *c = Chunk::Create(ser, 5);
+
+    SDChunkMetaData metadata = c->GetMetadata();
+    CHECK(metadata.chunkID == 5);
+    CHECK(metadata.durationMicro == i * 10);
+    CHECK(metadata.length == sizeof(uint32_t));
+
+    drawBytes += c->GetLength();
+    stats.Add(c);
+    c->Delete();
+  }
+
+  ser.ChunkMetadata().durationMicro = 40;
+
+  ser.WriteChunk(7);
+  ser.EndChunk();
+
+  Chunk *c = Chunk::Create(ser, 7);
+  uint64_t otherBytes = c->GetLength();
+  stats.Add(c);
+  c->Delete();
+
+  // 10 ticks per microsecond
+  rdcstr json = stats.ToJSON(&TestChunkName, 10.0);
+
+  CHECK(json.contains(StringFormat::Fmt(
+      "{\"chunk\": 5, \"name\": \"Draw\", \"count\": 100, \"bytes\": %llu, "
+      "\"minDurationMicro\": 1.000, \"meanDurationMicro\": 50.500, \"p99DurationMicro\": 99.000, "
+      "\"maxDurationMicro\": 100.000}",
+      drawBytes)));
+  CHECK(json.contains(StringFormat::Fmt(
+      "{\"chunk\": 7, \"name\": \"Quoted\\\"Name\", \"count\": 1, \"bytes\": %llu, "
+      "\"minDurationMicro\": 4.000, \"meanDurationMicro\": 4.000, \"p99DurationMicro\": 4.000, "
+      "\"maxDurationMicro\": 4.000}",
+      otherBytes)));
+};
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -45,19 +45,55 @@ struct ExtThumbnailHeader
   FileType format;
 };
 
+// an entry in the chunk index, locating one chunk within the uncompressed frame capture section.
+// eventId is 0 for chunks before the captured frame.
+struct ChunkIndexEntry
+{
+  uint32_t chunkID;
+  uint32_t eventId;
+  uint64_t offset;
+  uint64_t length;
+};
+
+class Chunk;
+class RDCFile;
+
+// statistics for each chunk type over the chunks written for a captured frame. These are stored as
+// JSON text in the ChunkStatistics section, so they can be read without replaying the capture.
+class ChunkStatistics
+{
+public:
+  void Add(const Chunk *chunk);
+  void Write(RDCFile *rdc, rdcstr (*chunkName)(uint32_t)) const;
+
+  // durations are converted to microseconds with the given frequency
+  rdcstr ToJSON(rdcstr (*chunkName)(uint32_t), double ticksPerMicrosecond) const;
+
+private:
+  struct TypeStatistics
+  {
+    uint32_t count = 0;
+    uint64_t bytes = 0;
+    rdcarray<int64_t> durations;
+  };
+
+  std::map<uint32_t, TypeStatistics> m_Types;
+};
+
 class RDCFile
 {
 public:
   // version number of overall file format or chunk organisation. If the contents/meaning/order of
   // chunks have changed this does not need to be bumped, there are version numbers within each
   // API that interprets the stream that can be bumped.
-  static const uint32_t SERIALISE_VERSION = 0x00000102;
+  static const uint32_t SERIALISE_VERSION = 0x00000103;
 
   // this must never be changed - files before this were in the v0.x series and didn't have embedded
   // version numbers
   static const uint32_t V1_0_VERSION = 0x00000100;
   static const uint32_t V1_1_VERSION = 0x00000101;
   static const uint32_t V1_2_VERSION = 0x00000102;
+  static const uint32_t V1_3_VERSION = 0x00000103;
 
   ~RDCFile();
 
@@ -74,7 +110,17 @@ public:
   // creates a new file with current properties, file will be overwritten if it already exists
   void Create(const rdcstr &filename);
 
+  // creates a new file as above, then writes out any sections that were written in memory before
+  // a file was created, compressing them as specified in their properties.
+  void CreateFromMemory(const rdcstr &filename);
+
+  // writes a capture built in memory as a complete file to any stream, such as a network socket or
+  // memory buffer, without the seeking that writing a file normally needs. The in-memory sections
+  // are released as they are written.
+  void WriteToStream(StreamWriter &writer);
+
   bool IsUntrusted() const { return m_Untrusted; }
+  bool IsFileBacked() const { return m_File != NULL; }
   const RDResult &Error() const { return m_Error; }
   RDCDriver GetDriver() const { return m_Driver; }
   const rdcstr &GetDriverName() const { return m_DriverName; }
@@ -82,6 +128,8 @@ public:
   uint64_t GetTimestampBase() const { return m_TimeBase; }
   double GetTimestampFrequency() const { return m_TimeFrequency; }
   const RDCThumb &GetThumbnail() const { return m_Thumb; }
+  // only has an effect before the file is created
+  void SetThumbnail(const RDCThumb &thumb) { m_Thumb = thumb; }
   int SectionIndex(SectionType type) const;
   int SectionIndex(const rdcstr &name) const;
   int NumSections() const { return int(m_Sections.size()); }
@@ -89,12 +137,42 @@ public:
   StreamReader *ReadSection(int index) const;
   StreamWriter *WriteSection(const SectionProperties &props);
 
+  // the chunk index is optional. Returns false if it's not present or doesn't match the current
+  // frame capture section.
+  bool ReadChunkIndex(rdcarray<ChunkIndexEntry> &index) const;
+  void WriteChunkIndex(const rdcarray<ChunkIndexEntry> &index);
+
+  // the table of unique callstacks that chunks refer to by index. Returns false if the capture
+  // doesn't have one.
+  bool ReadCallstackTable(rdcarray<rdcarray<uint64_t>> &table) const;
+  void WriteCallstackTable(const rdcarray<rdcarray<uint64_t>> &table);
+
   // Only valid if GetDriver returns RDCDriver::Image, passes over the underlying FILE * for use
   // loading the image directly, since the RDC container isn't there to read from a section.
   FILE *StealImageFileHandle(rdcstr &filename);
 
 private:
   void Init(StreamReader &reader);
+  void WriteFileHeader(StreamWriter &writer);
+
+  static const uint32_t BlockIndexVersion = 1;
+  static const uint32_t ChunkIndexVersion = 1;
+  static const uint32_t CallstackTableVersion = 1;
+  static bool IsValidBlockIndex(const CompressedBlockIndex &index, const SectionProperties &props);
+  void LoadBlockIndex();
+
+  StreamReader *OpenSectionReader(int index) const;
+
+  // helpers for WriteSection when replacing an existing section
+  bool MarkSectionUnused(int index);
+  void ReplaceSectionInPlace(int index, StreamCloseCallback &modifySectionCallback);
+  StreamWriter *WriteSectionHeader(const SectionProperties &props, SectionType type,
+                                   const rdcstr &name, StreamCloseCallback modifySectionCallback);
+
+  // on-disk cache of decompressed sections, opt-in with Capture_DecompressedCacheSizeMB
+  rdcstr GetSectionCacheFilename(int index) const;
+  StreamReader *ReadCachedSection(int index) const;
+  static void EvictSectionCache(const rdcstr &keepFilename);
 
   FILE *m_File = NULL;
   rdcstr m_Filename;
@@ -124,4 +202,7 @@ private:
   rdcarray<SectionProperties> m_Sections;
   rdcarray<SectionLocation> m_SectionLocations;
   rdcarray<bytebuf> m_MemorySections;
+
+  // if the frame capture section was compressed in independent blocks, this indexes them
+  CompressedBlockIndex m_FrameBlockIndex;
 };
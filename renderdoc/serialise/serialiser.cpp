@@ -27,7 +27,9 @@
 
 #include "serialiser.h"
 #include "api/replay/renderdoc_replay.h"
+#include "core/api_overhead.h"
 #include "core/core.h"
+#include "core/memory_accounting.h"
 #include "strings/string_utils.h"
 
 #if ENABLED(RDOC_DEVEL)
@@ -37,6 +39,106 @@ int64_t Chunk::m_TotalMem = 0;
 
 #endif
 
+struct InternedCallstack
+{
+  uint64_t hash;
+  uint32_t index;
+  uint32_t numLevels;
+  uint64_t addrs[1];
+};
+
+// the table is a fixed size open-addressed hash set, so that inserting never has to move entries
+// and threads can look up and insert stacks without taking a lock. Entries are only ever added
+// and live for the whole process, so a capture can refer to stacks collected at any point before.
+static const uint32_t CallstackSlots = 64 * 1024;
+// stop adding entries well before the table is full so that probe sequences stay short
+static const int32_t MaxInternedCallstacks = CallstackSlots / 2;
+
+static void *callstackSlots[CallstackSlots] = {};
+static int32_t numInternedCallstacks = 0;
+
+static uint64_t HashCallstack(const uint64_t *addrs, size_t numLevels)
+{
+  uint64_t h = 14695981039346656037ULL;
+  for(size_t i = 0; i < numLevels; i++)
+  {
+    h ^= addrs[i];
+    h *= 1099511628211ULL;
+    h ^= h >> 29;
+  }
+  return h;
+}
+
+uint32_t InternCallstack(const uint64_t *addrs, size_t numLevels)
+{
+  const uint64_t hash = HashCallstack(addrs, numLevels);
+
+  InternedCallstack *added = NULL;
+
+  for(uint32_t probe = 0, slot = uint32_t(hash) & (CallstackSlots - 1); probe < CallstackSlots;
+      probe++, slot = (slot + 1) & (CallstackSlots - 1))
+  {
+    InternedCallstack *entry =
+        (InternedCallstack *)Atomic::CmpExchPtr(&callstackSlots[slot], NULL, NULL);
+
+    if(entry == NULL)
+    {
+      if(added == NULL)
+      {
+        // indices are allocated before the entry is published, so one that loses a race to insert
+        // the same stack leaves an unused index behind. That's harmless, it's just an empty stack
+        // in the table.
+        if(Atomic::CmpExch32(&numInternedCallstacks, 0, 0) >= MaxInternedCallstacks)
+          return ~0U;
+
+        int32_t index = Atomic::Inc32(&numInternedCallstacks) - 1;
+        if(index >= MaxInternedCallstacks)
+          return ~0U;
+
+        added = (InternedCallstack *)malloc(sizeof(InternedCallstack) +
+                                            sizeof(uint64_t) * RDCMAX(numLevels, (size_t)1));
+        added->hash = hash;
+        added->index = (uint32_t)index;
+        added->numLevels = (uint32_t)numLevels;
+        memcpy(added->addrs, addrs, sizeof(uint64_t) * numLevels);
+      }
+
+      entry = (InternedCallstack *)Atomic::CmpExchPtr(&callstackSlots[slot], NULL, added);
+
+      if(entry == NULL)
+        return added->index;
+    }
+
+    if(entry->hash == hash && entry->numLevels == numLevels &&
+       memcmp(entry->addrs, addrs, sizeof(uint64_t) * numLevels) == 0)
+    {
+      free(added);
+      return entry->index;
+    }
+  }
+
+  free(added);
+  return ~0U;
+}
+
+CallstackTable GetInternedCallstacks()
+{
+  CallstackTable ret;
+  ret.resize(
+      (size_t)RDCMIN(Atomic::CmpExch32(&numInternedCallstacks, 0, 0), MaxInternedCallstacks));
+
+  for(uint32_t slot = 0; slot < CallstackSlots; slot++)
+  {
+    InternedCallstack *entry =
+        (InternedCallstack *)Atomic::CmpExchPtr(&callstackSlots[slot], NULL, NULL);
+
+    if(entry && entry->index < ret.size())
+      ret[entry->index].assign(entry->addrs, entry->numLevels);
+  }
+
+  return ret;
+}
+
 void DumpObject(FileIO::LogFileHandle *log, const rdcstr &indent, SDObject *obj)
 {
   if(obj->NumChildren() > 0)
@@ -149,6 +251,18 @@ uint32_t Serialiser<SerialiserMode::Reading>::BeginChunk(uint32_t, uint64_t)
       }
     }
 
+    if(c & ChunkCallstackIndex)
+    {
+      uint32_t callstackIndex = 0;
+      m_Read->Read(callstackIndex);
+
+      if(m_CallstackTable && callstackIndex < m_CallstackTable->size())
+      {
+        m_ChunkMetadata.flags |= SDChunkFlags::HasCallstack;
+        m_ChunkMetadata.callstack = m_CallstackTable->at(callstackIndex);
+      }
+    }
+
     if(c & ChunkThreadID)
       m_Read->Read(m_ChunkMetadata.threadID);
 
@@ -189,7 +303,8 @@ uint32_t Serialiser<SerialiserMode::Reading>::BeginChunk(uint32_t, uint64_t)
     if(name.empty())
       name = "<Unknown Chunk>";
 
-    SDChunk *chunk = new SDChunk(name);
+    // chunk names repeat for every chunk of the same type, so share a single copy between them
+    SDChunk *chunk = new SDChunk(InternString(name));
     chunk->metadata = m_ChunkMetadata;
 
     m_StructuredFile->chunks.push_back(chunk);
@@ -211,7 +326,8 @@ void Serialiser<SerialiserMode::Reading>::SkipCurrentChunk()
 
     SDObject &current = *m_StructureStack.back();
 
-    SDObject &obj = *current.AddAndOwnChild(new SDObject("Opaque chunk"_lit, "Byte Buffer"_lit));
+    SDObject &obj =
+        *current.AddAndOwnChild(NewStructuredObject("Opaque chunk"_lit, "Byte Buffer"_lit));
 
     obj.type.basetype = SDBasic::Buffer;
     obj.type.byteSize = m_ChunkMetadata.length;
@@ -360,31 +476,52 @@ uint32_t Serialiser<SerialiserMode::Writing>::BeginChunk(uint32_t chunkID, uint6
 
       m_ChunkMetadata.chunkID = chunkID;
 
-      /////////////////
-
-      m_Write->Write(c);
+      uint32_t callstackIndex = ~0U;
 
-      if(c & ChunkCallstack)
+      // callstacks we collect ourselves are stored by index into the capture's table. One that was
+      // given to us in the metadata is written in full, since it may be destined for a different
+      // capture than the one the table is written with.
+      if((c & ChunkCallstack) && m_ChunkMetadata.callstack.empty())
       {
-        if(m_ChunkMetadata.callstack.empty())
-        {
-          bool collect = RenderDoc::Inst().GetCaptureOptions().captureCallstacks;
+        bool collect = RenderDoc::Inst().GetCaptureOptions().captureCallstacks;
 
-          if(RenderDoc::Inst().GetCaptureOptions().captureCallstacksOnlyActions)
-            collect = collect && m_ActionChunk;
+        if(RenderDoc::Inst().GetCaptureOptions().captureCallstacksOnlyActions)
+          collect = collect && m_ActionChunk;
 
-          if(collect)
+        if(collect)
+        {
+          Callstack::Stackwalk *stack = Callstack::Collect();
+          if(stack && stack->NumLevels() > 0)
           {
-            Callstack::Stackwalk *stack = Callstack::Collect();
-            if(stack && stack->NumLevels() > 0)
-            {
-              m_ChunkMetadata.callstack.assign(stack->GetAddrs(), stack->NumLevels());
-            }
+            callstackIndex = InternCallstack(stack->GetAddrs(), stack->NumLevels());
 
-            SAFE_DELETE(stack);
+            if(callstackIndex == ~0U)
+              m_ChunkMetadata.callstack.assign(stack->GetAddrs(), stack->NumLevels());
           }
+
+          SAFE_DELETE(stack);
         }
+      }
+
+      if(callstackIndex != ~0U)
+      {
+        c &= ~ChunkCallstack;
+        c |= ChunkCallstackIndex;
+      }
 
+      /////////////////
+
+      m_Write->Write(c);
+
+      if(c & ChunkCallstackIndex)
+      {
+        m_ChunkMetadata.flags |= SDChunkFlags::HasCallstack;
+
+        m_Write->Write(callstackIndex);
+      }
+
+      if(c & ChunkCallstack)
+      {
         m_ChunkMetadata.flags |= SDChunkFlags::HasCallstack;
 
         uint32_t numFrames = (uint32_t)m_ChunkMetadata.callstack.size();
@@ -451,7 +588,8 @@ uint32_t Serialiser<SerialiserMode::Writing>::BeginChunk(uint32_t chunkID, uint6
     if(name.empty())
       name = "<Unknown Chunk>";
 
-    SDChunk *chunk = new SDChunk(name);
+    // chunk names repeat for every chunk of the same type, so share a single copy between them
+    SDChunk *chunk = new SDChunk(InternString(name));
     chunk->metadata = m_ChunkMetadata;
 
     m_StructuredFile->chunks.push_back(chunk);
@@ -1035,6 +1173,9 @@ Chunk *Chunk::Create(Serialiser<SerialiserMode::Writing> &ser, uint16_t chunkTyp
 
   ser.GetWriter()->Rewind();
 
+  if(APIOverhead::IsEnabled())
+    APIOverhead::AddSerialisedBytes(length);
+
   Chunk *ret = NULL;
 
   // if allocator wasn't NULL'd above, use it to allocate the chunk as well. We always either
@@ -1066,68 +1207,134 @@ Chunk *Chunk::Create(Serialiser<SerialiserMode::Writing> &ser, uint16_t chunkTyp
   return ret;
 }
 
-ChunkPagePool::~ChunkPagePool()
+SDChunkMetaData Chunk::GetMetadata() const
 {
-  // all allocated pages are in precisely one list, so just free the contents of both lists
-  for(ChunkPage &p : freePages)
+  SDChunkMetaData ret;
+
+  StreamReader reader(m_Data, m_Length);
+
+  uint32_t c = 0;
+  reader.Read(c);
+
+  ret.chunkID = c & Serialiser<SerialiserMode::Writing>::ChunkIndexMask;
+
+  if(c & Serialiser<SerialiserMode::Writing>::ChunkCallstack)
+  {
+    uint32_t numFrames = 0;
+    reader.Read(numFrames);
+    reader.Read(NULL, numFrames * sizeof(uint64_t));
+    ret.flags |= SDChunkFlags::HasCallstack;
+  }
+
+  if(c & Serialiser<SerialiserMode::Writing>::ChunkCallstackIndex)
+  {
+    reader.Read(NULL, sizeof(uint32_t));
+    ret.flags |= SDChunkFlags::HasCallstack;
+  }
+
+  if(c & Serialiser<SerialiserMode::Writing>::ChunkThreadID)
+    reader.Read(ret.threadID);
+
+  if(c & Serialiser<SerialiserMode::Writing>::ChunkDuration)
+    reader.Read(ret.durationMicro);
+
+  if(c & Serialiser<SerialiserMode::Writing>::ChunkTimestamp)
+    reader.Read(ret.timestampMicro);
+
+  if(c & Serialiser<SerialiserMode::Writing>::Chunk64BitSize)
   {
-    FreeAlignedBuffer(p.chunkBase);
-    FreeAlignedBuffer(p.bufferBase);
+    reader.Read(ret.length);
+  }
+  else
+  {
+    uint32_t chunkSize = 0;
+    reader.Read(chunkSize);
+    ret.length = chunkSize;
   }
 
-  for(ChunkPage &p : allocatedPages)
+  return ret;
+}
+
+ChunkPagePool::~ChunkPagePool()
+{
+  // the chunk memory is allocated after the buffer memory in the same allocation, so we only need
+  // to free each page's buffer base. Trimmed slots have a NULL base
+  for(PageSlot &s : slots)
   {
-    FreeAlignedBuffer(p.chunkBase);
-    FreeAlignedBuffer(p.bufferBase);
+    if(s.page.bufferBase)
+      MemoryAccounting::Freed(MemoryCategory::ChunkPages, BufferPageSize + ChunkPageSize);
+    FreeAlignedBuffer(s.page.bufferBase);
   }
 }
 
 ChunkPage ChunkPagePool::AllocPage()
 {
-  if(!freePages.empty())
+  size_t slot;
+
+  if(!freeSlots.empty())
   {
-    // if there's a free page, move it to the allocated list and return it
-    ChunkPage free = freePages.back();
-    freePages.pop_back();
-    allocatedPages.push_back(free);
+    // if there's a free page, reuse it
+    slot = freeSlots.back();
+    freeSlots.pop_back();
   }
   else
   {
-    // otherwise allocate a new one straight into the allocated list
-    byte *buffers = ::AllocAlignedBuffer(BufferPageSize);
-    byte *chunks = ::AllocAlignedBuffer(ChunkPageSize);
-    allocatedPages.push_back({m_ID++, buffers, buffers, chunks, chunks});
+    // otherwise allocate a new one, reusing an empty slot if there is one
+    if(!emptySlots.empty())
+    {
+      slot = emptySlots.back();
+      emptySlots.pop_back();
+    }
+    else
+    {
+      slot = slots.size();
+      slots.push_back({});
+    }
+
+    // allocate the buffer and chunk memory together to halve the number of heap allocations
+    byte *buffers = ::AllocAlignedBuffer(BufferPageSize + ChunkPageSize);
+    MemoryAccounting::Allocated(MemoryCategory::ChunkPages, BufferPageSize + ChunkPageSize);
+    byte *chunks = buffers + BufferPageSize;
+    slots[slot].page = {m_ID++, slot, buffers, buffers, chunks, chunks};
   }
 
-  return allocatedPages.back();
+  slots[slot].allocated = true;
+
+  return slots[slot].page;
 }
 
 void ChunkPagePool::Trim()
 {
   // truly release any currently free pages back to the system
-  for(ChunkPage &p : freePages)
+  for(size_t slot : freeSlots)
   {
-    FreeAlignedBuffer(p.chunkBase);
-    FreeAlignedBuffer(p.bufferBase);
+    FreeAlignedBuffer(slots[slot].page.bufferBase);
+    MemoryAccounting::Freed(MemoryCategory::ChunkPages, BufferPageSize + ChunkPageSize);
+    slots[slot].page = {};
   }
 
-  freePages.clear();
+  emptySlots.append(freeSlots);
+  freeSlots.clear();
 }
 
 void ChunkPagePool::Reset()
 {
   // forcibly move all allocated pages into the free list
-  freePages.append(allocatedPages);
-  allocatedPages.clear();
-
-  for(ChunkPage &p : freePages)
+  for(size_t slot = 0; slot < slots.size(); slot++)
   {
+    PageSlot &s = slots[slot];
+    if(!s.allocated)
+      continue;
+
     // reset head pointers
-    p.bufferHead = p.bufferBase;
-    p.chunkHead = p.chunkBase;
+    s.page.bufferHead = s.page.bufferBase;
+    s.page.chunkHead = s.page.chunkBase;
 
     // assign a new ID so these pages can't get reset again by any allocator currently holding them
-    p.ID = m_ID++;
+    s.page.ID = m_ID++;
+    s.allocated = false;
+
+    freeSlots.push_back(slot);
   }
 }
 
@@ -1136,25 +1343,23 @@ void ChunkPagePool::ResetPageSet(const rdcarray<ChunkPage> &pages)
   // iterate over each page being freed
   for(const ChunkPage &p : pages)
   {
-    // try to find it in the allocated page list. This compares by ID, so if the page was already
-    // freed with a pool reset we won't find it at all because it will have a new ID - that's fine.
-    int32_t idx = allocatedPages.indexOf(p);
-    if(idx >= 0)
-    {
-      ChunkPage &alloc = allocatedPages[idx];
-      // give a new ID to be safe
-      alloc.ID = m_ID++;
-      // reset head pointers
-      alloc.bufferHead = alloc.bufferBase;
-      alloc.chunkHead = alloc.chunkBase;
-      // move to free list
-      freePages.push_back(alloc);
-      // allocatedPages is not sorted, swap with the back and pop to avoid expensive erases in the
-      // middle of the list
-      std::swap(allocatedPages[idx], allocatedPages.back());
-      allocatedPages.pop_back();
+    // look up its slot and check the page there is still the same one. This compares by ID, so if
+    // the page was already freed with a pool reset it will have a new ID - that's fine.
+    if(p.slot >= slots.size())
       continue;
-    }
+
+    PageSlot &s = slots[p.slot];
+    if(!s.allocated || s.page.ID != p.ID)
+      continue;
+
+    // give a new ID to be safe
+    s.page.ID = m_ID++;
+    // reset head pointers
+    s.page.bufferHead = s.page.bufferBase;
+    s.page.chunkHead = s.page.chunkBase;
+    // move to free list
+    s.allocated = false;
+    freeSlots.push_back(p.slot);
   }
 }
 
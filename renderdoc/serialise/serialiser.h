@@ -82,6 +82,17 @@ enum class SerialiserMode
 
 struct CompressedFileIO;
 
+// the unique callstacks referenced by chunks in a capture, indexed by the number stored in each
+// chunk's header. See InternCallstack() below.
+typedef rdcarray<rdcarray<uint64_t>> CallstackTable;
+
+// When capturing, each unique callstack is stored once in a process-wide table and chunks only
+// record its index, since a frame usually has a few thousand unique stacks across many more calls.
+// The table is written with the capture in the CallstackTable section. Returns ~0U if the table is
+// full, in which case the stack should be stored in the chunk instead.
+uint32_t InternCallstack(const uint64_t *addrs, size_t numLevels);
+CallstackTable GetInternedCallstacks();
+
 template <SerialiserMode sertype>
 class Serialiser
 {
@@ -108,6 +119,7 @@ public:
     ChunkDuration = 0x00040000,
     ChunkTimestamp = 0x00080000,
     Chunk64BitSize = 0x00100000,
+    ChunkCallstackIndex = 0x00200000,
   };
 
   //////////////////////////////////////////
@@ -143,6 +155,9 @@ public:
   void *GetUserData() { return m_pUserData; }
   void SetUserData(void *userData) { m_pUserData = userData; }
   void SetStringDatabase(std::set<rdcstr> *db) { m_ExtStringDB = db; }
+  // the table that callstack indices in chunk headers refer to when reading. If it's not set, those
+  // chunks are read without a callstack.
+  void SetCallstackTable(const CallstackTable *table) { m_CallstackTable = table; }
   // jumps to the byte after the current chunk, can be called any time after BeginChunk
   void SkipCurrentChunk();
 
@@ -232,7 +247,7 @@ public:
 
       SDObject &current = *m_StructureStack.back();
 
-      SDObject &obj = *current.AddAndOwnChild(new SDObject(name, TypeName<T>()));
+      SDObject &obj = *current.AddAndOwnChild(NewStructuredObject(name, TypeName<T>()));
       m_StructureStack.push_back(&obj);
 
       obj.type.byteSize = sizeof(T);
@@ -277,7 +292,7 @@ public:
 
       SDObject &current = *m_StructureStack.back();
 
-      SDObject &obj = *current.AddAndOwnChild(new SDObject(name, "Byte Buffer"_lit));
+      SDObject &obj = *current.AddAndOwnChild(NewStructuredObject(name, "Byte Buffer"_lit));
       m_StructureStack.push_back(&obj);
 
       obj.type.basetype = SDBasic::Buffer;
@@ -386,7 +401,7 @@ public:
 
       SDObject &current = *m_StructureStack.back();
 
-      SDObject &obj = *current.AddAndOwnChild(new SDObject(name, "Byte Buffer"_lit));
+      SDObject &obj = *current.AddAndOwnChild(NewStructuredObject(name, "Byte Buffer"_lit));
       m_StructureStack.push_back(&obj);
 
       obj.type.basetype = SDBasic::Buffer;
@@ -498,7 +513,7 @@ public:
 
       SDObject &parent = *m_StructureStack.back();
 
-      SDObject &arr = *parent.AddAndOwnChild(new SDObject(name, TypeName<T>()));
+      SDObject &arr = *parent.AddAndOwnChild(NewStructuredObject(name, TypeName<T>()));
       m_StructureStack.push_back(&arr);
 
       arr.type.basetype = SDBasic::Array;
@@ -509,7 +524,7 @@ public:
 
       for(size_t i = 0; i < N; i++)
       {
-        SDObject &obj = *arr.AddAndOwnChild(new SDObject("$el"_lit, TypeName<T>()));
+        SDObject &obj = *arr.AddAndOwnChild(NewStructuredObject("$el"_lit, TypeName<T>()));
         m_StructureStack.push_back(&obj);
 
         // default to struct. This will be overwritten if appropriate
@@ -615,7 +630,7 @@ public:
 
       SDObject &parent = *m_StructureStack.back();
 
-      SDObject &arr = *parent.AddAndOwnChild(new SDObject(name, TypeName<T>()));
+      SDObject &arr = *parent.AddAndOwnChild(NewStructuredObject(name, TypeName<T>()));
       m_StructureStack.push_back(&arr);
 
       arr.type.basetype = SDBasic::Array;
@@ -651,7 +666,7 @@ public:
       {
         for(uint64_t i = 0; el && i < arrayCount; i++)
         {
-          SDObject &obj = *arr.AddAndOwnChild(new SDObject("$el"_lit, TypeName<T>()));
+          SDObject &obj = *arr.AddAndOwnChild(NewStructuredObject("$el"_lit, TypeName<T>()));
           m_StructureStack.push_back(&obj);
 
           // default to struct. This will be overwritten if appropriate
@@ -718,7 +733,7 @@ public:
 
       SDObject &parent = *m_StructureStack.back();
 
-      SDObject &arr = *parent.AddAndOwnChild(new SDObject(name, TypeName<U>()));
+      SDObject &arr = *parent.AddAndOwnChild(NewStructuredObject(name, TypeName<U>()));
       m_StructureStack.push_back(&arr);
 
       arr.type.basetype = SDBasic::Array;
@@ -744,7 +759,7 @@ public:
       {
         for(size_t i = 0; i < (size_t)size; i++)
         {
-          SDObject &obj = *arr.AddAndOwnChild(new SDObject("$el"_lit, TypeName<U>()));
+          SDObject &obj = *arr.AddAndOwnChild(NewStructuredObject("$el"_lit, TypeName<U>()));
           m_StructureStack.push_back(&obj);
 
           // default to struct. This will be overwritten if appropriate
@@ -797,7 +812,7 @@ public:
 
       SDObject &parent = *m_StructureStack.back();
 
-      SDObject &arr = *parent.AddAndOwnChild(new SDObject(name, TypeName<U>()));
+      SDObject &arr = *parent.AddAndOwnChild(NewStructuredObject(name, TypeName<U>()));
       m_StructureStack.push_back(&arr);
 
       arr.type.basetype = SDBasic::Array;
@@ -808,7 +823,7 @@ public:
 
       for(size_t i = 0; i < N; i++)
       {
-        SDObject &obj = *arr.AddAndOwnChild(new SDObject("$el"_lit, TypeName<U>()));
+        SDObject &obj = *arr.AddAndOwnChild(NewStructuredObject("$el"_lit, TypeName<U>()));
         m_StructureStack.push_back(&obj);
 
         // default to struct. This will be overwritten if appropriate
@@ -873,7 +888,7 @@ public:
 
       SDObject &parent = *m_StructureStack.back();
 
-      SDObject &arr = *parent.AddAndOwnChild(new SDObject(name, "pair"_lit));
+      SDObject &arr = *parent.AddAndOwnChild(NewStructuredObject(name, "pair"_lit));
       m_StructureStack.push_back(&arr);
 
       arr.type.basetype = SDBasic::Struct;
@@ -882,7 +897,7 @@ public:
       arr.ReserveChildren(2);
 
       {
-        SDObject &obj = *arr.AddAndOwnChild(new SDObject("first"_lit, TypeName<U>()));
+        SDObject &obj = *arr.AddAndOwnChild(NewStructuredObject("first"_lit, TypeName<U>()));
         m_StructureStack.push_back(&obj);
 
         // default to struct. This will be overwritten if appropriate
@@ -895,7 +910,7 @@ public:
       }
 
       {
-        SDObject &obj = *arr.AddAndOwnChild(new SDObject("second"_lit, TypeName<V>()));
+        SDObject &obj = *arr.AddAndOwnChild(NewStructuredObject("second"_lit, TypeName<V>()));
         m_StructureStack.push_back(&obj);
 
         // default to struct. This will be overwritten if appropriate
@@ -985,7 +1000,7 @@ public:
       {
         SDObject &parent = *m_StructureStack.back();
 
-        SDObject &nullable = *parent.AddAndOwnChild(new SDObject(name, TypeName<T>()));
+        SDObject &nullable = *parent.AddAndOwnChild(NewStructuredObject(name, TypeName<T>()));
 
         nullable.type.basetype = SDBasic::Null;
         nullable.type.byteSize = 0;
@@ -1071,7 +1086,7 @@ public:
 
       SDObject &current = *m_StructureStack.back();
 
-      SDObject &obj = *current.AddAndOwnChild(new SDObject(name, "Byte Buffer"_lit));
+      SDObject &obj = *current.AddAndOwnChild(NewStructuredObject(name, "Byte Buffer"_lit));
       m_StructureStack.push_back(&obj);
 
       obj.type.basetype = SDBasic::Buffer;
@@ -1455,6 +1470,12 @@ private:
     }
   }
 
+  // objects created while exporting structured data are allocated from the file's arena
+  SDObject *NewStructuredObject(const rdcinflexiblestr &name, const rdcinflexiblestr &type)
+  {
+    return new(m_StructuredFile->GetObjectArena()) SDObject(name, type);
+  }
+
   template <typename T>
   LazyGenerator MakeLazySerialiser()
   {
@@ -1516,6 +1537,7 @@ private:
 
   uint32_t m_ChunkFlags = 0;
   SDChunkMetaData m_ChunkMetadata;
+  const CallstackTable *m_CallstackTable = NULL;
   double m_TimerFrequency = 1.0;
   uint64_t m_TimerBase = 0;
 
@@ -1554,6 +1576,12 @@ class ReadSerialiser : public Serialiser<SerialiserMode::Reading>
 {
 public:
   ReadSerialiser(StreamReader *reader, Ownership own) : Serialiser(reader, own, NULL) {}
+  // export structured data into an existing object instead of a new chunk, e.g. to decode the
+  // contents of a lazy chunk on demand with SDObject::SetLazyObject
+  ReadSerialiser(StreamReader *reader, Ownership own, SDObject *rootStructuredObj)
+      : Serialiser(reader, own, rootStructuredObj)
+  {
+  }
   template <typename ChunkType>
   ChunkType ReadChunk()
   {
@@ -1661,6 +1689,8 @@ struct ChunkPage
   // again if an allocator subsequently tries to free them
   bool operator==(const ChunkPage &o) { return ID == o.ID; }
   size_t ID;
+  // the index of this page's slot in the pool, which never changes for the page's lifetime
+  size_t slot;
 
   // we allocate at two granularities, chunks are 16 bytes, buffers are multiples of 64-bytes
   // to keep things simple we allocate the chunk memory as 16/64 = a quarter the size of the
@@ -1709,11 +1739,20 @@ private:
 
   size_t m_ID = 1;
 
-  // a page is in precisely ONE of these arrays at any time.
+  struct PageSlot
+  {
+    ChunkPage page;
+    bool allocated;
+  };
+
+  // every page lives in a fixed slot, so pages being reset can be looked up directly instead of
+  // searched for. A slot is either allocated, in freeSlots with its memory still present to be
+  // reused, or in emptySlots once Trim() has released its memory.
   // Reset() will move all allocated pages back to free pages and reclaim all that memory
-  // ResetPageSet() will move any referenced pages from allocatedPages back to freePages
-  rdcarray<ChunkPage> freePages;
-  rdcarray<ChunkPage> allocatedPages;
+  // ResetPageSet() will move any referenced pages from allocated back to freeSlots
+  rdcarray<PageSlot> slots;
+  rdcarray<size_t> freeSlots;
+  rdcarray<size_t> emptySlots;
 };
 
 // this is the second level, it should only be used by one object (or a group of objects that are
@@ -1802,6 +1841,11 @@ public:
                        ChunkAllocator *allocator = NULL);
 
   byte *GetData() const { return m_Data; }
+  uint32_t GetLength() const { return m_Length; }
+
+  // decode the metadata from the chunk's header. The callstack is skipped and not returned.
+  SDChunkMetaData GetMetadata() const;
+
   Chunk *Duplicate()
   {
     Chunk *ret = new Chunk();
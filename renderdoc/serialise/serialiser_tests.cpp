@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include "serialiser.h"
+#include "common/timing.h"
 
 #if ENABLED(ENABLE_UNIT_TESTS)
 
@@ -595,6 +596,36 @@ TEST_CASE("Read/writing large buffers", "[serialiser]")
   FileIO::Delete(filename);
 };
 
+TEST_CASE("Intern callstacks", "[serialiser]")
+{
+  // other tests may have interned stacks already, so only check relative to these
+  const uint64_t stackA[] = {0x1001, 0x2002, 0x3003};
+  const uint64_t stackB[] = {0x1001, 0x2002, 0x4004};
+
+  uint32_t a = InternCallstack(stackA, ARRAY_COUNT(stackA));
+  uint32_t b = InternCallstack(stackB, ARRAY_COUNT(stackB));
+  uint32_t prefix = InternCallstack(stackA, 2);
+
+  REQUIRE(a != ~0U);
+  REQUIRE(b != ~0U);
+  REQUIRE(prefix != ~0U);
+  CHECK(a != b);
+  CHECK(a != prefix);
+  CHECK(b != prefix);
+
+  CHECK(InternCallstack(stackA, ARRAY_COUNT(stackA)) == a);
+  CHECK(InternCallstack(stackB, ARRAY_COUNT(stackB)) == b);
+
+  CallstackTable table = GetInternedCallstacks();
+
+  REQUIRE(a < table.size());
+  REQUIRE(b < table.size());
+  REQUIRE(prefix < table.size());
+  CHECK(table[a] == rdcarray<uint64_t>(stackA, ARRAY_COUNT(stackA)));
+  CHECK(table[b] == rdcarray<uint64_t>(stackB, ARRAY_COUNT(stackB)));
+  CHECK(table[prefix] == rdcarray<uint64_t>(stackA, 2));
+};
+
 TEST_CASE("Read/write chunk metadata", "[serialiser]")
 {
   StreamWriter *buf = new StreamWriter(StreamWriter::DefaultScratchSize);
@@ -682,6 +713,177 @@ TEST_CASE("Read/write chunk metadata", "[serialiser]")
   delete buf;
 };
 
+TEST_CASE("Lazily decode chunk contents on first access", "[serialiser][structured]")
+{
+  StreamWriter *buf = new StreamWriter(StreamWriter::DefaultScratchSize);
+
+  {
+    WriteSerialiser ser(buf, Ownership::Nothing);
+
+    ser.WriteChunk(1);
+
+    uint32_t foo = 42;
+    float bar = 1.5f;
+    ser.Serialise("foo"_lit, foo);
+    ser.Serialise("bar"_lit, bar);
+
+    ser.EndChunk();
+
+    REQUIRE_FALSE(ser.IsErrored());
+  }
+
+  ChunkLookup testChunkLoop = [](uint32_t) -> rdcstr { return "TestChunk"; };
+
+  // read the chunk header, recording where its contents start but not exporting them
+  uint64_t contentsOffset = 0;
+  {
+    ReadSerialiser ser(new StreamReader(buf->GetData(), buf->GetOffset()), Ownership::Stream);
+
+    ser.ReadChunk<uint32_t>();
+    contentsOffset = ser.GetReader()->GetOffset();
+    ser.SkipCurrentChunk();
+    ser.EndChunk();
+
+    REQUIRE_FALSE(ser.IsErrored());
+  }
+
+  int decodeCount = 0;
+
+  SDChunk *chunk = new SDChunk("TestChunk"_lit);
+  chunk->SetLazyObject([&decodeCount, buf, contentsOffset, testChunkLoop](SDObject *obj) {
+    decodeCount++;
+
+    StreamReader *reader = new StreamReader(buf->GetData(), buf->GetOffset());
+    reader->SetOffset(contentsOffset);
+
+    ReadSerialiser ser(reader, Ownership::Stream, obj);
+    ser.ConfigureStructuredExport(testChunkLoop, false, 0, 1.0);
+
+    uint32_t foo;
+    float bar;
+    ser.Serialise("foo"_lit, foo);
+    ser.Serialise("bar"_lit, bar);
+  });
+
+  CHECK(chunk->IsLazyObject());
+  CHECK(decodeCount == 0);
+
+  REQUIRE(chunk->NumChildren() == 2);
+  CHECK(decodeCount == 1);
+  CHECK_FALSE(chunk->IsLazyObject());
+
+  CHECK(chunk->GetChild(0)->name == "foo");
+  CHECK(chunk->GetChild(0)->AsUInt32() == 42);
+  CHECK(chunk->FindChild("bar")->AsFloat() == 1.5f);
+
+  SDChunk *dup = chunk->Duplicate();
+  CHECK(dup->HasEqualValue(chunk));
+  CHECK(decodeCount == 1);
+
+  // duplicating a chunk that hasn't been decoded yet decodes it
+  SDChunk *lazy = new SDChunk("TestChunk"_lit);
+  lazy->SetLazyObject([](SDObject *obj) { obj->AddAndOwnChild(makeSDUInt32("foo"_lit, 42)); });
+
+  SDChunk *lazyDup = lazy->Duplicate();
+  CHECK(lazyDup->NumChildren() == 1);
+  CHECK(lazy->NumChildren() == 1);
+
+  delete lazyDup;
+  delete lazy;
+  delete dup;
+  delete chunk;
+  delete buf;
+};
+
+TEST_CASE("Structured objects allocated from an arena", "[serialiser][structured]")
+{
+  SDObject *moved = NULL;
+
+  {
+    SDFile *file = new SDFile;
+
+    SDChunk *chunk = new SDChunk("TestChunk"_lit);
+    file->chunks.push_back(chunk);
+
+    SDObjectArena *arena = file->GetObjectArena();
+    CHECK(arena == file->GetObjectArena());
+
+    for(uint32_t i = 0; i < 10000; i++)
+    {
+      SDObject *obj = chunk->AddAndOwnChild(new(arena) SDObject("value"_lit, "uint32_t"_lit));
+      obj->type.basetype = SDBasic::UnsignedInteger;
+      obj->data.basic.u = i;
+    }
+
+    // objects can be removed and deleted individually
+    chunk->RemoveChild(0);
+    CHECK(chunk->NumChildren() == 9999);
+    CHECK(chunk->GetChild(0)->AsUInt32() == 1);
+
+    // move an arena allocated object out of the file, it must outlive the file
+    SDObject *parent = new SDObject("parent"_lit, "struct"_lit);
+    StructuredObjectList children;
+    chunk->TakeAllChildren(children);
+    moved = parent;
+    for(SDObject *o : children)
+      parent->AddAndOwnChild(o);
+    children.clear();
+
+    delete file;
+  }
+
+  REQUIRE(moved->NumChildren() == 9999);
+  for(uint32_t i = 0; i < 9999; i++)
+    CHECK(moved->GetChild(i)->AsUInt32() == i + 1);
+
+  delete moved;
+};
+
+TEST_CASE("Chunk allocators reset only their own pages", "[serialiser][chunks]")
+{
+  ChunkPagePool pool(4096);
+
+  ChunkAllocator a(pool), b(pool);
+
+  // interleave allocations so the two allocators' pages are mixed in the pool
+  rdcarray<byte *> aBuffers, bBuffers;
+  for(int i = 0; i < 16; i++)
+  {
+    aBuffers.push_back(a.AllocAlignedBuffer(1024));
+    bBuffers.push_back(b.AllocAlignedBuffer(1024));
+    memset(bBuffers.back(), i, 1024);
+  }
+
+  CHECK(a.AllocAlignedBuffer(8192) == NULL);
+
+  a.Reset();
+
+  // a new allocator picks up a's old pages, without touching b's data
+  ChunkAllocator c(pool);
+  for(int i = 0; i < 16; i++)
+  {
+    byte *buf = c.AllocAlignedBuffer(1024);
+    CHECK(aBuffers.contains(buf));
+    CHECK_FALSE(bBuffers.contains(buf));
+    memset(buf, 0xff, 1024);
+  }
+
+  for(int i = 0; i < 16; i++)
+    CHECK(bBuffers[i][1023] == i);
+
+  // after a full pool reset, b resetting its now-stale pages must not free them again
+  pool.Reset();
+  ChunkAllocator d(pool);
+  byte *dBuf = d.AllocAlignedBuffer(1024);
+  b.Reset();
+  c.Reset();
+
+  byte *eBuf = ChunkAllocator(pool).AllocAlignedBuffer(1024);
+  CHECK(dBuf != eBuf);
+
+  pool.Trim();
+};
+
 TEST_CASE("Verify multiple chunks can be merged", "[serialiser][chunks]")
 {
   StreamWriter *buf = new StreamWriter(StreamWriter::DefaultScratchSize);
@@ -1781,4 +1983,80 @@ TEST_CASE("Test stringification works as expected", "[tostr]")
   };
 };
 
+template <typename SerialiserType>
+static void SerialiseBenchmarkChunk(SerialiserType &ser, rdcarray<uint32_t> &values, bytebuf &blob)
+{
+  SERIALISE_ELEMENT(values);
+  SERIALISE_ELEMENT(blob);
+}
+
+// hidden by default, run explicitly with the [benchmark] tag to get throughput numbers reported
+TEST_CASE("Serialiser throughput", "[.][benchmark][serialiser]")
+{
+  const int numChunks = 4000;
+
+  rdcarray<uint32_t> values;
+  values.resize(256);
+  for(size_t i = 0; i < values.size(); i++)
+    values[i] = uint32_t(i * 7);
+
+  bytebuf blob;
+  blob.resize(16 * 1024);
+  for(size_t i = 0; i < blob.size(); i++)
+    blob[i] = byte(i & 0xff);
+
+  StreamWriter *buf = new StreamWriter(StreamWriter::DefaultScratchSize);
+
+  PerformanceTimer timer;
+
+  {
+    WriteSerialiser ser(buf, Ownership::Nothing);
+    for(int i = 0; i < numChunks; i++)
+    {
+      ser.WriteChunk(1);
+      SerialiseBenchmarkChunk(ser, values, blob);
+      ser.EndChunk();
+    }
+  }
+
+  const double MB = double(buf->GetOffset()) / (1024.0 * 1024.0);
+
+  double writeMS = timer.GetMilliseconds();
+
+  for(bool structured : {false, true})
+  {
+    timer.Restart();
+
+    ReadSerialiser ser(new StreamReader(buf->GetData(), buf->GetOffset()), Ownership::Stream);
+
+    if(structured)
+      ser.ConfigureStructuredExport([](uint32_t) -> rdcstr { return "BenchChunk"; }, true, 0, 1.0);
+
+    rdcarray<uint32_t> readValues;
+    bytebuf readBlob;
+
+    for(int i = 0; i < numChunks; i++)
+    {
+      ser.ReadChunk<uint32_t>();
+      SerialiseBenchmarkChunk(ser, readValues, readBlob);
+      ser.EndChunk();
+    }
+
+    double readMS = timer.GetMilliseconds();
+
+    CHECK(readValues == values);
+    CHECK(readBlob == blob);
+
+    WARN(StringFormat::Fmt("Read %.2f MB in %.2f ms (%.2f MB/s)%s", MB, readMS,
+                           MB / (readMS / 1000.0), structured ? " with structured export" : "")
+             .c_str());
+  }
+
+  WARN(StringFormat::Fmt("Wrote %.2f MB in %.2f ms (%.2f MB/s)", MB, writeMS,
+                         MB / (writeMS / 1000.0))
+           .c_str());
+
+  delete buf;
+}
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -25,6 +25,7 @@
 #include "streamio.h"
 #include <errno.h>
 #include "api/replay/stringise.h"
+#include "common/threading.h"
 #include "common/timing.h"
 
 Compressor::~Compressor()
@@ -39,6 +40,218 @@ Decompressor::~Decompressor()
     delete m_Read;
 }
 
+bool Decompressor::SeekToBlock(uint64_t offs, uint64_t &blockStart)
+{
+  if(!CanSeek())
+    return false;
+
+  uint64_t block = RDCMIN(offs / m_BlockIndex.blockSize, uint64_t(m_BlockIndex.offsets.size() - 1));
+
+  m_Read->SetOffset(m_BlockIndex.offsets[(size_t)block]);
+
+  if(m_Read->IsErrored())
+  {
+    m_Error = m_Read->GetError();
+    return false;
+  }
+
+  ResetBlock();
+
+  blockStart = block * m_BlockIndex.blockSize;
+  return true;
+}
+
+ParallelCompressor::ParallelCompressor(StreamWriter *write, Ownership own, uint64_t blockSize,
+                                       uint64_t compressBound, uint32_t numThreads)
+    : Compressor(write, own)
+{
+  m_BlockSize = blockSize;
+  m_NumContexts = RDCMAX(numThreads, 1U);
+
+  // every block is independent, so they can all be indexed
+  m_BlockIndex.blockSize = blockSize;
+
+  // each batch has a couple of blocks per context, so that the work is still reasonably well
+  // balanced if some blocks compress faster than others. While one batch is being compressed the
+  // other is being filled with new data.
+  for(Batch &batch : m_Batches)
+  {
+    batch.blocks.resize(m_NumContexts * 2);
+    for(Block &block : batch.blocks)
+    {
+      block.data = AllocAlignedBuffer(blockSize);
+      block.comp = AllocAlignedBuffer(compressBound);
+      block.size = block.compSize = 0;
+    }
+    batch.errors.resize(m_NumContexts);
+    batch.used = 0;
+  }
+
+  m_Batches[0].used = 1;
+  m_CurBlock = &m_Batches[0].blocks[0];
+
+  m_Pool = new Threading::WorkerPool(numThreads);
+}
+
+ParallelCompressor::~ParallelCompressor()
+{
+  StopWorkers();
+
+  for(Batch &batch : m_Batches)
+  {
+    for(Block &block : batch.blocks)
+    {
+      FreeAlignedBuffer(block.data);
+      FreeAlignedBuffer(block.comp);
+    }
+  }
+}
+
+void ParallelCompressor::StopWorkers()
+{
+  // destroying the pool waits for any jobs in flight
+  SAFE_DELETE(m_Pool);
+}
+
+bool ParallelCompressor::Write(const void *data, uint64_t numBytes)
+{
+  // if we encountered a stream error, ignore any further writes
+  if(m_Error != ResultCode::Succeeded)
+    return false;
+
+  if(numBytes == 0)
+    return true;
+
+  // simplest path, the write fits entirely into the current block
+  if(m_CurBlock->size + numBytes <= m_BlockSize)
+  {
+    memcpy(m_CurBlock->data + m_CurBlock->size, data, (size_t)numBytes);
+    m_CurBlock->size += numBytes;
+    return true;
+  }
+
+  const byte *src = (const byte *)data;
+
+  while(numBytes > 0)
+  {
+    // only move to a new block once there's more data to write, so that we never write a trailing
+    // empty block - the same as the serial compressors.
+    if(m_CurBlock->size == m_BlockSize)
+    {
+      Batch &batch = m_Batches[m_CurBatch];
+
+      if(batch.used == batch.blocks.size())
+      {
+        if(!SubmitBatch())
+          return false;
+      }
+      else
+      {
+        m_CurBlock = &batch.blocks[batch.used++];
+        m_CurBlock->size = 0;
+      }
+    }
+
+    uint64_t partialBytes = RDCMIN(m_BlockSize - m_CurBlock->size, numBytes);
+    memcpy(m_CurBlock->data + m_CurBlock->size, src, (size_t)partialBytes);
+
+    m_CurBlock->size += partialBytes;
+    numBytes -= partialBytes;
+    src += partialBytes;
+  }
+
+  return true;
+}
+
+bool ParallelCompressor::Finish()
+{
+  // submit whatever is in the current batch, including the final partial block, then wait for
+  // everything to be written. Calling Write() after Finish() is illegal
+  if(m_Error != ResultCode::Succeeded)
+    return false;
+
+  if(!SubmitBatch())
+    return false;
+
+  return FlushInFlight();
+}
+
+bool ParallelCompressor::SubmitBatch()
+{
+  // wait for the previous batch to finish and write it out, so it's free to be filled again
+  if(!FlushInFlight())
+    return false;
+
+  Batch &batch = m_Batches[m_CurBatch];
+
+  uint32_t numJobs = (uint32_t)RDCMIN((size_t)m_NumContexts, batch.used);
+
+  for(uint32_t c = 0; c < numJobs; c++)
+    m_Pool->AddJob([this, &batch, c, numJobs]() { CompressBatch(batch, c, numJobs); });
+
+  m_InFlight = true;
+
+  m_CurBatch = 1 - m_CurBatch;
+  m_Batches[m_CurBatch].used = 1;
+  m_CurBlock = &m_Batches[m_CurBatch].blocks[0];
+  m_CurBlock->size = 0;
+
+  return true;
+}
+
+void ParallelCompressor::CompressBatch(Batch &batch, uint32_t context, uint32_t stride)
+{
+  for(size_t i = context; i < batch.used; i += stride)
+  {
+    Block &block = batch.blocks[i];
+    block.compSize =
+        CompressBlock(context, block.data, block.size, block.comp, batch.errors[context]);
+
+    if(block.compSize == 0)
+      return;
+  }
+}
+
+bool ParallelCompressor::FlushInFlight()
+{
+  if(!m_InFlight)
+    return true;
+
+  m_Pool->WaitForIdle();
+  m_InFlight = false;
+
+  // the batch in flight is always the one we're not currently filling
+  Batch &batch = m_Batches[1 - m_CurBatch];
+
+  for(RDResult &err : batch.errors)
+  {
+    if(err != ResultCode::Succeeded)
+    {
+      m_Error = err;
+      return false;
+    }
+  }
+
+  bool success = true;
+
+  for(size_t i = 0; success && i < batch.used; i++)
+  {
+    const Block &block = batch.blocks[i];
+
+    m_BlockIndex.offsets.push_back(m_Write->GetOffset());
+
+    success &= m_Write->Write((uint32_t)block.compSize);
+    success &= m_Write->Write(block.comp, block.compSize);
+  }
+
+  if(!success)
+    m_Error = m_Write->GetError();
+
+  batch.used = 0;
+
+  return success;
+}
+
 static const uint64_t initialBufferSize = 64 * 1024;
 const byte StreamWriter::empty[128] = {};
 
@@ -117,6 +330,7 @@ StreamReader::StreamReader(FILE *file, uint64_t fileSize, Ownership own)
   }
 
   m_File = file;
+  m_FileStart = FileIO::ftell64(file);
   m_InputSize = fileSize;
 
   m_BufferSize = initialBufferSize;
@@ -177,12 +391,26 @@ StreamReader::StreamReader(Decompressor *decompressor, uint64_t uncompressedSize
   ReadFromExternal(m_BufferBase, RDCMIN(uncompressedSize, m_BufferSize));
 }
 
+StreamReader::StreamReader(const FileIO::MappedFileRegion &region)
+{
+  m_Mapping = region;
+
+  m_InputSize = m_BufferSize = region.size;
+  m_BufferHead = m_BufferBase = (byte *)region.data;
+
+  // the mapping behaves exactly like an in-memory buffer, we just never write to it
+  m_Ownership = Ownership::Nothing;
+}
+
 StreamReader::~StreamReader()
 {
   for(StreamCloseCallback cb : m_Callbacks)
     cb();
 
-  FreeAlignedBuffer(m_BufferBase);
+  if(m_Mapping.data)
+    FileIO::UnmapFileRegion(m_Mapping);
+  else
+    FreeAlignedBuffer(m_BufferBase);
 
   if(m_Ownership == Ownership::Stream)
   {
@@ -198,7 +426,61 @@ void StreamReader::SetOffset(uint64_t offs)
 {
   if(m_File || m_Decompressor)
   {
-    RDCERR("File and decompress stream readers do not support seeking");
+    if(!m_BufferBase || IsErrored())
+      return;
+
+    uint64_t curOffs = GetOffset();
+
+    // if we're seeking forward within the current window, just move the head
+    if(offs >= curOffs && offs - curOffs <= Available())
+    {
+      m_BufferHead += offs - curOffs;
+      return;
+    }
+
+    if(offs > GetSize())
+    {
+      SET_ERROR_RESULT(m_Error, ResultCode::FileIOFailed, "Seeking off the end of data stream");
+      return;
+    }
+
+    // otherwise seek the underlying source to at or before the offset we want
+    uint64_t readStart = offs;
+
+    if(m_Decompressor)
+    {
+      if(!m_Decompressor->SeekToBlock(offs, readStart))
+      {
+        // without a block index we can still seek forwards by decompressing everything up to the
+        // target.
+        if(offs >= curOffs && !m_Decompressor->CanSeek())
+        {
+          Read(NULL, offs - curOffs);
+          return;
+        }
+
+        if(m_Decompressor->CanSeek())
+          m_Error = m_Decompressor->GetError();
+        else
+          SET_ERROR_RESULT(m_Error, ResultCode::InternalError,
+                           "Can't seek backwards in compressed stream without a block index");
+        return;
+      }
+    }
+    else
+    {
+      FileIO::fseek64(m_File, m_FileStart + offs, SEEK_SET);
+    }
+
+    // refill the window from the new position, the same as when the stream was first created
+    m_ReadOffset = readStart;
+    m_BufferHead = m_BufferBase;
+
+    if(!ReadFromExternal(m_BufferBase, RDCMIN(m_BufferSize, m_InputSize - readStart)))
+      return;
+
+    // skip any remaining bytes in the block before the target
+    Read(NULL, offs - readStart);
     return;
   }
 
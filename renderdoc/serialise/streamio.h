@@ -40,8 +40,22 @@ enum class Ownership
 class StreamWriter;
 class StreamReader;
 
+namespace Threading
+{
+class WorkerPool;
+};
+
 typedef std::function<void()> StreamCloseCallback;
 
+// An index of the blocks in a compressed stream, for compressors that compress each block
+// independently. Every block except the last holds blockSize bytes of uncompressed data, so block i
+// starts at uncompressed offset i * blockSize and at compressed offset offsets[i].
+struct CompressedBlockIndex
+{
+  uint64_t blockSize = 0;
+  rdcarray<uint64_t> offsets;
+};
+
 class Compressor
 {
 public:
@@ -51,10 +65,72 @@ public:
   virtual bool Write(const void *data, uint64_t numBytes) = 0;
   virtual bool Finish() = 0;
 
+  // only filled out if the blocks written can be decompressed independently of each other
+  const CompressedBlockIndex &GetBlockIndex() const { return m_BlockIndex; }
+
 protected:
   StreamWriter *m_Write;
   Ownership m_Ownership;
   RDResult m_Error;
+  CompressedBlockIndex m_BlockIndex;
+};
+
+// A compressor that splits the stream into fixed-size blocks and compresses a batch of them at
+// once on worker threads. Blocks are compressed independently of each other and written out in
+// order, each as a 32-bit compressed size followed by the compressed data. This is the same framing
+// used by the serial compressors so the output can be read back with the matching Decompressor.
+class ParallelCompressor : public Compressor
+{
+public:
+  ParallelCompressor(StreamWriter *write, Ownership own, uint64_t blockSize, uint64_t compressBound,
+                     uint32_t numThreads);
+  virtual ~ParallelCompressor();
+
+  bool Write(const void *data, uint64_t numBytes);
+  bool Finish();
+
+protected:
+  // compress srcSize bytes from src into dst, which has the compressBound space given at
+  // construction. context is in the range [0, GetNumContexts()) and no two blocks with the same
+  // context will be compressed concurrently, so it can be used to index per-thread state.
+  // Returns the compressed size, or 0 on failure with error filled out.
+  virtual uint64_t CompressBlock(uint32_t context, const byte *src, uint64_t srcSize, byte *dst,
+                                 RDResult &error) = 0;
+
+  uint32_t GetNumContexts() const { return m_NumContexts; }
+  // derived classes must call this before destroying any per-context state, to ensure that no
+  // batch is still being compressed
+  void StopWorkers();
+
+private:
+  struct Block
+  {
+    byte *data;
+    byte *comp;
+    uint64_t size;
+    uint64_t compSize;
+  };
+
+  struct Batch
+  {
+    rdcarray<Block> blocks;
+    rdcarray<RDResult> errors;
+    size_t used;
+  };
+
+  bool SubmitBatch();
+  bool FlushInFlight();
+  void CompressBatch(Batch &batch, uint32_t context, uint32_t stride);
+
+  uint64_t m_BlockSize;
+  uint32_t m_NumContexts;
+
+  Batch m_Batches[2];
+  uint32_t m_CurBatch = 0;
+  Block *m_CurBlock = NULL;
+  bool m_InFlight = false;
+
+  Threading::WorkerPool *m_Pool;
 };
 
 class Decompressor
@@ -66,10 +142,22 @@ public:
   virtual bool Recompress(Compressor *comp) = 0;
   virtual bool Read(void *data, uint64_t numBytes) = 0;
 
+  // provide an index of independently compressed blocks, which allows random access seeking. The
+  // index must have come from the compressor that wrote this data.
+  void SetBlockIndex(const CompressedBlockIndex &index) { m_BlockIndex = index; }
+  bool CanSeek() const { return !m_BlockIndex.offsets.empty(); }
+  // seek so that the next read returns data from the start of the block containing the given
+  // uncompressed offset. The offset of that block is returned in blockStart.
+  bool SeekToBlock(uint64_t offs, uint64_t &blockStart);
+
 protected:
+  // discard any decompressed data and history, ready to decompress from a new block
+  virtual void ResetBlock() = 0;
+
   StreamReader *m_Read;
   Ownership m_Ownership;
   RDResult m_Error;
+  CompressedBlockIndex m_BlockIndex;
 };
 
 class StreamReader
@@ -94,6 +182,9 @@ public:
   StreamReader(FILE *file);
   StreamReader(StreamReader *reader, uint64_t bufferSize);
   StreamReader(Decompressor *decompressor, uint64_t uncompressedSize, Ownership own);
+  // read directly from a mapped region of a file without copying. The reader takes ownership of
+  // the mapping and unmaps it when destroyed.
+  StreamReader(const FileIO::MappedFileRegion &region);
 
   ~StreamReader();
 
@@ -104,6 +195,8 @@ public:
     if(m_Error == ResultCode::Succeeded && res != ResultCode::Succeeded)
       m_Error = res;
   }
+  // file readers and decompressing readers can only seek backwards outside of their current window
+  // if the underlying file is seekable or the decompressor has a block index.
   void SetOffset(uint64_t offs);
 
   inline uint64_t GetOffset() { return m_BufferHead - m_BufferBase + m_ReadOffset; }
@@ -268,12 +361,18 @@ private:
   // file pointer, if we're reading from a file
   FILE *m_File = NULL;
 
+  // the position in the file where our input starts, for seeking
+  uint64_t m_FileStart = 0;
+
   // socket, if we're reading from a socket
   Network::Socket *m_Sock = NULL;
 
   // the decompressor, if reading from it
   Decompressor *m_Decompressor = NULL;
 
+  // the file mapping, if we're reading from one. m_BufferBase points into it
+  FileIO::MappedFileRegion m_Mapping;
+
   // the offset in the file/decompressor that corresponds to the start of m_BufferBase
   uint64_t m_ReadOffset = 0;
 
@@ -527,9 +626,11 @@ private:
 
     if(bufferSize < newSize)
     {
-      // reallocate to a conservative size, don't 'double and allocate'
+      // reallocate to a conservative size, don't 'double and allocate'. We do grow by a quarter
+      // of the current size once that's larger than the fixed step, so that very large in-memory
+      // streams (e.g. whole captures) don't spend all their time copying.
       while(bufferSize < newSize)
-        bufferSize += 128 * 1024;
+        bufferSize += RDCMAX(uint64_t(128 * 1024), bufferSize / 4);
 
       byte *newBuf = AllocAlignedBuffer(bufferSize);
 
@@ -94,6 +94,86 @@ TEST_CASE("Test basic stream I/O operations", "[streamio]")
   CHECK(reader.IsErrored());
 };
 
+TEST_CASE("Test seeking file streams", "[streamio]")
+{
+  rdcstr filename = FileIO::GetTempFolderFilename() + "renderdoc_streamio_seek_test";
+
+  rdcarray<uint32_t> data;
+  data.resize(256 * 1024);
+  for(size_t i = 0; i < data.size(); i++)
+    data[i] = uint32_t(i);
+
+  {
+    StreamWriter writer(FileIO::fopen(filename, FileIO::WriteBinary), Ownership::Stream);
+    // write some prefix data so that the reader doesn't start at the beginning of the file
+    writer.Write<uint64_t>(0x1234);
+    writer.Write(data.data(), data.byteSize());
+  }
+
+  FILE *f = FileIO::fopen(filename, FileIO::ReadBinary);
+  FileIO::fseek64(f, sizeof(uint64_t), SEEK_SET);
+
+  {
+    StreamReader reader(f, data.byteSize(), Ownership::Nothing);
+
+    // seek forward past the window, backwards, then within the current window
+    for(uint32_t idx : {200000U, 3U, 150000U, 150002U, 149999U, 262143U})
+    {
+      reader.SetOffset(idx * sizeof(uint32_t));
+      CHECK(reader.GetOffset() == idx * sizeof(uint32_t));
+
+      uint32_t val = 0;
+      reader.Read(val);
+      CHECK(val == idx);
+    }
+
+    CHECK(reader.AtEnd());
+    CHECK_FALSE(reader.IsErrored());
+  }
+
+  FileIO::fclose(f);
+  FileIO::Delete(filename);
+};
+
+TEST_CASE("Test reading mapped file regions", "[streamio]")
+{
+  rdcstr filename = FileIO::GetTempFolderFilename() + "renderdoc_streamio_map_test";
+
+  rdcarray<uint32_t> data;
+  data.resize(64 * 1024);
+  for(size_t i = 0; i < data.size(); i++)
+    data[i] = uint32_t(i);
+
+  FileIO::WriteAll(filename, data);
+
+  FILE *f = FileIO::fopen(filename, FileIO::ReadBinary);
+
+  // map from an offset that isn't page aligned
+  FileIO::MappedFileRegion region;
+  REQUIRE(FileIO::MapFileRegion(f, 12, 1000 * sizeof(uint32_t), region));
+
+  // the mapping stays valid after the file is closed
+  FileIO::fclose(f);
+
+  {
+    StreamReader reader(region);
+
+    CHECK(reader.GetSize() == 1000 * sizeof(uint32_t));
+
+    uint32_t val = 0;
+    reader.Read(val);
+    CHECK(val == 3);
+
+    reader.SetOffset(500 * sizeof(uint32_t));
+    reader.Read(val);
+    CHECK(val == 503);
+
+    CHECK_FALSE(reader.IsErrored());
+  }
+
+  FileIO::Delete(filename);
+};
+
 TEST_CASE("Test stream I/O operations over the network", "[streamio][network]")
 {
   uint16_t port = 8235;
@@ -35,6 +35,9 @@ ZSTDCompressor::ZSTDCompressor(StreamWriter *write, Ownership own) : Compressor(
 
   m_PageOffset = 0;
 
+  // each page is compressed as a separate frame, so they can be indexed for seeking
+  m_BlockIndex.blockSize = zstdBlockSize;
+
   m_Stream = ZSTD_createCStream();
 }
 
@@ -132,6 +135,8 @@ bool ZSTDCompressor::FlushPage()
   if(!m_CompressBuffer)
     return false;
 
+  m_BlockIndex.offsets.push_back(m_Write->GetOffset());
+
   // a bit redundant to write this but it means we can read the entire frame without
   // doing multiple reads
   success &= m_Write->Write((uint32_t)out.pos);
@@ -199,6 +204,39 @@ bool ZSTDCompressor::CompressZSTDFrame(ZSTD_inBuffer &in, ZSTD_outBuffer &out)
   return true;
 }
 
+ZSTDParallelCompressor::ZSTDParallelCompressor(StreamWriter *write, Ownership own,
+                                               uint32_t numThreads)
+    : ParallelCompressor(write, own, zstdBlockSize, compressBlockSize, numThreads)
+{
+  m_Contexts.resize(GetNumContexts());
+  for(ZSTD_CCtx *&ctx : m_Contexts)
+    ctx = ZSTD_createCCtx();
+}
+
+ZSTDParallelCompressor::~ZSTDParallelCompressor()
+{
+  StopWorkers();
+
+  for(ZSTD_CCtx *ctx : m_Contexts)
+    ZSTD_freeCCtx(ctx);
+}
+
+uint64_t ZSTDParallelCompressor::CompressBlock(uint32_t context, const byte *src, uint64_t srcSize,
+                                               byte *dst, RDResult &error)
+{
+  size_t compSize =
+      ZSTD_compressCCtx(m_Contexts[context], dst, compressBlockSize, src, (size_t)srcSize, 7);
+
+  if(ZSTD_isError(compSize))
+  {
+    SET_ERROR_RESULT(error, ResultCode::CompressionFailed, "ZSTD compression failed: %s",
+                     ZSTD_getErrorName(compSize));
+    return 0;
+  }
+
+  return compSize;
+}
+
 ZSTDDecompressor::ZSTDDecompressor(StreamReader *read, Ownership own) : Decompressor(read, own)
 {
   m_Page = AllocAlignedBuffer(zstdBlockSize);
@@ -237,6 +275,12 @@ bool ZSTDDecompressor::Recompress(Compressor *comp)
   return success;
 }
 
+void ZSTDDecompressor::ResetBlock()
+{
+  m_PageOffset = 0;
+  m_PageLength = 0;
+}
+
 bool ZSTDDecompressor::Read(void *data, uint64_t numBytes)
 {
   // if we encountered a stream error this will be NULL
@@ -48,6 +48,22 @@ private:
   ZSTD_CStream *m_Stream;
 };
 
+// compresses each block as a separate frame on worker threads. Since ZSTDCompressor doesn't keep
+// any history between frames either, the output is equivalent.
+class ZSTDParallelCompressor : public ParallelCompressor
+{
+public:
+  ZSTDParallelCompressor(StreamWriter *write, Ownership own, uint32_t numThreads);
+  ~ZSTDParallelCompressor();
+
+protected:
+  uint64_t CompressBlock(uint32_t context, const byte *src, uint64_t srcSize, byte *dst,
+                         RDResult &error);
+
+private:
+  rdcarray<ZSTD_CCtx *> m_Contexts;
+};
+
 class ZSTDDecompressor : public Decompressor
 {
 public:
@@ -57,6 +73,9 @@ public:
   bool Recompress(Compressor *comp);
   bool Read(void *data, uint64_t numBytes);
 
+protected:
+  void ResetBlock();
+
 private:
   bool FillPage();
 
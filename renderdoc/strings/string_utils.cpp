@@ -26,7 +26,9 @@
 #include <ctype.h>
 #include <stdint.h>
 #include <algorithm>
+#include <set>
 #include "common/globalconfig.h"
+#include "common/threading.h"
 #include "os/os_specific.h"
 
 uint32_t strhash(const char *str, uint32_t seed)
@@ -186,6 +188,19 @@ void merge(const rdcarray<rdcstr> &in, rdcstr &out, const char sep)
   }
 }
 
+rdcliteral InternString(const rdcstr &str)
+{
+  // deliberately leaked, interned strings must stay valid until the process exits
+  static Threading::CriticalSection *lock = new Threading::CriticalSection;
+  static std::set<rdcstr> *strings = new std::set<rdcstr>;
+
+  SCOPED_LOCK(*lock);
+
+  const rdcstr &interned = *strings->insert(str).first;
+
+  return operator"" _lit(interned.c_str(), interned.size());
+}
+
 #if ENABLED(ENABLE_UNIT_TESTS)
 #include "catch/catch.hpp"
 
@@ -246,6 +261,26 @@ TEST_CASE("String hashing", "[string]")
   };
 };
 
+TEST_CASE("String interning", "[string]")
+{
+  rdcstr a = "interned_test_string";
+  rdcstr b = a;
+
+  rdcliteral litA = InternString(a);
+  rdcliteral litB = InternString(b);
+
+  CHECK(litA.c_str() == litB.c_str());
+  CHECK(litA.length() == a.size());
+  CHECK(rdcstr(litA) == a);
+
+  // the interned copy is independent of the source string
+  a = "changed";
+  CHECK(rdcstr(litB) == "interned_test_string");
+
+  CHECK(InternString("other_test_string").c_str() != litA.c_str());
+  CHECK(InternString("").length() == 0);
+};
+
 TEST_CASE("String manipulation", "[string]")
 {
   SECTION("strlower")
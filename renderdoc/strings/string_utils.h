@@ -39,3 +39,7 @@ rdcstr strip_extension(const rdcstr &path);
 
 void split(const rdcstr &in, rdcarray<rdcstr> &out, const char sep);
 void merge(const rdcarray<rdcstr> &in, rdcstr &out, const char sep);
+
+// returns a literal referencing a process-lifetime copy of str. Identical strings share the same
+// storage, so structured data names built at runtime can be stored without a per-object allocation
+rdcliteral InternString(const rdcstr &str);
@@ -26,6 +26,9 @@
 #include "renderdoccmd.h"
 #include <app/renderdoc_app.h>
 #include <replay/version.h>
+#include <algorithm>
+#include <chrono>
+#include <set>
 #include <string>
 
 rdcstr conv(const std::string &s)
@@ -295,6 +298,20 @@ public:
   }
 };
 
+static std::string format_bytes(uint64_t bytes)
+{
+  char buf[64];
+  if(bytes >= 1024ULL * 1024ULL * 1024ULL)
+    snprintf(buf, sizeof(buf), "%.2f GB", double(bytes) / (1024.0 * 1024.0 * 1024.0));
+  else if(bytes >= 1024ULL * 1024ULL)
+    snprintf(buf, sizeof(buf), "%.2f MB", double(bytes) / (1024.0 * 1024.0));
+  else if(bytes >= 1024ULL)
+    snprintf(buf, sizeof(buf), "%.2f KB", double(bytes) / 1024.0);
+  else
+    snprintf(buf, sizeof(buf), "%llu B", (unsigned long long)bytes);
+  return buf;
+}
+
 struct CaptureCommand : public Command
 {
 private:
@@ -303,12 +320,22 @@ private:
   std::string cmdLine;
   std::string logFile;
   bool wait_for_exit = false;
+  uint32_t stress_interval = 0;
+  uint32_t stress_count = 0;
 
 public:
   CaptureCommand() : Command() {}
   virtual void AddOptions(cmdline::parser &parser)
   {
     parser.set_footer("<executable> [program arguments]");
+    parser.add<uint32_t>("stress-interval", 0,
+                         "Trigger and discard a capture every N seconds, logging memory use and "
+                         "capture latency. Default is 0, which disables this.",
+                         false, 0);
+    parser.add<uint32_t>("stress-count", 0,
+                         "The number of stress captures to take before stopping. Default is 0, "
+                         "which continues until the program exits.",
+                         false, 0);
     parser.stop_at_rest(true);
   }
   virtual const char *Description() { return "Launches the given executable to capture."; }
@@ -341,6 +368,15 @@ public:
     }
 
     wait_for_exit = parser.exist("wait-for-exit");
+    stress_interval = parser.get<uint32_t>("stress-interval");
+    stress_count = parser.get<uint32_t>("stress-count");
+
+    if(wait_for_exit && stress_interval > 0)
+    {
+      std::cerr << "Error: can't wait for exit and take stress captures at the same time."
+                << std::endl;
+      return false;
+    }
 
     return true;
   }
@@ -375,9 +411,84 @@ public:
       std::cerr << "Launched as ID " << res.ident << std::endl;
     }
 
+    if(stress_interval > 0)
+      return StressCapture(res.ident);
+
     return res.ident;
   }
 
+  // repeatedly capture the target and throw the captures away, to check that the steady state of a
+  // long running program doesn't grow or slow down with each capture.
+  int StressCapture(uint32_t ident)
+  {
+    ITargetControl *control = RENDERDOC_CreateTargetControl("", ident, "renderdoccmd", true);
+
+    if(!control)
+    {
+      std::cerr << "Couldn't connect to target control for stress captures." << std::endl;
+      return 1;
+    }
+
+    std::cout << "Taking a capture every " << stress_interval << " seconds" << std::endl;
+
+    typedef std::chrono::steady_clock clock;
+
+    FrameStatsData stats;
+    uint32_t numCaptures = 0;
+    bool pending = false;
+    clock::time_point triggerTime;
+    clock::time_point nextTrigger = clock::now() + std::chrono::seconds(stress_interval);
+
+    while(stress_count == 0 || numCaptures < stress_count)
+    {
+      TargetControlMessage msg = control->ReceiveMessage(NULL);
+
+      if(msg.type == TargetControlMessageType::Disconnected)
+        break;
+
+      if(msg.type == TargetControlMessageType::FrameStats)
+      {
+        stats = msg.frameStats;
+      }
+      else if(msg.type == TargetControlMessageType::NewCapture && pending)
+      {
+        double latencyMS =
+            std::chrono::duration<double, std::milli>(clock::now() - triggerTime).count();
+
+        numCaptures++;
+
+        char line[256];
+        snprintf(line, sizeof(line),
+                 "Capture %u: frame %u, %s, latency %.1f ms, frame time %.2f ms, process memory "
+                 "%s, accounted memory %s",
+                 numCaptures, msg.newCapture.frameNumber,
+                 format_bytes(msg.newCapture.byteSize).c_str(), latencyMS, stats.averageMS,
+                 format_bytes(stats.processMemory).c_str(),
+                 format_bytes(stats.accountedMemory).c_str());
+        std::cout << line << std::endl;
+
+        // the target deletes the capture file once it shuts down
+        control->DeleteCapture(msg.newCapture.captureId);
+
+        pending = false;
+        nextTrigger = clock::now() + std::chrono::seconds(stress_interval);
+      }
+
+      if(!pending && clock::now() >= nextTrigger)
+      {
+        control->TriggerCapture(1);
+        triggerTime = clock::now();
+        pending = true;
+      }
+    }
+
+    control->Shutdown();
+
+    std::cout << "Took " << numCaptures << " stress captures." << std::endl;
+
+    return 0;
+  }
+
   std::string EscapeArgument(const std::string &arg)
   {
     // nothing to escape or quote
@@ -1258,6 +1369,518 @@ public:
   }
 };
 
+static bool name_contains(const rdcstr &name, const char *const *needles)
+{
+  for(; *needles; needles++)
+    if(name.contains(*needles))
+      return true;
+  return false;
+}
+
+// sort a chunk into a coarse category based on its name, which is shared across all APIs. This
+// is only a heuristic but it's enough to point at what's taking up the space in a capture.
+static std::string categorise_chunk(const SDChunk *chunk)
+{
+  static const char *const initialContents[] = {"Internal::Initial Contents", NULL};
+  static const char *const mapDiffs[] = {
+      "Unmap", "FlushMappedMemoryRanges", "FlushMappedBufferRange", "CoherentMapWrite", NULL,
+  };
+  static const char *const bufferUploads[] = {
+      "BufferData",   "BufferSubData",      "BufferStorage", "UpdateSubresource",
+      "UpdateBuffer", "WriteToSubresource", "TexImage",      "TexSubImage",
+      "TextureSubImage", "CompressedTex",   NULL,
+  };
+  static const char *const shaders[] = {
+      "CreateShaderModule",   "ShaderSource",        "ShaderBinary",     "ProgramBinary",
+      "CreateVertexShader",   "CreatePixelShader",   "CreateHullShader", "CreateDomainShader",
+      "CreateGeometryShader", "CreateComputeShader", "CreateShadersEXT", NULL,
+  };
+  static const char *const pipelines[] = {
+      "CreateGraphicsPipelines",     "CreateComputePipelines",     "CreateRayTracingPipelines",
+      "CreateGraphicsPipelineState", "CreateComputePipelineState", "CreatePipelineState",
+      "CreateStateObject",           "CreatePipelineLibrary",      NULL,
+  };
+
+  const rdcstr &name = chunk->name;
+
+  if(name_contains(name, initialContents))
+  {
+    // initial contents chunks serialise the resource type, though the member name varies by API
+    for(size_t i = 0; i < chunk->NumChildren(); i++)
+    {
+      const SDObject *child = chunk->GetChild(i);
+      if(child->name == "type" || child->name == "Type")
+        return "Initial contents: " + conv(child->AsString());
+    }
+    return "Initial contents";
+  }
+
+  if(name_contains(name, mapDiffs))
+    return "Map/coherent memory updates";
+  if(name_contains(name, bufferUploads))
+    return "Buffer/texture uploads";
+  if(name_contains(name, shaders))
+    return "Shader blobs";
+  if(name_contains(name, pipelines))
+    return "Pipeline state";
+
+  return "Other";
+}
+
+struct CaptureSizeCommand : public Command
+{
+private:
+  std::string infile;
+  bool chunks = false;
+
+public:
+  CaptureSizeCommand() : Command() {}
+  virtual void AddOptions(cmdline::parser &parser)
+  {
+    parser.set_footer("<filename.rdc>");
+    parser.add("chunks", 'c', "Also list the total size of each individual chunk type.");
+  }
+  virtual const char *Description()
+  {
+    return "Print a breakdown of what is taking up space in a capture.";
+  }
+  virtual bool IsInternalOnly() { return false; }
+  virtual bool IsCaptureCommand() { return false; }
+  virtual bool Parse(cmdline::parser &parser, GlobalEnvironment &)
+  {
+    std::vector<std::string> rest = parser.rest();
+    if(rest.empty())
+    {
+      std::cerr << "Error: sizes command requires a capture filename." << std::endl
+                << std::endl
+                << parser.usage();
+      return false;
+    }
+
+    infile = rest[0];
+
+    rest.erase(rest.begin());
+
+    parser.set_rest(rest);
+
+    chunks = parser.exist("chunks");
+
+    return true;
+  }
+  virtual int Execute(const CaptureOptions &)
+  {
+    ICaptureFile *capfile = RENDERDOC_OpenCaptureFile();
+
+    ResultDetails result = capfile->OpenFile(conv(infile), "", NULL);
+
+    if(result.code != ResultCode::Succeeded)
+    {
+      capfile->Shutdown();
+      std::cerr << "Couldn't load '" << infile << "': " << result.Message() << std::endl;
+      return 1;
+    }
+
+    char line[256];
+
+    std::cout << "Sections (compressed / uncompressed):" << std::endl;
+
+    uint64_t totalCompressed = 0, totalUncompressed = 0;
+    uint64_t frameCompressed = 0, frameUncompressed = 0;
+
+    for(int i = 0; i < capfile->GetSectionCount(); i++)
+    {
+      SectionProperties props = capfile->GetSectionProperties(i);
+
+      snprintf(line, sizeof(line), "  %-40s %12s / %12s", props.name.c_str(),
+               format_bytes(props.compressedSize).c_str(),
+               format_bytes(props.uncompressedSize).c_str());
+      std::cout << line << std::endl;
+
+      totalCompressed += props.compressedSize;
+      totalUncompressed += props.uncompressedSize;
+
+      if(props.type == SectionType::FrameCapture)
+      {
+        frameCompressed = props.compressedSize;
+        frameUncompressed = props.uncompressedSize;
+      }
+    }
+
+    Thumbnail thumb = capfile->GetThumbnail(FileType::JPG, 0);
+
+    snprintf(line, sizeof(line), "  %-40s %12s", "Header thumbnail",
+             format_bytes(thumb.data.size()).c_str());
+    std::cout << line << std::endl;
+
+    snprintf(line, sizeof(line), "  %-40s %12s / %12s", "Total",
+             format_bytes(totalCompressed).c_str(), format_bytes(totalUncompressed).c_str());
+    std::cout << line << std::endl << std::endl;
+
+    const SDFile &sdfile = capfile->GetStructuredData();
+
+    std::map<std::string, uint64_t> categorySizes, chunkSizes;
+    uint64_t chunkTotal = 0;
+
+    for(const SDChunk *chunk : sdfile.chunks)
+    {
+      categorySizes[categorise_chunk(chunk)] += chunk->metadata.length;
+      chunkSizes[conv(chunk->name)] += chunk->metadata.length;
+      chunkTotal += chunk->metadata.length;
+    }
+
+    capfile->Shutdown();
+
+    if(chunkTotal == 0)
+    {
+      std::cout << "No chunk data available." << std::endl;
+      return 0;
+    }
+
+    // chunks are compressed together within the frame capture section, so we can't know how well
+    // any one category compresses. Scale by the section's overall ratio as an estimate.
+    double ratio = 1.0;
+    if(frameUncompressed > 0)
+      ratio = double(frameCompressed) / double(frameUncompressed);
+
+    std::cout << "Frame capture chunks (uncompressed / estimated compressed):" << std::endl;
+
+    auto print_sorted = [&](const std::map<std::string, uint64_t> &sizes) {
+      std::vector<std::pair<uint64_t, std::string>> sorted;
+      for(auto it = sizes.begin(); it != sizes.end(); ++it)
+        sorted.push_back({it->second, it->first});
+      std::sort(sorted.rbegin(), sorted.rend());
+
+      for(const std::pair<uint64_t, std::string> &s : sorted)
+      {
+        snprintf(line, sizeof(line), "  %-50s %12s / %12s  %5.1f%%", s.second.c_str(),
+                 format_bytes(s.first).c_str(), format_bytes(uint64_t(s.first * ratio)).c_str(),
+                 100.0 * double(s.first) / double(chunkTotal));
+        std::cout << line << std::endl;
+      }
+    };
+
+    print_sorted(categorySizes);
+
+    if(chunks)
+    {
+      std::cout << std::endl << "Per-chunk totals:" << std::endl;
+      print_sorted(chunkSizes);
+    }
+
+    return 0;
+  }
+};
+
+// collect every resource ID referenced anywhere in a structured object, in order
+static void gather_resource_ids(const SDObject *obj, std::vector<ResourceId> &ids)
+{
+  if(obj->IsResource())
+  {
+    if(obj->AsResourceId() != ResourceId())
+      ids.push_back(obj->AsResourceId());
+    return;
+  }
+
+  for(size_t i = 0; i < obj->NumChildren(); i++)
+    gather_resource_ids(obj->GetChild(i), ids);
+}
+
+// collect the indices of any buffers referenced in a structured object
+static void gather_buffers(const SDObject *obj, std::vector<size_t> &buffers)
+{
+  if(obj->IsBuffer())
+  {
+    buffers.push_back((size_t)obj->AsUInt64());
+    return;
+  }
+
+  for(size_t i = 0; i < obj->NumChildren(); i++)
+    gather_buffers(obj->GetChild(i), buffers);
+}
+
+struct TrimCommand : public Command
+{
+private:
+  std::string infile;
+  std::string outfile;
+  bool dryrun = false;
+
+public:
+  TrimCommand() : Command() {}
+  virtual void AddOptions(cmdline::parser &parser)
+  {
+    parser.set_footer("<filename.rdc>");
+    parser.add<std::string>("output", 'o', "The file to write the trimmed capture to.", false);
+    parser.add("dry-run", 'n', "Only report what would be removed, don't write anything.");
+  }
+  virtual const char *Description()
+  {
+    return "Remove initial contents for resources the captured frame can't reach.";
+  }
+  virtual bool IsInternalOnly() { return false; }
+  virtual bool IsCaptureCommand() { return false; }
+  virtual bool Parse(cmdline::parser &parser, GlobalEnvironment &)
+  {
+    std::vector<std::string> rest = parser.rest();
+    if(rest.empty())
+    {
+      std::cerr << "Error: trim command requires a capture filename." << std::endl
+                << std::endl
+                << parser.usage();
+      return false;
+    }
+
+    infile = rest[0];
+
+    rest.erase(rest.begin());
+
+    parser.set_rest(rest);
+
+    outfile = parser.get<std::string>("output");
+    dryrun = parser.exist("dry-run");
+
+    if(outfile.empty() && !dryrun)
+    {
+      std::cerr << "Need an output filename (-o)." << std::endl << std::endl;
+      std::cerr << parser.usage() << std::endl;
+      return false;
+    }
+
+    return true;
+  }
+  virtual int Execute(const CaptureOptions &)
+  {
+    ICaptureFile *capfile = RENDERDOC_OpenCaptureFile();
+
+    ResultDetails result = capfile->OpenFile(conv(infile), "rdc", NULL);
+
+    if(result.code != ResultCode::Succeeded)
+    {
+      capfile->Shutdown();
+      std::cerr << "Couldn't load '" << infile << "': " << result.Message() << std::endl;
+      return 1;
+    }
+
+    const SDFile &sdfile = capfile->GetStructuredData();
+
+    // everything from the start of the capture onwards is the frame itself, anything before it is
+    // resource creation and initial contents.
+    size_t frameStart = sdfile.chunks.size();
+    for(size_t c = 0; c < sdfile.chunks.size(); c++)
+    {
+      if(sdfile.chunks[c]->name == "Internal::Beginning of Capture")
+      {
+        frameStart = c;
+        break;
+      }
+    }
+
+    if(frameStart == sdfile.chunks.size())
+    {
+      capfile->Shutdown();
+      std::cerr << "Couldn't find the start of the frame in '" << infile << "'." << std::endl;
+      return 1;
+    }
+
+    std::vector<std::vector<ResourceId>> chunkIds(frameStart);
+    std::vector<bool> isInitialContents(frameStart, false);
+
+    // the IDs referenced by the frame are where reachability starts
+    std::set<ResourceId> reachable;
+    std::vector<ResourceId> worklist;
+
+    for(size_t c = frameStart; c < sdfile.chunks.size(); c++)
+    {
+      std::vector<ResourceId> ids;
+      gather_resource_ids(sdfile.chunks[c], ids);
+      for(ResourceId id : ids)
+        if(reachable.insert(id).second)
+          worklist.push_back(id);
+    }
+
+    // the list of resources needing initial contents doesn't make anything reachable, resources
+    // in it that lose their initial contents are reset to defaults on replay
+    for(size_t c = 0; c < frameStart; c++)
+    {
+      const SDChunk *chunk = sdfile.chunks[c];
+      if(chunk->name == "Internal::List of Initial Contents Resources")
+        continue;
+
+      isInitialContents[c] = (chunk->name == "Internal::Initial Contents");
+      gather_resource_ids(chunk, chunkIds[c]);
+    }
+
+    // parent objects like the device are passed first to the creation of everything else, but
+    // don't need what was created from them. Anything that's the first parameter to many chunks
+    // is treated as such a parent and doesn't make the other resources in those chunks reachable,
+    // otherwise everything would be reachable through it.
+    std::map<ResourceId, uint32_t> firstCount;
+    for(size_t c = 0; c < frameStart; c++)
+      if(!isInitialContents[c] && chunkIds[c].size() > 1)
+        firstCount[chunkIds[c][0]]++;
+
+    const uint32_t parentThreshold = 16;
+
+    // for each resource, the chunks through which it makes other resources reachable. For initial
+    // contents that's only from the resource the contents belong to.
+    std::map<ResourceId, std::vector<size_t>> propagates;
+    for(size_t c = 0; c < frameStart; c++)
+    {
+      const std::vector<ResourceId> &ids = chunkIds[c];
+      if(ids.empty())
+        continue;
+
+      if(isInitialContents[c])
+      {
+        propagates[ids[0]].push_back(c);
+        continue;
+      }
+
+      for(size_t i = 0; i < ids.size(); i++)
+      {
+        if(i == 0 && ids.size() > 1 && firstCount[ids[0]] > parentThreshold)
+          continue;
+        propagates[ids[i]].push_back(c);
+      }
+    }
+
+    std::vector<bool> chunkVisited(frameStart, false);
+    while(!worklist.empty())
+    {
+      ResourceId id = worklist.back();
+      worklist.pop_back();
+
+      auto it = propagates.find(id);
+      if(it == propagates.end())
+        continue;
+
+      for(size_t c : it->second)
+      {
+        if(chunkVisited[c])
+          continue;
+        chunkVisited[c] = true;
+
+        for(ResourceId other : chunkIds[c])
+          if(reachable.insert(other).second)
+            worklist.push_back(other);
+      }
+    }
+
+    // drop initial contents for anything not reachable. Creation chunks are kept as they're
+    // comparatively small and removing them would need API-specific knowledge of what depends on
+    // what.
+    std::vector<bool> keep(sdfile.chunks.size(), true);
+    uint64_t droppedBytes = 0, totalBytes = 0;
+    uint32_t droppedCount = 0, initialCount = 0;
+
+    for(size_t c = 0; c < frameStart; c++)
+    {
+      if(!isInitialContents[c])
+        continue;
+
+      initialCount++;
+      totalBytes += sdfile.chunks[c]->metadata.length;
+
+      if(chunkIds[c].empty() || reachable.find(chunkIds[c][0]) != reachable.end())
+        continue;
+
+      keep[c] = false;
+      droppedCount++;
+      droppedBytes += sdfile.chunks[c]->metadata.length;
+    }
+
+    std::cout << "Removing " << droppedCount << " of " << initialCount
+              << " initial contents chunks (" << format_bytes(droppedBytes) << " of "
+              << format_bytes(totalBytes) << ")" << std::endl;
+
+    if(dryrun)
+    {
+      capfile->Shutdown();
+      return 0;
+    }
+
+    // build the trimmed file out of the original's chunks and buffers without copying them. The
+    // buffers only used by removed chunks are replaced with an empty one so they aren't copied
+    // below.
+    SDFile trimmed;
+    trimmed.version = sdfile.version;
+
+    bytebuf empty;
+    trimmed.buffers.reserve(sdfile.buffers.size());
+    for(bytebuf *buf : sdfile.buffers)
+      trimmed.buffers.push_back(buf);
+
+    for(size_t c = 0; c < sdfile.chunks.size(); c++)
+    {
+      if(keep[c])
+      {
+        trimmed.chunks.push_back(sdfile.chunks[c]);
+      }
+      else
+      {
+        std::vector<size_t> buffers;
+        gather_buffers(sdfile.chunks[c], buffers);
+        for(size_t b : buffers)
+          if(b < trimmed.buffers.size())
+            trimmed.buffers[b] = &empty;
+      }
+    }
+
+    Thumbnail thumb = capfile->GetThumbnail(FileType::JPG, 0);
+
+    ICaptureFile *output = RENDERDOC_OpenCaptureFile();
+
+    output->SetMetadata(capfile->DriverName(), 0, thumb.type, thumb.width, thumb.height, thumb.data,
+                        capfile->TimestampBase(), capfile->TimestampFrequency());
+    output->SetStructuredData(trimmed);
+
+    // the trimmed file doesn't own anything
+    trimmed.chunks.clear();
+    trimmed.buffers.clear();
+
+    result = output->Convert(conv(outfile), "rdc", NULL, NULL);
+
+    output->Shutdown();
+
+    if(result.code != ResultCode::Succeeded)
+    {
+      capfile->Shutdown();
+      std::cerr << "Couldn't write '" << outfile << "': " << result.Message() << std::endl;
+      return 1;
+    }
+
+    // copy over any other sections, like notes, bookmarks and callstack resolving data
+    output = RENDERDOC_OpenCaptureFile();
+    result = output->OpenFile(conv(outfile), "rdc", NULL);
+
+    for(int i = 0; result.code == ResultCode::Succeeded && i < capfile->GetSectionCount(); i++)
+    {
+      SectionProperties props = capfile->GetSectionProperties(i);
+
+      // the frame capture was written above, and indices into it are no longer valid
+      if(props.type == SectionType::FrameCapture || props.type == SectionType::BlockIndex ||
+         props.type == SectionType::ChunkIndex)
+        continue;
+
+      result = output->WriteSection(props, capfile->GetSectionContents(i));
+    }
+
+    output->Shutdown();
+    capfile->Shutdown();
+
+    if(result.code != ResultCode::Succeeded)
+    {
+      std::cerr << "Couldn't copy sections to '" << outfile << "': " << result.Message()
+                << std::endl;
+      return 1;
+    }
+
+    std::cout << "Wrote trimmed capture to '" << outfile << "'" << std::endl;
+
+    return 0;
+  }
+};
+
 struct VulkanRegisterCommand : public Command
 {
 private:
@@ -1565,6 +2188,8 @@ int renderdoccmd(GlobalEnvironment &env, std::vector<std::string> &argv)
     add_command("convert", new ConvertCommand());
     add_command("embed", new EmbeddedSectionCommand(false));
     add_command("extract", new EmbeddedSectionCommand(true));
+    add_command("sizes", new CaptureSizeCommand());
+    add_command("trim", new TrimCommand());
 
     if(argv.size() <= 1)
     {
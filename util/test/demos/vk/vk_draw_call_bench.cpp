@@ -0,0 +1,189 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2023 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#include <algorithm>
+#include <chrono>
+#include "3rdparty/fmt/core.h"
+#include "vk_test.h"
+
+RD_TEST(VK_Draw_Call_Bench, VulkanGraphicsTest)
+{
+  static constexpr const char *Description =
+      "Draw call overhead benchmark. Records a large number of tiny draws each frame and reports "
+      "CPU frame time percentiles as JSON, along with the time taken to capture a frame if "
+      "RenderDoc is loaded.";
+
+  uint32_t draws = 10000;
+  int captureFrame = -1;
+
+  typedef std::chrono::high_resolution_clock Clock;
+
+  void Prepare(int argc, char **argv)
+  {
+    for(int i = 0; i < argc; i++)
+    {
+      if(!strcmp(argv[i], "--draws") && i + 1 < argc)
+      {
+        draws = (uint32_t)atoi(argv[i + 1]);
+      }
+      if(!strcmp(argv[i], "--capture-frame") && i + 1 < argc)
+      {
+        captureFrame = atoi(argv[i + 1]);
+      }
+    }
+
+    VulkanGraphicsTest::Prepare(argc, argv);
+  }
+
+  static double Percentile(std::vector<double> &sorted, double p)
+  {
+    if(sorted.empty())
+      return 0.0;
+
+    size_t idx = std::min(sorted.size() - 1, size_t(p * double(sorted.size() - 1) + 0.5));
+    return sorted[idx];
+  }
+
+  int main()
+  {
+    // initialise, create window, create context, etc
+    if(!Init())
+      return 3;
+
+    VkPipelineLayout layout = createPipelineLayout(vkh::PipelineLayoutCreateInfo());
+
+    vkh::GraphicsPipelineCreateInfo pipeCreateInfo;
+
+    pipeCreateInfo.layout = layout;
+    pipeCreateInfo.renderPass = mainWindow->rp;
+
+    pipeCreateInfo.vertexInputState.vertexBindingDescriptions = {vkh::vertexBind(0, DefaultA2V)};
+    pipeCreateInfo.vertexInputState.vertexAttributeDescriptions = {
+        vkh::vertexAttr(0, 0, DefaultA2V, pos), vkh::vertexAttr(1, 0, DefaultA2V, col),
+        vkh::vertexAttr(2, 0, DefaultA2V, uv),
+    };
+
+    pipeCreateInfo.stages = {
+        CompileShaderModule(VKDefaultVertex, ShaderLang::glsl, ShaderStage::vert, "main"),
+        CompileShaderModule(VKDefaultPixel, ShaderLang::glsl, ShaderStage::frag, "main"),
+    };
+
+    VkPipeline pipe = createGraphicsPipeline(pipeCreateInfo);
+
+    AllocatedBuffer vb(
+        this, vkh::BufferCreateInfo(sizeof(DefaultTri), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                                                            VK_BUFFER_USAGE_TRANSFER_DST_BIT),
+        VmaAllocationCreateInfo({0, VMA_MEMORY_USAGE_CPU_TO_GPU}));
+
+    vb.upload(DefaultTri);
+
+    std::vector<double> frameTimes;
+    double captureTime = -1.0;
+
+    while(Running())
+    {
+      Clock::time_point start = Clock::now();
+
+      const bool capturing = rdoc && curFrame == captureFrame;
+
+      if(capturing)
+        rdoc->StartFrameCapture(NULL, NULL);
+
+      VkCommandBuffer cmd = GetCommandBuffer();
+
+      vkBeginCommandBuffer(cmd, vkh::CommandBufferBeginInfo());
+
+      VkImage swapimg =
+          StartUsingBackbuffer(cmd, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL);
+
+      vkCmdClearColorImage(cmd, swapimg, VK_IMAGE_LAYOUT_GENERAL,
+                           vkh::ClearColorValue(0.2f, 0.2f, 0.2f, 1.0f), 1,
+                           vkh::ImageSubresourceRange());
+
+      vkCmdBeginRenderPass(
+          cmd, vkh::RenderPassBeginInfo(mainWindow->rp, mainWindow->GetFB(), mainWindow->scissor),
+          VK_SUBPASS_CONTENTS_INLINE);
+
+      vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe);
+      vkCmdSetViewport(cmd, 0, 1, &mainWindow->viewport);
+      vkh::cmdBindVertexBuffers(cmd, 0, {vb.buffer}, {0});
+
+      // change a little dynamic state between each draw so that the draws aren't entirely trivial
+      // to record, the same as a real application would
+      VkRect2D scissor = mainWindow->scissor;
+      for(uint32_t d = 0; d < draws; d++)
+      {
+        scissor.offset.x = int32_t(d % 4);
+        vkCmdSetScissor(cmd, 0, 1, &scissor);
+        vkCmdDraw(cmd, 3, 1, 0, 0);
+      }
+
+      vkCmdEndRenderPass(cmd);
+
+      FinishUsingBackbuffer(cmd, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL);
+
+      vkEndCommandBuffer(cmd);
+
+      Submit(0, 1, {cmd});
+
+      Present();
+
+      Clock::time_point end = Clock::now();
+
+      if(capturing)
+      {
+        rdoc->EndFrameCapture(NULL, NULL);
+
+        Clock::time_point captured = Clock::now();
+
+        captureTime =
+            double(std::chrono::duration_cast<std::chrono::microseconds>(captured - end).count()) /
+            1000.0;
+      }
+
+      // don't include the captured frame in the steady-state timings
+      if(!capturing)
+        frameTimes.push_back(
+            double(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()) /
+            1000.0);
+    }
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+
+    TEST_LOG("%s",
+             fmt::format("{{\"test\": \"{}\", \"draws\": {}, \"renderdoc\": {}, \"frames\": {}, "
+                         "\"frame_ms\": {{\"p50\": {:.3f}, \"p90\": {:.3f}, \"p99\": {:.3f}, "
+                         "\"max\": {:.3f}}}, \"capture_ms\": {:.3f}}}",
+                         TestName, draws, rdoc ? "true" : "false", frameTimes.size(),
+                         Percentile(frameTimes, 0.5), Percentile(frameTimes, 0.9),
+                         Percentile(frameTimes, 0.99), frameTimes.empty() ? 0.0 : frameTimes.back(),
+                         captureTime)
+                 .c_str());
+
+    return 0;
+  }
+};
+
+REGISTER_TEST();
@@ -1,11 +1,24 @@
 import struct
 from typing import List
 import renderdoc
+from . import util
 
 # Alias for convenience - we need to import as-is so types don't get confused
 rd = renderdoc
 
 
+def _select_gpu(cap: rd.CaptureFile, opts: rd.ReplayOptions):
+    identifier = util.get_gpu().lower()
+
+    # Match the GPU the same way the demos' --gpu option does, on the name or the vendor
+    for gpu in cap.GetAvailableGPUs():
+        if identifier in gpu.name.lower() or identifier in str(gpu.vendor).lower():
+            opts.forceGPUVendor = gpu.vendor
+            opts.forceGPUDeviceID = gpu.deviceID
+            opts.forceGPUDriverName = gpu.driver
+            return
+
+
 def open_capture(filename="", cap: rd.CaptureFile=None, opts: rd.ReplayOptions=None):
     """
     Opens a capture file and begins a replay.
@@ -44,6 +57,10 @@ def open_capture(filename="", cap: rd.CaptureFile=None, opts: rd.ReplayOptions=N
             cap.Shutdown()
             raise RuntimeError("{} capture cannot be replayed".format(api))
 
+    # Pin replay to this run's GPU, unless the test picked one itself
+    if util.get_gpu() != '' and opts.forceGPUVendor == rd.GPUVendor.Unknown:
+        _select_gpu(cap, opts)
+
     result, controller = cap.OpenCapture(opts, None)
 
     if own_cap:
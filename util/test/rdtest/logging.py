@@ -94,6 +94,18 @@ class TestLogger:
         self.dedent()
         self.rawprint("<< Section {}".format(name))
 
+    def merge_output(self, path: str):
+        # Appends the log a test wrote in another process as-is, it has its own indentation
+        with open(path) as f:
+            text = f.read()
+
+        for o in self.outputs:
+            if o == sys.stdout:
+                continue
+
+            o.write(text)
+            o.flush()
+
     def inline_file(self, name: str, path: str, with_stdout: bool = False):
         self.rawprint(">> Raw {}".format(name))
         self.indent()
@@ -177,6 +177,111 @@ def _run_test(testclass, failedcases: list):
                            .format(test_run.returncode))
 
 
+def _run_test_in_shard(name: str, gpu: str, log_path: str):
+    # Like _run_test, but the test logs to its own file instead of streaming output back, so that several can run at
+    # once. The logs are merged into the main log in order once all tests are done.
+    args = sys.argv.copy()
+    args.insert(0, sys.executable)
+
+    args += ['--internal_run_test', name, '--internal_log', log_path]
+    if gpu != '':
+        args += ['--internal_gpu', gpu]
+
+    with open(log_path + '.err', 'w') as err:
+        test_run = subprocess.Popen(args, stdout=subprocess.DEVNULL, stderr=err)
+
+        # Require the log to grow every RUNNER_TIMEOUT seconds, the same as we require output when running serially
+        last_size = -1
+        last_change = time.monotonic()
+        while test_run.poll() is None:
+            time.sleep(0.5)
+
+            size = os.path.getsize(log_path) if os.path.exists(log_path) else 0
+            if size != last_size:
+                last_size = size
+                last_change = time.monotonic()
+            elif time.monotonic() - last_change > RUNNER_TIMEOUT:
+                test_run.kill()
+                test_run.communicate()
+                return False, 'Timed out, no output within {}s elapsed'.format(RUNNER_TIMEOUT)
+
+    if test_run.returncode == 0:
+        return True, ''
+    elif test_run.returncode == 1:
+        return False, ''
+    else:
+        return False, 'Test did not exit cleanly while running, possible crash. Exit code {}'.format(test_run.returncode)
+
+
+def _run_tests_parallel(runcases: list, jobs: int, gpus: list, failedcases: list):
+    log_dir = os.path.join(util.get_tmp_dir(), 'logs')
+    os.makedirs(log_dir, exist_ok=True)
+
+    # Tests of the same demo share its capture, so keep them in the same shard where they run one after the other and
+    # only the first needs to run the demo.
+    groups = {}
+    for testclass, name, instance in runcases:
+        key = instance.demos_test_name if instance.demos_test_name != '' else name
+        groups.setdefault(key, []).append(name)
+
+    # Hand the largest groups out first, each to the shard with the least work so far
+    shards = [[] for _ in range(jobs)]
+    for group in sorted(groups.values(), key=len, reverse=True):
+        min(shards, key=len).extend(group)
+
+    results = {}
+    lock = threading.Lock()
+
+    def run_shard(shard: list, gpu: str):
+        for name in shard:
+            log_path = os.path.join(log_dir, name + '.log')
+            try:
+                result = _run_test_in_shard(name, gpu, log_path)
+            except Exception as ex:
+                result = (False, 'Failed to run test: {}'.format(ex))
+
+            with lock:
+                results[name] = result
+                print('[{}/{}] {} {}'.format(len(results), len(runcases), name, 'passed' if result[0] else 'FAILED'))
+                sys.stdout.flush()
+
+    threads = []
+    for i, shard in enumerate(shards):
+        if len(shard) == 0:
+            continue
+
+        gpu = gpus[i % len(gpus)] if len(gpus) > 0 else util.get_gpu()
+
+        t = threading.Thread(target=run_shard, args=(shard, gpu))
+        t.start()
+        threads.append(t)
+
+    for t in threads:
+        t.join()
+
+    # Merge in the same order the tests would have run serially, so the output is stable
+    for testclass, name, instance in runcases:
+        log_path = os.path.join(log_dir, name + '.log')
+        passed, message = results[name]
+
+        log.begin_test(name)
+
+        if os.path.exists(log_path):
+            log.merge_output(log_path)
+
+        if message != '':
+            log.error(message)
+
+        if os.path.exists(log_path + '.err') and os.path.getsize(log_path + '.err') > 0:
+            log.inline_file('stderr', log_path + '.err')
+
+        if not passed:
+            log.failed = True
+            failedcases.append(testclass)
+
+        log.end_test(name)
+
+
 def fetch_tests():
     output = subprocess.run([util.get_demos_binary(), '--list-raw'], stdout=subprocess.PIPE).stdout
 
@@ -189,7 +294,8 @@ def fetch_tests():
     return { x[0]: (x[1] == 'True', x[2]) for x in split_tests }
 
 
-def run_tests(test_include: str, test_exclude: str, in_process: bool, slow_tests: bool, debugger: bool):
+def run_tests(test_include: str, test_exclude: str, in_process: bool, slow_tests: bool, debugger: bool,
+              jobs: int = 1, gpus: list = []):
     start_time = datetime.datetime.now(datetime.timezone.utc)
 
     rd.InitialiseReplay(rd.GlobalEnvironment(), [])
@@ -338,7 +444,14 @@ def run_tests(test_include: str, test_exclude: str, in_process: bool, slow_tests
 
         runcases.append((testclass, name, instance))
 
-    for testclass, name, instance in runcases:
+    if jobs > 1 and not in_process and not debugger:
+        log.print("Running tests in {} processes".format(jobs))
+        _run_tests_parallel(runcases, jobs, gpus, failedcases)
+        runcases_serial = []
+    else:
+        runcases_serial = runcases
+
+    for testclass, name, instance in runcases_serial:
         # Print header (and footer) outside the exec so we know they will always be printed successfully
         log.begin_test(name)
 
@@ -419,10 +532,13 @@ def become_remote_server():
     rd.BecomeRemoteServer('localhost', 0, None, None)
 
 
-def internal_run_test(test_name):
+def internal_run_test(test_name, log_path=None):
     testcases = get_tests()
 
-    log.add_output(util.get_artifact_path("output.log.html"))
+    if log_path is None:
+        log_path = util.get_artifact_path("output.log.html")
+
+    log.add_output(log_path)
 
     for testclass in testcases:
         if testclass.__name__ == test_name:
@@ -1,4 +1,5 @@
 import os
+import shutil
 import traceback
 import copy
 import re
@@ -235,15 +236,37 @@ class TestCase:
         """
 
         if self.demos_test_name != '':
-            logfile = os.path.join(util.get_tmp_dir(), 'demos.log')
+            # Tests of the same demo with the default capture options get the same capture, so when
+            # reusing captures only the first of them needs to run the demo
+            shared_path = None
+            if util.get_reuse_captures() and type(self).get_capture_options is TestCase.get_capture_options:
+                shared_path = os.path.join(util.get_tmp_dir(), 'shared_captures',
+                                           '{}_{}_{}_{}.rdc'.format(self.demos_test_name, self.demos_frame_cap,
+                                                                    self.demos_frame_count,
+                                                                    self.demos_captures_expected))
+
+                if os.path.exists(shared_path):
+                    log.print("Reusing capture of {} from an earlier test".format(self.demos_test_name))
+                    return shared_path
+
+            logfile = util.get_tmp_path('demos.log')
             timeout = self.demos_timeout
             if timeout is None:
                 timeout = util.get_demos_timeout()
-            return capture.run_and_capture(util.get_demos_binary(), self.demos_test_name + " --log " + logfile,
+            cmdline = self.demos_test_name + " --log " + logfile
+            if util.get_gpu() != '':
+                cmdline += " --gpu " + util.get_gpu()
+            path = capture.run_and_capture(util.get_demos_binary(), cmdline,
                                            self.demos_frame_cap, frame_count=self.demos_frame_count,
                                            captures_expected=self.demos_captures_expected, logfile=logfile,
                                            opts=self.get_capture_options(), timeout=timeout)
 
+            if shared_path is not None:
+                os.makedirs(os.path.dirname(shared_path), exist_ok=True)
+                shutil.copyfile(path, shared_path)
+
+            return path
+
         raise NotImplementedError("If run() is not implemented in a test, then"
                                   "get_capture() and check_capture() must be.")
 
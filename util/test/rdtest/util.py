@@ -32,6 +32,8 @@ _temp_dir = os.path.realpath('tmp')
 _test_name = 'Unknown_Test'
 _demos_bin = os.path.realpath('demos_x64')
 _demos_timeout = None
+_gpu = ''
+_reuse_captures = False
 
 
 def set_root_dir(path: str):
@@ -92,6 +94,16 @@ def set_demos_timeout(timeout: int):
     _demos_timeout = timeout
 
 
+def set_gpu(identifier: str):
+    global _gpu
+    _gpu = identifier
+
+
+def set_reuse_captures(reuse: bool):
+    global _reuse_captures
+    _reuse_captures = reuse
+
+
 def set_current_test(name: str):
     global _test_name
     _test_name = name
@@ -137,6 +149,14 @@ def get_demos_timeout():
     return _demos_timeout
 
 
+def get_gpu():
+    return _gpu
+
+
+def get_reuse_captures():
+    return _reuse_captures
+
+
 def get_tmp_path(name: str):
     os.makedirs(os.path.join(_temp_dir, _test_name), exist_ok=True)
     return os.path.join(_temp_dir, _test_name, name)
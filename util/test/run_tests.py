@@ -32,10 +32,18 @@ parser.add_argument('--artifacts', default=os.path.join(script_dir, "artifacts")
                     help="The folder to put output artifacts in. Will be completely cleared.", type=str)
 parser.add_argument('--temp', default=os.path.join(script_dir, "tmp"),
                     help="The folder to put temporary run data in. Will be completely cleared.", type=str)
+parser.add_argument('-j', '--jobs', default=1,
+                    help="The number of tests to run at once, each in its own process.", type=int)
+parser.add_argument('--gpus', default="",
+                    help="A comma-separated list of GPUs to spread tests over, identified as for the demos' --gpu "
+                         "option. With only one, all tests run on that GPU.", type=str)
 parser.add_argument('--debugger',
                     help="Enable debugger mode, exceptions are not caught by the framework.", action="store_true")
 # Internal command, when we fork out to run a test in a separate process
 parser.add_argument('--internal_run_test', help=argparse.SUPPRESS, type=str, required=False)
+# Internal options for a forked test when running in parallel, the GPU to use and the file to log to
+parser.add_argument('--internal_gpu', help=argparse.SUPPRESS, type=str, required=False)
+parser.add_argument('--internal_log', help=argparse.SUPPRESS, type=str, required=False)
 # Internal command, when we re-run as admin to register vulkan layer
 parser.add_argument('--internal_vulkan_register', help=argparse.SUPPRESS, action="store_true", required=False)
 # Internal command, when we re-run as a remote server
@@ -126,6 +134,15 @@ rdtest.set_temp_dir(temp_path)
 rdtest.set_demos_binary(demos_binary)
 rdtest.set_demos_timeout(demos_timeout)
 
+gpus = [gpu.strip() for gpu in args.gpus.split(',') if gpu.strip() != '']
+if args.internal_gpu is not None:
+    rdtest.set_gpu(args.internal_gpu)
+elif len(gpus) > 0:
+    rdtest.set_gpu(gpus[0])
+
+# tests running in parallel share captures of the same demo rather than each running it
+rdtest.set_reuse_captures(args.jobs > 1)
+
 # debugger option implies in-process test running
 if args.debugger:
     args.in_process = True
@@ -135,6 +152,7 @@ if args.internal_vulkan_register:
 elif args.internal_remote_server:
     rdtest.become_remote_server()
 elif args.internal_run_test is not None:
-    rdtest.internal_run_test(args.internal_run_test)
+    rdtest.internal_run_test(args.internal_run_test, args.internal_log)
 else:
-    rdtest.run_tests(args.test_include, args.test_exclude, args.in_process, args.slow_tests, args.debugger)
+    rdtest.run_tests(args.test_include, args.test_exclude, args.in_process, args.slow_tests, args.debugger,
+                     args.jobs, gpus)
@@ -0,0 +1,121 @@
+import rdtest
+import os
+import json
+import time
+import renderdoc as rd
+
+
+def percentile(times, pct):
+    if len(times) == 0:
+        return 0.0
+    times = sorted(times)
+    return times[min(len(times) - 1, int(pct * (len(times) - 1) + 0.5))]
+
+
+def summarise(times):
+    return {
+        'count': len(times),
+        'p50_ms': percentile(times, 0.5),
+        'p99_ms': percentile(times, 0.99),
+        'max_ms': max(times) if len(times) > 0 else 0.0,
+    }
+
+
+class Replay_Bench(rdtest.TestCase):
+    slow_test = True
+
+    def timed(self, func):
+        start = time.perf_counter()
+        ret = func()
+        return ret, (time.perf_counter() - start) * 1000.0
+
+    def bench_capture(self, path: str):
+        result = {}
+
+        try:
+            self.controller, result['load_ms'] = self.timed(lambda: rdtest.open_capture(path))
+        except RuntimeError as err:
+            rdtest.log.print("Skipping. Can't open {}: {}".format(path, err))
+            return None
+
+        rdtest.log.print("Loaded in {:.2f} ms".format(result['load_ms']))
+
+        seek_times = []
+        draws = []
+
+        action = self.get_first_action()
+
+        while action:
+            _, ms = self.timed(lambda: self.controller.SetFrameEvent(action.eventId, True))
+            seek_times.append(ms)
+
+            if action.flags & rd.ActionFlags.Drawcall:
+                draws.append(action)
+
+            action = action.next
+
+        result['seek'] = summarise(seek_times)
+
+        # only sample a bounded number of draws for the heavier fetches so that huge captures still
+        # complete in a reasonable time
+        stride = max(1, len(draws) // 20)
+        sampled = draws[::stride]
+
+        postvs_times = []
+        history_times = []
+
+        for draw in sampled:
+            self.controller.SetFrameEvent(draw.eventId, True)
+
+            _, ms = self.timed(lambda: self.controller.GetPostVSData(0, 0, rd.MeshDataStage.VSOut))
+            postvs_times.append(ms)
+
+            pipe: rd.PipeState = self.controller.GetPipelineState()
+
+            targets = [o.resourceId for o in pipe.GetOutputTargets() if o.resourceId != rd.ResourceId.Null()]
+            if len(targets) == 0:
+                continue
+
+            viewport = pipe.GetViewport(0)
+            x = int(viewport.x + viewport.width / 2)
+            y = int(viewport.y + viewport.height / 2)
+
+            _, ms = self.timed(lambda: self.controller.PixelHistory(targets[0], x, y, rd.Subresource(0, 0, 0),
+                                                                    rd.CompType.Typeless))
+            history_times.append(ms)
+
+        result['postvs'] = summarise(postvs_times)
+        result['pixel_history'] = summarise(history_times)
+
+        if rd.GPUCounter.EventGPUDuration in self.controller.EnumerateCounters():
+            _, result['counters_ms'] = self.timed(
+                lambda: self.controller.FetchCounters([rd.GPUCounter.EventGPUDuration]))
+
+        self.controller.Shutdown()
+
+        return result
+
+    def run(self):
+        dir_path = self.get_ref_path('', extra=True)
+
+        results = {}
+
+        for file in sorted(os.scandir(dir_path), key=lambda e: e.name.lower()):
+            if '.rdc' not in file.name:
+                continue
+
+            section_name = 'Benchmarking {}'.format(file.name)
+
+            rdtest.log.begin_section(section_name)
+            result = self.bench_capture(file.path)
+            if result is not None:
+                results[file.name] = result
+                rdtest.log.print(json.dumps(result))
+            rdtest.log.end_section(section_name)
+
+        out_path = rdtest.get_artifact_path('replay_bench.json')
+
+        with open(out_path, 'w') as f:
+            json.dump(results, f, indent=2)
+
+        rdtest.log.success("Benchmarked {} files, results written to {}".format(len(results), out_path))